@@ -48,6 +48,36 @@ public:
     }
 };
 
+// extractor inputs may reference numpy memory without copying
+// keep them alive with the extractor, the latest one per blob
+static void keep_extractor_input(py::object ex, py::object key, py::object in)
+{
+    if (!py::hasattr(ex, "_inputs"))
+        py::setattr(ex, "_inputs", py::dict());
+
+    py::dict inputs = ex.attr("_inputs");
+    inputs[key] = in;
+}
+
+// take numpy array as input directly
+static py::object as_extractor_input(py::object in)
+{
+    if (py::isinstance<Mat>(in))
+        return in;
+
+    return py::type::of<Mat>()(in);
+}
+
+// the extracted mat is handed to python as is, unless it references
+// input memory or the blob allocator that may go away before it
+static Mat detach_extracted(const Mat& feat)
+{
+    if (!feat.empty() && (!feat.refcount || feat.allocator))
+        return feat.clone();
+
+    return feat;
+}
+
 struct LayerFactory
 {
     std::string name;
@@ -139,6 +169,15 @@ PYBIND11_MODULE(ncnn, m)
     .def("clear", &UnlockedPoolAllocator::clear)
     .def("fastMalloc", &UnlockedPoolAllocator::fastMalloc, py::arg("size"))
     .def("fastFree", &UnlockedPoolAllocator::fastFree, py::arg("ptr"));
+    py::class_<SizeClassPoolAllocator, Allocator, PyAllocatorOther<SizeClassPoolAllocator> >(m, "SizeClassPoolAllocator")
+    .def(py::init<>())
+    .def("set_thread_cache_size", &SizeClassPoolAllocator::set_thread_cache_size, py::arg("count"))
+    .def("clear", &SizeClassPoolAllocator::clear)
+    .def("hit_count", &SizeClassPoolAllocator::hit_count)
+    .def("miss_count", &SizeClassPoolAllocator::miss_count)
+    .def("bytes_held", &SizeClassPoolAllocator::bytes_held)
+    .def("fastMalloc", &SizeClassPoolAllocator::fastMalloc, py::arg("size"))
+    .def("fastFree", &SizeClassPoolAllocator::fastFree, py::arg("ptr"));
 
     py::class_<DataReader, PyDataReader<> >(m, "DataReader")
     .def(py::init<>())
@@ -215,7 +254,9 @@ PYBIND11_MODULE(ncnn, m)
     .def_readwrite("use_packing_layout", &Option::use_packing_layout)
     .def_readwrite("use_shader_pack8", &Option::use_shader_pack8)
     .def_readwrite("use_subgroup_ops", &Option::use_subgroup_ops)
-    .def_readwrite("use_tensor_storage", &Option::use_tensor_storage);
+    .def_readwrite("use_tensor_storage", &Option::use_tensor_storage)
+    .def_readwrite("use_parallel_graph", &Option::use_parallel_graph)
+    .def_readwrite("use_memory_plan", &Option::use_memory_plan);
 
     py::class_<Mat> mat(m, "Mat", py::buffer_protocol());
     mat.def(py::init<>())
@@ -262,45 +303,9 @@ PYBIND11_MODULE(ncnn, m)
 
     .def(py::init([](py::buffer const b) {
         py::buffer_info info = b.request();
-        if (info.ndim > 4)
-        {
-            std::stringstream ss;
-            ss << "convert numpy.ndarray to ncnn.Mat only dims <=4 support now, but given " << info.ndim;
-            pybind11::pybind11_fail(ss.str());
-        }
-
-        size_t elemsize = info.itemsize;
-
-        Mat* v = nullptr;
-        if (info.ndim == 1)
-        {
-            v = new Mat((int)info.shape[0], info.ptr, elemsize);
-        }
-        else if (info.ndim == 2)
-        {
-            v = new Mat((int)info.shape[1], (int)info.shape[0], info.ptr, elemsize);
-        }
-        else if (info.ndim == 3)
-        {
-            v = new Mat((int)info.shape[2], (int)info.shape[1], (int)info.shape[0], info.ptr, elemsize);
-
-            // in ncnn, buffer to construct ncnn::Mat need align to ncnn::alignSize
-            // with (w * h * elemsize, 16) / elemsize, but the buffer from numpy not
-            // so we set the cstep as numpy's cstep
-            v->cstep = (int)info.shape[2] * (int)info.shape[1];
-        }
-        else if (info.ndim == 4)
-        {
-            v = new Mat((int)info.shape[3], (int)info.shape[2], (int)info.shape[1], (int)info.shape[0], info.ptr, elemsize);
-
-            // in ncnn, buffer to construct ncnn::Mat need align to ncnn::alignSize
-            // with (w * h * d elemsize, 16) / elemsize, but the buffer from numpy not
-            // so we set the cstep as numpy's cstep
-            v->cstep = (int)info.shape[3] * (int)info.shape[2] * (int)info.shape[1];
-        }
-        return std::unique_ptr<Mat>(v);
+        return std::unique_ptr<Mat>(from_buffer_info(info));
     }),
-    py::arg("array"))
+    py::arg("array"), py::keep_alive<1, 2>()) // the mat references array memory
     .def_buffer([](Mat& m) -> py::buffer_info {
         return to_buffer_info(m);
     })
@@ -845,34 +850,159 @@ PYBIND11_MODULE(ncnn, m)
     .value("PIXEL_BGRA2GRAY", ncnn::Mat::PixelType::PIXEL_BGRA2GRAY)
     .value("PIXEL_BGRA2RGBA", ncnn::Mat::PixelType::PIXEL_BGRA2RGBA);
 
-    py::class_<Extractor>(m, "Extractor")
+    py::class_<LayerProfile>(m, "LayerProfile")
+    .def_readonly("layer_index", &LayerProfile::layer_index)
+    .def_readonly("typeindex", &LayerProfile::typeindex)
+#if NCNN_STRING
+    .def_readonly("type", &LayerProfile::type)
+    .def_readonly("name", &LayerProfile::name)
+#endif // NCNN_STRING
+    .def_readonly("start", &LayerProfile::start)
+    .def_readonly("end", &LayerProfile::end)
+    .def_readonly("num_threads", &LayerProfile::num_threads)
+    .def_readonly("bottom_shapes", &LayerProfile::bottom_shapes)
+    .def_readonly("top_shapes", &LayerProfile::top_shapes)
+    .def_readonly("bytes_allocated", &LayerProfile::bytes_allocated)
+    .def_property_readonly("kernel", [](const LayerProfile& profile) {
+        return std::string(profile.kernel);
+    });
+
+    py::class_<Extractor>(m, "Extractor", py::dynamic_attr())
     .def("__enter__", [](Extractor& ex) -> Extractor& { return ex; })
     .def("__exit__", [](Extractor& ex, pybind11::args) {
         ex.clear();
     })
     .def("clear", &Extractor::clear)
+    .def("reset_inputs", &Extractor::reset_inputs)
     .def("set_light_mode", &Extractor::set_light_mode, py::arg("enable"))
     .def("set_num_threads", &Extractor::set_num_threads, py::arg("num_threads"))
     .def("set_blob_allocator", &Extractor::set_blob_allocator, py::arg("allocator"))
     .def("set_workspace_allocator", &Extractor::set_workspace_allocator, py::arg("allocator"))
+    .def("set_profiling", &Extractor::set_profiling, py::arg("enable"))
+    .def("layer_profiles", &Extractor::layer_profiles)
+#if NCNN_STDIO
+    .def("save_chrome_trace", &Extractor::save_chrome_trace, py::arg("path"))
+#endif // NCNN_STDIO
 #if NCNN_STRING
-    .def("input", (int (Extractor::*)(const char*, const Mat&)) & Extractor::input, py::arg("blob_name"), py::arg("in"))
-    .def("extract", (int (Extractor::*)(const char*, Mat&, int)) & Extractor::extract, py::arg("blob_name"), py::arg("feat"), py::arg("type") = 0)
+    .def(
+    "input", [](py::object self, const char* blob_name, py::object in) {
+        py::object mat = as_extractor_input(in);
+        int ret = self.cast<Extractor&>().input(blob_name, mat.cast<const Mat&>());
+        keep_extractor_input(self, py::str(blob_name), mat);
+        return ret;
+    },
+    py::arg("blob_name"), py::arg("in"))
+    .def("extract", (int (Extractor::*)(const char*, Mat&, int)) & Extractor::extract, py::arg("blob_name"), py::arg("feat"), py::arg("type") = 0, py::call_guard<py::gil_scoped_release>())
     .def(
     "extract", [](Extractor& ex, const char* blob_name, int type) {
         ncnn::Mat feat;
-        int ret = ex.extract(blob_name, feat, type);
-        return py::make_tuple(ret, feat.clone());
+        int ret;
+        {
+            py::gil_scoped_release release;
+            ret = ex.extract(blob_name, feat, type);
+        }
+        return py::make_tuple(ret, detach_extracted(feat));
+    },
+    py::arg("blob_name"), py::arg("type") = 0)
+    .def(
+    "extract_many", [](Extractor& ex, const std::vector<std::string>& blob_names, int type) {
+        std::vector<ncnn::Mat> feats(blob_names.size());
+        int ret = 0;
+        {
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < blob_names.size() && ret == 0; i++)
+            {
+                ret = ex.extract(blob_names[i].c_str(), feats[i], type);
+            }
+        }
+        for (size_t i = 0; i < feats.size(); i++)
+        {
+            feats[i] = detach_extracted(feats[i]);
+        }
+        return py::make_tuple(ret, feats);
+    },
+    py::arg("blob_names"), py::arg("type") = 0)
+    .def(
+    "input_batch", [](py::object self, const char* blob_name, py::object in) {
+        int ret = self.cast<Extractor&>().input_batch(blob_name, in.cast<std::vector<Mat> >());
+        keep_extractor_input(self, py::str(blob_name), in);
+        return ret;
+    },
+    py::arg("blob_name"), py::arg("in"))
+    .def(
+    "extract_batch", [](Extractor& ex, const char* blob_name, int type) {
+        std::vector<ncnn::Mat> feats;
+        int ret;
+        {
+            py::gil_scoped_release release;
+            ret = ex.extract_batch(blob_name, feats, type);
+        }
+        for (size_t i = 0; i < feats.size(); i++)
+        {
+            feats[i] = detach_extracted(feats[i]);
+        }
+        return py::make_tuple(ret, feats);
     },
     py::arg("blob_name"), py::arg("type") = 0)
 #endif
-    .def("input", (int (Extractor::*)(int, const Mat&)) & Extractor::input)
-    .def("extract", (int (Extractor::*)(int, Mat&, int)) & Extractor::extract, py::arg("blob_index"), py::arg("feat"), py::arg("type") = 0)
+    .def(
+    "input", [](py::object self, int blob_index, py::object in) {
+        py::object mat = as_extractor_input(in);
+        int ret = self.cast<Extractor&>().input(blob_index, mat.cast<const Mat&>());
+        keep_extractor_input(self, py::int_(blob_index), mat);
+        return ret;
+    },
+    py::arg("blob_index"), py::arg("in"))
+    .def("extract", (int (Extractor::*)(int, Mat&, int)) & Extractor::extract, py::arg("blob_index"), py::arg("feat"), py::arg("type") = 0, py::call_guard<py::gil_scoped_release>())
     .def(
     "extract", [](Extractor& ex, int blob_index, int type) {
         ncnn::Mat feat;
-        int ret = ex.extract(blob_index, feat, type);
-        return py::make_tuple(ret, feat.clone());
+        int ret;
+        {
+            py::gil_scoped_release release;
+            ret = ex.extract(blob_index, feat, type);
+        }
+        return py::make_tuple(ret, detach_extracted(feat));
+    },
+    py::arg("blob_index"), py::arg("type") = 0)
+    .def(
+    "extract_many", [](Extractor& ex, const std::vector<int>& blob_indexes, int type) {
+        std::vector<ncnn::Mat> feats(blob_indexes.size());
+        int ret = 0;
+        {
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < blob_indexes.size() && ret == 0; i++)
+            {
+                ret = ex.extract(blob_indexes[i], feats[i], type);
+            }
+        }
+        for (size_t i = 0; i < feats.size(); i++)
+        {
+            feats[i] = detach_extracted(feats[i]);
+        }
+        return py::make_tuple(ret, feats);
+    },
+    py::arg("blob_indexes"), py::arg("type") = 0)
+    .def(
+    "input_batch", [](py::object self, int blob_index, py::object in) {
+        int ret = self.cast<Extractor&>().input_batch(blob_index, in.cast<std::vector<Mat> >());
+        keep_extractor_input(self, py::int_(blob_index), in);
+        return ret;
+    },
+    py::arg("blob_index"), py::arg("in"))
+    .def(
+    "extract_batch", [](Extractor& ex, int blob_index, int type) {
+        std::vector<ncnn::Mat> feats;
+        int ret;
+        {
+            py::gil_scoped_release release;
+            ret = ex.extract_batch(blob_index, feats, type);
+        }
+        for (size_t i = 0; i < feats.size(); i++)
+        {
+            feats[i] = detach_extracted(feats[i]);
+        }
+        return py::make_tuple(ret, feats);
     },
     py::arg("blob_index"), py::arg("type") = 0);
 
@@ -965,6 +1095,9 @@ PYBIND11_MODULE(ncnn, m)
 #endif // NCNN_STRING
     .def("load_param_bin", (int (Net::*)(const char*)) & Net::load_param_bin, py::arg("protopath"))
     .def("load_model", (int (Net::*)(const char*)) & Net::load_model, py::arg("modelpath"))
+    .def("load_model_mmap", &Net::load_model_mmap, py::arg("modelpath"))
+    .def("set_weight_cache", &Net::set_weight_cache, py::arg("cachepath"))
+    .def("set_tuning_file", &Net::set_tuning_file, py::arg("tunepath"))
     .def(
     "load_model_mem", [](Net& net, const char* mem) {
         const unsigned char* _mem = (const unsigned char*)mem;
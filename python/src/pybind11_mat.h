@@ -113,4 +113,68 @@ py::buffer_info to_buffer_info(ncnn::Mat& m, const std::string& format = "")
                           );
 }
 
+// wrap the buffer memory as ncnn::Mat without copying
+// rows must be contiguous, and so must the depth planes of 4 dims buffer
+// the channel stride becomes cstep, padded channels from ncnn.Mat.numpy() round trip as is
+static inline ncnn::Mat* from_buffer_info(const py::buffer_info& info)
+{
+    if (info.ndim < 1 || info.ndim > 4)
+    {
+        std::ostringstream ss;
+        ss << "convert numpy.ndarray to ncnn.Mat only dims <=4 support now, but given " << info.ndim;
+        pybind11::pybind11_fail(ss.str());
+    }
+
+    const py::ssize_t itemsize = info.itemsize;
+
+    // numpy gives any stride to the dims of size 1
+    bool contiguous = true;
+    py::ssize_t channel_size = itemsize;
+    const int inner_ndim = info.ndim >= 3 ? (int)info.ndim - 1 : (int)info.ndim;
+    for (int i = (int)info.ndim - 1; i >= (int)info.ndim - inner_ndim; i--)
+    {
+        if (info.shape[i] != 1 && info.strides[i] != channel_size)
+            contiguous = false;
+
+        channel_size *= info.shape[i];
+    }
+
+    size_t cstep = channel_size / itemsize;
+    if (info.ndim >= 3 && info.shape[0] != 1)
+    {
+        if (info.strides[0] < channel_size || info.strides[0] % itemsize != 0)
+            contiguous = false;
+        else
+            cstep = info.strides[0] / itemsize;
+    }
+
+    if (!contiguous)
+    {
+        pybind11::pybind11_fail("convert numpy.ndarray to ncnn.Mat without copy needs contiguous rows and channels, use numpy.ascontiguousarray");
+    }
+
+    size_t elemsize = info.itemsize;
+
+    ncnn::Mat* v = nullptr;
+    if (info.ndim == 1)
+    {
+        v = new ncnn::Mat((int)info.shape[0], info.ptr, elemsize);
+    }
+    else if (info.ndim == 2)
+    {
+        v = new ncnn::Mat((int)info.shape[1], (int)info.shape[0], info.ptr, elemsize);
+    }
+    else if (info.ndim == 3)
+    {
+        v = new ncnn::Mat((int)info.shape[2], (int)info.shape[1], (int)info.shape[0], info.ptr, elemsize);
+        v->cstep = cstep;
+    }
+    else if (info.ndim == 4)
+    {
+        v = new ncnn::Mat((int)info.shape[3], (int)info.shape[2], (int)info.shape[1], (int)info.shape[0], info.ptr, elemsize);
+        v->cstep = cstep;
+    }
+    return v;
+}
+
 #endif
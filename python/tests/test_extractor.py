@@ -12,6 +12,9 @@
 # CONDITIONS OF ANY KIND, either express or implied. See the License for the
 # specific language governing permissions and limitations under the License.
 
+import threading
+
+import numpy as np
 import pytest
 
 import ncnn
@@ -84,3 +87,45 @@ def test_extractor_index():
 
     # not use with sentence, call clear manually to ensure ex destruct before net
     ex.clear()
+
+
+def test_extractor_many():
+    dr = ncnn.DataReaderFromEmpty()
+
+    net = ncnn.Net()
+    net.load_param("tests/test.param")
+    net.load_model(dr)
+
+    in_array = np.random.rand(3, 227, 227).astype(np.float32)
+    with net.create_extractor() as ex:
+        ex.input("data", in_array)
+        ret, out_mats = ex.extract_many(["conv0_fwd", "output"])
+        assert ret == 0 and len(out_mats) == 2
+        assert out_mats[0].dims == 3 and out_mats[0].w == 225 and out_mats[0].c == 3
+        assert out_mats[1].dims == 1 and out_mats[1].w == 1
+
+        ret, out_mats = ex.extract_many([1, 2])
+        assert ret == 0 and out_mats[0].w == 225 and out_mats[1].w == 1
+
+
+def test_extractor_threads():
+    dr = ncnn.DataReaderFromEmpty()
+
+    net = ncnn.Net()
+    net.load_param("tests/test.param")
+    net.load_model(dr)
+
+    def run(results, i):
+        in_array = np.random.rand(3, 227, 227).astype(np.float32)
+        with net.create_extractor() as ex:
+            ex.input("data", in_array)
+            ret, out_mat = ex.extract("conv0_fwd")
+            results[i] = ret == 0 and np.array(out_mat).shape == (3, 225, 225)
+
+    results = [False] * 4
+    threads = [threading.Thread(target=run, args=(results, i)) for i in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert all(results)
@@ -774,3 +774,25 @@ def test_substract_mean_normalize():
     assert (
         np.abs((pixels[0, 0, 0] - 127.5) * 0.007843 - mat.channel(0).row(0)[0]) < 1e-5
     )
+
+
+def test_numpy_zero_copy():
+    # cstep of 5x3 float mat is padded to 16, the channel stride survives the round trip
+    mat = ncnn.Mat(5, 3, 4)
+    mat.fill(1.0)
+    array = mat.numpy()
+    assert array.strides[0] == mat.cstep * 4
+
+    mat2 = ncnn.Mat(array)
+    assert mat2.cstep == mat.cstep
+    array[1, 2, 3] = 7.0
+    assert mat2.channel(1).row(2)[3] == 7.0
+
+    # the mat keeps the array alive
+    array = np.arange(60, dtype=np.float32).reshape(3, 4, 5)
+    mat = ncnn.Mat(array)
+    del array
+    assert mat.channel(2).row(3)[4] == 59.0
+
+    with pytest.raises(RuntimeError, match="ascontiguousarray"):
+        ncnn.Mat(np.zeros((3, 4, 10), dtype=np.float32)[:, :, ::2])
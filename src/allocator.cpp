@@ -14,9 +14,12 @@
 
 #include "allocator.h"
 
+#include "cpu.h"
 #include "gpu.h"
 #include "pipeline.h"
 
+#include <string.h>
+
 #if __ANDROID_API__ >= 26
 #include <android/hardware_buffer.h>
 #endif // __ANDROID_API__ >= 26
@@ -357,6 +360,497 @@ void UnlockedPoolAllocator::fastFree(void* ptr)
     ncnn::fastFree(ptr);
 }
 
+// flag atomics for claiming the thread caches
+#if NCNN_THREADS && !(defined __riscv && !defined __riscv_atomic) && (defined _MSC_VER || defined __GNUC__)
+#if defined _MSC_VER
+static NCNN_FORCEINLINE int atomic_cas_int(volatile int* addr, int expected, int desired)
+{
+    return (int)InterlockedCompareExchange((volatile long*)addr, desired, expected);
+}
+#else
+static NCNN_FORCEINLINE int atomic_cas_int(volatile int* addr, int expected, int desired)
+{
+    return __sync_val_compare_and_swap(addr, expected, desired);
+}
+#endif
+#else
+// thread-unsafe branch
+static NCNN_FORCEINLINE int atomic_cas_int(volatile int* addr, int expected, int desired)
+{
+    int tmp = *addr;
+    if (tmp == expected)
+        *addr = desired;
+    return tmp;
+}
+#endif
+
+// 4 size classes per power of two, from 64 bytes up to 1TB
+// the largest rounding waste is 25%
+#define NCNN_SIZE_CLASS_COUNT 137
+#define NCNN_SIZE_CLASS_MAGIC 0x6e636e6e
+
+static int size_class_index(size_t size)
+{
+    if (size <= 64)
+        return 0;
+
+    // size in (2^e, 2^(e+1)]
+    size_t n = size - 1;
+    int e = 6;
+    while ((n >> (e + 1)) != 0)
+        e++;
+
+    int index = (e - 6) * 4 + (int)((n >> (e - 2)) & 3) + 1;
+    return index < NCNN_SIZE_CLASS_COUNT ? index : -1;
+}
+
+static size_t size_class_bytes(int index)
+{
+    if (index == 0)
+        return 64;
+
+    int e = (index - 1) / 4 + 6;
+    int sub = (index - 1) % 4;
+    return ((size_t)1 << e) + ((size_t)(sub + 1) << (e - 2));
+}
+
+// stored in the aligned prefix before each chunk
+struct size_class_chunk_header
+{
+    void* next;
+    int magic;
+    int size_class; // -1 for chunks too large to pool
+};
+
+static NCNN_FORCEINLINE size_class_chunk_header* chunk_header(void* chunk)
+{
+    return (size_class_chunk_header*)chunk;
+}
+
+static NCNN_FORCEINLINE void* chunk_to_ptr(void* chunk)
+{
+    return (unsigned char*)chunk + NCNN_MALLOC_ALIGN;
+}
+
+static NCNN_FORCEINLINE void* ptr_to_chunk(void* ptr)
+{
+    return (unsigned char*)ptr - NCNN_MALLOC_ALIGN;
+}
+
+// a thread cache is claimed by one thread at a time without waiting
+// threads are spread over the caches by a sticky per-thread index
+struct size_class_thread_cache
+{
+    volatile int owner;
+    int counts[NCNN_SIZE_CLASS_COUNT];
+    void* heads[NCNN_SIZE_CLASS_COUNT];
+
+    size_t hit;
+    size_t miss;
+    int outstanding;
+
+    // keep neighbouring caches off the same cache line
+    char padding[64];
+};
+
+static ThreadLocalStorage tls_size_class_thread_index;
+static int g_size_class_thread_count = 0;
+
+static int get_size_class_thread_index()
+{
+    size_t index = (size_t)tls_size_class_thread_index.get();
+    if (index == 0)
+    {
+        index = (size_t)NCNN_XADD(&g_size_class_thread_count, 1) + 1;
+        tls_size_class_thread_index.set((void*)index);
+    }
+
+    return (int)(index - 1);
+}
+
+class SizeClassPoolAllocatorPrivate
+{
+public:
+    size_class_thread_cache* claim_cache();
+    void release_cache(size_class_thread_cache* cache);
+
+    // push a chain of chunks to the shared list, chunks over the shared limit go back to system
+    void push_shared(int size_class, void* first, void* last, int count);
+
+    // pop a chain of at most max_count chunks from the shared list
+    void* take_shared(int size_class, int max_count);
+
+    int thread_cache_size;
+
+    int cache_count;
+    size_class_thread_cache* caches;
+
+    // shared lists, only touched on thread cache miss and spill
+    // each holds at most (thread_cache_size + 1) * cache_count chunks
+    Mutex shared_locks[NCNN_SIZE_CLASS_COUNT];
+    void* shared_heads[NCNN_SIZE_CLASS_COUNT];
+    int shared_counts[NCNN_SIZE_CLASS_COUNT];
+
+    // statistics of allocations made without a thread cache
+    int shared_hit;
+    int shared_miss;
+    int shared_outstanding;
+};
+
+size_class_thread_cache* SizeClassPoolAllocatorPrivate::claim_cache()
+{
+    int index = get_size_class_thread_index();
+
+    // probe the sticky cache and its neighbour
+    for (int i = 0; i < 2; i++)
+    {
+        size_class_thread_cache* cache = &caches[(index + i) % cache_count];
+        if (cache->owner == 0 && atomic_cas_int(&cache->owner, 0, 1) == 0)
+            return cache;
+    }
+
+    return 0;
+}
+
+void SizeClassPoolAllocatorPrivate::release_cache(size_class_thread_cache* cache)
+{
+    atomic_cas_int(&cache->owner, 1, 0);
+}
+
+void SizeClassPoolAllocatorPrivate::push_shared(int size_class, void* first, void* last, int count)
+{
+    const int shared_limit = (thread_cache_size + 1) * cache_count;
+
+    void* overflow = first;
+
+    shared_locks[size_class].lock();
+
+    // keep the leading chunks that fit
+    int keep = shared_limit - shared_counts[size_class];
+    if (keep > count)
+        keep = count;
+
+    if (keep > 0)
+    {
+        if (keep < count)
+        {
+            last = first;
+            for (int i = 1; i < keep; i++)
+            {
+                last = chunk_header(last)->next;
+            }
+        }
+
+        overflow = chunk_header(last)->next;
+
+        chunk_header(last)->next = shared_heads[size_class];
+        shared_heads[size_class] = first;
+        shared_counts[size_class] += keep;
+    }
+
+    shared_locks[size_class].unlock();
+
+    // the chain may not be terminated, release by count
+    for (int i = keep > 0 ? keep : 0; i < count; i++)
+    {
+        void* next = chunk_header(overflow)->next;
+        ncnn::fastFree(overflow);
+        overflow = next;
+    }
+}
+
+void* SizeClassPoolAllocatorPrivate::take_shared(int size_class, int max_count)
+{
+    shared_locks[size_class].lock();
+
+    void* first = shared_heads[size_class];
+    if (first)
+    {
+        void* last = first;
+        int count = 1;
+        while (count < max_count && chunk_header(last)->next)
+        {
+            last = chunk_header(last)->next;
+            count++;
+        }
+
+        shared_heads[size_class] = chunk_header(last)->next;
+        shared_counts[size_class] -= count;
+
+        chunk_header(last)->next = 0;
+    }
+
+    shared_locks[size_class].unlock();
+
+    return first;
+}
+
+SizeClassPoolAllocator::SizeClassPoolAllocator()
+    : Allocator(), d(new SizeClassPoolAllocatorPrivate)
+{
+    d->thread_cache_size = 4;
+
+    d->cache_count = get_cpu_count() * 2;
+    d->caches = new size_class_thread_cache[d->cache_count];
+    memset(d->caches, 0, sizeof(size_class_thread_cache) * d->cache_count);
+
+    for (int i = 0; i < NCNN_SIZE_CLASS_COUNT; i++)
+    {
+        d->shared_heads[i] = 0;
+        d->shared_counts[i] = 0;
+    }
+
+    d->shared_hit = 0;
+    d->shared_miss = 0;
+    d->shared_outstanding = 0;
+}
+
+SizeClassPoolAllocator::~SizeClassPoolAllocator()
+{
+    clear();
+
+    int outstanding = d->shared_outstanding;
+    for (int i = 0; i < d->cache_count; i++)
+    {
+        outstanding += d->caches[i].outstanding;
+    }
+
+    if (outstanding != 0)
+    {
+        NCNN_LOGE("FATAL ERROR! size class pool allocator destroyed too early, %d chunks still in use", outstanding);
+    }
+
+    delete[] d->caches;
+
+    delete d;
+}
+
+SizeClassPoolAllocator::SizeClassPoolAllocator(const SizeClassPoolAllocator&)
+    : d(0)
+{
+}
+
+SizeClassPoolAllocator& SizeClassPoolAllocator::operator=(const SizeClassPoolAllocator&)
+{
+    return *this;
+}
+
+void SizeClassPoolAllocator::set_thread_cache_size(int count)
+{
+    d->thread_cache_size = count < 0 ? 0 : count;
+}
+
+void SizeClassPoolAllocator::clear()
+{
+    for (int i = 0; i < d->cache_count; i++)
+    {
+        size_class_thread_cache* cache = &d->caches[i];
+
+        // wait for the current holder, which only keeps it for one call
+        while (atomic_cas_int(&cache->owner, 0, 1) != 0)
+        {
+        }
+
+        for (int j = 0; j < NCNN_SIZE_CLASS_COUNT; j++)
+        {
+            void* chunk = cache->heads[j];
+            while (chunk)
+            {
+                void* next = chunk_header(chunk)->next;
+                ncnn::fastFree(chunk);
+                chunk = next;
+            }
+
+            cache->heads[j] = 0;
+            cache->counts[j] = 0;
+        }
+
+        d->release_cache(cache);
+    }
+
+    for (int j = 0; j < NCNN_SIZE_CLASS_COUNT; j++)
+    {
+        void* chunk = d->take_shared(j, d->shared_counts[j]);
+        while (chunk)
+        {
+            void* next = chunk_header(chunk)->next;
+            ncnn::fastFree(chunk);
+            chunk = next;
+        }
+    }
+}
+
+size_t SizeClassPoolAllocator::hit_count() const
+{
+    size_t count = (unsigned int)d->shared_hit;
+    for (int i = 0; i < d->cache_count; i++)
+    {
+        count += d->caches[i].hit;
+    }
+
+    return count;
+}
+
+size_t SizeClassPoolAllocator::miss_count() const
+{
+    size_t count = (unsigned int)d->shared_miss;
+    for (int i = 0; i < d->cache_count; i++)
+    {
+        count += d->caches[i].miss;
+    }
+
+    return count;
+}
+
+size_t SizeClassPoolAllocator::bytes_held() const
+{
+    size_t bytes = 0;
+    for (int j = 0; j < NCNN_SIZE_CLASS_COUNT; j++)
+    {
+        int count = d->shared_counts[j];
+        for (int i = 0; i < d->cache_count; i++)
+        {
+            count += d->caches[i].counts[j];
+        }
+
+        bytes += size_class_bytes(j) * count;
+    }
+
+    return bytes;
+}
+
+void* SizeClassPoolAllocator::fastMalloc(size_t size)
+{
+    const int size_class = size_class_index(size);
+    if (size_class == -1)
+    {
+        // too large to pool
+        void* chunk = ncnn::fastMalloc(size + NCNN_MALLOC_ALIGN);
+        if (!chunk)
+            return 0;
+
+        chunk_header(chunk)->magic = NCNN_SIZE_CLASS_MAGIC;
+        chunk_header(chunk)->size_class = -1;
+
+        NCNN_XADD(&d->shared_miss, 1);
+        NCNN_XADD(&d->shared_outstanding, 1);
+        return chunk_to_ptr(chunk);
+    }
+
+    size_class_thread_cache* cache = d->claim_cache();
+
+    void* chunk = 0;
+    if (cache && cache->heads[size_class])
+    {
+        chunk = cache->heads[size_class];
+        cache->heads[size_class] = chunk_header(chunk)->next;
+        cache->counts[size_class]--;
+    }
+
+    if (!chunk)
+    {
+        // the empty thread cache takes the remaining chunks of the batch
+        chunk = d->take_shared(size_class, cache ? d->thread_cache_size + 1 : 1);
+        if (chunk && cache)
+        {
+            void* rest = chunk_header(chunk)->next;
+            chunk_header(chunk)->next = 0;
+
+            cache->heads[size_class] = rest;
+            while (rest)
+            {
+                cache->counts[size_class]++;
+                rest = chunk_header(rest)->next;
+            }
+        }
+    }
+
+    bool hit = chunk != 0;
+    if (!chunk)
+    {
+        chunk = ncnn::fastMalloc(size_class_bytes(size_class) + NCNN_MALLOC_ALIGN);
+        if (chunk)
+        {
+            chunk_header(chunk)->magic = NCNN_SIZE_CLASS_MAGIC;
+            chunk_header(chunk)->size_class = size_class;
+        }
+    }
+
+    if (cache)
+    {
+        if (hit)
+            cache->hit++;
+        else
+            cache->miss++;
+        if (chunk)
+            cache->outstanding++;
+
+        d->release_cache(cache);
+    }
+    else
+    {
+        NCNN_XADD(hit ? &d->shared_hit : &d->shared_miss, 1);
+        if (chunk)
+            NCNN_XADD(&d->shared_outstanding, 1);
+    }
+
+    return chunk ? chunk_to_ptr(chunk) : 0;
+}
+
+void SizeClassPoolAllocator::fastFree(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    void* chunk = ptr_to_chunk(ptr);
+    if (chunk_header(chunk)->magic != NCNN_SIZE_CLASS_MAGIC)
+    {
+        NCNN_LOGE("FATAL ERROR! size class pool allocator get wild %p", ptr);
+        ncnn::fastFree(ptr);
+        return;
+    }
+
+    const int size_class = chunk_header(chunk)->size_class;
+    if (size_class == -1)
+    {
+        NCNN_XADD(&d->shared_outstanding, -1);
+        ncnn::fastFree(chunk);
+        return;
+    }
+
+    size_class_thread_cache* cache = d->claim_cache();
+    if (!cache)
+    {
+        NCNN_XADD(&d->shared_outstanding, -1);
+        d->push_shared(size_class, chunk, chunk, 1);
+        return;
+    }
+
+    cache->outstanding--;
+
+    chunk_header(chunk)->next = cache->heads[size_class];
+    cache->heads[size_class] = chunk;
+    cache->counts[size_class]++;
+
+    if (cache->counts[size_class] > d->thread_cache_size)
+    {
+        // spill the whole list for other threads
+        void* first = cache->heads[size_class];
+        void* last = first;
+        while (chunk_header(last)->next)
+        {
+            last = chunk_header(last)->next;
+        }
+
+        d->push_shared(size_class, first, last, cache->counts[size_class]);
+
+        cache->heads[size_class] = 0;
+        cache->counts[size_class] = 0;
+    }
+
+    d->release_cache(cache);
+}
+
 #if NCNN_VULKAN
 VkAllocator::VkAllocator(const VulkanDevice* _vkdev)
     : vkdev(_vkdev)
@@ -216,6 +216,41 @@ private:
     UnlockedPoolAllocatorPrivate* const d;
 };
 
+class SizeClassPoolAllocatorPrivate;
+class NCNN_EXPORT SizeClassPoolAllocator : public Allocator
+{
+public:
+    SizeClassPoolAllocator();
+    ~SizeClassPoolAllocator();
+
+    // cached chunks of each size class kept by one thread before spilling to the shared list
+    // the shared list of each size class keeps at most (count + 1) * 2 * cpu count chunks
+    // default count = 4
+    void set_thread_cache_size(int count);
+
+    // release all cached chunks immediately
+    void clear();
+
+    // count of allocations served from cached chunks
+    size_t hit_count() const;
+
+    // count of allocations served from system memory
+    size_t miss_count() const;
+
+    // total bytes of cached chunks
+    size_t bytes_held() const;
+
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+private:
+    SizeClassPoolAllocator(const SizeClassPoolAllocator&);
+    SizeClassPoolAllocator& operator=(const SizeClassPoolAllocator&);
+
+private:
+    SizeClassPoolAllocatorPrivate* const d;
+};
+
 #if NCNN_VULKAN
 
 class VulkanDevice;
@@ -95,6 +95,20 @@ void sleep(unsigned long long int milliseconds)
 #endif
 }
 
+static ThreadLocalStorage tls_profile_kernel_slot;
+
+void profile_kernel(const char* kernel)
+{
+    const char** slot = (const char**)tls_profile_kernel_slot.get();
+    if (slot)
+        *slot = kernel;
+}
+
+void set_profile_kernel_slot(const char** slot)
+{
+    tls_profile_kernel_slot.set((void*)slot);
+}
+
 #if NCNN_BENCHMARK
 
 void benchmark(const Layer* layer, double start, double end)
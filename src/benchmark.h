@@ -27,6 +27,14 @@ NCNN_EXPORT double get_current_time();
 // sleep milliseconds
 NCNN_EXPORT void sleep(unsigned long long int milliseconds = 1000);
 
+// report the kernel path taken by the layer forward running on this thread
+// such as winograd43 / sgemm / packed / int8_sgemm
+// kernel must be a string literal, no-op unless the extractor is profiling
+NCNN_EXPORT void profile_kernel(const char* kernel);
+
+// route profile_kernel() on this thread into slot, pass 0 to stop
+NCNN_EXPORT void set_profile_kernel_slot(const char** slot);
+
 #if NCNN_BENCHMARK
 
 NCNN_EXPORT void benchmark(const Layer* layer, double start, double end);
@@ -188,6 +188,9 @@ static int g_powersave;
 static ncnn::CpuSet g_cpu_affinity_mask_all;
 static ncnn::CpuSet g_cpu_affinity_mask_little;
 static ncnn::CpuSet g_cpu_affinity_mask_big;
+static int g_numa_node_count;
+static int g_numa_node_id[16];
+static ncnn::CpuSet g_numa_node_affinity_mask[16];
 
 // isa info
 #if defined _WIN32
@@ -1572,6 +1575,28 @@ static int set_sched_affinity(const ncnn::CpuSet& thread_affinity_mask)
 
     return 0;
 }
+
+static int get_sched_affinity(ncnn::CpuSet& thread_affinity_mask)
+{
+    // get affinity for thread
+#if defined(__BIONIC__) && !defined(__OHOS__)
+    pid_t pid = gettid();
+#else
+    pid_t pid = syscall(SYS_gettid);
+#endif
+
+    thread_affinity_mask.disable_all();
+
+    // the raw syscall returns the size of the copied mask on success
+    int syscallret = syscall(__NR_sched_getaffinity, pid, sizeof(cpu_set_t), &thread_affinity_mask.cpu_set);
+    if (syscallret < 0)
+    {
+        // handle get error silently
+        return -1;
+    }
+
+    return 0;
+}
 #endif // defined __ANDROID__ || defined __linux__
 
 #if __APPLE__
@@ -1828,6 +1853,77 @@ static void initialize_cpu_thread_affinity_mask(ncnn::CpuSet& mask_all, ncnn::Cp
 #endif
 }
 
+static void initialize_numa_node_affinity_mask()
+{
+    g_numa_node_count = 0;
+
+#if defined __ANDROID__ || defined __linux__
+    for (int node = 0; node < 16; node++)
+    {
+        char path[256];
+        sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+
+        FILE* fp = fopen(path, "rb");
+        if (!fp)
+            continue;
+
+        ncnn::CpuSet& mask = g_numa_node_affinity_mask[g_numa_node_count];
+        mask.disable_all();
+
+        // human-readable list like 0-7,16-23
+        int id0;
+        char sep;
+        int id1;
+
+        int nscan = fscanf(fp, "%d", &id0);
+        if (nscan == 1)
+        {
+            mask.enable(id0);
+
+            while (fscanf(fp, "%c%d", &sep, &id1) == 2)
+            {
+                if (sep == ',')
+                {
+                    mask.enable(id1);
+                }
+                if (sep == '-' && id0 < id1)
+                {
+                    for (int i = id0 + 1; i <= id1; i++)
+                    {
+                        mask.enable(i);
+                    }
+                }
+
+                id0 = id1;
+            }
+        }
+
+        fclose(fp);
+
+        // only the cpus we are allowed to run on, memory-only nodes are skipped
+        for (int i = 0; i < CPU_SETSIZE; i++)
+        {
+            if (mask.is_enabled(i) && !g_cpu_affinity_mask_all.is_enabled(i))
+                mask.disable(i);
+        }
+
+        if (mask.num_enabled() > 0)
+        {
+            g_numa_node_id[g_numa_node_count] = node;
+            g_numa_node_count++;
+        }
+    }
+#endif // defined __ANDROID__ || defined __linux__
+
+    if (g_numa_node_count == 0)
+    {
+        // treat as one node
+        g_numa_node_count = 1;
+        g_numa_node_id[0] = 0;
+        g_numa_node_affinity_mask[0] = g_cpu_affinity_mask_all;
+    }
+}
+
 #if defined __ANDROID__ || defined __linux__
 #if __aarch64__
 union midr_info_t
@@ -2045,27 +2141,6 @@ static unsigned int get_midr_from_register()
     return (unsigned int)midr;
 }
 
-static int get_sched_affinity(ncnn::CpuSet& thread_affinity_mask)
-{
-    // get affinity for thread
-#if defined(__BIONIC__) && !defined(__OHOS__)
-    pid_t pid = gettid();
-#else
-    pid_t pid = syscall(SYS_gettid);
-#endif
-
-    thread_affinity_mask.disable_all();
-
-    int syscallret = syscall(__NR_sched_getaffinity, pid, sizeof(cpu_set_t), &thread_affinity_mask.cpu_set);
-    if (syscallret)
-    {
-        // handle get error silently
-        return -1;
-    }
-
-    return 0;
-}
-
 static int midr_is_a53_a55(unsigned int midr)
 {
     // 0x 41 ? f d03 ? = arm cortex-a53
@@ -2154,6 +2229,7 @@ static void initialize_global_cpu_info()
     g_physical_cpucount = get_physical_cpucount();
     g_powersave = 0;
     initialize_cpu_thread_affinity_mask(g_cpu_affinity_mask_all, g_cpu_affinity_mask_little, g_cpu_affinity_mask_big);
+    initialize_numa_node_affinity_mask();
 
 #if (defined _WIN32 && (__aarch64__ || __arm__)) || ((defined __ANDROID__ || defined __linux__) && __riscv)
     if (!is_being_debugged())
@@ -3111,6 +3187,146 @@ int set_cpu_thread_affinity(const CpuSet& thread_affinity_mask)
 #endif
 }
 
+int set_current_thread_affinity(const CpuSet& thread_affinity_mask)
+{
+    try_initialize_global_cpu_info();
+#if defined __ANDROID__ || defined __linux__ || defined _WIN32 || __APPLE__
+    return set_sched_affinity(thread_affinity_mask);
+#else
+    // TODO
+    (void)thread_affinity_mask;
+    return -1;
+#endif
+}
+
+int get_current_thread_affinity(CpuSet& thread_affinity_mask)
+{
+    try_initialize_global_cpu_info();
+#if defined __ANDROID__ || defined __linux__
+    return get_sched_affinity(thread_affinity_mask);
+#else
+    // TODO
+    thread_affinity_mask.disable_all();
+    return -1;
+#endif
+}
+
+int get_numa_node_count()
+{
+    try_initialize_global_cpu_info();
+    return g_numa_node_count;
+}
+
+const CpuSet& get_numa_node_affinity_mask(int node)
+{
+    try_initialize_global_cpu_info();
+    if (node < 0 || node >= g_numa_node_count)
+    {
+        NCNN_LOGE("numa node %d not found", node);
+
+        // fallback to all cores anyway
+        return g_cpu_affinity_mask_all;
+    }
+
+    return g_numa_node_affinity_mask[node];
+}
+
+#if (defined __ANDROID__ || defined __linux__) && defined __NR_set_mempolicy && defined __NR_get_mempolicy
+// the memory policy of a thread before ncnn changed it, numactl --membind / --interleave included
+struct saved_numa_memory_policy
+{
+    int mode;
+    unsigned long nodemask[16];
+};
+
+static ncnn::ThreadLocalStorage tls_saved_numa_memory_policy;
+#endif
+
+int set_current_thread_numa_memory_policy(int node)
+{
+    try_initialize_global_cpu_info();
+#if (defined __ANDROID__ || defined __linux__) && defined __NR_set_mempolicy && defined __NR_get_mempolicy
+    if (node < -2 || node >= g_numa_node_count)
+    {
+        NCNN_LOGE("numa node %d not found", node);
+        return -1;
+    }
+
+    saved_numa_memory_policy* saved_policy = (saved_numa_memory_policy*)tls_saved_numa_memory_policy.get();
+
+    if (node == -1)
+    {
+        // this thread never changed its policy, keep it
+        if (!saved_policy)
+            return 0;
+
+        int syscallret = syscall(__NR_set_mempolicy, saved_policy->mode, saved_policy->nodemask, sizeof(saved_policy->nodemask) * 8);
+
+        delete saved_policy;
+        tls_saved_numa_memory_policy.set(0);
+
+        if (syscallret)
+        {
+            NCNN_LOGE("set_mempolicy error %d", syscallret);
+            return -1;
+        }
+
+        return 0;
+    }
+
+    if (!saved_policy)
+    {
+        saved_policy = new saved_numa_memory_policy;
+        memset(saved_policy->nodemask, 0, sizeof(saved_policy->nodemask));
+
+        int syscallret = syscall(__NR_get_mempolicy, &saved_policy->mode, saved_policy->nodemask, sizeof(saved_policy->nodemask) * 8, 0, 0);
+        if (syscallret)
+        {
+            NCNN_LOGE("get_mempolicy error %d", syscallret);
+            delete saved_policy;
+            return -1;
+        }
+
+        tls_saved_numa_memory_policy.set((void*)saved_policy);
+    }
+
+    // same values as linux/mempolicy.h
+    const int mpol_preferred = 1;
+    const int mpol_interleave = 3;
+
+    unsigned long nodemask[4] = {0, 0, 0, 0};
+    const int nodemask_bits = (int)sizeof(unsigned long) * 8;
+
+    int mode;
+    if (node == -2)
+    {
+        mode = mpol_interleave;
+        for (int i = 0; i < g_numa_node_count; i++)
+        {
+            nodemask[g_numa_node_id[i] / nodemask_bits] |= 1ul << (g_numa_node_id[i] % nodemask_bits);
+        }
+    }
+    else
+    {
+        // preferred instead of bind, fall back to other nodes when this one is full
+        mode = mpol_preferred;
+        nodemask[g_numa_node_id[node] / nodemask_bits] |= 1ul << (g_numa_node_id[node] % nodemask_bits);
+    }
+
+    int syscallret = syscall(__NR_set_mempolicy, mode, nodemask, sizeof(nodemask) * 8);
+    if (syscallret)
+    {
+        NCNN_LOGE("set_mempolicy error %d", syscallret);
+        return -1;
+    }
+
+    return 0;
+#else
+    (void)node;
+    return node == -1 ? 0 : -1;
+#endif
+}
+
 int is_current_thread_running_on_a53_a55()
 {
     try_initialize_global_cpu_info();
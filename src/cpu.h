@@ -159,6 +159,22 @@ NCNN_EXPORT const CpuSet& get_cpu_thread_affinity_mask(int powersave);
 // set explicit thread affinity
 NCNN_EXPORT int set_cpu_thread_affinity(const CpuSet& thread_affinity_mask);
 
+// set explicit affinity for the calling thread only, openmp threads are untouched
+NCNN_EXPORT int set_current_thread_affinity(const CpuSet& thread_affinity_mask);
+
+// affinity of the calling thread, return 0 if success
+NCNN_EXPORT int get_current_thread_affinity(CpuSet& thread_affinity_mask);
+
+// numa topology, one node with all cpus if unknown
+// the node masks only contain cpus this process is allowed to run on
+NCNN_EXPORT int get_numa_node_count();
+NCNN_EXPORT const CpuSet& get_numa_node_affinity_mask(int node);
+
+// memory placement of the pages the calling thread touches first from now on
+// -1 = back to the policy the thread had before, -2 = interleave across all numa nodes, n = prefer numa node n
+// return 0 if success
+NCNN_EXPORT int set_current_thread_numa_memory_policy(int node);
+
 // runtime thread affinity info
 NCNN_EXPORT int is_current_thread_running_on_a53_a55();
 
@@ -16,6 +16,18 @@
 
 #include <string.h>
 
+#if NCNN_STDIO
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif // NCNN_STDIO
+
 namespace ncnn {
 
 DataReader::DataReader()
@@ -87,6 +99,145 @@ size_t DataReaderFromStdio::read(void* buf, size_t size) const
 }
 #endif // NCNN_STDIO
 
+#if NCNN_STDIO
+class DataReaderFromMmapPrivate
+{
+public:
+    DataReaderFromMmapPrivate()
+        : data(0), size(0), pos(0)
+    {
+#if defined _WIN32
+        file = INVALID_HANDLE_VALUE;
+        mapping = 0;
+#endif
+    }
+    unsigned char* data;
+    size_t size;
+    mutable size_t pos;
+#if defined _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+DataReaderFromMmap::DataReaderFromMmap(const char* path)
+    : DataReader(), d(new DataReaderFromMmapPrivate)
+{
+#if defined _WIN32
+    d->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (d->file == INVALID_HANDLE_VALUE)
+    {
+        NCNN_LOGE("CreateFile %s failed", path);
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(d->file, &file_size) || file_size.QuadPart == 0)
+        return;
+
+    // copy-on-write pages, so that layers can still modify the weight in place
+    d->mapping = CreateFileMappingA(d->file, 0, PAGE_WRITECOPY, 0, 0, 0);
+    if (!d->mapping)
+    {
+        NCNN_LOGE("CreateFileMapping %s failed", path);
+        return;
+    }
+
+    void* ptr = MapViewOfFile(d->mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!ptr)
+    {
+        NCNN_LOGE("MapViewOfFile %s failed", path);
+        return;
+    }
+
+    d->data = (unsigned char*)ptr;
+    d->size = (size_t)file_size.QuadPart;
+#elif defined(__unix__) || defined(__APPLE__)
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        NCNN_LOGE("open %s failed", path);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    // copy-on-write pages, so that layers can still modify the weight in place
+    // untouched pages are shared with the page cache and other processes
+    void* ptr = mmap(0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        NCNN_LOGE("mmap %s failed", path);
+        return;
+    }
+
+    d->data = (unsigned char*)ptr;
+    d->size = (size_t)st.st_size;
+#else
+    NCNN_LOGE("mmap %s not supported on this platform", path);
+#endif
+}
+
+DataReaderFromMmap::~DataReaderFromMmap()
+{
+#if defined _WIN32
+    if (d->data)
+        UnmapViewOfFile(d->data);
+    if (d->mapping)
+        CloseHandle(d->mapping);
+    if (d->file != INVALID_HANDLE_VALUE)
+        CloseHandle(d->file);
+#elif defined(__unix__) || defined(__APPLE__)
+    if (d->data)
+        munmap(d->data, d->size);
+#endif
+
+    delete d;
+}
+
+DataReaderFromMmap::DataReaderFromMmap(const DataReaderFromMmap&)
+    : d(0)
+{
+}
+
+DataReaderFromMmap& DataReaderFromMmap::operator=(const DataReaderFromMmap&)
+{
+    return *this;
+}
+
+bool DataReaderFromMmap::mapped() const
+{
+    return d->data != 0;
+}
+
+size_t DataReaderFromMmap::read(void* buf, size_t size) const
+{
+    size_t nread = std::min(size, d->size - d->pos);
+    if (nread == 0)
+        return 0;
+
+    memcpy(buf, d->data + d->pos, nread);
+    d->pos += nread;
+    return nread;
+}
+
+size_t DataReaderFromMmap::reference(size_t size, const void** buf) const
+{
+    if (size > d->size - d->pos)
+        return 0;
+
+    *buf = d->data + d->pos;
+    d->pos += size;
+    return size;
+}
+#endif // NCNN_STDIO
+
 class DataReaderFromMemoryPrivate
 {
 public:
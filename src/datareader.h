@@ -72,6 +72,32 @@ private:
 };
 #endif // NCNN_STDIO
 
+#if NCNN_STDIO
+class DataReaderFromMmapPrivate;
+class NCNN_EXPORT DataReaderFromMmap : public DataReader
+{
+public:
+    // map the whole file into memory
+    // model data is referenced from the mapped pages instead of being copied
+    // so this reader should be retained when the referenced weight is used
+    explicit DataReaderFromMmap(const char* path);
+    virtual ~DataReaderFromMmap();
+
+    // return true if file mapping succeeded
+    bool mapped() const;
+
+    virtual size_t read(void* buf, size_t size) const;
+    virtual size_t reference(size_t size, const void** buf) const;
+
+private:
+    DataReaderFromMmap(const DataReaderFromMmap&);
+    DataReaderFromMmap& operator=(const DataReaderFromMmap&);
+
+private:
+    DataReaderFromMmapPrivate* const d;
+};
+#endif // NCNN_STDIO
+
 class DataReaderFromMemoryPrivate;
 class NCNN_EXPORT DataReaderFromMemory : public DataReader
 {
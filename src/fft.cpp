@@ -0,0 +1,581 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "fft.h"
+
+#include <string.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif // __ARM_NEON
+
+namespace ncnn {
+
+// mixed radix stockham autosort transform
+// each stage reads n points as r interleaved subsequences of length m = n / r with stride s
+// and writes r * m butterflies multiplied by exp(-2 pi i p k / n)
+// the result comes out in natural order without bit reversal
+struct FFTStage
+{
+    int r;
+    int n;
+    int s;
+
+    // [m, r - 1] twiddles as re im pairs
+    std::vector<float> twiddles;
+
+    // exp(-2 pi i j / r) for the direct dft stage
+    std::vector<float> roots;
+};
+
+class FFTPlan
+{
+public:
+    FFTPlan();
+
+    int create(int n);
+
+    // in and out must not overlap
+    // work holds 2 * n + 2 * max_radix floats
+    void forward(const float* in, float* out, float* work) const;
+
+public:
+    int n;
+    int max_radix;
+    std::vector<FFTStage> stages;
+};
+
+FFTPlan::FFTPlan()
+{
+    n = 0;
+    max_radix = 1;
+}
+
+int FFTPlan::create(int _n)
+{
+    n = _n;
+    max_radix = 1;
+    stages.clear();
+
+    if (n <= 0)
+        return -1;
+
+    // prefer radix-4, then radix-2 and radix-3, then any remaining prime
+    std::vector<int> factors;
+    {
+        int v = n;
+        while (v % 4 == 0)
+        {
+            factors.push_back(4);
+            v /= 4;
+        }
+        while (v % 2 == 0)
+        {
+            factors.push_back(2);
+            v /= 2;
+        }
+        for (int p = 3; v > 1; p += 2)
+        {
+            if (p * p > v)
+                p = v;
+
+            while (v % p == 0)
+            {
+                factors.push_back(p);
+                v /= p;
+            }
+        }
+    }
+
+    int stage_n = n;
+    int s = 1;
+    for (size_t i = 0; i < factors.size(); i++)
+    {
+        const int r = factors[i];
+        const int m = stage_n / r;
+
+        FFTStage stage;
+        stage.r = r;
+        stage.n = stage_n;
+        stage.s = s;
+        stage.twiddles.resize(m * (r - 1) * 2);
+        for (int p = 0; p < m; p++)
+        {
+            for (int k = 1; k < r; k++)
+            {
+                const double angle = -2 * 3.14159265358979323846 * p * k / stage_n;
+                stage.twiddles[(p * (r - 1) + k - 1) * 2] = cosf(angle);
+                stage.twiddles[(p * (r - 1) + k - 1) * 2 + 1] = sinf(angle);
+            }
+        }
+
+        if (r > 4)
+        {
+            stage.roots.resize(r * 2);
+            for (int j = 0; j < r; j++)
+            {
+                stage.roots[j * 2] = cosf(-2 * 3.14159265358979323846 * j / r);
+                stage.roots[j * 2 + 1] = sinf(-2 * 3.14159265358979323846 * j / r);
+            }
+        }
+
+        stages.push_back(stage);
+
+        max_radix = std::max(max_radix, r);
+        stage_n = m;
+        s *= r;
+    }
+
+    return 0;
+}
+
+static inline void cmul(float ar, float ai, float br, float bi, float* out)
+{
+    out[0] = ar * br - ai * bi;
+    out[1] = ar * bi + ai * br;
+}
+
+#if __SSE2__
+// two complex numbers times one complex number
+static inline __m128 _mm_cmul_ps(__m128 _a, float wr, float wi)
+{
+    __m128 _swap = _mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_add_ps(_mm_mul_ps(_a, _mm_set1_ps(wr)), _mm_mul_ps(_swap, _mm_setr_ps(-wi, wi, -wi, wi)));
+}
+
+// multiply by -i
+static inline __m128 _mm_cmul_negi_ps(__m128 _a)
+{
+    __m128 _swap = _mm_shuffle_ps(_a, _a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_mul_ps(_swap, _mm_setr_ps(1.f, -1.f, 1.f, -1.f));
+}
+#endif // __SSE2__
+
+#if __ARM_NEON
+static inline float32x4_t vcmulq_f32(float32x4_t _a, float wr, float wi)
+{
+    float32x4_t _swap = vrev64q_f32(_a);
+    float32x4_t _wi = vcombine_f32(vset_lane_f32(wi, vdup_n_f32(-wi), 1), vset_lane_f32(wi, vdup_n_f32(-wi), 1));
+    return vmlaq_f32(vmulq_n_f32(_a, wr), _swap, _wi);
+}
+
+static inline float32x4_t vcmulq_negi_f32(float32x4_t _a)
+{
+    const float signs[4] = {1.f, -1.f, 1.f, -1.f};
+    return vmulq_f32(vrev64q_f32(_a), vld1q_f32(signs));
+}
+#endif // __ARM_NEON
+
+static void fft_stage_radix2(const FFTStage& stage, const float* x, float* y)
+{
+    const int s = stage.s;
+    const int m = stage.n / 2;
+
+    for (int p = 0; p < m; p++)
+    {
+        const float w1r = stage.twiddles[p * 2];
+        const float w1i = stage.twiddles[p * 2 + 1];
+
+        const float* x0 = x + (s * p) * 2;
+        const float* x1 = x + (s * (p + m)) * 2;
+        float* y0 = y + (s * (2 * p)) * 2;
+        float* y1 = y + (s * (2 * p + 1)) * 2;
+
+        int q = 0;
+#if __SSE2__
+        for (; q + 1 < s; q += 2)
+        {
+            __m128 _a0 = _mm_loadu_ps(x0 + q * 2);
+            __m128 _a1 = _mm_loadu_ps(x1 + q * 2);
+            _mm_storeu_ps(y0 + q * 2, _mm_add_ps(_a0, _a1));
+            _mm_storeu_ps(y1 + q * 2, _mm_cmul_ps(_mm_sub_ps(_a0, _a1), w1r, w1i));
+        }
+#endif // __SSE2__
+#if __ARM_NEON
+        for (; q + 1 < s; q += 2)
+        {
+            float32x4_t _a0 = vld1q_f32(x0 + q * 2);
+            float32x4_t _a1 = vld1q_f32(x1 + q * 2);
+            vst1q_f32(y0 + q * 2, vaddq_f32(_a0, _a1));
+            vst1q_f32(y1 + q * 2, vcmulq_f32(vsubq_f32(_a0, _a1), w1r, w1i));
+        }
+#endif // __ARM_NEON
+        for (; q < s; q++)
+        {
+            const float a0r = x0[q * 2];
+            const float a0i = x0[q * 2 + 1];
+            const float a1r = x1[q * 2];
+            const float a1i = x1[q * 2 + 1];
+
+            y0[q * 2] = a0r + a1r;
+            y0[q * 2 + 1] = a0i + a1i;
+            cmul(a0r - a1r, a0i - a1i, w1r, w1i, y1 + q * 2);
+        }
+    }
+}
+
+static void fft_stage_radix3(const FFTStage& stage, const float* x, float* y)
+{
+    const int s = stage.s;
+    const int m = stage.n / 3;
+
+    // sin(2 pi / 3)
+    const float s3 = 0.86602540378443864676f;
+
+    for (int p = 0; p < m; p++)
+    {
+        const float* w = &stage.twiddles[p * 2 * 2];
+
+        const float* x0 = x + (s * p) * 2;
+        const float* x1 = x + (s * (p + m)) * 2;
+        const float* x2 = x + (s * (p + m * 2)) * 2;
+        float* y0 = y + (s * (3 * p)) * 2;
+        float* y1 = y + (s * (3 * p + 1)) * 2;
+        float* y2 = y + (s * (3 * p + 2)) * 2;
+
+        for (int q = 0; q < s; q++)
+        {
+            const float a0r = x0[q * 2];
+            const float a0i = x0[q * 2 + 1];
+            const float tr = x1[q * 2] + x2[q * 2];
+            const float ti = x1[q * 2 + 1] + x2[q * 2 + 1];
+            const float dr = (x1[q * 2] - x2[q * 2]) * s3;
+            const float di = (x1[q * 2 + 1] - x2[q * 2 + 1]) * s3;
+
+            const float mr = a0r - 0.5f * tr;
+            const float mi = a0i - 0.5f * ti;
+
+            y0[q * 2] = a0r + tr;
+            y0[q * 2 + 1] = a0i + ti;
+            cmul(mr + di, mi - dr, w[0], w[1], y1 + q * 2);
+            cmul(mr - di, mi + dr, w[2], w[3], y2 + q * 2);
+        }
+    }
+}
+
+static void fft_stage_radix4(const FFTStage& stage, const float* x, float* y)
+{
+    const int s = stage.s;
+    const int m = stage.n / 4;
+
+    for (int p = 0; p < m; p++)
+    {
+        const float* w = &stage.twiddles[p * 3 * 2];
+
+        const float* x0 = x + (s * p) * 2;
+        const float* x1 = x + (s * (p + m)) * 2;
+        const float* x2 = x + (s * (p + m * 2)) * 2;
+        const float* x3 = x + (s * (p + m * 3)) * 2;
+        float* y0 = y + (s * (4 * p)) * 2;
+        float* y1 = y + (s * (4 * p + 1)) * 2;
+        float* y2 = y + (s * (4 * p + 2)) * 2;
+        float* y3 = y + (s * (4 * p + 3)) * 2;
+
+        int q = 0;
+#if __SSE2__
+        for (; q + 1 < s; q += 2)
+        {
+            __m128 _a0 = _mm_loadu_ps(x0 + q * 2);
+            __m128 _a1 = _mm_loadu_ps(x1 + q * 2);
+            __m128 _a2 = _mm_loadu_ps(x2 + q * 2);
+            __m128 _a3 = _mm_loadu_ps(x3 + q * 2);
+            __m128 _t0 = _mm_add_ps(_a0, _a2);
+            __m128 _t1 = _mm_sub_ps(_a0, _a2);
+            __m128 _t2 = _mm_add_ps(_a1, _a3);
+            __m128 _t3 = _mm_cmul_negi_ps(_mm_sub_ps(_a1, _a3));
+            _mm_storeu_ps(y0 + q * 2, _mm_add_ps(_t0, _t2));
+            _mm_storeu_ps(y1 + q * 2, _mm_cmul_ps(_mm_add_ps(_t1, _t3), w[0], w[1]));
+            _mm_storeu_ps(y2 + q * 2, _mm_cmul_ps(_mm_sub_ps(_t0, _t2), w[2], w[3]));
+            _mm_storeu_ps(y3 + q * 2, _mm_cmul_ps(_mm_sub_ps(_t1, _t3), w[4], w[5]));
+        }
+#endif // __SSE2__
+#if __ARM_NEON
+        for (; q + 1 < s; q += 2)
+        {
+            float32x4_t _a0 = vld1q_f32(x0 + q * 2);
+            float32x4_t _a1 = vld1q_f32(x1 + q * 2);
+            float32x4_t _a2 = vld1q_f32(x2 + q * 2);
+            float32x4_t _a3 = vld1q_f32(x3 + q * 2);
+            float32x4_t _t0 = vaddq_f32(_a0, _a2);
+            float32x4_t _t1 = vsubq_f32(_a0, _a2);
+            float32x4_t _t2 = vaddq_f32(_a1, _a3);
+            float32x4_t _t3 = vcmulq_negi_f32(vsubq_f32(_a1, _a3));
+            vst1q_f32(y0 + q * 2, vaddq_f32(_t0, _t2));
+            vst1q_f32(y1 + q * 2, vcmulq_f32(vaddq_f32(_t1, _t3), w[0], w[1]));
+            vst1q_f32(y2 + q * 2, vcmulq_f32(vsubq_f32(_t0, _t2), w[2], w[3]));
+            vst1q_f32(y3 + q * 2, vcmulq_f32(vsubq_f32(_t1, _t3), w[4], w[5]));
+        }
+#endif // __ARM_NEON
+        for (; q < s; q++)
+        {
+            const float t0r = x0[q * 2] + x2[q * 2];
+            const float t0i = x0[q * 2 + 1] + x2[q * 2 + 1];
+            const float t1r = x0[q * 2] - x2[q * 2];
+            const float t1i = x0[q * 2 + 1] - x2[q * 2 + 1];
+            const float t2r = x1[q * 2] + x3[q * 2];
+            const float t2i = x1[q * 2 + 1] + x3[q * 2 + 1];
+            // -i * (a1 - a3)
+            const float t3r = x1[q * 2 + 1] - x3[q * 2 + 1];
+            const float t3i = x3[q * 2] - x1[q * 2];
+
+            y0[q * 2] = t0r + t2r;
+            y0[q * 2 + 1] = t0i + t2i;
+            cmul(t1r + t3r, t1i + t3i, w[0], w[1], y1 + q * 2);
+            cmul(t0r - t2r, t0i - t2i, w[2], w[3], y2 + q * 2);
+            cmul(t1r - t3r, t1i - t3i, w[4], w[5], y3 + q * 2);
+        }
+    }
+}
+
+static void fft_stage_generic(const FFTStage& stage, const float* x, float* y, float* a)
+{
+    const int r = stage.r;
+    const int s = stage.s;
+    const int m = stage.n / r;
+
+    const float* roots = &stage.roots[0];
+
+    for (int p = 0; p < m; p++)
+    {
+        const float* w = &stage.twiddles[p * (r - 1) * 2];
+
+        for (int q = 0; q < s; q++)
+        {
+            for (int j = 0; j < r; j++)
+            {
+                a[j * 2] = x[(q + s * (p + j * m)) * 2];
+                a[j * 2 + 1] = x[(q + s * (p + j * m)) * 2 + 1];
+            }
+
+            for (int k = 0; k < r; k++)
+            {
+                float sumr = 0.f;
+                float sumi = 0.f;
+                int jk = 0;
+                for (int j = 0; j < r; j++)
+                {
+                    const float wr = roots[jk * 2];
+                    const float wi = roots[jk * 2 + 1];
+                    sumr += a[j * 2] * wr - a[j * 2 + 1] * wi;
+                    sumi += a[j * 2] * wi + a[j * 2 + 1] * wr;
+
+                    jk += k;
+                    if (jk >= r)
+                        jk -= r;
+                }
+
+                float* yk = y + (q + s * (r * p + k)) * 2;
+                if (k == 0)
+                {
+                    yk[0] = sumr;
+                    yk[1] = sumi;
+                }
+                else
+                {
+                    cmul(sumr, sumi, w[(k - 1) * 2], w[(k - 1) * 2 + 1], yk);
+                }
+            }
+        }
+    }
+}
+
+void FFTPlan::forward(const float* in, float* out, float* work) const
+{
+    const int stage_count = (int)stages.size();
+    if (stage_count == 0)
+    {
+        memcpy(out, in, n * 2 * sizeof(float));
+        return;
+    }
+
+    float* buffer = work;
+    float* scratch = work + n * 2;
+
+    const float* x = in;
+    for (int i = 0; i < stage_count; i++)
+    {
+        // ping-pong so that the last stage lands in out
+        float* y = (stage_count - 1 - i) % 2 == 0 ? out : buffer;
+
+        const FFTStage& stage = stages[i];
+        if (stage.r == 4)
+            fft_stage_radix4(stage, x, y);
+        else if (stage.r == 2)
+            fft_stage_radix2(stage, x, y);
+        else if (stage.r == 3)
+            fft_stage_radix3(stage, x, y);
+        else
+            fft_stage_generic(stage, x, y, scratch);
+
+        x = y;
+    }
+}
+
+class FFTPrivate
+{
+public:
+    int n;
+
+    // complex transform of n points
+    FFTPlan plan;
+
+    // complex transform of n / 2 points for the even size real transform
+    FFTPlan half_plan;
+
+    // exp(-2 pi i k / n) for k in [0, n / 2]
+    std::vector<float> real_twiddles;
+};
+
+FFT::FFT()
+    : d(new FFTPrivate)
+{
+    d->n = 0;
+}
+
+FFT::~FFT()
+{
+    delete d;
+}
+
+FFT::FFT(const FFT&)
+    : d(0)
+{
+}
+
+FFT& FFT::operator=(const FFT&)
+{
+    return *this;
+}
+
+int FFT::create(int n)
+{
+    d->n = n;
+
+    int ret = d->plan.create(n);
+    if (ret != 0)
+        return ret;
+
+    if (n % 2 == 0)
+    {
+        ret = d->half_plan.create(n / 2);
+        if (ret != 0)
+            return ret;
+
+        d->real_twiddles.resize((n / 2 + 1) * 2);
+        for (int k = 0; k <= n / 2; k++)
+        {
+            d->real_twiddles[k * 2] = cosf(-2 * 3.14159265358979323846 * k / n);
+            d->real_twiddles[k * 2 + 1] = sinf(-2 * 3.14159265358979323846 * k / n);
+        }
+    }
+
+    return 0;
+}
+
+int FFT::size() const
+{
+    return d->n;
+}
+
+int FFT::workspace_size() const
+{
+    // input copy + output copy + ping-pong buffer + direct dft scratch
+    return d->n * 6 + d->plan.max_radix * 2;
+}
+
+void FFT::forward(const float* in, float* out, float* workspace) const
+{
+    const int n = d->n;
+
+    if (in == out)
+    {
+        memcpy(workspace, in, n * 2 * sizeof(float));
+        in = workspace;
+    }
+
+    d->plan.forward(in, out, workspace + n * 2);
+}
+
+void FFT::inverse(const float* in, float* out, float* workspace) const
+{
+    const int n = d->n;
+
+    // conj(fft(conj(x)))
+    float* x = workspace;
+    for (int i = 0; i < n; i++)
+    {
+        x[i * 2] = in[i * 2];
+        x[i * 2 + 1] = -in[i * 2 + 1];
+    }
+
+    d->plan.forward(x, out, workspace + n * 2);
+
+    for (int i = 0; i < n; i++)
+    {
+        out[i * 2 + 1] = -out[i * 2 + 1];
+    }
+}
+
+void FFT::forward_real(const float* in, float* out, float* workspace) const
+{
+    const int n = d->n;
+
+    if (n % 2 == 1)
+    {
+        // complex transform with zero imaginary part
+        float* x = workspace;
+        float* z = workspace + n * 2;
+        for (int i = 0; i < n; i++)
+        {
+            x[i * 2] = in[i];
+            x[i * 2 + 1] = 0.f;
+        }
+
+        d->plan.forward(x, z, workspace + n * 4);
+        memcpy(out, z, (n / 2 + 1) * 2 * sizeof(float));
+        return;
+    }
+
+    // pack even samples as real and odd samples as imaginary part
+    // the real input memory layout is exactly that complex sequence of n / 2 points
+    const int m = n / 2;
+    float* z = workspace;
+    d->half_plan.forward(in, z, workspace + m * 2);
+
+    const float* w = &d->real_twiddles[0];
+    for (int k = 0; k <= m; k++)
+    {
+        const int k0 = k == m ? 0 : k;
+        const int k1 = k == 0 ? 0 : m - k;
+
+        const float zr = z[k0 * 2];
+        const float zi = z[k0 * 2 + 1];
+        const float cr = z[k1 * 2];
+        const float ci = -z[k1 * 2 + 1];
+
+        // spectrum of the even samples and of the odd samples
+        const float er = (zr + cr) * 0.5f;
+        const float ei = (zi + ci) * 0.5f;
+        const float odr = (zi - ci) * 0.5f;
+        const float odi = (cr - zr) * 0.5f;
+
+        out[k * 2] = er + odr * w[k * 2] - odi * w[k * 2 + 1];
+        out[k * 2 + 1] = ei + odr * w[k * 2 + 1] + odi * w[k * 2];
+    }
+}
+
+} // namespace ncnn
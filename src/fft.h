@@ -0,0 +1,64 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_FFT_H
+#define NCNN_FFT_H
+
+#include "platform.h"
+
+namespace ncnn {
+
+// discrete fourier transform plan of any size
+// factors 2 3 4 are computed with dedicated butterflies, other primes with a direct dft stage
+// twiddle factors are computed once in create(), transforms are const and thread-safe
+// complex data is stored as interleaved re im float pairs
+class FFTPrivate;
+class NCNN_EXPORT FFT
+{
+public:
+    FFT();
+    ~FFT();
+
+    // prepare the plan for n points
+    // return 0 if success
+    int create(int n);
+
+    int size() const;
+
+    // number of floats required for the workspace argument
+    int workspace_size() const;
+
+    // complex n -> complex n
+    // X[k] = sum x[j] * exp(-2 pi i j k / n)
+    void forward(const float* in, float* out, float* workspace) const;
+
+    // complex n -> complex n, without the 1 / n normalization
+    // x[j] = sum X[k] * exp(2 pi i j k / n)
+    void inverse(const float* in, float* out, float* workspace) const;
+
+    // real n -> complex n / 2 + 1
+    // the redundant conjugate half of the spectrum is not produced
+    void forward_real(const float* in, float* out, float* workspace) const;
+
+private:
+    FFT(const FFT&);
+    FFT& operator=(const FFT&);
+
+private:
+    FFTPrivate* const d;
+};
+
+} // namespace ncnn
+
+#endif // NCNN_FFT_H
@@ -39,6 +39,8 @@ Layer::Layer()
 
     featmask = 0;
 
+    tuning_variant = 0;
+
 #if NCNN_VULKAN
     vkdev = 0;
 #endif // NCNN_VULKAN
@@ -71,6 +73,16 @@ int Layer::destroy_pipeline(const Option& /*opt*/)
     return 0;
 }
 
+int Layer::pipeline_weights(std::vector<Mat*>& /*weights*/)
+{
+    return 0;
+}
+
+int Layer::tuning_variants(std::vector<int>& /*variants*/, const Option& /*opt*/) const
+{
+    return 0;
+}
+
 int Layer::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
     if (!support_inplace)
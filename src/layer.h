@@ -52,6 +52,17 @@ public:
     // return 0 if success
     virtual int destroy_pipeline(const Option& opt);
 
+    // collect the weight mats prepared by create_pipeline, in a fixed order
+    // create_pipeline skips preparing a mat that is already filled, such as restored from weight cache
+    // return 0 if success
+    virtual int pipeline_weights(std::vector<Mat*>& weights);
+
+    // collect the kernel variants create_pipeline could be tuned to for the shape hints and option
+    // variant 0 is the built-in heuristic, the others are layer specific
+    // leave empty if not tunable
+    // return 0 if success
+    virtual int tuning_variants(std::vector<int>& variants, const Option& opt) const;
+
 public:
     // one input and one output blob
     bool one_blob_only;
@@ -95,6 +106,9 @@ public:
     // feature disabled set
     int featmask;
 
+    // kernel variant picked by auto tuning, 0 for built-in heuristic
+    int tuning_variant;
+
 public:
     // implement inference
     // return 0 if success
@@ -63,6 +63,18 @@ static inline float32x4_t activation_ps(float32x4_t _v, int activation_type, con
         _ans = vminq_f32(_ans, _one);
         _v = vmulq_f32(_ans, _v);
     }
+    else if (activation_type == 7)
+    {
+        // y = 0.5x * (1 + tanh(sqrt(2/Pi) * (x + 0.044715x^3)))
+        float32x4_t _cube = vmulq_f32(vmulq_f32(_v, _v), _v);
+        float32x4_t _t = vmulq_n_f32(vmlaq_n_f32(_v, _cube, 0.044715f), 0.79788452f);
+        _t = vaddq_f32(tanh_ps(_t), vdupq_n_f32(1.f));
+        _v = vmulq_f32(vmulq_n_f32(_v, 0.5f), _t);
+    }
+    else if (activation_type == 8)
+    {
+        _v = vmulq_f32(_v, sigmoid_ps(_v));
+    }
 
     return _v;
 }
@@ -112,6 +124,11 @@ static inline __fp16 activation_ss_f16(__fp16 v, int activation_type, const ncnn
         else
             v = v * (v * alpha + beta);
     }
+    else if (activation_type == 7 || activation_type == 8)
+    {
+        // evaluate in fp32, the cube in gelu overflows fp16 early
+        v = (__fp16)activation_ss((float)v, activation_type, activation_params);
+    }
 
     return v;
 }
@@ -162,6 +179,11 @@ static inline float16x4_t activation_ps_f16(float16x4_t _v, int activation_type,
         _ans = vmin_f16(_ans, _one);
         _v = vmul_f16(_ans, _v);
     }
+    else if (activation_type == 7 || activation_type == 8)
+    {
+        // evaluate in fp32, the cube in gelu overflows fp16 early
+        _v = vcvt_f16_f32(activation_ps(vcvt_f32_f16(_v), activation_type, activation_params));
+    }
 
     return _v;
 }
@@ -213,6 +235,13 @@ static inline float16x8_t activation_ps_f16(float16x8_t _v, int activation_type,
         _ans = vminq_f16(_ans, _one);
         _v = vmulq_f16(_ans, _v);
     }
+    else if (activation_type == 7 || activation_type == 8)
+    {
+        // evaluate in fp32, the cube in gelu overflows fp16 early
+        float32x4_t _v0 = activation_ps(vcvt_f32_f16(vget_low_f16(_v)), activation_type, activation_params);
+        float32x4_t _v1 = activation_ps(vcvt_f32_f16(vget_high_f16(_v)), activation_type, activation_params);
+        _v = vcombine_f16(vcvt_f16_f32(_v0), vcvt_f16_f32(_v1));
+    }
     return _v;
 }
 #endif // __ARM_FEATURE_FP16_VECTOR_ARITHMETIC
@@ -137,6 +137,13 @@ int Convolution_arm::create_pipeline(const Option& opt)
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
+        if (int8_dynamic_quantize)
+        {
+            // no kernel for runtime input scales here,
+            // forward() runs the reference int8 path instead
+            return 0;
+        }
+
         return create_pipeline_int8_arm(opt);
     }
 #endif
@@ -336,6 +343,36 @@ int Convolution_arm::destroy_pipeline(const Option& opt)
 int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
+    if (opt.use_int8_inference && int8_dynamic_quantize)
+    {
+        Mat bottom_blob_unpacked = bottom_blob;
+        if (bottom_blob.elempack != 1)
+        {
+            Option opt_pack1 = opt;
+            opt_pack1.blob_allocator = opt.workspace_allocator;
+
+            convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_pack1);
+        }
+
+        Mat bottom_blob_unpacked_fp32 = bottom_blob_unpacked;
+        if (bottom_blob_unpacked.elembits() == 16)
+        {
+            Option opt_pack1 = opt;
+            opt_pack1.blob_allocator = opt.workspace_allocator;
+
+#if NCNN_ARM82
+            if (support_fp16_storage && opt.use_fp16_storage)
+                cast_float16_to_float32(bottom_blob_unpacked, bottom_blob_unpacked_fp32, opt_pack1);
+            else
+#endif
+                cast_bfloat16_to_float32(bottom_blob_unpacked, bottom_blob_unpacked_fp32, opt_pack1);
+        }
+
+        Option opt_unpacked = opt;
+        opt_unpacked.use_packing_layout = false;
+        return Convolution::forward_int8(bottom_blob_unpacked_fp32, top_blob, opt_unpacked);
+    }
+
     if (opt.use_int8_inference && int8_scale_term)
     {
         return forward_int8_arm(bottom_blob, top_blob, opt);
@@ -437,6 +474,7 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     {
         if (outw >= dilation_w && outh >= dilation_h)
         {
+            profile_kernel("dilation");
             return forwardDilation_arm(bottom_blob_bordered, top_blob, opt);
         }
     }
@@ -491,14 +529,17 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         int ret = 0;
         if (prefer_winograd23)
         {
+            profile_kernel("winograd23");
             ret = conv3x3s1_winograd23(bottom_blob_bordered, top_blob, weight_winograd23_data, bias_data, _nT, opt);
         }
         else if (prefer_winograd43)
         {
+            profile_kernel("winograd43");
             ret = conv3x3s1_winograd43(bottom_blob_bordered, top_blob, weight_winograd43_data, bias_data, _nT, opt);
         }
         else if (prefer_winograd63)
         {
+            profile_kernel("winograd63");
             ret = conv3x3s1_winograd63(bottom_blob_bordered, top_blob, weight_winograd63_data, bias_data, _nT, opt);
         }
         else
@@ -562,6 +603,7 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
             NCNN_LOGE("opt.num_threads %d changed, convolution gemm will use load-time value %d", opt.num_threads, nT);
         }
 
+        profile_kernel("sgemm");
         int ret = convolution_im2col_gemm(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, _nT, opt);
         if (ret != 0)
             return ret;
@@ -573,6 +615,9 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         return 0;
     }
 
+    // hand-written kernels below, convolution_packed as fallback
+    profile_kernel("direct");
+
 #if NCNN_GNU_INLINE_ASM
 #if __ARM_NEON
     if (elempack == 4 && out_elempack == 4)
@@ -606,6 +651,7 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         }
         else
         {
+            profile_kernel("packed");
             convolution_packed(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
@@ -641,6 +687,7 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         }
         else
         {
+            profile_kernel("packed");
             convolution_packed(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
@@ -648,6 +695,7 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     if (elempack == 4 && out_elempack == 1)
     {
         {
+            profile_kernel("packed");
             convolution_packed(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
@@ -729,11 +777,13 @@ int Convolution_arm::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         }
         else
         {
+            profile_kernel("packed");
             convolution_packed(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
 #else  // NCNN_GNU_INLINE_ASM
     {
+        profile_kernel("packed");
         convolution_packed(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
     }
 #endif // NCNN_GNU_INLINE_ASM
@@ -1151,6 +1201,7 @@ int Convolution_arm::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const
             NCNN_LOGE("opt.num_threads %d changed, convolution gemm will use load-time value %d", opt.num_threads, nT);
         }
 
+        profile_kernel("sgemm");
         int ret = convolution_im2col_gemm_bf16s(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, _nT, opt);
         if (ret != 0)
             return ret;
@@ -1162,6 +1213,9 @@ int Convolution_arm::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const
         return 0;
     }
 
+    // hand-written kernels below, convolution_packed as fallback
+    profile_kernel("direct");
+
 #if NCNN_GNU_INLINE_ASM
 #if __ARM_NEON
     if (elempack == 4 && out_elempack == 4)
@@ -1195,6 +1249,7 @@ int Convolution_arm::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const
         }
         else
         {
+            profile_kernel("packed");
             convolution_packed_bf16s(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
@@ -1230,6 +1285,7 @@ int Convolution_arm::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const
         }
         else
         {
+            profile_kernel("packed");
             convolution_packed_bf16s(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
@@ -1237,6 +1293,7 @@ int Convolution_arm::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const
     if (elempack == 4 && out_elempack == 1)
     {
         {
+            profile_kernel("packed");
             convolution_packed_bf16s(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
@@ -1245,11 +1302,13 @@ int Convolution_arm::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const
     if (elempack == 1 && out_elempack == 1)
     {
         {
+            profile_kernel("packed");
             convolution_packed_bf16s(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
 #else  // NCNN_GNU_INLINE_ASM
     {
+        profile_kernel("packed");
         convolution_packed_bf16s(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
     }
 #endif // NCNN_GNU_INLINE_ASM
@@ -1413,16 +1472,24 @@ int Convolution_arm::forward_int8_arm(const Mat& bottom_blob, Mat& top_blob, con
     if (opt.use_winograd_convolution && prefer_winograd)
     {
         if (opt.use_winograd43_convolution && !weight_winograd43_data.empty())
+        {
+            profile_kernel("int8_winograd43");
             ret = conv3x3s1_winograd43_int8(bottom_blob_bordered, top_blob_int32, weight_winograd43_data, _nT, opt);
+        }
         else
+        {
+            profile_kernel("int8_winograd23");
             ret = conv3x3s1_winograd23_int8(bottom_blob_bordered, top_blob_int32, weight_winograd23_data, _nT, opt);
+        }
     }
     else if (opt.use_sgemm_convolution)
     {
+        profile_kernel("int8_sgemm");
         ret = convolution_im2col_gemm_int8(bottom_blob_bordered, top_blob_int32, weight_sgemm_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, _nT, opt);
     }
     else
     {
+        profile_kernel("int8_packed");
         convolution_packed_int8(bottom_blob_bordered, top_blob_int32, weight_data_tm, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
     }
     if (ret != 0)
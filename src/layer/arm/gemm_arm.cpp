@@ -19,6 +19,7 @@
 #include "neon_mathfun.h"
 #endif // __ARM_NEON
 
+#include "arm_activation.h"
 #include "arm_usability.h"
 
 #include "cpu.h"
@@ -50,6 +51,8 @@ Gemm_arm::Gemm_arm()
     support_bf16_storage = true;
 #endif
 
+    activation = 0;
+
     nT = 0;
 }
 
@@ -4246,6 +4249,8 @@ static int gemm_AT_BT_arm(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_b
 
 int Gemm_arm::create_pipeline(const Option& opt)
 {
+    activation = create_activation_layer(activation_type, activation_params, opt);
+
 #if NCNN_INT8
     if (int8_scale_term)
     {
@@ -4398,7 +4403,33 @@ int Gemm_arm::create_pipeline(const Option& opt)
     return 0;
 }
 
+int Gemm_arm::destroy_pipeline(const Option& opt)
+{
+    if (activation)
+    {
+        activation->destroy_pipeline(opt);
+        delete activation;
+        activation = 0;
+    }
+
+    return 0;
+}
+
 int Gemm_arm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    int ret = forward_gemm(bottom_blobs, top_blobs, opt);
+    if (ret != 0)
+        return ret;
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blobs[0], opt);
+    }
+
+    return 0;
+}
+
+int Gemm_arm::forward_gemm(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
 #if NCNN_INT8
     if (int8_scale_term)
@@ -529,7 +529,7 @@ int LSTM_arm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
     Mat hidden;
     Mat cell;
     Allocator* hidden_cell_allocator = top_blobs.size() == 3 ? opt.blob_allocator : opt.workspace_allocator;
-    if (bottom_blobs.size() == 3)
+    if (bottom_blobs.size() == 3 && !bottom_blobs[1].empty() && !bottom_blobs[2].empty())
     {
         hidden = bottom_blobs[1].clone(hidden_cell_allocator);
         cell = bottom_blobs[2].clone(hidden_cell_allocator);
@@ -1040,7 +1040,7 @@ int LSTM_arm::forward_bf16s(const std::vector<Mat>& bottom_blobs, std::vector<Ma
     Mat hidden;
     Mat cell;
     Allocator* hidden_cell_allocator = top_blobs.size() == 3 ? opt.blob_allocator : opt.workspace_allocator;
-    if (bottom_blobs.size() == 3)
+    if (bottom_blobs.size() == 3 && !bottom_blobs[1].empty() && !bottom_blobs[2].empty())
     {
         Option opt_cast = opt;
         opt_cast.blob_allocator = hidden_cell_allocator;
@@ -1350,7 +1350,7 @@ int LSTM_arm::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
     Mat hidden;
     Mat cell;
     Allocator* hidden_cell_allocator = top_blobs.size() == 3 ? opt.blob_allocator : opt.workspace_allocator;
-    if (bottom_blobs.size() == 3)
+    if (bottom_blobs.size() == 3 && !bottom_blobs[1].empty() && !bottom_blobs[2].empty())
     {
         if (elemtype == 1)
         {
@@ -882,7 +882,7 @@ int LSTM_arm::forward_fp16s(const std::vector<Mat>& bottom_blobs, std::vector<Ma
     Mat hidden;
     Mat cell;
     Allocator* hidden_cell_allocator = top_blobs.size() == 3 ? opt.blob_allocator : opt.workspace_allocator;
-    if (bottom_blobs.size() == 3)
+    if (bottom_blobs.size() == 3 && !bottom_blobs[1].empty() && !bottom_blobs[2].empty())
     {
         Option opt_cast = opt;
         opt_cast.blob_allocator = hidden_cell_allocator;
@@ -47,16 +47,18 @@ int Convolution::load_param(const ParamDict& pd)
     activation_params = pd.get(10, Mat());
 
     dynamic_weight = pd.get(19, 0);
+    int8_dynamic_quantize = pd.get(20, 0);
 
     if (dynamic_weight)
     {
         one_blob_only = false;
     }
 
-    if (int8_scale_term)
+    if (int8_scale_term || int8_dynamic_quantize)
     {
 #if NCNN_INT8
-        support_int8_storage = true;
+        // dynamic quantization needs float input
+        support_int8_storage = !int8_dynamic_quantize;
 #else
         NCNN_LOGE("please build ncnn with NCNN_INT8 enabled for int8 inference");
         return -1;
@@ -97,13 +99,31 @@ int Convolution::load_model(const ModelBin& mb)
 
 #if NCNN_INT8
     // runtime quantize the weight data
-    if (weight_data.elemsize == (size_t)4u && int8_scale_term)
+    if (weight_data.elemsize == (size_t)4u && (int8_scale_term || int8_dynamic_quantize))
     {
         const int maxk = kernel_w * kernel_h;
         const int num_input = weight_data_size / num_output / maxk;
 
         Mat weight_data_r2 = weight_data.reshape(maxk, num_input, num_output);
 
+        if (!int8_scale_term)
+        {
+            // calibration free, per output channel absmax
+            weight_data_int8_scales.create(num_output);
+            for (int p = 0; p < num_output; p++)
+            {
+                const float* ptr = (const float*)weight_data + maxk * num_input * p;
+
+                float absmax = 0.f;
+                for (int i = 0; i < maxk * num_input; i++)
+                {
+                    absmax = std::max(absmax, (float)fabs(ptr[i]));
+                }
+
+                weight_data_int8_scales[p] = absmax == 0.f ? 1.f : 127.f / absmax;
+            }
+        }
+
         Mat weight_data_int8;
 
         Option opt_q;
@@ -394,8 +414,70 @@ int Convolution::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Optio
     const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
     const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
 
+    // one scale per pixel for 1x1 stride 1 convolution, one scale for the whole blob otherwise
+    const bool dynamic_quantize_per_pixel = int8_dynamic_quantize && kernel_w == 1 && kernel_h == 1 && stride_w == 1 && stride_h == 1;
+
     Mat bottom_blob_unbordered = bottom_blob;
-    if (elemsize != 1)
+    Mat bottom_scales = bottom_blob_int8_scales;
+    if (elemsize != 1 && dynamic_quantize_per_pixel)
+    {
+        // pad first, pixels of padding get their own scales
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        make_padding(bottom_blob, bottom_blob_unbordered, opt_b);
+        if (bottom_blob_unbordered.empty())
+            return -100;
+
+        const int size = bottom_blob_unbordered.w * bottom_blob_unbordered.h;
+
+        Mat bottom_blob_int8(bottom_blob_unbordered.w, bottom_blob_unbordered.h, channels, (size_t)1u, opt.workspace_allocator);
+        bottom_scales.create(size, (size_t)4u, opt.workspace_allocator);
+        if (bottom_blob_int8.empty() || bottom_scales.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < size; i++)
+        {
+            float absmax = 0.f;
+            for (int q = 0; q < channels; q++)
+            {
+                absmax = std::max(absmax, (float)fabs(bottom_blob_unbordered.channel(q)[i]));
+            }
+
+            const float scale = absmax == 0.f ? 1.f : 127.f / absmax;
+            for (int q = 0; q < channels; q++)
+            {
+                bottom_blob_int8.channel(q).row<signed char>(0)[i] = float2int8(bottom_blob_unbordered.channel(q)[i] * scale);
+            }
+
+            bottom_scales[i] = scale;
+        }
+
+        bottom_blob_unbordered = bottom_blob_int8;
+    }
+    else if (elemsize != 1 && int8_dynamic_quantize)
+    {
+        float absmax = 0.f;
+        for (int q = 0; q < channels; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            for (int i = 0; i < w * h; i++)
+            {
+                absmax = std::max(absmax, (float)fabs(ptr[i]));
+            }
+        }
+
+        bottom_scales.create(1);
+        bottom_scales[0] = absmax == 0.f ? 1.f : 127.f / absmax;
+
+        Option opt_g = opt;
+        opt_g.blob_allocator = opt.workspace_allocator;
+
+        quantize_to_int8(bottom_blob, bottom_blob_unbordered, bottom_scales, opt_g);
+        if (bottom_blob_unbordered.empty())
+            return -100;
+    }
+    else if (elemsize != 1)
     {
         Option opt_g = opt;
         opt_g.blob_allocator = opt.workspace_allocator;
@@ -405,10 +487,13 @@ int Convolution::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Optio
             return -100;
     }
 
-    Mat bottom_blob_bordered;
-    make_padding(bottom_blob_unbordered, bottom_blob_bordered, opt);
-    if (bottom_blob_bordered.empty())
-        return -100;
+    Mat bottom_blob_bordered = bottom_blob_unbordered;
+    if (!dynamic_quantize_per_pixel || elemsize == 1)
+    {
+        make_padding(bottom_blob_unbordered, bottom_blob_bordered, opt);
+        if (bottom_blob_bordered.empty())
+            return -100;
+    }
 
     w = bottom_blob_bordered.w;
     h = bottom_blob_bordered.h;
@@ -438,7 +523,7 @@ int Convolution::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Optio
     }
 
     // int8
-    bool use_int8_requantize = int8_scale_term > 100;
+    bool use_int8_requantize = int8_scale_term > 100 && !int8_dynamic_quantize;
     size_t out_elemsize = use_int8_requantize ? 1u : 4u;
 
     top_blob.create(outw, outh, num_output, out_elemsize, opt.blob_allocator);
@@ -479,7 +564,7 @@ int Convolution::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Optio
                 if (weight_data_int8_scales[p] == 0)
                     scale_in = 0;
                 else
-                    scale_in = 1.f / (bottom_blob_int8_scales[0] * weight_data_int8_scales[p]);
+                    scale_in = 1.f / (bottom_scales[dynamic_quantize_per_pixel ? i * w + j : 0] * weight_data_int8_scales[p]);
 
                 float sumfp32 = sum * scale_in;
 
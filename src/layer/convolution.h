@@ -60,6 +60,9 @@ public:
 
     int int8_scale_term;
 
+    // 1=quantize input with runtime scales instead of bottom_blob_int8_scales
+    int int8_dynamic_quantize;
+
     // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid
     int activation_type;
     Mat activation_params;
@@ -14,6 +14,8 @@
 
 #include "detectionoutput.h"
 
+#include "nms.h"
+
 namespace ncnn {
 
 DetectionOutput::DetectionOutput()
@@ -37,110 +39,6 @@ int DetectionOutput::load_param(const ParamDict& pd)
     return 0;
 }
 
-struct BBoxRect
-{
-    float xmin;
-    float ymin;
-    float xmax;
-    float ymax;
-    int label;
-};
-
-static inline float intersection_area(const BBoxRect& a, const BBoxRect& b)
-{
-    if (a.xmin > b.xmax || a.xmax < b.xmin || a.ymin > b.ymax || a.ymax < b.ymin)
-    {
-        // no intersection
-        return 0.f;
-    }
-
-    float inter_width = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
-    float inter_height = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
-
-    return inter_width * inter_height;
-}
-
-template<typename T>
-static void qsort_descent_inplace(std::vector<T>& datas, std::vector<float>& scores, int left, int right)
-{
-    int i = left;
-    int j = right;
-    float p = scores[(left + right) / 2];
-
-    while (i <= j)
-    {
-        while (scores[i] > p)
-            i++;
-
-        while (scores[j] < p)
-            j--;
-
-        if (i <= j)
-        {
-            // swap
-            std::swap(datas[i], datas[j]);
-            std::swap(scores[i], scores[j]);
-
-            i++;
-            j--;
-        }
-    }
-
-    if (left < j)
-        qsort_descent_inplace(datas, scores, left, j);
-
-    if (i < right)
-        qsort_descent_inplace(datas, scores, i, right);
-}
-
-template<typename T>
-static void qsort_descent_inplace(std::vector<T>& datas, std::vector<float>& scores)
-{
-    if (datas.empty() || scores.empty())
-        return;
-
-    qsort_descent_inplace(datas, scores, 0, static_cast<int>(scores.size() - 1));
-}
-
-static void nms_sorted_bboxes(const std::vector<BBoxRect>& bboxes, std::vector<size_t>& picked, float nms_threshold)
-{
-    picked.clear();
-
-    const size_t n = bboxes.size();
-
-    std::vector<float> areas(n);
-    for (size_t i = 0; i < n; i++)
-    {
-        const BBoxRect& r = bboxes[i];
-
-        float width = r.xmax - r.xmin;
-        float height = r.ymax - r.ymin;
-
-        areas[i] = width * height;
-    }
-
-    for (size_t i = 0; i < n; i++)
-    {
-        const BBoxRect& a = bboxes[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            const BBoxRect& b = bboxes[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            //             float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
-        }
-
-        if (keep)
-            picked.push_back(i);
-    }
-}
-
 int DetectionOutput::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
     const Mat& location = bottom_blobs[0];
@@ -197,17 +95,17 @@ int DetectionOutput::forward(const std::vector<Mat>& bottom_blobs, std::vector<M
     }
 
     // sort and nms for each class
-    std::vector<std::vector<BBoxRect> > all_class_bbox_rects;
-    std::vector<std::vector<float> > all_class_bbox_scores;
-    all_class_bbox_rects.resize(num_class_copy);
-    all_class_bbox_scores.resize(num_class_copy);
+    std::vector<std::vector<int> > all_class_picked;
+    std::vector<std::vector<float> > all_class_scores;
+    all_class_picked.resize(num_class_copy);
+    all_class_scores.resize(num_class_copy);
 
     // start from 1 to ignore background class
     #pragma omp parallel for num_threads(opt.num_threads)
     for (int i = 1; i < num_class_copy; i++)
     {
         // filter by confidence_threshold
-        std::vector<BBoxRect> class_bbox_rects;
+        std::vector<int> class_bbox_indices;
         std::vector<float> class_bbox_scores;
 
         for (int j = 0; j < num_prior; j++)
@@ -219,61 +117,64 @@ int DetectionOutput::forward(const std::vector<Mat>& bottom_blobs, std::vector<M
 
             if (score > confidence_threshold)
             {
-                const float* bbox = bboxes.row(j);
-                BBoxRect c = {bbox[0], bbox[1], bbox[2], bbox[3], i};
-                class_bbox_rects.push_back(c);
+                class_bbox_indices.push_back(j);
                 class_bbox_scores.push_back(score);
             }
         }
 
-        // sort inplace
-        qsort_descent_inplace(class_bbox_rects, class_bbox_scores);
+        const int class_bbox_count = (int)class_bbox_indices.size();
+        if (class_bbox_count == 0)
+            continue;
+
+        // keep nms_top_k sorted
+        std::vector<int> order;
+        topk_descent(&class_bbox_scores[0], class_bbox_count, nms_top_k, order);
+        if (order.empty())
+            continue;
 
-        // keep nms_top_k
-        if (nms_top_k < (int)class_bbox_rects.size())
+        for (size_t j = 0; j < order.size(); j++)
         {
-            class_bbox_rects.resize(nms_top_k);
-            class_bbox_scores.resize(nms_top_k);
+            order[j] = class_bbox_indices[order[j]];
         }
 
         // apply nms
-        std::vector<size_t> picked;
-        nms_sorted_bboxes(class_bbox_rects, picked, nms_threshold);
+        std::vector<int>& picked = all_class_picked[i];
+        nms_sorted_bboxes(bboxes, &order[0], (int)order.size(), nms_threshold, picked);
 
-        // select
+        std::vector<float>& picked_scores = all_class_scores[i];
+        picked_scores.resize(picked.size());
         for (size_t j = 0; j < picked.size(); j++)
         {
-            size_t z = picked[j];
-            all_class_bbox_rects[i].push_back(class_bbox_rects[z]);
-            all_class_bbox_scores[i].push_back(class_bbox_scores[z]);
+            const int z = picked[j];
+            picked_scores[j] = mxnet_ssd_style ? confidence[i * num_prior + z] : confidence[z * num_class_copy + i];
         }
     }
 
     // gather all class
-    std::vector<BBoxRect> bbox_rects;
+    std::vector<int> bbox_indices;
+    std::vector<int> bbox_labels;
     std::vector<float> bbox_scores;
 
     for (int i = 1; i < num_class_copy; i++)
     {
-        const std::vector<BBoxRect>& class_bbox_rects = all_class_bbox_rects[i];
-        const std::vector<float>& class_bbox_scores = all_class_bbox_scores[i];
+        const std::vector<int>& class_picked = all_class_picked[i];
+        const std::vector<float>& class_scores = all_class_scores[i];
 
-        bbox_rects.insert(bbox_rects.end(), class_bbox_rects.begin(), class_bbox_rects.end());
-        bbox_scores.insert(bbox_scores.end(), class_bbox_scores.begin(), class_bbox_scores.end());
+        bbox_indices.insert(bbox_indices.end(), class_picked.begin(), class_picked.end());
+        bbox_labels.insert(bbox_labels.end(), class_picked.size(), i);
+        bbox_scores.insert(bbox_scores.end(), class_scores.begin(), class_scores.end());
     }
 
-    // global sort inplace
-    qsort_descent_inplace(bbox_rects, bbox_scores);
+    // fill result
+    int num_detected = static_cast<int>(bbox_indices.size());
+    if (num_detected == 0)
+        return 0;
 
-    // keep_top_k
-    if (keep_top_k < (int)bbox_rects.size())
-    {
-        bbox_rects.resize(keep_top_k);
-        bbox_scores.resize(keep_top_k);
-    }
+    // keep_top_k sorted
+    std::vector<int> order;
+    topk_descent(&bbox_scores[0], num_detected, keep_top_k, order);
 
-    // fill result
-    int num_detected = static_cast<int>(bbox_rects.size());
+    num_detected = static_cast<int>(order.size());
     if (num_detected == 0)
         return 0;
 
@@ -284,16 +185,16 @@ int DetectionOutput::forward(const std::vector<Mat>& bottom_blobs, std::vector<M
 
     for (int i = 0; i < num_detected; i++)
     {
-        const BBoxRect& r = bbox_rects[i];
-        float score = bbox_scores[i];
+        const int z = order[i];
+        const float* bbox = bboxes.row(bbox_indices[z]);
         float* outptr = top_blob.row(i);
 
-        outptr[0] = static_cast<float>(r.label);
-        outptr[1] = score;
-        outptr[2] = r.xmin;
-        outptr[3] = r.ymin;
-        outptr[4] = r.xmax;
-        outptr[5] = r.ymax;
+        outptr[0] = static_cast<float>(bbox_labels[z]);
+        outptr[1] = bbox_scores[z];
+        outptr[2] = bbox[0];
+        outptr[3] = bbox[1];
+        outptr[4] = bbox[2];
+        outptr[5] = bbox[3];
     }
 
     return 0;
@@ -69,6 +69,17 @@ static NCNN_FORCEINLINE float activation_ss(float v, int activation_type, const
             v = v * (v * alpha + beta);
         break;
     }
+    case 7:
+    {
+        // y = 0.5x * (1 + tanh(sqrt(2/Pi) * (x + 0.044715x^3)))
+        v = 0.5f * v * (1.0f + tanhf(0.79788452f * (v + 0.044715f * v * v * v)));
+        break;
+    }
+    case 8:
+    {
+        v = v / (1.f + expf(-v));
+        break;
+    }
     }
 
     return v;
@@ -127,6 +138,21 @@ static ncnn::Layer* create_activation_layer(int activation_type, const ncnn::Mat
 
         activation->load_param(pd);
     }
+    else if (activation_type == 7)
+    {
+        activation = ncnn::create_layer_cpu(ncnn::LayerType::GELU);
+
+        ncnn::ParamDict pd;
+        pd.set(0, 1); // fast_gelu
+        activation->load_param(pd);
+    }
+    else if (activation_type == 8)
+    {
+        activation = ncnn::create_layer_cpu(ncnn::LayerType::Swish);
+
+        ncnn::ParamDict pd;
+        activation->load_param(pd);
+    }
 
     if (activation)
     {
@@ -14,6 +14,8 @@
 
 #include "gemm.h"
 
+#include "fused_activation.h"
+
 namespace ncnn {
 
 Gemm::Gemm()
@@ -43,6 +45,8 @@ int Gemm::load_param(const ParamDict& pd)
     constant_TILE_M = pd.get(20, 0);
     constant_TILE_N = pd.get(21, 0);
     constant_TILE_K = pd.get(22, 0);
+    activation_type = pd.get(15, 0);
+    activation_params = pd.get(16, Mat());
 
     if (int8_scale_term)
     {
@@ -138,7 +142,7 @@ int Gemm::load_model(const ModelBin& mb)
     return 0;
 }
 
-static void gemm_transB(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob, float alpha, float beta, int broadcast_type_C, int output_transpose, const Option& opt)
+static void gemm_transB(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob, float alpha, float beta, int broadcast_type_C, int output_transpose, int activation_type, const Mat& activation_params, const Option& opt)
 {
     const int M = A.dims == 3 ? A.c : A.h;
     const int N = BT.dims == 3 ? BT.c : BT.h;
@@ -193,6 +197,8 @@ static void gemm_transB(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob
 
             sum *= alpha;
 
+            sum = activation_ss(sum, activation_type, activation_params);
+
             if (output_transpose)
             {
                 top_blob[j * out_hstep + i] = sum;
@@ -214,7 +220,7 @@ static inline signed char float2int8(float v)
     return (signed char)int32;
 }
 
-static void gemm_transB_int8(const Mat& A_int8, const Mat& BT_int8, const Mat& A_int8_scales, float BT_int8_scale, const Mat& C, Mat& top_blob, float alpha, float beta, int broadcast_type_C, int output_transpose, const Option& opt)
+static void gemm_transB_int8(const Mat& A_int8, const Mat& BT_int8, const Mat& A_int8_scales, float BT_int8_scale, const Mat& C, Mat& top_blob, float alpha, float beta, int broadcast_type_C, int output_transpose, int activation_type, const Mat& activation_params, const Option& opt)
 {
     const int M = A_int8.h;
     const int N = BT_int8.h;
@@ -271,6 +277,8 @@ static void gemm_transB_int8(const Mat& A_int8, const Mat& BT_int8, const Mat& A
 
             sum_fp32 *= alpha;
 
+            sum_fp32 = activation_ss(sum_fp32, activation_type, activation_params);
+
             if (output_transpose)
             {
                 top_blob[j * out_hstep + i] = sum_fp32;
@@ -430,7 +438,7 @@ int Gemm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_bl
     if (top_blob.empty())
         return -100;
 
-    gemm_transB(A, BT, C, top_blob, alpha, beta, broadcast_type_C, output_transpose, opt);
+    gemm_transB(A, BT, C, top_blob, alpha, beta, broadcast_type_C, output_transpose, activation_type, activation_params, opt);
 
     return 0;
 }
@@ -642,7 +650,7 @@ int Gemm::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& t
     if (top_blob.empty())
         return -100;
 
-    gemm_transB_int8(A_int8, BT_int8, A_int8_scales, B_int8_scale, C, top_blob, alpha, beta, broadcast_type_C, output_transpose, opt);
+    gemm_transB_int8(A_int8, BT_int8, A_int8_scales, B_int8_scale, C, top_blob, alpha, beta, broadcast_type_C, output_transpose, activation_type, activation_params, opt);
 
     return 0;
 }
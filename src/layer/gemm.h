@@ -57,6 +57,10 @@ public:
 
     int int8_scale_term;
 
+    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid 5=mish 6=hardswish 7=gelu 8=swish
+    int activation_type;
+    Mat activation_params;
+
     int constant_TILE_M;
     int constant_TILE_N;
     int constant_TILE_K;
@@ -34,11 +34,40 @@ int InnerProduct::load_param(const ParamDict& pd)
     int8_scale_term = pd.get(8, 0);
     activation_type = pd.get(9, 0);
     activation_params = pd.get(10, Mat());
+    int8_dynamic_quantize = pd.get(20, 0);
+    weight_quant_bits = pd.get(21, 0);
+    weight_quant_group_size = pd.get(22, 0);
 
-    if (int8_scale_term)
+    if (weight_quant_bits)
+    {
+        if (weight_quant_bits != 4 && weight_quant_bits != 8)
+        {
+            NCNN_LOGE("unsupported weight_quant_bits %d", weight_quant_bits);
+            return -1;
+        }
+
+        if (int8_scale_term || int8_dynamic_quantize)
+        {
+            NCNN_LOGE("weight_quant_bits can not be used with int8 inference");
+            return -1;
+        }
+
+        const int num_input = num_output ? weight_data_size / num_output : 0;
+        if (weight_quant_group_size == 0)
+            weight_quant_group_size = num_input;
+
+        if (weight_quant_group_size <= 0 || num_input % weight_quant_group_size != 0 || (weight_quant_bits == 4 && weight_quant_group_size % 2 != 0))
+        {
+            NCNN_LOGE("invalid weight_quant_group_size %d for num_input %d", weight_quant_group_size, num_input);
+            return -1;
+        }
+    }
+
+    if (int8_scale_term || int8_dynamic_quantize)
     {
 #if NCNN_INT8
-        support_int8_storage = true;
+        // dynamic quantization needs float input
+        support_int8_storage = !int8_dynamic_quantize;
 #else
         NCNN_LOGE("please build ncnn with NCNN_INT8 enabled for int8 inference");
         return -1;
@@ -50,9 +79,25 @@ int InnerProduct::load_param(const ParamDict& pd)
 
 int InnerProduct::load_model(const ModelBin& mb)
 {
-    weight_data = mb.load(weight_data_size, 0);
-    if (weight_data.empty())
-        return -100;
+    if (weight_quant_bits)
+    {
+        // packed int4 or int8 rows, kept compressed in memory
+        weight_data = mb.load((int)((size_t)weight_data_size * weight_quant_bits / 8), 0);
+        if (weight_data.empty())
+            return -100;
+
+        if (weight_data.elemsize != 1)
+        {
+            NCNN_LOGE("weight_quant_bits expects int8 stored weight, got elemsize %d", (int)weight_data.elemsize);
+            return -100;
+        }
+    }
+    else
+    {
+        weight_data = mb.load(weight_data_size, 0);
+        if (weight_data.empty())
+            return -100;
+    }
 
     if (bias_term)
     {
@@ -61,6 +106,15 @@ int InnerProduct::load_model(const ModelBin& mb)
             return -100;
     }
 
+    if (weight_quant_bits)
+    {
+        const int num_input = weight_data_size / num_output;
+
+        weight_data_group_scales = mb.load(num_input / weight_quant_group_size, num_output, 1);
+        if (weight_data_group_scales.empty())
+            return -100;
+    }
+
 #if NCNN_INT8
     if (int8_scale_term)
     {
@@ -71,12 +125,30 @@ int InnerProduct::load_model(const ModelBin& mb)
 
 #if NCNN_INT8
     // runtime quantize the weight data
-    if (weight_data.elemsize == (size_t)4u && int8_scale_term)
+    if (weight_data.elemsize == (size_t)4u && (int8_scale_term || int8_dynamic_quantize))
     {
         const int num_input = weight_data_size / num_output;
 
         Mat weight_data_r2 = weight_data.reshape(num_input, num_output);
 
+        if (!int8_scale_term)
+        {
+            // calibration free, per output channel absmax
+            weight_data_int8_scales.create(num_output);
+            for (int p = 0; p < num_output; p++)
+            {
+                const float* ptr = weight_data_r2.row(p);
+
+                float absmax = 0.f;
+                for (int i = 0; i < num_input; i++)
+                {
+                    absmax = std::max(absmax, (float)fabs(ptr[i]));
+                }
+
+                weight_data_int8_scales[p] = absmax == 0.f ? 1.f : 127.f / absmax;
+            }
+        }
+
         Mat weight_data_int8;
         Option opt_q;
         opt_q.num_threads = 1;
@@ -94,6 +166,11 @@ int InnerProduct::load_model(const ModelBin& mb)
 
 int InnerProduct::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+    if (weight_quant_bits)
+    {
+        return forward_weight_quant(bottom_blob, top_blob, opt);
+    }
+
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
@@ -174,7 +251,135 @@ int InnerProduct::forward(const Mat& bottom_blob, Mat& top_blob, const Option& o
     return 0;
 }
 
+static inline float weight_quant_value(const signed char* kptr, const float* scales, int i, int bits, int group_size)
+{
+    int q;
+    if (bits == 4)
+    {
+        const signed char b = kptr[i / 2];
+        q = i % 2 == 0 ? (signed char)(b << 4) / 16 : b >> 4;
+    }
+    else
+    {
+        q = kptr[i];
+    }
+
+    return q * scales[i / group_size];
+}
+
+int InnerProduct::dequantize_weight_data(Mat& weight_data_fp32, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+    const size_t row_bytes = (size_t)num_input * weight_quant_bits / 8;
+
+    weight_data_fp32.create(weight_data_size);
+    if (weight_data_fp32.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        const signed char* kptr = (const signed char*)weight_data + row_bytes * p;
+        const float* scales = weight_data_group_scales.row(p);
+        float* outptr = (float*)weight_data_fp32 + num_input * p;
+
+        for (int i = 0; i < num_input; i++)
+        {
+            outptr[i] = weight_quant_value(kptr, scales, i, weight_quant_bits, weight_quant_group_size);
+        }
+    }
+
+    return 0;
+}
+
+int InnerProduct::forward_weight_quant(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+    const size_t row_bytes = (size_t)num_input * weight_quant_bits / 8;
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int size = w * h;
+
+    if (bottom_blob.dims == 2 && w == num_input)
+    {
+        // gemm
+        top_blob.create(num_output, h, elemsize, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int j = 0; j < h; j++)
+        {
+            const float* m = bottom_blob.row(j);
+            float* outptr = top_blob.row(j);
+
+            for (int p = 0; p < num_output; p++)
+            {
+                const signed char* kptr = (const signed char*)weight_data + row_bytes * p;
+                const float* scales = weight_data_group_scales.row(p);
+
+                float sum = 0.f;
+
+                if (bias_term)
+                    sum = bias_data[p];
+
+                for (int i = 0; i < w; i++)
+                {
+                    sum += m[i] * weight_quant_value(kptr, scales, i, weight_quant_bits, weight_quant_group_size);
+                }
+
+                outptr[p] = activation_ss(sum, activation_type, activation_params);
+            }
+        }
+
+        return 0;
+    }
+
+    top_blob.create(num_output, elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // num_output
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        const signed char* kptr = (const signed char*)weight_data + row_bytes * p;
+        const float* scales = weight_data_group_scales.row(p);
+
+        float sum = 0.f;
+
+        if (bias_term)
+            sum = bias_data[p];
+
+        // channels
+        for (int q = 0; q < channels; q++)
+        {
+            const float* m = bottom_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                sum += m[i] * weight_quant_value(kptr, scales, size * q + i, weight_quant_bits, weight_quant_group_size);
+            }
+        }
+
+        top_blob[p] = activation_ss(sum, activation_type, activation_params);
+    }
+
+    return 0;
+}
+
 #if NCNN_INT8
+static inline signed char float2int8(float v)
+{
+    int int32 = static_cast<int>(round(v));
+    if (int32 > 127) return 127;
+    if (int32 < -127) return -127;
+    return (signed char)int32;
+}
+
 int InnerProduct::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
     const int num_input = weight_data_size / num_output;
@@ -186,7 +391,47 @@ int InnerProduct::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Opti
     int size = w * h;
 
     Mat bottom_blob_int8 = bottom_blob;
-    if (elemsize != 1)
+    Mat bottom_scales = bottom_blob_int8_scales;
+    if (elemsize != 1 && int8_dynamic_quantize)
+    {
+        // one scale per row for gemm, one scale for the whole blob otherwise
+        const int rows = bottom_blob.dims == 2 && w == num_input ? h : 1;
+        const int rowsize = bottom_blob.dims == 2 && w == num_input ? w : size * channels;
+
+        Mat bottom_blob_flattened = bottom_blob.reshape(rowsize, rows, opt.workspace_allocator);
+        bottom_blob_int8.create(rowsize, rows, (size_t)1u, opt.workspace_allocator);
+        bottom_scales.create(rows, (size_t)4u, opt.workspace_allocator);
+        if (bottom_blob_flattened.empty() || bottom_blob_int8.empty() || bottom_scales.empty())
+            return -100;
+
+        for (int j = 0; j < rows; j++)
+        {
+            const float* ptr = bottom_blob_flattened.row(j);
+            signed char* outptr = bottom_blob_int8.row<signed char>(j);
+
+            float absmax = 0.f;
+            for (int i = 0; i < rowsize; i++)
+            {
+                absmax = std::max(absmax, (float)fabs(ptr[i]));
+            }
+
+            const float scale = absmax == 0.f ? 1.f : 127.f / absmax;
+            for (int i = 0; i < rowsize; i++)
+            {
+                outptr[i] = float2int8(ptr[i] * scale);
+            }
+
+            bottom_scales[j] = scale;
+        }
+
+        if (bottom_blob.dims == 3)
+        {
+            bottom_blob_int8 = bottom_blob_int8.reshape(w, h, channels, opt.workspace_allocator);
+            if (bottom_blob_int8.empty())
+                return -100;
+        }
+    }
+    else if (elemsize != 1)
     {
         Option opt_g = opt;
         opt_g.blob_allocator = opt.workspace_allocator;
@@ -222,7 +467,7 @@ int InnerProduct::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Opti
                 if (weight_data_int8_scales[p] == 0)
                     scale_in = 0;
                 else
-                    scale_in = 1.f / (bottom_blob_int8_scales[0] * weight_data_int8_scales[p]);
+                    scale_in = 1.f / (bottom_scales[bottom_scales.w > 1 ? j : 0] * weight_data_int8_scales[p]);
 
                 float sumfp32 = sum * scale_in;
 
@@ -266,7 +511,7 @@ int InnerProduct::forward_int8(const Mat& bottom_blob, Mat& top_blob, const Opti
         if (weight_data_int8_scales[p] == 0)
             scale_in = 0;
         else
-            scale_in = 1.f / (bottom_blob_int8_scales[0] * weight_data_int8_scales[p]);
+            scale_in = 1.f / (bottom_scales[0] * weight_data_int8_scales[p]);
 
         float sumfp32 = sum * scale_in;
 
@@ -31,6 +31,8 @@ public:
     virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 protected:
+    int forward_weight_quant(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int dequantize_weight_data(Mat& weight_data_fp32, const Option& opt) const;
 #if NCNN_INT8
     int forward_int8(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 #endif
@@ -44,14 +46,24 @@ public:
 
     int int8_scale_term;
 
-    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid
+    // 1=quantize input with runtime scales instead of bottom_blob_int8_scales
+    int int8_dynamic_quantize;
+
+    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid 5=mish 6=hardswish 7=gelu 8=swish
     int activation_type;
     Mat activation_params;
 
+    // weight-only quantization, 0=none 4=int4 8=int8
+    int weight_quant_bits;
+    int weight_quant_group_size;
+
     // model
     Mat weight_data;
     Mat bias_data;
 
+    // weight = int * scale, [num_input / weight_quant_group_size, num_output]
+    Mat weight_data_group_scales;
+
 #if NCNN_INT8
     Mat weight_data_int8_scales;
     Mat bottom_blob_int8_scales;
@@ -14,6 +14,8 @@
 
 #include "inversespectrogram.h"
 
+#include "cpu.h"
+
 namespace ncnn {
 
 InverseSpectrogram::InverseSpectrogram()
@@ -82,6 +84,10 @@ int InverseSpectrogram::load_param(const ParamDict& pd)
         }
     }
 
+    // precompute twiddle factors
+    if (n_fft > 0)
+        fft.create(n_fft);
+
     return 0;
 }
 
@@ -120,93 +126,94 @@ int InverseSpectrogram::forward(const Mat& bottom_blob, Mat& top_blob, const Opt
     top_blob.fill(0.f);
     window_sumsquare.fill(0.f);
 
+    // inverse transform all frames independently
+    Mat frames_data(n_fft * 2, frames, (size_t)4u, opt.workspace_allocator);
+    if (frames_data.empty())
+        return -100;
+
+    // per thread collected spectrum + fft workspace
+    const int frame_size = n_fft * 2 + fft.workspace_size();
+
+    Mat frame_workspace(frame_size, opt.num_threads, (size_t)4u, opt.workspace_allocator);
+    if (frame_workspace.empty())
+        return -100;
+
+    float norm = 1.f / n_fft;
+    if (normalized == 1)
+    {
+        norm *= sqrt(n_fft);
+    }
+    if (normalized == 2)
+    {
+        norm *= window_data[n_fft];
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
     for (int j = 0; j < frames; j++)
     {
+        float* sp = frame_workspace.row(get_omp_thread_num());
+        float* workspace = sp + n_fft * 2;
+
         // collect complex
-        Mat sp(2, n_fft);
-        if (onesided == 1)
+        for (int k = 0; k < freqs; k++)
         {
-            for (int k = 0; k < n_fft / 2 + 1; k++)
-            {
-                sp.row(k)[0] = bottom_blob.channel(k).row(j)[0];
-                sp.row(k)[1] = bottom_blob.channel(k).row(j)[1];
-            }
-            for (int k = n_fft / 2 + 1; k < n_fft; k++)
-            {
-                sp.row(k)[0] = bottom_blob.channel(n_fft - k).row(j)[0];
-                sp.row(k)[1] = -bottom_blob.channel(n_fft - k).row(j)[1];
-            }
+            const float* ptr = bottom_blob.channel(k).row(j);
+            sp[k * 2] = ptr[0];
+            sp[k * 2 + 1] = ptr[1];
         }
-        else
+        if (onesided == 1)
         {
-            for (int k = 0; k < n_fft; k++)
+            for (int k = freqs; k < n_fft; k++)
             {
-                sp.row(k)[0] = bottom_blob.channel(k).row(j)[0];
-                sp.row(k)[1] = bottom_blob.channel(k).row(j)[1];
+                const float* ptr = bottom_blob.channel(n_fft - k).row(j);
+                sp[k * 2] = ptr[0];
+                sp[k * 2 + 1] = -ptr[1];
             }
         }
 
-        if (normalized == 1)
-        {
-            float norm = sqrt(n_fft);
-            for (int i = 0; i < 2 * n_fft; i++)
-            {
-                sp[i] *= norm;
-            }
-        }
-        if (normalized == 2)
+        float* outptr = frames_data.row(j);
+
+        // inverse dft
+        fft.inverse(sp, outptr, workspace);
+
+        // normalize and apply window
+        for (int i = 0; i < n_fft; i++)
         {
-            float norm = window_data[n_fft];
-            for (int i = 0; i < 2 * n_fft; i++)
-            {
-                sp[i] *= norm;
-            }
+            outptr[i * 2] *= norm * window_data[i];
+            outptr[i * 2 + 1] *= norm * window_data[i];
         }
+    }
+
+    // overlap add
+    for (int j = 0; j < frames; j++)
+    {
+        const float* ptr = frames_data.row(j);
 
-        #pragma omp parallel for num_threads(opt.num_threads)
         for (int i = 0; i < n_fft; i++)
         {
-            // inverse dft
-            float re = 0.f;
-            float im = 0.f;
-            for (int k = 0; k < n_fft; k++)
+            int output_index = j * hoplen + i;
+            if (center == 1)
             {
-                double angle = 2 * 3.14159265358979323846 * i * k / n_fft;
-
-                re += sp.row(k)[0] * cosf(angle) - sp.row(k)[1] * sinf(angle);
-                im += sp.row(k)[0] * sinf(angle) + sp.row(k)[1] * cosf(angle);
+                output_index -= n_fft / 2;
             }
+            if (output_index < 0 || output_index >= outsize)
+                continue;
 
-            re /= n_fft;
-            im /= n_fft;
-
-            // apply window
-            re *= window_data[i];
-            im *= window_data[i];
+            // square window
+            window_sumsquare[output_index] += window_data[i] * window_data[i];
 
-            int output_index = j * hoplen + i;
-            if (center == 1)
+            if (returns == 0)
             {
-                output_index -= n_fft / 2;
+                top_blob.row(output_index)[0] += ptr[i * 2];
+                top_blob.row(output_index)[1] += ptr[i * 2 + 1];
+            }
+            if (returns == 1)
+            {
+                top_blob[output_index] += ptr[i * 2];
             }
-            if (output_index >= 0 && output_index < outsize)
+            if (returns == 2)
             {
-                // square window
-                window_sumsquare[output_index] += window_data[i] * window_data[i];
-
-                if (returns == 0)
-                {
-                    top_blob.row(output_index)[0] += re;
-                    top_blob.row(output_index)[1] += im;
-                }
-                if (returns == 1)
-                {
-                    top_blob[output_index] += re;
-                }
-                if (returns == 2)
-                {
-                    top_blob[output_index] += im;
-                }
+                top_blob[output_index] += ptr[i * 2 + 1];
             }
         }
     }
@@ -15,6 +15,7 @@
 #ifndef LAYER_INVERSESPECTROGRAM_H
 #define LAYER_INVERSESPECTROGRAM_H
 
+#include "fft.h"
 #include "layer.h"
 
 namespace ncnn {
@@ -38,6 +39,8 @@ public:
     int normalized; // 0=disabled 1=sqrt(n_fft) 2=window-l2-energy
 
     Mat window_data;
+
+    FFT fft;
 };
 
 } // namespace ncnn
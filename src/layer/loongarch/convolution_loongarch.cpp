@@ -133,6 +133,13 @@ int Convolution_loongarch::create_pipeline(const Option& opt)
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
+        if (int8_dynamic_quantize)
+        {
+            // no kernel for runtime input scales here,
+            // forward() runs the reference int8 path instead
+            return 0;
+        }
+
         return create_pipeline_int8_loongarch(opt);
     }
 #endif
@@ -246,6 +253,22 @@ int Convolution_loongarch::destroy_pipeline(const Option& opt)
 int Convolution_loongarch::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
+    if (opt.use_int8_inference && int8_dynamic_quantize)
+    {
+        Mat bottom_blob_unpacked = bottom_blob;
+        if (bottom_blob.elempack != 1)
+        {
+            Option opt_pack1 = opt;
+            opt_pack1.blob_allocator = opt.workspace_allocator;
+
+            convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_pack1);
+        }
+
+        Option opt_unpacked = opt;
+        opt_unpacked.use_packing_layout = false;
+        return Convolution::forward_int8(bottom_blob_unpacked, top_blob, opt_unpacked);
+    }
+
     if (opt.use_int8_inference && int8_scale_term)
     {
         return forward_int8_loongarch(bottom_blob, top_blob, opt);
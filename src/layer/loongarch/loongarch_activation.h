@@ -62,6 +62,19 @@ static inline __m128 activation_ps(__m128 _v, int activation_type, const ncnn::M
         _outp = __lsx_vfmin_s(_outp, _one);
         _v = __lsx_vfmul_s(_outp, _v);
     }
+    else if (activation_type == 7)
+    {
+        // y = 0.5x * (1 + tanh(sqrt(2/Pi) * (x + 0.044715x^3)))
+        __m128 _cube = __lsx_vfmul_s(__lsx_vfmul_s(_v, _v), _v);
+        __m128 _t = __lsx_vfmadd_s(_cube, (__m128)__lsx_vreplfr2vr_s(0.044715f), _v);
+        _t = tanh_ps(__lsx_vfmul_s(_t, (__m128)__lsx_vreplfr2vr_s(0.79788452f)));
+        _t = __lsx_vfadd_s(_t, (__m128)__lsx_vreplfr2vr_s(1.f));
+        _v = __lsx_vfmul_s(__lsx_vfmul_s(_v, (__m128)__lsx_vreplfr2vr_s(0.5f)), _t);
+    }
+    else if (activation_type == 8)
+    {
+        _v = __lsx_vfmul_s(_v, sigmoid_ps(_v));
+    }
 
     return _v;
 }
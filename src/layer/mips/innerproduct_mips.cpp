@@ -46,9 +46,30 @@ int InnerProduct_mips::create_pipeline(const Option& opt)
         flatten->create_pipeline(opt);
     }
 
+    if (weight_quant_bits)
+    {
+        // no grouped int4/int8 kernels here, expand the weight to fp32 once
+        // and run as a plain float innerproduct from here on
+        Mat weight_data_fp32;
+        int ret = dequantize_weight_data(weight_data_fp32, opt);
+        if (ret != 0)
+            return ret;
+
+        weight_data = weight_data_fp32;
+        weight_data_group_scales.release();
+        weight_quant_bits = 0;
+    }
+
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
+        if (int8_dynamic_quantize)
+        {
+            // no kernel for runtime input scales here,
+            // forward() runs the reference int8 path instead
+            return 0;
+        }
+
         return create_pipeline_int8_mips(opt);
     }
 #endif
@@ -120,6 +141,22 @@ int InnerProduct_mips::destroy_pipeline(const Option& opt)
 int InnerProduct_mips::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
+    if (opt.use_int8_inference && int8_dynamic_quantize)
+    {
+        Mat bottom_blob_unpacked = bottom_blob;
+        if (bottom_blob.elempack != 1)
+        {
+            Option opt_pack1 = opt;
+            opt_pack1.blob_allocator = opt.workspace_allocator;
+
+            convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_pack1);
+        }
+
+        Option opt_unpacked = opt;
+        opt_unpacked.use_packing_layout = false;
+        return InnerProduct::forward_int8(bottom_blob_unpacked, top_blob, opt_unpacked);
+    }
+
     if (opt.use_int8_inference && int8_scale_term)
     {
         return forward_int8_mips(bottom_blob, top_blob, opt);
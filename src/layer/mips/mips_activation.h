@@ -62,6 +62,19 @@ static inline v4f32 activation_ps(v4f32 _v, int activation_type, const ncnn::Mat
         _outp = __msa_fmin_w(_outp, _one);
         _v = __msa_fmul_w(_outp, _v);
     }
+    else if (activation_type == 7)
+    {
+        // y = 0.5x * (1 + tanh(sqrt(2/Pi) * (x + 0.044715x^3)))
+        v4f32 _cube = __msa_fmul_w(__msa_fmul_w(_v, _v), _v);
+        v4f32 _t = __msa_fmadd_w(_v, _cube, (v4f32)__msa_fill_w_f32(0.044715f));
+        _t = tanh_ps(__msa_fmul_w(_t, (v4f32)__msa_fill_w_f32(0.79788452f)));
+        _t = __msa_fadd_w(_t, (v4f32)__msa_fill_w_f32(1.f));
+        _v = __msa_fmul_w(__msa_fmul_w(_v, (v4f32)__msa_fill_w_f32(0.5f)), _t);
+    }
+    else if (activation_type == 8)
+    {
+        _v = __msa_fmul_w(_v, sigmoid_ps(_v));
+    }
 
     return _v;
 }
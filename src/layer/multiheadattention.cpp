@@ -31,6 +31,7 @@ int MultiHeadAttention::load_param(const ParamDict& pd)
     vdim = pd.get(4, embed_dim);
     attn_mask = pd.get(5, 0);
     scale = pd.get(6, 1.f / sqrtf(embed_dim / num_heads));
+    kv_cache = pd.get(7, 0);
     int8_scale_term = pd.get(18, 0);
 
     return 0;
@@ -95,23 +96,42 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
     }
 #endif
 
+    // the past key and value cache come after the regular inputs
+    const size_t bottom_count = kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (bottom_count == 1 || (bottom_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (bottom_count == 1 || (bottom_count == 2 && attn_mask)) ? q_blob : (bottom_count == 2 || (bottom_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_count - 1] : Mat();
+    const Mat& past_k_blob = kv_cache ? bottom_blobs[bottom_count] : Mat();
+    const Mat& past_v_blob = kv_cache ? bottom_blobs[bottom_count + 1] : Mat();
 
     const int src_seqlen = q_blob.h;
-    const int dst_seqlen = k_blob.h;
+    const int past_seqlen = past_k_blob.empty() ? 0 : past_k_blob.w;
+    const int dst_seqlen = past_seqlen + k_blob.h;
     const int embed_dim_per_head = embed_dim / num_heads;
     const int qdim = weight_data_size / embed_dim;
 
     // assert k_blob.h == v_blob.h
+    // assert past_k_blob.w == past_v_blob.w
 
     Mat& top_blob = top_blobs[0];
     top_blob.create(qdim, src_seqlen, 4u, opt.blob_allocator);
     if (top_blob.empty())
         return -100;
 
+    // cache layout is the projected key and value, (dst_seqlen, embed_dim)
+    if (kv_cache)
+    {
+        top_blobs[1].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[1].empty())
+            return -100;
+
+        top_blobs[2].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[2].empty())
+            return -100;
+    }
+
     Mat xq(embed_dim_per_head, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xq.empty())
         return -100;
@@ -157,17 +177,27 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
             }
         }
 
-        // xk = affine(k)
+        // xk = concat(past_k, affine(k))
         {
             Mat outm = xk.channel(q);
 
-            for (int i = 0; i < dst_seqlen; i++)
+            for (int i = 0; i < past_seqlen; i++)
             {
                 float* outptr = outm.row(i);
 
                 for (int j = 0; j < embed_dim_per_head; j++)
                 {
-                    const float* ptr = k_blob.row(i);
+                    outptr[j] = past_k_blob.row(q * embed_dim_per_head + j)[i];
+                }
+            }
+
+            for (int i = past_seqlen; i < dst_seqlen; i++)
+            {
+                float* outptr = outm.row(i);
+
+                for (int j = 0; j < embed_dim_per_head; j++)
+                {
+                    const float* ptr = k_blob.row(i - past_seqlen);
                     const float* kptr = (const float*)k_weight_data + kdim * (q * embed_dim_per_head + j);
 
                     float sum = k_bias_data[q * embed_dim_per_head + j];
@@ -181,15 +211,25 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
             }
         }
 
-        // xv = affine(v)
+        // xv = concat(past_v, affine(v))
         {
             Mat outm = xv.channel(q);
 
             for (int i = 0; i < embed_dim_per_head; i++)
             {
-                for (int j = 0; j < dst_seqlen; j++)
+                float* outptr = outm.row(i);
+
+                for (int j = 0; j < past_seqlen; j++)
                 {
-                    const float* ptr = v_blob.row(j);
+                    outptr[j] = past_v_blob.row(q * embed_dim_per_head + i)[j];
+                }
+            }
+
+            for (int i = 0; i < embed_dim_per_head; i++)
+            {
+                for (int j = past_seqlen; j < dst_seqlen; j++)
+                {
+                    const float* ptr = v_blob.row(j - past_seqlen);
                     const float* kptr = (const float*)v_weight_data + vdim * (q * embed_dim_per_head + i);
 
                     float sum = v_bias_data[q * embed_dim_per_head + i];
@@ -205,6 +245,26 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
             }
         }
 
+        // new_k = xk, new_v = xv
+        if (kv_cache)
+        {
+            const Mat xkm = xk.channel(q);
+            const Mat xvm = xv.channel(q);
+
+            for (int i = 0; i < embed_dim_per_head; i++)
+            {
+                float* kcptr = top_blobs[1].row(q * embed_dim_per_head + i);
+                float* vcptr = top_blobs[2].row(q * embed_dim_per_head + i);
+                const float* vptr = xvm.row(i);
+
+                for (int j = 0; j < dst_seqlen; j++)
+                {
+                    kcptr[j] = xkm.row(j)[i];
+                    vcptr[j] = vptr[j];
+                }
+            }
+        }
+
         // xqk = xq * xk
         // xq  (embed_dim_per_head, src_seqlen)
         // xk  (embed_dim_per_head, dst_seqlen)
@@ -405,23 +465,42 @@ static void dynamic_quantize_2d_per_h(const Mat& blob, Mat& blob_int8, Mat& scal
 
 int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
+    // the past key and value cache come after the regular inputs
+    const size_t bottom_count = kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (bottom_count == 1 || (bottom_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (bottom_count == 1 || (bottom_count == 2 && attn_mask)) ? q_blob : (bottom_count == 2 || (bottom_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_count - 1] : Mat();
+    const Mat& past_k_blob = kv_cache ? bottom_blobs[bottom_count] : Mat();
+    const Mat& past_v_blob = kv_cache ? bottom_blobs[bottom_count + 1] : Mat();
 
     const int src_seqlen = q_blob.h;
-    const int dst_seqlen = k_blob.h;
+    const int past_seqlen = past_k_blob.empty() ? 0 : past_k_blob.w;
+    const int dst_seqlen = past_seqlen + k_blob.h;
     const int embed_dim_per_head = embed_dim / num_heads;
     const int qdim = weight_data_size / embed_dim;
 
     // assert k_blob.h == v_blob.h
+    // assert past_k_blob.w == past_v_blob.w
 
     Mat& top_blob = top_blobs[0];
     top_blob.create(qdim, src_seqlen, 4u, opt.blob_allocator);
     if (top_blob.empty())
         return -100;
 
+    // cache layout is the projected key and value, (dst_seqlen, embed_dim)
+    if (kv_cache)
+    {
+        top_blobs[1].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[1].empty())
+            return -100;
+
+        top_blobs[2].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[2].empty())
+            return -100;
+    }
+
     Mat xq(embed_dim_per_head, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xq.empty())
         return -100;
@@ -448,7 +527,7 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
     // dynamic quantize k_blob
     Mat k_blob_int8;
     float k_blob_int8_scale;
-    if (bottom_blobs.size() == 1)
+    if (bottom_count == 1)
     {
         k_blob_int8 = q_blob_int8;
         k_blob_int8_scale = q_blob_int8_scale;
@@ -461,12 +540,12 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
     // dynamic quantize v_blob
     Mat v_blob_int8;
     float v_blob_int8_scale;
-    if (bottom_blobs.size() == 1)
+    if (bottom_count == 1)
     {
         v_blob_int8 = q_blob_int8;
         v_blob_int8_scale = q_blob_int8_scale;
     }
-    else if (bottom_blobs.size() == 2)
+    else if (bottom_count == 2)
     {
         v_blob_int8 = k_blob_int8;
         v_blob_int8_scale = k_blob_int8_scale;
@@ -507,9 +586,21 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
             }
         }
 
-        // xk = affine(k)
+        // xk = concat(past_k, affine(k))
         {
-            float* outptr = xk.channel(q);
+            Mat outm = xk.channel(q);
+
+            for (int i = 0; i < past_seqlen; i++)
+            {
+                float* outptr = outm.row(i);
+
+                for (int j = 0; j < embed_dim_per_head; j++)
+                {
+                    outptr[j] = past_k_blob.row(q * embed_dim_per_head + j)[i];
+                }
+            }
+
+            float* outptr = outm.row(past_seqlen);
 
             for (int i = 0; i < k_blob_int8.h; i++)
             {
@@ -531,7 +622,7 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
             }
         }
 
-        // xv = affine(v)
+        // xv = concat(past_v, affine(v))
         {
             Mat outm = xv.channel(q);
 
@@ -539,6 +630,11 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
             {
                 float* outptr = outm.row(i);
 
+                for (int j = 0; j < past_seqlen; j++)
+                {
+                    *outptr++ = past_v_blob.row(q * embed_dim_per_head + i)[j];
+                }
+
                 for (int j = 0; j < v_blob_int8.h; j++)
                 {
                     const signed char* ptr = v_blob_int8.row<const signed char>(j);
@@ -557,6 +653,26 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
             }
         }
 
+        // new_k = xk, new_v = xv
+        if (kv_cache)
+        {
+            const Mat xkm = xk.channel(q);
+            const Mat xvm = xv.channel(q);
+
+            for (int i = 0; i < embed_dim_per_head; i++)
+            {
+                float* kcptr = top_blobs[1].row(q * embed_dim_per_head + i);
+                float* vcptr = top_blobs[2].row(q * embed_dim_per_head + i);
+                const float* vptr = xvm.row(i);
+
+                for (int j = 0; j < dst_seqlen; j++)
+                {
+                    kcptr[j] = xkm.row(j)[i];
+                    vcptr[j] = vptr[j];
+                }
+            }
+        }
+
         // xqk = xq * xk
         // xq  (embed_dim_per_head, src_seqlen)
         // xk  (embed_dim_per_head, dst_seqlen)
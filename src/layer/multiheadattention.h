@@ -43,6 +43,7 @@ public:
     int vdim;
     int attn_mask;
     float scale;
+    int kv_cache;
 
     int int8_scale_term;
 
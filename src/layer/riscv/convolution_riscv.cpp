@@ -239,7 +239,7 @@ int Convolution_riscv::destroy_pipeline(const Option& opt)
 int Convolution_riscv::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
-    if (opt.use_int8_inference && int8_scale_term)
+    if (opt.use_int8_inference && (int8_scale_term || int8_dynamic_quantize))
     {
         Mat bottom_blob_unpacked = bottom_blob;
         if (bottom_blob.elempack != 1)
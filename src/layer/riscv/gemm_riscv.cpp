@@ -18,6 +18,7 @@
 #include <riscv_vector.h>
 #endif // __riscv_vector
 
+#include "riscv_activation.h"
 #include "riscv_usability.h"
 
 #include "cpu.h"
@@ -32,6 +33,8 @@ Gemm_riscv::Gemm_riscv()
     one_blob_only = false;
     support_inplace = false;
 
+    activation = 0;
+
     nT = 0;
 }
 
@@ -1989,6 +1992,20 @@ int Gemm_riscv::create_pipeline(const Option& opt)
         nT = opt.num_threads;
     }
 
+    activation = create_activation_layer(activation_type, activation_params, opt);
+
+    return 0;
+}
+
+int Gemm_riscv::destroy_pipeline(const Option& opt)
+{
+    if (activation)
+    {
+        activation->destroy_pipeline(opt);
+        delete activation;
+        activation = 0;
+    }
+
     return 0;
 }
 
@@ -2183,6 +2200,11 @@ int Gemm_riscv::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         }
     }
 
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
     return 0;
 }
 
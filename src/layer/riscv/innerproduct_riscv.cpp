@@ -54,6 +54,20 @@ int InnerProduct_riscv::create_pipeline(const Option& opt)
         flatten->create_pipeline(opt);
     }
 
+    if (weight_quant_bits)
+    {
+        // no grouped int4/int8 kernels here, expand the weight to fp32 once
+        // and run as a plain float innerproduct from here on
+        Mat weight_data_fp32;
+        int ret = dequantize_weight_data(weight_data_fp32, opt);
+        if (ret != 0)
+            return ret;
+
+        weight_data = weight_data_fp32;
+        weight_data_group_scales.release();
+        weight_quant_bits = 0;
+    }
+
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
@@ -132,7 +146,7 @@ int InnerProduct_riscv::destroy_pipeline(const Option& opt)
 int InnerProduct_riscv::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
-    if (opt.use_int8_inference && int8_scale_term)
+    if (opt.use_int8_inference && (int8_scale_term || int8_dynamic_quantize))
     {
         Mat bottom_blob_unpacked = bottom_blob;
         if (bottom_blob.elempack != 1)
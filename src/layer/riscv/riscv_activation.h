@@ -62,6 +62,18 @@
                                                                                                                                                                               \
             vfloat##SEW##m##LMUL##_t _p0 = __riscv_vfadd_vf_f##SEW##m##LMUL##_m(_apply, __riscv_vfmul_vf_f##SEW##m##LMUL##_m(_apply, _v, (STYPE)alpha, vl), (STYPE)beta, vl); \
             _v = __riscv_vfmul_vv_f##SEW##m##LMUL##_mu(_apply, _v, _v, _p0, vl);                                                                                              \
+        }                                                                                                                                                                     \
+        else if (activation_type == 7)                                                                                                                                        \
+        {                                                                                                                                                                     \
+            vfloat##SEW##m##LMUL##_t _cube = __riscv_vfmul_vv_f##SEW##m##LMUL(__riscv_vfmul_vv_f##SEW##m##LMUL(_v, _v, vl), _v, vl);                                          \
+            vfloat##SEW##m##LMUL##_t _t = __riscv_vfmacc_vf_f##SEW##m##LMUL(_v, (STYPE)0.044715f, _cube, vl);                                                                 \
+            _t = tanh_ps(__riscv_vfmul_vf_f##SEW##m##LMUL(_t, (STYPE)0.79788452f, vl), vl);                                                                                   \
+            _t = __riscv_vfadd_vf_f##SEW##m##LMUL(_t, (STYPE)1.f, vl);                                                                                                        \
+            _v = __riscv_vfmul_vv_f##SEW##m##LMUL(__riscv_vfmul_vf_f##SEW##m##LMUL(_v, (STYPE)0.5f, vl), _t, vl);                                                             \
+        }                                                                                                                                                                     \
+        else if (activation_type == 8)                                                                                                                                        \
+        {                                                                                                                                                                     \
+            _v = __riscv_vfmul_vv_f##SEW##m##LMUL(_v, sigmoid_ps(_v, vl), vl);                                                                                                \
         }                                                                                                                                                                     \
                                                                                                                                                                               \
         return _v;                                                                                                                                                            \
@@ -14,6 +14,8 @@
 
 #include "spectrogram.h"
 
+#include "cpu.h"
+
 namespace ncnn {
 
 Spectrogram::Spectrogram()
@@ -84,6 +86,10 @@ int Spectrogram::load_param(const ParamDict& pd)
         }
     }
 
+    // precompute twiddle factors
+    if (n_fft > 0)
+        fft.create(n_fft);
+
     return 0;
 }
 
@@ -126,63 +132,61 @@ int Spectrogram::forward(const Mat& bottom_blob, Mat& top_blob, const Option& op
     if (top_blob.empty())
         return -100;
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int i = 0; i < freqs_onesided; i++)
+    // per thread windowed frame + onesided spectrum + fft workspace
+    const int frame_size = n_fft + freqs_onesided * 2 + fft.workspace_size();
+
+    Mat frame_workspace(frame_size, opt.num_threads, (size_t)4u, opt.workspace_allocator);
+    if (frame_workspace.empty())
+        return -100;
+
+    float norm = 1.f;
+    if (normalized == 1)
     {
-        const float* ptr = bottom_blob_bordered;
-        float* outptr = power == 0 ? top_blob.channel(i) : top_blob.row(i);
+        norm = 1.f / sqrt(n_fft);
+    }
+    if (normalized == 2)
+    {
+        norm = window_data[n_fft];
+    }
 
-        for (int j = 0; j < frames; j++)
-        {
-            float re = 0.f;
-            float im = 0.f;
-            for (int k = 0; k < n_fft; k++)
-            {
-                float v = ptr[k];
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int j = 0; j < frames; j++)
+    {
+        const float* ptr = (const float*)bottom_blob_bordered + j * hoplen;
 
-                // apply window
-                v *= window_data[k];
+        float* frame = frame_workspace.row(get_omp_thread_num());
+        float* spec = frame + n_fft;
+        float* workspace = spec + freqs_onesided * 2;
 
-                // dft
-                double angle = 2 * 3.14159265358979323846 * i * k / n_fft;
+        // apply window
+        for (int k = 0; k < n_fft; k++)
+        {
+            frame[k] = ptr[k] * window_data[k];
+        }
 
-                re += v * cosf(angle); // + imag * sinf(angle);
-                im -= v * sinf(angle); // + imag * cosf(angle);
-            }
+        fft.forward_real(frame, spec, workspace);
 
-            if (normalized == 1)
-            {
-                float norm = 1.f / sqrt(n_fft);
-                re *= norm;
-                im *= norm;
-            }
-            if (normalized == 2)
-            {
-                float norm = window_data[n_fft];
-                re *= norm;
-                im *= norm;
-            }
+        for (int i = 0; i < freqs_onesided; i++)
+        {
+            const float re = spec[i * 2] * norm;
+            const float im = spec[i * 2 + 1] * norm;
 
             if (power == 0)
             {
                 // complex as real
+                float* outptr = top_blob.channel(i).row(j);
                 outptr[0] = re;
                 outptr[1] = im;
-                outptr += 2;
             }
             if (power == 1)
             {
                 // magnitude
-                outptr[0] = sqrt(re * re + im * im);
-                outptr += 1;
+                top_blob.row(i)[j] = sqrt(re * re + im * im);
             }
             if (power == 2)
             {
-                outptr[0] = re * re + im * im;
-                outptr += 1;
+                top_blob.row(i)[j] = re * re + im * im;
             }
-
-            ptr += hoplen;
         }
     }
 
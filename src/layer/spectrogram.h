@@ -15,6 +15,7 @@
 #ifndef LAYER_SPECTROGRAM_H
 #define LAYER_SPECTROGRAM_H
 
+#include "fft.h"
 #include "layer.h"
 
 namespace ncnn {
@@ -40,6 +41,8 @@ public:
     int onesided;
 
     Mat window_data;
+
+    FFT fft;
 };
 
 } // namespace ncnn
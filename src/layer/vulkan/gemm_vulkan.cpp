@@ -70,7 +70,7 @@ int Gemm_vulkan::create_pipeline(const Option& opt)
         C_data_packed = C_data;
     }
 
-    std::vector<vk_specialization_type> specializations(15);
+    std::vector<vk_specialization_type> specializations(18);
     specializations[0].f = alpha;
     specializations[1].f = beta;
     specializations[2].i = transA;
@@ -86,6 +86,9 @@ int Gemm_vulkan::create_pipeline(const Option& opt)
     specializations[12].i = output_elempack;
     specializations[13].i = output_elemtype;
     specializations[14].i = output_transpose;
+    specializations[15].i = activation_type;
+    specializations[16].f = activation_params.w >= 1 ? activation_params[0] : 0.f;
+    specializations[17].f = activation_params.w == 2 ? activation_params[1] : 0.f;
 
     Mat local_size_xyz;
     // if (shape_packed.dims == 2)
@@ -33,6 +33,18 @@ InnerProduct_vulkan::InnerProduct_vulkan()
     pipeline_innerproduct_gemm = 0;
 }
 
+int InnerProduct_vulkan::load_param(const ParamDict& pd)
+{
+    int ret = InnerProduct::load_param(pd);
+
+    if (weight_quant_bits)
+    {
+        support_vulkan = false;
+    }
+
+    return ret;
+}
+
 int InnerProduct_vulkan::create_pipeline(const Option& _opt)
 {
     Option opt = _opt;
@@ -51,6 +51,13 @@ int MultiHeadAttention_vulkan::load_param(const ParamDict& pd)
         support_vulkan = false;
     }
 
+    if (kv_cache)
+    {
+        // the cache blobs are concatenated and handed back on cpu every step
+        // so forward on cpu rather than round-tripping them through the device
+        support_vulkan = false;
+    }
+
     return ret;
 }
 
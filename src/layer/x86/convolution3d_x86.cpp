@@ -0,0 +1,250 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "convolution3d_x86.h"
+
+#include "layer_type.h"
+
+namespace ncnn {
+
+Convolution3D_x86::Convolution3D_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+
+    convolution_2d = 0;
+}
+
+int Convolution3D_x86::create_pipeline(const Option& opt)
+{
+    const int maxk = kernel_w * kernel_h * kernel_d;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    // output depth z reads the input depth slices z * stride_d + kz * dilation_d
+    // stacking them as kernel_d * num_input channels turns each output slice into one 2d convolution
+    // whose weight is reordered from outch-inch-kd-kh-kw to outch-kd-inch-kh-kw
+    const int maxk_2d = kernel_w * kernel_h;
+
+    Mat weight_data_2d;
+    {
+        weight_data_2d.create(weight_data_size);
+
+        const float* kptr = weight_data;
+        float* g00 = weight_data_2d;
+
+        for (int p = 0; p < num_output; p++)
+        {
+            for (int z = 0; z < kernel_d; z++)
+            {
+                for (int q = 0; q < num_input; q++)
+                {
+                    const float* k00 = kptr + ((p * num_input + q) * kernel_d + z) * maxk_2d;
+
+                    for (int k = 0; k < maxk_2d; k++)
+                    {
+                        g00[k] = k00[k];
+                    }
+
+                    g00 += maxk_2d;
+                }
+            }
+        }
+    }
+
+    convolution_2d = ncnn::create_layer_cpu(ncnn::LayerType::Convolution);
+
+    ncnn::ParamDict pd;
+    pd.set(0, num_output);
+    pd.set(1, kernel_w);
+    pd.set(11, kernel_h);
+    pd.set(2, dilation_w);
+    pd.set(12, dilation_h);
+    pd.set(3, stride_w);
+    pd.set(13, stride_h);
+    pd.set(4, 0);  // pad_w
+    pd.set(14, 0); // pad_h
+    pd.set(5, bias_term);
+    pd.set(6, weight_data_size);
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    convolution_2d->load_param(pd);
+
+    ncnn::Mat weights[2];
+    weights[0] = weight_data_2d;
+    weights[1] = bias_data;
+
+    convolution_2d->load_model(ModelBinFromMatArray(weights));
+
+    convolution_2d->create_pipeline(opt);
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int Convolution3D_x86::destroy_pipeline(const Option& opt)
+{
+    if (convolution_2d)
+    {
+        convolution_2d->destroy_pipeline(opt);
+        delete convolution_2d;
+        convolution_2d = 0;
+    }
+
+    return 0;
+}
+
+int Convolution3D_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+    const int kernel_extent_d = dilation_d * (kernel_d - 1) + 1;
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob, bottom_blob_bordered, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+    const int d = bottom_blob_bordered.d;
+    const int channels = bottom_blob_bordered.c;
+    const size_t elemsize = bottom_blob_bordered.elemsize;
+    const int elempack = bottom_blob_bordered.elempack;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+    const int outh = (h - kernel_extent_h) / stride_h + 1;
+    const int outd = (d - kernel_extent_d) / stride_d + 1;
+
+    if (kernel_w == 1 && kernel_h == 1 && kernel_d == 1 && stride_w == 1 && stride_h == 1 && stride_d == 1)
+    {
+        // pointwise, the whole volume as one wide image
+        Mat bottom_blob_2 = bottom_blob_bordered;
+        {
+            bottom_blob_2.dims = 3;
+            bottom_blob_2.w = w * h * d;
+            bottom_blob_2.h = 1;
+            bottom_blob_2.d = 1;
+        }
+
+        Mat top_blob_2;
+        int ret = convolution_2d->forward(bottom_blob_2, top_blob_2, opt);
+        if (ret != 0)
+            return ret;
+
+        top_blob = top_blob_2.reshape(outw, outh, outd, top_blob_2.c);
+        if (top_blob.empty())
+            return -100;
+
+        return 0;
+    }
+
+    const int num_input_2d = channels * elempack * kernel_d;
+
+    int elempack_2d = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        elempack_2d = num_input_2d % 16 == 0 ? 16 : num_input_2d % 8 == 0 ? 8 : num_input_2d % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        elempack_2d = num_input_2d % 8 == 0 ? 8 : num_input_2d % 4 == 0 ? 4 : 1;
+#else
+        elempack_2d = num_input_2d % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+
+    Option opt_ws = opt;
+    opt_ws.blob_allocator = opt.workspace_allocator;
+
+    // a single depth slice of all channels is a 2d blob with the channel step of the volume
+    // only valid when the slice keeps the 16 byte channel alignment, it is never written to
+    const size_t slice_size = (size_t)w * h * elemsize;
+    const bool bottom_slice_view = kernel_d == 1 && elempack_2d == elempack && slice_size % 16 == 0;
+
+    Mat bottom_slices;
+    if (!bottom_slice_view)
+    {
+        bottom_slices.create(w, h, channels * kernel_d, elemsize, elempack, opt.workspace_allocator);
+        if (bottom_slices.empty())
+            return -100;
+    }
+
+    for (int z = 0; z < outd; z++)
+    {
+        Mat bottom_blob_z;
+        if (bottom_slice_view)
+        {
+            bottom_blob_z = Mat(w, h, channels, (unsigned char*)bottom_blob_bordered.data + z * stride_d * slice_size, elemsize, elempack, bottom_blob_bordered.allocator);
+            bottom_blob_z.cstep = bottom_blob_bordered.cstep;
+        }
+        else
+        {
+            // gather the kernel_d input depths of output depth z as channels
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels; q++)
+            {
+                const Mat m = bottom_blob_bordered.channel(q);
+
+                for (int kz = 0; kz < kernel_d; kz++)
+                {
+                    memcpy(bottom_slices.channel(kz * channels + q), m.depth(z * stride_d + kz * dilation_d), slice_size);
+                }
+            }
+
+            bottom_blob_z = bottom_slices;
+
+            // stacking may change the channel count divisibility, repack the gathered slices as a whole
+            if (elempack_2d != elempack)
+            {
+                Mat bottom_blob_z_packed;
+                convert_packing(bottom_slices, bottom_blob_z_packed, elempack_2d, opt_ws);
+                if (bottom_blob_z_packed.empty())
+                    return -100;
+
+                bottom_blob_z = bottom_blob_z_packed;
+            }
+        }
+
+        Mat top_blob_z;
+        int ret = convolution_2d->forward(bottom_blob_z, top_blob_z, opt_ws);
+        if (ret != 0)
+            return ret;
+
+        if (z == 0)
+        {
+            top_blob.create(outw, outh, outd, top_blob_z.c, top_blob_z.elemsize, top_blob_z.elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+        }
+
+        // scatter the 2d output into depth z of every output channel
+        const int out_channels = top_blob.c;
+        const size_t out_slice_size = (size_t)outw * outh * top_blob.elemsize;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < out_channels; p++)
+        {
+            memcpy(top_blob.channel(p).depth(z), top_blob_z.channel(p), out_slice_size);
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -340,6 +340,15 @@ int Convolution_x86::create_pipeline(const Option& opt)
         return 0;
     }
 
+    if (!weight_winograd23_data.empty() || !weight_winograd43_data.empty() || !weight_winograd63_data.empty() || !weight_sgemm_data.empty() || !weight_data_tm.empty())
+    {
+        // transformed weights restored from weight cache
+        if (opt.lightmode)
+            weight_data.release();
+
+        return 0;
+    }
+
     int elempack = 1;
     int out_elempack = 1;
 
@@ -359,9 +368,25 @@ int Convolution_x86::create_pipeline(const Option& opt)
     }
 #endif // __SSE2__
 
+    // kernel picked by auto tuning
+    if (tuning_variant >= 1 && tuning_variant <= 3)
+    {
+        if (tuning_variant == 1)
+            conv3x3s1_winograd23_transform_kernel(weight_data, weight_winograd23_data, num_input, num_output, opt);
+        if (tuning_variant == 2)
+            conv3x3s1_winograd43_transform_kernel(weight_data, weight_winograd43_data, num_input, num_output, opt);
+        if (tuning_variant == 3)
+            conv3x3s1_winograd63_transform_kernel(weight_data, weight_winograd63_data, num_input, num_output, opt);
+
+        if (opt.lightmode)
+            weight_data.release();
+
+        return 0;
+    }
+
     bool prefer_winograd = (opt.use_winograd23_convolution || opt.use_winograd43_convolution || opt.use_winograd63_convolution) && (num_input > 8 || num_output > 8);
 
-    if (opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+    if (tuning_variant == 0 && opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
     {
         if ((bottom_shapes.empty() || bottom_shapes[0].w == 0 || bottom_shapes[0].h == 0) && (top_shapes.empty() || top_shapes[0].w == 0 || top_shapes[0].h == 0))
         {
@@ -461,7 +486,7 @@ int Convolution_x86::create_pipeline(const Option& opt)
     int l2_cache_size = get_cpu_level2_cache_size();
     bool prefer_sgemm = num_input * num_output * kernel_w * kernel_h * dilation_w * dilation_h * stride_w * stride_h * (int)sizeof(float) * 2 > l2_cache_size || (num_input > 16 || num_output > 16);
 
-    if ((opt.use_sgemm_convolution && prefer_sgemm) || (kernel_w == 1 && kernel_h == 1))
+    if ((tuning_variant == 0 && ((opt.use_sgemm_convolution && prefer_sgemm) || (kernel_w == 1 && kernel_h == 1))) || tuning_variant == 4)
     {
         convolution_im2col_gemm_transform_kernel(weight_data, weight_sgemm_data, num_input, num_output, kernel_w, kernel_h, opt);
 
@@ -493,6 +518,51 @@ int Convolution_x86::create_pipeline(const Option& opt)
     return 0;
 }
 
+int Convolution_x86::pipeline_weights(std::vector<Mat*>& weights)
+{
+    weights.push_back(&weight_data_tm);
+    weights.push_back(&weight_sgemm_data);
+    weights.push_back(&weight_winograd23_data);
+    weights.push_back(&weight_winograd43_data);
+    weights.push_back(&weight_winograd63_data);
+
+    return 0;
+}
+
+int Convolution_x86::tuning_variants(std::vector<int>& variants, const Option& opt) const
+{
+    if (dynamic_weight)
+        return 0;
+
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+        return 0;
+#endif
+
+    if (!opt.use_packing_layout && kernel_w == kernel_h && dilation_w != 1 && dilation_h == dilation_w && stride_w == 1 && stride_h == 1)
+        return 0;
+
+    // 0 = heuristic, 1 = winograd23, 2 = winograd43, 3 = winograd63, 4 = im2col gemm, 5 = direct
+    variants.push_back(0);
+
+    if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+    {
+        if (opt.use_winograd23_convolution)
+            variants.push_back(1);
+        if (opt.use_winograd43_convolution)
+            variants.push_back(2);
+        if (opt.use_winograd63_convolution)
+            variants.push_back(3);
+    }
+
+    if (opt.use_sgemm_convolution || (kernel_w == 1 && kernel_h == 1))
+        variants.push_back(4);
+
+    variants.push_back(5);
+
+    return 0;
+}
+
 int Convolution_x86::destroy_pipeline(const Option& opt)
 {
     if (activation)
@@ -515,7 +585,7 @@ int Convolution_x86::destroy_pipeline(const Option& opt)
 int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
-    if (opt.use_int8_inference && int8_scale_term)
+    if (opt.use_int8_inference && (int8_scale_term || int8_dynamic_quantize))
     {
         return forward_int8_x86(bottom_blob, top_blob, opt);
     }
@@ -607,6 +677,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     {
         if (outw >= dilation_w && outh >= dilation_h)
         {
+            profile_kernel("dilation");
             return forwardDilation_x86(bottom_blob_bordered, top_blob, opt);
         }
     }
@@ -615,10 +686,10 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
 
     bool prefer_winograd = (opt.use_winograd23_convolution || opt.use_winograd43_convolution || opt.use_winograd63_convolution) && (num_input > 8 || num_output > 8);
 
-    if (opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+    if ((tuning_variant == 0 && opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1) || (tuning_variant >= 1 && tuning_variant <= 3))
     {
-        bool prefer_winograd63 = test_prefer_winograd63(num_input, num_output, w, h);
-        bool prefer_winograd23 = test_prefer_winograd23(num_input, num_output, w, h);
+        bool prefer_winograd63 = tuning_variant == 0 ? test_prefer_winograd63(num_input, num_output, w, h) : tuning_variant == 3;
+        bool prefer_winograd23 = tuning_variant == 0 ? test_prefer_winograd23(num_input, num_output, w, h) : tuning_variant == 1;
         bool prefer_winograd43 = !prefer_winograd63 && !prefer_winograd23;
 
         if (prefer_winograd23 && (!opt.use_winograd23_convolution || weight_winograd23_data.empty()))
@@ -660,14 +731,17 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         int ret = 0;
         if (prefer_winograd23)
         {
+            profile_kernel("winograd23");
             ret = conv3x3s1_winograd23(bottom_blob_bordered, top_blob, weight_winograd23_data, bias_data, _nT, opt);
         }
         else if (prefer_winograd43)
         {
+            profile_kernel("winograd43");
             ret = conv3x3s1_winograd43(bottom_blob_bordered, top_blob, weight_winograd43_data, bias_data, _nT, opt);
         }
         else if (prefer_winograd63)
         {
+            profile_kernel("winograd63");
             ret = conv3x3s1_winograd63(bottom_blob_bordered, top_blob, weight_winograd63_data, bias_data, _nT, opt);
         }
         else
@@ -687,7 +761,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     int l2_cache_size = get_cpu_level2_cache_size();
     bool prefer_sgemm = num_input * num_output * kernel_w * kernel_h * dilation_w * dilation_h * stride_w * stride_h * (int)sizeof(float) * 2 > l2_cache_size || (num_input > 16 || num_output > 16);
 
-    if ((opt.use_sgemm_convolution && prefer_sgemm) || (kernel_w == 1 && kernel_h == 1))
+    if ((tuning_variant == 0 && ((opt.use_sgemm_convolution && prefer_sgemm) || (kernel_w == 1 && kernel_h == 1))) || tuning_variant == 4)
     {
         int _nT = nT ? nT : opt.num_threads;
         if (nT != 0 && opt.num_threads != nT)
@@ -697,6 +771,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
             NCNN_LOGE("opt.num_threads %d changed, convolution gemm will use load-time value %d", opt.num_threads, nT);
         }
 
+        profile_kernel("sgemm");
         int ret = convolution_im2col_gemm(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, _nT, opt);
         if (ret != 0)
             return ret;
@@ -708,6 +783,9 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         return 0;
     }
 
+    // hand-written kernels below, convolution_packed as fallback
+    profile_kernel("direct");
+
 #if __SSE2__
 #if __AVX__
 #if __AVX512F__
@@ -814,6 +892,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     }
 #endif // __SSE2__
 
+    profile_kernel("packed");
     convolution_packed(bottom_blob_bordered, top_blob, weight_data_tm, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
 
     return 0;
@@ -901,7 +980,11 @@ int Convolution_x86::create_pipeline_int8_x86(const Option& opt)
 
     bool prefer_winograd = (opt.use_winograd23_convolution || opt.use_winograd43_convolution) && (num_input > 8 || num_output > 8);
 
-    if (opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+    if (!weight_winograd23_data.empty() || !weight_winograd43_data.empty() || !weight_sgemm_data.empty() || !weight_data_tm.empty())
+    {
+        // transformed weights restored from weight cache
+    }
+    else if (opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
     {
         if (opt.use_winograd43_convolution)
             conv3x3s1_winograd43_transform_kernel_int8(weight_data, weight_winograd43_data, num_input, num_output, opt);
@@ -917,17 +1000,21 @@ int Convolution_x86::create_pipeline_int8_x86(const Option& opt)
         convolution_transform_kernel_packed_int8(weight_data, weight_data_tm, num_input, num_output, kernel_w, kernel_h);
     }
 
-    scale_in_data.create(num_output);
-    for (int p = 0; p < num_output; p++)
+    // dynamic quantization resolves input scales in forward
+    if (!int8_dynamic_quantize)
     {
-        // requantize and relu
-        float scale_in;
-        if (weight_data_int8_scales[p] == 0)
-            scale_in = 0;
-        else
-            scale_in = 1.f / (bottom_blob_int8_scales[0] * weight_data_int8_scales[p]);
+        scale_in_data.create(num_output);
+        for (int p = 0; p < num_output; p++)
+        {
+            // requantize and relu
+            float scale_in;
+            if (weight_data_int8_scales[p] == 0)
+                scale_in = 0;
+            else
+                scale_in = 1.f / (bottom_blob_int8_scales[0] * weight_data_int8_scales[p]);
 
-        scale_in_data[p] = scale_in;
+            scale_in_data[p] = scale_in;
+        }
     }
 
     if (opt.lightmode)
@@ -936,12 +1023,150 @@ int Convolution_x86::create_pipeline_int8_x86(const Option& opt)
     return 0;
 }
 
+static float absmax_fp32(const Mat& bottom_blob, const Option& opt)
+{
+    const int channels = bottom_blob.c;
+    const int size = bottom_blob.w * bottom_blob.h * bottom_blob.d * bottom_blob.elempack;
+
+    std::vector<float> absmax(channels, 0.f);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        const float* ptr = bottom_blob.channel(q);
+
+        float m = 0.f;
+        for (int i = 0; i < size; i++)
+        {
+            m = std::max(m, (float)fabs(ptr[i]));
+        }
+
+        absmax[q] = m;
+    }
+
+    float m = 0.f;
+    for (int q = 0; q < channels; q++)
+    {
+        m = std::max(m, absmax[q]);
+    }
+
+    return m;
+}
+
+static int quantize_to_int8_per_pixel(const Mat& bottom_blob, Mat& bottom_blob_int8, Mat& scales, const Option& opt)
+{
+    const int size = bottom_blob.w * bottom_blob.h;
+    const int elempack = bottom_blob.elempack;
+    const int num_input = bottom_blob.c * elempack;
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+        out_elempack = num_input % 8 == 0 ? 8 : 1;
+    }
+#endif
+
+    bottom_blob_int8.create(bottom_blob.w, bottom_blob.h, num_input / out_elempack, (size_t)out_elempack, out_elempack, opt.workspace_allocator);
+    scales.create(size, (size_t)4u, opt.workspace_allocator);
+    if (bottom_blob_int8.empty() || scales.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < size; i++)
+    {
+        float absmax = 0.f;
+        for (int q = 0; q < num_input; q++)
+        {
+            const float* ptr = bottom_blob.channel(q / elempack);
+            absmax = std::max(absmax, (float)fabs(ptr[i * elempack + q % elempack]));
+        }
+
+        const float scale = absmax == 0.f ? 1.f : 127.f / absmax;
+        for (int q = 0; q < num_input; q++)
+        {
+            const float* ptr = bottom_blob.channel(q / elempack);
+            signed char* outptr = bottom_blob_int8.channel(q / out_elempack);
+            outptr[i * out_elempack + q % out_elempack] = float2int8(ptr[i * elempack + q % elempack] * scale);
+        }
+
+        scales[i] = scale;
+    }
+
+    return 0;
+}
+
+static void dequantize_from_int32_per_pixel(const Mat& top_blob_int32, Mat& top_blob, const Mat& bottom_scales, const Mat& weight_scales, const Mat& bias_data, const Option& opt)
+{
+    const int size = top_blob.w * top_blob.h;
+    const int elempack_int32 = top_blob_int32.elempack;
+    const int out_elempack = top_blob.elempack;
+    const int num_output = top_blob.c * out_elempack;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        const int* ptr = top_blob_int32.channel(p / elempack_int32);
+        float* outptr = top_blob.channel(p / out_elempack);
+
+        const float scale_w = weight_scales[p];
+        const float bias = bias_data.empty() ? 0.f : bias_data[p];
+
+        for (int i = 0; i < size; i++)
+        {
+            const float scale_in = scale_w == 0 ? 0.f : 1.f / (bottom_scales[i] * scale_w);
+            outptr[i * out_elempack + p % out_elempack] = ptr[i * elempack_int32 + p % elempack_int32] * scale_in + bias;
+        }
+    }
+}
+
 int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
     int elembits = bottom_blob.elembits();
 
+    // one scale per pixel for 1x1 stride 1 convolution, one scale for the whole blob otherwise
+    const bool dynamic_quantize_per_pixel = int8_dynamic_quantize && elembits != 8 && kernel_w == 1 && kernel_h == 1 && stride_w == 1 && stride_h == 1;
+
     Mat bottom_blob_int8 = bottom_blob;
-    if (elembits != 8)
+    Mat bottom_scales;
+    Mat scale_in_dynamic;
+    if (dynamic_quantize_per_pixel)
+    {
+        // pad first, pixels of padding get their own scales
+        Mat bottom_blob_bordered_fp32;
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        make_padding(bottom_blob, bottom_blob_bordered_fp32, opt_b);
+        if (bottom_blob_bordered_fp32.empty())
+            return -100;
+
+        int ret = quantize_to_int8_per_pixel(bottom_blob_bordered_fp32, bottom_blob_int8, bottom_scales, opt);
+        if (ret != 0)
+            return ret;
+    }
+    else if (elembits != 8 && int8_dynamic_quantize)
+    {
+        const float absmax = absmax_fp32(bottom_blob, opt);
+
+        bottom_scales.create(1);
+        bottom_scales[0] = absmax == 0.f ? 1.f : 127.f / absmax;
+
+        scale_in_dynamic.create(num_output);
+        for (int p = 0; p < num_output; p++)
+        {
+            if (weight_data_int8_scales[p] == 0)
+                scale_in_dynamic[p] = 0;
+            else
+                scale_in_dynamic[p] = 1.f / (bottom_scales[0] * weight_data_int8_scales[p]);
+        }
+
+        Option opt_q = opt;
+        opt_q.blob_allocator = opt.workspace_allocator;
+        quantize_to_int8(bottom_blob, bottom_blob_int8, bottom_scales, opt_q);
+        if (bottom_blob_int8.empty())
+            return -100;
+    }
+    else if (elembits != 8)
     {
         Option opt_q = opt;
         opt_q.blob_allocator = opt.workspace_allocator;
@@ -952,10 +1177,13 @@ int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, con
 
     //     NCNN_LOGE("Convolution_x86 input %d x %d  ksize=%d %d  stride=%d %d", w, h, kernel_w, kernel_h, stride_w, stride_h);
 
-    Mat bottom_blob_bordered;
-    make_padding(bottom_blob_int8, bottom_blob_bordered, opt);
-    if (bottom_blob_bordered.empty())
-        return -100;
+    Mat bottom_blob_bordered = bottom_blob_int8;
+    if (!dynamic_quantize_per_pixel)
+    {
+        make_padding(bottom_blob_int8, bottom_blob_bordered, opt);
+        if (bottom_blob_bordered.empty())
+            return -100;
+    }
 
     int w = bottom_blob_bordered.w;
     int h = bottom_blob_bordered.h;
@@ -968,7 +1196,7 @@ int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, con
     int outw = (w - kernel_extent_w) / stride_w + 1;
     int outh = (h - kernel_extent_h) / stride_h + 1;
 
-    bool use_int8_requantize = int8_scale_term > 100;
+    bool use_int8_requantize = int8_scale_term > 100 && !int8_dynamic_quantize;
     int out_elempack = 1;
 #if __SSE2__
     if (opt.use_packing_layout)
@@ -1052,16 +1280,24 @@ int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, con
     if (opt.use_winograd_convolution && prefer_winograd && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
     {
         if (opt.use_winograd43_convolution && !weight_winograd43_data.empty())
+        {
+            profile_kernel("int8_winograd43");
             ret = conv3x3s1_winograd43_int8(bottom_blob_bordered, top_blob_int32, weight_winograd43_data, _nT, opt);
+        }
         else
+        {
+            profile_kernel("int8_winograd23");
             ret = conv3x3s1_winograd23_int8(bottom_blob_bordered, top_blob_int32, weight_winograd23_data, _nT, opt);
+        }
     }
     else if (opt.use_sgemm_convolution)
     {
+        profile_kernel("int8_sgemm");
         ret = convolution_im2col_gemm_int8(bottom_blob_bordered, top_blob_int32, weight_sgemm_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, _nT, opt);
     }
     else
     {
+        profile_kernel("int8_packed");
         convolution_packed_int8(bottom_blob_bordered, top_blob_int32, weight_data_tm, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
     }
     if (ret != 0)
@@ -1106,9 +1342,18 @@ int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, con
     {
         requantize_from_int32_to_int8(top_blob_int32, top_blob, scale_in_data, top_blob_int8_scales, bias_data, activation_type, activation_params, opt);
     }
+    else if (dynamic_quantize_per_pixel)
+    {
+        dequantize_from_int32_per_pixel(top_blob_int32, top_blob, bottom_scales, weight_data_int8_scales, bias_data, opt);
+
+        if (activation)
+        {
+            activation->forward_inplace(top_blob, opt);
+        }
+    }
     else
     {
-        dequantize_from_int32(top_blob_int32, top_blob, scale_in_data, bias_data, opt);
+        dequantize_from_int32(top_blob_int32, top_blob, int8_dynamic_quantize ? scale_in_dynamic : scale_in_data, bias_data, opt);
 
         if (activation)
         {
@@ -25,6 +25,7 @@
 #endif // __AVX512F__
 #endif // __AVX__
 #endif // __SSE2__
+#include "x86_activation.h"
 #include "x86_usability.h"
 
 #include "cpu.h"
@@ -6850,7 +6851,109 @@ static void get_optimal_tile_mnk(int M, int N, int K, int constant_TILE_M, int c
     }
 }
 
-static int gemm_x86(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int transA, int transB, int output_transpose, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+// constant TILE_M/N/K tried by auto tuning, variant i takes row i - 1
+static const int gemm_tuning_tiles[][3] = {
+    {32, 32, 64},
+    {64, 64, 128},
+    {64, 64, 256},
+    {128, 64, 256},
+    {64, 128, 256},
+    {128, 128, 512},
+    {256, 64, 512},
+};
+
+static void get_constant_tile_mnk(int tuning_variant, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int& tile_M, int& tile_N, int& tile_K)
+{
+    if (tuning_variant > 0)
+    {
+        // tile size picked by auto tuning takes over the param ones
+        tile_M = gemm_tuning_tiles[tuning_variant - 1][0];
+        tile_N = gemm_tuning_tiles[tuning_variant - 1][1];
+        tile_K = gemm_tuning_tiles[tuning_variant - 1][2];
+        return;
+    }
+
+    tile_M = constant_TILE_M;
+    tile_N = constant_TILE_N;
+    tile_K = constant_TILE_K;
+}
+
+static void activation_output_span(float* ptr, int size, float alpha, int activation_type, const Mat& activation_params)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    __m512 _alpha_avx512 = _mm512_set1_ps(alpha);
+    for (; i + 15 < size; i += 16)
+    {
+        __m512 _p = _mm512_mul_ps(_mm512_loadu_ps(ptr), _alpha_avx512);
+        _mm512_storeu_ps(ptr, activation_avx512(_p, activation_type, activation_params));
+        ptr += 16;
+    }
+#endif // __AVX512F__
+    __m256 _alpha_avx = _mm256_set1_ps(alpha);
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_mul_ps(_mm256_loadu_ps(ptr), _alpha_avx);
+        _mm256_storeu_ps(ptr, activation_avx(_p, activation_type, activation_params));
+        ptr += 8;
+    }
+#endif // __AVX__
+    __m128 _alpha = _mm_set1_ps(alpha);
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_mul_ps(_mm_loadu_ps(ptr), _alpha);
+        _mm_storeu_ps(ptr, activation_sse(_p, activation_type, activation_params));
+        ptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *ptr = activation_ss(*ptr * alpha, activation_type, activation_params);
+        ptr++;
+    }
+}
+
+// apply alpha and activation to the finished output tile while it is still hot in cache
+static void activation_output_tile(Mat& top_blob, int i, int max_ii, int j, int max_jj, float alpha, int output_transpose, int activation_type, const Mat& activation_params)
+{
+    const int out_elempack = top_blob.elempack;
+    const int out_hstep = top_blob.dims == 3 ? (int)top_blob.cstep : top_blob.w;
+
+    // the tile covers rows r0 ~ r0+nr-1 and columns c0 ~ c0+nc-1 of the unpacked output
+    const int r0 = output_transpose ? j : i;
+    const int nr = output_transpose ? max_jj : max_ii;
+    const int c0 = output_transpose ? i : j;
+    const int nc = output_transpose ? max_ii : max_jj;
+
+    for (int g = r0 / out_elempack; g * out_elempack < r0 + nr; g++)
+    {
+        float* p0 = (float*)top_blob + g * out_hstep * out_elempack + c0 * out_elempack;
+
+        if (g * out_elempack >= r0 && (g + 1) * out_elempack <= r0 + nr)
+        {
+            // whole pack rows are contiguous
+            activation_output_span(p0, nc * out_elempack, alpha, activation_type, activation_params);
+            continue;
+        }
+
+        // pack rows shared with the neighbor tile
+        for (int k = 0; k < out_elempack; k++)
+        {
+            const int r = g * out_elempack + k;
+            if (r < r0 || r >= r0 + nr)
+                continue;
+
+            for (int c = 0; c < nc; c++)
+            {
+                p0[c * out_elempack + k] = activation_ss(p0[c * out_elempack + k] * alpha, activation_type, activation_params);
+            }
+        }
+    }
+}
+
+static int gemm_x86(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int transA, int transB, int output_transpose, float alpha, int activation_type, const Mat& activation_params, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     const int M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
     const int K = transA ? (A.dims == 3 ? A.c : A.h) * A.elempack : A.w;
@@ -6966,13 +7069,18 @@ static int gemm_x86(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob, int
             {
                 transpose_unpack_output_tile(topT_tile, top_blob, i, max_ii, j, max_jj);
             }
+
+            if (alpha != 1.f || activation_type)
+            {
+                activation_output_tile(top_blob, i, max_ii, j, max_jj, alpha, output_transpose, activation_type, activation_params);
+            }
         }
     }
 
     return 0;
 }
 
-static int gemm_AT_x86(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int K, int transB, int output_transpose, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+static int gemm_AT_x86(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int K, int transB, int output_transpose, float alpha, int activation_type, const Mat& activation_params, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     const int N = transB ? (B.dims == 3 ? B.c : B.h) * B.elempack : B.w;
 
@@ -7067,13 +7175,18 @@ static int gemm_AT_x86(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob,
             {
                 transpose_unpack_output_tile(topT_tile, top_blob, i, max_ii, j, max_jj);
             }
+
+            if (alpha != 1.f || activation_type)
+            {
+                activation_output_tile(top_blob, i, max_ii, j, max_jj, alpha, output_transpose, activation_type, activation_params);
+            }
         }
     }
 
     return 0;
 }
 
-static int gemm_BT_x86(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob, int broadcast_type_C, int N, int K, int transA, int output_transpose, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+static int gemm_BT_x86(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob, int broadcast_type_C, int N, int K, int transA, int output_transpose, float alpha, int activation_type, const Mat& activation_params, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     const int M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
 
@@ -7156,13 +7269,18 @@ static int gemm_BT_x86(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob,
             {
                 transpose_unpack_output_tile(topT_tile, top_blob, i, max_ii, j, max_jj);
             }
+
+            if (alpha != 1.f || activation_type)
+            {
+                activation_output_tile(top_blob, i, max_ii, j, max_jj, alpha, output_transpose, activation_type, activation_params);
+            }
         }
     }
 
     return 0;
 }
 
-static int gemm_AT_BT_x86(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int N, int K, int output_transpose, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+static int gemm_AT_BT_x86(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int N, int K, int output_transpose, float alpha, int activation_type, const Mat& activation_params, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     // NCNN_LOGE("M/N/K = %d %d %d", M, N, K);
 
@@ -7223,6 +7341,11 @@ static int gemm_AT_BT_x86(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_b
             {
                 transpose_unpack_output_tile(topT_tile, top_blob, i, max_ii, j, max_jj);
             }
+
+            if (alpha != 1.f || activation_type)
+            {
+                activation_output_tile(top_blob, i, max_ii, j, max_jj, alpha, output_transpose, activation_type, activation_params);
+            }
         }
     }
 
@@ -7238,13 +7361,16 @@ int Gemm_x86::create_pipeline(const Option& opt)
     }
 #endif
 
-    if (constantA)
+    int tile_M, tile_N, tile_K;
+    get_constant_tile_mnk(tuning_variant, constant_TILE_M, constant_TILE_N, constant_TILE_K, tile_M, tile_N, tile_K);
+
+    if (constantA && AT_data.empty())
     {
         const int M = constantM;
         const int K = constantK;
 
         int TILE_M, TILE_N, TILE_K;
-        get_optimal_tile_mnk(M, 0, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+        get_optimal_tile_mnk(M, 0, K, tile_M, tile_N, tile_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
 
         const int nn_M = (M + TILE_M - 1) / TILE_M;
 
@@ -7274,18 +7400,18 @@ int Gemm_x86::create_pipeline(const Option& opt)
                 }
             }
         }
-
-        if (opt.lightmode)
-            A_data.release();
     }
 
-    if (constantB)
+    if (constantA && opt.lightmode)
+        A_data.release();
+
+    if (constantB && BT_data.empty())
     {
         const int N = constantN;
         const int K = constantK;
 
         int TILE_M, TILE_N, TILE_K;
-        get_optimal_tile_mnk(0, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+        get_optimal_tile_mnk(0, N, K, tile_M, tile_N, tile_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
 
         const int nn_N = (N + TILE_N - 1) / TILE_N;
         const int nn_K = (K + TILE_K - 1) / TILE_K;
@@ -7319,11 +7445,11 @@ int Gemm_x86::create_pipeline(const Option& opt)
                 transpose_pack_B_tile(B_data, BT_tile, j, max_jj, k, max_kk);
             }
         }
-
-        if (opt.lightmode)
-            B_data.release();
     }
 
+    if (constantB && opt.lightmode)
+        B_data.release();
+
     if (constantC && constant_broadcast_type_C != -1)
     {
         CT_data = C_data;
@@ -7369,6 +7495,30 @@ int Gemm_x86::create_pipeline(const Option& opt)
     return 0;
 }
 
+int Gemm_x86::pipeline_weights(std::vector<Mat*>& weights)
+{
+    weights.push_back(&AT_data);
+    weights.push_back(&BT_data);
+
+    return 0;
+}
+
+int Gemm_x86::tuning_variants(std::vector<int>& variants, const Option& /*opt*/) const
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+        return 0;
+#endif
+
+    const int variant_count = sizeof(gemm_tuning_tiles) / sizeof(gemm_tuning_tiles[0]);
+    for (int i = 0; i <= variant_count; i++)
+    {
+        variants.push_back(i);
+    }
+
+    return 0;
+}
+
 int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
 #if NCNN_INT8
@@ -7527,43 +7677,31 @@ int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
         NCNN_LOGE("opt.num_threads %d changed, gemm will use load-time value %d", opt.num_threads, nT);
     }
 
+    int tile_M, tile_N, tile_K;
+    get_constant_tile_mnk(tuning_variant, constant_TILE_M, constant_TILE_N, constant_TILE_K, tile_M, tile_N, tile_K);
+
     int ret = 0;
     if (constantA && constantB)
     {
-        ret = gemm_AT_BT_x86(AT_data, BT_data, C, top_blob, broadcast_type_C, constantM, constantN, constantK, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_AT_BT_x86(AT_data, BT_data, C, top_blob, broadcast_type_C, constantM, constantN, constantK, output_transpose, alpha, activation_type, activation_params, tile_M, tile_N, tile_K, _nT, opt);
     }
     else if (constantA)
     {
         const Mat& B = bottom_blobs[0];
-        ret = gemm_AT_x86(AT_data, B, C, top_blob, broadcast_type_C, constantM, constantK, transB, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_AT_x86(AT_data, B, C, top_blob, broadcast_type_C, constantM, constantK, transB, output_transpose, alpha, activation_type, activation_params, tile_M, tile_N, tile_K, _nT, opt);
     }
     else if (constantB)
     {
         const Mat& A = bottom_blobs[0];
-        ret = gemm_BT_x86(A, BT_data, C, top_blob, broadcast_type_C, constantN, constantK, transA, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_BT_x86(A, BT_data, C, top_blob, broadcast_type_C, constantN, constantK, transA, output_transpose, alpha, activation_type, activation_params, tile_M, tile_N, tile_K, _nT, opt);
     }
     else
     {
         const Mat& A = bottom_blobs[0];
         const Mat& B = bottom_blobs[1];
-        ret = gemm_x86(A, B, C, top_blob, broadcast_type_C, transA, transB, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
-    }
-    if (ret != 0)
-        return ret;
-
-    // multiply top_blob with alpha
-    if (alpha != 1.f)
-    {
-        const int size = top_blob.total() * out_elempack;
-
-        #pragma omp parallel for num_threads(opt.num_threads)
-        for (int i = 0; i < size; i++)
-        {
-            top_blob[i] *= alpha;
-        }
+        ret = gemm_x86(A, B, C, top_blob, broadcast_type_C, transA, transB, output_transpose, alpha, activation_type, activation_params, tile_M, tile_N, tile_K, _nT, opt);
     }
-
-    return 0;
+    return ret;
 }
 
 #if NCNN_INT8
@@ -8083,7 +8221,7 @@ static int gemm_AT_BT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Ma
 
 int Gemm_x86::create_pipeline_int8(const Option& opt)
 {
-    if (constantA)
+    if (constantA && AT_data.empty())
     {
         const int M = constantM;
         const int K = constantK;
@@ -8138,12 +8276,12 @@ int Gemm_x86::create_pipeline_int8(const Option& opt)
                 }
             }
         }
-
-        if (opt.lightmode)
-            A_data.release();
     }
 
-    if (constantB)
+    if (constantA && opt.lightmode)
+        A_data.release();
+
+    if (constantB && BT_data.empty())
     {
         const int N = constantN;
         const int K = constantK;
@@ -8179,11 +8317,11 @@ int Gemm_x86::create_pipeline_int8(const Option& opt)
                 }
             }
         }
-
-        if (opt.lightmode)
-            B_data.release();
     }
 
+    if (constantB && opt.lightmode)
+        B_data.release();
+
     if (constantC && constant_broadcast_type_C != -1)
     {
         CT_data = C_data;
@@ -8365,8 +8503,22 @@ int Gemm_x86::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
         const Mat& B = bottom_blobs[1];
         ret = gemm_x86_int8(A, B, C, top_blob, broadcast_type_C, transA, transB, output_transpose, alpha, beta, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
     }
+    if (ret != 0)
+        return ret;
 
-    return ret;
+    if (activation_type)
+    {
+        // alpha is already applied by dequantize
+        const int outh = top_blob.dims == 3 ? top_blob.c : top_blob.h;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < outh; i++)
+        {
+            activation_output_tile(top_blob, i * out_elempack, out_elempack, 0, top_blob.w, 1.f, 0, activation_type, activation_params);
+        }
+    }
+
+    return 0;
 }
 #endif
 
@@ -26,6 +26,10 @@ public:
 
     virtual int create_pipeline(const Option& opt);
 
+    virtual int pipeline_weights(std::vector<Mat*>& weights);
+
+    virtual int tuning_variants(std::vector<int>& variants, const Option& opt) const;
+
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
 protected:
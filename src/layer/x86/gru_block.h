@@ -0,0 +1,87 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// units are grouped in blocks of 8 (avx) and 4 (sse2), then single units
+// block b covers units q .. q + n - 1, every packed weight row holds one block
+static NCNN_FORCEINLINE void gru_block_range(int b, int num_output, int max_block, int& q, int& n)
+{
+    const int nn8 = max_block >= 8 ? num_output / 8 : 0;
+    const int nn4 = max_block >= 4 ? (num_output - nn8 * 8) / 4 : 0;
+
+    if (b < nn8)
+    {
+        q = b * 8;
+        n = 8;
+    }
+    else if (b < nn8 + nn4)
+    {
+        q = nn8 * 8 + (b - nn8) * 4;
+        n = 4;
+    }
+    else
+    {
+        q = nn8 * 8 + nn4 * 4 + (b - nn8 - nn4);
+        n = 1;
+    }
+}
+
+static int gru_block_count(int num_output, int max_block)
+{
+    const int nn8 = max_block >= 8 ? num_output / 8 : 0;
+    const int nn4 = max_block >= 4 ? (num_output - nn8 * 8) / 4 : 0;
+
+    return nn8 + nn4 + num_output - nn8 * 8 - nn4 * 4;
+}
+
+// h_t := (1 - update) .* new + update .* h_{t-1}
+static void gru_update_hidden(const Mat& gates, Mat& hidden_state, float* outptr)
+{
+    const int num_output = hidden_state.w;
+
+    const float* gates_U = gates.row(0);
+    const float* gates_N = gates.row(1);
+    float* hidden_ptr = hidden_state;
+
+    int q = 0;
+#if __SSE2__
+#if __AVX__
+    for (; q + 7 < num_output; q += 8)
+    {
+        __m256 _U = _mm256_loadu_ps(gates_U + q);
+        __m256 _N = _mm256_loadu_ps(gates_N + q);
+        __m256 _H = _mm256_comp_fmadd_ps(_U, _mm256_sub_ps(_mm256_loadu_ps(hidden_ptr + q), _N), _N);
+        _mm256_storeu_ps(hidden_ptr + q, _H);
+        _mm256_storeu_ps(outptr + q, _H);
+    }
+#endif // __AVX__
+    for (; q + 3 < num_output; q += 4)
+    {
+        __m128 _U = _mm_loadu_ps(gates_U + q);
+        __m128 _N = _mm_loadu_ps(gates_N + q);
+        __m128 _H = _mm_comp_fmadd_ps(_U, _mm_sub_ps(_mm_loadu_ps(hidden_ptr + q), _N), _N);
+        _mm_storeu_ps(hidden_ptr + q, _H);
+        _mm_storeu_ps(outptr + q, _H);
+    }
+#endif // __SSE2__
+    for (; q < num_output; q++)
+    {
+        float U = gates_U[q];
+        float N = gates_N[q];
+
+        float H = (1 - U) * N + U * hidden_ptr[q];
+
+        hidden_ptr[q] = H;
+        outptr[q] = H;
+    }
+}
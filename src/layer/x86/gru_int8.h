@@ -0,0 +1,474 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// weight_data_tm row layout, one row per 4 units block or per remaining unit
+//   xc part = (size + 1) / 2 k-pairs, hc part = (num_output + 1) / 2 k-pairs
+//   each k-pair holds gate R U N, each gate holds unit0 k0 k1 unit1 k0 k1 ...
+// odd k is padded with zero so that every k-pair feeds one pmaddwd
+// weight_data_tm_int8_descales holds xcR xcU xcN hcR hcU hcN for each unit, grouped the same way
+// the layout is the same for every isa, only the kernels are dispatched
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+int gru_int8_input_projection_avx512vnni(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt);
+int gru_int8_avx512vnni(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, const float* bias_c_ptr, Mat& hidden_state, const Option& opt);
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVXVNNI && __AVX__ && !__AVX512F__ && !__AVXVNNI__ && !__AVX512VNNI__
+int gru_int8_input_projection_avxvnni(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt);
+int gru_int8_avxvnni(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, const float* bias_c_ptr, Mat& hidden_state, const Option& opt);
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__ && !__AVXVNNI__ && !__AVX512VNNI__
+int gru_int8_input_projection_avx2(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt);
+int gru_int8_avx2(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, const float* bias_c_ptr, Mat& hidden_state, const Option& opt);
+#endif
+
+static int gru_int8_max_block()
+{
+#if __SSE2__
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+static void gru_transform_weight_int8(const Mat& weight_xc, const Mat& weight_xc_int8_scales, const Mat& weight_hc, const Mat& weight_hc_int8_scales, Mat& weight_data_tm, Mat& weight_data_tm_int8_descales, int size, int num_output, int num_directions, const Option& opt)
+{
+    const int size2 = (size + 1) / 2;
+    const int num_output2 = (num_output + 1) / 2;
+
+#if __SSE2__
+    weight_data_tm.create((size2 + num_output2) * 24, num_output / 4 + num_output % 4, num_directions, 1u, 1);
+#else
+    weight_data_tm.create((size2 + num_output2) * 6, num_output, num_directions, 1u, 1);
+#endif
+    weight_data_tm_int8_descales.create(num_output * 6, 1, num_directions);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        const Mat weight_xc_dr = weight_xc.channel(dr);
+        const Mat weight_hc_dr = weight_hc.channel(dr);
+        const float* weight_xc_int8_scales_ptr = weight_xc_int8_scales.row(dr);
+        const float* weight_hc_int8_scales_ptr = weight_hc_int8_scales.row(dr);
+
+        Mat weight_data_tm_dr = weight_data_tm.channel(dr);
+        float* descales_ptr = weight_data_tm_int8_descales.channel(dr);
+
+        int q = 0;
+#if __SSE2__
+        for (; q + 3 < num_output; q += 4)
+        {
+            signed char* kptr = weight_data_tm_dr.row<signed char>(q / 4);
+
+            for (int i = 0; i < size2 * 2; i += 2)
+            {
+                for (int g = 0; g < 3; g++)
+                {
+                    for (int j = 0; j < 4; j++)
+                    {
+                        const signed char* wptr = weight_xc_dr.row<const signed char>(num_output * g + q + j);
+                        kptr[0] = wptr[i];
+                        kptr[1] = i + 1 < size ? wptr[i + 1] : 0;
+                        kptr += 2;
+                    }
+                }
+            }
+
+            for (int i = 0; i < num_output2 * 2; i += 2)
+            {
+                for (int g = 0; g < 3; g++)
+                {
+                    for (int j = 0; j < 4; j++)
+                    {
+                        const signed char* wptr = weight_hc_dr.row<const signed char>(num_output * g + q + j);
+                        kptr[0] = wptr[i];
+                        kptr[1] = i + 1 < num_output ? wptr[i + 1] : 0;
+                        kptr += 2;
+                    }
+                }
+            }
+
+            float* dptr = descales_ptr + q * 6;
+            for (int g = 0; g < 3; g++)
+            {
+                for (int j = 0; j < 4; j++)
+                {
+                    dptr[g * 4 + j] = 1.f / weight_xc_int8_scales_ptr[num_output * g + q + j];
+                    dptr[12 + g * 4 + j] = 1.f / weight_hc_int8_scales_ptr[num_output * g + q + j];
+                }
+            }
+        }
+#endif // __SSE2__
+        for (; q < num_output; q++)
+        {
+#if __SSE2__
+            signed char* kptr = weight_data_tm_dr.row<signed char>(q / 4 + q % 4);
+#else
+            signed char* kptr = weight_data_tm_dr.row<signed char>(q);
+#endif
+
+            for (int i = 0; i < size2 * 2; i += 2)
+            {
+                for (int g = 0; g < 3; g++)
+                {
+                    const signed char* wptr = weight_xc_dr.row<const signed char>(num_output * g + q);
+                    kptr[0] = wptr[i];
+                    kptr[1] = i + 1 < size ? wptr[i + 1] : 0;
+                    kptr += 2;
+                }
+            }
+
+            for (int i = 0; i < num_output2 * 2; i += 2)
+            {
+                for (int g = 0; g < 3; g++)
+                {
+                    const signed char* wptr = weight_hc_dr.row<const signed char>(num_output * g + q);
+                    kptr[0] = wptr[i];
+                    kptr[1] = i + 1 < num_output ? wptr[i + 1] : 0;
+                    kptr += 2;
+                }
+            }
+
+            float* dptr = descales_ptr + q * 6;
+            for (int g = 0; g < 3; g++)
+            {
+                dptr[g] = 1.f / weight_xc_int8_scales_ptr[num_output * g + q];
+                dptr[3 + g] = 1.f / weight_hc_int8_scales_ptr[num_output * g + q];
+            }
+        }
+    }
+}
+
+// quantize to int8 and store every two values as one int16 pair
+// return the descale, zero input gives zero pairs
+static float gru_dynamic_quantize_pairs(const float* ptr, int size, int* outptr)
+{
+    float absmax = 0.f;
+    for (int i = 0; i < size; i++)
+    {
+        absmax = std::max(absmax, (float)fabs(ptr[i]));
+    }
+
+    if (absmax == 0.f)
+    {
+        for (int i = 0; i < (size + 1) / 2; i++)
+        {
+            outptr[i] = 0;
+        }
+        return 1.f;
+    }
+
+    const float scale = 127.f / absmax;
+
+    int i = 0;
+    for (; i + 1 < size; i += 2)
+    {
+        const signed char v0 = float2int8(ptr[i] * scale);
+        const signed char v1 = float2int8(ptr[i + 1] * scale);
+        outptr[i / 2] = (int)(((unsigned int)(unsigned short)(short)v1 << 16) | (unsigned short)(short)v0);
+    }
+    if (i < size)
+    {
+        const signed char v0 = float2int8(ptr[i] * scale);
+        outptr[i / 2] = (unsigned short)(short)v0;
+    }
+
+    return absmax / 127.f;
+}
+
+#if __SSE2__
+static NCNN_FORCEINLINE void gru_int8_dot_pack4(const signed char* kptr, const int* xptr, int n2, __m128i& _R, __m128i& _U, __m128i& _N)
+{
+    int i = 0;
+#if __AVX2__
+    // two k-pairs are R0 U0 N0 R1 U1 N1, feed them as R0U0 N0R1 U1N1
+    __m256i _RU = _mm256_setzero_si256();
+    __m256i _NR = _mm256_setzero_si256();
+    __m256i _UN = _mm256_setzero_si256();
+    for (; i + 1 < n2; i += 2)
+    {
+        __m256i _x0 = _mm256_set1_epi32(xptr[i]);
+        __m256i _x1 = _mm256_set1_epi32(xptr[i + 1]);
+        __m256i _x01 = _mm256_blend_epi32(_x0, _x1, 0xf0);
+
+        __m256i _w0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)kptr));
+        __m256i _w1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(kptr + 16)));
+        __m256i _w2 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(kptr + 32)));
+
+        _RU = _mm256_comp_dpwssd_epi32(_RU, _w0, _x0);
+        _NR = _mm256_comp_dpwssd_epi32(_NR, _w1, _x01);
+        _UN = _mm256_comp_dpwssd_epi32(_UN, _w2, _x1);
+
+        kptr += 48;
+    }
+    _R = _mm_add_epi32(_R, _mm_add_epi32(_mm256_castsi256_si128(_RU), _mm256_extracti128_si256(_NR, 1)));
+    _U = _mm_add_epi32(_U, _mm_add_epi32(_mm256_extracti128_si256(_RU, 1), _mm256_castsi256_si128(_UN)));
+    _N = _mm_add_epi32(_N, _mm_add_epi32(_mm256_castsi256_si128(_NR), _mm256_extracti128_si256(_UN, 1)));
+#endif // __AVX2__
+    for (; i < n2; i++)
+    {
+        __m128i _x = _mm_set1_epi32(xptr[i]);
+
+        __m128i _w01 = _mm_loadu_si128((const __m128i*)kptr);
+        __m128i _w2 = _mm_loadl_epi64((const __m128i*)(kptr + 16));
+        __m128i _s01 = _mm_cmpgt_epi8(_mm_setzero_si128(), _w01);
+        __m128i _s2 = _mm_cmpgt_epi8(_mm_setzero_si128(), _w2);
+
+        _R = _mm_comp_dpwssd_epi32(_R, _mm_unpacklo_epi8(_w01, _s01), _x);
+        _U = _mm_comp_dpwssd_epi32(_U, _mm_unpackhi_epi8(_w01, _s01), _x);
+        _N = _mm_comp_dpwssd_epi32(_N, _mm_unpacklo_epi8(_w2, _s2), _x);
+
+        kptr += 24;
+    }
+}
+#endif // __SSE2__
+
+static NCNN_FORCEINLINE void gru_int8_dot(const signed char* kptr, const int* xptr, int n2, int& R, int& U, int& N)
+{
+    for (int i = 0; i < n2; i++)
+    {
+        const short x0 = (short)(xptr[i] & 0xffff);
+        const short x1 = (short)(xptr[i] >> 16);
+
+        R += kptr[0] * x0 + kptr[1] * x1;
+        U += kptr[2] * x0 + kptr[3] * x1;
+        N += kptr[4] * x0 + kptr[5] * x1;
+
+        kptr += 6;
+    }
+}
+
+// gates_x = bias_c + W_xc * x_t for every timestep and every direction
+// gate R U N of unit q stored at q * 3, grouped in 4 units block the same as weight_data_tm
+static int gru_int8_input_projection(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt)
+{
+#if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        return gru_int8_input_projection_avx512vnni(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c, num_output, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVXVNNI && __AVX__ && !__AVX512F__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx_vnni())
+    {
+        return gru_int8_input_projection_avxvnni(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c, num_output, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx2())
+    {
+        return gru_int8_input_projection_avx2(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c, num_output, opt);
+    }
+#endif
+
+    const int size = bottom_blob.w;
+    const int T = bottom_blob.h;
+    const int num_directions = weight_data_tm.c;
+
+    const int size2 = (size + 1) / 2;
+
+    // dynamic quantize bottom_blob
+    Mat bottom_blob_int8(size2, T, (size_t)4u, opt.workspace_allocator);
+    Mat bottom_blob_int8_descales(T, (size_t)4u, opt.workspace_allocator);
+    if (bottom_blob_int8.empty() || bottom_blob_int8_descales.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int t = 0; t < T; t++)
+    {
+        bottom_blob_int8_descales[t] = gru_dynamic_quantize_pairs(bottom_blob.row(t), size, bottom_blob_int8.row<int>(t));
+    }
+
+    gates_x.create(num_output * 3, T, num_directions, 4u, opt.workspace_allocator);
+    if (gates_x.empty())
+        return -100;
+
+    const int max_block = gru_int8_max_block();
+    const int nblocks = gru_block_count(num_output, max_block);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < num_directions * T * nblocks; ii++)
+    {
+        const int dr = ii / (T * nblocks);
+        const int t = ii % (T * nblocks) / nblocks;
+        const int b = ii % nblocks;
+
+        const Mat weight_data_tm_dr = weight_data_tm.channel(dr);
+        const float* descales_ptr = weight_data_tm_int8_descales.channel(dr);
+        const float* bias_c_ptr = bias_c.channel(dr);
+
+        const int* x = bottom_blob_int8.row<const int>(t);
+        const float descale_x = bottom_blob_int8_descales[t];
+
+        float* gates_x_ptr = gates_x.channel(dr).row(t);
+
+        int q;
+        int n;
+        gru_block_range(b, num_output, max_block, q, n);
+
+#if __SSE2__
+        if (n == 4)
+        {
+            __m128i _R = _mm_setzero_si128();
+            __m128i _U = _mm_setzero_si128();
+            __m128i _N = _mm_setzero_si128();
+            gru_int8_dot_pack4(weight_data_tm_dr.row<const signed char>(b), x, size2, _R, _U, _N);
+
+            __m128 _descale_x = _mm_set1_ps(descale_x);
+            const float* dptr = descales_ptr + q * 6;
+            const float* bptr = bias_c_ptr + q * 4;
+
+            __m128 _gR = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_R), _mm_mul_ps(_descale_x, _mm_loadu_ps(dptr)), _mm_loadu_ps(bptr));
+            __m128 _gU = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_U), _mm_mul_ps(_descale_x, _mm_loadu_ps(dptr + 4)), _mm_loadu_ps(bptr + 4));
+            __m128 _gN = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_N), _mm_mul_ps(_descale_x, _mm_loadu_ps(dptr + 8)), _mm_loadu_ps(bptr + 8));
+
+            _mm_storeu_ps(gates_x_ptr + q * 3, _gR);
+            _mm_storeu_ps(gates_x_ptr + q * 3 + 4, _gU);
+            _mm_storeu_ps(gates_x_ptr + q * 3 + 8, _gN);
+            continue;
+        }
+#endif // __SSE2__
+
+        int R = 0;
+        int U = 0;
+        int N = 0;
+        gru_int8_dot(weight_data_tm_dr.row<const signed char>(b), x, size2, R, U, N);
+
+        const float* dptr = descales_ptr + q * 6;
+        const float* bptr = bias_c_ptr + q * 4;
+
+        gates_x_ptr[q * 3] = bptr[0] + R * (descale_x * dptr[0]);
+        gates_x_ptr[q * 3 + 1] = bptr[1] + U * (descale_x * dptr[1]);
+        gates_x_ptr[q * 3 + 2] = bptr[2] + N * (descale_x * dptr[2]);
+    }
+
+    return 0;
+}
+
+static int gru_int8(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, const float* bias_c_ptr, Mat& hidden_state, const Option& opt)
+{
+#if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        return gru_int8_avx512vnni(gates_x, top_blob, outw_offset, reverse, size, weight_data_tm, descales_ptr, bias_c_ptr, hidden_state, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVXVNNI && __AVX__ && !__AVX512F__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx_vnni())
+    {
+        return gru_int8_avxvnni(gates_x, top_blob, outw_offset, reverse, size, weight_data_tm, descales_ptr, bias_c_ptr, hidden_state, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx2())
+    {
+        return gru_int8_avx2(gates_x, top_blob, outw_offset, reverse, size, weight_data_tm, descales_ptr, bias_c_ptr, hidden_state, opt);
+    }
+#endif
+
+    const int T = gates_x.h;
+    const int num_output = hidden_state.w;
+
+    const int size2 = (size + 1) / 2;
+    const int num_output2 = (num_output + 1) / 2;
+
+    // U N
+    Mat gates(num_output, 2, 4u, opt.workspace_allocator);
+    Mat hidden_state_int8(num_output2, (size_t)4u, opt.workspace_allocator);
+    if (gates.empty() || hidden_state_int8.empty())
+        return -100;
+
+    const int max_block = gru_int8_max_block();
+    const int nblocks = gru_block_count(num_output, max_block);
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+        // dynamic quantize hidden_state
+        const float descale_h = gru_dynamic_quantize_pairs(hidden_state, num_output, hidden_state_int8);
+
+        const int* hs = hidden_state_int8;
+        const float* gates_x_ptr = gates_x.row(ti);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int b = 0; b < nblocks; b++)
+        {
+            int q;
+            int n;
+            gru_block_range(b, num_output, max_block, q, n);
+
+            float* gates_U = gates.row(0);
+            float* gates_N = gates.row(1);
+
+#if __SSE2__
+            if (n == 4)
+            {
+                const signed char* kptr = weight_data_tm.row<const signed char>(b) + size2 * 24;
+
+                __m128i _Rh = _mm_setzero_si128();
+                __m128i _Uh = _mm_setzero_si128();
+                __m128i _Nh = _mm_setzero_si128();
+                gru_int8_dot_pack4(kptr, hs, num_output2, _Rh, _Uh, _Nh);
+
+                __m128 _descale_h = _mm_set1_ps(descale_h);
+                const float* dptr = descales_ptr + q * 6 + 12;
+
+                __m128 _R = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_Rh), _mm_mul_ps(_descale_h, _mm_loadu_ps(dptr)), _mm_loadu_ps(gates_x_ptr + q * 3));
+                __m128 _U = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_Uh), _mm_mul_ps(_descale_h, _mm_loadu_ps(dptr + 4)), _mm_loadu_ps(gates_x_ptr + q * 3 + 4));
+                __m128 _N = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_Nh), _mm_mul_ps(_descale_h, _mm_loadu_ps(dptr + 8)), _mm_loadu_ps(bias_c_ptr + q * 4 + 12));
+
+                _R = sigmoid_sse(_R);
+                _U = sigmoid_sse(_U);
+                _N = tanh_sse(_mm_comp_fmadd_ps(_R, _N, _mm_loadu_ps(gates_x_ptr + q * 3 + 8)));
+
+                _mm_storeu_ps(gates_U + q, _U);
+                _mm_storeu_ps(gates_N + q, _N);
+                continue;
+            }
+#endif // __SSE2__
+
+            const signed char* kptr = weight_data_tm.row<const signed char>(b) + size2 * 6;
+
+            int Rh = 0;
+            int Uh = 0;
+            int Nh = 0;
+            gru_int8_dot(kptr, hs, num_output2, Rh, Uh, Nh);
+
+            const float* dptr = descales_ptr + q * 6 + 3;
+
+            float R = gates_x_ptr[q * 3] + Rh * (descale_h * dptr[0]);
+            float U = gates_x_ptr[q * 3 + 1] + Uh * (descale_h * dptr[1]);
+            float N = bias_c_ptr[q * 4 + 3] + Nh * (descale_h * dptr[2]);
+
+            R = 1.f / (1.f + expf(-R));
+            U = 1.f / (1.f + expf(-U));
+            N = tanhf(gates_x_ptr[q * 3 + 2] + R * N);
+
+            gates_U[q] = U;
+            gates_N[q] = N;
+        }
+
+        // h_t := (1 - update) .* new + update .* h_{t-1}
+        gru_update_hidden(gates, hidden_state, top_blob.row(ti) + outw_offset);
+    }
+
+    return 0;
+}
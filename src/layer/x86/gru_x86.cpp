@@ -0,0 +1,734 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "gru_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+#include "cpu.h"
+
+namespace ncnn {
+
+#include "gru_block.h"
+
+static int gru_max_block()
+{
+#if __AVX__
+    return 8;
+#elif __SSE2__
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+#if NCNN_INT8
+#include "gru_int8.h"
+#endif
+
+GRU_x86::GRU_x86()
+{
+    one_blob_only = false;
+    support_inplace = false;
+}
+
+static void gru_transform_bias(const Mat& bias_c, Mat& bias_c_tm, int num_output, int num_directions, int max_block)
+{
+    // R U WN BN for each block
+    bias_c_tm.create(num_output * 4, 1, num_directions);
+
+    const int nblocks = gru_block_count(num_output, max_block);
+
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        const Mat bias_c_dr = bias_c.channel(dr);
+        float* outptr = bias_c_tm.channel(dr);
+
+        for (int b = 0; b < nblocks; b++)
+        {
+            int q;
+            int n;
+            gru_block_range(b, num_output, max_block, q, n);
+
+            for (int g = 0; g < 4; g++)
+            {
+                const float* ptr = bias_c_dr.row(g);
+                for (int j = 0; j < n; j++)
+                {
+                    *outptr++ = ptr[q + j];
+                }
+            }
+        }
+    }
+}
+
+int GRU_x86::create_pipeline(const Option& opt)
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        return create_pipeline_int8(opt);
+    }
+#endif
+
+    // pack RUN
+    int num_directions = direction == 2 ? 2 : 1;
+    int size = weight_data_size / num_directions / num_output / 3;
+
+    if (weight_xc_data_packed.empty())
+    {
+        const int max_block = gru_max_block();
+        const int nblocks = gru_block_count(num_output, max_block);
+
+        weight_xc_data_packed.create(size * 3 * max_block, nblocks, num_directions);
+        weight_hc_data_packed.create(num_output * 3 * max_block, nblocks, num_directions);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            const Mat weight_xc = weight_xc_data.channel(dr);
+            const Mat weight_hc = weight_hc_data.channel(dr);
+
+            Mat weight_xc_data_packed_dr = weight_xc_data_packed.channel(dr);
+            Mat weight_hc_data_packed_dr = weight_hc_data_packed.channel(dr);
+
+            for (int b = 0; b < nblocks; b++)
+            {
+                int q;
+                int n;
+                gru_block_range(b, num_output, max_block, q, n);
+
+                // R0 R1 .. U0 U1 .. N0 N1 .. for each k
+                float* weight_xc_RUN = weight_xc_data_packed_dr.row(b);
+                float* weight_hc_RUN = weight_hc_data_packed_dr.row(b);
+
+                for (int i = 0; i < size; i++)
+                {
+                    for (int g = 0; g < 3; g++)
+                    {
+                        for (int j = 0; j < n; j++)
+                        {
+                            *weight_xc_RUN++ = weight_xc.row(num_output * g + q + j)[i];
+                        }
+                    }
+                }
+
+                for (int i = 0; i < num_output; i++)
+                {
+                    for (int g = 0; g < 3; g++)
+                    {
+                        for (int j = 0; j < n; j++)
+                        {
+                            *weight_hc_RUN++ = weight_hc.row(num_output * g + q + j)[i];
+                        }
+                    }
+                }
+            }
+        }
+
+        gru_transform_bias(bias_c_data, bias_c_data_packed, num_output, num_directions, max_block);
+    }
+
+    if (opt.lightmode)
+    {
+        weight_xc_data.release();
+        bias_c_data.release();
+        weight_hc_data.release();
+    }
+
+    return 0;
+}
+
+int GRU_x86::pipeline_weights(std::vector<Mat*>& weights)
+{
+    weights.push_back(&weight_xc_data_packed);
+    weights.push_back(&bias_c_data_packed);
+    weights.push_back(&weight_hc_data_packed);
+#if NCNN_INT8
+    weights.push_back(&weight_data_tm);
+    weights.push_back(&weight_data_tm_int8_descales);
+#endif
+
+    return 0;
+}
+
+// gates_x = bias_c + W_xc * x_t for every timestep and every direction
+// the input projection does not depend on the hidden state, so it runs as one gemm
+// outside the recurrence, four timesteps share each weight load
+// gate R U N of block q stored at q * 3, laid out the same as the packed weight
+static int gru_input_projection(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_xc, const Mat& bias_c, int num_output, const Option& opt)
+{
+    const int size = bottom_blob.w;
+    const int T = bottom_blob.h;
+    const int num_directions = weight_xc.c;
+
+    gates_x.create(num_output * 3, T, num_directions, 4u, opt.workspace_allocator);
+    if (gates_x.empty())
+        return -100;
+
+    const int max_block = gru_max_block();
+    const int nblocks = gru_block_count(num_output, max_block);
+
+    const int nn_T = T / 4;
+    const int ntiles = nn_T + T - nn_T * 4;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < num_directions * ntiles * nblocks; ii++)
+    {
+        const int dr = ii / (ntiles * nblocks);
+        const int tile = ii % (ntiles * nblocks) / nblocks;
+        const int b = ii % nblocks;
+
+        const int t = tile < nn_T ? tile * 4 : nn_T * 4 + tile - nn_T;
+        const int tn = tile < nn_T ? 4 : 1;
+
+        int q;
+        int n;
+        gru_block_range(b, num_output, max_block, q, n);
+
+        const float* kptr0 = weight_xc.channel(dr).row(b);
+        const float* bias_c_ptr = (const float*)bias_c.channel(dr) + q * 4;
+        Mat gates_x_dr = gates_x.channel(dr);
+
+#if __SSE2__
+#if __AVX__
+        if (n == 8)
+        {
+            __m256 _bR = _mm256_loadu_ps(bias_c_ptr);
+            __m256 _bU = _mm256_loadu_ps(bias_c_ptr + 8);
+            __m256 _bN = _mm256_loadu_ps(bias_c_ptr + 16);
+
+            int j = 0;
+            for (; j + 3 < tn; j += 4)
+            {
+                const float* x0 = bottom_blob.row(t + j);
+                const float* x1 = bottom_blob.row(t + j + 1);
+                const float* x2 = bottom_blob.row(t + j + 2);
+                const float* x3 = bottom_blob.row(t + j + 3);
+
+                const float* kptr = kptr0;
+
+                __m256 _R0 = _bR;
+                __m256 _R1 = _bR;
+                __m256 _R2 = _bR;
+                __m256 _R3 = _bR;
+                __m256 _U0 = _bU;
+                __m256 _U1 = _bU;
+                __m256 _U2 = _bU;
+                __m256 _U3 = _bU;
+                __m256 _N0 = _bN;
+                __m256 _N1 = _bN;
+                __m256 _N2 = _bN;
+                __m256 _N3 = _bN;
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m256 _wR = _mm256_loadu_ps(kptr);
+                    __m256 _wU = _mm256_loadu_ps(kptr + 8);
+                    __m256 _wN = _mm256_loadu_ps(kptr + 16);
+
+                    __m256 _x = _mm256_broadcast_ss(x0 + i);
+                    _R0 = _mm256_comp_fmadd_ps(_wR, _x, _R0);
+                    _U0 = _mm256_comp_fmadd_ps(_wU, _x, _U0);
+                    _N0 = _mm256_comp_fmadd_ps(_wN, _x, _N0);
+                    _x = _mm256_broadcast_ss(x1 + i);
+                    _R1 = _mm256_comp_fmadd_ps(_wR, _x, _R1);
+                    _U1 = _mm256_comp_fmadd_ps(_wU, _x, _U1);
+                    _N1 = _mm256_comp_fmadd_ps(_wN, _x, _N1);
+                    _x = _mm256_broadcast_ss(x2 + i);
+                    _R2 = _mm256_comp_fmadd_ps(_wR, _x, _R2);
+                    _U2 = _mm256_comp_fmadd_ps(_wU, _x, _U2);
+                    _N2 = _mm256_comp_fmadd_ps(_wN, _x, _N2);
+                    _x = _mm256_broadcast_ss(x3 + i);
+                    _R3 = _mm256_comp_fmadd_ps(_wR, _x, _R3);
+                    _U3 = _mm256_comp_fmadd_ps(_wU, _x, _U3);
+                    _N3 = _mm256_comp_fmadd_ps(_wN, _x, _N3);
+
+                    kptr += 24;
+                }
+
+                float* outptr0 = gates_x_dr.row(t + j) + q * 3;
+                float* outptr1 = gates_x_dr.row(t + j + 1) + q * 3;
+                float* outptr2 = gates_x_dr.row(t + j + 2) + q * 3;
+                float* outptr3 = gates_x_dr.row(t + j + 3) + q * 3;
+
+                _mm256_storeu_ps(outptr0, _R0);
+                _mm256_storeu_ps(outptr0 + 8, _U0);
+                _mm256_storeu_ps(outptr0 + 16, _N0);
+                _mm256_storeu_ps(outptr1, _R1);
+                _mm256_storeu_ps(outptr1 + 8, _U1);
+                _mm256_storeu_ps(outptr1 + 16, _N1);
+                _mm256_storeu_ps(outptr2, _R2);
+                _mm256_storeu_ps(outptr2 + 8, _U2);
+                _mm256_storeu_ps(outptr2 + 16, _N2);
+                _mm256_storeu_ps(outptr3, _R3);
+                _mm256_storeu_ps(outptr3 + 8, _U3);
+                _mm256_storeu_ps(outptr3 + 16, _N3);
+            }
+            for (; j < tn; j++)
+            {
+                const float* x = bottom_blob.row(t + j);
+
+                const float* kptr = kptr0;
+
+                __m256 _R = _bR;
+                __m256 _U = _bU;
+                __m256 _N = _bN;
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m256 _x = _mm256_broadcast_ss(x + i);
+                    _R = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _x, _R);
+                    _U = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _x, _U);
+                    _N = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 16), _x, _N);
+
+                    kptr += 24;
+                }
+
+                float* outptr = gates_x_dr.row(t + j) + q * 3;
+                _mm256_storeu_ps(outptr, _R);
+                _mm256_storeu_ps(outptr + 8, _U);
+                _mm256_storeu_ps(outptr + 16, _N);
+            }
+            continue;
+        }
+#endif // __AVX__
+        if (n == 4)
+        {
+            __m128 _bR = _mm_loadu_ps(bias_c_ptr);
+            __m128 _bU = _mm_loadu_ps(bias_c_ptr + 4);
+            __m128 _bN = _mm_loadu_ps(bias_c_ptr + 8);
+
+            int j = 0;
+            for (; j + 3 < tn; j += 4)
+            {
+                const float* x0 = bottom_blob.row(t + j);
+                const float* x1 = bottom_blob.row(t + j + 1);
+                const float* x2 = bottom_blob.row(t + j + 2);
+                const float* x3 = bottom_blob.row(t + j + 3);
+
+                const float* kptr = kptr0;
+
+                __m128 _R0 = _bR;
+                __m128 _R1 = _bR;
+                __m128 _R2 = _bR;
+                __m128 _R3 = _bR;
+                __m128 _U0 = _bU;
+                __m128 _U1 = _bU;
+                __m128 _U2 = _bU;
+                __m128 _U3 = _bU;
+                __m128 _N0 = _bN;
+                __m128 _N1 = _bN;
+                __m128 _N2 = _bN;
+                __m128 _N3 = _bN;
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m128 _wR = _mm_loadu_ps(kptr);
+                    __m128 _wU = _mm_loadu_ps(kptr + 4);
+                    __m128 _wN = _mm_loadu_ps(kptr + 8);
+
+                    __m128 _x = _mm_set1_ps(x0[i]);
+                    _R0 = _mm_comp_fmadd_ps(_wR, _x, _R0);
+                    _U0 = _mm_comp_fmadd_ps(_wU, _x, _U0);
+                    _N0 = _mm_comp_fmadd_ps(_wN, _x, _N0);
+                    _x = _mm_set1_ps(x1[i]);
+                    _R1 = _mm_comp_fmadd_ps(_wR, _x, _R1);
+                    _U1 = _mm_comp_fmadd_ps(_wU, _x, _U1);
+                    _N1 = _mm_comp_fmadd_ps(_wN, _x, _N1);
+                    _x = _mm_set1_ps(x2[i]);
+                    _R2 = _mm_comp_fmadd_ps(_wR, _x, _R2);
+                    _U2 = _mm_comp_fmadd_ps(_wU, _x, _U2);
+                    _N2 = _mm_comp_fmadd_ps(_wN, _x, _N2);
+                    _x = _mm_set1_ps(x3[i]);
+                    _R3 = _mm_comp_fmadd_ps(_wR, _x, _R3);
+                    _U3 = _mm_comp_fmadd_ps(_wU, _x, _U3);
+                    _N3 = _mm_comp_fmadd_ps(_wN, _x, _N3);
+
+                    kptr += 12;
+                }
+
+                float* outptr0 = gates_x_dr.row(t + j) + q * 3;
+                float* outptr1 = gates_x_dr.row(t + j + 1) + q * 3;
+                float* outptr2 = gates_x_dr.row(t + j + 2) + q * 3;
+                float* outptr3 = gates_x_dr.row(t + j + 3) + q * 3;
+
+                _mm_storeu_ps(outptr0, _R0);
+                _mm_storeu_ps(outptr0 + 4, _U0);
+                _mm_storeu_ps(outptr0 + 8, _N0);
+                _mm_storeu_ps(outptr1, _R1);
+                _mm_storeu_ps(outptr1 + 4, _U1);
+                _mm_storeu_ps(outptr1 + 8, _N1);
+                _mm_storeu_ps(outptr2, _R2);
+                _mm_storeu_ps(outptr2 + 4, _U2);
+                _mm_storeu_ps(outptr2 + 8, _N2);
+                _mm_storeu_ps(outptr3, _R3);
+                _mm_storeu_ps(outptr3 + 4, _U3);
+                _mm_storeu_ps(outptr3 + 8, _N3);
+            }
+            for (; j < tn; j++)
+            {
+                const float* x = bottom_blob.row(t + j);
+
+                const float* kptr = kptr0;
+
+                __m128 _R = _bR;
+                __m128 _U = _bU;
+                __m128 _N = _bN;
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m128 _x = _mm_set1_ps(x[i]);
+                    _R = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _x, _R);
+                    _U = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 4), _x, _U);
+                    _N = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 8), _x, _N);
+
+                    kptr += 12;
+                }
+
+                float* outptr = gates_x_dr.row(t + j) + q * 3;
+                _mm_storeu_ps(outptr, _R);
+                _mm_storeu_ps(outptr + 4, _U);
+                _mm_storeu_ps(outptr + 8, _N);
+            }
+            continue;
+        }
+#endif // __SSE2__
+
+        for (int j = 0; j < tn; j++)
+        {
+            const float* x = bottom_blob.row(t + j);
+            const float* kptr = kptr0;
+
+            float R = bias_c_ptr[0];
+            float U = bias_c_ptr[1];
+            float N = bias_c_ptr[2];
+
+            for (int i = 0; i < size; i++)
+            {
+                float xi = x[i];
+
+                R += kptr[0] * xi;
+                U += kptr[1] * xi;
+                N += kptr[2] * xi;
+
+                kptr += 3;
+            }
+
+            float* outptr = gates_x_dr.row(t + j) + q * 3;
+            outptr[0] = R;
+            outptr[1] = U;
+            outptr[2] = N;
+        }
+    }
+
+    return 0;
+}
+
+static int gru(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, const Mat& weight_hc, const float* bias_c, Mat& hidden_state, const Option& opt)
+{
+    const int T = gates_x.h;
+    const int num_output = hidden_state.w;
+
+    // U N
+    Mat gates(num_output, 2, 4u, opt.workspace_allocator);
+    if (gates.empty())
+        return -100;
+
+    const int max_block = gru_max_block();
+    const int nblocks = gru_block_count(num_output, max_block);
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+        const float* gates_x_ptr0 = gates_x.row(ti);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int b = 0; b < nblocks; b++)
+        {
+            int q;
+            int n;
+            gru_block_range(b, num_output, max_block, q, n);
+
+            const float* kptr = weight_hc.row(b);
+            const float* bias_c_ptr = bias_c + q * 4;
+            const float* gates_x_ptr = gates_x_ptr0 + q * 3;
+            const float* hidden_ptr = hidden_state;
+
+            float* gates_U = gates.row(0);
+            float* gates_N = gates.row(1);
+
+#if __SSE2__
+#if __AVX__
+            if (n == 8)
+            {
+                __m256 _R = _mm256_loadu_ps(gates_x_ptr);
+                __m256 _U = _mm256_loadu_ps(gates_x_ptr + 8);
+                __m256 _N = _mm256_loadu_ps(bias_c_ptr + 24);
+                __m256 _R1 = _mm256_setzero_ps();
+                __m256 _U1 = _mm256_setzero_ps();
+                __m256 _N1 = _mm256_setzero_ps();
+
+                int i = 0;
+                for (; i + 1 < num_output; i += 2)
+                {
+                    __m256 _h0 = _mm256_broadcast_ss(hidden_ptr + i);
+                    __m256 _h1 = _mm256_broadcast_ss(hidden_ptr + i + 1);
+                    _R = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _h0, _R);
+                    _U = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _h0, _U);
+                    _N = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 16), _h0, _N);
+                    _R1 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 24), _h1, _R1);
+                    _U1 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 32), _h1, _U1);
+                    _N1 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 40), _h1, _N1);
+
+                    kptr += 48;
+                }
+                for (; i < num_output; i++)
+                {
+                    __m256 _h = _mm256_broadcast_ss(hidden_ptr + i);
+                    _R = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _h, _R);
+                    _U = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _h, _U);
+                    _N = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 16), _h, _N);
+
+                    kptr += 24;
+                }
+
+                _R = sigmoid_avx(_mm256_add_ps(_R, _R1));
+                _U = sigmoid_avx(_mm256_add_ps(_U, _U1));
+                _N = tanh_avx(_mm256_comp_fmadd_ps(_R, _mm256_add_ps(_N, _N1), _mm256_loadu_ps(gates_x_ptr + 16)));
+
+                _mm256_storeu_ps(gates_U + q, _U);
+                _mm256_storeu_ps(gates_N + q, _N);
+                continue;
+            }
+#endif // __AVX__
+            if (n == 4)
+            {
+                __m128 _R = _mm_loadu_ps(gates_x_ptr);
+                __m128 _U = _mm_loadu_ps(gates_x_ptr + 4);
+                __m128 _N = _mm_loadu_ps(bias_c_ptr + 12);
+                __m128 _R1 = _mm_setzero_ps();
+                __m128 _U1 = _mm_setzero_ps();
+                __m128 _N1 = _mm_setzero_ps();
+
+                int i = 0;
+                for (; i + 1 < num_output; i += 2)
+                {
+                    __m128 _h0 = _mm_set1_ps(hidden_ptr[i]);
+                    __m128 _h1 = _mm_set1_ps(hidden_ptr[i + 1]);
+                    _R = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _h0, _R);
+                    _U = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 4), _h0, _U);
+                    _N = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 8), _h0, _N);
+                    _R1 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 12), _h1, _R1);
+                    _U1 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 16), _h1, _U1);
+                    _N1 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 20), _h1, _N1);
+
+                    kptr += 24;
+                }
+                for (; i < num_output; i++)
+                {
+                    __m128 _h = _mm_set1_ps(hidden_ptr[i]);
+                    _R = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _h, _R);
+                    _U = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 4), _h, _U);
+                    _N = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 8), _h, _N);
+
+                    kptr += 12;
+                }
+
+                _R = sigmoid_sse(_mm_add_ps(_R, _R1));
+                _U = sigmoid_sse(_mm_add_ps(_U, _U1));
+                _N = tanh_sse(_mm_comp_fmadd_ps(_R, _mm_add_ps(_N, _N1), _mm_loadu_ps(gates_x_ptr + 8)));
+
+                _mm_storeu_ps(gates_U + q, _U);
+                _mm_storeu_ps(gates_N + q, _N);
+                continue;
+            }
+#endif // __SSE2__
+
+            float R = gates_x_ptr[0];
+            float U = gates_x_ptr[1];
+            float N = bias_c_ptr[3];
+
+            for (int i = 0; i < num_output; i++)
+            {
+                float h_cont = hidden_ptr[i];
+
+                R += kptr[0] * h_cont;
+                U += kptr[1] * h_cont;
+                N += kptr[2] * h_cont;
+
+                kptr += 3;
+            }
+
+            // sigmoid(R)
+            // sigmoid(U)
+            R = 1.f / (1.f + expf(-R));
+            U = 1.f / (1.f + expf(-U));
+
+            // tanh(N)
+            N = tanhf(gates_x_ptr[2] + R * N);
+
+            gates_U[q] = U;
+            gates_N[q] = N;
+        }
+
+        gru_update_hidden(gates, hidden_state, top_blob.row(ti) + outw_offset);
+    }
+
+    return 0;
+}
+
+int GRU_x86::forward_directions(const Mat& bottom_blob, Mat& top_blob, Mat& hidden, const Option& opt) const
+{
+    const int size = bottom_blob.w;
+    const int num_directions = direction == 2 ? 2 : 1;
+
+    Mat gates_x;
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        int ret = gru_int8_input_projection(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c_data_packed, num_output, opt);
+        if (ret != 0)
+            return ret;
+    }
+    else
+#endif
+    {
+        int ret = gru_input_projection(bottom_blob, gates_x, weight_xc_data_packed, bias_c_data_packed, num_output, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    // each direction writes its own half of the output row, no concat needed
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        const int reverse = direction == 2 ? dr : direction;
+
+        Mat hidden_dr = hidden.row_range(dr, 1);
+
+#if NCNN_INT8
+        if (int8_scale_term)
+        {
+            int ret = gru_int8(gates_x.channel(dr), top_blob, num_output * dr, reverse, size, weight_data_tm.channel(dr), weight_data_tm_int8_descales.channel(dr), bias_c_data_packed.channel(dr), hidden_dr, opt);
+            if (ret != 0)
+                return ret;
+        }
+        else
+#endif
+        {
+            int ret = gru(gates_x.channel(dr), top_blob, num_output * dr, reverse, weight_hc_data_packed.channel(dr), bias_c_data_packed.channel(dr), hidden_dr, opt);
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+int GRU_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int T = bottom_blob.h;
+
+    int num_directions = direction == 2 ? 2 : 1;
+
+    // initial hidden state
+    Mat hidden(num_output, num_directions, 4u, opt.workspace_allocator);
+    if (hidden.empty())
+        return -100;
+    hidden.fill(0.f);
+
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return forward_directions(bottom_blob, top_blob, hidden, opt);
+}
+
+int GRU_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    int T = bottom_blob.h;
+    int num_directions = direction == 2 ? 2 : 1;
+
+    Mat hidden;
+    Allocator* hidden_allocator = top_blobs.size() == 2 ? opt.blob_allocator : opt.workspace_allocator;
+    if (bottom_blobs.size() == 2 && !bottom_blobs[1].empty())
+    {
+        hidden = bottom_blobs[1].clone(hidden_allocator);
+    }
+    else
+    {
+        hidden.create(num_output, num_directions, 4u, hidden_allocator);
+        if (hidden.empty())
+            return -100;
+        hidden.fill(0.f);
+    }
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int ret = forward_directions(bottom_blob, top_blob, hidden, opt);
+    if (ret != 0)
+        return ret;
+
+    if (top_blobs.size() == 2)
+    {
+        top_blobs[1] = hidden;
+    }
+
+    return 0;
+}
+
+#if NCNN_INT8
+int GRU_x86::create_pipeline_int8(const Option& opt)
+{
+    // pack RUN
+    const int num_directions = direction == 2 ? 2 : 1;
+    const int size = weight_data_size / num_directions / num_output / 3;
+
+    if (weight_data_tm.empty())
+    {
+        gru_transform_weight_int8(weight_xc_data, weight_xc_data_int8_scales, weight_hc_data, weight_hc_data_int8_scales, weight_data_tm, weight_data_tm_int8_descales, size, num_output, num_directions, opt);
+
+        gru_transform_bias(bias_c_data, bias_c_data_packed, num_output, num_directions, gru_int8_max_block());
+    }
+
+    if (opt.lightmode)
+    {
+        weight_xc_data.release();
+        bias_c_data.release();
+        weight_hc_data.release();
+        weight_xc_data_int8_scales.release();
+        weight_hc_data_int8_scales.release();
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
+} // namespace ncnn
@@ -0,0 +1,36 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "cpu.h"
+#include "mat.h"
+#include "layer.h"
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+namespace ncnn {
+
+#include "gru_block.h"
+#include "gru_int8.h"
+
+int gru_int8_input_projection_avxvnni(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt)
+{
+    return gru_int8_input_projection(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c, num_output, opt);
+}
+
+int gru_int8_avxvnni(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, const float* bias_c_ptr, Mat& hidden_state, const Option& opt)
+{
+    return gru_int8(gates_x, top_blob, outw_offset, reverse, size, weight_data_tm, descales_ptr, bias_c_ptr, hidden_state, opt);
+}
+
+} // namespace ncnn
@@ -0,0 +1,265 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2024 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// weight row layout
+//   int8 = num_input signed char
+//   int4 = num_input / 2 bytes, even element in low nibble, odd element in high nibble
+// one float scale per group_size elements, weight = int * scale
+
+static float innerproduct_weight_quant_dot_int8(const float* x, const signed char* kptr, const float* scales, int num_input, int group_size)
+{
+    float sum = 0.f;
+#if __SSE2__
+#if __AVX2__
+    __m256 _sum = _mm256_setzero_ps();
+#endif // __AVX2__
+    __m128 _sum0 = _mm_setzero_ps();
+#endif // __SSE2__
+
+    for (int g = 0; g < num_input / group_size; g++)
+    {
+        const float* xg = x + g * group_size;
+        const signed char* w = kptr + g * group_size;
+        const float scale = scales[g];
+
+        int i = 0;
+#if __SSE2__
+#if __AVX2__
+        __m256 _acc = _mm256_setzero_ps();
+        for (; i + 7 < group_size; i += 8)
+        {
+            __m256 _w = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(w + i))));
+            _acc = _mm256_comp_fmadd_ps(_w, _mm256_loadu_ps(xg + i), _acc);
+        }
+        _sum = _mm256_comp_fmadd_ps(_acc, _mm256_set1_ps(scale), _sum);
+#endif // __AVX2__
+        __m128 _acc0 = _mm_setzero_ps();
+        for (; i + 3 < group_size; i += 4)
+        {
+            __m128i _w = _mm_cvtsi32_si128(((const int*)(w + i))[0]);
+            _w = _mm_unpacklo_epi8(_w, _mm_cmpgt_epi8(_mm_setzero_si128(), _w));
+            _w = _mm_unpacklo_epi16(_w, _mm_cmpgt_epi16(_mm_setzero_si128(), _w));
+            _acc0 = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_w), _mm_loadu_ps(xg + i), _acc0);
+        }
+        _sum0 = _mm_comp_fmadd_ps(_acc0, _mm_set1_ps(scale), _sum0);
+#endif // __SSE2__
+        float acc = 0.f;
+        for (; i < group_size; i++)
+        {
+            acc += w[i] * xg[i];
+        }
+        sum += acc * scale;
+    }
+
+#if __SSE2__
+#if __AVX2__
+    sum += _mm256_reduce_add_ps(_sum);
+#endif // __AVX2__
+    sum += _mm_reduce_add_ps(_sum0);
+#endif // __SSE2__
+
+    return sum;
+}
+
+static float innerproduct_weight_quant_dot_int4(const float* x, const signed char* kptr, const float* scales, int num_input, int group_size)
+{
+    float sum = 0.f;
+#if __SSE2__
+#if __AVX2__
+    __m256 _sum = _mm256_setzero_ps();
+#endif // __AVX2__
+    __m128 _sum0 = _mm_setzero_ps();
+#endif // __SSE2__
+
+    for (int g = 0; g < num_input / group_size; g++)
+    {
+        const float* xg = x + g * group_size;
+        const signed char* w = kptr + g * group_size / 2;
+        const float scale = scales[g];
+
+        int i = 0;
+#if __SSE2__
+#if __AVX2__
+        __m256 _acc = _mm256_setzero_ps();
+        for (; i + 15 < group_size; i += 16)
+        {
+            __m256i _b = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(w + i / 2)));
+            __m256i _lo = _mm256_srai_epi32(_mm256_slli_epi32(_b, 28), 28);
+            __m256i _hi = _mm256_srai_epi32(_b, 4);
+            __m256i _wl = _mm256_unpacklo_epi32(_lo, _hi);
+            __m256i _wh = _mm256_unpackhi_epi32(_lo, _hi);
+            __m256 _w0 = _mm256_cvtepi32_ps(_mm256_permute2x128_si256(_wl, _wh, _MM_SHUFFLE(0, 2, 0, 0)));
+            __m256 _w1 = _mm256_cvtepi32_ps(_mm256_permute2x128_si256(_wl, _wh, _MM_SHUFFLE(0, 3, 0, 1)));
+            _acc = _mm256_comp_fmadd_ps(_w0, _mm256_loadu_ps(xg + i), _acc);
+            _acc = _mm256_comp_fmadd_ps(_w1, _mm256_loadu_ps(xg + i + 8), _acc);
+        }
+        _sum = _mm256_comp_fmadd_ps(_acc, _mm256_set1_ps(scale), _sum);
+#endif // __AVX2__
+        __m128 _acc0 = _mm_setzero_ps();
+        for (; i + 7 < group_size; i += 8)
+        {
+            __m128i _b = _mm_cvtsi32_si128(((const int*)(w + i / 2))[0]);
+            _b = _mm_unpacklo_epi8(_b, _mm_cmpgt_epi8(_mm_setzero_si128(), _b));
+            _b = _mm_unpacklo_epi16(_b, _mm_cmpgt_epi16(_mm_setzero_si128(), _b));
+            __m128i _lo = _mm_srai_epi32(_mm_slli_epi32(_b, 28), 28);
+            __m128i _hi = _mm_srai_epi32(_b, 4);
+            __m128 _w0 = _mm_cvtepi32_ps(_mm_unpacklo_epi32(_lo, _hi));
+            __m128 _w1 = _mm_cvtepi32_ps(_mm_unpackhi_epi32(_lo, _hi));
+            _acc0 = _mm_comp_fmadd_ps(_w0, _mm_loadu_ps(xg + i), _acc0);
+            _acc0 = _mm_comp_fmadd_ps(_w1, _mm_loadu_ps(xg + i + 4), _acc0);
+        }
+        _sum0 = _mm_comp_fmadd_ps(_acc0, _mm_set1_ps(scale), _sum0);
+#endif // __SSE2__
+        float acc = 0.f;
+        for (; i + 1 < group_size; i += 2)
+        {
+            const signed char b = w[i / 2];
+            acc += (signed char)(b << 4) / 16 * xg[i];
+            acc += (b >> 4) * xg[i + 1];
+        }
+        sum += acc * scale;
+    }
+
+#if __SSE2__
+#if __AVX2__
+    sum += _mm256_reduce_add_ps(_sum);
+#endif // __AVX2__
+    sum += _mm_reduce_add_ps(_sum0);
+#endif // __SSE2__
+
+    return sum;
+}
+
+static void innerproduct_weight_quant_dequantize_row(const signed char* kptr, const float* scales, float* outptr, int num_input, int bits, int group_size)
+{
+    for (int g = 0; g < num_input / group_size; g++)
+    {
+        const float scale = scales[g];
+
+        if (bits == 8)
+        {
+            const signed char* w = kptr + g * group_size;
+            for (int i = 0; i < group_size; i++)
+            {
+                outptr[i] = w[i] * scale;
+            }
+        }
+        else
+        {
+            const signed char* w = kptr + g * group_size / 2;
+            for (int i = 0; i + 1 < group_size; i += 2)
+            {
+                const signed char b = w[i / 2];
+                outptr[i] = (signed char)(b << 4) / 16 * scale;
+                outptr[i + 1] = (b >> 4) * scale;
+            }
+        }
+
+        outptr += group_size;
+    }
+}
+
+static void innerproduct_weight_quant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data, const Mat& weight_data_group_scales, const Mat& bias_data, int bits, int group_size, int activation_type, const Mat& activation_params, const Option& opt)
+{
+    const int num_input = bottom_blob.w;
+    const int num_output = top_blob.w;
+
+    const size_t row_bytes = (size_t)num_input * bits / 8;
+
+    const float* x = bottom_blob;
+    float* outptr = top_blob;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < num_output; p++)
+    {
+        const signed char* kptr = (const signed char*)weight_data + row_bytes * p;
+        const float* scales = weight_data_group_scales.row(p);
+
+        float sum = bias_data.empty() ? 0.f : bias_data[p];
+
+        if (bits == 8)
+            sum += innerproduct_weight_quant_dot_int8(x, kptr, scales, num_input, group_size);
+        else
+            sum += innerproduct_weight_quant_dot_int4(x, kptr, scales, num_input, group_size);
+
+        outptr[p] = activation_ss(sum, activation_type, activation_params);
+    }
+}
+
+static int innerproduct_gemm_weight_quant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data, const Mat& weight_data_group_scales, const Mat& bias_data, int bits, int group_size, int activation_type, const Mat& activation_params, const Option& opt)
+{
+    const int num_input = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int elempack = bottom_blob.elempack;
+    const size_t elemsize = bottom_blob.elemsize;
+    const int num_output = top_blob.w;
+
+    const size_t row_bytes = (size_t)num_input * bits / 8;
+
+    // dequantize a tile of output channels that fits in l2, pack it like weight_data_tm
+    // and run the regular fp32 gemm kernel on it, so no fp32 copy of the whole weight is kept
+    const int l2_cache_size = get_cpu_level2_cache_size();
+    int TILE_N = l2_cache_size / 2 / (num_input * (int)sizeof(float)) / 16 * 16;
+    TILE_N = std::max(TILE_N, 16);
+    TILE_N = std::min(TILE_N, num_output);
+
+    Mat weight_tile(num_input, TILE_N, (size_t)4u, opt.workspace_allocator);
+    if (weight_tile.empty())
+        return -100;
+
+    Mat weight_tile_tm;
+    Mat top_tile;
+
+    for (int p0 = 0; p0 < num_output; p0 += TILE_N)
+    {
+        const int nn = std::min(TILE_N, num_output - p0);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < nn; p++)
+        {
+            const signed char* kptr = (const signed char*)weight_data + row_bytes * (p0 + p);
+
+            innerproduct_weight_quant_dequantize_row(kptr, weight_data_group_scales.row(p0 + p), weight_tile.row(p), num_input, bits, group_size);
+        }
+
+        Option opt_tm = opt;
+        opt_tm.blob_allocator = opt.workspace_allocator;
+
+        innerproduct_transform_kernel_sse(weight_tile.row_range(0, nn), weight_tile_tm, num_input, nn, opt_tm);
+
+        Mat bias_tile;
+        if (!bias_data.empty())
+            bias_tile = bias_data.range(p0, nn);
+
+        if (nn == num_output)
+        {
+            innerproduct_gemm_sse(bottom_blob, top_blob, weight_tile_tm, bias_tile, activation_type, activation_params, opt);
+            break;
+        }
+
+        top_tile.create(nn, h, elemsize, elempack, opt.workspace_allocator);
+        if (top_tile.empty())
+            return -100;
+
+        innerproduct_gemm_sse(bottom_blob, top_tile, weight_tile_tm, bias_tile, activation_type, activation_params, opt);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int j = 0; j < h; j++)
+        {
+            memcpy(top_blob.row(j) + p0 * elempack, top_tile.row(j), nn * elemsize);
+        }
+    }
+
+    return 0;
+}
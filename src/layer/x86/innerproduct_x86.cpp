@@ -24,6 +24,7 @@
 #include "x86_activation.h"
 #include "x86_usability.h"
 
+#include "benchmark.h"
 #include "layer_type.h"
 
 #include "cpu.h"
@@ -32,6 +33,7 @@ namespace ncnn {
 
 #include "innerproduct_fp.h"
 #include "innerproduct_gemm_fp.h"
+#include "innerproduct_weight_quant.h"
 
 #if NCNN_F16C && __AVX__
 #define NCNN_IMPL_FP16S 1
@@ -47,6 +49,10 @@ InnerProduct_x86::InnerProduct_x86()
 #endif // __SSE2__
 
     flatten = 0;
+
+#if NCNN_INT8
+    gemm = 0;
+#endif
 }
 
 int InnerProduct_x86::create_pipeline(const Option& opt)
@@ -62,6 +68,12 @@ int InnerProduct_x86::create_pipeline(const Option& opt)
         flatten->create_pipeline(opt);
     }
 
+    if (weight_quant_bits)
+    {
+        // weight stays compressed, kernels dequantize on the fly
+        return 0;
+    }
+
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
@@ -78,7 +90,10 @@ int InnerProduct_x86::create_pipeline(const Option& opt)
 
     const int num_input = weight_data_size / num_output;
 
-    innerproduct_transform_kernel_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+    if (weight_data_tm.empty())
+    {
+        innerproduct_transform_kernel_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+    }
 
     if (opt.lightmode)
         weight_data.release();
@@ -86,6 +101,13 @@ int InnerProduct_x86::create_pipeline(const Option& opt)
     return 0;
 }
 
+int InnerProduct_x86::pipeline_weights(std::vector<Mat*>& weights)
+{
+    weights.push_back(&weight_data_tm);
+
+    return 0;
+}
+
 int InnerProduct_x86::destroy_pipeline(const Option& opt)
 {
     if (flatten)
@@ -95,13 +117,27 @@ int InnerProduct_x86::destroy_pipeline(const Option& opt)
         flatten = 0;
     }
 
+#if NCNN_INT8
+    if (gemm)
+    {
+        gemm->destroy_pipeline(opt);
+        delete gemm;
+        gemm = 0;
+    }
+#endif
+
     return 0;
 }
 
 int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
+    if (weight_quant_bits)
+    {
+        return forward_weight_quant_x86(bottom_blob, top_blob, opt);
+    }
+
 #if NCNN_INT8
-    if (opt.use_int8_inference && int8_scale_term)
+    if (opt.use_int8_inference && (int8_scale_term || int8_dynamic_quantize))
     {
         return forward_int8_x86(bottom_blob, top_blob, opt);
     }
@@ -127,6 +163,7 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
         if (top_blob.empty())
             return -100;
 
+        profile_kernel("gemm");
         innerproduct_gemm_sse(bottom_blob, top_blob, weight_data_tm, bias_data, activation_type, activation_params, opt);
 
         return 0;
@@ -166,17 +203,64 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
     if (top_blob.empty())
         return -100;
 
+    profile_kernel("gemv");
     innerproduct_sse(bottom_blob_flattened, top_blob, weight_data_tm, bias_data, activation_type, activation_params, opt);
 
     return 0;
 }
 
+int InnerProduct_x86::forward_weight_quant_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    if (bottom_blob.dims == 2 && bottom_blob.w == num_input)
+    {
+        // gemm
+        top_blob.create(num_output, bottom_blob.h, bottom_blob.elemsize, bottom_blob.elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        profile_kernel("weight_quant_gemm");
+        return innerproduct_gemm_weight_quant_sse(bottom_blob, top_blob, weight_data, weight_data_group_scales, bias_data, weight_quant_bits, weight_quant_group_size, activation_type, activation_params, opt);
+    }
+
+    Option opt_pack1 = opt;
+    opt_pack1.blob_allocator = opt.workspace_allocator;
+    opt_pack1.use_packing_layout = false;
+
+    Mat bottom_blob_unpacked;
+    convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_pack1);
+    if (bottom_blob_unpacked.empty())
+        return -100;
+
+    // flatten
+    Mat bottom_blob_flattened = bottom_blob_unpacked;
+    if (bottom_blob_unpacked.dims != 1)
+    {
+        flatten->forward(bottom_blob_unpacked, bottom_blob_flattened, opt_pack1);
+        if (bottom_blob_flattened.empty())
+            return -100;
+    }
+
+    top_blob.create(num_output, (size_t)4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    profile_kernel("weight_quant_gemv");
+    innerproduct_weight_quant_sse(bottom_blob_flattened, top_blob, weight_data, weight_data_group_scales, bias_data, weight_quant_bits, weight_quant_group_size, activation_type, activation_params, opt);
+
+    return 0;
+}
+
 #if NCNN_F16C && __AVX__
 int InnerProduct_x86::create_pipeline_fp16s(const Option& opt)
 {
     const int num_input = weight_data_size / num_output;
 
-    innerproduct_transform_kernel_fp16s_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+    if (weight_data_tm.empty())
+    {
+        innerproduct_transform_kernel_fp16s_sse(weight_data, weight_data_tm, num_input, num_output, opt);
+    }
 
     if (opt.lightmode)
         weight_data.release();
@@ -199,6 +283,7 @@ int InnerProduct_x86::forward_fp16s(const Mat& bottom_blob, Mat& top_blob, const
         if (top_blob.empty())
             return -100;
 
+        profile_kernel("fp16s_gemm");
         innerproduct_gemm_fp16s_sse(bottom_blob, top_blob, weight_data_tm, bias_data, activation_type, activation_params, opt);
 
         return 0;
@@ -234,6 +319,7 @@ int InnerProduct_x86::forward_fp16s(const Mat& bottom_blob, Mat& top_blob, const
     if (top_blob.empty())
         return -100;
 
+    profile_kernel("fp16s_gemv");
     innerproduct_fp16s_sse(bottom_blob_flattened, top_blob, weight_data_tm, bias_data, activation_type, activation_params, opt);
 
     return 0;
@@ -245,6 +331,47 @@ int InnerProduct_x86::create_pipeline_int8_x86(const Option& opt)
 {
     const int num_input = weight_data_size / num_output;
 
+    if (int8_dynamic_quantize)
+    {
+        // gemm quantizes each input row with its own scale, weight is passed in quantized with unit scale
+        gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
+
+        ncnn::ParamDict pd;
+        pd.set(2, 0);          // transA
+        pd.set(3, 1);          // transB
+        pd.set(4, 0);          // constantA
+        pd.set(5, 1);          // constantB
+        pd.set(6, 1);          // constantC
+        pd.set(7, 0);          // M
+        pd.set(8, num_output); // N
+        pd.set(9, num_input);  // K
+        pd.set(10, -1);        // constant_broadcast_type_C
+        pd.set(18, 1);         // int8_scale_term
+
+        gemm->load_param(pd);
+
+        Mat weights[2];
+        weights[0] = weight_data.reshape(num_input, num_output);
+        weights[1] = Mat(1);
+        weights[1].fill(1.f);
+
+        gemm->load_model(ModelBinFromMatArray(weights));
+
+        gemm->create_pipeline(opt);
+
+        // per output channel dequantize scale, input scales are applied in gemm
+        scale_in_data.create(num_output);
+        for (int p = 0; p < num_output; p++)
+        {
+            scale_in_data[p] = weight_data_int8_scales[p] == 0 ? 0.f : 1.f / weight_data_int8_scales[p];
+        }
+
+        if (opt.lightmode)
+            weight_data.release();
+
+        return 0;
+    }
+
     int out_elempack = 1;
 #if __SSE2__
     if (opt.use_packing_layout)
@@ -255,6 +382,7 @@ int InnerProduct_x86::create_pipeline_int8_x86(const Option& opt)
 
     // src = inch-outch
     // dst = pb-inch-outch/pb
+    if (weight_data_tm.empty())
     {
         Mat weight_data_r2 = weight_data.reshape(num_input, num_output);
 
@@ -293,10 +421,88 @@ int InnerProduct_x86::create_pipeline_int8_x86(const Option& opt)
     return 0;
 }
 
+int InnerProduct_x86::forward_int8_dynamic_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    // one token per row for gemm, the whole blob is one token otherwise
+    const bool is_gemm = bottom_blob.dims == 2 && bottom_blob.w == num_input;
+
+    Mat bottom_blob_2d = bottom_blob;
+    if (!is_gemm)
+    {
+        Option opt_flatten = opt;
+        opt_flatten.blob_allocator = opt.workspace_allocator;
+        opt_flatten.use_packing_layout = false;
+
+        Mat bottom_blob_unpacked;
+        convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_flatten);
+        if (bottom_blob_unpacked.empty())
+            return -100;
+
+        Mat bottom_blob_flattened;
+        flatten->forward(bottom_blob_unpacked, bottom_blob_flattened, opt_flatten);
+        if (bottom_blob_flattened.empty())
+            return -100;
+
+        bottom_blob_2d = bottom_blob_flattened.reshape(num_input, 1, opt.workspace_allocator);
+        if (bottom_blob_2d.empty())
+            return -100;
+    }
+
+    profile_kernel("int8_dynamic_gemm");
+
+    Mat top_blob_2d;
+    int ret = gemm->forward(bottom_blob_2d, top_blob_2d, opt);
+    if (ret != 0)
+        return ret;
+
+    // dequantize per output channel, bias and activation
+    const int outh = top_blob_2d.h;
+    const int out_elempack = top_blob_2d.elempack;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int j = 0; j < outh; j++)
+    {
+        float* ptr = top_blob_2d.row(j);
+
+        for (int p = 0; p < num_output; p++)
+        {
+            const float scale_in = scale_in_data[p];
+            const float bias = bias_term ? bias_data[p] : 0.f;
+
+            for (int k = 0; k < out_elempack; k++)
+            {
+                ptr[k] = activation_ss(ptr[k] * scale_in + bias, activation_type, activation_params);
+            }
+
+            ptr += out_elempack;
+        }
+    }
+
+    if (is_gemm)
+    {
+        top_blob = top_blob_2d;
+    }
+    else
+    {
+        top_blob = top_blob_2d.reshape(num_output, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
 int InnerProduct_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
     const int num_input = weight_data_size / num_output;
 
+    if (int8_dynamic_quantize && bottom_blob.elembits() != 8)
+    {
+        return forward_int8_dynamic_x86(bottom_blob, top_blob, opt);
+    }
+
     int elembits = bottom_blob.elembits();
 
     Mat bottom_blob_int8 = bottom_blob;
@@ -309,6 +515,8 @@ int InnerProduct_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, co
             return -100;
     }
 
+    profile_kernel("int8");
+
     if (bottom_blob_int8.dims == 2 && bottom_blob_int8.w == num_input)
     {
         // gemm
@@ -27,9 +27,12 @@ public:
     virtual int create_pipeline(const Option& opt);
     virtual int destroy_pipeline(const Option& opt);
 
+    virtual int pipeline_weights(std::vector<Mat*>& weights);
+
     virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 protected:
+    int forward_weight_quant_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 #if NCNN_F16C && __AVX__
     int create_pipeline_fp16s(const Option& opt);
     int forward_fp16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
@@ -37,6 +40,7 @@ protected:
 #if NCNN_INT8
     int create_pipeline_int8_x86(const Option& opt);
     int forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_int8_dynamic_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 #endif
 
 public:
@@ -46,6 +50,9 @@ public:
 
 #if NCNN_INT8
     Mat scale_in_data;
+
+    // per-token gemm for int8_dynamic_quantize
+    Layer* gemm;
 #endif
 };
 
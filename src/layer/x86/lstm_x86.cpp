@@ -54,144 +54,147 @@ int LSTM_x86::create_pipeline(const Option& opt)
     int num_directions = direction == 2 ? 2 : 1;
     int size = weight_data_size / num_directions / hidden_size / 4;
 
+    if (weight_xc_data_packed.empty())
+    {
 #if __AVX__
-    weight_xc_data_packed.create(size, hidden_size / 2 + hidden_size % 2, num_directions, 32u, 8);
-    bias_c_data_packed.create(hidden_size, 1, num_directions, 16u, 4);
-    weight_hc_data_packed.create(num_output, hidden_size / 2 + hidden_size % 2, num_directions, 32u, 8);
+        weight_xc_data_packed.create(size, hidden_size / 2 + hidden_size % 2, num_directions, 32u, 8);
+        bias_c_data_packed.create(hidden_size, 1, num_directions, 16u, 4);
+        weight_hc_data_packed.create(num_output, hidden_size / 2 + hidden_size % 2, num_directions, 32u, 8);
 #else
-    weight_xc_data_packed.create(size, hidden_size, num_directions, 16u, 4);
-    bias_c_data_packed.create(hidden_size, 1, num_directions, 16u, 4);
-    weight_hc_data_packed.create(num_output, hidden_size, num_directions, 16u, 4);
+        weight_xc_data_packed.create(size, hidden_size, num_directions, 16u, 4);
+        bias_c_data_packed.create(hidden_size, 1, num_directions, 16u, 4);
+        weight_hc_data_packed.create(num_output, hidden_size, num_directions, 16u, 4);
 #endif
 
-    #pragma omp parallel for num_threads(opt.num_threads)
-    for (int dr = 0; dr < num_directions; dr++)
-    {
-        const Mat weight_xc = weight_xc_data.channel(dr);
-        const Mat bias_c = bias_c_data.channel(dr);
-        const Mat weight_hc = weight_hc_data.channel(dr);
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            const Mat weight_xc = weight_xc_data.channel(dr);
+            const Mat bias_c = bias_c_data.channel(dr);
+            const Mat weight_hc = weight_hc_data.channel(dr);
 
-        Mat weight_xc_data_packed_dr = weight_xc_data_packed.channel(dr);
-        Mat bias_c_data_packed_dr = bias_c_data_packed.channel(dr);
-        Mat weight_hc_data_packed_dr = weight_hc_data_packed.channel(dr);
+            Mat weight_xc_data_packed_dr = weight_xc_data_packed.channel(dr);
+            Mat bias_c_data_packed_dr = bias_c_data_packed.channel(dr);
+            Mat weight_hc_data_packed_dr = weight_hc_data_packed.channel(dr);
 
-        const float* bias_c_I = bias_c.row(0);
-        const float* bias_c_F = bias_c.row(1);
-        const float* bias_c_O = bias_c.row(2);
-        const float* bias_c_G = bias_c.row(3);
+            const float* bias_c_I = bias_c.row(0);
+            const float* bias_c_F = bias_c.row(1);
+            const float* bias_c_O = bias_c.row(2);
+            const float* bias_c_G = bias_c.row(3);
 
-        float* bias_c_IFOG = bias_c_data_packed_dr.row(0);
+            float* bias_c_IFOG = bias_c_data_packed_dr.row(0);
 
-        int q = 0;
+            int q = 0;
 #if __AVX__
-        for (; q + 1 < hidden_size; q += 2)
-        {
-            bias_c_IFOG[0] = bias_c_I[q];
-            bias_c_IFOG[1] = bias_c_F[q];
-            bias_c_IFOG[2] = bias_c_O[q];
-            bias_c_IFOG[3] = bias_c_G[q];
-            bias_c_IFOG[4] = bias_c_I[q + 1];
-            bias_c_IFOG[5] = bias_c_F[q + 1];
-            bias_c_IFOG[6] = bias_c_O[q + 1];
-            bias_c_IFOG[7] = bias_c_G[q + 1];
-
-            bias_c_IFOG += 8;
-
-            const float* weight_xc_I = weight_xc.row(hidden_size * 0 + q);
-            const float* weight_xc_F = weight_xc.row(hidden_size * 1 + q);
-            const float* weight_xc_O = weight_xc.row(hidden_size * 2 + q);
-            const float* weight_xc_G = weight_xc.row(hidden_size * 3 + q);
-            const float* weight_xc_I_1 = weight_xc.row(hidden_size * 0 + q + 1);
-            const float* weight_xc_F_1 = weight_xc.row(hidden_size * 1 + q + 1);
-            const float* weight_xc_O_1 = weight_xc.row(hidden_size * 2 + q + 1);
-            const float* weight_xc_G_1 = weight_xc.row(hidden_size * 3 + q + 1);
-
-            const float* weight_hc_I = weight_hc.row(hidden_size * 0 + q);
-            const float* weight_hc_F = weight_hc.row(hidden_size * 1 + q);
-            const float* weight_hc_O = weight_hc.row(hidden_size * 2 + q);
-            const float* weight_hc_G = weight_hc.row(hidden_size * 3 + q);
-            const float* weight_hc_I_1 = weight_hc.row(hidden_size * 0 + q + 1);
-            const float* weight_hc_F_1 = weight_hc.row(hidden_size * 1 + q + 1);
-            const float* weight_hc_O_1 = weight_hc.row(hidden_size * 2 + q + 1);
-            const float* weight_hc_G_1 = weight_hc.row(hidden_size * 3 + q + 1);
-
-            float* weight_xc_IFOG = weight_xc_data_packed_dr.row(q / 2);
-            float* weight_hc_IFOG = weight_hc_data_packed_dr.row(q / 2);
-
-            for (int i = 0; i < size; i++)
-            {
-                weight_xc_IFOG[0] = weight_xc_I[i];
-                weight_xc_IFOG[1] = weight_xc_F[i];
-                weight_xc_IFOG[2] = weight_xc_O[i];
-                weight_xc_IFOG[3] = weight_xc_G[i];
-                weight_xc_IFOG[4] = weight_xc_I_1[i];
-                weight_xc_IFOG[5] = weight_xc_F_1[i];
-                weight_xc_IFOG[6] = weight_xc_O_1[i];
-                weight_xc_IFOG[7] = weight_xc_G_1[i];
-
-                weight_xc_IFOG += 8;
-            }
-
-            for (int i = 0; i < num_output; i++)
+            for (; q + 1 < hidden_size; q += 2)
             {
-                weight_hc_IFOG[0] = weight_hc_I[i];
-                weight_hc_IFOG[1] = weight_hc_F[i];
-                weight_hc_IFOG[2] = weight_hc_O[i];
-                weight_hc_IFOG[3] = weight_hc_G[i];
-                weight_hc_IFOG[4] = weight_hc_I_1[i];
-                weight_hc_IFOG[5] = weight_hc_F_1[i];
-                weight_hc_IFOG[6] = weight_hc_O_1[i];
-                weight_hc_IFOG[7] = weight_hc_G_1[i];
+                bias_c_IFOG[0] = bias_c_I[q];
+                bias_c_IFOG[1] = bias_c_F[q];
+                bias_c_IFOG[2] = bias_c_O[q];
+                bias_c_IFOG[3] = bias_c_G[q];
+                bias_c_IFOG[4] = bias_c_I[q + 1];
+                bias_c_IFOG[5] = bias_c_F[q + 1];
+                bias_c_IFOG[6] = bias_c_O[q + 1];
+                bias_c_IFOG[7] = bias_c_G[q + 1];
+
+                bias_c_IFOG += 8;
+
+                const float* weight_xc_I = weight_xc.row(hidden_size * 0 + q);
+                const float* weight_xc_F = weight_xc.row(hidden_size * 1 + q);
+                const float* weight_xc_O = weight_xc.row(hidden_size * 2 + q);
+                const float* weight_xc_G = weight_xc.row(hidden_size * 3 + q);
+                const float* weight_xc_I_1 = weight_xc.row(hidden_size * 0 + q + 1);
+                const float* weight_xc_F_1 = weight_xc.row(hidden_size * 1 + q + 1);
+                const float* weight_xc_O_1 = weight_xc.row(hidden_size * 2 + q + 1);
+                const float* weight_xc_G_1 = weight_xc.row(hidden_size * 3 + q + 1);
+
+                const float* weight_hc_I = weight_hc.row(hidden_size * 0 + q);
+                const float* weight_hc_F = weight_hc.row(hidden_size * 1 + q);
+                const float* weight_hc_O = weight_hc.row(hidden_size * 2 + q);
+                const float* weight_hc_G = weight_hc.row(hidden_size * 3 + q);
+                const float* weight_hc_I_1 = weight_hc.row(hidden_size * 0 + q + 1);
+                const float* weight_hc_F_1 = weight_hc.row(hidden_size * 1 + q + 1);
+                const float* weight_hc_O_1 = weight_hc.row(hidden_size * 2 + q + 1);
+                const float* weight_hc_G_1 = weight_hc.row(hidden_size * 3 + q + 1);
+
+                float* weight_xc_IFOG = weight_xc_data_packed_dr.row(q / 2);
+                float* weight_hc_IFOG = weight_hc_data_packed_dr.row(q / 2);
+
+                for (int i = 0; i < size; i++)
+                {
+                    weight_xc_IFOG[0] = weight_xc_I[i];
+                    weight_xc_IFOG[1] = weight_xc_F[i];
+                    weight_xc_IFOG[2] = weight_xc_O[i];
+                    weight_xc_IFOG[3] = weight_xc_G[i];
+                    weight_xc_IFOG[4] = weight_xc_I_1[i];
+                    weight_xc_IFOG[5] = weight_xc_F_1[i];
+                    weight_xc_IFOG[6] = weight_xc_O_1[i];
+                    weight_xc_IFOG[7] = weight_xc_G_1[i];
+
+                    weight_xc_IFOG += 8;
+                }
 
-                weight_hc_IFOG += 8;
+                for (int i = 0; i < num_output; i++)
+                {
+                    weight_hc_IFOG[0] = weight_hc_I[i];
+                    weight_hc_IFOG[1] = weight_hc_F[i];
+                    weight_hc_IFOG[2] = weight_hc_O[i];
+                    weight_hc_IFOG[3] = weight_hc_G[i];
+                    weight_hc_IFOG[4] = weight_hc_I_1[i];
+                    weight_hc_IFOG[5] = weight_hc_F_1[i];
+                    weight_hc_IFOG[6] = weight_hc_O_1[i];
+                    weight_hc_IFOG[7] = weight_hc_G_1[i];
+
+                    weight_hc_IFOG += 8;
+                }
             }
-        }
 #endif // __AVX__
-        for (; q < hidden_size; q++)
-        {
-            bias_c_IFOG[0] = bias_c_I[q];
-            bias_c_IFOG[1] = bias_c_F[q];
-            bias_c_IFOG[2] = bias_c_O[q];
-            bias_c_IFOG[3] = bias_c_G[q];
+            for (; q < hidden_size; q++)
+            {
+                bias_c_IFOG[0] = bias_c_I[q];
+                bias_c_IFOG[1] = bias_c_F[q];
+                bias_c_IFOG[2] = bias_c_O[q];
+                bias_c_IFOG[3] = bias_c_G[q];
 
-            bias_c_IFOG += 4;
+                bias_c_IFOG += 4;
 
-            const float* weight_xc_I = weight_xc.row(hidden_size * 0 + q);
-            const float* weight_xc_F = weight_xc.row(hidden_size * 1 + q);
-            const float* weight_xc_O = weight_xc.row(hidden_size * 2 + q);
-            const float* weight_xc_G = weight_xc.row(hidden_size * 3 + q);
+                const float* weight_xc_I = weight_xc.row(hidden_size * 0 + q);
+                const float* weight_xc_F = weight_xc.row(hidden_size * 1 + q);
+                const float* weight_xc_O = weight_xc.row(hidden_size * 2 + q);
+                const float* weight_xc_G = weight_xc.row(hidden_size * 3 + q);
 
-            const float* weight_hc_I = weight_hc.row(hidden_size * 0 + q);
-            const float* weight_hc_F = weight_hc.row(hidden_size * 1 + q);
-            const float* weight_hc_O = weight_hc.row(hidden_size * 2 + q);
-            const float* weight_hc_G = weight_hc.row(hidden_size * 3 + q);
+                const float* weight_hc_I = weight_hc.row(hidden_size * 0 + q);
+                const float* weight_hc_F = weight_hc.row(hidden_size * 1 + q);
+                const float* weight_hc_O = weight_hc.row(hidden_size * 2 + q);
+                const float* weight_hc_G = weight_hc.row(hidden_size * 3 + q);
 
 #if __AVX__
-            float* weight_xc_IFOG = weight_xc_data_packed_dr.row(q / 2 + q % 2);
-            float* weight_hc_IFOG = weight_hc_data_packed_dr.row(q / 2 + q % 2);
+                float* weight_xc_IFOG = weight_xc_data_packed_dr.row(q / 2 + q % 2);
+                float* weight_hc_IFOG = weight_hc_data_packed_dr.row(q / 2 + q % 2);
 #else
-            float* weight_xc_IFOG = weight_xc_data_packed_dr.row(q);
-            float* weight_hc_IFOG = weight_hc_data_packed_dr.row(q);
+                float* weight_xc_IFOG = weight_xc_data_packed_dr.row(q);
+                float* weight_hc_IFOG = weight_hc_data_packed_dr.row(q);
 #endif
 
-            for (int i = 0; i < size; i++)
-            {
-                weight_xc_IFOG[0] = weight_xc_I[i];
-                weight_xc_IFOG[1] = weight_xc_F[i];
-                weight_xc_IFOG[2] = weight_xc_O[i];
-                weight_xc_IFOG[3] = weight_xc_G[i];
+                for (int i = 0; i < size; i++)
+                {
+                    weight_xc_IFOG[0] = weight_xc_I[i];
+                    weight_xc_IFOG[1] = weight_xc_F[i];
+                    weight_xc_IFOG[2] = weight_xc_O[i];
+                    weight_xc_IFOG[3] = weight_xc_G[i];
 
-                weight_xc_IFOG += 4;
-            }
+                    weight_xc_IFOG += 4;
+                }
 
-            for (int i = 0; i < num_output; i++)
-            {
-                weight_hc_IFOG[0] = weight_hc_I[i];
-                weight_hc_IFOG[1] = weight_hc_F[i];
-                weight_hc_IFOG[2] = weight_hc_O[i];
-                weight_hc_IFOG[3] = weight_hc_G[i];
+                for (int i = 0; i < num_output; i++)
+                {
+                    weight_hc_IFOG[0] = weight_hc_I[i];
+                    weight_hc_IFOG[1] = weight_hc_F[i];
+                    weight_hc_IFOG[2] = weight_hc_O[i];
+                    weight_hc_IFOG[3] = weight_hc_G[i];
 
-                weight_hc_IFOG += 4;
+                    weight_hc_IFOG += 4;
+                }
             }
         }
     }
@@ -206,6 +209,19 @@ int LSTM_x86::create_pipeline(const Option& opt)
     return 0;
 }
 
+int LSTM_x86::pipeline_weights(std::vector<Mat*>& weights)
+{
+    weights.push_back(&weight_xc_data_packed);
+    weights.push_back(&bias_c_data_packed);
+    weights.push_back(&weight_hc_data_packed);
+    weights.push_back(&weight_data_tm);
+#if NCNN_INT8
+    weights.push_back(&weight_data_tm_int8_descales);
+#endif
+
+    return 0;
+}
+
 static int lstm(const Mat& bottom_blob, Mat& top_blob, int reverse, const Mat& weight_xc, const Mat& bias_c, const Mat& weight_hc, const Mat& weight_hr, Mat& hidden_state, Mat& cell_state, const Option& opt)
 {
     int size = bottom_blob.w;
@@ -664,7 +680,7 @@ int LSTM_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
     Mat hidden;
     Mat cell;
     Allocator* hidden_cell_allocator = top_blobs.size() == 3 ? opt.blob_allocator : opt.workspace_allocator;
-    if (bottom_blobs.size() == 3)
+    if (bottom_blobs.size() == 3 && !bottom_blobs[1].empty() && !bottom_blobs[2].empty())
     {
         hidden = bottom_blobs[1].clone(hidden_cell_allocator);
         cell = bottom_blobs[2].clone(hidden_cell_allocator);
@@ -749,7 +765,10 @@ int LSTM_x86::create_pipeline_int8(const Option& opt)
     const int num_directions = direction == 2 ? 2 : 1;
     const int size = weight_data_size / num_directions / hidden_size / 4;
 
-    lstm_transform_weight_int8(weight_xc_data, weight_xc_data_int8_scales, weight_hc_data, weight_hc_data_int8_scales, bias_c_data, weight_data_tm, weight_data_tm_int8_descales, bias_c_data_packed, size, num_output, num_directions, hidden_size, opt);
+    if (weight_data_tm.empty())
+    {
+        lstm_transform_weight_int8(weight_xc_data, weight_xc_data_int8_scales, weight_hc_data, weight_hc_data_int8_scales, bias_c_data, weight_data_tm, weight_data_tm_int8_descales, bias_c_data_packed, size, num_output, num_directions, hidden_size, opt);
+    }
 
     if (opt.lightmode)
     {
@@ -871,7 +890,7 @@ int LSTM_x86::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
     Mat hidden;
     Mat cell;
     Allocator* hidden_cell_allocator = top_blobs.size() == 3 ? opt.blob_allocator : opt.workspace_allocator;
-    if (bottom_blobs.size() == 3)
+    if (bottom_blobs.size() == 3 && !bottom_blobs[1].empty() && !bottom_blobs[2].empty())
     {
         hidden = bottom_blobs[1].clone(hidden_cell_allocator);
         cell = bottom_blobs[2].clone(hidden_cell_allocator);
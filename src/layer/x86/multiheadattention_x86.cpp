@@ -16,6 +16,8 @@
 
 #include "layer_type.h"
 
+#include <string.h>
+
 namespace ncnn {
 
 MultiHeadAttention_x86::MultiHeadAttention_x86()
@@ -311,12 +313,60 @@ int MultiHeadAttention_x86::destroy_pipeline(const Option& _opt)
     return 0;
 }
 
+// out = concat(cache, affine) along seqlen, both laid out as (seqlen, embed_dim)
+static int concat_kv_cache(const Mat& cache, const Mat& affine, Mat& out, const Option& opt)
+{
+    if (cache.empty())
+    {
+        out = affine;
+        return 0;
+    }
+
+    Mat cache_unpacked = cache;
+    if (cache.elempack != 1)
+    {
+        convert_packing(cache, cache_unpacked, 1, opt);
+        if (cache_unpacked.empty())
+            return -100;
+    }
+
+    if (cache_unpacked.h != affine.h || cache_unpacked.elemsize != affine.elemsize)
+    {
+        NCNN_LOGE("kv cache shape %d x %d elemsize %d mismatch with %d x %d elemsize %d", cache_unpacked.w, cache_unpacked.h, (int)cache_unpacked.elemsize, affine.w, affine.h, (int)affine.elemsize);
+        return -1;
+    }
+
+    const int past_seqlen = cache_unpacked.w;
+    const int cur_seqlen = affine.w;
+    const size_t elemsize = affine.elemsize;
+
+    out.create(past_seqlen + cur_seqlen, affine.h, elemsize, opt.blob_allocator);
+    if (out.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < affine.h; i++)
+    {
+        unsigned char* outptr = out.row<unsigned char>(i);
+
+        memcpy(outptr, cache_unpacked.row<const unsigned char>(i), past_seqlen * elemsize);
+        memcpy(outptr + past_seqlen * elemsize, affine.row<const unsigned char>(i), cur_seqlen * elemsize);
+    }
+
+    return 0;
+}
+
 int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& _opt) const
 {
+    // the past key and value cache come after the regular inputs
+    const size_t bottom_count = kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (bottom_count == 1 || (bottom_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (bottom_count == 1 || (bottom_count == 2 && attn_mask)) ? q_blob : (bottom_count == 2 || (bottom_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_count - 1] : Mat();
+    const Mat& past_k_blob = kv_cache ? bottom_blobs[bottom_count] : Mat();
+    const Mat& past_v_blob = kv_cache ? bottom_blobs[bottom_count + 1] : Mat();
 
     Option opt = _opt;
     if (int8_scale_term)
@@ -338,7 +388,8 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
 
     const int embed_dim_per_head = embed_dim / num_heads;
     const int src_seqlen = q_blob.h * q_blob.elempack;
-    const int dst_seqlen = k_blob.h * k_blob.elempack;
+    const int past_seqlen = past_k_blob.empty() ? 0 : past_k_blob.w;
+    const int dst_seqlen = past_seqlen + k_blob.h * k_blob.elempack;
 
     Mat q_affine;
     int retq = q_gemm->forward(q_blob, q_affine, opt);
@@ -350,6 +401,16 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retk != 0)
         return retk;
 
+    if (kv_cache)
+    {
+        Mat k_affine_cur = k_affine;
+        retk = concat_kv_cache(past_k_blob, k_affine_cur, k_affine, opt);
+        if (retk != 0)
+            return retk;
+
+        top_blobs[1] = k_affine;
+    }
+
     Mat qk_cross(dst_seqlen, src_seqlen * num_heads, 4u, opt.blob_allocator);
     if (qk_cross.empty())
         return -100;
@@ -391,6 +452,16 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retv != 0)
         return retv;
 
+    if (kv_cache)
+    {
+        Mat v_affine_cur = v_affine;
+        retv = concat_kv_cache(past_v_blob, v_affine_cur, v_affine, opt);
+        if (retv != 0)
+            return retv;
+
+        top_blobs[2] = v_affine;
+    }
+
     Mat qkv_cross(src_seqlen, embed_dim_per_head * num_heads, 4u, opt.blob_allocator);
     if (qkv_cross.empty())
         return -100;
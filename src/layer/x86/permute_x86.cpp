@@ -0,0 +1,279 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "permute_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+
+namespace ncnn {
+
+// output axis w h d c takes the input axis, 0=w 1=h 2=d 3=c
+static const int permute_orders_2d[2][4] = {
+    {0, 1, 2, 3},
+    {1, 0, 2, 3},
+};
+
+static const int permute_orders_3d[6][4] = {
+    {0, 1, 2, 3},
+    {1, 0, 2, 3},
+    {0, 3, 2, 1},
+    {3, 0, 2, 1},
+    {1, 3, 2, 0},
+    {3, 1, 2, 0},
+};
+
+static const int permute_orders_4d[24][4] = {
+    {0, 1, 2, 3},
+    {1, 0, 2, 3},
+    {0, 2, 1, 3},
+    {2, 0, 1, 3},
+    {1, 2, 0, 3},
+    {2, 1, 0, 3},
+    {0, 1, 3, 2},
+    {1, 0, 3, 2},
+    {0, 3, 1, 2},
+    {3, 0, 1, 2},
+    {1, 3, 0, 2},
+    {3, 1, 0, 2},
+    {0, 2, 3, 1},
+    {2, 0, 3, 1},
+    {0, 3, 2, 1},
+    {3, 0, 2, 1},
+    {2, 3, 0, 1},
+    {3, 2, 0, 1},
+    {1, 2, 3, 0},
+    {2, 1, 3, 0},
+    {1, 3, 2, 0},
+    {3, 1, 2, 0},
+    {2, 3, 1, 0},
+    {3, 2, 1, 0},
+};
+
+// dst[j * dst_stride + i] = src[i * src_stride + j]
+static void transpose_tile(const float* src, size_t src_stride, float* dst, size_t dst_stride, int rows, int cols)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+    for (; i + 7 < rows; i += 8)
+    {
+        const float* p0 = src + i * src_stride;
+
+        int j = 0;
+        for (; j + 7 < cols; j += 8)
+        {
+            __m256 _r0 = _mm256_loadu_ps(p0 + j);
+            __m256 _r1 = _mm256_loadu_ps(p0 + src_stride + j);
+            __m256 _r2 = _mm256_loadu_ps(p0 + src_stride * 2 + j);
+            __m256 _r3 = _mm256_loadu_ps(p0 + src_stride * 3 + j);
+            __m256 _r4 = _mm256_loadu_ps(p0 + src_stride * 4 + j);
+            __m256 _r5 = _mm256_loadu_ps(p0 + src_stride * 5 + j);
+            __m256 _r6 = _mm256_loadu_ps(p0 + src_stride * 6 + j);
+            __m256 _r7 = _mm256_loadu_ps(p0 + src_stride * 7 + j);
+
+            transpose8x8_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+
+            float* outptr = dst + j * dst_stride + i;
+            _mm256_storeu_ps(outptr, _r0);
+            _mm256_storeu_ps(outptr + dst_stride, _r1);
+            _mm256_storeu_ps(outptr + dst_stride * 2, _r2);
+            _mm256_storeu_ps(outptr + dst_stride * 3, _r3);
+            _mm256_storeu_ps(outptr + dst_stride * 4, _r4);
+            _mm256_storeu_ps(outptr + dst_stride * 5, _r5);
+            _mm256_storeu_ps(outptr + dst_stride * 6, _r6);
+            _mm256_storeu_ps(outptr + dst_stride * 7, _r7);
+        }
+        for (; j < cols; j++)
+        {
+            float* outptr = dst + j * dst_stride + i;
+            for (int k = 0; k < 8; k++)
+            {
+                outptr[k] = p0[k * src_stride + j];
+            }
+        }
+    }
+#endif // __AVX__
+    for (; i + 3 < rows; i += 4)
+    {
+        const float* p0 = src + i * src_stride;
+
+        int j = 0;
+        for (; j + 3 < cols; j += 4)
+        {
+            __m128 _r0 = _mm_loadu_ps(p0 + j);
+            __m128 _r1 = _mm_loadu_ps(p0 + src_stride + j);
+            __m128 _r2 = _mm_loadu_ps(p0 + src_stride * 2 + j);
+            __m128 _r3 = _mm_loadu_ps(p0 + src_stride * 3 + j);
+
+            _MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+
+            float* outptr = dst + j * dst_stride + i;
+            _mm_storeu_ps(outptr, _r0);
+            _mm_storeu_ps(outptr + dst_stride, _r1);
+            _mm_storeu_ps(outptr + dst_stride * 2, _r2);
+            _mm_storeu_ps(outptr + dst_stride * 3, _r3);
+        }
+        for (; j < cols; j++)
+        {
+            float* outptr = dst + j * dst_stride + i;
+            for (int k = 0; k < 4; k++)
+            {
+                outptr[k] = p0[k * src_stride + j];
+            }
+        }
+    }
+#endif // __SSE2__
+    for (; i < rows; i++)
+    {
+        const float* p0 = src + i * src_stride;
+
+        for (int j = 0; j < cols; j++)
+        {
+            dst[j * dst_stride + i] = p0[j];
+        }
+    }
+}
+
+Permute_x86::Permute_x86()
+{
+}
+
+int Permute_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int dims = bottom_blob.dims;
+
+    if (dims == 1 || order_type == 0)
+    {
+        top_blob = bottom_blob;
+        return 0;
+    }
+
+    if (bottom_blob.elemsize != 4 || bottom_blob.elempack != 1)
+        return Permute::forward(bottom_blob, top_blob, opt);
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int d = bottom_blob.d;
+    const int channels = bottom_blob.c;
+
+    // view every blob as w h d c, 3-dim blob has d = 1
+    const int* order = dims == 2 ? permute_orders_2d[order_type] : dims == 3 ? permute_orders_3d[order_type] : permute_orders_4d[order_type];
+
+    const int sizes[4] = {w, h, dims == 4 ? d : 1, channels};
+    const size_t strides[4] = {1, (size_t)w, (size_t)w * h, bottom_blob.cstep};
+
+    const int outw = sizes[order[0]];
+    const int outh = sizes[order[1]];
+    const int outd = sizes[order[2]];
+    const int outc = sizes[order[3]];
+
+    if (dims == 2)
+        top_blob.create(outw, outh, 4u, opt.blob_allocator);
+    if (dims == 3)
+        top_blob.create(outw, outh, outc, 4u, opt.blob_allocator);
+    if (dims == 4)
+        top_blob.create(outw, outh, outd, outc, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int outsizes[4] = {outw, outh, outd, outc};
+    const size_t outstrides[4] = {1, (size_t)outw, (size_t)outw * outh, top_blob.cstep};
+
+    const float* ptr = bottom_blob;
+    float* outptr = top_blob;
+
+    // the output axis walking along the contiguous input w
+    int kw = 0;
+    while (order[kw] != 0)
+        kw++;
+
+    if (kw == 0)
+    {
+        // output rows are contiguous input rows
+        const int nslice = outh * outd * outc;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int s = 0; s < nslice; s++)
+        {
+            const int y = s % outh;
+            const int z = s / outh % outd;
+            const int q = s / outh / outd;
+
+            const float* p0 = ptr + y * strides[order[1]] + z * strides[order[2]] + q * strides[order[3]];
+            float* outp0 = outptr + y * outstrides[1] + z * outstrides[2] + q * outstrides[3];
+
+            memcpy(outp0, p0, outw * sizeof(float));
+        }
+
+        return 0;
+    }
+
+    // transpose the output w axis against the output axis kw, the other two axes index the slices
+    int ka = 0;
+    int kb = 0;
+    {
+        int others[2];
+        int n = 0;
+        for (int k = 1; k < 4; k++)
+        {
+            if (k != kw)
+                others[n++] = k;
+        }
+        ka = others[0];
+        kb = others[1];
+    }
+
+    const int rows = outw;
+    const int cols = outsizes[kw];
+    const size_t src_stride = strides[order[0]];
+    const size_t dst_stride = outstrides[kw];
+
+    // cache blocking, a tile of rows x cols stays in L1
+    const int TILE = 32;
+    const int nrowtile = (rows + TILE - 1) / TILE;
+    const int nslice = outsizes[ka] * outsizes[kb];
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int t = 0; t < nslice * nrowtile; t++)
+    {
+        const int s = t / nrowtile;
+        const int i = t % nrowtile * TILE;
+
+        const int a = s % outsizes[ka];
+        const int b = s / outsizes[ka];
+
+        const float* p0 = ptr + a * strides[order[ka]] + b * strides[order[kb]];
+        float* outp0 = outptr + a * outstrides[ka] + b * outstrides[kb];
+
+        const int max_ii = std::min(rows - i, TILE);
+
+        for (int j = 0; j < cols; j += TILE)
+        {
+            const int max_jj = std::min(cols - j, TILE);
+
+            transpose_tile(p0 + i * src_stride + j, src_stride, outp0 + j * dst_stride + i, dst_stride, max_ii, max_jj);
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,45 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// units are grouped in blocks of 8 (avx) and 4 (sse2), then single units
+// block b covers units q .. q + n - 1, every packed weight row holds one block
+static NCNN_FORCEINLINE void rnn_block_range(int b, int num_output, int max_block, int& q, int& n)
+{
+    const int nn8 = max_block >= 8 ? num_output / 8 : 0;
+    const int nn4 = max_block >= 4 ? (num_output - nn8 * 8) / 4 : 0;
+
+    if (b < nn8)
+    {
+        q = b * 8;
+        n = 8;
+    }
+    else if (b < nn8 + nn4)
+    {
+        q = nn8 * 8 + (b - nn8) * 4;
+        n = 4;
+    }
+    else
+    {
+        q = nn8 * 8 + nn4 * 4 + (b - nn8 - nn4);
+        n = 1;
+    }
+}
+
+static int rnn_block_count(int num_output, int max_block)
+{
+    const int nn8 = max_block >= 8 ? num_output / 8 : 0;
+    const int nn4 = max_block >= 4 ? (num_output - nn8 * 8) / 4 : 0;
+
+    return nn8 + nn4 + num_output - nn8 * 8 - nn4 * 4;
+}
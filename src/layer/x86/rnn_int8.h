@@ -0,0 +1,415 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// weight_data_tm row layout, one row per 4 units block or per remaining unit
+//   xc part = (size + 1) / 2 k-pairs, hc part = (num_output + 1) / 2 k-pairs
+//   each k-pair holds unit0 k0 k1 unit1 k0 k1 ...
+// odd k is padded with zero so that every k-pair feeds one pmaddwd
+// weight_data_tm_int8_descales holds xc hc for each unit, grouped the same way
+// the layout is the same for every isa, only the kernels are dispatched
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+int rnn_int8_input_projection_avx512vnni(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt);
+int rnn_int8_avx512vnni(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, Mat& hidden_state, const Option& opt);
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVXVNNI && __AVX__ && !__AVX512F__ && !__AVXVNNI__ && !__AVX512VNNI__
+int rnn_int8_input_projection_avxvnni(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt);
+int rnn_int8_avxvnni(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, Mat& hidden_state, const Option& opt);
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__ && !__AVXVNNI__ && !__AVX512VNNI__
+int rnn_int8_input_projection_avx2(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt);
+int rnn_int8_avx2(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, Mat& hidden_state, const Option& opt);
+#endif
+
+static int rnn_int8_max_block()
+{
+#if __SSE2__
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+static void rnn_transform_weight_int8(const Mat& weight_xc, const Mat& weight_xc_int8_scales, const Mat& weight_hc, const Mat& weight_hc_int8_scales, Mat& weight_data_tm, Mat& weight_data_tm_int8_descales, int size, int num_output, int num_directions, const Option& opt)
+{
+    const int size2 = (size + 1) / 2;
+    const int num_output2 = (num_output + 1) / 2;
+
+#if __SSE2__
+    weight_data_tm.create((size2 + num_output2) * 8, num_output / 4 + num_output % 4, num_directions, 1u, 1);
+#else
+    weight_data_tm.create((size2 + num_output2) * 2, num_output, num_directions, 1u, 1);
+#endif
+    weight_data_tm_int8_descales.create(num_output * 2, 1, num_directions);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        const Mat weight_xc_dr = weight_xc.channel(dr);
+        const Mat weight_hc_dr = weight_hc.channel(dr);
+        const float* weight_xc_int8_scales_ptr = weight_xc_int8_scales.row(dr);
+        const float* weight_hc_int8_scales_ptr = weight_hc_int8_scales.row(dr);
+
+        Mat weight_data_tm_dr = weight_data_tm.channel(dr);
+        float* descales_ptr = weight_data_tm_int8_descales.channel(dr);
+
+        int q = 0;
+#if __SSE2__
+        for (; q + 3 < num_output; q += 4)
+        {
+            signed char* kptr = weight_data_tm_dr.row<signed char>(q / 4);
+
+            for (int i = 0; i < size2 * 2; i += 2)
+            {
+                for (int j = 0; j < 4; j++)
+                {
+                    const signed char* wptr = weight_xc_dr.row<const signed char>(q + j);
+                    kptr[0] = wptr[i];
+                    kptr[1] = i + 1 < size ? wptr[i + 1] : 0;
+                    kptr += 2;
+                }
+            }
+
+            for (int i = 0; i < num_output2 * 2; i += 2)
+            {
+                for (int j = 0; j < 4; j++)
+                {
+                    const signed char* wptr = weight_hc_dr.row<const signed char>(q + j);
+                    kptr[0] = wptr[i];
+                    kptr[1] = i + 1 < num_output ? wptr[i + 1] : 0;
+                    kptr += 2;
+                }
+            }
+
+            float* dptr = descales_ptr + q * 2;
+            for (int j = 0; j < 4; j++)
+            {
+                dptr[j] = 1.f / weight_xc_int8_scales_ptr[q + j];
+                dptr[4 + j] = 1.f / weight_hc_int8_scales_ptr[q + j];
+            }
+        }
+#endif // __SSE2__
+        for (; q < num_output; q++)
+        {
+#if __SSE2__
+            signed char* kptr = weight_data_tm_dr.row<signed char>(q / 4 + q % 4);
+#else
+            signed char* kptr = weight_data_tm_dr.row<signed char>(q);
+#endif
+
+            const signed char* weight_xc_ptr = weight_xc_dr.row<const signed char>(q);
+            const signed char* weight_hc_ptr = weight_hc_dr.row<const signed char>(q);
+
+            for (int i = 0; i < size2 * 2; i += 2)
+            {
+                kptr[0] = weight_xc_ptr[i];
+                kptr[1] = i + 1 < size ? weight_xc_ptr[i + 1] : 0;
+                kptr += 2;
+            }
+
+            for (int i = 0; i < num_output2 * 2; i += 2)
+            {
+                kptr[0] = weight_hc_ptr[i];
+                kptr[1] = i + 1 < num_output ? weight_hc_ptr[i + 1] : 0;
+                kptr += 2;
+            }
+
+            descales_ptr[q * 2] = 1.f / weight_xc_int8_scales_ptr[q];
+            descales_ptr[q * 2 + 1] = 1.f / weight_hc_int8_scales_ptr[q];
+        }
+    }
+}
+
+// quantize to int8 and store every two values as one int16 pair
+// return the descale, zero input gives zero pairs
+static float rnn_dynamic_quantize_pairs(const float* ptr, int size, int* outptr)
+{
+    float absmax = 0.f;
+    for (int i = 0; i < size; i++)
+    {
+        absmax = std::max(absmax, (float)fabs(ptr[i]));
+    }
+
+    if (absmax == 0.f)
+    {
+        for (int i = 0; i < (size + 1) / 2; i++)
+        {
+            outptr[i] = 0;
+        }
+        return 1.f;
+    }
+
+    const float scale = 127.f / absmax;
+
+    int i = 0;
+    for (; i + 1 < size; i += 2)
+    {
+        const signed char v0 = float2int8(ptr[i] * scale);
+        const signed char v1 = float2int8(ptr[i + 1] * scale);
+        outptr[i / 2] = (int)(((unsigned int)(unsigned short)(short)v1 << 16) | (unsigned short)(short)v0);
+    }
+    if (i < size)
+    {
+        const signed char v0 = float2int8(ptr[i] * scale);
+        outptr[i / 2] = (unsigned short)(short)v0;
+    }
+
+    return absmax / 127.f;
+}
+
+#if __SSE2__
+static NCNN_FORCEINLINE __m128i rnn_int8_dot_pack4(const signed char* kptr, const int* xptr, int n2)
+{
+    __m128i _sum0 = _mm_setzero_si128();
+    __m128i _sum1 = _mm_setzero_si128();
+
+    int i = 0;
+#if __AVX2__
+    __m256i _sum01 = _mm256_setzero_si256();
+    __m256i _sum23 = _mm256_setzero_si256();
+    for (; i + 3 < n2; i += 4)
+    {
+        __m256i _x01 = _mm256_blend_epi32(_mm256_set1_epi32(xptr[i]), _mm256_set1_epi32(xptr[i + 1]), 0xf0);
+        __m256i _x23 = _mm256_blend_epi32(_mm256_set1_epi32(xptr[i + 2]), _mm256_set1_epi32(xptr[i + 3]), 0xf0);
+
+        __m256i _w01 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)kptr));
+        __m256i _w23 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(kptr + 16)));
+
+        _sum01 = _mm256_comp_dpwssd_epi32(_sum01, _w01, _x01);
+        _sum23 = _mm256_comp_dpwssd_epi32(_sum23, _w23, _x23);
+
+        kptr += 32;
+    }
+    _sum01 = _mm256_add_epi32(_sum01, _sum23);
+    _sum0 = _mm256_castsi256_si128(_sum01);
+    _sum1 = _mm256_extracti128_si256(_sum01, 1);
+#endif // __AVX2__
+    for (; i + 1 < n2; i += 2)
+    {
+        __m128i _w = _mm_loadu_si128((const __m128i*)kptr);
+        __m128i _s = _mm_cmpgt_epi8(_mm_setzero_si128(), _w);
+
+        _sum0 = _mm_comp_dpwssd_epi32(_sum0, _mm_unpacklo_epi8(_w, _s), _mm_set1_epi32(xptr[i]));
+        _sum1 = _mm_comp_dpwssd_epi32(_sum1, _mm_unpackhi_epi8(_w, _s), _mm_set1_epi32(xptr[i + 1]));
+
+        kptr += 16;
+    }
+    for (; i < n2; i++)
+    {
+        __m128i _w = _mm_loadl_epi64((const __m128i*)kptr);
+        _w = _mm_unpacklo_epi8(_w, _mm_cmpgt_epi8(_mm_setzero_si128(), _w));
+
+        _sum0 = _mm_comp_dpwssd_epi32(_sum0, _w, _mm_set1_epi32(xptr[i]));
+
+        kptr += 8;
+    }
+
+    return _mm_add_epi32(_sum0, _sum1);
+}
+#endif // __SSE2__
+
+static NCNN_FORCEINLINE int rnn_int8_dot(const signed char* kptr, const int* xptr, int n2)
+{
+    int sum = 0;
+    for (int i = 0; i < n2; i++)
+    {
+        const short x0 = (short)(xptr[i] & 0xffff);
+        const short x1 = (short)(xptr[i] >> 16);
+
+        sum += kptr[0] * x0 + kptr[1] * x1;
+
+        kptr += 2;
+    }
+
+    return sum;
+}
+
+// gates_x = bias_c + W_xc * x_t for every timestep and every direction
+static int rnn_int8_input_projection(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_data_tm, const Mat& weight_data_tm_int8_descales, const Mat& bias_c, int num_output, const Option& opt)
+{
+#if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        return rnn_int8_input_projection_avx512vnni(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c, num_output, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVXVNNI && __AVX__ && !__AVX512F__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx_vnni())
+    {
+        return rnn_int8_input_projection_avxvnni(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c, num_output, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx2())
+    {
+        return rnn_int8_input_projection_avx2(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c, num_output, opt);
+    }
+#endif
+
+    const int size = bottom_blob.w;
+    const int T = bottom_blob.h;
+    const int num_directions = weight_data_tm.c;
+
+    const int size2 = (size + 1) / 2;
+
+    // dynamic quantize bottom_blob
+    Mat bottom_blob_int8(size2, T, (size_t)4u, opt.workspace_allocator);
+    Mat bottom_blob_int8_descales(T, (size_t)4u, opt.workspace_allocator);
+    if (bottom_blob_int8.empty() || bottom_blob_int8_descales.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int t = 0; t < T; t++)
+    {
+        bottom_blob_int8_descales[t] = rnn_dynamic_quantize_pairs(bottom_blob.row(t), size, bottom_blob_int8.row<int>(t));
+    }
+
+    gates_x.create(num_output, T, num_directions, 4u, opt.workspace_allocator);
+    if (gates_x.empty())
+        return -100;
+
+    const int max_block = rnn_int8_max_block();
+    const int nblocks = rnn_block_count(num_output, max_block);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < num_directions * T * nblocks; ii++)
+    {
+        const int dr = ii / (T * nblocks);
+        const int t = ii % (T * nblocks) / nblocks;
+        const int b = ii % nblocks;
+
+        const Mat weight_data_tm_dr = weight_data_tm.channel(dr);
+        const float* descales_ptr = weight_data_tm_int8_descales.channel(dr);
+        const float* bias_c_ptr = bias_c.channel(dr);
+
+        const int* x = bottom_blob_int8.row<const int>(t);
+        const float descale_x = bottom_blob_int8_descales[t];
+
+        float* gates_x_ptr = gates_x.channel(dr).row(t);
+
+        int q;
+        int n;
+        rnn_block_range(b, num_output, max_block, q, n);
+
+#if __SSE2__
+        if (n == 4)
+        {
+            __m128i _H = rnn_int8_dot_pack4(weight_data_tm_dr.row<const signed char>(b), x, size2);
+
+            __m128 _descale = _mm_mul_ps(_mm_set1_ps(descale_x), _mm_loadu_ps(descales_ptr + q * 2));
+            _mm_storeu_ps(gates_x_ptr + q, _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_H), _descale, _mm_loadu_ps(bias_c_ptr + q)));
+            continue;
+        }
+#endif // __SSE2__
+
+        int H = rnn_int8_dot(weight_data_tm_dr.row<const signed char>(b), x, size2);
+
+        gates_x_ptr[q] = bias_c_ptr[q] + H * (descale_x * descales_ptr[q * 2]);
+    }
+
+    return 0;
+}
+
+static int rnn_int8(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, int size, const Mat& weight_data_tm, const float* descales_ptr, Mat& hidden_state, const Option& opt)
+{
+#if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        return rnn_int8_avx512vnni(gates_x, top_blob, outw_offset, reverse, size, weight_data_tm, descales_ptr, hidden_state, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVXVNNI && __AVX__ && !__AVX512F__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx_vnni())
+    {
+        return rnn_int8_avxvnni(gates_x, top_blob, outw_offset, reverse, size, weight_data_tm, descales_ptr, hidden_state, opt);
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__ && !__AVXVNNI__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx2())
+    {
+        return rnn_int8_avx2(gates_x, top_blob, outw_offset, reverse, size, weight_data_tm, descales_ptr, hidden_state, opt);
+    }
+#endif
+
+    const int T = gates_x.h;
+    const int num_output = hidden_state.w;
+
+    const int size2 = (size + 1) / 2;
+    const int num_output2 = (num_output + 1) / 2;
+
+    Mat gates(num_output, 4u, opt.workspace_allocator);
+    Mat hidden_state_int8(num_output2, (size_t)4u, opt.workspace_allocator);
+    if (gates.empty() || hidden_state_int8.empty())
+        return -100;
+
+    const int max_block = rnn_int8_max_block();
+    const int nblocks = rnn_block_count(num_output, max_block);
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+        // dynamic quantize hidden_state
+        const float descale_h = rnn_dynamic_quantize_pairs(hidden_state, num_output, hidden_state_int8);
+
+        const int* hs = hidden_state_int8;
+        const float* gates_x_ptr = gates_x.row(ti);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int b = 0; b < nblocks; b++)
+        {
+            int q;
+            int n;
+            rnn_block_range(b, num_output, max_block, q, n);
+
+            float* gates_ptr = gates;
+
+#if __SSE2__
+            if (n == 4)
+            {
+                const signed char* kptr = weight_data_tm.row<const signed char>(b) + size2 * 8;
+
+                __m128i _Hh = rnn_int8_dot_pack4(kptr, hs, num_output2);
+
+                __m128 _descale = _mm_mul_ps(_mm_set1_ps(descale_h), _mm_loadu_ps(descales_ptr + q * 2 + 4));
+                __m128 _H = _mm_comp_fmadd_ps(_mm_cvtepi32_ps(_Hh), _descale, _mm_loadu_ps(gates_x_ptr + q));
+
+                _mm_storeu_ps(gates_ptr + q, tanh_sse(_H));
+                continue;
+            }
+#endif // __SSE2__
+
+            const signed char* kptr = weight_data_tm.row<const signed char>(b) + size2 * 2;
+
+            int Hh = rnn_int8_dot(kptr, hs, num_output2);
+
+            float H = gates_x_ptr[q] + Hh * (descale_h * descales_ptr[q * 2 + 1]);
+
+            gates_ptr[q] = tanhf(H);
+        }
+
+        float* output_data = top_blob.row(ti) + outw_offset;
+        memcpy(hidden_state, gates, num_output * sizeof(float));
+        memcpy(output_data, gates, num_output * sizeof(float));
+    }
+
+    return 0;
+}
@@ -0,0 +1,546 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "rnn_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+#include "cpu.h"
+
+namespace ncnn {
+
+#include "rnn_block.h"
+
+static int rnn_max_block()
+{
+#if __AVX__
+    return 8;
+#elif __SSE2__
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+#if NCNN_INT8
+#include "rnn_int8.h"
+#endif
+
+RNN_x86::RNN_x86()
+{
+    one_blob_only = false;
+    support_inplace = false;
+}
+
+int RNN_x86::create_pipeline(const Option& opt)
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        return create_pipeline_int8(opt);
+    }
+#endif
+
+    int num_directions = direction == 2 ? 2 : 1;
+    int size = weight_data_size / num_directions / num_output;
+
+    if (weight_xc_data_packed.empty())
+    {
+        const int max_block = rnn_max_block();
+        const int nblocks = rnn_block_count(num_output, max_block);
+
+        weight_xc_data_packed.create(size * max_block, nblocks, num_directions);
+        weight_hc_data_packed.create(num_output * max_block, nblocks, num_directions);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            const Mat weight_xc = weight_xc_data.channel(dr);
+            const Mat weight_hc = weight_hc_data.channel(dr);
+
+            Mat weight_xc_data_packed_dr = weight_xc_data_packed.channel(dr);
+            Mat weight_hc_data_packed_dr = weight_hc_data_packed.channel(dr);
+
+            for (int b = 0; b < nblocks; b++)
+            {
+                int q;
+                int n;
+                rnn_block_range(b, num_output, max_block, q, n);
+
+                // unit0 unit1 .. for each k
+                float* kptr = weight_xc_data_packed_dr.row(b);
+                float* kptr_hc = weight_hc_data_packed_dr.row(b);
+
+                for (int i = 0; i < size; i++)
+                {
+                    for (int j = 0; j < n; j++)
+                    {
+                        *kptr++ = weight_xc.row(q + j)[i];
+                    }
+                }
+
+                for (int i = 0; i < num_output; i++)
+                {
+                    for (int j = 0; j < n; j++)
+                    {
+                        *kptr_hc++ = weight_hc.row(q + j)[i];
+                    }
+                }
+            }
+        }
+    }
+
+    if (opt.lightmode)
+    {
+        weight_xc_data.release();
+        weight_hc_data.release();
+    }
+
+    return 0;
+}
+
+int RNN_x86::pipeline_weights(std::vector<Mat*>& weights)
+{
+    weights.push_back(&weight_xc_data_packed);
+    weights.push_back(&weight_hc_data_packed);
+#if NCNN_INT8
+    weights.push_back(&weight_data_tm);
+    weights.push_back(&weight_data_tm_int8_descales);
+#endif
+
+    return 0;
+}
+
+// gates_x = bias_c + W_xc * x_t for every timestep and every direction
+// the input projection does not depend on the hidden state, so it runs as one gemm
+// outside the recurrence, four timesteps share each weight load
+static int rnn_input_projection(const Mat& bottom_blob, Mat& gates_x, const Mat& weight_xc, const Mat& bias_c, int num_output, const Option& opt)
+{
+    const int size = bottom_blob.w;
+    const int T = bottom_blob.h;
+    const int num_directions = weight_xc.c;
+
+    gates_x.create(num_output, T, num_directions, 4u, opt.workspace_allocator);
+    if (gates_x.empty())
+        return -100;
+
+    const int max_block = rnn_max_block();
+    const int nblocks = rnn_block_count(num_output, max_block);
+
+    const int nn_T = T / 4;
+    const int ntiles = nn_T + T - nn_T * 4;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < num_directions * ntiles * nblocks; ii++)
+    {
+        const int dr = ii / (ntiles * nblocks);
+        const int tile = ii % (ntiles * nblocks) / nblocks;
+        const int b = ii % nblocks;
+
+        const int t = tile < nn_T ? tile * 4 : nn_T * 4 + tile - nn_T;
+        const int tn = tile < nn_T ? 4 : 1;
+
+        int q;
+        int n;
+        rnn_block_range(b, num_output, max_block, q, n);
+
+        const float* kptr0 = weight_xc.channel(dr).row(b);
+        const float* bias_c_ptr = (const float*)bias_c.channel(dr) + q;
+        Mat gates_x_dr = gates_x.channel(dr);
+
+#if __SSE2__
+#if __AVX__
+        if (n == 8)
+        {
+            __m256 _bias = _mm256_loadu_ps(bias_c_ptr);
+
+            int j = 0;
+            for (; j + 3 < tn; j += 4)
+            {
+                const float* x0 = bottom_blob.row(t + j);
+                const float* x1 = bottom_blob.row(t + j + 1);
+                const float* x2 = bottom_blob.row(t + j + 2);
+                const float* x3 = bottom_blob.row(t + j + 3);
+
+                const float* kptr = kptr0;
+
+                __m256 _H0 = _bias;
+                __m256 _H1 = _bias;
+                __m256 _H2 = _bias;
+                __m256 _H3 = _bias;
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m256 _w = _mm256_loadu_ps(kptr);
+                    _H0 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x0 + i), _H0);
+                    _H1 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x1 + i), _H1);
+                    _H2 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x2 + i), _H2);
+                    _H3 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x3 + i), _H3);
+
+                    kptr += 8;
+                }
+
+                _mm256_storeu_ps(gates_x_dr.row(t + j) + q, _H0);
+                _mm256_storeu_ps(gates_x_dr.row(t + j + 1) + q, _H1);
+                _mm256_storeu_ps(gates_x_dr.row(t + j + 2) + q, _H2);
+                _mm256_storeu_ps(gates_x_dr.row(t + j + 3) + q, _H3);
+            }
+            for (; j < tn; j++)
+            {
+                const float* x = bottom_blob.row(t + j);
+
+                const float* kptr = kptr0;
+
+                __m256 _H = _bias;
+                __m256 _H1 = _mm256_setzero_ps();
+
+                int i = 0;
+                for (; i + 1 < size; i += 2)
+                {
+                    _H = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_broadcast_ss(x + i), _H);
+                    _H1 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _mm256_broadcast_ss(x + i + 1), _H1);
+
+                    kptr += 16;
+                }
+                for (; i < size; i++)
+                {
+                    _H = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_broadcast_ss(x + i), _H);
+
+                    kptr += 8;
+                }
+
+                _mm256_storeu_ps(gates_x_dr.row(t + j) + q, _mm256_add_ps(_H, _H1));
+            }
+            continue;
+        }
+#endif // __AVX__
+        if (n == 4)
+        {
+            __m128 _bias = _mm_loadu_ps(bias_c_ptr);
+
+            int j = 0;
+            for (; j + 3 < tn; j += 4)
+            {
+                const float* x0 = bottom_blob.row(t + j);
+                const float* x1 = bottom_blob.row(t + j + 1);
+                const float* x2 = bottom_blob.row(t + j + 2);
+                const float* x3 = bottom_blob.row(t + j + 3);
+
+                const float* kptr = kptr0;
+
+                __m128 _H0 = _bias;
+                __m128 _H1 = _bias;
+                __m128 _H2 = _bias;
+                __m128 _H3 = _bias;
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m128 _w = _mm_loadu_ps(kptr);
+                    _H0 = _mm_comp_fmadd_ps(_w, _mm_set1_ps(x0[i]), _H0);
+                    _H1 = _mm_comp_fmadd_ps(_w, _mm_set1_ps(x1[i]), _H1);
+                    _H2 = _mm_comp_fmadd_ps(_w, _mm_set1_ps(x2[i]), _H2);
+                    _H3 = _mm_comp_fmadd_ps(_w, _mm_set1_ps(x3[i]), _H3);
+
+                    kptr += 4;
+                }
+
+                _mm_storeu_ps(gates_x_dr.row(t + j) + q, _H0);
+                _mm_storeu_ps(gates_x_dr.row(t + j + 1) + q, _H1);
+                _mm_storeu_ps(gates_x_dr.row(t + j + 2) + q, _H2);
+                _mm_storeu_ps(gates_x_dr.row(t + j + 3) + q, _H3);
+            }
+            for (; j < tn; j++)
+            {
+                const float* x = bottom_blob.row(t + j);
+
+                const float* kptr = kptr0;
+
+                __m128 _H = _bias;
+                __m128 _H1 = _mm_setzero_ps();
+
+                int i = 0;
+                for (; i + 1 < size; i += 2)
+                {
+                    _H = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _mm_set1_ps(x[i]), _H);
+                    _H1 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 4), _mm_set1_ps(x[i + 1]), _H1);
+
+                    kptr += 8;
+                }
+                for (; i < size; i++)
+                {
+                    _H = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _mm_set1_ps(x[i]), _H);
+
+                    kptr += 4;
+                }
+
+                _mm_storeu_ps(gates_x_dr.row(t + j) + q, _mm_add_ps(_H, _H1));
+            }
+            continue;
+        }
+#endif // __SSE2__
+
+        for (int j = 0; j < tn; j++)
+        {
+            const float* x = bottom_blob.row(t + j);
+
+            float H = bias_c_ptr[0];
+
+            for (int i = 0; i < size; i++)
+            {
+                H += kptr0[i] * x[i];
+            }
+
+            gates_x_dr.row(t + j)[q] = H;
+        }
+    }
+
+    return 0;
+}
+
+static int rnn(const Mat& gates_x, Mat& top_blob, int outw_offset, int reverse, const Mat& weight_hc, Mat& hidden_state, const Option& opt)
+{
+    const int T = gates_x.h;
+    const int num_output = hidden_state.w;
+
+    Mat gates(num_output, 4u, opt.workspace_allocator);
+    if (gates.empty())
+        return -100;
+
+    const int max_block = rnn_max_block();
+    const int nblocks = rnn_block_count(num_output, max_block);
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+        const float* gates_x_ptr = gates_x.row(ti);
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int b = 0; b < nblocks; b++)
+        {
+            int q;
+            int n;
+            rnn_block_range(b, num_output, max_block, q, n);
+
+            const float* kptr = weight_hc.row(b);
+            const float* hidden_ptr = hidden_state;
+
+            float* gates_ptr = gates;
+
+#if __SSE2__
+#if __AVX__
+            if (n == 8)
+            {
+                __m256 _H = _mm256_loadu_ps(gates_x_ptr + q);
+                __m256 _H1 = _mm256_setzero_ps();
+
+                int i = 0;
+                for (; i + 1 < num_output; i += 2)
+                {
+                    _H = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_broadcast_ss(hidden_ptr + i), _H);
+                    _H1 = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr + 8), _mm256_broadcast_ss(hidden_ptr + i + 1), _H1);
+
+                    kptr += 16;
+                }
+                for (; i < num_output; i++)
+                {
+                    _H = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_broadcast_ss(hidden_ptr + i), _H);
+
+                    kptr += 8;
+                }
+
+                _mm256_storeu_ps(gates_ptr + q, tanh_avx(_mm256_add_ps(_H, _H1)));
+                continue;
+            }
+#endif // __AVX__
+            if (n == 4)
+            {
+                __m128 _H = _mm_loadu_ps(gates_x_ptr + q);
+                __m128 _H1 = _mm_setzero_ps();
+
+                int i = 0;
+                for (; i + 1 < num_output; i += 2)
+                {
+                    _H = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _mm_set1_ps(hidden_ptr[i]), _H);
+                    _H1 = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr + 4), _mm_set1_ps(hidden_ptr[i + 1]), _H1);
+
+                    kptr += 8;
+                }
+                for (; i < num_output; i++)
+                {
+                    _H = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _mm_set1_ps(hidden_ptr[i]), _H);
+
+                    kptr += 4;
+                }
+
+                _mm_storeu_ps(gates_ptr + q, tanh_sse(_mm_add_ps(_H, _H1)));
+                continue;
+            }
+#endif // __SSE2__
+
+            float H = gates_x_ptr[q];
+
+            for (int i = 0; i < num_output; i++)
+            {
+                H += kptr[i] * hidden_ptr[i];
+            }
+
+            gates_ptr[q] = tanhf(H);
+        }
+
+        float* output_data = top_blob.row(ti) + outw_offset;
+        memcpy(hidden_state, gates, num_output * sizeof(float));
+        memcpy(output_data, gates, num_output * sizeof(float));
+    }
+
+    return 0;
+}
+
+int RNN_x86::forward_directions(const Mat& bottom_blob, Mat& top_blob, Mat& hidden, const Option& opt) const
+{
+    const int num_directions = direction == 2 ? 2 : 1;
+
+    Mat gates_x;
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        int ret = rnn_int8_input_projection(bottom_blob, gates_x, weight_data_tm, weight_data_tm_int8_descales, bias_c_data, num_output, opt);
+        if (ret != 0)
+            return ret;
+    }
+    else
+#endif
+    {
+        int ret = rnn_input_projection(bottom_blob, gates_x, weight_xc_data_packed, bias_c_data, num_output, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    // each direction writes its own half of the output row, no concat needed
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        const int reverse = direction == 2 ? dr : direction;
+
+        Mat hidden_dr = hidden.row_range(dr, 1);
+
+#if NCNN_INT8
+        if (int8_scale_term)
+        {
+            int ret = rnn_int8(gates_x.channel(dr), top_blob, num_output * dr, reverse, bottom_blob.w, weight_data_tm.channel(dr), weight_data_tm_int8_descales.channel(dr), hidden_dr, opt);
+            if (ret != 0)
+                return ret;
+        }
+        else
+#endif
+        {
+            int ret = rnn(gates_x.channel(dr), top_blob, num_output * dr, reverse, weight_hc_data_packed.channel(dr), hidden_dr, opt);
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+int RNN_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int T = bottom_blob.h;
+
+    int num_directions = direction == 2 ? 2 : 1;
+
+    // initial hidden state
+    Mat hidden(num_output, num_directions, 4u, opt.workspace_allocator);
+    if (hidden.empty())
+        return -100;
+    hidden.fill(0.f);
+
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return forward_directions(bottom_blob, top_blob, hidden, opt);
+}
+
+int RNN_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    int T = bottom_blob.h;
+    int num_directions = direction == 2 ? 2 : 1;
+
+    Mat hidden;
+    Allocator* hidden_allocator = top_blobs.size() == 2 ? opt.blob_allocator : opt.workspace_allocator;
+    if (bottom_blobs.size() == 2 && !bottom_blobs[1].empty())
+    {
+        hidden = bottom_blobs[1].clone(hidden_allocator);
+    }
+    else
+    {
+        hidden.create(num_output, num_directions, 4u, hidden_allocator);
+        if (hidden.empty())
+            return -100;
+        hidden.fill(0.f);
+    }
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int ret = forward_directions(bottom_blob, top_blob, hidden, opt);
+    if (ret != 0)
+        return ret;
+
+    if (top_blobs.size() == 2)
+    {
+        top_blobs[1] = hidden;
+    }
+
+    return 0;
+}
+
+#if NCNN_INT8
+int RNN_x86::create_pipeline_int8(const Option& opt)
+{
+    const int num_directions = direction == 2 ? 2 : 1;
+    const int size = weight_data_size / num_directions / num_output;
+
+    if (weight_data_tm.empty())
+    {
+        rnn_transform_weight_int8(weight_xc_data, weight_xc_data_int8_scales, weight_hc_data, weight_hc_data_int8_scales, weight_data_tm, weight_data_tm_int8_descales, size, num_output, num_directions, opt);
+    }
+
+    if (opt.lightmode)
+    {
+        weight_xc_data.release();
+        weight_hc_data.release();
+        weight_xc_data_int8_scales.release();
+        weight_hc_data_int8_scales.release();
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
+} // namespace ncnn
@@ -46,6 +46,15 @@ static NCNN_FORCEINLINE __m128 swish_sse(__m128 inputs)
     return _mm_mul_ps(inputs, sigmoid_sse(inputs));
 }
 
+static NCNN_FORCEINLINE __m128 gelu_sse(__m128 inputs)
+{
+    // y = 0.5x * (1 + tanh(sqrt(2/Pi) * (x + 0.044715x^3)))
+    __m128 cube = _mm_mul_ps(_mm_mul_ps(inputs, inputs), inputs);
+    __m128 t = _mm_mul_ps(_mm_comp_fmadd_ps(cube, _mm_set1_ps(0.044715f), inputs), _mm_set1_ps(0.79788452f));
+    t = _mm_add_ps(tanh_ps(t), _mm_set1_ps(1.f));
+    return _mm_mul_ps(_mm_mul_ps(inputs, _mm_set1_ps(0.5f)), t);
+}
+
 static NCNN_FORCEINLINE __m128 hardswish_sse(__m128 inputs, __m128 a, __m128 b)
 {
     const __m128 one = _mm_set1_ps(1.0f);
@@ -114,6 +123,14 @@ static NCNN_FORCEINLINE __m128 activation_sse(__m128 _v, int activation_type, co
         __m128 _b = _mm_set1_ps(activation_params[1]);
         return hardswish_sse(_v, _a, _b);
     }
+    case 7:
+    {
+        return gelu_sse(_v);
+    }
+    case 8:
+    {
+        return swish_sse(_v);
+    }
     }
 
     return _v;
@@ -150,6 +167,14 @@ static NCNN_FORCEINLINE __m256 swish_avx(__m256 inputs)
     return _mm256_mul_ps(inputs, sigmoid_avx(inputs));
 }
 
+static NCNN_FORCEINLINE __m256 gelu_avx(__m256 inputs)
+{
+    __m256 cube = _mm256_mul_ps(_mm256_mul_ps(inputs, inputs), inputs);
+    __m256 t = _mm256_mul_ps(_mm256_comp_fmadd_ps(cube, _mm256_set1_ps(0.044715f), inputs), _mm256_set1_ps(0.79788452f));
+    t = _mm256_add_ps(tanh256_ps(t), _mm256_set1_ps(1.f));
+    return _mm256_mul_ps(_mm256_mul_ps(inputs, _mm256_set1_ps(0.5f)), t);
+}
+
 static NCNN_FORCEINLINE __m256 hardswish_avx(__m256 inputs, __m256 a, __m256 b)
 {
     const __m256 one = _mm256_set1_ps(1.0f);
@@ -218,6 +243,14 @@ static NCNN_FORCEINLINE __m256 activation_avx(__m256 _v, int activation_type, co
         __m256 _b = _mm256_set1_ps(activation_params[1]);
         return hardswish_avx(_v, _a, _b);
     }
+    case 7:
+    {
+        return gelu_avx(_v);
+    }
+    case 8:
+    {
+        return swish_avx(_v);
+    }
     }
 
     return _v;
@@ -249,6 +282,14 @@ static NCNN_FORCEINLINE __m512 swish_avx512(__m512 inputs)
     return _mm512_mul_ps(inputs, sigmoid_avx512(inputs));
 }
 
+static NCNN_FORCEINLINE __m512 gelu_avx512(__m512 inputs)
+{
+    __m512 cube = _mm512_mul_ps(_mm512_mul_ps(inputs, inputs), inputs);
+    __m512 t = _mm512_mul_ps(_mm512_fmadd_ps(cube, _mm512_set1_ps(0.044715f), inputs), _mm512_set1_ps(0.79788452f));
+    t = _mm512_add_ps(tanh512_ps(t), _mm512_set1_ps(1.f));
+    return _mm512_mul_ps(_mm512_mul_ps(inputs, _mm512_set1_ps(0.5f)), t);
+}
+
 static NCNN_FORCEINLINE __m512 hardswish_avx512(__m512 inputs, __m512 a, __m512 b)
 {
     const __m512 one = _mm512_set1_ps(1.0f);
@@ -316,6 +357,14 @@ static NCNN_FORCEINLINE __m512 activation_avx512(__m512 _v, int activation_type,
         __m512 _b = _mm512_set1_ps(activation_params[1]);
         return hardswish_avx512(_v, _a, _b);
     }
+    case 7:
+    {
+        return gelu_avx512(_v);
+    }
+    case 8:
+    {
+        return swish_avx512(_v);
+    }
     }
 
     return _v;
@@ -157,9 +157,7 @@ int Yolov3DetectionOutput_x86::forward(const std::vector<Mat>& bottom_blobs, std
                         float bbox_xmax = bbox_cx + bbox_w * 0.5f;
                         float bbox_ymax = bbox_cy + bbox_h * 0.5f;
 
-                        float area = bbox_w * bbox_h;
-
-                        BBoxRect c = {confidence, bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, area, class_index};
+                        BBoxRect c = {confidence, bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, class_index};
                         all_box_bbox_rects[pp].push_back(c);
                     }
 
@@ -181,47 +179,7 @@ int Yolov3DetectionOutput_x86::forward(const std::vector<Mat>& bottom_blobs, std
         }
     }
 
-    // global sort inplace
-    qsort_descent_inplace(all_bbox_rects);
-
-    // apply nms
-    std::vector<size_t> picked;
-    nms_sorted_bboxes(all_bbox_rects, picked, nms_threshold);
-
-    // select
-    std::vector<BBoxRect> bbox_rects;
-
-    for (size_t i = 0; i < picked.size(); i++)
-    {
-        size_t z = picked[i];
-        bbox_rects.push_back(all_bbox_rects[z]);
-    }
-
-    // fill result
-    int num_detected = static_cast<int>(bbox_rects.size());
-    if (num_detected == 0)
-        return 0;
-
-    Mat& top_blob = top_blobs[0];
-    top_blob.create(6, num_detected, 4u, opt.blob_allocator);
-    if (top_blob.empty())
-        return -100;
-
-    for (int i = 0; i < num_detected; i++)
-    {
-        const BBoxRect& r = bbox_rects[i];
-        float score = r.score;
-        float* outptr = top_blob.row(i);
-
-        outptr[0] = r.label + 1.0f; // +1 for prepend background class
-        outptr[1] = score;
-        outptr[2] = r.xmin;
-        outptr[3] = r.ymin;
-        outptr[4] = r.xmax;
-        outptr[5] = r.ymax;
-    }
-
-    return 0;
+    return select_detections(all_bbox_rects, top_blobs[0], opt);
 }
 
 } // namespace ncnn
@@ -15,6 +15,7 @@
 #include "yolodetectionoutput.h"
 
 #include "layer_type.h"
+#include "nms.h"
 
 namespace ncnn {
 
@@ -63,110 +64,6 @@ int YoloDetectionOutput::destroy_pipeline(const Option& opt)
     return 0;
 }
 
-struct BBoxRect
-{
-    float xmin;
-    float ymin;
-    float xmax;
-    float ymax;
-    int label;
-};
-
-static inline float intersection_area(const BBoxRect& a, const BBoxRect& b)
-{
-    if (a.xmin > b.xmax || a.xmax < b.xmin || a.ymin > b.ymax || a.ymax < b.ymin)
-    {
-        // no intersection
-        return 0.f;
-    }
-
-    float inter_width = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
-    float inter_height = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
-
-    return inter_width * inter_height;
-}
-
-template<typename T>
-static void qsort_descent_inplace(std::vector<T>& datas, std::vector<float>& scores, int left, int right)
-{
-    int i = left;
-    int j = right;
-    float p = scores[(left + right) / 2];
-
-    while (i <= j)
-    {
-        while (scores[i] > p)
-            i++;
-
-        while (scores[j] < p)
-            j--;
-
-        if (i <= j)
-        {
-            // swap
-            std::swap(datas[i], datas[j]);
-            std::swap(scores[i], scores[j]);
-
-            i++;
-            j--;
-        }
-    }
-
-    if (left < j)
-        qsort_descent_inplace(datas, scores, left, j);
-
-    if (i < right)
-        qsort_descent_inplace(datas, scores, i, right);
-}
-
-template<typename T>
-static void qsort_descent_inplace(std::vector<T>& datas, std::vector<float>& scores)
-{
-    if (datas.empty() || scores.empty())
-        return;
-
-    qsort_descent_inplace(datas, scores, 0, static_cast<int>(scores.size() - 1));
-}
-
-static void nms_sorted_bboxes(const std::vector<BBoxRect>& bboxes, std::vector<size_t>& picked, float nms_threshold)
-{
-    picked.clear();
-
-    const size_t n = bboxes.size();
-
-    std::vector<float> areas(n);
-    for (size_t i = 0; i < n; i++)
-    {
-        const BBoxRect& r = bboxes[i];
-
-        float width = r.xmax - r.xmin;
-        float height = r.ymax - r.ymin;
-
-        areas[i] = width * height;
-    }
-
-    for (size_t i = 0; i < n; i++)
-    {
-        const BBoxRect& a = bboxes[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            const BBoxRect& b = bboxes[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            //             float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
-        }
-
-        if (keep)
-            picked.push_back(i);
-    }
-}
-
 static inline float sigmoid(float x)
 {
     return 1.f / (1.f + expf(-x));
@@ -175,7 +72,8 @@ static inline float sigmoid(float x)
 int YoloDetectionOutput::forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const
 {
     // gather all box
-    std::vector<BBoxRect> all_bbox_rects;
+    std::vector<float> all_bbox_rects;
+    std::vector<int> all_bbox_labels;
     std::vector<float> all_bbox_scores;
 
     for (size_t b = 0; b < bottom_top_blobs.size(); b++)
@@ -192,9 +90,11 @@ int YoloDetectionOutput::forward_inplace(std::vector<Mat>& bottom_top_blobs, con
         if (channels_per_box != 4 + 1 + num_class)
             return -1;
 
-        std::vector<std::vector<BBoxRect> > all_box_bbox_rects;
+        std::vector<std::vector<float> > all_box_bbox_rects;
+        std::vector<std::vector<int> > all_box_bbox_labels;
         std::vector<std::vector<float> > all_box_bbox_scores;
         all_box_bbox_rects.resize(num_box);
+        all_box_bbox_labels.resize(num_box);
         all_box_bbox_scores.resize(num_box);
 
         std::vector<int> softmax_rets;
@@ -255,8 +155,12 @@ int YoloDetectionOutput::forward_inplace(std::vector<Mat>& bottom_top_blobs, con
                     float confidence = box_score * class_score;
                     if (confidence >= confidence_threshold)
                     {
-                        BBoxRect c = {bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, class_index};
-                        all_box_bbox_rects[pp].push_back(c);
+                        std::vector<float>& box_bbox_rects = all_box_bbox_rects[pp];
+                        box_bbox_rects.push_back(bbox_xmin);
+                        box_bbox_rects.push_back(bbox_ymin);
+                        box_bbox_rects.push_back(bbox_xmax);
+                        box_bbox_rects.push_back(bbox_ymax);
+                        all_box_bbox_labels[pp].push_back(class_index);
                         all_box_bbox_scores[pp].push_back(confidence);
                     }
 
@@ -275,36 +179,30 @@ int YoloDetectionOutput::forward_inplace(std::vector<Mat>& bottom_top_blobs, con
             if (softmax_rets[i] != 0)
                 return softmax_rets[i];
 
-            const std::vector<BBoxRect>& box_bbox_rects = all_box_bbox_rects[i];
+            const std::vector<float>& box_bbox_rects = all_box_bbox_rects[i];
+            const std::vector<int>& box_bbox_labels = all_box_bbox_labels[i];
             const std::vector<float>& box_bbox_scores = all_box_bbox_scores[i];
 
             all_bbox_rects.insert(all_bbox_rects.end(), box_bbox_rects.begin(), box_bbox_rects.end());
+            all_bbox_labels.insert(all_bbox_labels.end(), box_bbox_labels.begin(), box_bbox_labels.end());
             all_bbox_scores.insert(all_bbox_scores.end(), box_bbox_scores.begin(), box_bbox_scores.end());
         }
     }
 
-    // global sort inplace
-    qsort_descent_inplace(all_bbox_rects, all_bbox_scores);
-
-    // apply nms
-    std::vector<size_t> picked;
-    nms_sorted_bboxes(all_bbox_rects, picked, nms_threshold);
+    int num_bbox = static_cast<int>(all_bbox_scores.size());
+    if (num_bbox == 0)
+        return 0;
 
-    // select
-    std::vector<BBoxRect> bbox_rects;
-    std::vector<float> bbox_scores;
+    // global sort
+    std::vector<int> order;
+    topk_descent(&all_bbox_scores[0], num_bbox, -1, order);
 
-    for (size_t i = 0; i < picked.size(); i++)
-    {
-        size_t z = picked[i];
-        bbox_rects.push_back(all_bbox_rects[z]);
-        bbox_scores.push_back(all_bbox_scores[z]);
-    }
+    // apply nms
+    std::vector<int> picked;
+    nms_sorted_bboxes(&all_bbox_rects[0], &order[0], num_bbox, nms_threshold, picked);
 
     // fill result
-    int num_detected = static_cast<int>(bbox_rects.size());
-    if (num_detected == 0)
-        return 0;
+    int num_detected = static_cast<int>(picked.size());
 
     Mat& top_blob = bottom_top_blobs[0];
     top_blob.create(6, num_detected, 4u, opt.blob_allocator);
@@ -313,16 +211,16 @@ int YoloDetectionOutput::forward_inplace(std::vector<Mat>& bottom_top_blobs, con
 
     for (int i = 0; i < num_detected; i++)
     {
-        const BBoxRect& r = bbox_rects[i];
-        float score = bbox_scores[i];
+        const int z = picked[i];
+        const float* r = &all_bbox_rects[z * 4];
         float* outptr = top_blob.row(i);
 
-        outptr[0] = r.label + 1.0f; // +1 for prepend background class
-        outptr[1] = score;
-        outptr[2] = r.xmin;
-        outptr[3] = r.ymin;
-        outptr[4] = r.xmax;
-        outptr[5] = r.ymax;
+        outptr[0] = all_bbox_labels[z] + 1.0f; // +1 for prepend background class
+        outptr[1] = all_bbox_scores[z];
+        outptr[2] = r[0];
+        outptr[3] = r[1];
+        outptr[4] = r[2];
+        outptr[5] = r[3];
     }
 
     return 0;
@@ -15,6 +15,7 @@
 #include "yolov3detectionoutput.h"
 
 #include "layer_type.h"
+#include "nms.h"
 
 #include <float.h>
 
@@ -51,90 +52,6 @@ int Yolov3DetectionOutput::load_param(const ParamDict& pd)
     return 0;
 }
 
-static inline float intersection_area(const Yolov3DetectionOutput::BBoxRect& a, const Yolov3DetectionOutput::BBoxRect& b)
-{
-    if (a.xmin > b.xmax || a.xmax < b.xmin || a.ymin > b.ymax || a.ymax < b.ymin)
-    {
-        // no intersection
-        return 0.f;
-    }
-
-    float inter_width = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
-    float inter_height = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
-
-    return inter_width * inter_height;
-}
-
-void Yolov3DetectionOutput::qsort_descent_inplace(std::vector<BBoxRect>& datas, int left, int right) const
-{
-    int i = left;
-    int j = right;
-    float p = datas[(left + right) / 2].score;
-
-    while (i <= j)
-    {
-        while (datas[i].score > p)
-            i++;
-
-        while (datas[j].score < p)
-            j--;
-
-        if (i <= j)
-        {
-            // swap
-            std::swap(datas[i], datas[j]);
-
-            i++;
-            j--;
-        }
-    }
-
-    if (left < j)
-        qsort_descent_inplace(datas, left, j);
-
-    if (i < right)
-        qsort_descent_inplace(datas, i, right);
-}
-
-void Yolov3DetectionOutput::qsort_descent_inplace(std::vector<BBoxRect>& datas) const
-{
-    if (datas.empty())
-        return;
-
-    qsort_descent_inplace(datas, 0, static_cast<int>(datas.size() - 1));
-}
-
-void Yolov3DetectionOutput::nms_sorted_bboxes(std::vector<BBoxRect>& bboxes, std::vector<size_t>& picked, float nms_threshold) const
-{
-    picked.clear();
-
-    const size_t n = bboxes.size();
-
-    for (size_t i = 0; i < n; i++)
-    {
-        const BBoxRect& a = bboxes[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            const BBoxRect& b = bboxes[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = a.area + b.area - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area > nms_threshold * union_area)
-            {
-                keep = 0;
-                break;
-            }
-        }
-
-        if (keep)
-            picked.push_back(i);
-    }
-}
-
 static inline float sigmoid(float x)
 {
     return 1.f / (1.f + expf(-x));
@@ -218,9 +135,7 @@ int Yolov3DetectionOutput::forward(const std::vector<Mat>& bottom_blobs, std::ve
                         float bbox_xmax = bbox_cx + bbox_w * 0.5f;
                         float bbox_ymax = bbox_cy + bbox_h * 0.5f;
 
-                        float area = bbox_w * bbox_h;
-
-                        BBoxRect c = {confidence, bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, area, class_index};
+                        BBoxRect c = {confidence, bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, class_index};
                         all_box_bbox_rects[pp].push_back(c);
                     }
 
@@ -242,40 +157,50 @@ int Yolov3DetectionOutput::forward(const std::vector<Mat>& bottom_blobs, std::ve
         }
     }
 
-    // global sort inplace
-    qsort_descent_inplace(all_bbox_rects);
-
-    // apply nms
-    std::vector<size_t> picked;
-    nms_sorted_bboxes(all_bbox_rects, picked, nms_threshold);
+    return select_detections(all_bbox_rects, top_blobs[0], opt);
+}
 
-    // select
-    std::vector<BBoxRect> bbox_rects;
+int Yolov3DetectionOutput::select_detections(const std::vector<BBoxRect>& all_bbox_rects, Mat& top_blob, const Option& opt) const
+{
+    const int num_bbox = (int)all_bbox_rects.size();
+    if (num_bbox == 0)
+        return 0;
 
-    for (size_t i = 0; i < picked.size(); i++)
+    std::vector<float> scores(num_bbox);
+    std::vector<float> boxes(num_bbox * 4);
+    for (int i = 0; i < num_bbox; i++)
     {
-        size_t z = picked[i];
-        bbox_rects.push_back(all_bbox_rects[z]);
+        const BBoxRect& r = all_bbox_rects[i];
+
+        scores[i] = r.score;
+        boxes[i * 4] = r.xmin;
+        boxes[i * 4 + 1] = r.ymin;
+        boxes[i * 4 + 2] = r.xmax;
+        boxes[i * 4 + 3] = r.ymax;
     }
 
+    // global sort
+    std::vector<int> order;
+    topk_descent(&scores[0], num_bbox, -1, order);
+
+    // apply nms
+    std::vector<int> picked;
+    nms_sorted_bboxes(&boxes[0], &order[0], num_bbox, nms_threshold, picked);
+
     // fill result
-    int num_detected = static_cast<int>(bbox_rects.size());
-    if (num_detected == 0)
-        return 0;
+    int num_detected = static_cast<int>(picked.size());
 
-    Mat& top_blob = top_blobs[0];
     top_blob.create(6, num_detected, 4u, opt.blob_allocator);
     if (top_blob.empty())
         return -100;
 
     for (int i = 0; i < num_detected; i++)
     {
-        const BBoxRect& r = bbox_rects[i];
-        float score = r.score;
+        const BBoxRect& r = all_bbox_rects[picked[i]];
         float* outptr = top_blob.row(i);
 
         outptr[0] = r.label + 1.0f; // +1 for prepend background class
-        outptr[1] = score;
+        outptr[1] = r.score;
         outptr[2] = r.xmin;
         outptr[3] = r.ymin;
         outptr[4] = r.xmax;
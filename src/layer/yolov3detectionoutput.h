@@ -48,13 +48,11 @@ public:
         float ymin;
         float xmax;
         float ymax;
-        float area;
         int label;
     };
 
-    void qsort_descent_inplace(std::vector<BBoxRect>& datas, int left, int right) const;
-    void qsort_descent_inplace(std::vector<BBoxRect>& datas) const;
-    void nms_sorted_bboxes(std::vector<BBoxRect>& bboxes, std::vector<size_t>& picked, float nms_threshold) const;
+    // sort by score, apply nms and write the detections to top_blob
+    int select_detections(const std::vector<BBoxRect>& all_bbox_rects, Mat& top_blob, const Option& opt) const;
 };
 
 } // namespace ncnn
@@ -238,6 +238,8 @@ public:
         PIXEL_GRAY = 3,
         PIXEL_RGBA = 4,
         PIXEL_BGRA = 5,
+        PIXEL_NV21 = 6, // yuv420sp with interleaved vu
+        PIXEL_NV12 = 7, // yuv420sp with interleaved uv
 
         PIXEL_RGB2BGR = PIXEL_RGB | (PIXEL_BGR << PIXEL_CONVERT_SHIFT),
         PIXEL_RGB2GRAY = PIXEL_RGB | (PIXEL_GRAY << PIXEL_CONVERT_SHIFT),
@@ -263,6 +265,14 @@ public:
         PIXEL_BGRA2BGR = PIXEL_BGRA | (PIXEL_BGR << PIXEL_CONVERT_SHIFT),
         PIXEL_BGRA2GRAY = PIXEL_BGRA | (PIXEL_GRAY << PIXEL_CONVERT_SHIFT),
         PIXEL_BGRA2RGBA = PIXEL_BGRA | (PIXEL_RGBA << PIXEL_CONVERT_SHIFT),
+
+        PIXEL_NV212RGB = PIXEL_NV21 | (PIXEL_RGB << PIXEL_CONVERT_SHIFT),
+        PIXEL_NV212BGR = PIXEL_NV21 | (PIXEL_BGR << PIXEL_CONVERT_SHIFT),
+        PIXEL_NV212GRAY = PIXEL_NV21 | (PIXEL_GRAY << PIXEL_CONVERT_SHIFT),
+
+        PIXEL_NV122RGB = PIXEL_NV12 | (PIXEL_RGB << PIXEL_CONVERT_SHIFT),
+        PIXEL_NV122BGR = PIXEL_NV12 | (PIXEL_BGR << PIXEL_CONVERT_SHIFT),
+        PIXEL_NV122GRAY = PIXEL_NV12 | (PIXEL_GRAY << PIXEL_CONVERT_SHIFT),
     };
     // convenient construct from pixel data
     static Mat from_pixels(const unsigned char* pixels, int type, int w, int h, Allocator* allocator = 0);
@@ -290,6 +300,13 @@ public:
     // convenient export to pixel data and resize to specific size with stride(bytes-per-row) parameter
     void to_pixels_resize(unsigned char* pixels, int type, int target_width, int target_height, int target_stride) const;
 
+    // convenient construct from pixel data, resize to specific size, substract mean and normalize in one pass
+    // the blob is written with elempack, and elembits 32 for fp32, 16 for fp16, 8 for int8 with the quantize scale folded into norm_vals
+    // yuv420sp types PIXEL_NV21 / PIXEL_NV12 are accepted here only, with stride(bytes-per-row) of the luma plane followed by the chroma plane
+    static Mat from_pixels_resize_normalize(const unsigned char* pixels, int type, int w, int h, int stride, int target_width, int target_height, const float* mean_vals, const float* norm_vals, int elempack = 1, int elembits = 32, const Option& opt = Option());
+    // convenient construct from pixel data roi, resize to specific size, substract mean and normalize in one pass
+    static Mat from_pixels_roi_resize_normalize(const unsigned char* pixels, int type, int w, int h, int stride, int roix, int roiy, int roiw, int roih, int target_width, int target_height, const float* mean_vals, const float* norm_vals, int elempack = 1, int elembits = 32, const Option& opt = Option());
+
 #if NCNN_PLATFORM_API
 #if __ANDROID_API__ >= 9
     // convenient construct from android Bitmap
@@ -632,8 +649,33 @@ NCNN_EXPORT void resize_bilinear_c1(const unsigned char* src, int srcw, int srch
 NCNN_EXPORT void resize_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride);
 NCNN_EXPORT void resize_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride);
 NCNN_EXPORT void resize_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride);
+// image pixel bilinear resize with stride(bytes-per-row) parameter, output rows are split among opt.num_threads
+NCNN_EXPORT void resize_bilinear_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt);
+NCNN_EXPORT void resize_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt);
+NCNN_EXPORT void resize_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt);
+NCNN_EXPORT void resize_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt);
 // image pixel bilinear resize, convenient wrapper for yuv420sp(nv21/nv12)
 NCNN_EXPORT void resize_bilinear_yuv420sp(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h);
+// image pixel area resize, averages the covered source pixels for large downscales and falls back to bilinear when enlarging
+NCNN_EXPORT void resize_area_c1(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+NCNN_EXPORT void resize_area_c2(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+NCNN_EXPORT void resize_area_c3(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+NCNN_EXPORT void resize_area_c4(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+// image pixel area resize with stride(bytes-per-row) parameter
+NCNN_EXPORT void resize_area_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
+NCNN_EXPORT void resize_area_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
+NCNN_EXPORT void resize_area_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
+NCNN_EXPORT void resize_area_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
+// image pixel bicubic resize
+NCNN_EXPORT void resize_bicubic_c1(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+NCNN_EXPORT void resize_bicubic_c2(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+NCNN_EXPORT void resize_bicubic_c3(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+NCNN_EXPORT void resize_bicubic_c4(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt = Option());
+// image pixel bicubic resize with stride(bytes-per-row) parameter
+NCNN_EXPORT void resize_bicubic_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
+NCNN_EXPORT void resize_bicubic_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
+NCNN_EXPORT void resize_bicubic_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
+NCNN_EXPORT void resize_bicubic_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt = Option());
 #endif // NCNN_PIXEL
 #if NCNN_PIXEL_ROTATE
 // type is the from type, 6 means rotating from 6 to 1
@@ -677,6 +719,11 @@ NCNN_EXPORT void warpaffine_bilinear_c1(const unsigned char* src, int srcw, int
 NCNN_EXPORT void warpaffine_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type = 0, unsigned int v = 0);
 NCNN_EXPORT void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type = 0, unsigned int v = 0);
 NCNN_EXPORT void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type = 0, unsigned int v = 0);
+// image pixel bilinear warpaffine inverse transform with stride(bytes-per-row) parameter, output rows are split among opt.num_threads
+NCNN_EXPORT void warpaffine_bilinear_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt);
+NCNN_EXPORT void warpaffine_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt);
+NCNN_EXPORT void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt);
+NCNN_EXPORT void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt);
 // image pixel bilinear warpaffine, convenient wrapper for yuv420sp(nv21/nv12), set -233 for transparent border color, the color YUV_ is little-endian encoded
 NCNN_EXPORT void warpaffine_bilinear_yuv420sp(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const float* tm, int type = 0, unsigned int v = 0);
 #endif // NCNN_PIXEL_AFFINE
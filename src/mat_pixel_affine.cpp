@@ -17,8 +17,10 @@
 #include <arm_neon.h>
 #endif // __ARM_NEON
 #include <limits.h>
+#include <string.h>
 
 #include "platform.h"
+#include "cpu.h"
 
 namespace ncnn {
 
@@ -151,6 +153,11 @@ void invert_affine_transform(const float* tm, float* tm_inv)
     tm_inv[5] = b2;
 }
 
+#if NCNN_AVX2 && (__AVX2__ || (NCNN_RUNTIME_CPU && __SSE2__))
+void warpaffine_bilinear_inside_c3_avx2(const unsigned char* src0, int srcstride, int X0, int Y0, const int* adelta, const int* bdelta, unsigned char* dst0);
+void warpaffine_bilinear_inside_c4_avx2(const unsigned char* src0, int srcstride, int X0, int Y0, const int* adelta, const int* bdelta, unsigned char* dst0);
+#endif
+
 void warpaffine_bilinear_c1(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const float* tm, int type, unsigned int v)
 {
     return warpaffine_bilinear_c1(src, srcw, srch, srcw, dst, w, h, w, tm, type, v);
@@ -172,12 +179,42 @@ void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, unsign
 }
 
 void warpaffine_bilinear_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return warpaffine_bilinear_c1(src, srcw, srch, srcstride, dst, w, h, stride, tm, type, v, opt);
+}
+
+void warpaffine_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return warpaffine_bilinear_c2(src, srcw, srch, srcstride, dst, w, h, stride, tm, type, v, opt);
+}
+
+void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return warpaffine_bilinear_c3(src, srcw, srch, srcstride, dst, w, h, stride, tm, type, v, opt);
+}
+
+void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return warpaffine_bilinear_c4(src, srcw, srch, srcstride, dst, w, h, stride, tm, type, v, opt);
+}
+
+void warpaffine_bilinear_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt)
 {
     const unsigned char* border_color = (const unsigned char*)&v;
-    const int wgap = stride - w;
 
     const unsigned char* src0 = src;
-    unsigned char* dst0 = dst;
 
 #define SATURATE_CAST_SHORT(X) (short)::std::min(::std::max((int)(X), SHRT_MIN), SHRT_MAX)
 #define SATURATE_CAST_INT(X)   (int)::std::min(::std::max((int)((X) + ((X) >= 0.f ? 0.5f : -0.5f)), INT_MIN), INT_MAX)
@@ -190,9 +227,11 @@ void warpaffine_bilinear_c1(const unsigned char* src, int srcw, int srch, int sr
         bdelta[x] = SATURATE_CAST_INT(tm[3] * x * (1 << 10));
     }
 
-    int y = 0;
-    for (; y < h; y++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int y = 0; y < h; y++)
     {
+        unsigned char* dst0 = dst + stride * y;
+
         int X0 = SATURATE_CAST_INT((tm[1] * y + tm[2]) * (1 << 10));
         int Y0 = SATURATE_CAST_INT((tm[4] * y + tm[5]) * (1 << 10));
 
@@ -468,21 +507,17 @@ void warpaffine_bilinear_c1(const unsigned char* src, int srcw, int srch, int sr
 
             dst0 += 1;
         }
-
-        dst0 += wgap;
     }
 
 #undef SATURATE_CAST_SHORT
 #undef SATURATE_CAST_INT
 }
 
-void warpaffine_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v)
+void warpaffine_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt)
 {
     const unsigned char* border_color = (const unsigned char*)&v;
-    const int wgap = stride - w * 2;
 
     const unsigned char* src0 = src;
-    unsigned char* dst0 = dst;
 
 #define SATURATE_CAST_SHORT(X) (short)::std::min(::std::max((int)(X), SHRT_MIN), SHRT_MAX)
 #define SATURATE_CAST_INT(X)   (int)::std::min(::std::max((int)((X) + ((X) >= 0.f ? 0.5f : -0.5f)), INT_MIN), INT_MAX)
@@ -495,9 +530,11 @@ void warpaffine_bilinear_c2(const unsigned char* src, int srcw, int srch, int sr
         bdelta[x] = SATURATE_CAST_INT(tm[3] * x * (1 << 10));
     }
 
-    int y = 0;
-    for (; y < h; y++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int y = 0; y < h; y++)
     {
+        unsigned char* dst0 = dst + stride * y;
+
         int X0 = SATURATE_CAST_INT((tm[1] * y + tm[2]) * (1 << 10));
         int Y0 = SATURATE_CAST_INT((tm[4] * y + tm[5]) * (1 << 10));
 
@@ -795,21 +832,17 @@ void warpaffine_bilinear_c2(const unsigned char* src, int srcw, int srch, int sr
 
             dst0 += 2;
         }
-
-        dst0 += wgap;
     }
 
 #undef SATURATE_CAST_SHORT
 #undef SATURATE_CAST_INT
 }
 
-void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v)
+void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt)
 {
     const unsigned char* border_color = (const unsigned char*)&v;
-    const int wgap = stride - w * 3;
 
     const unsigned char* src0 = src;
-    unsigned char* dst0 = dst;
 
 #define SATURATE_CAST_SHORT(X) (short)::std::min(::std::max((int)(X), SHRT_MIN), SHRT_MAX)
 #define SATURATE_CAST_INT(X)   (int)::std::min(::std::max((int)((X) + ((X) >= 0.f ? 0.5f : -0.5f)), INT_MIN), INT_MAX)
@@ -822,9 +855,11 @@ void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int sr
         bdelta[x] = SATURATE_CAST_INT(tm[3] * x * (1 << 10));
     }
 
-    int y = 0;
-    for (; y < h; y++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int y = 0; y < h; y++)
     {
+        unsigned char* dst0 = dst + stride * y;
+
         int X0 = SATURATE_CAST_INT((tm[1] * y + tm[2]) * (1 << 10));
         int Y0 = SATURATE_CAST_INT((tm[4] * y + tm[5]) * (1 << 10));
 
@@ -976,8 +1011,21 @@ void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int sr
 
                 vst3_u8(dst0, _dst);
 
+                dst0 += 3 * 8;
+#elif NCNN_AVX2 && __AVX2__
+                warpaffine_bilinear_inside_c3_avx2(src0, srcstride, X0, Y0, adelta.data() + x, bdelta.data() + x, dst0);
+
                 dst0 += 3 * 8;
 #else
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __SSE2__
+                if (ncnn::cpu_support_x86_avx2())
+                {
+                    warpaffine_bilinear_inside_c3_avx2(src0, srcstride, X0, Y0, adelta.data() + x, bdelta.data() + x, dst0);
+
+                    dst0 += 3 * 8;
+                }
+                else
+#endif
                 for (int xi = 0; xi < 8; xi++)
                 {
                     int X = X0 + adelta[x + xi];
@@ -1162,21 +1210,17 @@ void warpaffine_bilinear_c3(const unsigned char* src, int srcw, int srch, int sr
 
             dst0 += 3;
         }
-
-        dst0 += wgap;
     }
 
 #undef SATURATE_CAST_SHORT
 #undef SATURATE_CAST_INT
 }
 
-void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v)
+void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const float* tm, int type, unsigned int v, const Option& opt)
 {
     const unsigned char* border_color = (const unsigned char*)&v;
-    const int wgap = stride - w * 4;
 
     const unsigned char* src0 = src;
-    unsigned char* dst0 = dst;
 
 #define SATURATE_CAST_SHORT(X) (short)::std::min(::std::max((int)(X), SHRT_MIN), SHRT_MAX)
 #define SATURATE_CAST_INT(X)   (int)::std::min(::std::max((int)((X) + ((X) >= 0.f ? 0.5f : -0.5f)), INT_MIN), INT_MAX)
@@ -1189,9 +1233,11 @@ void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int sr
         bdelta[x] = SATURATE_CAST_INT(tm[3] * x * (1 << 10));
     }
 
-    int y = 0;
-    for (; y < h; y++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int y = 0; y < h; y++)
     {
+        unsigned char* dst0 = dst + stride * y;
+
         int X0 = SATURATE_CAST_INT((tm[1] * y + tm[2]) * (1 << 10));
         int Y0 = SATURATE_CAST_INT((tm[4] * y + tm[5]) * (1 << 10));
 
@@ -1378,8 +1424,21 @@ void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int sr
 
                 vst4_u8(dst0, _dst);
 
+                dst0 += 4 * 8;
+#elif NCNN_AVX2 && __AVX2__
+                warpaffine_bilinear_inside_c4_avx2(src0, srcstride, X0, Y0, adelta.data() + x, bdelta.data() + x, dst0);
+
                 dst0 += 4 * 8;
 #else
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __SSE2__
+                if (ncnn::cpu_support_x86_avx2())
+                {
+                    warpaffine_bilinear_inside_c4_avx2(src0, srcstride, X0, Y0, adelta.data() + x, bdelta.data() + x, dst0);
+
+                    dst0 += 4 * 8;
+                }
+                else
+#endif
                 for (int xi = 0; xi < 8; xi++)
                 {
                     int X = X0 + adelta[x + xi];
@@ -1571,8 +1630,6 @@ void warpaffine_bilinear_c4(const unsigned char* src, int srcw, int srch, int sr
 
             dst0 += 4;
         }
-
-        dst0 += wgap;
     }
 
 #undef SATURATE_CAST_SHORT
@@ -0,0 +1,109 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "platform.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+namespace ncnn {
+
+#if NCNN_PIXEL_AFFINE
+// eight pixels of one row with all taps inside, each tap pair is gathered as 32bit words
+template<int cn>
+static void warpaffine_bilinear_inside_avx2(const unsigned char* src0, int srcstride, int X0, int Y0, const int* adelta, const int* bdelta, unsigned char* dst0)
+{
+    __m256i _X = _mm256_add_epi32(_mm256_set1_epi32(X0), _mm256_loadu_si256((const __m256i*)adelta));
+    __m256i _Y = _mm256_add_epi32(_mm256_set1_epi32(Y0), _mm256_loadu_si256((const __m256i*)bdelta));
+
+    __m256i _sx = _mm256_srai_epi32(_X, 10);
+    __m256i _sy = _mm256_srai_epi32(_Y, 10);
+
+    __m256i _v1024 = _mm256_set1_epi32(1 << 10);
+    __m256i _v1024m1 = _mm256_set1_epi32((1 << 10) - 1);
+    __m256i _fx = _mm256_and_si256(_X, _v1024m1);
+    __m256i _fy = _mm256_and_si256(_Y, _v1024m1);
+
+    // alpha0 alpha1 and beta0 beta1 as int16 pairs for madd
+    __m256i _alpha = _mm256_or_si256(_mm256_sub_epi32(_v1024, _fx), _mm256_slli_epi32(_fx, 16));
+    __m256i _beta = _mm256_or_si256(_mm256_sub_epi32(_v1024, _fy), _mm256_slli_epi32(_fy, 16));
+
+    __m256i _a0ofs = _mm256_add_epi32(_mm256_mullo_epi32(_sy, _mm256_set1_epi32(srcstride)), _mm256_mullo_epi32(_sx, _mm256_set1_epi32(cn)));
+    __m256i _b0ofs = _mm256_add_epi32(_a0ofs, _mm256_set1_epi32(srcstride));
+
+    // the right tap of c3 is loaded one byte early so that the last column never reads past the row
+    const int a1ofs = cn == 3 ? 2 : cn;
+
+    __m256i _a0 = _mm256_i32gather_epi32((const int*)src0, _a0ofs, 1);
+    __m256i _a1 = _mm256_i32gather_epi32((const int*)(src0 + a1ofs), _a0ofs, 1);
+    __m256i _b0 = _mm256_i32gather_epi32((const int*)src0, _b0ofs, 1);
+    __m256i _b1 = _mm256_i32gather_epi32((const int*)(src0 + a1ofs), _b0ofs, 1);
+    if (cn == 3)
+    {
+        _a1 = _mm256_srli_epi32(_a1, 8);
+        _b1 = _mm256_srli_epi32(_b1, 8);
+    }
+
+    __m256i _vff = _mm256_set1_epi32(0xff);
+    __m256i _dst = _mm256_setzero_si256();
+    for (int k = 0; k < cn; k++)
+    {
+        __m256i _a = _mm256_or_si256(_mm256_and_si256(_a0, _vff), _mm256_slli_epi32(_mm256_and_si256(_a1, _vff), 16));
+        __m256i _b = _mm256_or_si256(_mm256_and_si256(_b0, _vff), _mm256_slli_epi32(_mm256_and_si256(_b1, _vff), 16));
+
+        __m256i _t = _mm256_srli_epi32(_mm256_madd_epi16(_a, _alpha), 5);
+        __m256i _u = _mm256_srli_epi32(_mm256_madd_epi16(_b, _alpha), 5);
+        __m256i _d = _mm256_srli_epi32(_mm256_madd_epi16(_mm256_or_si256(_t, _mm256_slli_epi32(_u, 16)), _beta), 15);
+
+        _dst = _mm256_or_si256(_dst, _mm256_sll_epi32(_d, _mm_cvtsi32_si128(k * 8)));
+
+        _a0 = _mm256_srli_epi32(_a0, 8);
+        _a1 = _mm256_srli_epi32(_a1, 8);
+        _b0 = _mm256_srli_epi32(_b0, 8);
+        _b1 = _mm256_srli_epi32(_b1, 8);
+    }
+
+    if (cn == 4)
+    {
+        _mm256_storeu_si256((__m256i*)dst0, _dst);
+    }
+    if (cn == 3)
+    {
+        // drop the 4th byte of each pixel, 12 bytes per lane
+        __m256i _mask = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        _dst = _mm256_shuffle_epi8(_dst, _mask);
+
+        __m128i _dst0 = _mm256_castsi256_si128(_dst);
+        __m128i _dst1 = _mm256_extracti128_si256(_dst, 1);
+        int tail0 = _mm_cvtsi128_si32(_mm_srli_si128(_dst0, 8));
+        int tail1 = _mm_cvtsi128_si32(_mm_srli_si128(_dst1, 8));
+        _mm_storel_epi64((__m128i*)dst0, _dst0);
+        memcpy(dst0 + 8, &tail0, 4);
+        _mm_storel_epi64((__m128i*)(dst0 + 12), _dst1);
+        memcpy(dst0 + 20, &tail1, 4);
+    }
+}
+
+void warpaffine_bilinear_inside_c3_avx2(const unsigned char* src0, int srcstride, int X0, int Y0, const int* adelta, const int* bdelta, unsigned char* dst0)
+{
+    warpaffine_bilinear_inside_avx2<3>(src0, srcstride, X0, Y0, adelta, bdelta, dst0);
+}
+
+void warpaffine_bilinear_inside_c4_avx2(const unsigned char* src0, int srcstride, int X0, int Y0, const int* adelta, const int* bdelta, unsigned char* dst0)
+{
+    warpaffine_bilinear_inside_avx2<4>(src0, srcstride, X0, Y0, adelta, bdelta, dst0);
+}
+#endif // NCNN_PIXEL_AFFINE
+
+} // namespace ncnn
@@ -0,0 +1,635 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "mat.h"
+
+#include <math.h>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif // __ARM_NEON
+#include "platform.h"
+#include "cpu.h"
+
+#include <vector>
+
+namespace ncnn {
+
+#if NCNN_PIXEL
+#if NCNN_AVX2 && (__AVX2__ || (NCNN_RUNTIME_CPU && __SSE2__))
+int hresize_row_avx2(const unsigned char* S, const int* xofs, const int* ialpha, int w, int wvec, int cn, float* const* rows);
+#endif
+
+// one output channel as a weighted sum of the sampled source planes
+struct pixel_channel_expr
+{
+    int count;
+    int plane[3];
+    float coef[3];
+    float bias;
+
+    // clamp to [0, 255] before normalize, for yuv to rgb
+    int clamp;
+
+    // the normalize applied after clamp, otherwise folded into coef and bias
+    float scale;
+    float shift;
+};
+
+static int get_pixel_planes(int type_from)
+{
+    if (type_from == Mat::PIXEL_GRAY)
+        return 1;
+    if (type_from == Mat::PIXEL_RGB || type_from == Mat::PIXEL_BGR || type_from == Mat::PIXEL_NV21 || type_from == Mat::PIXEL_NV12)
+        return 3;
+    if (type_from == Mat::PIXEL_RGBA || type_from == Mat::PIXEL_BGRA)
+        return 4;
+
+    return 0;
+}
+
+// color 0 1 2 3 for r g b a
+// yuv420sp planes are y and the two chroma bytes in memory order
+static void resolve_source_color(int type_from, int color, pixel_channel_expr& e)
+{
+    e.count = 0;
+    e.plane[0] = 0;
+    e.bias = 0.f;
+    e.clamp = 0;
+
+    if (color == 3 && type_from != Mat::PIXEL_RGBA && type_from != Mat::PIXEL_BGRA)
+    {
+        // opaque alpha
+        e.bias = 255.f;
+        return;
+    }
+
+    if (type_from == Mat::PIXEL_GRAY)
+    {
+        e.count = 1;
+        e.plane[0] = 0;
+        e.coef[0] = 1.f;
+    }
+    else if (type_from == Mat::PIXEL_RGB || type_from == Mat::PIXEL_RGBA)
+    {
+        e.count = 1;
+        e.plane[0] = color;
+        e.coef[0] = 1.f;
+    }
+    else if (type_from == Mat::PIXEL_BGR || type_from == Mat::PIXEL_BGRA)
+    {
+        e.count = 1;
+        e.plane[0] = color == 3 ? 3 : 2 - color;
+        e.coef[0] = 1.f;
+    }
+    else // if (type_from == Mat::PIXEL_NV21 || type_from == Mat::PIXEL_NV12)
+    {
+        // the coeffs of yuv420sp2rgb
+        // R = Y + 90/64 * (V-128)
+        // G = Y - 46/64 * (V-128) - 22/64 * (U-128)
+        // B = Y + 113/64 * (U-128)
+        const int v = type_from == Mat::PIXEL_NV21 ? 1 : 2;
+        const int u = type_from == Mat::PIXEL_NV21 ? 2 : 1;
+
+        e.clamp = 1;
+        e.plane[0] = 0;
+        e.coef[0] = 1.f;
+        if (color == 0)
+        {
+            e.count = 2;
+            e.plane[1] = v;
+            e.coef[1] = 90 / 64.f;
+        }
+        if (color == 1)
+        {
+            e.count = 3;
+            e.plane[1] = v;
+            e.coef[1] = -46 / 64.f;
+            e.plane[2] = u;
+            e.coef[2] = -22 / 64.f;
+        }
+        if (color == 2)
+        {
+            e.count = 2;
+            e.plane[1] = u;
+            e.coef[1] = 113 / 64.f;
+        }
+
+        for (int i = 1; i < e.count; i++)
+        {
+            e.bias -= 128 * e.coef[i];
+        }
+    }
+}
+
+// return the output channel count, 0 for unknown convert type
+static int resolve_channel_exprs(int type_from, int type_to, pixel_channel_expr* exprs)
+{
+    static const int colors_rgb[4] = {0, 1, 2, 3};
+    static const int colors_bgr[4] = {2, 1, 0, 3};
+
+    if (type_to == Mat::PIXEL_GRAY)
+    {
+        pixel_channel_expr& e = exprs[0];
+
+        if (type_from == Mat::PIXEL_GRAY || type_from == Mat::PIXEL_NV21 || type_from == Mat::PIXEL_NV12)
+        {
+            // gray is the luma plane as is
+            e.count = 1;
+            e.plane[0] = 0;
+            e.coef[0] = 1.f;
+            e.bias = 0.f;
+            e.clamp = 0;
+            return 1;
+        }
+
+        // coeffs for r g b = 0.299f, 0.587f, 0.114f
+        static const float rgb2y[3] = {77 / 256.f, 150 / 256.f, 29 / 256.f};
+
+        e.count = 3;
+        e.bias = 0.f;
+        e.clamp = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            pixel_channel_expr ei;
+            resolve_source_color(type_from, i, ei);
+            e.plane[i] = ei.plane[0];
+            e.coef[i] = rgb2y[i];
+        }
+        return 1;
+    }
+
+    const int* colors = 0;
+    int channels = 0;
+    if (type_to == Mat::PIXEL_RGB || type_to == Mat::PIXEL_RGBA)
+        colors = colors_rgb;
+    if (type_to == Mat::PIXEL_BGR || type_to == Mat::PIXEL_BGRA)
+        colors = colors_bgr;
+    if (type_to == Mat::PIXEL_RGB || type_to == Mat::PIXEL_BGR)
+        channels = 3;
+    if (type_to == Mat::PIXEL_RGBA || type_to == Mat::PIXEL_BGRA)
+        channels = 4;
+
+    if (!colors)
+        return 0;
+
+    for (int q = 0; q < channels; q++)
+    {
+        resolve_source_color(type_from, colors[q], exprs[q]);
+    }
+
+    return channels;
+}
+
+// bilinear positions along one axis, the same as resize_bilinear_c*
+// ofs holds the dstsize first taps followed by the dstsize second taps
+static void resolve_bilinear_coords(int srcsize, int dstsize, int* ofs, float* alpha)
+{
+    const double scale = (double)srcsize / dstsize;
+
+    for (int i = 0; i < dstsize; i++)
+    {
+        float f = (float)((i + 0.5) * scale - 0.5);
+        int s = static_cast<int>(floor(f));
+        f -= s;
+
+        if (s < 0)
+        {
+            s = 0;
+            f = 0.f;
+        }
+        if (s >= srcsize - 1)
+        {
+            s = std::max(srcsize - 2, 0);
+            f = srcsize > 1 ? 1.f : 0.f;
+        }
+
+        ofs[i] = s;
+        ofs[dstsize + i] = std::min(s + 1, srcsize - 1);
+        alpha[i] = f;
+    }
+}
+
+#define INTER_RESIZE_COEF_BITS  11
+#define INTER_RESIZE_COEF_SCALE (1 << INTER_RESIZE_COEF_BITS)
+
+// horizontal pass of one source row, cn interleaved planes to planar rows in INTER_RESIZE_COEF_SCALE units
+// ialpha packs the two tap weights as 16 bit pairs
+// the first wvec outputs may read 4 bytes at every tap
+template<int cn>
+static void hresize_row(const unsigned char* S, const int* xofs, const int* ialpha, int w, int wvec, float* const* rows)
+{
+    const int* xofs0 = xofs;
+    const int* xofs1 = xofs + w;
+
+    float* r[cn];
+    for (int k = 0; k < cn; k++)
+    {
+        r[k] = rows[k];
+    }
+
+    int dx = 0;
+#if NCNN_AVX2 && __AVX2__
+    dx = hresize_row_avx2(S, xofs, ialpha, w, wvec, cn, rows);
+#elif NCNN_RUNTIME_CPU && NCNN_AVX2 && __SSE2__
+    if (ncnn::cpu_support_x86_avx2())
+    {
+        dx = hresize_row_avx2(S, xofs, ialpha, w, wvec, cn, rows);
+    }
+#else
+    (void)wvec;
+#endif
+    for (; dx < w; dx++)
+    {
+        const unsigned char* S0 = S + xofs0[dx];
+        const unsigned char* S1 = S + xofs1[dx];
+        const int a0 = ialpha[dx] & 0xffff;
+        const int a1 = ialpha[dx] >> 16;
+
+        // load all before storing, the float rows may alias the pixels as far as the compiler knows
+        int v[cn];
+        for (int k = 0; k < cn; k++)
+        {
+            v[k] = S0[k] * a0 + S1[k] * a1;
+        }
+        for (int k = 0; k < cn; k++)
+        {
+            r[k][dx] = (float)v[k];
+        }
+    }
+}
+
+// make top and bot hold the horizontal pass of source rows sy0 and sy1
+// consecutive output rows mostly share source rows, which are reused by swapping
+template<int cn>
+static void prepare_rows(const unsigned char* base, size_t stride, int sy0, int sy1, const int* xofs, const int* ialpha, int w, int wvec, float** top, float** bot, int& top_y, int& bot_y)
+{
+    if (sy0 == top_y && sy1 == bot_y)
+        return;
+
+    if (sy0 == bot_y)
+    {
+        for (int k = 0; k < cn; k++)
+        {
+            std::swap(top[k], bot[k]);
+        }
+    }
+    else
+    {
+        hresize_row<cn>(base + stride * sy0, xofs, ialpha, w, wvec, top);
+    }
+
+    if (sy1 == sy0)
+    {
+        for (int k = 0; k < cn; k++)
+        {
+            memcpy(bot[k], top[k], w * sizeof(float));
+        }
+    }
+    else
+    {
+        hresize_row<cn>(base + stride * sy1, xofs, ialpha, w, wvec, bot);
+    }
+
+    top_y = sy0;
+    bot_y = sy1;
+}
+
+// evaluate one output channel with the vertical pass over the top and bot rows, normalized
+static void eval_channel_expr(const pixel_channel_expr& e, const float* const* top, const float* const* bot, float beta, int w, float* outptr)
+{
+    // up to three terms, unused ones read the first plane with zero weight
+    const float* t0 = top[e.plane[0]];
+    const float* t1 = e.count > 1 ? top[e.plane[1]] : t0;
+    const float* t2 = e.count > 2 ? top[e.plane[2]] : t0;
+    const float* b0 = bot[e.plane[0]];
+    const float* b1 = e.count > 1 ? bot[e.plane[1]] : b0;
+    const float* b2 = e.count > 2 ? bot[e.plane[2]] : b0;
+
+    const float wt = (1.f - beta) / INTER_RESIZE_COEF_SCALE;
+    const float wb = beta / INTER_RESIZE_COEF_SCALE;
+    const float ct0 = e.count > 0 ? e.coef[0] * wt : 0.f;
+    const float ct1 = e.count > 1 ? e.coef[1] * wt : 0.f;
+    const float ct2 = e.count > 2 ? e.coef[2] * wt : 0.f;
+    const float cb0 = e.count > 0 ? e.coef[0] * wb : 0.f;
+    const float cb1 = e.count > 1 ? e.coef[1] * wb : 0.f;
+    const float cb2 = e.count > 2 ? e.coef[2] * wb : 0.f;
+
+    int dx = 0;
+#if __SSE2__
+    {
+        __m128 _ct0 = _mm_set1_ps(ct0);
+        __m128 _ct1 = _mm_set1_ps(ct1);
+        __m128 _ct2 = _mm_set1_ps(ct2);
+        __m128 _cb0 = _mm_set1_ps(cb0);
+        __m128 _cb1 = _mm_set1_ps(cb1);
+        __m128 _cb2 = _mm_set1_ps(cb2);
+        __m128 _bias = _mm_set1_ps(e.bias);
+        __m128 _scale = _mm_set1_ps(e.scale);
+        __m128 _shift = _mm_set1_ps(e.shift);
+        __m128 _zero = _mm_setzero_ps();
+        __m128 _v255 = _mm_set1_ps(255.f);
+        for (; dx + 3 < w; dx += 4)
+        {
+            __m128 _t = _mm_add_ps(_bias, _mm_mul_ps(_mm_loadu_ps(t0 + dx), _ct0));
+            _t = _mm_add_ps(_t, _mm_mul_ps(_mm_loadu_ps(b0 + dx), _cb0));
+            if (e.count > 1)
+            {
+                _t = _mm_add_ps(_t, _mm_mul_ps(_mm_loadu_ps(t1 + dx), _ct1));
+                _t = _mm_add_ps(_t, _mm_mul_ps(_mm_loadu_ps(b1 + dx), _cb1));
+            }
+            if (e.count > 2)
+            {
+                _t = _mm_add_ps(_t, _mm_mul_ps(_mm_loadu_ps(t2 + dx), _ct2));
+                _t = _mm_add_ps(_t, _mm_mul_ps(_mm_loadu_ps(b2 + dx), _cb2));
+            }
+            if (e.clamp)
+            {
+                _t = _mm_min_ps(_mm_max_ps(_t, _zero), _v255);
+                _t = _mm_add_ps(_mm_mul_ps(_t, _scale), _shift);
+            }
+            _mm_storeu_ps(outptr + dx, _t);
+        }
+    }
+#endif // __SSE2__
+#if __ARM_NEON
+    {
+        float32x4_t _bias = vdupq_n_f32(e.bias);
+        float32x4_t _scale = vdupq_n_f32(e.scale);
+        float32x4_t _shift = vdupq_n_f32(e.shift);
+        float32x4_t _zero = vdupq_n_f32(0.f);
+        float32x4_t _v255 = vdupq_n_f32(255.f);
+        for (; dx + 3 < w; dx += 4)
+        {
+            float32x4_t _t = vmlaq_n_f32(_bias, vld1q_f32(t0 + dx), ct0);
+            _t = vmlaq_n_f32(_t, vld1q_f32(b0 + dx), cb0);
+            if (e.count > 1)
+            {
+                _t = vmlaq_n_f32(_t, vld1q_f32(t1 + dx), ct1);
+                _t = vmlaq_n_f32(_t, vld1q_f32(b1 + dx), cb1);
+            }
+            if (e.count > 2)
+            {
+                _t = vmlaq_n_f32(_t, vld1q_f32(t2 + dx), ct2);
+                _t = vmlaq_n_f32(_t, vld1q_f32(b2 + dx), cb2);
+            }
+            if (e.clamp)
+            {
+                _t = vminq_f32(vmaxq_f32(_t, _zero), _v255);
+                _t = vmlaq_f32(_shift, _t, _scale);
+            }
+            vst1q_f32(outptr + dx, _t);
+        }
+    }
+#endif // __ARM_NEON
+    for (; dx < w; dx++)
+    {
+        float t = e.bias + t0[dx] * ct0 + b0[dx] * cb0 + t1[dx] * ct1 + b1[dx] * cb1 + t2[dx] * ct2 + b2[dx] * cb2;
+        if (e.clamp)
+        {
+            t = std::min(std::max(t, 0.f), 255.f);
+            t = t * e.scale + e.shift;
+        }
+        outptr[dx] = t;
+    }
+}
+
+static inline signed char float2int8(float v)
+{
+    int int32 = static_cast<int>(round(v));
+    if (int32 > 127) return 127;
+    if (int32 < -127) return -127;
+    return (signed char)int32;
+}
+
+// store one normalized channel row to the lane of the packed blob row
+static void store_channel_row(const float* ptr, int w, void* outptr, int elempack, int elembits)
+{
+    if (elembits == 32)
+    {
+        float* p = (float*)outptr;
+        for (int dx = 0; dx < w; dx++)
+        {
+            p[dx * elempack] = ptr[dx];
+        }
+    }
+    if (elembits == 16)
+    {
+        unsigned short* p = (unsigned short*)outptr;
+        int dx = 0;
+#if __F16C__
+        if (elempack == 1)
+        {
+            for (; dx + 7 < w; dx += 8)
+            {
+                _mm_storeu_si128((__m128i*)(p + dx), _mm256_cvtps_ph(_mm256_loadu_ps(ptr + dx), _MM_ROUND_NEAREST | _MM_FROUND_NO_EXC));
+            }
+        }
+#endif // __F16C__
+        for (; dx < w; dx++)
+        {
+            p[dx * elempack] = float32_to_float16(ptr[dx]);
+        }
+    }
+    if (elembits == 8)
+    {
+        signed char* p = (signed char*)outptr;
+        for (int dx = 0; dx < w; dx++)
+        {
+            p[dx * elempack] = float2int8(ptr[dx]);
+        }
+    }
+}
+
+Mat Mat::from_pixels_resize_normalize(const unsigned char* pixels, int type, int w, int h, int stride, int target_width, int target_height, const float* mean_vals, const float* norm_vals, int elempack, int elembits, const Option& opt)
+{
+    return Mat::from_pixels_roi_resize_normalize(pixels, type, w, h, stride, 0, 0, w, h, target_width, target_height, mean_vals, norm_vals, elempack, elembits, opt);
+}
+
+Mat Mat::from_pixels_roi_resize_normalize(const unsigned char* pixels, int type, int w, int h, int stride, int roix, int roiy, int roiw, int roih, int target_width, int target_height, const float* mean_vals, const float* norm_vals, int elempack, int elembits, const Option& opt)
+{
+    if (roix < 0 || roiy < 0 || roiw <= 0 || roih <= 0 || roix + roiw > w || roiy + roih > h)
+    {
+        NCNN_LOGE("roi %d %d %d %d out of image %d %d", roix, roiy, roiw, roih, w, h);
+        return Mat();
+    }
+
+    const int type_from = type & PIXEL_FORMAT_MASK;
+    int type_to = (type & PIXEL_CONVERT_MASK) >> PIXEL_CONVERT_SHIFT;
+    if (type_to == 0 && type_from != PIXEL_NV21 && type_from != PIXEL_NV12)
+        type_to = type_from;
+
+    const int planes = get_pixel_planes(type_from);
+
+    pixel_channel_expr exprs[4];
+    const int channels = planes ? resolve_channel_exprs(type_from, type_to, exprs) : 0;
+    if (channels == 0)
+    {
+        // unknown convert type
+        NCNN_LOGE("unknown convert type %d", type);
+        return Mat();
+    }
+
+    if (elempack <= 0 || channels % elempack != 0 || (elembits != 32 && elembits != 16 && elembits != 8))
+    {
+        NCNN_LOGE("unsupported elempack %d elembits %d for %d channels", elempack, elembits, channels);
+        return Mat();
+    }
+
+    for (int q = 0; q < channels; q++)
+    {
+        pixel_channel_expr& e = exprs[q];
+
+        const float mean = mean_vals ? mean_vals[q] : 0.f;
+        const float norm = norm_vals ? norm_vals[q] : 1.f;
+
+        if (e.clamp)
+        {
+            e.scale = norm;
+            e.shift = -mean * norm;
+        }
+        else
+        {
+            for (int i = 0; i < e.count; i++)
+            {
+                e.coef[i] *= norm;
+            }
+            e.bias = (e.bias - mean) * norm;
+            e.scale = 1.f;
+            e.shift = 0.f;
+        }
+    }
+
+    Mat m;
+    m.create(target_width, target_height, channels / elempack, (size_t)(elembits / 8 * elempack), elempack, opt.blob_allocator);
+    if (m.empty())
+        return m;
+
+    // sampling positions in the full image
+    // interleaved pixels use byte offsets, yuv420sp chroma bytes follow the pixel at half resolution
+    const int cn = planes == 3 && (type_from == PIXEL_NV21 || type_from == PIXEL_NV12) ? 1 : planes;
+    const bool yuv420sp = type_from == PIXEL_NV21 || type_from == PIXEL_NV12;
+
+    std::vector<int> xofs(target_width * 2);
+    std::vector<int> xofs_uv(yuv420sp ? target_width * 2 : 0);
+    std::vector<int> ialpha(target_width);
+    std::vector<int> yofs(target_height * 2);
+    std::vector<float> beta(target_height);
+    {
+        std::vector<float> alpha(target_width);
+
+        resolve_bilinear_coords(roiw, target_width, &xofs[0], &alpha[0]);
+        resolve_bilinear_coords(roih, target_height, &yofs[0], &beta[0]);
+
+        for (int i = 0; i < target_width; i++)
+        {
+            const int a1 = (int)(alpha[i] * INTER_RESIZE_COEF_SCALE + 0.5f);
+            ialpha[i] = (INTER_RESIZE_COEF_SCALE - a1) | (a1 << 16);
+        }
+    }
+
+    for (int i = 0; i < target_width * 2; i++)
+    {
+        const int sx = roix + xofs[i];
+        xofs[i] = sx * cn;
+        if (yuv420sp)
+            xofs_uv[i] = sx / 2 * 2;
+    }
+    for (int i = 0; i < target_height * 2; i++)
+    {
+        yofs[i] += roiy;
+    }
+
+    // the taps are ascending, the leading outputs whose second tap can be read as 4 bytes within the row
+    int wvec = target_width;
+    while (wvec > 0 && xofs[target_width + wvec - 1] + 4 > w * cn)
+        wvec--;
+
+    int wvec_uv = target_width;
+    while (yuv420sp && wvec_uv > 0 && xofs_uv[target_width + wvec_uv - 1] + 4 > w)
+        wvec_uv--;
+
+    const unsigned char* uvplane = pixels + (size_t)stride * h;
+
+    // two sampled rows per plane and one normalized row for each band of output rows
+    const int nbands = std::max(1, std::min(opt.num_threads, target_height));
+    const int band_rows = (target_height + nbands - 1) / nbands;
+
+    Mat rowsbuf(target_width, planes * 2 + 1, nbands, 4u, opt.workspace_allocator);
+    if (rowsbuf.empty())
+        return Mat();
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int b = 0; b < nbands; b++)
+    {
+        Mat rows = rowsbuf.channel(b);
+
+        float* top[4];
+        float* bot[4];
+        for (int k = 0; k < planes; k++)
+        {
+            top[k] = rows.row(k);
+            bot[k] = rows.row(planes + k);
+        }
+        float* tmp = rows.row(planes * 2);
+
+        int top_y = -1;
+        int bot_y = -1;
+        int top_uv_y = -1;
+        int bot_uv_y = -1;
+
+        const int dy_end = std::min((b + 1) * band_rows, target_height);
+        for (int dy = b * band_rows; dy < dy_end; dy++)
+        {
+            const int sy0 = yofs[dy];
+            const int sy1 = yofs[target_height + dy];
+
+            if (cn == 1)
+                prepare_rows<1>(pixels, stride, sy0, sy1, &xofs[0], &ialpha[0], target_width, wvec, top, bot, top_y, bot_y);
+            if (cn == 3)
+                prepare_rows<3>(pixels, stride, sy0, sy1, &xofs[0], &ialpha[0], target_width, wvec, top, bot, top_y, bot_y);
+            if (cn == 4)
+                prepare_rows<4>(pixels, stride, sy0, sy1, &xofs[0], &ialpha[0], target_width, wvec, top, bot, top_y, bot_y);
+
+            if (yuv420sp)
+            {
+                // the chroma row of each luma tap
+                prepare_rows<2>(uvplane, stride, sy0 / 2, sy1 / 2, &xofs_uv[0], &ialpha[0], target_width, wvec_uv, top + 1, bot + 1, top_uv_y, bot_uv_y);
+            }
+
+            for (int q = 0; q < channels; q++)
+            {
+                void* outptr = m.channel(q / elempack).row<unsigned char>(dy) + (q % elempack) * (elembits / 8);
+
+                if (elempack == 1 && elembits == 32)
+                {
+                    eval_channel_expr(exprs[q], top, bot, beta[dy], target_width, (float*)outptr);
+                }
+                else
+                {
+                    eval_channel_expr(exprs[q], top, bot, beta[dy], target_width, tmp);
+                    store_channel_row(tmp, target_width, outptr, elempack, elembits);
+                }
+            }
+        }
+    }
+
+    return m;
+}
+
+#undef INTER_RESIZE_COEF_BITS
+#undef INTER_RESIZE_COEF_SCALE
+#endif // NCNN_PIXEL
+
+} // namespace ncnn
@@ -0,0 +1,67 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "platform.h"
+
+#include <immintrin.h>
+
+namespace ncnn {
+
+#if NCNN_PIXEL
+template<int cn>
+static int hresize_row_avx2_cn(const unsigned char* S, const int* xofs0, const int* xofs1, const int* ialpha, int wvec, float* const* rows)
+{
+    __m256i _mask = _mm256_set1_epi32(0xff);
+
+    int dx = 0;
+    for (; dx + 7 < wvec; dx += 8)
+    {
+        __m256i _g0 = _mm256_i32gather_epi32((const int*)S, _mm256_loadu_si256((const __m256i*)(xofs0 + dx)), 1);
+        __m256i _g1 = _mm256_i32gather_epi32((const int*)S, _mm256_loadu_si256((const __m256i*)(xofs1 + dx)), 1);
+        __m256i _a = _mm256_loadu_si256((const __m256i*)(ialpha + dx));
+
+        for (int k = 0; k < cn; k++)
+        {
+            // the two taps of byte k as a 16 bit pair for madd
+            __m256i _lo = _mm256_and_si256(_mm256_srli_epi32(_g0, k * 8), _mask);
+            __m256i _hi = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(_g1, k * 8), _mask), 16);
+            __m256i _v = _mm256_madd_epi16(_mm256_or_si256(_lo, _hi), _a);
+            _mm256_storeu_ps(rows[k] + dx, _mm256_cvtepi32_ps(_v));
+        }
+    }
+
+    return dx;
+}
+
+// horizontal pass of from_pixels_preprocess, eight outputs per step with the two taps gathered as 32bit words
+// every output below wvec may read 4 bytes at each tap, returns the number of outputs done
+int hresize_row_avx2(const unsigned char* S, const int* xofs, const int* ialpha, int w, int wvec, int cn, float* const* rows)
+{
+    const int* xofs0 = xofs;
+    const int* xofs1 = xofs + w;
+
+    if (cn == 1)
+        return hresize_row_avx2_cn<1>(S, xofs0, xofs1, ialpha, wvec, rows);
+    if (cn == 2)
+        return hresize_row_avx2_cn<2>(S, xofs0, xofs1, ialpha, wvec, rows);
+    if (cn == 3)
+        return hresize_row_avx2_cn<3>(S, xofs0, xofs1, ialpha, wvec, rows);
+    if (cn == 4)
+        return hresize_row_avx2_cn<4>(S, xofs0, xofs1, ialpha, wvec, rows);
+
+    return 0;
+}
+#endif // NCNN_PIXEL
+
+} // namespace ncnn
@@ -15,15 +15,22 @@
 #include "mat.h"
 
 #include <limits.h>
+#include <math.h>
 
 #if __ARM_NEON
 #include <arm_neon.h>
 #endif // __ARM_NEON
 #include "platform.h"
+#include "cpu.h"
 
 namespace ncnn {
 
 #if NCNN_PIXEL
+#if NCNN_AVX2 && (__AVX2__ || (NCNN_RUNTIME_CPU && __SSE2__))
+int vresize_two_avx2(const short* rows0p, const short* rows1p, int wsize, unsigned char* Dp0, unsigned char* Dp1, short b0, short b1, short b2, short b3);
+int vresize_one_avx2(const short* rows0p, const short* rows1p, int wsize, unsigned char* Dp, short b0, short b1);
+#endif
+
 static void vresize_two(const short* rows0p, const short* rows1p, int wsize, unsigned char* Dp0, unsigned char* Dp1, short b0, short b1, short b2, short b3)
 {
     int dx = 0;
@@ -67,6 +74,18 @@ static void vresize_two(const short* rows0p, const short* rows1p, int wsize, uns
         rows1p += 8;
     }
 #endif // __ARM_NEON
+#if NCNN_AVX2 && (__AVX2__ || (NCNN_RUNTIME_CPU && __SSE2__))
+#if !__AVX2__
+    if (ncnn::cpu_support_x86_avx2())
+#endif
+    {
+        dx = vresize_two_avx2(rows0p, rows1p, wsize, Dp0, Dp1, b0, b1, b2, b3);
+        Dp0 += dx;
+        Dp1 += dx;
+        rows0p += dx;
+        rows1p += dx;
+    }
+#endif
 #if __SSE2__
     __m128i _b0 = _mm_set1_epi16(b0);
     __m128i _b1 = _mm_set1_epi16(b1);
@@ -156,6 +175,17 @@ static void vresize_one(const short* rows0p, const short* rows1p, int wsize, uns
         rows1p += 8;
     }
 #endif // __ARM_NEON
+#if NCNN_AVX2 && (__AVX2__ || (NCNN_RUNTIME_CPU && __SSE2__))
+#if !__AVX2__
+    if (ncnn::cpu_support_x86_avx2())
+#endif
+    {
+        dx = vresize_one_avx2(rows0p, rows1p, wsize, Dp, b0, b1);
+        Dp += dx;
+        rows0p += dx;
+        rows1p += dx;
+    }
+#endif
 #if __SSE2__
     __m128i _b0 = _mm_set1_epi16(b0);
     __m128i _b1 = _mm_set1_epi16(b1);
@@ -198,6 +228,58 @@ static void vresize_one(const short* rows0p, const short* rows1p, int wsize, uns
     }
 }
 
+#if __SSE2__
+// horizontal pass over the leading pixels whose two taps can be loaded as 8 bytes, returns the pixels done
+static int hresize_c3_sse2(const unsigned char* S, short* rows, const int* xofs, const short* ialpha, int w, int srcw)
+{
+    const __m128i _zero = _mm_setzero_si128();
+
+    int dx = 0;
+    // the 4th lane spills into the next pixel, which is written afterwards
+    for (; dx + 1 < w; dx++)
+    {
+        const int sx = xofs[dx];
+        if (sx + 8 > srcw * 3)
+            break;
+
+        __m128i _S = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(S + sx)), _zero);
+        __m128i _a = _mm_unpacklo_epi16(_mm_set1_epi16(ialpha[dx * 2]), _mm_set1_epi16(ialpha[dx * 2 + 1]));
+
+        // pair the two taps of each channel
+        _S = _mm_unpacklo_epi16(_S, _mm_srli_si128(_S, 6));
+
+        __m128i _rows = _mm_srai_epi32(_mm_madd_epi16(_S, _a), 4);
+        _mm_storel_epi64((__m128i*)(rows + dx * 3), _mm_packs_epi32(_rows, _rows));
+    }
+
+    return dx;
+}
+
+static int hresize_c4_sse2(const unsigned char* S, short* rows, const int* xofs, const short* ialpha, int w)
+{
+    const __m128i _zero = _mm_setzero_si128();
+
+    int dx = 0;
+    for (; dx + 1 < w; dx += 2)
+    {
+        __m128i _S0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(S + xofs[dx])), _zero);
+        __m128i _S1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(S + xofs[dx + 1])), _zero);
+        __m128i _a0 = _mm_unpacklo_epi16(_mm_set1_epi16(ialpha[dx * 2]), _mm_set1_epi16(ialpha[dx * 2 + 1]));
+        __m128i _a1 = _mm_unpacklo_epi16(_mm_set1_epi16(ialpha[dx * 2 + 2]), _mm_set1_epi16(ialpha[dx * 2 + 3]));
+
+        // pair the two taps of each channel
+        _S0 = _mm_unpacklo_epi16(_S0, _mm_srli_si128(_S0, 8));
+        _S1 = _mm_unpacklo_epi16(_S1, _mm_srli_si128(_S1, 8));
+
+        __m128i _rows0 = _mm_srai_epi32(_mm_madd_epi16(_S0, _a0), 4);
+        __m128i _rows1 = _mm_srai_epi32(_mm_madd_epi16(_S1, _a1), 4);
+        _mm_storeu_si128((__m128i*)(rows + dx * 4), _mm_packs_epi32(_rows0, _rows1));
+    }
+
+    return dx;
+}
+#endif // __SSE2__
+
 void resize_bilinear_c1(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h)
 {
     return resize_bilinear_c1(src, srcw, srch, srcw, dst, w, h, w);
@@ -219,6 +301,38 @@ void resize_bilinear_c4(const unsigned char* src, int srcw, int srch, unsigned c
 }
 
 void resize_bilinear_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return resize_bilinear_c1(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return resize_bilinear_c2(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return resize_bilinear_c3(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride)
+{
+    Option opt;
+    opt.num_threads = 1;
+
+    return resize_bilinear_c4(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bilinear_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
 {
     const int INTER_RESIZE_COEF_BITS = 11;
     const int INTER_RESIZE_COEF_SCALE = 1 << INTER_RESIZE_COEF_BITS;
@@ -295,96 +409,106 @@ void resize_bilinear_c1(const unsigned char* src, int srcw, int srch, int srcstr
 
 #undef SATURATE_CAST_SHORT
 
-    // loop body
-    Mat rowsbuf0(w, (size_t)2u);
-    Mat rowsbuf1(w, (size_t)2u);
-    short* rows0 = (short*)rowsbuf0.data;
-    short* rows1 = (short*)rowsbuf1.data;
+    // loop body, output rows are split into bands which keep their own row buffers
+    const int nn_bands = std::max(std::min(opt.num_threads, h), 1);
 
-    int prev_sy1 = -2;
-
-    for (int dy = 0; dy < h; dy++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < nn_bands; ii++)
     {
-        sy = yofs[dy];
+        const int dy_start = h * ii / nn_bands;
+        const int dy_end = h * (ii + 1) / nn_bands;
+        const short* ibetap = ibeta + dy_start * 2;
 
-        if (sy == prev_sy1)
-        {
-            // reuse all rows
-        }
-        else if (sy == prev_sy1 + 1)
-        {
-            // hresize one row
-            short* rows0_old = rows0;
-            rows0 = rows1;
-            rows1 = rows0_old;
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
-            {
-                sx = xofs[dx];
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
+        Mat rowsbuf0(w, (size_t)2u);
+        Mat rowsbuf1(w, (size_t)2u);
+        short* rows0 = (short*)rowsbuf0.data;
+        short* rows1 = (short*)rowsbuf1.data;
 
-                const unsigned char* S1p = S1 + sx;
-                rows1p[dx] = (S1p[0] * a0 + S1p[1] * a1) >> 4;
+        int prev_sy1 = -2;
 
-                ialphap += 2;
-            }
-        }
-        else
+        for (int dy = dy_start; dy < dy_end; dy++)
         {
-            // hresize two rows
-            const unsigned char* S0 = src + srcstride * (sy);
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows0p = rows0;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
-            {
-                sx = xofs[dx];
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
+            const int sy = yofs[dy];
 
-                const unsigned char* S0p = S0 + sx;
-                const unsigned char* S1p = S1 + sx;
-                rows0p[dx] = (S0p[0] * a0 + S0p[1] * a1) >> 4;
-                rows1p[dx] = (S1p[0] * a0 + S1p[1] * a1) >> 4;
-
-                ialphap += 2;
+            if (sy == prev_sy1)
+            {
+                // reuse all rows
+            }
+            else if (sy == prev_sy1 + 1)
+            {
+                // hresize one row
+                short* rows0_old = rows0;
+                rows0 = rows1;
+                rows1 = rows0_old;
+                const unsigned char* S1 = src + srcstride * (sy + 1);
+
+                const short* ialphap = ialpha;
+                short* rows1p = rows1;
+                for (int dx = 0; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
+
+                    const unsigned char* S1p = S1 + sx;
+                    rows1p[dx] = (S1p[0] * a0 + S1p[1] * a1) >> 4;
+
+                    ialphap += 2;
+                }
+            }
+            else
+            {
+                // hresize two rows
+                const unsigned char* S0 = src + srcstride * (sy);
+                const unsigned char* S1 = src + srcstride * (sy + 1);
+
+                const short* ialphap = ialpha;
+                short* rows0p = rows0;
+                short* rows1p = rows1;
+                for (int dx = 0; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
+
+                    const unsigned char* S0p = S0 + sx;
+                    const unsigned char* S1p = S1 + sx;
+                    rows0p[dx] = (S0p[0] * a0 + S0p[1] * a1) >> 4;
+                    rows1p[dx] = (S1p[0] * a0 + S1p[1] * a1) >> 4;
+
+                    ialphap += 2;
+                }
             }
-        }
 
-        prev_sy1 = sy;
+            prev_sy1 = sy;
 
-        if (dy + 1 < h && yofs[dy + 1] == sy)
-        {
-            // vresize for two rows
-            unsigned char* Dp0 = dst + stride * dy;
-            unsigned char* Dp1 = dst + stride * (dy + 1);
+            if (dy + 1 < dy_end && yofs[dy + 1] == sy)
+            {
+                // vresize for two rows
+                unsigned char* Dp0 = dst + stride * dy;
+                unsigned char* Dp1 = dst + stride * (dy + 1);
 
-            vresize_two(rows0, rows1, w, Dp0, Dp1, ibeta[0], ibeta[1], ibeta[2], ibeta[3]);
+                vresize_two(rows0, rows1, w, Dp0, Dp1, ibetap[0], ibetap[1], ibetap[2], ibetap[3]);
 
-            ibeta += 4;
-            dy += 1;
-        }
-        else
-        {
-            // vresize
-            unsigned char* Dp = dst + stride * dy;
+                ibetap += 4;
+                dy += 1;
+            }
+            else
+            {
+                // vresize
+                unsigned char* Dp = dst + stride * dy;
 
-            vresize_one(rows0, rows1, w, Dp, ibeta[0], ibeta[1]);
+                vresize_one(rows0, rows1, w, Dp, ibetap[0], ibetap[1]);
 
-            ibeta += 2;
+                ibetap += 2;
+            }
         }
     }
 
     delete[] buf;
 }
 
-void resize_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride)
+void resize_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
 {
     const int INTER_RESIZE_COEF_BITS = 11;
     const int INTER_RESIZE_COEF_SCALE = 1 << INTER_RESIZE_COEF_BITS;
@@ -461,151 +585,161 @@ void resize_bilinear_c2(const unsigned char* src, int srcw, int srch, int srcstr
 
 #undef SATURATE_CAST_SHORT
 
-    // loop body
-    Mat rowsbuf0(w * 2 + 2, (size_t)2u);
-    Mat rowsbuf1(w * 2 + 2, (size_t)2u);
-    short* rows0 = (short*)rowsbuf0.data;
-    short* rows1 = (short*)rowsbuf1.data;
-
-    int prev_sy1 = -2;
+    // loop body, output rows are split into bands which keep their own row buffers
+    const int nn_bands = std::max(std::min(opt.num_threads, h), 1);
 
-    for (int dy = 0; dy < h; dy++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < nn_bands; ii++)
     {
-        sy = yofs[dy];
+        const int dy_start = h * ii / nn_bands;
+        const int dy_end = h * (ii + 1) / nn_bands;
+        const short* ibetap = ibeta + dy_start * 2;
 
-        if (sy == prev_sy1)
-        {
-            // reuse all rows
-        }
-        else if (sy == prev_sy1 + 1)
+        Mat rowsbuf0(w * 2 + 2, (size_t)2u);
+        Mat rowsbuf1(w * 2 + 2, (size_t)2u);
+        short* rows0 = (short*)rowsbuf0.data;
+        short* rows1 = (short*)rowsbuf1.data;
+
+        int prev_sy1 = -2;
+
+        for (int dy = dy_start; dy < dy_end; dy++)
         {
-            // hresize one row
-            short* rows0_old = rows0;
-            rows0 = rows1;
-            rows1 = rows0_old;
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
-            {
-                sx = xofs[dx];
+            const int sy = yofs[dy];
 
-                const unsigned char* S1p = S1 + sx;
+            if (sy == prev_sy1)
+            {
+                // reuse all rows
+            }
+            else if (sy == prev_sy1 + 1)
+            {
+                // hresize one row
+                short* rows0_old = rows0;
+                rows0 = rows1;
+                rows1 = rows0_old;
+                const unsigned char* S1 = src + srcstride * (sy + 1);
+
+                const short* ialphap = ialpha;
+                short* rows1p = rows1;
+                for (int dx = 0; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+
+                    const unsigned char* S1p = S1 + sx;
 #if __ARM_NEON
-                int16x4_t _a0a1XX = vld1_s16(ialphap);
-                int16x4_t _a0a0a1a1 = vzip_s16(_a0a1XX, _a0a1XX).val[0];
-                uint8x8_t _S1 = uint8x8_t();
-
-                _S1 = vld1_lane_u8(S1p, _S1, 0);
-                _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
-                _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
-                _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
-
-                int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
-                int16x4_t _S1lowhigh = vget_low_s16(_S116);
-                int32x4_t _S1ma0a1 = vmull_s16(_S1lowhigh, _a0a0a1a1);
-                int32x2_t _rows1low = vadd_s32(vget_low_s32(_S1ma0a1), vget_high_s32(_S1ma0a1));
-                int32x4_t _rows1 = vcombine_s32(_rows1low, vget_high_s32(_S1ma0a1));
-                int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
-                vst1_s16(rows1p, _rows1_sr4);
+                    int16x4_t _a0a1XX = vld1_s16(ialphap);
+                    int16x4_t _a0a0a1a1 = vzip_s16(_a0a1XX, _a0a1XX).val[0];
+                    uint8x8_t _S1 = uint8x8_t();
+
+                    _S1 = vld1_lane_u8(S1p, _S1, 0);
+                    _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
+                    _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
+                    _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
+
+                    int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
+                    int16x4_t _S1lowhigh = vget_low_s16(_S116);
+                    int32x4_t _S1ma0a1 = vmull_s16(_S1lowhigh, _a0a0a1a1);
+                    int32x2_t _rows1low = vadd_s32(vget_low_s32(_S1ma0a1), vget_high_s32(_S1ma0a1));
+                    int32x4_t _rows1 = vcombine_s32(_rows1low, vget_high_s32(_S1ma0a1));
+                    int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
+                    vst1_s16(rows1p, _rows1_sr4);
 #else
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
 
-                rows1p[0] = (S1p[0] * a0 + S1p[2] * a1) >> 4;
-                rows1p[1] = (S1p[1] * a0 + S1p[3] * a1) >> 4;
+                    rows1p[0] = (S1p[0] * a0 + S1p[2] * a1) >> 4;
+                    rows1p[1] = (S1p[1] * a0 + S1p[3] * a1) >> 4;
 #endif // __ARM_NEON
 
-                ialphap += 2;
-                rows1p += 2;
+                    ialphap += 2;
+                    rows1p += 2;
+                }
             }
-        }
-        else
-        {
-            // hresize two rows
-            const unsigned char* S0 = src + srcstride * (sy);
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows0p = rows0;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
+            else
             {
-                sx = xofs[dx];
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
-
-                const unsigned char* S0p = S0 + sx;
-                const unsigned char* S1p = S1 + sx;
+                // hresize two rows
+                const unsigned char* S0 = src + srcstride * (sy);
+                const unsigned char* S1 = src + srcstride * (sy + 1);
+
+                const short* ialphap = ialpha;
+                short* rows0p = rows0;
+                short* rows1p = rows1;
+                for (int dx = 0; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
+
+                    const unsigned char* S0p = S0 + sx;
+                    const unsigned char* S1p = S1 + sx;
 #if __ARM_NEON
-                int16x4_t _a0 = vdup_n_s16(a0);
-                int16x4_t _a1 = vdup_n_s16(a1);
-                uint8x8_t _S0 = uint8x8_t();
-                uint8x8_t _S1 = uint8x8_t();
-
-                _S0 = vld1_lane_u8(S0p, _S0, 0);
-                _S0 = vld1_lane_u8(S0p + 1, _S0, 1);
-                _S0 = vld1_lane_u8(S0p + 2, _S0, 2);
-                _S0 = vld1_lane_u8(S0p + 3, _S0, 3);
-
-                _S1 = vld1_lane_u8(S1p, _S1, 0);
-                _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
-                _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
-                _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
-
-                int16x8_t _S016 = vreinterpretq_s16_u16(vmovl_u8(_S0));
-                int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
-                int16x4_t _S0lowhigh = vget_low_s16(_S016);
-                int16x4_t _S1lowhigh = vget_low_s16(_S116);
-                int32x2x2_t _S0S1low_S0S1high = vtrn_s32(vreinterpret_s32_s16(_S0lowhigh), vreinterpret_s32_s16(_S1lowhigh));
-                int32x4_t _rows01 = vmull_s16(vreinterpret_s16_s32(_S0S1low_S0S1high.val[0]), _a0);
-                _rows01 = vmlal_s16(_rows01, vreinterpret_s16_s32(_S0S1low_S0S1high.val[1]), _a1);
-                int16x4_t _rows01_sr4 = vshrn_n_s32(_rows01, 4);
-                int16x4_t _rows1_sr4 = vext_s16(_rows01_sr4, _rows01_sr4, 2);
-                vst1_s16(rows0p, _rows01_sr4);
-                vst1_s16(rows1p, _rows1_sr4);
+                    int16x4_t _a0 = vdup_n_s16(a0);
+                    int16x4_t _a1 = vdup_n_s16(a1);
+                    uint8x8_t _S0 = uint8x8_t();
+                    uint8x8_t _S1 = uint8x8_t();
+
+                    _S0 = vld1_lane_u8(S0p, _S0, 0);
+                    _S0 = vld1_lane_u8(S0p + 1, _S0, 1);
+                    _S0 = vld1_lane_u8(S0p + 2, _S0, 2);
+                    _S0 = vld1_lane_u8(S0p + 3, _S0, 3);
+
+                    _S1 = vld1_lane_u8(S1p, _S1, 0);
+                    _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
+                    _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
+                    _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
+
+                    int16x8_t _S016 = vreinterpretq_s16_u16(vmovl_u8(_S0));
+                    int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
+                    int16x4_t _S0lowhigh = vget_low_s16(_S016);
+                    int16x4_t _S1lowhigh = vget_low_s16(_S116);
+                    int32x2x2_t _S0S1low_S0S1high = vtrn_s32(vreinterpret_s32_s16(_S0lowhigh), vreinterpret_s32_s16(_S1lowhigh));
+                    int32x4_t _rows01 = vmull_s16(vreinterpret_s16_s32(_S0S1low_S0S1high.val[0]), _a0);
+                    _rows01 = vmlal_s16(_rows01, vreinterpret_s16_s32(_S0S1low_S0S1high.val[1]), _a1);
+                    int16x4_t _rows01_sr4 = vshrn_n_s32(_rows01, 4);
+                    int16x4_t _rows1_sr4 = vext_s16(_rows01_sr4, _rows01_sr4, 2);
+                    vst1_s16(rows0p, _rows01_sr4);
+                    vst1_s16(rows1p, _rows1_sr4);
 #else
-                rows0p[0] = (S0p[0] * a0 + S0p[2] * a1) >> 4;
-                rows0p[1] = (S0p[1] * a0 + S0p[3] * a1) >> 4;
-                rows1p[0] = (S1p[0] * a0 + S1p[2] * a1) >> 4;
-                rows1p[1] = (S1p[1] * a0 + S1p[3] * a1) >> 4;
+                    rows0p[0] = (S0p[0] * a0 + S0p[2] * a1) >> 4;
+                    rows0p[1] = (S0p[1] * a0 + S0p[3] * a1) >> 4;
+                    rows1p[0] = (S1p[0] * a0 + S1p[2] * a1) >> 4;
+                    rows1p[1] = (S1p[1] * a0 + S1p[3] * a1) >> 4;
 #endif // __ARM_NEON
 
-                ialphap += 2;
-                rows0p += 2;
-                rows1p += 2;
+                    ialphap += 2;
+                    rows0p += 2;
+                    rows1p += 2;
+                }
             }
-        }
 
-        prev_sy1 = sy;
+            prev_sy1 = sy;
 
-        if (dy + 1 < h && yofs[dy + 1] == sy)
-        {
-            // vresize for two rows
-            unsigned char* Dp0 = dst + stride * dy;
-            unsigned char* Dp1 = dst + stride * (dy + 1);
+            if (dy + 1 < dy_end && yofs[dy + 1] == sy)
+            {
+                // vresize for two rows
+                unsigned char* Dp0 = dst + stride * dy;
+                unsigned char* Dp1 = dst + stride * (dy + 1);
 
-            vresize_two(rows0, rows1, w * 2, Dp0, Dp1, ibeta[0], ibeta[1], ibeta[2], ibeta[3]);
+                vresize_two(rows0, rows1, w * 2, Dp0, Dp1, ibetap[0], ibetap[1], ibetap[2], ibetap[3]);
 
-            ibeta += 4;
-            dy += 1;
-        }
-        else
-        {
-            // vresize
-            unsigned char* Dp = dst + stride * dy;
+                ibetap += 4;
+                dy += 1;
+            }
+            else
+            {
+                // vresize
+                unsigned char* Dp = dst + stride * dy;
 
-            vresize_one(rows0, rows1, w * 2, Dp, ibeta[0], ibeta[1]);
+                vresize_one(rows0, rows1, w * 2, Dp, ibetap[0], ibetap[1]);
 
-            ibeta += 2;
+                ibetap += 2;
+            }
         }
     }
 
     delete[] buf;
 }
 
-void resize_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride)
+void resize_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
 {
     const int INTER_RESIZE_COEF_BITS = 11;
     const int INTER_RESIZE_COEF_SCALE = 1 << INTER_RESIZE_COEF_BITS;
@@ -682,162 +816,183 @@ void resize_bilinear_c3(const unsigned char* src, int srcw, int srch, int srcstr
 
 #undef SATURATE_CAST_SHORT
 
-    // loop body
-    Mat rowsbuf0(w * 3 + 1, (size_t)2u);
-    Mat rowsbuf1(w * 3 + 1, (size_t)2u);
-    short* rows0 = (short*)rowsbuf0.data;
-    short* rows1 = (short*)rowsbuf1.data;
+    // loop body, output rows are split into bands which keep their own row buffers
+    const int nn_bands = std::max(std::min(opt.num_threads, h), 1);
 
-    int prev_sy1 = -2;
-
-    for (int dy = 0; dy < h; dy++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < nn_bands; ii++)
     {
-        sy = yofs[dy];
+        const int dy_start = h * ii / nn_bands;
+        const int dy_end = h * (ii + 1) / nn_bands;
+        const short* ibetap = ibeta + dy_start * 2;
 
-        if (sy == prev_sy1)
-        {
-            // reuse all rows
-        }
-        else if (sy == prev_sy1 + 1)
+        Mat rowsbuf0(w * 3 + 1, (size_t)2u);
+        Mat rowsbuf1(w * 3 + 1, (size_t)2u);
+        short* rows0 = (short*)rowsbuf0.data;
+        short* rows1 = (short*)rowsbuf1.data;
+
+        int prev_sy1 = -2;
+
+        for (int dy = dy_start; dy < dy_end; dy++)
         {
-            // hresize one row
-            short* rows0_old = rows0;
-            rows0 = rows1;
-            rows1 = rows0_old;
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
+            const int sy = yofs[dy];
+
+            if (sy == prev_sy1)
+            {
+                // reuse all rows
+            }
+            else if (sy == prev_sy1 + 1)
             {
-                sx = xofs[dx];
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
+                // hresize one row
+                short* rows0_old = rows0;
+                rows0 = rows1;
+                rows1 = rows0_old;
+                const unsigned char* S1 = src + srcstride * (sy + 1);
+
+                int dx = 0;
+#if __SSE2__
+                dx = hresize_c3_sse2(S1, rows1, xofs, ialpha, w, srcw);
+#endif // __SSE2__
+
+                const short* ialphap = ialpha + dx * 2;
+                short* rows1p = rows1 + dx * 3;
+                for (; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
 
-                const unsigned char* S1p = S1 + sx;
+                    const unsigned char* S1p = S1 + sx;
 #if __ARM_NEON
-                int16x4_t _a0 = vdup_n_s16(a0);
-                int16x4_t _a1 = vdup_n_s16(a1);
-                uint8x8_t _S1 = uint8x8_t();
-
-                _S1 = vld1_lane_u8(S1p, _S1, 0);
-                _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
-                _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
-                _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
-                _S1 = vld1_lane_u8(S1p + 4, _S1, 4);
-                _S1 = vld1_lane_u8(S1p + 5, _S1, 5);
-
-                int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
-                int16x4_t _S1low = vget_low_s16(_S116);
-                int16x4_t _S1high = vext_s16(_S1low, vget_high_s16(_S116), 3);
-                int32x4_t _rows1 = vmull_s16(_S1low, _a0);
-                _rows1 = vmlal_s16(_rows1, _S1high, _a1);
-                int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
-                vst1_s16(rows1p, _rows1_sr4);
+                    int16x4_t _a0 = vdup_n_s16(a0);
+                    int16x4_t _a1 = vdup_n_s16(a1);
+                    uint8x8_t _S1 = uint8x8_t();
+
+                    _S1 = vld1_lane_u8(S1p, _S1, 0);
+                    _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
+                    _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
+                    _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
+                    _S1 = vld1_lane_u8(S1p + 4, _S1, 4);
+                    _S1 = vld1_lane_u8(S1p + 5, _S1, 5);
+
+                    int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
+                    int16x4_t _S1low = vget_low_s16(_S116);
+                    int16x4_t _S1high = vext_s16(_S1low, vget_high_s16(_S116), 3);
+                    int32x4_t _rows1 = vmull_s16(_S1low, _a0);
+                    _rows1 = vmlal_s16(_rows1, _S1high, _a1);
+                    int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
+                    vst1_s16(rows1p, _rows1_sr4);
 #else
-                rows1p[0] = (S1p[0] * a0 + S1p[3] * a1) >> 4;
-                rows1p[1] = (S1p[1] * a0 + S1p[4] * a1) >> 4;
-                rows1p[2] = (S1p[2] * a0 + S1p[5] * a1) >> 4;
+                    rows1p[0] = (S1p[0] * a0 + S1p[3] * a1) >> 4;
+                    rows1p[1] = (S1p[1] * a0 + S1p[4] * a1) >> 4;
+                    rows1p[2] = (S1p[2] * a0 + S1p[5] * a1) >> 4;
 #endif // __ARM_NEON
 
-                ialphap += 2;
-                rows1p += 3;
+                    ialphap += 2;
+                    rows1p += 3;
+                }
             }
-        }
-        else
-        {
-            // hresize two rows
-            const unsigned char* S0 = src + srcstride * (sy);
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows0p = rows0;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
+            else
             {
-                sx = xofs[dx];
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
+                // hresize two rows
+                const unsigned char* S0 = src + srcstride * (sy);
+                const unsigned char* S1 = src + srcstride * (sy + 1);
+
+                int dx = 0;
+#if __SSE2__
+                hresize_c3_sse2(S0, rows0, xofs, ialpha, w, srcw);
+                dx = hresize_c3_sse2(S1, rows1, xofs, ialpha, w, srcw);
+#endif // __SSE2__
 
-                const unsigned char* S0p = S0 + sx;
-                const unsigned char* S1p = S1 + sx;
+                const short* ialphap = ialpha + dx * 2;
+                short* rows0p = rows0 + dx * 3;
+                short* rows1p = rows1 + dx * 3;
+                for (; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
+
+                    const unsigned char* S0p = S0 + sx;
+                    const unsigned char* S1p = S1 + sx;
 #if __ARM_NEON
-                int16x4_t _a0 = vdup_n_s16(a0);
-                int16x4_t _a1 = vdup_n_s16(a1);
-                uint8x8_t _S0 = uint8x8_t();
-                uint8x8_t _S1 = uint8x8_t();
-
-                _S0 = vld1_lane_u8(S0p, _S0, 0);
-                _S0 = vld1_lane_u8(S0p + 1, _S0, 1);
-                _S0 = vld1_lane_u8(S0p + 2, _S0, 2);
-                _S0 = vld1_lane_u8(S0p + 3, _S0, 3);
-                _S0 = vld1_lane_u8(S0p + 4, _S0, 4);
-                _S0 = vld1_lane_u8(S0p + 5, _S0, 5);
-
-                _S1 = vld1_lane_u8(S1p, _S1, 0);
-                _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
-                _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
-                _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
-                _S1 = vld1_lane_u8(S1p + 4, _S1, 4);
-                _S1 = vld1_lane_u8(S1p + 5, _S1, 5);
-
-                int16x8_t _S016 = vreinterpretq_s16_u16(vmovl_u8(_S0));
-                int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
-                int16x4_t _S0low = vget_low_s16(_S016);
-                int16x4_t _S1low = vget_low_s16(_S116);
-                int16x4_t _S0high = vext_s16(_S0low, vget_high_s16(_S016), 3);
-                int16x4_t _S1high = vext_s16(_S1low, vget_high_s16(_S116), 3);
-                int32x4_t _rows0 = vmull_s16(_S0low, _a0);
-                int32x4_t _rows1 = vmull_s16(_S1low, _a0);
-                _rows0 = vmlal_s16(_rows0, _S0high, _a1);
-                _rows1 = vmlal_s16(_rows1, _S1high, _a1);
-                int16x4_t _rows0_sr4 = vshrn_n_s32(_rows0, 4);
-                int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
-                vst1_s16(rows0p, _rows0_sr4);
-                vst1_s16(rows1p, _rows1_sr4);
+                    int16x4_t _a0 = vdup_n_s16(a0);
+                    int16x4_t _a1 = vdup_n_s16(a1);
+                    uint8x8_t _S0 = uint8x8_t();
+                    uint8x8_t _S1 = uint8x8_t();
+
+                    _S0 = vld1_lane_u8(S0p, _S0, 0);
+                    _S0 = vld1_lane_u8(S0p + 1, _S0, 1);
+                    _S0 = vld1_lane_u8(S0p + 2, _S0, 2);
+                    _S0 = vld1_lane_u8(S0p + 3, _S0, 3);
+                    _S0 = vld1_lane_u8(S0p + 4, _S0, 4);
+                    _S0 = vld1_lane_u8(S0p + 5, _S0, 5);
+
+                    _S1 = vld1_lane_u8(S1p, _S1, 0);
+                    _S1 = vld1_lane_u8(S1p + 1, _S1, 1);
+                    _S1 = vld1_lane_u8(S1p + 2, _S1, 2);
+                    _S1 = vld1_lane_u8(S1p + 3, _S1, 3);
+                    _S1 = vld1_lane_u8(S1p + 4, _S1, 4);
+                    _S1 = vld1_lane_u8(S1p + 5, _S1, 5);
+
+                    int16x8_t _S016 = vreinterpretq_s16_u16(vmovl_u8(_S0));
+                    int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
+                    int16x4_t _S0low = vget_low_s16(_S016);
+                    int16x4_t _S1low = vget_low_s16(_S116);
+                    int16x4_t _S0high = vext_s16(_S0low, vget_high_s16(_S016), 3);
+                    int16x4_t _S1high = vext_s16(_S1low, vget_high_s16(_S116), 3);
+                    int32x4_t _rows0 = vmull_s16(_S0low, _a0);
+                    int32x4_t _rows1 = vmull_s16(_S1low, _a0);
+                    _rows0 = vmlal_s16(_rows0, _S0high, _a1);
+                    _rows1 = vmlal_s16(_rows1, _S1high, _a1);
+                    int16x4_t _rows0_sr4 = vshrn_n_s32(_rows0, 4);
+                    int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
+                    vst1_s16(rows0p, _rows0_sr4);
+                    vst1_s16(rows1p, _rows1_sr4);
 #else
-                rows0p[0] = (S0p[0] * a0 + S0p[3] * a1) >> 4;
-                rows0p[1] = (S0p[1] * a0 + S0p[4] * a1) >> 4;
-                rows0p[2] = (S0p[2] * a0 + S0p[5] * a1) >> 4;
-                rows1p[0] = (S1p[0] * a0 + S1p[3] * a1) >> 4;
-                rows1p[1] = (S1p[1] * a0 + S1p[4] * a1) >> 4;
-                rows1p[2] = (S1p[2] * a0 + S1p[5] * a1) >> 4;
+                    rows0p[0] = (S0p[0] * a0 + S0p[3] * a1) >> 4;
+                    rows0p[1] = (S0p[1] * a0 + S0p[4] * a1) >> 4;
+                    rows0p[2] = (S0p[2] * a0 + S0p[5] * a1) >> 4;
+                    rows1p[0] = (S1p[0] * a0 + S1p[3] * a1) >> 4;
+                    rows1p[1] = (S1p[1] * a0 + S1p[4] * a1) >> 4;
+                    rows1p[2] = (S1p[2] * a0 + S1p[5] * a1) >> 4;
 #endif // __ARM_NEON
 
-                ialphap += 2;
-                rows0p += 3;
-                rows1p += 3;
+                    ialphap += 2;
+                    rows0p += 3;
+                    rows1p += 3;
+                }
             }
-        }
 
-        prev_sy1 = sy;
+            prev_sy1 = sy;
 
-        if (dy + 1 < h && yofs[dy + 1] == sy)
-        {
-            // vresize for two rows
-            unsigned char* Dp0 = dst + stride * dy;
-            unsigned char* Dp1 = dst + stride * (dy + 1);
+            if (dy + 1 < dy_end && yofs[dy + 1] == sy)
+            {
+                // vresize for two rows
+                unsigned char* Dp0 = dst + stride * dy;
+                unsigned char* Dp1 = dst + stride * (dy + 1);
 
-            vresize_two(rows0, rows1, w * 3, Dp0, Dp1, ibeta[0], ibeta[1], ibeta[2], ibeta[3]);
+                vresize_two(rows0, rows1, w * 3, Dp0, Dp1, ibetap[0], ibetap[1], ibetap[2], ibetap[3]);
 
-            ibeta += 4;
-            dy += 1;
-        }
-        else
-        {
-            // vresize
-            unsigned char* Dp = dst + stride * dy;
+                ibetap += 4;
+                dy += 1;
+            }
+            else
+            {
+                // vresize
+                unsigned char* Dp = dst + stride * dy;
 
-            vresize_one(rows0, rows1, w * 3, Dp, ibeta[0], ibeta[1]);
+                vresize_one(rows0, rows1, w * 3, Dp, ibetap[0], ibetap[1]);
 
-            ibeta += 2;
+                ibetap += 2;
+            }
         }
     }
 
     delete[] buf;
 }
 
-void resize_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride)
+void resize_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
 {
     const int INTER_RESIZE_COEF_BITS = 11;
     const int INTER_RESIZE_COEF_SCALE = 1 << INTER_RESIZE_COEF_BITS;
@@ -914,135 +1069,156 @@ void resize_bilinear_c4(const unsigned char* src, int srcw, int srch, int srcstr
 
 #undef SATURATE_CAST_SHORT
 
-    // loop body
-    Mat rowsbuf0(w * 4, (size_t)2u);
-    Mat rowsbuf1(w * 4, (size_t)2u);
-    short* rows0 = (short*)rowsbuf0.data;
-    short* rows1 = (short*)rowsbuf1.data;
+    // loop body, output rows are split into bands which keep their own row buffers
+    const int nn_bands = std::max(std::min(opt.num_threads, h), 1);
 
-    int prev_sy1 = -2;
-
-    for (int dy = 0; dy < h; dy++)
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < nn_bands; ii++)
     {
-        sy = yofs[dy];
+        const int dy_start = h * ii / nn_bands;
+        const int dy_end = h * (ii + 1) / nn_bands;
+        const short* ibetap = ibeta + dy_start * 2;
 
-        if (sy == prev_sy1)
-        {
-            // reuse all rows
-        }
-        else if (sy == prev_sy1 + 1)
+        Mat rowsbuf0(w * 4, (size_t)2u);
+        Mat rowsbuf1(w * 4, (size_t)2u);
+        short* rows0 = (short*)rowsbuf0.data;
+        short* rows1 = (short*)rowsbuf1.data;
+
+        int prev_sy1 = -2;
+
+        for (int dy = dy_start; dy < dy_end; dy++)
         {
-            // hresize one row
-            short* rows0_old = rows0;
-            rows0 = rows1;
-            rows1 = rows0_old;
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
+            const int sy = yofs[dy];
+
+            if (sy == prev_sy1)
             {
-                sx = xofs[dx];
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
+                // reuse all rows
+            }
+            else if (sy == prev_sy1 + 1)
+            {
+                // hresize one row
+                short* rows0_old = rows0;
+                rows0 = rows1;
+                rows1 = rows0_old;
+                const unsigned char* S1 = src + srcstride * (sy + 1);
 
-                const unsigned char* S1p = S1 + sx;
+                int dx = 0;
+#if __SSE2__
+                dx = hresize_c4_sse2(S1, rows1, xofs, ialpha, w);
+#endif // __SSE2__
+
+                const short* ialphap = ialpha + dx * 2;
+                short* rows1p = rows1 + dx * 4;
+                for (; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
+
+                    const unsigned char* S1p = S1 + sx;
 #if __ARM_NEON
-                int16x4_t _a0 = vdup_n_s16(a0);
-                int16x4_t _a1 = vdup_n_s16(a1);
-                uint8x8_t _S1 = vld1_u8(S1p);
-                int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
-                int16x4_t _S1low = vget_low_s16(_S116);
-                int16x4_t _S1high = vget_high_s16(_S116);
-                int32x4_t _rows1 = vmull_s16(_S1low, _a0);
-                _rows1 = vmlal_s16(_rows1, _S1high, _a1);
-                int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
-                vst1_s16(rows1p, _rows1_sr4);
+                    int16x4_t _a0 = vdup_n_s16(a0);
+                    int16x4_t _a1 = vdup_n_s16(a1);
+                    uint8x8_t _S1 = vld1_u8(S1p);
+                    int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
+                    int16x4_t _S1low = vget_low_s16(_S116);
+                    int16x4_t _S1high = vget_high_s16(_S116);
+                    int32x4_t _rows1 = vmull_s16(_S1low, _a0);
+                    _rows1 = vmlal_s16(_rows1, _S1high, _a1);
+                    int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
+                    vst1_s16(rows1p, _rows1_sr4);
 #else
-                rows1p[0] = (S1p[0] * a0 + S1p[4] * a1) >> 4;
-                rows1p[1] = (S1p[1] * a0 + S1p[5] * a1) >> 4;
-                rows1p[2] = (S1p[2] * a0 + S1p[6] * a1) >> 4;
-                rows1p[3] = (S1p[3] * a0 + S1p[7] * a1) >> 4;
+                    rows1p[0] = (S1p[0] * a0 + S1p[4] * a1) >> 4;
+                    rows1p[1] = (S1p[1] * a0 + S1p[5] * a1) >> 4;
+                    rows1p[2] = (S1p[2] * a0 + S1p[6] * a1) >> 4;
+                    rows1p[3] = (S1p[3] * a0 + S1p[7] * a1) >> 4;
 #endif // __ARM_NEON
 
-                ialphap += 2;
-                rows1p += 4;
+                    ialphap += 2;
+                    rows1p += 4;
+                }
             }
-        }
-        else
-        {
-            // hresize two rows
-            const unsigned char* S0 = src + srcstride * (sy);
-            const unsigned char* S1 = src + srcstride * (sy + 1);
-
-            const short* ialphap = ialpha;
-            short* rows0p = rows0;
-            short* rows1p = rows1;
-            for (int dx = 0; dx < w; dx++)
+            else
             {
-                sx = xofs[dx];
-                short a0 = ialphap[0];
-                short a1 = ialphap[1];
+                // hresize two rows
+                const unsigned char* S0 = src + srcstride * (sy);
+                const unsigned char* S1 = src + srcstride * (sy + 1);
 
-                const unsigned char* S0p = S0 + sx;
-                const unsigned char* S1p = S1 + sx;
+                int dx = 0;
+#if __SSE2__
+                hresize_c4_sse2(S0, rows0, xofs, ialpha, w);
+                dx = hresize_c4_sse2(S1, rows1, xofs, ialpha, w);
+#endif // __SSE2__
+
+                const short* ialphap = ialpha + dx * 2;
+                short* rows0p = rows0 + dx * 4;
+                short* rows1p = rows1 + dx * 4;
+                for (; dx < w; dx++)
+                {
+                    const int sx = xofs[dx];
+                    short a0 = ialphap[0];
+                    short a1 = ialphap[1];
+
+                    const unsigned char* S0p = S0 + sx;
+                    const unsigned char* S1p = S1 + sx;
 #if __ARM_NEON
-                int16x4_t _a0 = vdup_n_s16(a0);
-                int16x4_t _a1 = vdup_n_s16(a1);
-                uint8x8_t _S0 = vld1_u8(S0p);
-                uint8x8_t _S1 = vld1_u8(S1p);
-                int16x8_t _S016 = vreinterpretq_s16_u16(vmovl_u8(_S0));
-                int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
-                int16x4_t _S0low = vget_low_s16(_S016);
-                int16x4_t _S1low = vget_low_s16(_S116);
-                int16x4_t _S0high = vget_high_s16(_S016);
-                int16x4_t _S1high = vget_high_s16(_S116);
-                int32x4_t _rows0 = vmull_s16(_S0low, _a0);
-                int32x4_t _rows1 = vmull_s16(_S1low, _a0);
-                _rows0 = vmlal_s16(_rows0, _S0high, _a1);
-                _rows1 = vmlal_s16(_rows1, _S1high, _a1);
-                int16x4_t _rows0_sr4 = vshrn_n_s32(_rows0, 4);
-                int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
-                vst1_s16(rows0p, _rows0_sr4);
-                vst1_s16(rows1p, _rows1_sr4);
+                    int16x4_t _a0 = vdup_n_s16(a0);
+                    int16x4_t _a1 = vdup_n_s16(a1);
+                    uint8x8_t _S0 = vld1_u8(S0p);
+                    uint8x8_t _S1 = vld1_u8(S1p);
+                    int16x8_t _S016 = vreinterpretq_s16_u16(vmovl_u8(_S0));
+                    int16x8_t _S116 = vreinterpretq_s16_u16(vmovl_u8(_S1));
+                    int16x4_t _S0low = vget_low_s16(_S016);
+                    int16x4_t _S1low = vget_low_s16(_S116);
+                    int16x4_t _S0high = vget_high_s16(_S016);
+                    int16x4_t _S1high = vget_high_s16(_S116);
+                    int32x4_t _rows0 = vmull_s16(_S0low, _a0);
+                    int32x4_t _rows1 = vmull_s16(_S1low, _a0);
+                    _rows0 = vmlal_s16(_rows0, _S0high, _a1);
+                    _rows1 = vmlal_s16(_rows1, _S1high, _a1);
+                    int16x4_t _rows0_sr4 = vshrn_n_s32(_rows0, 4);
+                    int16x4_t _rows1_sr4 = vshrn_n_s32(_rows1, 4);
+                    vst1_s16(rows0p, _rows0_sr4);
+                    vst1_s16(rows1p, _rows1_sr4);
 #else
-                rows0p[0] = (S0p[0] * a0 + S0p[4] * a1) >> 4;
-                rows0p[1] = (S0p[1] * a0 + S0p[5] * a1) >> 4;
-                rows0p[2] = (S0p[2] * a0 + S0p[6] * a1) >> 4;
-                rows0p[3] = (S0p[3] * a0 + S0p[7] * a1) >> 4;
-                rows1p[0] = (S1p[0] * a0 + S1p[4] * a1) >> 4;
-                rows1p[1] = (S1p[1] * a0 + S1p[5] * a1) >> 4;
-                rows1p[2] = (S1p[2] * a0 + S1p[6] * a1) >> 4;
-                rows1p[3] = (S1p[3] * a0 + S1p[7] * a1) >> 4;
+                    rows0p[0] = (S0p[0] * a0 + S0p[4] * a1) >> 4;
+                    rows0p[1] = (S0p[1] * a0 + S0p[5] * a1) >> 4;
+                    rows0p[2] = (S0p[2] * a0 + S0p[6] * a1) >> 4;
+                    rows0p[3] = (S0p[3] * a0 + S0p[7] * a1) >> 4;
+                    rows1p[0] = (S1p[0] * a0 + S1p[4] * a1) >> 4;
+                    rows1p[1] = (S1p[1] * a0 + S1p[5] * a1) >> 4;
+                    rows1p[2] = (S1p[2] * a0 + S1p[6] * a1) >> 4;
+                    rows1p[3] = (S1p[3] * a0 + S1p[7] * a1) >> 4;
 #endif // __ARM_NEON
 
-                ialphap += 2;
-                rows0p += 4;
-                rows1p += 4;
+                    ialphap += 2;
+                    rows0p += 4;
+                    rows1p += 4;
+                }
             }
-        }
 
-        prev_sy1 = sy;
+            prev_sy1 = sy;
 
-        if (dy + 1 < h && yofs[dy + 1] == sy)
-        {
-            // vresize for two rows
-            unsigned char* Dp0 = dst + stride * dy;
-            unsigned char* Dp1 = dst + stride * (dy + 1);
+            if (dy + 1 < dy_end && yofs[dy + 1] == sy)
+            {
+                // vresize for two rows
+                unsigned char* Dp0 = dst + stride * dy;
+                unsigned char* Dp1 = dst + stride * (dy + 1);
 
-            vresize_two(rows0, rows1, w * 4, Dp0, Dp1, ibeta[0], ibeta[1], ibeta[2], ibeta[3]);
+                vresize_two(rows0, rows1, w * 4, Dp0, Dp1, ibetap[0], ibetap[1], ibetap[2], ibetap[3]);
 
-            ibeta += 4;
-            dy += 1;
-        }
-        else
-        {
-            // vresize
-            unsigned char* Dp = dst + stride * dy;
+                ibetap += 4;
+                dy += 1;
+            }
+            else
+            {
+                // vresize
+                unsigned char* Dp = dst + stride * dy;
 
-            vresize_one(rows0, rows1, w * 4, Dp, ibeta[0], ibeta[1]);
+                vresize_one(rows0, rows1, w * 4, Dp, ibetap[0], ibetap[1]);
 
-            ibeta += 2;
+                ibetap += 2;
+            }
         }
     }
 
@@ -1064,6 +1240,372 @@ void resize_bilinear_yuv420sp(const unsigned char* src, int srcw, int srch, unsi
     unsigned char* dstUV = dst + w * h;
     resize_bilinear_c2(srcUV, srcw / 2, srch / 2, dstUV, w / 2, h / 2);
 }
+
+static inline unsigned char float2uint8(float v)
+{
+    int i = (int)floor(v + 0.5f);
+    return (unsigned char)std::min(std::max(i, 0), 255);
+}
+
+// the source pixels covered by each output cell and their share of it, as opencv INTER_AREA
+static void area_coeffs(int srcw, int w, int* tabofs, int* xofs, float* alpha)
+{
+    const double scale = (double)srcw / w;
+
+    int n = 0;
+    for (int dx = 0; dx < w; dx++)
+    {
+        tabofs[dx] = n;
+
+        const double fsx1 = dx * scale;
+        const double fsx2 = fsx1 + scale;
+        const double cellw = std::min(scale, srcw - fsx1);
+
+        int sx1 = (int)ceil(fsx1);
+        int sx2 = (int)floor(fsx2);
+        sx2 = std::min(sx2, srcw - 1);
+        sx1 = std::min(sx1, sx2);
+
+        if (sx1 - fsx1 > 1e-3)
+        {
+            xofs[n] = sx1 - 1;
+            alpha[n++] = (float)((sx1 - fsx1) / cellw);
+        }
+
+        for (int sx = sx1; sx < sx2; sx++)
+        {
+            xofs[n] = sx;
+            alpha[n++] = (float)(1.0 / cellw);
+        }
+
+        if (fsx2 - sx2 > 1e-3)
+        {
+            xofs[n] = sx2;
+            alpha[n++] = (float)(std::min(std::min(fsx2 - sx2, 1.0), cellw) / cellw);
+        }
+    }
+
+    tabofs[w] = n;
+}
+
+template<int cn>
+static void resize_area_pixel(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    // every cell covers at most ceil(scale) + 1 source pixels
+    int* xtabofs = new int[w + 1 + h + 1];
+    int* ytabofs = xtabofs + w + 1;
+    int* xofs = new int[srcw + w * 2 + srch + h * 2];
+    int* yofs = xofs + srcw + w * 2;
+    float* alpha = new float[srcw + w * 2 + srch + h * 2];
+    float* beta = alpha + srcw + w * 2;
+
+    area_coeffs(srcw, w, xtabofs, xofs, alpha);
+    area_coeffs(srch, h, ytabofs, yofs, beta);
+
+    // loop body, output rows are split into bands which keep their own row buffers
+    const int nn_bands = std::max(std::min(opt.num_threads, h), 1);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < nn_bands; ii++)
+    {
+        const int dy_start = h * ii / nn_bands;
+        const int dy_end = h * (ii + 1) / nn_bands;
+
+        Mat rowbuf(w * cn, (size_t)4u);
+        Mat sumbuf(w * cn, (size_t)4u);
+        float* rows = rowbuf;
+        float* sum = sumbuf;
+
+        // the source row shared by the last cell of one output row and the first of the next
+        int prev_sy = -1;
+
+        for (int dy = dy_start; dy < dy_end; dy++)
+        {
+            for (int i = 0; i < w * cn; i++)
+            {
+                sum[i] = 0.f;
+            }
+
+            for (int j = ytabofs[dy]; j < ytabofs[dy + 1]; j++)
+            {
+                const int sy = yofs[j];
+                const float b = beta[j];
+
+                if (sy != prev_sy)
+                {
+                    // hresize
+                    const unsigned char* S = src + srcstride * sy;
+                    for (int dx = 0; dx < w; dx++)
+                    {
+                        float acc[cn];
+                        for (int k = 0; k < cn; k++)
+                        {
+                            acc[k] = 0.f;
+                        }
+
+                        for (int i = xtabofs[dx]; i < xtabofs[dx + 1]; i++)
+                        {
+                            const unsigned char* Sp = S + xofs[i] * cn;
+                            const float a = alpha[i];
+                            for (int k = 0; k < cn; k++)
+                            {
+                                acc[k] += Sp[k] * a;
+                            }
+                        }
+
+                        for (int k = 0; k < cn; k++)
+                        {
+                            rows[dx * cn + k] = acc[k];
+                        }
+                    }
+
+                    prev_sy = sy;
+                }
+
+                // vresize
+                for (int i = 0; i < w * cn; i++)
+                {
+                    sum[i] += rows[i] * b;
+                }
+            }
+
+            unsigned char* Dp = dst + stride * dy;
+            for (int i = 0; i < w * cn; i++)
+            {
+                Dp[i] = float2uint8(sum[i]);
+            }
+        }
+    }
+
+    delete[] xtabofs;
+    delete[] xofs;
+    delete[] alpha;
+}
+
+// four taps clamped to the image border, the same coefficients as the bicubic interp layer
+static void cubic_coeffs(int srcw, int w, int* xofs, float* alpha)
+{
+    const float A = -0.75f;
+
+    const double scale = (double)srcw / w;
+
+    for (int dx = 0; dx < w; dx++)
+    {
+        float fx = (float)((dx + 0.5) * scale - 0.5);
+        int sx = static_cast<int>(floor(fx));
+        fx -= sx;
+
+        float fx0 = fx + 1;
+        float fx1 = fx;
+        float fx2 = 1 - fx;
+
+        float* a = alpha + dx * 4;
+        a[0] = A * fx0 * fx0 * fx0 - 5 * A * fx0 * fx0 + 8 * A * fx0 - 4 * A;
+        a[1] = (A + 2) * fx1 * fx1 * fx1 - (A + 3) * fx1 * fx1 + 1;
+        a[2] = (A + 2) * fx2 * fx2 * fx2 - (A + 3) * fx2 * fx2 + 1;
+        a[3] = 1.f - a[0] - a[1] - a[2];
+
+        for (int k = 0; k < 4; k++)
+        {
+            xofs[dx * 4 + k] = std::min(std::max(sx - 1 + k, 0), srcw - 1);
+        }
+    }
+}
+
+template<int cn>
+static void resize_bicubic_pixel(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    int* xofs = new int[w * 4 + h * 4];
+    int* yofs = xofs + w * 4;
+    float* alpha = new float[w * 4 + h * 4];
+    float* beta = alpha + w * 4;
+
+    cubic_coeffs(srcw, w, xofs, alpha);
+    cubic_coeffs(srch, h, yofs, beta);
+
+    // loop body, output rows are split into bands which keep their own row buffers
+    const int nn_bands = std::max(std::min(opt.num_threads, h), 1);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < nn_bands; ii++)
+    {
+        const int dy_start = h * ii / nn_bands;
+        const int dy_end = h * (ii + 1) / nn_bands;
+
+        // four cached horizontal rows tagged by source row
+        Mat rowsbuf(w * cn, 4, (size_t)4u);
+        int rows_sy[4] = {-1, -1, -1, -1};
+
+        for (int dy = dy_start; dy < dy_end; dy++)
+        {
+            const int* sy = yofs + dy * 4;
+            const float* b = beta + dy * 4;
+
+            const float* rows[4];
+            for (int k = 0; k < 4; k++)
+            {
+                int slot = -1;
+                for (int j = 0; j < 4; j++)
+                {
+                    if (rows_sy[j] == sy[k])
+                        slot = j;
+                }
+
+                if (slot == -1)
+                {
+                    // evict a row none of the four taps needs
+                    for (int j = 0; j < 4; j++)
+                    {
+                        if (rows_sy[j] != sy[0] && rows_sy[j] != sy[1] && rows_sy[j] != sy[2] && rows_sy[j] != sy[3])
+                        {
+                            slot = j;
+                            break;
+                        }
+                    }
+
+                    // hresize
+                    const unsigned char* S = src + srcstride * sy[k];
+                    float* rowsp = rowsbuf.row(slot);
+                    for (int dx = 0; dx < w; dx++)
+                    {
+                        const int* sx = xofs + dx * 4;
+                        const float* a = alpha + dx * 4;
+                        for (int c = 0; c < cn; c++)
+                        {
+                            rowsp[dx * cn + c] = S[sx[0] * cn + c] * a[0] + S[sx[1] * cn + c] * a[1] + S[sx[2] * cn + c] * a[2] + S[sx[3] * cn + c] * a[3];
+                        }
+                    }
+
+                    rows_sy[slot] = sy[k];
+                }
+
+                rows[k] = rowsbuf.row(slot);
+            }
+
+            // vresize
+            unsigned char* Dp = dst + stride * dy;
+            int i = 0;
+#if __SSE2__
+            __m128 _b0 = _mm_set1_ps(b[0]);
+            __m128 _b1 = _mm_set1_ps(b[1]);
+            __m128 _b2 = _mm_set1_ps(b[2]);
+            __m128 _b3 = _mm_set1_ps(b[3]);
+            for (; i + 7 < w * cn; i += 8)
+            {
+                __m128 _v0 = _mm_mul_ps(_mm_loadu_ps(rows[0] + i), _b0);
+                __m128 _v1 = _mm_mul_ps(_mm_loadu_ps(rows[0] + i + 4), _b0);
+                _v0 = _mm_add_ps(_v0, _mm_mul_ps(_mm_loadu_ps(rows[1] + i), _b1));
+                _v1 = _mm_add_ps(_v1, _mm_mul_ps(_mm_loadu_ps(rows[1] + i + 4), _b1));
+                _v0 = _mm_add_ps(_v0, _mm_mul_ps(_mm_loadu_ps(rows[2] + i), _b2));
+                _v1 = _mm_add_ps(_v1, _mm_mul_ps(_mm_loadu_ps(rows[2] + i + 4), _b2));
+                _v0 = _mm_add_ps(_v0, _mm_mul_ps(_mm_loadu_ps(rows[3] + i), _b3));
+                _v1 = _mm_add_ps(_v1, _mm_mul_ps(_mm_loadu_ps(rows[3] + i + 4), _b3));
+                __m128i _v = _mm_packs_epi32(_mm_cvtps_epi32(_v0), _mm_cvtps_epi32(_v1));
+                _mm_storel_epi64((__m128i*)(Dp + i), _mm_packus_epi16(_v, _v));
+            }
+#endif // __SSE2__
+            for (; i < w * cn; i++)
+            {
+                Dp[i] = float2uint8(rows[0][i] * b[0] + rows[1][i] * b[1] + rows[2][i] * b[2] + rows[3][i] * b[3]);
+            }
+        }
+    }
+
+    delete[] xofs;
+    delete[] alpha;
+}
+
+void resize_area_c1(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_area_c1(src, srcw, srch, srcw, dst, w, h, w, opt);
+}
+
+void resize_area_c2(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_area_c2(src, srcw, srch, srcw * 2, dst, w, h, w * 2, opt);
+}
+
+void resize_area_c3(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_area_c3(src, srcw, srch, srcw * 3, dst, w, h, w * 3, opt);
+}
+
+void resize_area_c4(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_area_c4(src, srcw, srch, srcw * 4, dst, w, h, w * 4, opt);
+}
+
+void resize_area_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    if (w > srcw || h > srch)
+        return resize_bilinear_c1(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+
+    resize_area_pixel<1>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_area_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    if (w > srcw || h > srch)
+        return resize_bilinear_c2(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+
+    resize_area_pixel<2>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_area_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    if (w > srcw || h > srch)
+        return resize_bilinear_c3(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+
+    resize_area_pixel<3>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_area_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    if (w > srcw || h > srch)
+        return resize_bilinear_c4(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+
+    resize_area_pixel<4>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bicubic_c1(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_bicubic_c1(src, srcw, srch, srcw, dst, w, h, w, opt);
+}
+
+void resize_bicubic_c2(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_bicubic_c2(src, srcw, srch, srcw * 2, dst, w, h, w * 2, opt);
+}
+
+void resize_bicubic_c3(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_bicubic_c3(src, srcw, srch, srcw * 3, dst, w, h, w * 3, opt);
+}
+
+void resize_bicubic_c4(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, const Option& opt)
+{
+    return resize_bicubic_c4(src, srcw, srch, srcw * 4, dst, w, h, w * 4, opt);
+}
+
+void resize_bicubic_c1(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    resize_bicubic_pixel<1>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bicubic_c2(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    resize_bicubic_pixel<2>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bicubic_c3(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    resize_bicubic_pixel<3>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
+
+void resize_bicubic_c4(const unsigned char* src, int srcw, int srch, int srcstride, unsigned char* dst, int w, int h, int stride, const Option& opt)
+{
+    resize_bicubic_pixel<4>(src, srcw, srch, srcstride, dst, w, h, stride, opt);
+}
 #endif // NCNN_PIXEL
 
 } // namespace ncnn
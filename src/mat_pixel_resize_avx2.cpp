@@ -0,0 +1,90 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "platform.h"
+
+#include <immintrin.h>
+
+namespace ncnn {
+
+#if NCNN_PIXEL
+// vertical pass of resize_bilinear, two output rows from the same pair of source rows
+// 32 pixels per step, returns the number of pixels done
+int vresize_two_avx2(const short* rows0p, const short* rows1p, int wsize, unsigned char* Dp0, unsigned char* Dp1, short b0, short b1, short b2, short b3)
+{
+    int dx = 0;
+
+    __m256i _b0 = _mm256_set1_epi16(b0);
+    __m256i _b1 = _mm256_set1_epi16(b1);
+    __m256i _b2 = _mm256_set1_epi16(b2);
+    __m256i _b3 = _mm256_set1_epi16(b3);
+    __m256i _v2 = _mm256_set1_epi16(2);
+    for (; dx + 31 < wsize; dx += 32)
+    {
+        __m256i _r00 = _mm256_loadu_si256((const __m256i*)rows0p);
+        __m256i _r01 = _mm256_loadu_si256((const __m256i*)(rows0p + 16));
+        __m256i _r10 = _mm256_loadu_si256((const __m256i*)rows1p);
+        __m256i _r11 = _mm256_loadu_si256((const __m256i*)(rows1p + 16));
+        __m256i _acc00 = _mm256_add_epi16(_mm256_mulhi_epi16(_r00, _b0), _mm256_mulhi_epi16(_r10, _b1));
+        __m256i _acc01 = _mm256_add_epi16(_mm256_mulhi_epi16(_r01, _b0), _mm256_mulhi_epi16(_r11, _b1));
+        __m256i _acc10 = _mm256_add_epi16(_mm256_mulhi_epi16(_r00, _b2), _mm256_mulhi_epi16(_r10, _b3));
+        __m256i _acc11 = _mm256_add_epi16(_mm256_mulhi_epi16(_r01, _b2), _mm256_mulhi_epi16(_r11, _b3));
+        _acc00 = _mm256_srai_epi16(_mm256_add_epi16(_acc00, _v2), 2);
+        _acc01 = _mm256_srai_epi16(_mm256_add_epi16(_acc01, _v2), 2);
+        _acc10 = _mm256_srai_epi16(_mm256_add_epi16(_acc10, _v2), 2);
+        _acc11 = _mm256_srai_epi16(_mm256_add_epi16(_acc11, _v2), 2);
+        // packus works per 128bit lane, restore the order
+        __m256i _Dp0 = _mm256_permute4x64_epi64(_mm256_packus_epi16(_acc00, _acc01), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i _Dp1 = _mm256_permute4x64_epi64(_mm256_packus_epi16(_acc10, _acc11), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)Dp0, _Dp0);
+        _mm256_storeu_si256((__m256i*)Dp1, _Dp1);
+        Dp0 += 32;
+        Dp1 += 32;
+        rows0p += 32;
+        rows1p += 32;
+    }
+
+    return dx;
+}
+
+// vertical pass of resize_bilinear, one output row
+int vresize_one_avx2(const short* rows0p, const short* rows1p, int wsize, unsigned char* Dp, short b0, short b1)
+{
+    int dx = 0;
+
+    __m256i _b0 = _mm256_set1_epi16(b0);
+    __m256i _b1 = _mm256_set1_epi16(b1);
+    __m256i _v2 = _mm256_set1_epi16(2);
+    for (; dx + 31 < wsize; dx += 32)
+    {
+        __m256i _r00 = _mm256_loadu_si256((const __m256i*)rows0p);
+        __m256i _r01 = _mm256_loadu_si256((const __m256i*)(rows0p + 16));
+        __m256i _r10 = _mm256_loadu_si256((const __m256i*)rows1p);
+        __m256i _r11 = _mm256_loadu_si256((const __m256i*)(rows1p + 16));
+        __m256i _acc0 = _mm256_add_epi16(_mm256_mulhi_epi16(_r00, _b0), _mm256_mulhi_epi16(_r10, _b1));
+        __m256i _acc1 = _mm256_add_epi16(_mm256_mulhi_epi16(_r01, _b0), _mm256_mulhi_epi16(_r11, _b1));
+        _acc0 = _mm256_srai_epi16(_mm256_add_epi16(_acc0, _v2), 2);
+        _acc1 = _mm256_srai_epi16(_mm256_add_epi16(_acc1, _v2), 2);
+        __m256i _Dp = _mm256_permute4x64_epi64(_mm256_packus_epi16(_acc0, _acc1), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)Dp, _Dp);
+        Dp += 32;
+        rows0p += 32;
+        rows1p += 32;
+    }
+
+    return dx;
+}
+#endif // NCNN_PIXEL
+
+} // namespace ncnn
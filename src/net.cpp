@@ -19,14 +19,19 @@
 #include "layer_type.h"
 #include "modelbin.h"
 #include "paramdict.h"
+#include "threadpool.h"
 
+#include "layer/convolution.h"
+#include "layer/gemm.h"
+#include "layer/innerproduct.h"
+
+#include <limits.h>
+#include <map>
 #include <stdarg.h>
 #include <stdint.h>
 #include <string.h>
 
-#if NCNN_BENCHMARK
 #include "benchmark.h"
-#endif // NCNN_BENCHMARK
 
 #if NCNN_VULKAN
 #include "command.h"
@@ -35,6 +40,385 @@
 
 namespace ncnn {
 
+// identify an allocation by the layer running when it is made, the openmp thread making it
+// and its order among the allocations of that layer on that thread
+// the order of allocations across threads varies from run to run, while the order on a single thread does not
+struct MemoryPlanKey
+{
+    int layer_index;
+    int thread;
+    int seq;
+
+    bool operator<(const MemoryPlanKey& rhs) const
+    {
+        if (layer_index != rhs.layer_index)
+            return layer_index < rhs.layer_index;
+        if (thread != rhs.thread)
+            return thread < rhs.thread;
+        return seq < rhs.seq;
+    }
+};
+
+// allocation offsets in a single arena, computed from the allocations recorded in a previous extraction
+class MemoryPlan
+{
+public:
+    MemoryPlan()
+        : refcount(1), arena_size(0)
+    {
+    }
+
+    std::vector<MemoryPlanKey> keys;
+    std::vector<size_t> sizes;
+    // the block is alive from the layer step it is allocated in to the layer step it is freed in, both inclusive
+    std::vector<int> alloc_steps;
+    std::vector<int> free_steps;
+    std::vector<size_t> offsets;
+
+    // block index of each key
+    std::map<MemoryPlanKey, int> slots;
+
+    int refcount;
+    size_t arena_size;
+
+    void addref()
+    {
+        NCNN_XADD(&refcount, 1);
+    }
+
+    void release()
+    {
+        if (NCNN_XADD(&refcount, -1) == 1)
+            delete this;
+    }
+
+    // greedy by size, place larger blocks first at the lowest offset free during its lifetime
+    void solve();
+};
+
+void MemoryPlan::solve()
+{
+    const int count = (int)sizes.size();
+
+    std::vector<std::pair<size_t, int> > order(count);
+    for (int i = 0; i < count; i++)
+    {
+        order[i] = std::make_pair(alignSize(sizes[i], NCNN_MALLOC_ALIGN), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    offsets.resize(count);
+    arena_size = 0;
+
+    std::vector<int> placed;
+    std::vector<std::pair<size_t, size_t> > occupied;
+    for (int i = count - 1; i >= 0; i--)
+    {
+        const size_t size = order[i].first;
+        const int k = order[i].second;
+
+        // the blocks alive at the same time, the order inside a layer step is unknown
+        occupied.clear();
+        for (size_t j = 0; j < placed.size(); j++)
+        {
+            int p = placed[j];
+            if (alloc_steps[p] <= free_steps[k] && alloc_steps[k] <= free_steps[p])
+                occupied.push_back(std::make_pair(offsets[p], offsets[p] + alignSize(sizes[p], NCNN_MALLOC_ALIGN)));
+        }
+        std::sort(occupied.begin(), occupied.end());
+
+        size_t offset = 0;
+        for (size_t j = 0; j < occupied.size(); j++)
+        {
+            if (occupied[j].first >= offset + size)
+                break;
+
+            offset = std::max(offset, occupied[j].second);
+        }
+
+        offsets[k] = offset;
+        arena_size = std::max(arena_size, offset + size);
+
+        placed.push_back(k);
+    }
+
+    slots.clear();
+    for (int i = 0; i < count; i++)
+    {
+        slots[keys[i]] = i;
+    }
+}
+
+// serve allocations from the planned arena, and record the allocations for the next plan
+class PlannedAllocator : public Allocator
+{
+public:
+    PlannedAllocator(MemoryPlan* _plan);
+    virtual ~PlannedAllocator();
+
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+    // allocations from now on belong to the layer, -1 for none
+    void enter_layer(int layer_index);
+
+    // return the plan solved from recorded allocations, or null if the current plan served them all
+    MemoryPlan* recorded_plan();
+
+    // follow the plan again from the start on the same arena
+    // return false if the current run left the plan or some allocation is still alive
+    bool rewind();
+
+public:
+    Mutex lock;
+    MemoryPlan* plan;
+    unsigned char* arena;
+
+    // every allocation of the current run is served from the arena
+    bool matched;
+
+    int layer_index;
+    int step;
+    // next seq of layer and thread
+    std::map<std::pair<int, int>, int> seqs;
+
+    // recorded allocations of this run
+    std::vector<MemoryPlanKey> keys;
+    std::vector<size_t> sizes;
+    std::vector<int> alloc_steps;
+    std::vector<int> free_steps;
+
+    // alive allocation index of pointer
+    std::map<void*, int> alive;
+    // arena range end of alive blocks by offset, they never overlap
+    std::map<size_t, size_t> arena_alive;
+};
+
+PlannedAllocator::PlannedAllocator(MemoryPlan* _plan)
+    : plan(_plan), arena(0), matched(false), layer_index(-1), step(0)
+{
+    if (plan)
+    {
+        plan->addref();
+
+        arena = (unsigned char*)ncnn::fastMalloc(plan->arena_size);
+        matched = arena != 0;
+    }
+}
+
+PlannedAllocator::~PlannedAllocator()
+{
+    if (arena)
+        ncnn::fastFree(arena);
+
+    if (plan)
+        plan->release();
+}
+
+void PlannedAllocator::enter_layer(int _layer_index)
+{
+    MutexLockGuard guard(lock);
+
+    layer_index = _layer_index;
+    if (layer_index != -1)
+        step++;
+}
+
+void* PlannedAllocator::fastMalloc(size_t size)
+{
+    MutexLockGuard guard(lock);
+
+    MemoryPlanKey key;
+    key.layer_index = layer_index;
+    key.thread = get_omp_thread_num();
+    key.seq = seqs[std::make_pair(key.layer_index, key.thread)]++;
+
+    void* ptr = 0;
+    if (arena)
+    {
+        std::map<MemoryPlanKey, int>::const_iterator it = plan->slots.find(key);
+        if (it != plan->slots.end() && size <= plan->sizes[it->second])
+        {
+            const size_t offset = plan->offsets[it->second];
+            const size_t end = offset + alignSize(plan->sizes[it->second], NCNN_MALLOC_ALIGN);
+
+            // the planned range must not be taken by a block alive longer than planned
+            std::map<size_t, size_t>::const_iterator next = arena_alive.lower_bound(offset);
+            bool overlap = next != arena_alive.end() && next->first < end;
+            if (!overlap && next != arena_alive.begin())
+            {
+                std::map<size_t, size_t>::const_iterator prev = next;
+                --prev;
+                overlap = prev->second > offset;
+            }
+
+            if (!overlap)
+            {
+                ptr = arena + offset;
+                arena_alive[offset] = end;
+            }
+        }
+    }
+
+    if (!ptr)
+    {
+        // not in plan, fall back to heap for this allocation only
+        matched = false;
+
+        ptr = ncnn::fastMalloc(size);
+        if (!ptr)
+            return 0;
+    }
+
+    alive[ptr] = (int)keys.size();
+
+    keys.push_back(key);
+    sizes.push_back(size);
+    alloc_steps.push_back(step);
+    free_steps.push_back(INT_MAX);
+
+    return ptr;
+}
+
+void PlannedAllocator::fastFree(void* ptr)
+{
+    MutexLockGuard guard(lock);
+
+    std::map<void*, int>::iterator it = alive.find(ptr);
+    if (it == alive.end())
+    {
+        NCNN_LOGE("FATAL ERROR! planned allocator get wild %p", ptr);
+        ncnn::fastFree(ptr);
+        return;
+    }
+
+    free_steps[it->second] = step;
+    alive.erase(it);
+
+    if (arena && (unsigned char*)ptr >= arena && (unsigned char*)ptr < arena + plan->arena_size)
+    {
+        arena_alive.erase((unsigned char*)ptr - arena);
+        return;
+    }
+
+    ncnn::fastFree(ptr);
+}
+
+MemoryPlan* PlannedAllocator::recorded_plan()
+{
+    MutexLockGuard guard(lock);
+
+    // a matched run may stop early, keep the plan covering more layers
+    if (keys.empty() || matched)
+        return 0;
+
+    MemoryPlan* recorded = new MemoryPlan;
+    recorded->keys = keys;
+    recorded->sizes = sizes;
+    recorded->alloc_steps = alloc_steps;
+    recorded->free_steps = free_steps;
+    recorded->solve();
+
+    return recorded;
+}
+
+bool PlannedAllocator::rewind()
+{
+    MutexLockGuard guard(lock);
+
+    if (!matched || !alive.empty())
+        return false;
+
+    layer_index = -1;
+    step = 0;
+    seqs.clear();
+
+    keys.clear();
+    sizes.clear();
+    alloc_steps.clear();
+    free_steps.clear();
+
+    matched = arena != 0;
+
+    return true;
+}
+
+// the planned allocator of the extraction running on this thread
+static ThreadLocalStorage tls_planned_allocator;
+
+// count workspace bytes allocated for layer profiling, forwarding to the wrapped allocator
+class ProfileAllocator : public Allocator
+{
+public:
+    ProfileAllocator()
+        : allocator(0), bytes(0)
+    {
+    }
+
+    virtual void* fastMalloc(size_t size)
+    {
+        lock.lock();
+        bytes += size;
+        lock.unlock();
+
+        return allocator ? allocator->fastMalloc(size) : ncnn::fastMalloc(size);
+    }
+
+    virtual void fastFree(void* ptr)
+    {
+        if (allocator)
+            allocator->fastFree(ptr);
+        else
+            ncnn::fastFree(ptr);
+    }
+
+    size_t allocated_bytes()
+    {
+        MutexLockGuard guard(lock);
+        return bytes;
+    }
+
+public:
+    Allocator* allocator;
+
+private:
+    Mutex lock;
+    size_t bytes;
+};
+
+// the profiling extractor on this thread
+struct layer_profiler_context
+{
+    std::vector<LayerProfile>* profiles;
+    ProfileAllocator* workspace_allocator;
+};
+
+static ThreadLocalStorage tls_layer_profiler;
+
+LayerProfile::LayerProfile()
+    : layer_index(-1), typeindex(-1), start(0), end(0), num_threads(0), bytes_allocated(0), kernel("")
+{
+}
+
+// a data-less copy of the mat header
+static Mat profile_blob_shape(const Mat& m)
+{
+    Mat shape;
+    shape.elemsize = m.elemsize;
+    shape.elempack = m.elempack;
+    shape.dims = m.dims;
+    shape.w = m.w;
+    shape.h = m.h;
+    shape.d = m.d;
+    shape.c = m.c;
+    shape.cstep = m.cstep;
+    return shape;
+}
+
+#if NCNN_THREADS
+class ParallelGraphPool;
+#endif // NCNN_THREADS
+
 class NetPrivate
 {
 public:
@@ -50,6 +434,20 @@ public:
 
     friend class Extractor;
     int forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const;
+    int forward_layer_profiled(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, layer_profiler_context* profiler) const;
+
+#if NCNN_THREADS
+    int forward_layer_parallel(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const;
+#endif // NCNN_THREADS
+
+    // the thread count the layer got in create_pipeline
+    int layer_num_threads(int layer_index, const Option& opt) const;
+
+    // batch_blob_mats[i] holds the blobs of sample i
+    int forward_layer_batch(int layer_index, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const;
+    int batch_stack_type(const Layer* layer) const;
+    int do_forward_layer_batch_rows(const Layer* layer, int num_input, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const;
+    int do_forward_layer_batch_height(const Layer* layer, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const;
 
 #if NCNN_VULKAN
     int forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
@@ -57,6 +455,10 @@ public:
 
     int convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const;
 
+#if NCNN_STDIO
+    int tune_layer(Layer* layer, const std::vector<int>& variants, const Option& opt) const;
+#endif // NCNN_STDIO
+
     int do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt) const;
 #if NCNN_VULKAN
     int do_forward_layer(const Layer* layer, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
@@ -66,10 +468,18 @@ public:
 #if NCNN_STRING
     void update_input_output_names();
 #endif // NCNN_STRING
+    void update_layer_graph();
 
     std::vector<Blob> blobs;
     std::vector<Layer*> layers;
 
+    // layer indexes consuming each blob, one entry per bottom reference
+    std::vector<std::vector<int> > blob_consumers;
+    // every blob is consumed at most once, as split layers are inserted by converters
+    bool blob_consumed_once;
+    // count of layers at the same graph depth, the thread share of parallel graph is num_threads / width
+    std::vector<int> layer_graph_width;
+
     std::vector<int> input_blob_indexes;
     std::vector<int> output_blob_indexes;
 #if NCNN_STRING
@@ -83,6 +493,27 @@ public:
     PoolAllocator* local_blob_allocator;
     PoolAllocator* local_workspace_allocator;
 
+#if NCNN_STDIO
+    // file mapping referenced by weight data
+    DataReaderFromMmap* model_mmap;
+
+    // transformed weight cache file, empty for disabled
+    std::string weight_cache_path;
+
+    // kernel tuning file, empty for disabled
+    std::string tuning_path;
+#endif // NCNN_STDIO
+
+    // static memory plan shared by extractors
+    Mutex memory_plan_lock;
+    MemoryPlan* memory_plan;
+
+#if NCNN_THREADS
+    // workers of parallel graph, created on first use
+    mutable Mutex parallel_graph_pool_lock;
+    mutable ParallelGraphPool* parallel_graph_pool;
+#endif // NCNN_THREADS
+
 #if NCNN_VULKAN
     const VulkanDevice* vkdev;
 
@@ -99,6 +530,18 @@ NetPrivate::NetPrivate(Option& _opt)
     local_blob_allocator = 0;
     local_workspace_allocator = 0;
 
+    blob_consumed_once = true;
+
+#if NCNN_STDIO
+    model_mmap = 0;
+#endif // NCNN_STDIO
+
+    memory_plan = 0;
+
+#if NCNN_THREADS
+    parallel_graph_pool = 0;
+#endif // NCNN_THREADS
+
 #if NCNN_VULKAN
     vkdev = 0;
     weight_vkallocator = 0;
@@ -168,6 +611,20 @@ int NetPrivate::upload_model()
 }
 #endif // NCNN_VULKAN
 
+int NetPrivate::layer_num_threads(int layer_index, const Option& _opt) const
+{
+#if NCNN_THREADS
+    // parallel graph gives each layer a fixed share from the graph width
+    // serial runs use the same share, so that prepacked kernels keep their thread layout
+    if (opt.use_parallel_graph && layer_index < (int)layer_graph_width.size())
+        return std::max(_opt.num_threads / layer_graph_width[layer_index], 1);
+#else
+    (void)layer_index;
+#endif // NCNN_THREADS
+
+    return _opt.num_threads;
+}
+
 int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const
 {
     const Layer* layer = layers[layer_index];
@@ -181,6 +638,10 @@ int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, cons
 
         if (blob_mats[bottom_blob_index].dims == 0)
         {
+            // input left empty on purpose, such as the kv cache before the first step
+            if (layers[blobs[bottom_blob_index].producer]->typeindex == LayerType::Input)
+                continue;
+
             int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, opt);
             if (ret != 0)
                 return ret;
@@ -202,15 +663,30 @@ int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, cons
         bottom_blob.elemsize = blob_mats[bottom_blob_index].elemsize;
     }
 #endif
+    Option opt1 = opt;
+    opt1.num_threads = layer_num_threads(layer_index, opt);
+
+    PlannedAllocator* planned_allocator = (PlannedAllocator*)tls_planned_allocator.get();
+    if (planned_allocator)
+        planned_allocator->enter_layer(layer_index);
+
     int ret = 0;
-    if (layer->featmask)
+    layer_profiler_context* profiler = (layer_profiler_context*)tls_layer_profiler.get();
+    if (profiler)
+    {
+        ret = forward_layer_profiled(layer_index, blob_mats, opt1, profiler);
+    }
+    else if (layer->featmask)
     {
-        ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
+        ret = do_forward_layer(layer, blob_mats, get_masked_option(opt1, layer->featmask));
     }
     else
     {
-        ret = do_forward_layer(layer, blob_mats, opt);
+        ret = do_forward_layer(layer, blob_mats, opt1);
     }
+
+    if (planned_allocator)
+        planned_allocator->enter_layer(-1);
 #if NCNN_BENCHMARK
     double end = get_current_time();
     if (layer->one_blob_only)
@@ -233,778 +709,1822 @@ int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, cons
     return 0;
 }
 
-#if NCNN_VULKAN
-int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
+int NetPrivate::forward_layer_profiled(int layer_index, std::vector<Mat>& blob_mats, const Option& _opt, layer_profiler_context* profiler) const
 {
     const Layer* layer = layers[layer_index];
 
-    //     NCNN_LOGE("forward_layer %d %d %s", layer->support_vulkan, layer_index, layer->name.c_str());
+    Option opt = layer->featmask ? get_masked_option(_opt, layer->featmask) : _opt;
+    profiler->workspace_allocator->allocator = opt.workspace_allocator;
+    opt.workspace_allocator = profiler->workspace_allocator;
 
-    bool cmd_submit_and_wait = false;
+    LayerProfile profile;
+    profile.layer_index = layer_index;
+    profile.typeindex = layer->typeindex;
+#if NCNN_STRING
+    profile.type = layer->type;
+    profile.name = layer->name;
+#endif // NCNN_STRING
+    profile.num_threads = opt.num_threads;
 
-    // load bottom blobs
+    // bottom blobs may be released in light mode, take the shapes beforehand
+    profile.bottom_shapes.resize(layer->bottoms.size());
+    std::vector<const void*> bottom_datas(layer->bottoms.size());
     for (size_t i = 0; i < layer->bottoms.size(); i++)
     {
-        int bottom_blob_index = layer->bottoms[i];
+        profile.bottom_shapes[i] = profile_blob_shape(blob_mats[layer->bottoms[i]]);
+        bottom_datas[i] = blob_mats[layer->bottoms[i]].data;
+    }
 
-        if (blob_mats_gpu[bottom_blob_index].dims == 0 && blob_mats[bottom_blob_index].dims == 0)
-        {
-            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, blob_mats_gpu, cmd, opt);
-            if (ret != 0)
-                return ret;
-        }
+    const size_t workspace_bytes = profiler->workspace_allocator->allocated_bytes();
 
-        if (layer->support_vulkan)
-        {
-            if (blob_mats_gpu[bottom_blob_index].dims == 0)
-            {
-                // host to buffer
-                cmd.record_upload(blob_mats[bottom_blob_index], blob_mats_gpu[bottom_blob_index], opt);
+    set_profile_kernel_slot(&profile.kernel);
 
-                if (opt.lightmode)
-                {
-                    // delete after taken in light mode
-                    blob_mats[bottom_blob_index].release();
-                }
-            }
-        }
-        else
-        {
-            if (blob_mats[bottom_blob_index].dims == 0)
-            {
-                Option opt_download = opt;
-                opt_download.use_packing_layout = layer->support_packing;
+    profile.start = get_current_time();
+    int ret = do_forward_layer(layer, blob_mats, opt);
+    profile.end = get_current_time();
 
-                // buffer to host
-                cmd.record_download(blob_mats_gpu[bottom_blob_index], blob_mats[bottom_blob_index], opt_download);
+    set_profile_kernel_slot(0);
 
-                if (opt.lightmode)
-                {
-                    // delete after taken in light mode
-                    blob_mats_gpu[bottom_blob_index].release();
-                }
+    if (ret != 0)
+        return ret;
 
-                cmd_submit_and_wait = true;
-            }
-        }
-    }
+    profile.bytes_allocated = profiler->workspace_allocator->allocated_bytes() - workspace_bytes;
 
-    int ret;
-    if (cmd_submit_and_wait)
+    profile.top_shapes.resize(layer->tops.size());
+    for (size_t i = 0; i < layer->tops.size(); i++)
     {
-        ret = cmd.submit_and_wait();
+        const Mat& top_blob = blob_mats[layer->tops[i]];
+        profile.top_shapes[i] = profile_blob_shape(top_blob);
 
-#if NCNN_BENCHMARK
-        std::vector<uint64_t> results(layer_index * 2);
-        cmd.get_query_pool_results(0, layer_index * 2, results);
-        for (int i = 0; i < layer_index; i++)
-        {
-            uint64_t start = results[i * 2];
-            uint64_t end = results[i * 2 + 1];
-            if (start == 0 || end == 0)
-                continue;
+        // inplace and shared tops allocate nothing
+        if (std::find(bottom_datas.begin(), bottom_datas.end(), (const void*)top_blob.data) == bottom_datas.end())
+            profile.bytes_allocated += top_blob.total() * top_blob.elemsize;
+    }
 
-            double duration_us = (end - start) * vkdev->info.timestamp_period() / 1000;
-            NCNN_LOGE("%-24s %-30s %8.2lfus    |", layers[i]->type.c_str(), layers[i]->name.c_str(), duration_us);
-        }
-#endif // NCNN_BENCHMARK
+    profiler->profiles->push_back(profile);
 
-        cmd.reset();
-        if (ret != 0)
-            return ret;
-    }
+    return 0;
+}
 
-    if (layer->support_vulkan)
+#if NCNN_THREADS
+struct parallel_graph_context
+{
+    std::vector<Mat>* blob_mats;
+    const Option* opt;
+
+    // at most this many layers of the run execute at once, the calling thread included
+    int num_workers;
+    int running;
+
+    // count of bottom blobs not produced yet for each scheduled layer
+    std::vector<int> pending;
+    // blob is produced by a scheduled layer
+    std::vector<char> awaited;
+    std::vector<int> ready;
+    int remaining;
+    int ret;
+};
+
+// persistent workers owned by the net, shared by all extractors running the parallel graph
+class ParallelGraphPool
+{
+public:
+    ParallelGraphPool(const NetPrivate* _net);
+    ~ParallelGraphPool();
+
+    // spawn workers up to count
+    void reserve(int count);
+
+    // schedule the run and work on it with the calling thread until it finishes
+    int run(parallel_graph_context* ctx);
+
+protected:
+    static void* worker(void* args);
+
+    // pick one ready layer from ctx, run it and release its consumers, called with lock held
+    void run_one(parallel_graph_context* ctx);
+
+    static bool runnable(const parallel_graph_context* ctx)
     {
-#if NCNN_BENCHMARK
-        cmd.record_write_timestamp(layer_index * 2);
-#endif
-        if (layer->featmask)
+        return !ctx->ready.empty() && ctx->ret == 0 && ctx->running < ctx->num_workers;
+    }
+
+    const NetPrivate* net;
+
+    Mutex lock;
+    ConditionVariable cond;
+    std::vector<parallel_graph_context*> jobs;
+    std::vector<Thread*> workers;
+    bool stop;
+};
+
+ParallelGraphPool::ParallelGraphPool(const NetPrivate* _net)
+    : net(_net), stop(false)
+{
+}
+
+ParallelGraphPool::~ParallelGraphPool()
+{
+    lock.lock();
+    stop = true;
+    cond.broadcast();
+    lock.unlock();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+}
+
+void ParallelGraphPool::reserve(int count)
+{
+    MutexLockGuard guard(lock);
+
+    while ((int)workers.size() < count)
+    {
+        workers.push_back(new Thread(worker, (void*)this));
+    }
+}
+
+void* ParallelGraphPool::worker(void* args)
+{
+    ParallelGraphPool* pool = (ParallelGraphPool*)args;
+
+    pool->lock.lock();
+    while (!pool->stop)
+    {
+        parallel_graph_context* ctx = 0;
+        for (size_t i = 0; i < pool->jobs.size(); i++)
         {
-            ret = do_forward_layer(layer, blob_mats_gpu, cmd, get_masked_option(opt, layer->featmask));
+            if (runnable(pool->jobs[i]))
+            {
+                ctx = pool->jobs[i];
+                break;
+            }
         }
-        else
+
+        if (!ctx)
         {
-            ret = do_forward_layer(layer, blob_mats_gpu, cmd, opt);
+            pool->cond.wait(pool->lock);
+            continue;
         }
-#if NCNN_BENCHMARK
-        cmd.record_write_timestamp(layer_index * 2 + 1);
-#endif
+
+        pool->run_one(ctx);
+    }
+    pool->lock.unlock();
+
+    return 0;
+}
+
+void ParallelGraphPool::run_one(parallel_graph_context* ctx)
+{
+    int layer_index = ctx->ready.back();
+    ctx->ready.pop_back();
+    ctx->running++;
+
+    lock.unlock();
+
+    const Option& opt = *ctx->opt;
+
+    // workers are shared across runs, take the floating point and thread pool settings of this one
+    set_flush_denormals(opt.flush_denormals);
+
+    ThreadPool* old_thread_pool = get_current_thread_pool();
+    if (opt.thread_pool != old_thread_pool)
+        set_current_thread_pool(opt.thread_pool);
+
+    const Layer* layer = net->layers[layer_index];
+
+    Option opt1 = opt;
+    opt1.num_threads = net->layer_num_threads(layer_index, opt);
+
+    int ret = 0;
+    if (layer->featmask)
+    {
+        ret = net->do_forward_layer(layer, *ctx->blob_mats, get_masked_option(opt1, layer->featmask));
     }
     else
     {
-#if NCNN_BENCHMARK
-        double start = get_current_time();
-        Mat bottom_blob;
-        if (layer->one_blob_only)
+        ret = net->do_forward_layer(layer, *ctx->blob_mats, opt1);
+    }
+
+    lock.lock();
+
+    ctx->running--;
+    ctx->remaining--;
+
+    if (ret != 0)
+    {
+        ctx->ret = ret;
+    }
+    else
+    {
+        // release consumers whose bottom blobs are all ready
+        for (size_t i = 0; i < layer->tops.size(); i++)
         {
-            int bottom_blob_index = layer->bottoms[0];
-            bottom_blob = blob_mats[bottom_blob_index].shape();
+            int top_blob_index = layer->tops[i];
+            if (!ctx->awaited[top_blob_index])
+                continue;
+
+            const std::vector<int>& consumers = net->blob_consumers[top_blob_index];
+            for (size_t j = 0; j < consumers.size(); j++)
+            {
+                int consumer = consumers[j];
+                if (ctx->pending[consumer] > 0 && --ctx->pending[consumer] == 0)
+                {
+                    ctx->ready.push_back(consumer);
+                }
+            }
         }
-#endif
-        if (layer->featmask)
+    }
+
+    cond.broadcast();
+}
+
+int ParallelGraphPool::run(parallel_graph_context* ctx)
+{
+    lock.lock();
+
+    jobs.push_back(ctx);
+    cond.broadcast();
+
+    // the calling thread only works on its own run, and leaves when no layer of it is in flight
+    for (;;)
+    {
+        if (runnable(ctx))
         {
-            ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
+            run_one(ctx);
+            continue;
         }
-        else
+
+        if ((ctx->remaining == 0 || ctx->ret != 0 || ctx->ready.empty()) && ctx->running == 0)
+            break;
+
+        cond.wait(lock);
+    }
+
+    jobs.erase(std::find(jobs.begin(), jobs.end(), ctx));
+
+    lock.unlock();
+
+    return ctx->ret;
+}
+
+int NetPrivate::forward_layer_parallel(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const
+{
+    parallel_graph_context ctx;
+    ctx.blob_mats = &blob_mats;
+    ctx.opt = &opt;
+    ctx.running = 0;
+    ctx.pending.resize(layers.size(), -1);
+    ctx.awaited.resize(blobs.size(), 0);
+    ctx.remaining = 0;
+    ctx.ret = 0;
+
+    // collect the layers required for producing the wanted blob
+    std::vector<int> stack;
+    stack.push_back(layer_index);
+    ctx.pending[layer_index] = 0;
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        ctx.remaining++;
+
+        const Layer* layer = layers[index];
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
         {
-            ret = do_forward_layer(layer, blob_mats, opt);
+            int bottom_blob_index = layer->bottoms[i];
+            if (blob_mats[bottom_blob_index].dims != 0)
+                continue;
+
+            if (layers[blobs[bottom_blob_index].producer]->typeindex == LayerType::Input)
+                continue;
+
+            ctx.pending[index]++;
+            ctx.awaited[bottom_blob_index] = 1;
+
+            int producer = blobs[bottom_blob_index].producer;
+            if (ctx.pending[producer] == -1)
+            {
+                ctx.pending[producer] = 0;
+                stack.push_back(producer);
+            }
         }
-#if NCNN_BENCHMARK
-        double end = get_current_time();
-        if (layer->one_blob_only)
+    }
+
+    // graph width bound, every source and every extra fork may start a concurrent path
+    int max_concurrency = 0;
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (ctx.pending[i] == -1)
+            continue;
+
+        if (ctx.pending[i] == 0)
         {
-            int top_blob_index = layer->tops[0];
-            benchmark(layer, bottom_blob, blob_mats[top_blob_index], start, end);
+            ctx.ready.push_back((int)i);
+            max_concurrency++;
         }
-        else
+
+        int forks = 0;
+        const Layer* layer = layers[i];
+        for (size_t j = 0; j < layer->tops.size(); j++)
         {
-            benchmark(layer, start, end);
+            if (ctx.awaited[layer->tops[j]])
+                forks += (int)blob_consumers[layer->tops[j]].size();
         }
-#endif
+        max_concurrency += std::max(forks - 1, 0);
     }
-    if (ret != 0)
-        return ret;
 
-    //     NCNN_LOGE("forward_layer %d %d %s done", layer->support_vulkan, layer_index, layer->name.c_str());
+    ctx.num_workers = std::min(opt.num_threads, max_concurrency);
 
-    return 0;
+    if (ctx.num_workers <= 1)
+        return forward_layer(layer_index, blob_mats, opt);
+
+    {
+        MutexLockGuard guard(parallel_graph_pool_lock);
+        if (!parallel_graph_pool)
+            parallel_graph_pool = new ParallelGraphPool(this);
+    }
+
+    // the calling thread works too
+    parallel_graph_pool->reserve(ctx.num_workers - 1);
+
+    return parallel_graph_pool->run(&ctx);
 }
-#endif // NCNN_VULKAN
+#endif // NCNN_THREADS
 
-int NetPrivate::convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const
+int NetPrivate::forward_layer_batch(int layer_index, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const
 {
-    if (bottom_blob.elembits() == 32)
+    const Layer* layer = layers[layer_index];
+
+    // load bottom blobs, all samples advance layer by layer together
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
     {
-        // clang-format off
-        // *INDENT-OFF*
+        int bottom_blob_index = layer->bottoms[i];
 
-#if NCNN_ARM82
-        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && layer->support_fp16_storage)
+        if (batch_blob_mats[0][bottom_blob_index].dims == 0)
         {
-            Mat bottom_blob_fp16;
-            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
-            bottom_blob = bottom_blob_fp16;
+            int ret = forward_layer_batch(blobs[bottom_blob_index].producer, batch_blob_mats, opt);
+            if (ret != 0)
+                return ret;
         }
-        else
-#endif // NCNN_ARM82
-#if NCNN_VFPV4
-        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && layer->support_fp16_storage)
+    }
+
+    Option opt1 = opt;
+    opt1.num_threads = layer_num_threads(layer_index, opt);
+    if (layer->featmask)
+    {
+        opt1 = get_masked_option(opt1, layer->featmask);
+    }
+
+    const int batch = (int)batch_blob_mats.size();
+
+    int stack_type = batch > 1 ? batch_stack_type(layer) : 0;
+
+    int num_input = 0;
+    if (stack_type == 1)
+    {
+        // samples become rows of one matrix, weights are streamed once for the whole batch
+        if (layer->typeindex == LayerType::InnerProduct)
         {
-            Mat bottom_blob_fp16;
-            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
-            bottom_blob = bottom_blob_fp16;
+            const InnerProduct* innerproduct = (const InnerProduct*)layer;
+            num_input = innerproduct->weight_data_size / innerproduct->num_output;
         }
-        else
-#endif // NCNN_VFPV4
-#if NCNN_ZFH
-        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && layer->support_fp16_storage)
+        else // if (layer->typeindex == LayerType::Gemm)
         {
-            Mat bottom_blob_fp16;
-            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
-            bottom_blob = bottom_blob_fp16;
+            num_input = ((const Gemm*)layer)->constantK;
         }
-        else
-#endif // NCNN_ZFH
-#if NCNN_BF16
-        if (opt.use_bf16_storage && layer->support_bf16_storage)
+
+        for (int b = 0; b < batch; b++)
         {
-            Mat bottom_blob_bf16;
-            cast_float32_to_bfloat16(bottom_blob, bottom_blob_bf16, opt);
-            bottom_blob = bottom_blob_bf16;
+            const Mat& m = batch_blob_mats[b][layer->bottoms[0]];
+            if (m.elembits() != 32)
+            {
+                stack_type = 0;
+                break;
+            }
+
+            if (m.dims == 2 && m.w == num_input)
+                continue;
+
+            // innerproduct flattens other shapes
+            if (layer->typeindex == LayerType::InnerProduct && m.w * m.h * m.d * m.c * m.elempack == num_input)
+                continue;
+
+            stack_type = 0;
+            break;
         }
-        else
-#endif // NCNN_BF16
+    }
+
+    if (stack_type == 2)
+    {
+        // 1x1 convolution is pointwise, samples of the same width and channels can be stacked along height
+        const Mat& m0 = batch_blob_mats[0][layer->bottoms[0]];
+        for (int b = 0; b < batch; b++)
         {
+            const Mat& m = batch_blob_mats[b][layer->bottoms[0]];
+            if (m.dims != 3 || m.w != m0.w || m.c != m0.c || m.elempack != m0.elempack || m.elemsize != m0.elemsize)
+            {
+                stack_type = 0;
+                break;
+            }
         }
+    }
 
-        // *INDENT-ON*
-        // clang-format on
+    if (stack_type == 1)
+        return do_forward_layer_batch_rows(layer, num_input, batch_blob_mats, opt1);
 
-        if (bottom_blob.empty())
-            return -100;
+    if (stack_type == 2)
+        return do_forward_layer_batch_height(layer, batch_blob_mats, opt1);
+
+    for (int b = 0; b < batch; b++)
+    {
+        int ret = do_forward_layer(layer, batch_blob_mats[b], opt1);
+        if (ret != 0)
+            return ret;
     }
 
-    int dst_elempack = 1;
-    if (opt.use_packing_layout)
+    return 0;
+}
+
+int NetPrivate::batch_stack_type(const Layer* layer) const
+{
+    // 0 = forward each sample
+    // 1 = stack samples as matrix rows
+    // 2 = stack samples along height
+    if (!layer->one_blob_only)
+        return 0;
+
+    // overwritten layers are not the builtin classes
+    for (size_t i = 0; i < overwrite_builtin_layer_registry.size(); i++)
     {
-        // resolve dst_elempack
-        int dims = bottom_blob.dims;
-        int elemcount = 0;
-        if (dims == 1) elemcount = bottom_blob.elempack * bottom_blob.w;
-        if (dims == 2) elemcount = bottom_blob.elempack * bottom_blob.h;
-        if (dims == 3 || dims == 4) elemcount = bottom_blob.elempack * bottom_blob.c;
+        if (overwrite_builtin_layer_registry[i].typeindex == layer->typeindex)
+            return 0;
+    }
 
-        int elembits = bottom_blob.elembits();
+    if (layer->typeindex == LayerType::InnerProduct)
+    {
+        const InnerProduct* innerproduct = (const InnerProduct*)layer;
+        if (innerproduct->int8_scale_term == 0)
+            return 1;
+    }
 
-        if (layer->support_packing)
-        {
-            if (elembits == 32)
-            {
-#if NCNN_AVX512
-                if (elemcount % 16 == 0 && ncnn::cpu_support_x86_avx512())
-                    dst_elempack = 16;
-                else if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
-                    dst_elempack = 8;
-                else if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#elif NCNN_AVX
-                if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
-                    dst_elempack = 8;
-                else if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#elif NCNN_RVV || NCNN_XTHEADVECTOR
-                const int packn = ncnn::cpu_riscv_vlenb() / 4;
-                if (elemcount % packn == 0)
-                    dst_elempack = packn;
-#else
-                if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#endif
-            }
-            if (elembits == 16)
-            {
-#if NCNN_ARM82
-                if (elemcount % 8 == 0 && ncnn::cpu_support_arm_asimdhp() && opt.use_fp16_arithmetic && layer->support_fp16_storage)
-                    dst_elempack = 8;
-                else if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#elif NCNN_RVV || NCNN_XTHEADVECTOR
-                const int packn = ncnn::cpu_riscv_vlenb() / 2;
-                if (elemcount % packn == 0)
-                    dst_elempack = packn;
-#else
-                if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#endif
-            }
-            if (elembits == 8)
-            {
-#if NCNN_RVV || NCNN_XTHEADVECTOR
-                const int packn = ncnn::cpu_riscv_vlenb() / 1;
-                if (elemcount % packn == 0)
-                    dst_elempack = packn;
-#else
-                if (elemcount % 8 == 0)
-                    dst_elempack = 8;
-#endif
-            }
-        }
+    if (layer->typeindex == LayerType::Gemm)
+    {
+        const Gemm* gemm = (const Gemm*)layer;
+
+        // rows of A map to rows of output, C must not vary along M
+        int broadcast_type_C = gemm->constant_broadcast_type_C;
+        if (gemm->constantA == 0 && gemm->constantB == 1 && gemm->transA == 0 && gemm->output_N1M == 0 && gemm->output_transpose == 0 && gemm->int8_scale_term == 0
+                && (broadcast_type_C == -1 || broadcast_type_C == 0 || broadcast_type_C == 4))
+            return 1;
     }
 
-    if (bottom_blob.elempack != dst_elempack)
+    if (layer->typeindex == LayerType::Convolution)
     {
-        Mat bottom_blob_packed;
-        convert_packing(bottom_blob, bottom_blob_packed, dst_elempack, opt);
-        bottom_blob = bottom_blob_packed;
+        const Convolution* convolution = (const Convolution*)layer;
 
-        if (bottom_blob.empty())
-            return -100;
+        bool no_padding = convolution->pad_left == -233 || convolution->pad_left == -234 || (convolution->pad_left == 0 && convolution->pad_right == 0 && convolution->pad_top == 0 && convolution->pad_bottom == 0);
+        if (convolution->kernel_w == 1 && convolution->kernel_h == 1 && convolution->stride_w == 1 && convolution->stride_h == 1 && convolution->dynamic_weight == 0 && no_padding)
+            return 2;
     }
 
-    if (bottom_blob.elembits() == 16)
+    return 0;
+}
+
+int NetPrivate::do_forward_layer_batch_rows(const Layer* layer, int num_input, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const
+{
+    const int batch = (int)batch_blob_mats.size();
+    const int bottom_blob_index = layer->bottoms[0];
+    const int top_blob_index = layer->tops[0];
+
+    Option opt_ws = opt;
+    opt_ws.blob_allocator = opt.workspace_allocator;
+
+    std::vector<int> rows(batch);
+    std::vector<int> flattened(batch);
+    int total_rows = 0;
+    for (int b = 0; b < batch; b++)
     {
-        // clang-format off
-        // *INDENT-OFF*
+        const Mat& m = batch_blob_mats[b][bottom_blob_index];
 
-#if NCNN_ARM82
-        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && !layer->support_fp16_storage)
-        {
-            Mat bottom_blob_fp32;
-            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
-        }
-        else
-#endif // NCNN_ARM82
-#if NCNN_VFPV4
-        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && !layer->support_fp16_storage)
-        {
-            Mat bottom_blob_fp32;
-            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
-        }
-        else
-#endif // NCNN_VFPV4
-#if NCNN_ZFH
-        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && !layer->support_fp16_storage)
+        // 2d input of num_input width is already a matrix, otherwise one flattened row
+        flattened[b] = (m.dims == 2 && m.w == num_input) ? 0 : 1;
+        rows[b] = flattened[b] ? 1 : m.h * m.elempack;
+        total_rows += rows[b];
+    }
+
+    Mat bottom_blob(num_input, total_rows, 4u, 1, opt.workspace_allocator);
+    if (bottom_blob.empty())
+        return -100;
+
+    int row_offset = 0;
+    for (int b = 0; b < batch; b++)
+    {
+        Mat m = batch_blob_mats[b][bottom_blob_index];
+
+        if (m.elempack != 1)
         {
-            Mat bottom_blob_fp32;
-            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
+            Mat m_unpacked;
+            convert_packing(m, m_unpacked, 1, opt_ws);
+            m = m_unpacked;
+            if (m.empty())
+                return -100;
         }
-        else
-#endif // NCNN_ZFH
-#if NCNN_BF16
-        if (opt.use_bf16_storage && !layer->support_bf16_storage)
+
+        if (flattened[b])
         {
-            Mat bottom_blob_fp32;
-            cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-            bottom_blob = bottom_blob_fp32;
+            m = m.reshape(num_input, opt.workspace_allocator);
+            if (m.empty())
+                return -100;
         }
-        else
-#endif // NCNN_BF16
+
+        memcpy(bottom_blob.row(row_offset), m.data, (size_t)num_input * rows[b] * sizeof(float));
+        row_offset += rows[b];
+
+        if (opt.lightmode)
         {
+            // delete after taken in light mode
+            batch_blob_mats[b][bottom_blob_index].release();
         }
+    }
 
-        // *INDENT-ON*
-        // clang-format on
+    int ret = convert_layout(bottom_blob, layer, opt);
+    if (ret != 0)
+        return ret;
 
-        if (bottom_blob.empty())
+    Mat top_blob;
+    ret = layer->forward(bottom_blob, top_blob, opt);
+    if (ret != 0)
+        return ret;
+
+    bottom_blob.release();
+
+    if (top_blob.elempack != 1)
+    {
+        Mat top_blob_unpacked;
+        convert_packing(top_blob, top_blob_unpacked, 1, opt_ws);
+        top_blob = top_blob_unpacked;
+        if (top_blob.empty())
+            return -100;
+    }
+
+    const int num_output = top_blob.w;
+    const size_t elemsize = top_blob.elemsize;
+
+    row_offset = 0;
+    for (int b = 0; b < batch; b++)
+    {
+        Mat top;
+        if (flattened[b])
+            top.create(num_output, elemsize, opt.blob_allocator);
+        else
+            top.create(num_output, rows[b], elemsize, opt.blob_allocator);
+        if (top.empty())
             return -100;
+
+        memcpy(top.data, (const unsigned char*)top_blob.data + num_output * row_offset * elemsize, num_output * rows[b] * elemsize);
+        row_offset += rows[b];
+
+        // store top blob
+        batch_blob_mats[b][top_blob_index] = top;
     }
 
     return 0;
 }
 
-int NetPrivate::do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt) const
+int NetPrivate::do_forward_layer_batch_height(const Layer* layer, std::vector<std::vector<Mat> >& batch_blob_mats, const Option& opt) const
 {
-    if (layer->one_blob_only)
+    const int batch = (int)batch_blob_mats.size();
+    const int bottom_blob_index = layer->bottoms[0];
+    const int top_blob_index = layer->tops[0];
+
+    std::vector<Mat> bottom_blobs(batch);
+    std::vector<int> heights(batch);
+    int total_h = 0;
+    for (int b = 0; b < batch; b++)
     {
-        int bottom_blob_index = layer->bottoms[0];
-        int top_blob_index = layer->tops[0];
+        bottom_blobs[b] = batch_blob_mats[b][bottom_blob_index];
 
-        Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
-        Mat bottom_blob;
+        int ret = convert_layout(bottom_blobs[b], layer, opt);
+        if (ret != 0)
+            return ret;
 
         if (opt.lightmode)
         {
-            // deep copy for inplace forward if data is shared
-            if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
-            {
-                bottom_blob = bottom_blob_ref.clone(opt.blob_allocator);
-                if (bottom_blob.empty())
-                    return -100;
-            }
+            // delete after taken in light mode
+            batch_blob_mats[b][bottom_blob_index].release();
         }
-        if (bottom_blob.dims == 0)
+
+        heights[b] = bottom_blobs[b].h;
+        total_h += heights[b];
+    }
+
+    const int w = bottom_blobs[0].w;
+    const int channels = bottom_blobs[0].c;
+    const size_t elemsize = bottom_blobs[0].elemsize;
+    const int elempack = bottom_blobs[0].elempack;
+
+    Mat bottom_blob(w, total_h, channels, elemsize, elempack, opt.workspace_allocator);
+    if (bottom_blob.empty())
+        return -100;
+
+    for (int q = 0; q < channels; q++)
+    {
+        unsigned char* outptr = bottom_blob.channel(q);
+        for (int b = 0; b < batch; b++)
         {
-            bottom_blob = bottom_blob_ref;
+            const size_t size = (size_t)w * heights[b] * elemsize;
+            memcpy(outptr, bottom_blobs[b].channel(q), size);
+            outptr += size;
         }
+    }
 
-        int ret = convert_layout(bottom_blob, layer, opt);
-        if (ret != 0)
-            return ret;
+    bottom_blobs.clear();
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
-        {
-            Mat& bottom_top_blob = bottom_blob;
-            int ret = layer->forward_inplace(bottom_top_blob, opt);
-            if (ret != 0)
-                return ret;
+    Mat top_blob;
+    int ret = layer->forward(bottom_blob, top_blob, opt);
+    if (ret != 0)
+        return ret;
 
-            // store top blob
-            blob_mats[top_blob_index] = bottom_top_blob;
-        }
-        else
-        {
-            Mat top_blob;
-            int ret = layer->forward(bottom_blob, top_blob, opt);
-            if (ret != 0)
-                return ret;
+    bottom_blob.release();
 
-            // store top blob
-            blob_mats[top_blob_index] = top_blob;
-        }
+    const int outw = top_blob.w;
+    const int out_channels = top_blob.c;
+    const size_t out_elemsize = top_blob.elemsize;
+    const int out_elempack = top_blob.elempack;
 
-        if (opt.lightmode)
+    std::vector<Mat> top_blobs(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs[b].create(outw, heights[b], out_channels, out_elemsize, out_elempack, opt.blob_allocator);
+        if (top_blobs[b].empty())
+            return -100;
+    }
+
+    for (int q = 0; q < out_channels; q++)
+    {
+        const unsigned char* ptr = top_blob.channel(q);
+        for (int b = 0; b < batch; b++)
         {
-            // delete after taken in light mode
-            blob_mats[bottom_blob_index].release();
+            const size_t size = (size_t)outw * heights[b] * out_elemsize;
+            memcpy(top_blobs[b].channel(q), ptr, size);
+            ptr += size;
         }
     }
-    else
+
+    for (int b = 0; b < batch; b++)
     {
-        std::vector<Mat> bottom_blobs(layer->bottoms.size());
-        for (size_t i = 0; i < layer->bottoms.size(); i++)
-        {
-            int bottom_blob_index = layer->bottoms[i];
+        // store top blob
+        batch_blob_mats[b][top_blob_index] = top_blobs[b];
+    }
 
-            Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
-            bottom_blobs[i].release();
+    return 0;
+}
 
-            if (opt.lightmode)
-            {
-                // deep copy for inplace forward if data is shared
-                if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
-                {
-                    bottom_blobs[i] = bottom_blob_ref.clone(opt.blob_allocator);
-                    if (bottom_blobs[i].empty())
-                        return -100;
-                }
-            }
-            if (bottom_blobs[i].dims == 0)
-            {
-                bottom_blobs[i] = bottom_blob_ref;
-            }
+#if NCNN_VULKAN
+int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
 
-            int ret = convert_layout(bottom_blobs[i], layer, opt);
-            if (ret != 0)
-                return ret;
-        }
+    //     NCNN_LOGE("forward_layer %d %d %s", layer->support_vulkan, layer_index, layer->name.c_str());
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
+    bool cmd_submit_and_wait = false;
+
+    // load bottom blobs
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (blob_mats_gpu[bottom_blob_index].dims == 0 && blob_mats[bottom_blob_index].dims == 0)
         {
-            std::vector<Mat>& bottom_top_blobs = bottom_blobs;
-            int ret = layer->forward_inplace(bottom_top_blobs, opt);
+            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, blob_mats_gpu, cmd, opt);
             if (ret != 0)
                 return ret;
+        }
 
-            // store top blobs
-            for (size_t i = 0; i < layer->tops.size(); i++)
+        if (layer->support_vulkan)
+        {
+            if (blob_mats_gpu[bottom_blob_index].dims == 0)
             {
-                int top_blob_index = layer->tops[i];
+                // host to buffer
+                cmd.record_upload(blob_mats[bottom_blob_index], blob_mats_gpu[bottom_blob_index], opt);
 
-                blob_mats[top_blob_index] = bottom_top_blobs[i];
+                if (opt.lightmode)
+                {
+                    // delete after taken in light mode
+                    blob_mats[bottom_blob_index].release();
+                }
             }
         }
         else
         {
-            std::vector<Mat> top_blobs(layer->tops.size());
-            int ret = layer->forward(bottom_blobs, top_blobs, opt);
-            if (ret != 0)
-                return ret;
-
-            // store top blobs
-            for (size_t i = 0; i < layer->tops.size(); i++)
+            if (blob_mats[bottom_blob_index].dims == 0)
             {
-                int top_blob_index = layer->tops[i];
+                Option opt_download = opt;
+                opt_download.use_packing_layout = layer->support_packing;
 
-                blob_mats[top_blob_index] = top_blobs[i];
+                // buffer to host
+                cmd.record_download(blob_mats_gpu[bottom_blob_index], blob_mats[bottom_blob_index], opt_download);
+
+                if (opt.lightmode)
+                {
+                    // delete after taken in light mode
+                    blob_mats_gpu[bottom_blob_index].release();
+                }
+
+                cmd_submit_and_wait = true;
             }
         }
+    }
 
-        if (opt.lightmode)
-        {
-            for (size_t i = 0; i < layer->bottoms.size(); i++)
-            {
-                int bottom_blob_index = layer->bottoms[i];
-
-                // delete after taken in light mode
-                blob_mats[bottom_blob_index].release();
-            }
-        }
-    }
-
-    return 0;
-}
-
-#if NCNN_VULKAN
-int NetPrivate::do_forward_layer(const Layer* layer, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
-{
-    if (layer->one_blob_only)
+    int ret;
+    if (cmd_submit_and_wait)
     {
-        // load bottom blob
-        int bottom_blob_index = layer->bottoms[0];
-        int top_blob_index = layer->tops[0];
-
-        VkMat& bottom_blob_ref = blob_mats_gpu[bottom_blob_index];
-        VkMat bottom_blob;
+        ret = cmd.submit_and_wait();
 
-        if (opt.lightmode)
-        {
-            // deep copy for inplace forward if data is shared
-            if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
-            {
-                cmd.record_clone(bottom_blob_ref, bottom_blob, opt);
-                //                     NCNN_LOGE("clone %p[+%lu] %p[+%lu]", bottom_blob_ref.buffer(), bottom_blob_ref.buffer_offset(), bottom_blob.buffer(), bottom_blob.buffer_offset());
-            }
-        }
-        if (bottom_blob.dims == 0)
+#if NCNN_BENCHMARK
+        std::vector<uint64_t> results(layer_index * 2);
+        cmd.get_query_pool_results(0, layer_index * 2, results);
+        for (int i = 0; i < layer_index; i++)
         {
-            bottom_blob = bottom_blob_ref;
+            uint64_t start = results[i * 2];
+            uint64_t end = results[i * 2 + 1];
+            if (start == 0 || end == 0)
+                continue;
+
+            double duration_us = (end - start) * vkdev->info.timestamp_period() / 1000;
+            NCNN_LOGE("%-24s %-30s %8.2lfus    |", layers[i]->type.c_str(), layers[i]->name.c_str(), duration_us);
         }
+#endif // NCNN_BENCHMARK
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
-        {
-            VkMat& bottom_top_blob = bottom_blob;
-            int ret = layer->forward_inplace(bottom_top_blob, cmd, opt);
-            if (ret != 0)
-                return ret;
+        cmd.reset();
+        if (ret != 0)
+            return ret;
+    }
 
-            // store top blob
-            blob_mats_gpu[top_blob_index] = bottom_top_blob;
-        }
-        else
+    if (layer->support_vulkan)
+    {
+#if NCNN_BENCHMARK
+        cmd.record_write_timestamp(layer_index * 2);
+#endif
+        if (layer->featmask)
         {
-            VkMat top_blob;
-            int ret = layer->forward(bottom_blob, top_blob, cmd, opt);
-            if (ret != 0)
-                return ret;
-
-            // store top blob
-            blob_mats_gpu[top_blob_index] = top_blob;
+            ret = do_forward_layer(layer, blob_mats_gpu, cmd, get_masked_option(opt, layer->featmask));
         }
-
-        if (opt.lightmode)
+        else
         {
-            // delete after taken in light mode
-            blob_mats_gpu[bottom_blob_index].release();
+            ret = do_forward_layer(layer, blob_mats_gpu, cmd, opt);
         }
+#if NCNN_BENCHMARK
+        cmd.record_write_timestamp(layer_index * 2 + 1);
+#endif
     }
     else
     {
-        // load bottom blobs
-        std::vector<VkMat> bottom_blobs(layer->bottoms.size());
-        for (size_t i = 0; i < layer->bottoms.size(); i++)
+#if NCNN_BENCHMARK
+        double start = get_current_time();
+        Mat bottom_blob;
+        if (layer->one_blob_only)
         {
-            int bottom_blob_index = layer->bottoms[i];
-
-            VkMat& bottom_blob_ref = blob_mats_gpu[bottom_blob_index];
-            bottom_blobs[i].release();
-
-            if (opt.lightmode)
-            {
-                // deep copy for inplace forward if data is shared
-                if (layer->support_inplace && *bottom_blob_ref.refcount != 1)
-                {
-                    cmd.record_clone(bottom_blob_ref, bottom_blobs[i], opt);
-                    //                         NCNN_LOGE("clone %p[+%lu] %p[+%lu]", bottom_blob_ref.buffer(), bottom_blob_ref.buffer_offset(), bottom_blobs[i].buffer(), bottom_blobs[i].buffer_offset());
-                }
-            }
-            if (bottom_blobs[i].dims == 0)
-            {
-                bottom_blobs[i] = bottom_blob_ref;
-            }
+            int bottom_blob_index = layer->bottoms[0];
+            bottom_blob = blob_mats[bottom_blob_index].shape();
         }
-
-        // forward
-        if (opt.lightmode && layer->support_inplace)
+#endif
+        if (layer->featmask)
         {
-            std::vector<VkMat>& bottom_top_blobs = bottom_blobs;
-            int ret = layer->forward_inplace(bottom_top_blobs, cmd, opt);
-            if (ret != 0)
-                return ret;
-
-            // store top blobs
-            for (size_t i = 0; i < layer->tops.size(); i++)
-            {
-                int top_blob_index = layer->tops[i];
-
-                blob_mats_gpu[top_blob_index] = bottom_top_blobs[i];
-            }
+            ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
         }
         else
         {
-            std::vector<VkMat> top_blobs(layer->tops.size());
-            int ret = layer->forward(bottom_blobs, top_blobs, cmd, opt);
-            if (ret != 0)
-                return ret;
-
-            // store top blobs
-            for (size_t i = 0; i < layer->tops.size(); i++)
-            {
-                int top_blob_index = layer->tops[i];
-
-                blob_mats_gpu[top_blob_index] = top_blobs[i];
-            }
+            ret = do_forward_layer(layer, blob_mats, opt);
         }
-
-        if (opt.lightmode)
+#if NCNN_BENCHMARK
+        double end = get_current_time();
+        if (layer->one_blob_only)
         {
-            for (size_t i = 0; i < layer->bottoms.size(); i++)
-            {
-                int bottom_blob_index = layer->bottoms[i];
-
-                // delete after taken in light mode
-                blob_mats_gpu[bottom_blob_index].release();
-            }
+            int top_blob_index = layer->tops[0];
+            benchmark(layer, bottom_blob, blob_mats[top_blob_index], start, end);
+        }
+        else
+        {
+            benchmark(layer, start, end);
         }
+#endif
     }
+    if (ret != 0)
+        return ret;
+
+    //     NCNN_LOGE("forward_layer %d %d %s done", layer->support_vulkan, layer_index, layer->name.c_str());
 
     return 0;
 }
 #endif // NCNN_VULKAN
 
-void NetPrivate::update_input_output_indexes()
+int NetPrivate::convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const
 {
-    input_blob_indexes.clear();
-    output_blob_indexes.clear();
+    if (bottom_blob.empty())
+        return 0;
 
-    for (size_t i = 0; i < layers.size(); i++)
+    if (bottom_blob.elembits() == 32)
     {
-        if (layers[i]->typeindex == LayerType::Input)
+        // clang-format off
+        // *INDENT-OFF*
+
+#if NCNN_ARM82
+        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && layer->support_fp16_storage)
         {
-            int blob_index = layers[i]->tops[0];
-            input_blob_indexes.push_back(blob_index);
+            Mat bottom_blob_fp16;
+            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
+            bottom_blob = bottom_blob_fp16;
         }
-    }
-
-    for (size_t i = 0; i < blobs.size(); i++)
-    {
-        if (blobs[i].producer != -1 && blobs[i].consumer == -1)
+        else
+#endif // NCNN_ARM82
+#if NCNN_VFPV4
+        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp16;
+            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
+            bottom_blob = bottom_blob_fp16;
+        }
+        else
+#endif // NCNN_VFPV4
+#if NCNN_ZFH
+        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp16;
+            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
+            bottom_blob = bottom_blob_fp16;
+        }
+        else
+#endif // NCNN_ZFH
+#if NCNN_BF16
+        if (opt.use_bf16_storage && layer->support_bf16_storage)
+        {
+            Mat bottom_blob_bf16;
+            cast_float32_to_bfloat16(bottom_blob, bottom_blob_bf16, opt);
+            bottom_blob = bottom_blob_bf16;
+        }
+        else
+#endif // NCNN_BF16
         {
-            output_blob_indexes.push_back(i);
         }
-    }
-}
 
-#if NCNN_STRING
-void NetPrivate::update_input_output_names()
-{
-    input_blob_names.clear();
-    output_blob_names.clear();
+        // *INDENT-ON*
+        // clang-format on
 
-    for (size_t i = 0; i < input_blob_indexes.size(); i++)
-    {
-        int blob_index = input_blob_indexes[i];
-        input_blob_names.push_back(blobs[blob_index].name.c_str());
+        if (bottom_blob.empty())
+            return -100;
     }
 
-    for (size_t i = 0; i < output_blob_indexes.size(); i++)
+    int dst_elempack = 1;
+    if (opt.use_packing_layout)
     {
-        int blob_index = output_blob_indexes[i];
-        output_blob_names.push_back(blobs[blob_index].name.c_str());
-    }
-}
-#endif // NCNN_STRING
-
-Net::Net()
-    : d(new NetPrivate(opt))
-{
-}
-
-Net::~Net()
-{
-    clear();
+        // resolve dst_elempack
+        int dims = bottom_blob.dims;
+        int elemcount = 0;
+        if (dims == 1) elemcount = bottom_blob.elempack * bottom_blob.w;
+        if (dims == 2) elemcount = bottom_blob.elempack * bottom_blob.h;
+        if (dims == 3 || dims == 4) elemcount = bottom_blob.elempack * bottom_blob.c;
 
-    delete d;
-}
+        int elembits = bottom_blob.elembits();
+
+        if (layer->support_packing)
+        {
+            if (elembits == 32)
+            {
+#if NCNN_AVX512
+                if (elemcount % 16 == 0 && ncnn::cpu_support_x86_avx512())
+                    dst_elempack = 16;
+                else if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#elif NCNN_AVX
+                if (elemcount % 8 == 0 && ncnn::cpu_support_x86_avx())
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#elif NCNN_RVV || NCNN_XTHEADVECTOR
+                const int packn = ncnn::cpu_riscv_vlenb() / 4;
+                if (elemcount % packn == 0)
+                    dst_elempack = packn;
+#else
+                if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#endif
+            }
+            if (elembits == 16)
+            {
+#if NCNN_ARM82
+                if (elemcount % 8 == 0 && ncnn::cpu_support_arm_asimdhp() && opt.use_fp16_arithmetic && layer->support_fp16_storage)
+                    dst_elempack = 8;
+                else if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#elif NCNN_RVV || NCNN_XTHEADVECTOR
+                const int packn = ncnn::cpu_riscv_vlenb() / 2;
+                if (elemcount % packn == 0)
+                    dst_elempack = packn;
+#else
+                if (elemcount % 4 == 0)
+                    dst_elempack = 4;
+#endif
+            }
+            if (elembits == 8)
+            {
+#if NCNN_RVV || NCNN_XTHEADVECTOR
+                const int packn = ncnn::cpu_riscv_vlenb() / 1;
+                if (elemcount % packn == 0)
+                    dst_elempack = packn;
+#else
+                if (elemcount % 8 == 0)
+                    dst_elempack = 8;
+#endif
+            }
+        }
+    }
+
+    if (bottom_blob.elempack != dst_elempack)
+    {
+        Mat bottom_blob_packed;
+        convert_packing(bottom_blob, bottom_blob_packed, dst_elempack, opt);
+        bottom_blob = bottom_blob_packed;
+
+        if (bottom_blob.empty())
+            return -100;
+    }
+
+    if (bottom_blob.elembits() == 16)
+    {
+        // clang-format off
+        // *INDENT-OFF*
+
+#if NCNN_ARM82
+        if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && !layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_ARM82
+#if NCNN_VFPV4
+        if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && !layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_VFPV4
+#if NCNN_ZFH
+        if (opt.use_fp16_storage && (ncnn::cpu_support_riscv_zvfh() || (!ncnn::cpu_support_riscv_v() && ncnn::cpu_support_riscv_zfh())) && !layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_ZFH
+#if NCNN_BF16
+        if (opt.use_bf16_storage && !layer->support_bf16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+        else
+#endif // NCNN_BF16
+        {
+        }
+
+        // *INDENT-ON*
+        // clang-format on
+
+        if (bottom_blob.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
+int NetPrivate::do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt) const
+{
+    if (layer->one_blob_only)
+    {
+        int bottom_blob_index = layer->bottoms[0];
+        int top_blob_index = layer->tops[0];
+
+        Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
+        Mat bottom_blob;
+
+        if (opt.lightmode)
+        {
+            // deep copy for inplace forward if data is shared or external
+            if (layer->support_inplace && (!bottom_blob_ref.refcount || *bottom_blob_ref.refcount != 1))
+            {
+                bottom_blob = bottom_blob_ref.clone(opt.blob_allocator);
+                if (bottom_blob.empty())
+                    return -100;
+            }
+        }
+        if (bottom_blob.dims == 0)
+        {
+            bottom_blob = bottom_blob_ref;
+        }
+
+        int ret = convert_layout(bottom_blob, layer, opt);
+        if (ret != 0)
+            return ret;
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            Mat& bottom_top_blob = bottom_blob;
+            int ret = layer->forward_inplace(bottom_top_blob, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blob
+            blob_mats[top_blob_index] = bottom_top_blob;
+        }
+        else
+        {
+            Mat top_blob;
+            int ret = layer->forward(bottom_blob, top_blob, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blob
+            blob_mats[top_blob_index] = top_blob;
+        }
+
+        if (opt.lightmode)
+        {
+            // delete after taken in light mode
+            blob_mats[bottom_blob_index].release();
+        }
+    }
+    else
+    {
+        std::vector<Mat> bottom_blobs(layer->bottoms.size());
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
+        {
+            int bottom_blob_index = layer->bottoms[i];
+
+            Mat& bottom_blob_ref = blob_mats[bottom_blob_index];
+            bottom_blobs[i].release();
+
+            if (opt.lightmode)
+            {
+                // deep copy for inplace forward if data is shared or external
+                if (layer->support_inplace && (!bottom_blob_ref.refcount || *bottom_blob_ref.refcount != 1))
+                {
+                    bottom_blobs[i] = bottom_blob_ref.clone(opt.blob_allocator);
+                    if (bottom_blobs[i].empty())
+                        return -100;
+                }
+            }
+            if (bottom_blobs[i].dims == 0)
+            {
+                bottom_blobs[i] = bottom_blob_ref;
+            }
+
+            int ret = convert_layout(bottom_blobs[i], layer, opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            std::vector<Mat>& bottom_top_blobs = bottom_blobs;
+            int ret = layer->forward_inplace(bottom_top_blobs, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                int top_blob_index = layer->tops[i];
+
+                blob_mats[top_blob_index] = bottom_top_blobs[i];
+            }
+        }
+        else
+        {
+            std::vector<Mat> top_blobs(layer->tops.size());
+            int ret = layer->forward(bottom_blobs, top_blobs, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                int top_blob_index = layer->tops[i];
+
+                blob_mats[top_blob_index] = top_blobs[i];
+            }
+        }
+
+        if (opt.lightmode)
+        {
+            for (size_t i = 0; i < layer->bottoms.size(); i++)
+            {
+                int bottom_blob_index = layer->bottoms[i];
+
+                // delete after taken in light mode
+                blob_mats[bottom_blob_index].release();
+            }
+        }
+    }
+
+    return 0;
+}
+
+#if NCNN_VULKAN
+int NetPrivate::do_forward_layer(const Layer* layer, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
+{
+    if (layer->one_blob_only)
+    {
+        // load bottom blob
+        int bottom_blob_index = layer->bottoms[0];
+        int top_blob_index = layer->tops[0];
+
+        VkMat& bottom_blob_ref = blob_mats_gpu[bottom_blob_index];
+        VkMat bottom_blob;
+
+        if (opt.lightmode)
+        {
+            // deep copy for inplace forward if data is shared or external
+            if (layer->support_inplace && (!bottom_blob_ref.refcount || *bottom_blob_ref.refcount != 1))
+            {
+                cmd.record_clone(bottom_blob_ref, bottom_blob, opt);
+                //                     NCNN_LOGE("clone %p[+%lu] %p[+%lu]", bottom_blob_ref.buffer(), bottom_blob_ref.buffer_offset(), bottom_blob.buffer(), bottom_blob.buffer_offset());
+            }
+        }
+        if (bottom_blob.dims == 0)
+        {
+            bottom_blob = bottom_blob_ref;
+        }
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            VkMat& bottom_top_blob = bottom_blob;
+            int ret = layer->forward_inplace(bottom_top_blob, cmd, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blob
+            blob_mats_gpu[top_blob_index] = bottom_top_blob;
+        }
+        else
+        {
+            VkMat top_blob;
+            int ret = layer->forward(bottom_blob, top_blob, cmd, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blob
+            blob_mats_gpu[top_blob_index] = top_blob;
+        }
+
+        if (opt.lightmode)
+        {
+            // delete after taken in light mode
+            blob_mats_gpu[bottom_blob_index].release();
+        }
+    }
+    else
+    {
+        // load bottom blobs
+        std::vector<VkMat> bottom_blobs(layer->bottoms.size());
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
+        {
+            int bottom_blob_index = layer->bottoms[i];
+
+            VkMat& bottom_blob_ref = blob_mats_gpu[bottom_blob_index];
+            bottom_blobs[i].release();
+
+            if (opt.lightmode)
+            {
+                // deep copy for inplace forward if data is shared or external
+                if (layer->support_inplace && (!bottom_blob_ref.refcount || *bottom_blob_ref.refcount != 1))
+                {
+                    cmd.record_clone(bottom_blob_ref, bottom_blobs[i], opt);
+                    //                         NCNN_LOGE("clone %p[+%lu] %p[+%lu]", bottom_blob_ref.buffer(), bottom_blob_ref.buffer_offset(), bottom_blobs[i].buffer(), bottom_blobs[i].buffer_offset());
+                }
+            }
+            if (bottom_blobs[i].dims == 0)
+            {
+                bottom_blobs[i] = bottom_blob_ref;
+            }
+        }
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            std::vector<VkMat>& bottom_top_blobs = bottom_blobs;
+            int ret = layer->forward_inplace(bottom_top_blobs, cmd, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                int top_blob_index = layer->tops[i];
+
+                blob_mats_gpu[top_blob_index] = bottom_top_blobs[i];
+            }
+        }
+        else
+        {
+            std::vector<VkMat> top_blobs(layer->tops.size());
+            int ret = layer->forward(bottom_blobs, top_blobs, cmd, opt);
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                int top_blob_index = layer->tops[i];
+
+                blob_mats_gpu[top_blob_index] = top_blobs[i];
+            }
+        }
+
+        if (opt.lightmode)
+        {
+            for (size_t i = 0; i < layer->bottoms.size(); i++)
+            {
+                int bottom_blob_index = layer->bottoms[i];
+
+                // delete after taken in light mode
+                blob_mats_gpu[bottom_blob_index].release();
+            }
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_VULKAN
+
+void NetPrivate::update_input_output_indexes()
+{
+    input_blob_indexes.clear();
+    output_blob_indexes.clear();
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers[i]->typeindex == LayerType::Input)
+        {
+            int blob_index = layers[i]->tops[0];
+            input_blob_indexes.push_back(blob_index);
+        }
+    }
+
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        if (blobs[i].producer != -1 && blobs[i].consumer == -1)
+        {
+            output_blob_indexes.push_back(i);
+        }
+    }
+}
+
+void NetPrivate::update_layer_graph()
+{
+    blob_consumers.clear();
+    blob_consumers.resize(blobs.size());
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        const Layer* layer = layers[i];
+        if (!layer)
+            continue;
+
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            blob_consumers[layer->bottoms[j]].push_back((int)i);
+        }
+    }
+
+    blob_consumed_once = true;
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        if (blob_consumers[i].size() > 1)
+        {
+            blob_consumed_once = false;
+            break;
+        }
+    }
+
+    // layers are stored in topological order, depth is the longest path from any source
+    std::vector<int> layer_depth(layers.size(), 0);
+    std::vector<int> depth_width(layers.size() + 1, 0);
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        const Layer* layer = layers[i];
+        if (!layer)
+            continue;
+
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            int producer = blobs[layer->bottoms[j]].producer;
+            if (producer >= 0 && producer < (int)i)
+                layer_depth[i] = std::max(layer_depth[i], layer_depth[producer] + 1);
+        }
+
+        depth_width[layer_depth[i]]++;
+    }
+
+    layer_graph_width.resize(layers.size());
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        layer_graph_width[i] = depth_width[layer_depth[i]];
+    }
+}
+
+#if NCNN_STRING
+void NetPrivate::update_input_output_names()
+{
+    input_blob_names.clear();
+    output_blob_names.clear();
+
+    for (size_t i = 0; i < input_blob_indexes.size(); i++)
+    {
+        int blob_index = input_blob_indexes[i];
+        input_blob_names.push_back(blobs[blob_index].name.c_str());
+    }
+
+    for (size_t i = 0; i < output_blob_indexes.size(); i++)
+    {
+        int blob_index = output_blob_indexes[i];
+        output_blob_names.push_back(blobs[blob_index].name.c_str());
+    }
+}
+#endif // NCNN_STRING
+
+Net::Net()
+    : d(new NetPrivate(opt))
+{
+}
+
+Net::~Net()
+{
+    clear();
+
+    delete d;
+}
 
 Net::Net(const Net&)
     : d(0)
 {
 }
 
-Net& Net::operator=(const Net&)
-{
-    return *this;
-}
+Net& Net::operator=(const Net&)
+{
+    return *this;
+}
+
+#if NCNN_STRING
+int Net::register_custom_layer(const char* type, layer_creator_func creator, layer_destroyer_func destroyer, void* userdata)
+{
+    int typeindex = layer_to_index(type);
+    if (typeindex != -1)
+    {
+        NCNN_LOGE("overwrite built-in layer type %s", type);
+
+        for (size_t i = 0; i < d->overwrite_builtin_layer_registry.size(); i++)
+        {
+            if (d->overwrite_builtin_layer_registry[i].typeindex == typeindex)
+            {
+                NCNN_LOGE("overwrite existing overwritten built-in layer index %d", typeindex);
+
+                d->overwrite_builtin_layer_registry[i].creator = creator;
+                d->overwrite_builtin_layer_registry[i].destroyer = destroyer;
+                d->overwrite_builtin_layer_registry[i].userdata = userdata;
+                return 0;
+            }
+        }
+
+        struct overwrite_builtin_layer_registry_entry entry = {typeindex, creator, destroyer, userdata};
+        d->overwrite_builtin_layer_registry.push_back(entry);
+        return 0;
+    }
+
+    int custom_index = custom_layer_to_index(type);
+    if (custom_index == -1)
+    {
+        struct custom_layer_registry_entry entry = {type, creator, destroyer, userdata};
+        d->custom_layer_registry.push_back(entry);
+    }
+    else
+    {
+        NCNN_LOGE("overwrite existing custom layer type %s", type);
+        d->custom_layer_registry[custom_index].name = type;
+        d->custom_layer_registry[custom_index].creator = creator;
+        d->custom_layer_registry[custom_index].destroyer = destroyer;
+        d->custom_layer_registry[custom_index].userdata = userdata;
+    }
+
+    return 0;
+}
+#endif // NCNN_STRING
+
+int Net::register_custom_layer(int index, layer_creator_func creator, layer_destroyer_func destroyer, void* userdata)
+{
+    int custom_index = index & ~LayerType::CustomBit;
+    if (index == custom_index)
+    {
+        NCNN_LOGE("overwrite built-in layer type %d", index);
+
+        for (size_t i = 0; i < d->overwrite_builtin_layer_registry.size(); i++)
+        {
+            if (d->overwrite_builtin_layer_registry[i].typeindex == index)
+            {
+                NCNN_LOGE("overwrite existing overwritten built-in layer index %d", index);
+
+                d->overwrite_builtin_layer_registry[i].creator = creator;
+                d->overwrite_builtin_layer_registry[i].destroyer = destroyer;
+                d->overwrite_builtin_layer_registry[i].userdata = userdata;
+                return 0;
+            }
+        }
+
+        struct overwrite_builtin_layer_registry_entry entry = {index, creator, destroyer, userdata};
+        d->overwrite_builtin_layer_registry.push_back(entry);
+        return 0;
+    }
+
+    if ((int)d->custom_layer_registry.size() <= custom_index)
+    {
+#if NCNN_STRING
+        struct custom_layer_registry_entry dummy = {"", 0, 0, 0};
+#else
+        struct custom_layer_registry_entry dummy = {0, 0, 0};
+#endif // NCNN_STRING
+        d->custom_layer_registry.resize(custom_index + 1, dummy);
+    }
+
+    if (d->custom_layer_registry[custom_index].creator)
+    {
+        NCNN_LOGE("overwrite existing custom layer index %d", custom_index);
+    }
+
+    d->custom_layer_registry[custom_index].creator = creator;
+    d->custom_layer_registry[custom_index].destroyer = destroyer;
+    d->custom_layer_registry[custom_index].userdata = userdata;
+    return 0;
+}
+
+#if NCNN_STDIO
+void Net::set_weight_cache(const char* cachepath)
+{
+    d->weight_cache_path = cachepath ? cachepath : "";
+}
+
+void Net::set_tuning_file(const char* tunepath)
+{
+    d->tuning_path = tunepath ? tunepath : "";
+}
+#endif // NCNN_STDIO
+
+#if NCNN_STRING
+int Net::load_param(const DataReader& dr)
+{
+#define SCAN_VALUE(fmt, v)                \
+    if (dr.scan(fmt, &v) != 1)            \
+    {                                     \
+        NCNN_LOGE("parse " #v " failed"); \
+        return -1;                        \
+    }
+
+    int magic = 0;
+    SCAN_VALUE("%d", magic)
+    if (magic != 7767517)
+    {
+        NCNN_LOGE("param is too old, please regenerate");
+        return -1;
+    }
+
+    // parse
+    int layer_count = 0;
+    int blob_count = 0;
+    SCAN_VALUE("%d", layer_count)
+    SCAN_VALUE("%d", blob_count)
+    if (layer_count <= 0 || blob_count <= 0)
+    {
+        NCNN_LOGE("invalid layer_count or blob_count");
+        return -1;
+    }
+
+    d->layers.resize((size_t)layer_count);
+    d->blobs.resize((size_t)blob_count);
+
+#if NCNN_VULKAN
+    // TODO enable gpu when bf16 conversion implemented
+    if (opt.use_bf16_storage)
+        opt.use_vulkan_compute = false;
+
+    if (opt.use_vulkan_compute)
+    {
+        if (!d->vkdev)
+        {
+            int device_index = opt.vulkan_device_index;
+            if (device_index < 0 || device_index >= get_gpu_count())
+                device_index = get_default_gpu_index();
+
+            d->vkdev = get_gpu_device(device_index);
+        }
+        if (!d->vkdev || !d->vkdev->is_valid()) opt.use_vulkan_compute = false; // no valid vulkan device, fallback to cpu
+    }
+    if (opt.use_vulkan_compute)
+    {
+        // sanitize use options
+        if (!d->vkdev->info.support_fp16_packed()) opt.use_fp16_packed = false;
+        if (!d->vkdev->info.support_fp16_storage()) opt.use_fp16_storage = false;
+        if (!d->vkdev->info.support_fp16_uniform()) opt.use_fp16_uniform = false;
+        if (!d->vkdev->info.support_fp16_arithmetic()) opt.use_fp16_arithmetic = false;
+        if (!d->vkdev->info.support_int8_packed()) opt.use_int8_packed = false;
+        if (!d->vkdev->info.support_int8_storage()) opt.use_int8_storage = false;
+        if (!d->vkdev->info.support_int8_uniform()) opt.use_int8_uniform = false;
+        if (!d->vkdev->info.support_int8_arithmetic()) opt.use_int8_arithmetic = false;
+        if (!d->vkdev->info.support_cooperative_matrix()) opt.use_cooperative_matrix = false;
+        if (!d->vkdev->info.support_subgroup_ops()) opt.use_subgroup_ops = false;
+
+        // enable local memory optimization on discrete gpu only
+        if (d->vkdev->info.type() != 0) opt.use_shader_local_memory = false;
+
+        // fp16a makes no sense when fp16 storage disabled
+        if (!opt.use_fp16_packed && !opt.use_fp16_storage) opt.use_fp16_arithmetic = false;
+
+        // int8a makes no sense when int8 storage disabled
+        if (!opt.use_int8_packed && !opt.use_int8_storage) opt.use_int8_arithmetic = false;
+
+        // fp16 uniform makes no sense when fp16 arithmetic disabled
+        if (!opt.use_fp16_arithmetic) opt.use_fp16_uniform = false;
+    }
+    else
+    {
+        // fp16a makes no sense when fp16 storage disabled
+        if (!opt.use_fp16_storage) opt.use_fp16_arithmetic = false;
+    }
+#endif // NCNN_VULKAN
+
+    ParamDict pd;
+
+    int blob_index = 0;
+    for (int i = 0; i < layer_count; i++)
+    {
+        char layer_type[256];
+        char layer_name[256];
+        int bottom_count = 0;
+        int top_count = 0;
+        SCAN_VALUE("%255s", layer_type)
+        SCAN_VALUE("%255s", layer_name)
+        SCAN_VALUE("%d", bottom_count)
+        SCAN_VALUE("%d", top_count)
+
+        Layer* layer = create_overwrite_builtin_layer(layer_type);
+#if NCNN_VULKAN
+        if (!layer && opt.use_vulkan_compute && d->vkdev)
+        {
+            layer = create_layer_vulkan(layer_type);
+        }
+#endif // NCNN_VULKAN
+        if (!layer)
+        {
+            layer = create_layer_cpu(layer_type);
+        }
+        if (!layer)
+        {
+            layer = create_custom_layer(layer_type);
+        }
+        if (!layer)
+        {
+            NCNN_LOGE("layer %s not exists or registered", layer_type);
+            clear();
+            return -1;
+        }
 
-#if NCNN_STRING
-int Net::register_custom_layer(const char* type, layer_creator_func creator, layer_destroyer_func destroyer, void* userdata)
-{
-    int typeindex = layer_to_index(type);
-    if (typeindex != -1)
-    {
-        NCNN_LOGE("overwrite built-in layer type %s", type);
+#if NCNN_VULKAN
+        if (opt.use_vulkan_compute)
+            layer->vkdev = d->vkdev;
+#endif // NCNN_VULKAN
 
-        for (size_t i = 0; i < d->overwrite_builtin_layer_registry.size(); i++)
+        layer->type = std::string(layer_type);
+        layer->name = std::string(layer_name);
+        //         NCNN_LOGE("new layer %d %s", i, layer_name);
+
+        layer->bottoms.resize(bottom_count);
+        for (int j = 0; j < bottom_count; j++)
         {
-            if (d->overwrite_builtin_layer_registry[i].typeindex == typeindex)
+            char bottom_name[256];
+            SCAN_VALUE("%255s", bottom_name)
+
+            int bottom_blob_index = find_blob_index_by_name(bottom_name);
+            if (bottom_blob_index == -1)
             {
-                NCNN_LOGE("overwrite existing overwritten built-in layer index %d", typeindex);
+                Blob& blob = d->blobs[blob_index];
 
-                d->overwrite_builtin_layer_registry[i].creator = creator;
-                d->overwrite_builtin_layer_registry[i].destroyer = destroyer;
-                d->overwrite_builtin_layer_registry[i].userdata = userdata;
-                return 0;
+                bottom_blob_index = blob_index;
+
+                blob.name = std::string(bottom_name);
+                //                 NCNN_LOGE("new blob %s", bottom_name);
+
+                blob_index++;
             }
+
+            Blob& blob = d->blobs[bottom_blob_index];
+
+            blob.consumer = i;
+
+            layer->bottoms[j] = bottom_blob_index;
         }
 
-        struct overwrite_builtin_layer_registry_entry entry = {typeindex, creator, destroyer, userdata};
-        d->overwrite_builtin_layer_registry.push_back(entry);
-        return 0;
-    }
+        layer->tops.resize(top_count);
+        for (int j = 0; j < top_count; j++)
+        {
+            Blob& blob = d->blobs[blob_index];
 
-    int custom_index = custom_layer_to_index(type);
-    if (custom_index == -1)
-    {
-        struct custom_layer_registry_entry entry = {type, creator, destroyer, userdata};
-        d->custom_layer_registry.push_back(entry);
-    }
-    else
-    {
-        NCNN_LOGE("overwrite existing custom layer type %s", type);
-        d->custom_layer_registry[custom_index].name = type;
-        d->custom_layer_registry[custom_index].creator = creator;
-        d->custom_layer_registry[custom_index].destroyer = destroyer;
-        d->custom_layer_registry[custom_index].userdata = userdata;
-    }
+            char blob_name[256];
+            SCAN_VALUE("%255s", blob_name)
 
-    return 0;
-}
-#endif // NCNN_STRING
+            blob.name = std::string(blob_name);
+            //             NCNN_LOGE("new blob %s", blob_name);
 
-int Net::register_custom_layer(int index, layer_creator_func creator, layer_destroyer_func destroyer, void* userdata)
-{
-    int custom_index = index & ~LayerType::CustomBit;
-    if (index == custom_index)
-    {
-        NCNN_LOGE("overwrite built-in layer type %d", index);
+            blob.producer = i;
 
-        for (size_t i = 0; i < d->overwrite_builtin_layer_registry.size(); i++)
+            layer->tops[j] = blob_index;
+
+            blob_index++;
+        }
+
+        int layer_support_vulkan = layer->support_vulkan;
+
+        // layer specific params
+        int pdlr = pd.load_param(dr);
+        if (pdlr != 0)
         {
-            if (d->overwrite_builtin_layer_registry[i].typeindex == index)
+            NCNN_LOGE("ParamDict load_param %d %s failed", i, layer_name);
+            continue;
+        }
+
+        // pull out top shape hints
+        Mat shape_hints = pd.get(30, Mat());
+        if (!shape_hints.empty())
+        {
+            const int* psh = shape_hints;
+            for (int j = 0; j < top_count; j++)
             {
-                NCNN_LOGE("overwrite existing overwritten built-in layer index %d", index);
+                Blob& blob = d->blobs[layer->tops[j]];
 
-                d->overwrite_builtin_layer_registry[i].creator = creator;
-                d->overwrite_builtin_layer_registry[i].destroyer = destroyer;
-                d->overwrite_builtin_layer_registry[i].userdata = userdata;
-                return 0;
+                int dims = psh[0];
+                if (dims == 1)
+                {
+                    blob.shape = Mat(psh[1], (void*)0, 4u, 1);
+                }
+                if (dims == 2)
+                {
+                    blob.shape = Mat(psh[1], psh[2], (void*)0, 4u, 1);
+                }
+                if (dims == 3)
+                {
+                    blob.shape = Mat(psh[1], psh[2], psh[3], (void*)0, 4u, 1);
+                }
+
+                psh += 4;
             }
         }
 
-        struct overwrite_builtin_layer_registry_entry entry = {index, creator, destroyer, userdata};
-        d->overwrite_builtin_layer_registry.push_back(entry);
-        return 0;
-    }
+        // set bottom and top shape hints
+        layer->bottom_shapes.resize(bottom_count);
+        for (int j = 0; j < bottom_count; j++)
+        {
+            layer->bottom_shapes[j] = d->blobs[layer->bottoms[j]].shape;
+        }
 
-    if ((int)d->custom_layer_registry.size() <= custom_index)
-    {
-#if NCNN_STRING
-        struct custom_layer_registry_entry dummy = {"", 0, 0, 0};
-#else
-        struct custom_layer_registry_entry dummy = {0, 0, 0};
-#endif // NCNN_STRING
-        d->custom_layer_registry.resize(custom_index + 1, dummy);
-    }
+        layer->top_shapes.resize(top_count);
+        for (int j = 0; j < top_count; j++)
+        {
+            layer->top_shapes[j] = d->blobs[layer->tops[j]].shape;
+        }
 
-    if (d->custom_layer_registry[custom_index].creator)
-    {
-        NCNN_LOGE("overwrite existing custom layer index %d", custom_index);
+        // pull out layer specific feature disabled set
+        layer->featmask = pd.get(31, 0);
+
+        int lr = layer->load_param(pd);
+        if (lr != 0)
+        {
+            NCNN_LOGE("layer load_param %d %s failed", i, layer_name);
+            continue;
+        }
+
+        if (layer->support_int8_storage)
+        {
+            // no int8 gpu support yet
+            opt.use_vulkan_compute = false;
+        }
+
+        Option opt1 = get_masked_option(opt, layer->featmask);
+
+        if (layer_support_vulkan && (!layer->support_vulkan || !opt1.use_vulkan_compute))
+        {
+            // vulkan layer cannot handle these param, recreate cpu layer
+            Layer* layer_cpu = create_overwrite_builtin_layer(layer_type);
+            if (!layer_cpu)
+            {
+                layer_cpu = create_layer_cpu(layer_type);
+            }
+            if (!layer_cpu)
+            {
+                layer_cpu = create_custom_layer(layer_type);
+            }
+            if (!layer_cpu)
+            {
+                NCNN_LOGE("layer %s not exists or registered", layer_type);
+                clear();
+                return -1;
+            }
+
+            layer_cpu->type = layer->type;
+            layer_cpu->name = layer->name;
+            layer_cpu->bottoms = layer->bottoms;
+            layer_cpu->tops = layer->tops;
+            layer_cpu->bottom_shapes = layer->bottom_shapes;
+            layer_cpu->top_shapes = layer->top_shapes;
+            layer_cpu->featmask = layer->featmask;
+
+            int lr = layer_cpu->load_param(pd);
+            if (lr != 0)
+            {
+                NCNN_LOGE("layer load_param %d %s failed", i, layer_name);
+                continue;
+            }
+
+            delete layer;
+            layer = layer_cpu;
+        }
+
+        d->layers[i] = layer;
     }
 
-    d->custom_layer_registry[custom_index].creator = creator;
-    d->custom_layer_registry[custom_index].destroyer = destroyer;
-    d->custom_layer_registry[custom_index].userdata = userdata;
+    d->update_input_output_indexes();
+    d->update_input_output_names();
+    d->update_layer_graph();
+
+#undef SCAN_VALUE
     return 0;
 }
+#endif // NCNN_STRING
 
-#if NCNN_STRING
-int Net::load_param(const DataReader& dr)
+int Net::load_param_bin(const DataReader& dr)
 {
-#define SCAN_VALUE(fmt, v)                \
-    if (dr.scan(fmt, &v) != 1)            \
-    {                                     \
-        NCNN_LOGE("parse " #v " failed"); \
-        return -1;                        \
+#if __BIG_ENDIAN__
+#define READ_VALUE(buf)                            \
+    if (dr.read(&buf, sizeof(buf)) != sizeof(buf)) \
+    {                                              \
+        NCNN_LOGE("read " #buf " failed");         \
+        return -1;                                 \
+    }                                              \
+    if (sizeof(buf) == 2)                          \
+        swap_endianness_16(&buf);                  \
+    if (sizeof(buf) == 4)                          \
+        swap_endianness_32(&buf);
+#else
+#define READ_VALUE(buf)                            \
+    if (dr.read(&buf, sizeof(buf)) != sizeof(buf)) \
+    {                                              \
+        NCNN_LOGE("read " #buf " failed");         \
+        return -1;                                 \
     }
+#endif
 
     int magic = 0;
-    SCAN_VALUE("%d", magic)
+    READ_VALUE(magic)
     if (magic != 7767517)
     {
         NCNN_LOGE("param is too old, please regenerate");
         return -1;
     }
 
-    // parse
     int layer_count = 0;
     int blob_count = 0;
-    SCAN_VALUE("%d", layer_count)
-    SCAN_VALUE("%d", blob_count)
+    READ_VALUE(layer_count)
+    READ_VALUE(blob_count)
     if (layer_count <= 0 || blob_count <= 0)
     {
         NCNN_LOGE("invalid layer_count or blob_count");
         return -1;
     }
 
-    d->layers.resize((size_t)layer_count);
-    d->blobs.resize((size_t)blob_count);
+    d->layers.resize(layer_count);
+    d->blobs.resize(blob_count);
 
 #if NCNN_VULKAN
     // TODO enable gpu when bf16 conversion implemented
@@ -1058,36 +2578,34 @@ int Net::load_param(const DataReader& dr)
 
     ParamDict pd;
 
-    int blob_index = 0;
     for (int i = 0; i < layer_count; i++)
     {
-        char layer_type[256];
-        char layer_name[256];
-        int bottom_count = 0;
-        int top_count = 0;
-        SCAN_VALUE("%255s", layer_type)
-        SCAN_VALUE("%255s", layer_name)
-        SCAN_VALUE("%d", bottom_count)
-        SCAN_VALUE("%d", top_count)
+        int typeindex;
+        int bottom_count;
+        int top_count;
+        READ_VALUE(typeindex)
+        READ_VALUE(bottom_count)
+        READ_VALUE(top_count)
 
-        Layer* layer = create_overwrite_builtin_layer(layer_type);
+        Layer* layer = create_overwrite_builtin_layer(typeindex);
 #if NCNN_VULKAN
         if (!layer && opt.use_vulkan_compute && d->vkdev)
         {
-            layer = create_layer_vulkan(layer_type);
+            layer = create_layer_vulkan(typeindex);
         }
 #endif // NCNN_VULKAN
         if (!layer)
         {
-            layer = create_layer_cpu(layer_type);
+            layer = create_layer_cpu(typeindex);
         }
         if (!layer)
         {
-            layer = create_custom_layer(layer_type);
+            int custom_index = typeindex & ~LayerType::CustomBit;
+            layer = create_custom_layer(custom_index);
         }
         if (!layer)
         {
-            NCNN_LOGE("layer %s not exists or registered", layer_type);
+            NCNN_LOGE("layer %d not exists or registered", typeindex);
             clear();
             return -1;
         }
@@ -1097,28 +2615,15 @@ int Net::load_param(const DataReader& dr)
             layer->vkdev = d->vkdev;
 #endif // NCNN_VULKAN
 
-        layer->type = std::string(layer_type);
-        layer->name = std::string(layer_name);
-        //         NCNN_LOGE("new layer %d %s", i, layer_name);
+        //         layer->type = std::string(layer_type);
+        //         layer->name = std::string(layer_name);
+        //         NCNN_LOGE("new layer %d", typeindex);
 
         layer->bottoms.resize(bottom_count);
         for (int j = 0; j < bottom_count; j++)
         {
-            char bottom_name[256];
-            SCAN_VALUE("%255s", bottom_name)
-
-            int bottom_blob_index = find_blob_index_by_name(bottom_name);
-            if (bottom_blob_index == -1)
-            {
-                Blob& blob = d->blobs[blob_index];
-
-                bottom_blob_index = blob_index;
-
-                blob.name = std::string(bottom_name);
-                //                 NCNN_LOGE("new blob %s", bottom_name);
-
-                blob_index++;
-            }
+            int bottom_blob_index;
+            READ_VALUE(bottom_blob_index)
 
             Blob& blob = d->blobs[bottom_blob_index];
 
@@ -1130,32 +2635,30 @@ int Net::load_param(const DataReader& dr)
         layer->tops.resize(top_count);
         for (int j = 0; j < top_count; j++)
         {
-            Blob& blob = d->blobs[blob_index];
+            int top_blob_index;
+            READ_VALUE(top_blob_index)
 
-            char blob_name[256];
-            SCAN_VALUE("%255s", blob_name)
+            Blob& blob = d->blobs[top_blob_index];
 
-            blob.name = std::string(blob_name);
+            //             blob.name = std::string(blob_name);
             //             NCNN_LOGE("new blob %s", blob_name);
 
             blob.producer = i;
 
-            layer->tops[j] = blob_index;
-
-            blob_index++;
+            layer->tops[j] = top_blob_index;
         }
 
         int layer_support_vulkan = layer->support_vulkan;
 
         // layer specific params
-        int pdlr = pd.load_param(dr);
+        int pdlr = pd.load_param_bin(dr);
         if (pdlr != 0)
         {
-            NCNN_LOGE("ParamDict load_param %d %s failed", i, layer_name);
+            NCNN_LOGE("ParamDict load_param_bin %d failed", i);
             continue;
         }
 
-        // pull out top shape hints
+        // pull out top blob shape hints
         Mat shape_hints = pd.get(30, Mat());
         if (!shape_hints.empty())
         {
@@ -1201,7 +2704,7 @@ int Net::load_param(const DataReader& dr)
         int lr = layer->load_param(pd);
         if (lr != 0)
         {
-            NCNN_LOGE("layer load_param %d %s failed", i, layer_name);
+            NCNN_LOGE("layer load_param %d failed", i);
             continue;
         }
 
@@ -1216,328 +2719,732 @@ int Net::load_param(const DataReader& dr)
         if (layer_support_vulkan && (!layer->support_vulkan || !opt1.use_vulkan_compute))
         {
             // vulkan layer cannot handle these param, recreate cpu layer
-            Layer* layer_cpu = create_overwrite_builtin_layer(layer_type);
+            Layer* layer_cpu = create_overwrite_builtin_layer(typeindex);
             if (!layer_cpu)
             {
-                layer_cpu = create_layer_cpu(layer_type);
+                layer_cpu = create_layer_cpu(typeindex);
             }
             if (!layer_cpu)
             {
-                layer_cpu = create_custom_layer(layer_type);
+                int custom_index = typeindex & ~LayerType::CustomBit;
+                layer_cpu = create_custom_layer(custom_index);
             }
             if (!layer_cpu)
             {
-                NCNN_LOGE("layer %s not exists or registered", layer_type);
+                NCNN_LOGE("layer %d not exists or registered", typeindex);
                 clear();
                 return -1;
             }
 
-            layer_cpu->type = layer->type;
-            layer_cpu->name = layer->name;
             layer_cpu->bottoms = layer->bottoms;
             layer_cpu->tops = layer->tops;
             layer_cpu->bottom_shapes = layer->bottom_shapes;
             layer_cpu->top_shapes = layer->top_shapes;
             layer_cpu->featmask = layer->featmask;
 
-            int lr = layer_cpu->load_param(pd);
-            if (lr != 0)
-            {
-                NCNN_LOGE("layer load_param %d %s failed", i, layer_name);
+            int lr = layer_cpu->load_param(pd);
+            if (lr != 0)
+            {
+                NCNN_LOGE("layer load_param %d failed", i);
+                continue;
+            }
+
+            delete layer;
+            layer = layer_cpu;
+        }
+
+        d->layers[i] = layer;
+    }
+
+    d->update_input_output_indexes();
+    d->update_layer_graph();
+
+#undef READ_VALUE
+    return 0;
+}
+
+#if NCNN_STDIO
+// https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function#FNV-1a_hash
+// consume 8 bytes per step with a fold, weight data is large
+static uint64_t fnv1a_64(uint64_t h, const void* data, size_t size)
+{
+    const unsigned char* p = (const unsigned char*)data;
+
+    for (; size >= 8; size -= 8)
+    {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        h ^= k;
+        h *= 0x100000001b3ULL;
+        h ^= h >> 32;
+        p += 8;
+    }
+    for (; size > 0; size--)
+    {
+        h ^= *p++;
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+static uint64_t fnv1a_64(uint64_t h, int v)
+{
+    return fnv1a_64(h, &v, sizeof(int));
+}
+
+// hash weight data while reading it through
+class DataReaderHash : public DataReader
+{
+public:
+    DataReaderHash(const DataReader& _dr)
+        : dr(_dr), hash(0xcbf29ce484222325ULL)
+    {
+    }
+
+#if NCNN_STRING
+    virtual int scan(const char* format, void* p) const
+    {
+        return dr.scan(format, p);
+    }
+#endif // NCNN_STRING
+
+    virtual size_t read(void* buf, size_t size) const
+    {
+        size_t nread = dr.read(buf, size);
+        hash = fnv1a_64(hash, buf, nread);
+        return nread;
+    }
+
+    virtual size_t reference(size_t size, const void** buf) const
+    {
+        size_t nref = dr.reference(size, buf);
+        if (nref)
+            hash = fnv1a_64(hash, *buf, nref);
+        return nref;
+    }
+
+public:
+    const DataReader& dr;
+    mutable uint64_t hash;
+};
+
+// cpu features and ncnn version, the layout of transformed weights depends on them
+static uint64_t weight_cache_environment_digest()
+{
+    const int features[] = {
+        (int)sizeof(void*),
+        cpu_support_arm_neon(),
+        cpu_support_arm_vfpv4(),
+        cpu_support_arm_asimdhp(),
+        cpu_support_arm_asimddp(),
+        cpu_support_arm_asimdfhm(),
+        cpu_support_arm_bf16(),
+        cpu_support_arm_i8mm(),
+        cpu_support_arm_sve(),
+        cpu_support_arm_sve2(),
+        cpu_support_x86_avx(),
+        cpu_support_x86_fma(),
+        cpu_support_x86_xop(),
+        cpu_support_x86_f16c(),
+        cpu_support_x86_avx2(),
+        cpu_support_x86_avx_vnni(),
+        cpu_support_x86_avx_vnni_int8(),
+        cpu_support_x86_avx_vnni_int16(),
+        cpu_support_x86_avx_ne_convert(),
+        cpu_support_x86_avx512(),
+        cpu_support_x86_avx512_vnni(),
+        cpu_support_x86_avx512_bf16(),
+        cpu_support_x86_avx512_fp16(),
+        cpu_support_loongarch_lsx(),
+        cpu_support_loongarch_lasx(),
+        cpu_support_mips_msa(),
+        cpu_support_riscv_v(),
+        cpu_support_riscv_zfh(),
+        cpu_support_riscv_zvfh(),
+        cpu_riscv_vlenb(),
+        get_cpu_level2_cache_size(),
+        get_cpu_level3_cache_size(),
+    };
+
+    uint64_t h = fnv1a_64(0xcbf29ce484222325ULL, features, sizeof(features));
+
+#ifdef NCNN_VERSION_STRING
+    h = fnv1a_64(h, NCNN_VERSION_STRING, strlen(NCNN_VERSION_STRING));
+#endif
+
+    return h;
+}
+
+// layer and the options create_pipeline sees
+static uint64_t layer_pipeline_digest(uint64_t h, int layer_index, const Layer* layer, const Option& opt)
+{
+    const int options[] = {
+        opt.num_threads,
+        opt.use_winograd_convolution,
+        opt.use_sgemm_convolution,
+        opt.use_int8_inference,
+        opt.use_vulkan_compute,
+        opt.use_bf16_storage,
+        opt.use_fp16_packed,
+        opt.use_fp16_storage,
+        opt.use_fp16_arithmetic,
+        opt.use_int8_packed,
+        opt.use_int8_storage,
+        opt.use_int8_arithmetic,
+        opt.use_packing_layout,
+        opt.use_winograd23_convolution,
+        opt.use_winograd43_convolution,
+        opt.use_winograd63_convolution,
+        opt.use_a53_a55_optimized_kernel,
+    };
+
+    h = fnv1a_64(h, options, sizeof(options));
+    h = fnv1a_64(h, layer_index);
+    h = fnv1a_64(h, layer->typeindex);
+
+    // shape hints select kernels such as winograd tiles
+    for (size_t i = 0; i < layer->bottom_shapes.size(); i++)
+    {
+        const Mat& m = layer->bottom_shapes[i];
+        const int shape[5] = {m.dims, m.w, m.h, m.d, m.c};
+        h = fnv1a_64(h, shape, sizeof(shape));
+    }
+    h = fnv1a_64(h, -1);
+    for (size_t i = 0; i < layer->top_shapes.size(); i++)
+    {
+        const Mat& m = layer->top_shapes[i];
+        const int shape[5] = {m.dims, m.w, m.h, m.d, m.c};
+        h = fnv1a_64(h, shape, sizeof(shape));
+    }
+
+    return h;
+}
+
+// model data read so far, layer, the options create_pipeline sees and the tuned kernel
+static uint64_t weight_cache_layer_digest(uint64_t model_hash, int layer_index, const Layer* layer, const Option& opt)
+{
+    uint64_t h = layer_pipeline_digest(model_hash, layer_index, layer, opt);
+    h = fnv1a_64(h, layer->tuning_variant);
+
+    return h;
+}
+
+// weight cache file
+//   header  uint32 magic, uint32 version, uint64 environment digest
+//   layer   int32 layer index, int32 mat count, uint64 layer digest
+//   mat     int32 dims w h d c elempack, uint32 elemsize, data of total() * elemsize bytes
+class WeightCache
+{
+public:
+    WeightCache(int layer_count);
+
+    // read all entries, unreadable or stale file leaves the cache empty
+    void load(const char* path);
+
+    // fill the layer weights from cache
+    // return 0 if restored
+    int restore(int layer_index, uint64_t digest, const std::vector<Mat*>& weights);
+
+    // keep the layer weights after create_pipeline
+    void store(int layer_index, uint64_t digest, const std::vector<Mat*>& weights);
+
+    // return 0 if success
+    int save(const char* path) const;
+
+public:
+    struct weight_cache_entry
+    {
+        uint64_t digest;
+        std::vector<Mat> mats;
+    };
+
+    uint64_t environment_digest;
+    std::vector<weight_cache_entry> entries;
+
+    // some layer missed the cache, file needs rewrite
+    bool dirty;
+};
+
+static const uint32_t weight_cache_magic = 0x6e63776d; // ncwm
+static const uint32_t weight_cache_version = 1;
+
+WeightCache::WeightCache(int layer_count)
+{
+    environment_digest = weight_cache_environment_digest();
+
+    weight_cache_entry empty_entry;
+    empty_entry.digest = 0;
+    entries.resize(layer_count, empty_entry);
+
+    dirty = false;
+}
+
+void WeightCache::load(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+    {
+        // first run
+        dirty = true;
+        return;
+    }
+
+    uint32_t header[2] = {0, 0};
+    uint64_t file_environment_digest = 0;
+    if (fread(header, sizeof(uint32_t), 2, fp) != 2 || fread(&file_environment_digest, sizeof(uint64_t), 1, fp) != 1
+            || header[0] != weight_cache_magic || header[1] != weight_cache_version || file_environment_digest != environment_digest)
+    {
+        // other cpu or build
+        fclose(fp);
+        dirty = true;
+        return;
+    }
+
+    for (;;)
+    {
+        int layer_info[2];
+        uint64_t digest;
+        if (fread(layer_info, sizeof(int), 2, fp) != 2 || fread(&digest, sizeof(uint64_t), 1, fp) != 1)
+            break;
+
+        const int layer_index = layer_info[0];
+        const int mat_count = layer_info[1];
+        if (layer_index < 0 || layer_index >= (int)entries.size() || mat_count < 0)
+        {
+            NCNN_LOGE("weight cache %s is corrupted", path);
+            break;
+        }
+
+        std::vector<Mat> mats(mat_count);
+
+        bool ok = true;
+        for (int j = 0; j < mat_count; j++)
+        {
+            int shape[6];
+            uint32_t elemsize;
+            if (fread(shape, sizeof(int), 6, fp) != 6 || fread(&elemsize, sizeof(uint32_t), 1, fp) != 1)
+            {
+                ok = false;
+                break;
+            }
+
+            const int dims = shape[0];
+            if (dims == 0)
+                continue;
+
+            Mat& m = mats[j];
+            if (dims == 1) m.create(shape[1], (size_t)elemsize, shape[5]);
+            if (dims == 2) m.create(shape[1], shape[2], (size_t)elemsize, shape[5]);
+            if (dims == 3) m.create(shape[1], shape[2], shape[4], (size_t)elemsize, shape[5]);
+            if (dims == 4) m.create(shape[1], shape[2], shape[3], shape[4], (size_t)elemsize, shape[5]);
+            if (m.empty())
+            {
+                ok = false;
+                break;
+            }
+
+            const size_t size = m.total() * m.elemsize;
+            if (fread(m.data, 1, size, fp) != size)
+            {
+                ok = false;
+                break;
+            }
+        }
+
+        if (!ok)
+        {
+            NCNN_LOGE("weight cache %s is corrupted", path);
+            break;
+        }
+
+        entries[layer_index].digest = digest;
+        entries[layer_index].mats = mats;
+    }
+
+    fclose(fp);
+}
+
+int WeightCache::restore(int layer_index, uint64_t digest, const std::vector<Mat*>& weights)
+{
+    const weight_cache_entry& entry = entries[layer_index];
+    if (entry.digest != digest || entry.mats.size() != weights.size())
+    {
+        dirty = true;
+        return -1;
+    }
+
+    for (size_t j = 0; j < weights.size(); j++)
+    {
+        *weights[j] = entry.mats[j];
+    }
+
+    return 0;
+}
+
+void WeightCache::store(int layer_index, uint64_t digest, const std::vector<Mat*>& weights)
+{
+    weight_cache_entry& entry = entries[layer_index];
+    entry.digest = digest;
+    entry.mats.resize(weights.size());
+    for (size_t j = 0; j < weights.size(); j++)
+    {
+        entry.mats[j] = *weights[j];
+    }
+}
+
+int WeightCache::save(const char* path) const
+{
+    // write aside and rename, concurrent loaders never see a partial file
+    std::string tmppath = std::string(path) + ".tmp";
+
+    FILE* fp = fopen(tmppath.c_str(), "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", tmppath.c_str());
+        return -1;
+    }
+
+    bool ok = true;
+
+    const uint32_t header[2] = {weight_cache_magic, weight_cache_version};
+    ok = ok && fwrite(header, sizeof(uint32_t), 2, fp) == 2;
+    ok = ok && fwrite(&environment_digest, sizeof(uint64_t), 1, fp) == 1;
+
+    for (size_t i = 0; i < entries.size() && ok; i++)
+    {
+        const weight_cache_entry& entry = entries[i];
+        if (entry.mats.empty())
+            continue;
+
+        const int layer_info[2] = {(int)i, (int)entry.mats.size()};
+        ok = ok && fwrite(layer_info, sizeof(int), 2, fp) == 2;
+        ok = ok && fwrite(&entry.digest, sizeof(uint64_t), 1, fp) == 1;
+
+        for (size_t j = 0; j < entry.mats.size() && ok; j++)
+        {
+            const Mat& m = entry.mats[j];
+
+            const int shape[6] = {m.empty() ? 0 : m.dims, m.w, m.h, m.d, m.c, m.elempack};
+            const uint32_t elemsize = (uint32_t)m.elemsize;
+            ok = ok && fwrite(shape, sizeof(int), 6, fp) == 6;
+            ok = ok && fwrite(&elemsize, sizeof(uint32_t), 1, fp) == 1;
+
+            if (m.empty())
                 continue;
-            }
 
-            delete layer;
-            layer = layer_cpu;
+            const size_t size = m.total() * m.elemsize;
+            ok = ok && fwrite(m.data, 1, size, fp) == size;
         }
+    }
 
-        d->layers[i] = layer;
+    ok = fclose(fp) == 0 && ok;
+
+    if (!ok)
+    {
+        NCNN_LOGE("write weight cache %s failed", tmppath.c_str());
+        remove(tmppath.c_str());
+        return -1;
     }
 
-    d->update_input_output_indexes();
-    d->update_input_output_names();
+    if (rename(tmppath.c_str(), path) != 0)
+    {
+        // rename does not replace existing file on windows
+        remove(path);
+        if (rename(tmppath.c_str(), path) != 0)
+        {
+            NCNN_LOGE("rename weight cache %s failed", path);
+            remove(tmppath.c_str());
+            return -1;
+        }
+    }
 
-#undef SCAN_VALUE
     return 0;
 }
-#endif // NCNN_STRING
 
-int Net::load_param_bin(const DataReader& dr)
+// tuning file, one text line per tuned layer
+//   ncnntune version environment-digest
+//   layer-index layer-digest variant layer-name
+class TuningTable
 {
-#if __BIG_ENDIAN__
-#define READ_VALUE(buf)                            \
-    if (dr.read(&buf, sizeof(buf)) != sizeof(buf)) \
-    {                                              \
-        NCNN_LOGE("read " #buf " failed");         \
-        return -1;                                 \
-    }                                              \
-    if (sizeof(buf) == 2)                          \
-        swap_endianness_16(&buf);                  \
-    if (sizeof(buf) == 4)                          \
-        swap_endianness_32(&buf);
-#else
-#define READ_VALUE(buf)                            \
-    if (dr.read(&buf, sizeof(buf)) != sizeof(buf)) \
-    {                                              \
-        NCNN_LOGE("read " #buf " failed");         \
-        return -1;                                 \
-    }
-#endif
+public:
+    TuningTable(int layer_count);
 
-    int magic = 0;
-    READ_VALUE(magic)
-    if (magic != 7767517)
-    {
-        NCNN_LOGE("param is too old, please regenerate");
-        return -1;
-    }
+    // read all entries, unreadable or stale file leaves the table empty
+    void load(const char* path);
 
-    int layer_count = 0;
-    int blob_count = 0;
-    READ_VALUE(layer_count)
-    READ_VALUE(blob_count)
-    if (layer_count <= 0 || blob_count <= 0)
-    {
-        NCNN_LOGE("invalid layer_count or blob_count");
-        return -1;
-    }
+    // return the recorded variant, -1 if missing or stale
+    int lookup(int layer_index, uint64_t digest) const;
 
-    d->layers.resize(layer_count);
-    d->blobs.resize(blob_count);
+    void store(int layer_index, uint64_t digest, int variant);
 
-#if NCNN_VULKAN
-    // TODO enable gpu when bf16 conversion implemented
-    if (opt.use_bf16_storage)
-        opt.use_vulkan_compute = false;
+    // return 0 if success
+    int save(const char* path, const std::vector<Layer*>& layers) const;
 
-    if (opt.use_vulkan_compute)
+public:
+    struct tuning_entry
     {
-        if (!d->vkdev)
-        {
-            int device_index = opt.vulkan_device_index;
-            if (device_index < 0 || device_index >= get_gpu_count())
-                device_index = get_default_gpu_index();
+        uint64_t digest;
+        int variant;
+    };
 
-            d->vkdev = get_gpu_device(device_index);
-        }
-        if (!d->vkdev || !d->vkdev->is_valid()) opt.use_vulkan_compute = false; // no valid vulkan device, fallback to cpu
-    }
-    if (opt.use_vulkan_compute)
-    {
-        // sanitize use options
-        if (!d->vkdev->info.support_fp16_packed()) opt.use_fp16_packed = false;
-        if (!d->vkdev->info.support_fp16_storage()) opt.use_fp16_storage = false;
-        if (!d->vkdev->info.support_fp16_uniform()) opt.use_fp16_uniform = false;
-        if (!d->vkdev->info.support_fp16_arithmetic()) opt.use_fp16_arithmetic = false;
-        if (!d->vkdev->info.support_int8_packed()) opt.use_int8_packed = false;
-        if (!d->vkdev->info.support_int8_storage()) opt.use_int8_storage = false;
-        if (!d->vkdev->info.support_int8_uniform()) opt.use_int8_uniform = false;
-        if (!d->vkdev->info.support_int8_arithmetic()) opt.use_int8_arithmetic = false;
-        if (!d->vkdev->info.support_cooperative_matrix()) opt.use_cooperative_matrix = false;
-        if (!d->vkdev->info.support_subgroup_ops()) opt.use_subgroup_ops = false;
+    uint64_t environment_digest;
+    std::vector<tuning_entry> entries;
 
-        // enable local memory optimization on discrete gpu only
-        if (d->vkdev->info.type() != 0) opt.use_shader_local_memory = false;
+    // some layer was timed, file needs rewrite
+    bool dirty;
+};
 
-        // fp16a makes no sense when fp16 storage disabled
-        if (!opt.use_fp16_packed && !opt.use_fp16_storage) opt.use_fp16_arithmetic = false;
+static const int tuning_version = 1;
 
-        // int8a makes no sense when int8 storage disabled
-        if (!opt.use_int8_packed && !opt.use_int8_storage) opt.use_int8_arithmetic = false;
+TuningTable::TuningTable(int layer_count)
+{
+    environment_digest = weight_cache_environment_digest();
 
-        // fp16 uniform makes no sense when fp16 arithmetic disabled
-        if (!opt.use_fp16_arithmetic) opt.use_fp16_uniform = false;
-    }
-    else
+    tuning_entry empty_entry;
+    empty_entry.digest = 0;
+    empty_entry.variant = -1;
+    entries.resize(layer_count, empty_entry);
+
+    dirty = false;
+}
+
+void TuningTable::load(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
     {
-        // fp16a makes no sense when fp16 storage disabled
-        if (!opt.use_fp16_storage) opt.use_fp16_arithmetic = false;
+        // first run
+        return;
     }
-#endif // NCNN_VULKAN
 
-    ParamDict pd;
+    int version = 0;
+    unsigned long long file_environment_digest = 0;
+    if (fscanf(fp, "ncnntune %d %llx", &version, &file_environment_digest) != 2
+            || version != tuning_version || file_environment_digest != environment_digest)
+    {
+        // other cpu or build
+        fclose(fp);
+        return;
+    }
 
-    for (int i = 0; i < layer_count; i++)
+    for (;;)
     {
-        int typeindex;
-        int bottom_count;
-        int top_count;
-        READ_VALUE(typeindex)
-        READ_VALUE(bottom_count)
-        READ_VALUE(top_count)
+        int layer_index;
+        unsigned long long digest;
+        int variant;
+        if (fscanf(fp, "%d %llx %d%*[^\n]", &layer_index, &digest, &variant) != 3)
+            break;
 
-        Layer* layer = create_overwrite_builtin_layer(typeindex);
-#if NCNN_VULKAN
-        if (!layer && opt.use_vulkan_compute && d->vkdev)
-        {
-            layer = create_layer_vulkan(typeindex);
-        }
-#endif // NCNN_VULKAN
-        if (!layer)
+        if (layer_index < 0 || layer_index >= (int)entries.size() || variant < 0)
         {
-            layer = create_layer_cpu(typeindex);
-        }
-        if (!layer)
-        {
-            int custom_index = typeindex & ~LayerType::CustomBit;
-            layer = create_custom_layer(custom_index);
-        }
-        if (!layer)
-        {
-            NCNN_LOGE("layer %d not exists or registered", typeindex);
-            clear();
-            return -1;
+            NCNN_LOGE("tuning file %s is corrupted", path);
+            break;
         }
 
-#if NCNN_VULKAN
-        if (opt.use_vulkan_compute)
-            layer->vkdev = d->vkdev;
-#endif // NCNN_VULKAN
+        entries[layer_index].digest = digest;
+        entries[layer_index].variant = variant;
+    }
 
-        //         layer->type = std::string(layer_type);
-        //         layer->name = std::string(layer_name);
-        //         NCNN_LOGE("new layer %d", typeindex);
+    fclose(fp);
+}
 
-        layer->bottoms.resize(bottom_count);
-        for (int j = 0; j < bottom_count; j++)
-        {
-            int bottom_blob_index;
-            READ_VALUE(bottom_blob_index)
+int TuningTable::lookup(int layer_index, uint64_t digest) const
+{
+    const tuning_entry& entry = entries[layer_index];
+    if (entry.digest != digest)
+        return -1;
 
-            Blob& blob = d->blobs[bottom_blob_index];
+    return entry.variant;
+}
 
-            blob.consumer = i;
+void TuningTable::store(int layer_index, uint64_t digest, int variant)
+{
+    tuning_entry& entry = entries[layer_index];
+    entry.digest = digest;
+    entry.variant = variant;
 
-            layer->bottoms[j] = bottom_blob_index;
-        }
+    dirty = true;
+}
 
-        layer->tops.resize(top_count);
-        for (int j = 0; j < top_count; j++)
-        {
-            int top_blob_index;
-            READ_VALUE(top_blob_index)
+int TuningTable::save(const char* path, const std::vector<Layer*>& layers) const
+{
+    // write aside and rename, concurrent loaders never see a partial file
+    std::string tmppath = std::string(path) + ".tmp";
 
-            Blob& blob = d->blobs[top_blob_index];
+    FILE* fp = fopen(tmppath.c_str(), "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", tmppath.c_str());
+        return -1;
+    }
 
-            //             blob.name = std::string(blob_name);
-            //             NCNN_LOGE("new blob %s", blob_name);
+    bool ok = fprintf(fp, "ncnntune %d %016llx\n", tuning_version, (unsigned long long)environment_digest) > 0;
 
-            blob.producer = i;
+    for (size_t i = 0; i < entries.size() && ok; i++)
+    {
+        const tuning_entry& entry = entries[i];
+        if (entry.variant == -1)
+            continue;
 
-            layer->tops[j] = top_blob_index;
-        }
+#if NCNN_STRING
+        const char* layer_name = layers[i]->name.c_str();
+#else
+        const char* layer_name = "";
+#endif
+        ok = fprintf(fp, "%d %016llx %d %s\n", (int)i, (unsigned long long)entry.digest, entry.variant, layer_name) > 0;
+    }
 
-        int layer_support_vulkan = layer->support_vulkan;
+    ok = fclose(fp) == 0 && ok;
 
-        // layer specific params
-        int pdlr = pd.load_param_bin(dr);
-        if (pdlr != 0)
+    if (!ok)
+    {
+        NCNN_LOGE("write tuning file %s failed", tmppath.c_str());
+        remove(tmppath.c_str());
+        return -1;
+    }
+
+    if (rename(tmppath.c_str(), path) != 0)
+    {
+        // rename does not replace existing file on windows
+        remove(path);
+        if (rename(tmppath.c_str(), path) != 0)
         {
-            NCNN_LOGE("ParamDict load_param_bin %d failed", i);
-            continue;
+            NCNN_LOGE("rename tuning file %s failed", path);
+            remove(tmppath.c_str());
+            return -1;
         }
+    }
 
-        // pull out top blob shape hints
-        Mat shape_hints = pd.get(30, Mat());
-        if (!shape_hints.empty())
+    return 0;
+}
+
+// run each kernel variant on input of the bottom shape hints
+// return the fastest variant, -1 if the shapes are unknown
+int NetPrivate::tune_layer(Layer* layer, const std::vector<int>& variants, const Option& opt) const
+{
+    const size_t bottom_count = layer->bottoms.size();
+    if (layer->bottom_shapes.size() != bottom_count || (layer->one_blob_only && bottom_count != 1))
+        return -1;
+
+    Option opt1 = opt;
+    opt1.lightmode = false; // keep weight data for the next variant
+
+    std::vector<Mat> bottom_blobs(bottom_count);
+    for (size_t i = 0; i < bottom_count; i++)
+    {
+        const Mat& shape = layer->bottom_shapes[i];
+
+        Mat& m = bottom_blobs[i];
+        if (shape.dims == 1) m.create(shape.w);
+        if (shape.dims == 2) m.create(shape.w, shape.h);
+        if (shape.dims == 3) m.create(shape.w, shape.h, shape.c);
+        if (shape.dims == 4) m.create(shape.w, shape.h, shape.d, shape.c);
+        if (m.empty())
+            return -1;
+
+        m.fill(0.5f);
+
+        int ret = convert_layout(m, layer, opt1);
+        if (ret != 0)
+            return -1;
+    }
+
+    std::vector<Mat*> weights;
+    layer->pipeline_weights(weights);
+
+    int best_variant = -1;
+    double best_time = 0;
+    for (size_t i = 0; i < variants.size(); i++)
+    {
+        layer->tuning_variant = variants[i];
+
+        double time = -1;
+        if (layer->create_pipeline(opt1) == 0)
         {
-            const int* psh = shape_hints;
-            for (int j = 0; j < top_count; j++)
+            // the first run warms up caches and allocators
+            for (int j = 0; j < 4; j++)
             {
-                Blob& blob = d->blobs[layer->tops[j]];
+                std::vector<Mat> top_blobs(layer->tops.size());
 
-                int dims = psh[0];
-                if (dims == 1)
-                {
-                    blob.shape = Mat(psh[1], (void*)0, 4u, 1);
-                }
-                if (dims == 2)
-                {
-                    blob.shape = Mat(psh[1], psh[2], (void*)0, 4u, 1);
-                }
-                if (dims == 3)
+                double start = get_current_time();
+
+                int ret = layer->one_blob_only ? layer->forward(bottom_blobs[0], top_blobs[0], opt1) : layer->forward(bottom_blobs, top_blobs, opt1);
+
+                double end = get_current_time();
+
+                if (ret != 0)
                 {
-                    blob.shape = Mat(psh[1], psh[2], psh[3], (void*)0, 4u, 1);
+                    time = -1;
+                    break;
                 }
 
-                psh += 4;
+                if (j > 0 && (time < 0 || end - start < time))
+                    time = end - start;
             }
         }
 
-        // set bottom and top shape hints
-        layer->bottom_shapes.resize(bottom_count);
-        for (int j = 0; j < bottom_count; j++)
-        {
-            layer->bottom_shapes[j] = d->blobs[layer->bottoms[j]].shape;
-        }
-
-        layer->top_shapes.resize(top_count);
-        for (int j = 0; j < top_count; j++)
-        {
-            layer->top_shapes[j] = d->blobs[layer->tops[j]].shape;
-        }
-
-        // pull out layer specific feature disabled set
-        layer->featmask = pd.get(31, 0);
+        layer->destroy_pipeline(opt1);
 
-        int lr = layer->load_param(pd);
-        if (lr != 0)
+        // drop the transformed weights, create_pipeline skips preparing filled ones
+        for (size_t j = 0; j < weights.size(); j++)
         {
-            NCNN_LOGE("layer load_param %d failed", i);
-            continue;
+            weights[j]->release();
         }
 
-        if (layer->support_int8_storage)
+        if (time >= 0 && (best_variant == -1 || time < best_time))
         {
-            // no int8 gpu support yet
-            opt.use_vulkan_compute = false;
+            best_variant = variants[i];
+            best_time = time;
         }
+    }
 
-        Option opt1 = get_masked_option(opt, layer->featmask);
-
-        if (layer_support_vulkan && (!layer->support_vulkan || !opt1.use_vulkan_compute))
-        {
-            // vulkan layer cannot handle these param, recreate cpu layer
-            Layer* layer_cpu = create_overwrite_builtin_layer(typeindex);
-            if (!layer_cpu)
-            {
-                layer_cpu = create_layer_cpu(typeindex);
-            }
-            if (!layer_cpu)
-            {
-                int custom_index = typeindex & ~LayerType::CustomBit;
-                layer_cpu = create_custom_layer(custom_index);
-            }
-            if (!layer_cpu)
-            {
-                NCNN_LOGE("layer %d not exists or registered", typeindex);
-                clear();
-                return -1;
-            }
+    layer->tuning_variant = 0;
 
-            layer_cpu->bottoms = layer->bottoms;
-            layer_cpu->tops = layer->tops;
-            layer_cpu->bottom_shapes = layer->bottom_shapes;
-            layer_cpu->top_shapes = layer->top_shapes;
-            layer_cpu->featmask = layer->featmask;
+    return best_variant;
+}
+#endif // NCNN_STDIO
 
-            int lr = layer_cpu->load_param(pd);
-            if (lr != 0)
-            {
-                NCNN_LOGE("layer load_param %d failed", i);
-                continue;
-            }
+// read weight data into fresh memory instead of referencing the source
+class DataReaderNoReference : public DataReader
+{
+public:
+    DataReaderNoReference(const DataReader& _dr)
+        : dr(_dr)
+    {
+    }
 
-            delete layer;
-            layer = layer_cpu;
-        }
+#if NCNN_STRING
+    virtual int scan(const char* format, void* p) const
+    {
+        return dr.scan(format, p);
+    }
+#endif // NCNN_STRING
 
-        d->layers[i] = layer;
+    virtual size_t read(void* buf, size_t size) const
+    {
+        return dr.read(buf, size);
     }
 
-    d->update_input_output_indexes();
+public:
+    const DataReader& dr;
+};
+
+// numa memory policy for the loading thread and its openmp threads
+static int set_numa_memory_policy(int node, int num_threads)
+{
+    std::vector<int> policyrets(num_threads, 0);
+    #pragma omp parallel for num_threads(num_threads)
+    for (int i = 0; i < num_threads; i++)
+    {
+        policyrets[i] = set_current_thread_numa_memory_policy(node);
+    }
+    for (int i = 0; i < num_threads; i++)
+    {
+        if (policyrets[i] != 0)
+            return -1;
+    }
 
-#undef READ_VALUE
     return 0;
 }
 
@@ -1566,7 +3473,40 @@ int Net::load_model(const DataReader& dr)
     }
 #endif // NCNN_VULKAN
 
-    ModelBinFromDataReader mb(dr);
+    // weights and packed weights are placed by the pages first touched from here
+    if (opt.weight_numa_node != -1)
+    {
+        if (set_numa_memory_policy(opt.weight_numa_node, opt.num_threads) != 0)
+        {
+            NCNN_LOGE("weight numa placement on node %d not available", opt.weight_numa_node);
+        }
+    }
+
+#if NCNN_STDIO
+    const bool use_weight_cache = !d->weight_cache_path.empty();
+
+    WeightCache weight_cache(use_weight_cache ? layer_count : 0);
+    if (use_weight_cache)
+    {
+        weight_cache.load(d->weight_cache_path.c_str());
+    }
+
+    const bool use_tuning = !d->tuning_path.empty();
+
+    TuningTable tuning_table(use_tuning ? layer_count : 0);
+    if (use_tuning)
+    {
+        tuning_table.load(d->tuning_path.c_str());
+    }
+
+    DataReaderHash drh(dr);
+    DataReaderNoReference drn(use_weight_cache ? (const DataReader&)drh : dr);
+    ModelBinFromDataReader mb(opt.weight_numa_node != -1 ? (const DataReader&)drn : use_weight_cache ? (const DataReader&)drh : dr);
+#else
+    DataReaderNoReference drn(dr);
+    ModelBinFromDataReader mb(opt.weight_numa_node != -1 ? (const DataReader&)drn : dr);
+#endif // NCNN_STDIO
+
     for (int i = 0; i < layer_count; i++)
     {
         Layer* layer = d->layers[i];
@@ -1592,6 +3532,50 @@ int Net::load_model(const DataReader& dr)
         }
 
         Option opt1 = get_masked_option(opt, layer->featmask);
+        opt1.num_threads = d->layer_num_threads(i, opt1);
+
+#if NCNN_STDIO
+        if (use_tuning)
+        {
+            std::vector<int> variants;
+            layer->tuning_variants(variants, opt1);
+            if (variants.size() > 1)
+            {
+                const uint64_t tuning_digest = layer_pipeline_digest(0xcbf29ce484222325ULL, i, layer, opt1);
+
+                // the recorded variant must still be a candidate of the layer
+                int variant = tuning_table.lookup(i, tuning_digest);
+                bool recorded = false;
+                for (size_t j = 0; j < variants.size(); j++)
+                {
+                    recorded = recorded || variants[j] == variant;
+                }
+
+                if (!recorded)
+                {
+                    variant = d->tune_layer(layer, variants, opt1);
+                    if (variant != -1)
+                    {
+                        tuning_table.store(i, tuning_digest, variant);
+                    }
+                }
+
+                layer->tuning_variant = variant == -1 ? 0 : variant;
+            }
+        }
+
+        std::vector<Mat*> weights;
+        uint64_t weight_digest = 0;
+        if (use_weight_cache)
+        {
+            layer->pipeline_weights(weights);
+            if (!weights.empty())
+            {
+                weight_digest = weight_cache_layer_digest(drh.hash, i, layer, opt1);
+                weight_cache.restore(i, weight_digest, weights);
+            }
+        }
+#endif // NCNN_STDIO
 
         int cret = layer->create_pipeline(opt1);
         if (cret != 0)
@@ -1604,7 +3588,33 @@ int Net::load_model(const DataReader& dr)
             ret = -1;
             break;
         }
+
+#if NCNN_STDIO
+        if (!weights.empty())
+        {
+            weight_cache.store(i, weight_digest, weights);
+        }
+#endif // NCNN_STDIO
+    }
+
+    if (opt.weight_numa_node != -1)
+    {
+        set_numa_memory_policy(-1, opt.num_threads);
+    }
+
+#if NCNN_STDIO
+    if (ret == 0 && use_weight_cache && weight_cache.dirty)
+    {
+        // not fatal, the next load_model computes and tries again
+        weight_cache.save(d->weight_cache_path.c_str());
+    }
+
+    if (ret == 0 && use_tuning && tuning_table.dirty)
+    {
+        // not fatal, the next load_model times again
+        tuning_table.save(d->tuning_path.c_str(), d->layers);
     }
+#endif // NCNN_STDIO
 
     if (opt.use_local_pool_allocator)
     {
@@ -1705,6 +3715,28 @@ int Net::load_model(const char* modelpath)
     fclose(fp);
     return ret;
 }
+
+int Net::load_model_mmap(const char* modelpath)
+{
+    if (d->model_mmap)
+    {
+        NCNN_LOGE("model already mapped, please clear() first");
+        return -1;
+    }
+
+    DataReaderFromMmap* dr = new DataReaderFromMmap(modelpath);
+    if (!dr->mapped())
+    {
+        NCNN_LOGE("mmap %s failed", modelpath);
+        delete dr;
+        return -1;
+    }
+
+    // weight data may reference the mapped pages, keep mapping alive until clear()
+    d->model_mmap = dr;
+
+    return load_model(*dr);
+}
 #endif // NCNN_STDIO
 
 int Net::load_param(const unsigned char* _mem)
@@ -1792,6 +3824,8 @@ int Net::load_model(AAssetManager* mgr, const char* assetpath)
 void Net::clear()
 {
     d->blobs.clear();
+    d->blob_consumers.clear();
+    d->layer_graph_width.clear();
     for (size_t i = 0; i < d->layers.size(); i++)
     {
         Layer* layer = d->layers[i];
@@ -1843,6 +3877,14 @@ void Net::clear()
     }
     d->layers.clear();
 
+#if NCNN_THREADS
+    if (d->parallel_graph_pool)
+    {
+        delete d->parallel_graph_pool;
+        d->parallel_graph_pool = 0;
+    }
+#endif // NCNN_THREADS
+
     if (d->local_blob_allocator)
     {
         delete d->local_blob_allocator;
@@ -1854,6 +3896,20 @@ void Net::clear()
         d->local_workspace_allocator = 0;
     }
 
+#if NCNN_STDIO
+    if (d->model_mmap)
+    {
+        delete d->model_mmap;
+        d->model_mmap = 0;
+    }
+#endif // NCNN_STDIO
+
+    if (d->memory_plan)
+    {
+        d->memory_plan->release();
+        d->memory_plan = 0;
+    }
+
 #if NCNN_VULKAN
     if (d->weight_vkallocator)
     {
@@ -2053,6 +4109,23 @@ public:
     std::vector<Mat> blob_mats;
     Option opt;
 
+    // per-sample blob mats of batched extraction
+    std::vector<std::vector<Mat> > batch_blob_mats;
+
+    PlannedAllocator* planned_allocator;
+
+    bool profiling;
+    std::vector<LayerProfile> layer_profiles;
+    ProfileAllocator* profile_allocator;
+
+    // bound recurrent states, fed from out blob back to in blob across runs
+    std::vector<int> state_in_indexes;
+    std::vector<int> state_out_indexes;
+    std::vector<Mat> state_mats;
+
+    // extract() has run since the current run began
+    bool forwarded;
+
 #if NCNN_VULKAN
     VkAllocator* local_blob_vkallocator;
     VkAllocator* local_staging_vkallocator;
@@ -2061,11 +4134,103 @@ public:
 #endif // NCNN_VULKAN
 };
 
+// mats in the planned arena of another extractor die with it, take private copies
+static void detach_planned_mats(std::vector<Mat>& mats, const PlannedAllocator* planned_allocator)
+{
+    if (!planned_allocator)
+        return;
+
+    for (size_t i = 0; i < mats.size(); i++)
+    {
+        if (mats[i].allocator == planned_allocator)
+            mats[i] = mats[i].clone();
+    }
+}
+
+static int convert_extracted_blob(Mat& feat, int type, const Option& opt)
+{
+    if (opt.use_packing_layout && (type == 0) && feat.elempack != 1)
+    {
+        Mat bottom_blob_unpacked;
+        convert_packing(feat, bottom_blob_unpacked, 1, opt);
+        feat = bottom_blob_unpacked;
+        if (feat.empty())
+            return -100;
+    }
+
+    // clang-format off
+    // *INDENT-OFF*
+#if NCNN_ARM82
+    if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_ARM82
+#if NCNN_VFPV4
+    if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_VFPV4
+#if NCNN_ZVFH
+    if (opt.use_fp16_storage && cpu_support_riscv_zvfh() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_ZVFH
+#if NCNN_BF16
+    if (opt.use_bf16_storage && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_bfloat16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_BF16
+    if (feat.elembits() == 8 && (type == 0))
+    {
+        Mat feat_fp32;
+        cast_int8_to_float32(feat, feat_fp32, opt);
+        feat = feat_fp32;
+    }
+    // *INDENT-ON*
+    // clang-format on
+    if (feat.empty())
+        return -100;
+
+    return 0;
+}
+
 Extractor::Extractor(const Net* _net, size_t blob_count)
     : d(new ExtractorPrivate(_net))
 {
     d->blob_mats.resize(blob_count);
     d->opt = d->net->opt;
+    d->planned_allocator = 0;
+    d->profiling = false;
+    d->profile_allocator = 0;
+    d->forwarded = false;
 
 #if NCNN_VULKAN
     if (d->net->opt.use_vulkan_compute)
@@ -2082,6 +4247,8 @@ Extractor::~Extractor()
 {
     clear();
 
+    delete d->profile_allocator;
+
     delete d;
 }
 
@@ -2091,6 +4258,28 @@ Extractor::Extractor(const Extractor& rhs)
     d->net = rhs.d->net;
     d->blob_mats = rhs.d->blob_mats;
     d->opt = rhs.d->opt;
+    d->batch_blob_mats = rhs.d->batch_blob_mats;
+    d->profiling = rhs.d->profiling;
+    d->layer_profiles = rhs.d->layer_profiles;
+    d->state_in_indexes = rhs.d->state_in_indexes;
+    d->state_out_indexes = rhs.d->state_out_indexes;
+    d->state_mats = rhs.d->state_mats;
+    d->forwarded = rhs.d->forwarded;
+    d->profile_allocator = 0;
+
+    // planned allocator is owned by rhs
+    d->planned_allocator = 0;
+    if (d->opt.blob_allocator == rhs.d->planned_allocator)
+        d->opt.blob_allocator = 0;
+    if (d->opt.workspace_allocator == rhs.d->planned_allocator)
+        d->opt.workspace_allocator = 0;
+
+    detach_planned_mats(d->blob_mats, rhs.d->planned_allocator);
+    for (size_t b = 0; b < d->batch_blob_mats.size(); b++)
+    {
+        detach_planned_mats(d->batch_blob_mats[b], rhs.d->planned_allocator);
+    }
+    detach_planned_mats(d->state_mats, rhs.d->planned_allocator);
 
 #if NCNN_VULKAN
     d->local_blob_vkallocator = 0;
@@ -2105,9 +4294,35 @@ Extractor& Extractor::operator=(const Extractor& rhs)
     if (this == &rhs)
         return *this;
 
+    if (d->planned_allocator)
+    {
+        // retire the planned allocator before dropping blob mats
+        clear();
+    }
+
     d->net = rhs.d->net;
     d->blob_mats = rhs.d->blob_mats;
     d->opt = rhs.d->opt;
+    d->batch_blob_mats = rhs.d->batch_blob_mats;
+    d->profiling = rhs.d->profiling;
+    d->layer_profiles = rhs.d->layer_profiles;
+    d->state_in_indexes = rhs.d->state_in_indexes;
+    d->state_out_indexes = rhs.d->state_out_indexes;
+    d->state_mats = rhs.d->state_mats;
+    d->forwarded = rhs.d->forwarded;
+
+    d->planned_allocator = 0;
+    if (d->opt.blob_allocator == rhs.d->planned_allocator)
+        d->opt.blob_allocator = 0;
+    if (d->opt.workspace_allocator == rhs.d->planned_allocator)
+        d->opt.workspace_allocator = 0;
+
+    detach_planned_mats(d->blob_mats, rhs.d->planned_allocator);
+    for (size_t b = 0; b < d->batch_blob_mats.size(); b++)
+    {
+        detach_planned_mats(d->batch_blob_mats[b], rhs.d->planned_allocator);
+    }
+    detach_planned_mats(d->state_mats, rhs.d->planned_allocator);
 
 #if NCNN_VULKAN
     d->local_blob_vkallocator = 0;
@@ -2122,6 +4337,31 @@ Extractor& Extractor::operator=(const Extractor& rhs)
 void Extractor::clear()
 {
     d->blob_mats.clear();
+    d->batch_blob_mats.clear();
+
+    if (d->planned_allocator)
+    {
+        // publish the allocation sequence of this run for later extractors
+        MemoryPlan* recorded = d->planned_allocator->recorded_plan();
+        if (recorded)
+        {
+            NetPrivate* net_d = d->net->d;
+
+            net_d->memory_plan_lock.lock();
+            if (net_d->memory_plan)
+                net_d->memory_plan->release();
+            net_d->memory_plan = recorded;
+            net_d->memory_plan_lock.unlock();
+        }
+
+        if (d->opt.blob_allocator == d->planned_allocator)
+            d->opt.blob_allocator = 0;
+        if (d->opt.workspace_allocator == d->planned_allocator)
+            d->opt.workspace_allocator = 0;
+
+        delete d->planned_allocator;
+        d->planned_allocator = 0;
+    }
 
 #if NCNN_VULKAN
     if (d->opt.use_vulkan_compute)
@@ -2163,6 +4403,94 @@ void Extractor::set_workspace_allocator(Allocator* allocator)
     d->opt.workspace_allocator = allocator;
 }
 
+void Extractor::set_thread_pool(ThreadPool* pool)
+{
+    d->opt.thread_pool = pool;
+}
+
+void Extractor::set_profiling(bool enable)
+{
+    d->profiling = enable;
+    d->layer_profiles.clear();
+
+    if (enable && !d->profile_allocator)
+    {
+        d->profile_allocator = new ProfileAllocator;
+    }
+}
+
+const std::vector<LayerProfile>& Extractor::layer_profiles() const
+{
+    return d->layer_profiles;
+}
+
+#if NCNN_STDIO
+static void write_chrome_trace_string(FILE* fp, const char* str)
+{
+    fputc('"', fp);
+    for (const char* p = str; *p; p++)
+    {
+        if (*p == '"' || *p == '\\')
+            fputc('\\', fp);
+        fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+
+static void write_chrome_trace_shapes(FILE* fp, const std::vector<Mat>& shapes)
+{
+    fprintf(fp, "[");
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        const Mat& m = shapes[i];
+        fprintf(fp, "%s{\"dims\":%d,\"w\":%d,\"h\":%d,\"d\":%d,\"c\":%d,\"elempack\":%d,\"elemsize\":%d}", i == 0 ? "" : ",", m.dims, m.w, m.h, m.d, m.c, m.elempack, (int)m.elemsize);
+    }
+    fprintf(fp, "]");
+}
+
+int Extractor::save_chrome_trace(const char* path) const
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", path);
+        return -1;
+    }
+
+    const std::vector<LayerProfile>& profiles = d->layer_profiles;
+    const double origin = profiles.empty() ? 0.0 : profiles[0].start;
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < profiles.size(); i++)
+    {
+        const LayerProfile& profile = profiles[i];
+
+        // complete event, timestamps in us
+        fprintf(fp, "{\"ph\":\"X\",\"pid\":0,\"tid\":0,\"name\":");
+#if NCNN_STRING
+        write_chrome_trace_string(fp, profile.name.c_str());
+        fprintf(fp, ",\"cat\":");
+        write_chrome_trace_string(fp, profile.type.c_str());
+#else
+        fprintf(fp, "\"%d\",\"cat\":\"%d\"", profile.layer_index, profile.typeindex);
+#endif // NCNN_STRING
+        fprintf(fp, ",\"ts\":%.3f,\"dur\":%.3f", (profile.start - origin) * 1000, (profile.end - profile.start) * 1000);
+        fprintf(fp, ",\"args\":{\"layer_index\":%d,\"num_threads\":%d,\"bytes_allocated\":%lu,\"kernel\":", profile.layer_index, profile.num_threads, (unsigned long)profile.bytes_allocated);
+        write_chrome_trace_string(fp, profile.kernel);
+        fprintf(fp, ",\"bottoms\":");
+        write_chrome_trace_shapes(fp, profile.bottom_shapes);
+        fprintf(fp, ",\"tops\":");
+        write_chrome_trace_shapes(fp, profile.top_shapes);
+        fprintf(fp, "}}%s\n", i + 1 == profiles.size() ? "" : ",");
+    }
+    fprintf(fp, "]}\n");
+
+    fclose(fp);
+
+    return 0;
+}
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
 void Extractor::set_vulkan_compute(bool enable)
 {
@@ -2222,13 +4550,189 @@ int Extractor::extract(const char* blob_name, Mat& feat, int type)
 
     return extract(blob_index, feat, type);
 }
+
+int Extractor::input_batch(const char* blob_name, const std::vector<Mat>& in)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+    {
+        NCNN_LOGE("Try");
+        const std::vector<const char*>& input_names = d->net->input_names();
+        for (size_t i = 0; i < input_names.size(); i++)
+        {
+            NCNN_LOGE("    ex.input_batch(\"%s\", in%d);", input_names[i], (int)i);
+        }
+
+        return -1;
+    }
+
+    return input_batch(blob_index, in);
+}
+
+int Extractor::extract_batch(const char* blob_name, std::vector<Mat>& feats, int type)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+    {
+        NCNN_LOGE("Try");
+        const std::vector<const char*>& output_names = d->net->output_names();
+        for (size_t i = 0; i < output_names.size(); i++)
+        {
+            NCNN_LOGE("    ex.extract_batch(\"%s\", out%d);", output_names[i], (int)i);
+        }
+
+        return -1;
+    }
+
+    return extract_batch(blob_index, feats, type);
+}
+
+int Extractor::bind_state(const char* in_blob_name, const char* out_blob_name)
+{
+    int in_blob_index = d->net->find_blob_index_by_name(in_blob_name);
+    if (in_blob_index == -1)
+    {
+        NCNN_LOGE("bind_state no state input blob %s", in_blob_name);
+        return -1;
+    }
+
+    int out_blob_index = d->net->find_blob_index_by_name(out_blob_name);
+    if (out_blob_index == -1)
+    {
+        NCNN_LOGE("bind_state no state output blob %s", out_blob_name);
+        return -1;
+    }
+
+    return bind_state(in_blob_index, out_blob_index);
+}
 #endif // NCNN_STRING
 
+int Extractor::bind_state(int in_blob_index, int out_blob_index)
+{
+    const int blob_count = (int)d->blob_mats.size();
+    if (in_blob_index < 0 || in_blob_index >= blob_count || out_blob_index < 0 || out_blob_index >= blob_count || in_blob_index == out_blob_index)
+        return -1;
+
+    int producer = d->net->blobs()[in_blob_index].producer;
+    if (producer == -1 || d->net->layers()[producer]->typeindex != LayerType::Input)
+    {
+        NCNN_LOGE("bind_state state input blob %d is not produced by an Input layer", in_blob_index);
+        return -1;
+    }
+
+    for (size_t i = 0; i < d->state_in_indexes.size(); i++)
+    {
+        if (d->state_in_indexes[i] == in_blob_index)
+        {
+            // rebind, the carried state is dropped
+            d->state_out_indexes[i] = out_blob_index;
+            d->state_mats[i].release();
+            return 0;
+        }
+    }
+
+    d->state_in_indexes.push_back(in_blob_index);
+    d->state_out_indexes.push_back(out_blob_index);
+    d->state_mats.push_back(Mat());
+
+    return 0;
+}
+
+void Extractor::reset_state()
+{
+    for (size_t i = 0; i < d->state_mats.size(); i++)
+    {
+        d->state_mats[i].release();
+    }
+
+    if (d->forwarded)
+    {
+        begin_run(false);
+        return;
+    }
+
+    // drop the states fed into the current run
+    for (size_t i = 0; i < d->state_in_indexes.size(); i++)
+    {
+        d->blob_mats[d->state_in_indexes[i]].release();
+    }
+}
+
+int Extractor::begin_run(bool carry_state)
+{
+    const size_t state_count = d->state_in_indexes.size();
+
+    if (carry_state)
+    {
+        for (size_t i = 0; i < state_count; i++)
+        {
+            // keep internal layout, the consumers convert it on their own
+            // a state left empty by this run keeps the previous one
+            Mat state;
+            int ret = extract(d->state_out_indexes[i], state, 1);
+            if (ret != 0)
+                return ret;
+
+            if (!state.empty())
+                d->state_mats[i] = state;
+        }
+    }
+
+    // drop the blobs of this run but keep the allocators for the next one
+    const size_t blob_count = d->blob_mats.size();
+
+    d->blob_mats.clear();
+    d->batch_blob_mats.clear();
+#if NCNN_VULKAN
+    if (d->opt.use_vulkan_compute)
+    {
+        d->blob_mats_gpu.clear();
+    }
+#endif // NCNN_VULKAN
+
+    // the next run is placed in the same arena when this run followed the plan
+    // otherwise retire it as clear() does, publishing the recorded plan for a new arena
+    if (d->planned_allocator && !d->planned_allocator->rewind())
+    {
+        clear();
+    }
+
+    d->blob_mats.resize(blob_count);
+#if NCNN_VULKAN
+    if (d->opt.use_vulkan_compute)
+    {
+        d->blob_mats_gpu.resize(blob_count);
+    }
+#endif // NCNN_VULKAN
+
+    for (size_t i = 0; i < state_count; i++)
+    {
+        d->blob_mats[d->state_in_indexes[i]] = d->state_mats[i];
+    }
+
+    d->forwarded = false;
+
+    return 0;
+}
+
+int Extractor::reset_inputs()
+{
+    // carry the states only when this run has produced them
+    return begin_run(d->forwarded);
+}
+
 int Extractor::input(int blob_index, const Mat& in)
 {
     if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
         return -1;
 
+    if (d->forwarded && !d->state_in_indexes.empty())
+    {
+        int ret = begin_run(true);
+        if (ret != 0)
+            return ret;
+    }
+
     d->blob_mats[blob_index] = in;
 
     return 0;
@@ -2239,18 +4743,40 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
     if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
         return -1;
 
+    d->forwarded = true;
+
     int old_blocktime = get_kmp_blocktime();
     set_kmp_blocktime(d->opt.openmp_blocktime);
 
     int old_flush_denormals = get_flush_denormals();
     set_flush_denormals(d->opt.flush_denormals);
 
+    ThreadPool* old_thread_pool = get_current_thread_pool();
+    if (d->opt.thread_pool)
+        set_current_thread_pool(d->opt.thread_pool);
+
     int ret = 0;
 
     if (d->blob_mats[blob_index].dims == 0)
     {
         int layer_index = d->net->blobs()[blob_index].producer;
 
+        // use planned allocator, the layer execution order must be deterministic
+        if (d->opt.use_memory_plan && !d->opt.use_parallel_graph && !d->opt.use_vulkan_compute && !d->planned_allocator)
+        {
+            if (!d->opt.blob_allocator && !d->opt.workspace_allocator)
+            {
+                NetPrivate* net_d = d->net->d;
+
+                net_d->memory_plan_lock.lock();
+                d->planned_allocator = new PlannedAllocator(net_d->memory_plan);
+                net_d->memory_plan_lock.unlock();
+
+                d->opt.blob_allocator = d->planned_allocator;
+                d->opt.workspace_allocator = d->planned_allocator;
+            }
+        }
+
         // use local allocator
         if (d->opt.use_local_pool_allocator)
         {
@@ -2264,6 +4790,9 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
             }
         }
 
+        // planned allocations are keyed by the running layer
+        tls_planned_allocator.set(d->planned_allocator);
+
 #if NCNN_VULKAN
         if (d->opt.use_vulkan_compute)
         {
@@ -2314,12 +4843,31 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
             }
         }
         else
+#endif // NCNN_VULKAN
+        if (d->profiling)
+        {
+            // run serially so that time and memory attribute to a single layer
+            layer_profiler_context profiler;
+            profiler.profiles = &d->layer_profiles;
+            profiler.workspace_allocator = d->profile_allocator;
+
+            tls_layer_profiler.set(&profiler);
+            ret = d->net->d->forward_layer(layer_index, d->blob_mats, d->opt);
+            tls_layer_profiler.set(0);
+        }
+#if NCNN_THREADS
+        // light mode releases consumed blobs, which is only safe when each blob has a single consumer
+        else if (d->opt.use_parallel_graph && d->opt.num_threads > 1 && (d->net->d->blob_consumed_once || !d->opt.lightmode))
+        {
+            ret = d->net->d->forward_layer_parallel(layer_index, d->blob_mats, d->opt);
+        }
+#endif // NCNN_THREADS
+        else
         {
             ret = d->net->d->forward_layer(layer_index, d->blob_mats, d->opt);
         }
-#else
-        ret = d->net->d->forward_layer(layer_index, d->blob_mats, d->opt);
-#endif // NCNN_VULKAN
+
+        tls_planned_allocator.set(0);
     }
 
     feat = d->blob_mats[blob_index];
@@ -2327,89 +4875,151 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
     // empty is valid for outputs
     if (!feat.empty())
     {
-        if (d->opt.use_packing_layout && (type == 0) && feat.elempack != 1)
+        int cret = convert_extracted_blob(feat, type, d->opt);
+        if (cret != 0)
         {
-            Mat bottom_blob_unpacked;
-            convert_packing(feat, bottom_blob_unpacked, 1, d->opt);
-            feat = bottom_blob_unpacked;
-            if (feat.empty())
-                return -100;
+            ret = cret;
         }
-
-        // clang-format off
-        // *INDENT-OFF*
-#if NCNN_ARM82
-        if (d->opt.use_fp16_storage && cpu_support_arm_asimdhp() && (type == 0))
+        else if ((d->opt.use_local_pool_allocator && feat.allocator == d->net->d->local_blob_allocator) || (d->planned_allocator && feat.allocator == d->planned_allocator))
         {
-            if (feat.elembits() == 16)
-            {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
-            }
+            // detach the returned mat from local pool allocator
+            // so we could destroy net instance much earlier
+            feat = feat.clone();
+            if (feat.empty())
+                ret = -100;
         }
-        else
-#endif // NCNN_ARM82
-#if NCNN_VFPV4
-        if (d->opt.use_fp16_storage && !d->opt.use_bf16_storage && cpu_support_arm_vfpv4() && (type == 0))
+    }
+
+    set_kmp_blocktime(old_blocktime);
+    set_flush_denormals(old_flush_denormals);
+
+    if (d->opt.thread_pool)
+        set_current_thread_pool(old_thread_pool);
+
+    return ret;
+}
+
+int Extractor::input_batch(int blob_index, const std::vector<Mat>& in)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    if (in.empty())
+        return -1;
+
+    if (d->batch_blob_mats.empty())
+    {
+        d->batch_blob_mats.resize(in.size(), std::vector<Mat>(d->blob_mats.size()));
+    }
+
+    if (d->batch_blob_mats.size() != in.size())
+    {
+        NCNN_LOGE("input_batch size %d mismatch previous batch size %d", (int)in.size(), (int)d->batch_blob_mats.size());
+        return -1;
+    }
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        d->batch_blob_mats[i][blob_index] = in[i];
+    }
+
+    return 0;
+}
+
+int Extractor::extract_batch(int blob_index, std::vector<Mat>& feats, int type)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    if (d->batch_blob_mats.empty())
+    {
+        NCNN_LOGE("extract_batch requires input_batch first");
+        return -1;
+    }
+
+    if (d->opt.use_vulkan_compute)
+    {
+        NCNN_LOGE("extract_batch is not supported with vulkan compute");
+        return -1;
+    }
+
+    const int batch = (int)d->batch_blob_mats.size();
+
+    // plain inputs are shared by every sample
+    for (size_t i = 0; i < d->blob_mats.size(); i++)
+    {
+        if (d->blob_mats[i].dims == 0)
+            continue;
+
+        for (int b = 0; b < batch; b++)
         {
-            if (feat.elembits() == 16)
-            {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
-            }
+            if (d->batch_blob_mats[b][i].dims == 0)
+                d->batch_blob_mats[b][i] = d->blob_mats[i];
         }
-        else
-#endif // NCNN_VFPV4
-#if NCNN_ZVFH
-        if (d->opt.use_fp16_storage && cpu_support_riscv_zvfh() && (type == 0))
+    }
+
+    int old_blocktime = get_kmp_blocktime();
+    set_kmp_blocktime(d->opt.openmp_blocktime);
+
+    int old_flush_denormals = get_flush_denormals();
+    set_flush_denormals(d->opt.flush_denormals);
+
+    ThreadPool* old_thread_pool = get_current_thread_pool();
+    if (d->opt.thread_pool)
+        set_current_thread_pool(d->opt.thread_pool);
+
+    int ret = 0;
+
+    if (d->batch_blob_mats[0][blob_index].dims == 0)
+    {
+        int layer_index = d->net->blobs()[blob_index].producer;
+
+        // use local allocator
+        if (d->opt.use_local_pool_allocator)
         {
-            if (feat.elembits() == 16)
+            if (!d->opt.blob_allocator)
             {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
+                d->opt.blob_allocator = d->net->d->local_blob_allocator;
             }
-        }
-        else
-#endif // NCNN_ZVFH
-#if NCNN_BF16
-        if (d->opt.use_bf16_storage && (type == 0))
-        {
-            if (feat.elembits() == 16)
+            if (!d->opt.workspace_allocator)
             {
-                Mat feat_fp32;
-                cast_bfloat16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
+                d->opt.workspace_allocator = d->net->d->local_workspace_allocator;
             }
         }
-        else
-#endif // NCNN_BF16
-        if (feat.elembits() == 8 && (type == 0))
-        {
-            Mat feat_fp32;
-            cast_int8_to_float32(feat, feat_fp32, d->opt);
-            feat = feat_fp32;
-        }
-        // *INDENT-ON*
-        // clang-format on
+
+        ret = d->net->d->forward_layer_batch(layer_index, d->batch_blob_mats, d->opt);
+    }
+
+    feats.resize(batch);
+    for (int b = 0; b < batch && ret == 0; b++)
+    {
+        Mat& feat = feats[b];
+        feat = d->batch_blob_mats[b][blob_index];
+
+        // empty is valid for outputs
         if (feat.empty())
-            return -100;
+            continue;
+
+        ret = convert_extracted_blob(feat, type, d->opt);
+        if (ret != 0)
+            break;
 
-        if (d->opt.use_local_pool_allocator && feat.allocator == d->net->d->local_blob_allocator)
+        if ((d->opt.use_local_pool_allocator && feat.allocator == d->net->d->local_blob_allocator) || (d->planned_allocator && feat.allocator == d->planned_allocator))
         {
             // detach the returned mat from local pool allocator
             // so we could destroy net instance much earlier
             feat = feat.clone();
             if (feat.empty())
-                return -100;
+                ret = -100;
         }
     }
 
     set_kmp_blocktime(old_blocktime);
     set_flush_denormals(old_flush_denormals);
 
+    if (d->opt.thread_pool)
+        set_current_thread_pool(old_thread_pool);
+
     return ret;
 }
 
@@ -2457,6 +5067,13 @@ int Extractor::input(int blob_index, const VkMat& in)
     if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
         return -1;
 
+    if (d->forwarded && !d->state_in_indexes.empty())
+    {
+        int ret = begin_run(true);
+        if (ret != 0)
+            return ret;
+    }
+
     d->blob_mats_gpu[blob_index] = in;
 
     return 0;
@@ -2467,12 +5084,18 @@ int Extractor::extract(int blob_index, VkMat& feat, VkCompute& cmd)
     if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
         return -1;
 
+    d->forwarded = true;
+
     int old_blocktime = get_kmp_blocktime();
     set_kmp_blocktime(d->opt.openmp_blocktime);
 
     int old_flush_denormals = get_flush_denormals();
     set_flush_denormals(d->opt.flush_denormals);
 
+    ThreadPool* old_thread_pool = get_current_thread_pool();
+    if (d->opt.thread_pool)
+        set_current_thread_pool(d->opt.thread_pool);
+
     int ret = 0;
 
     if (d->blob_mats_gpu[blob_index].dims == 0)
@@ -2494,6 +5117,9 @@ int Extractor::extract(int blob_index, VkMat& feat, VkCompute& cmd)
     set_kmp_blocktime(old_blocktime);
     set_flush_denormals(old_flush_denormals);
 
+    if (d->opt.thread_pool)
+        set_current_thread_pool(old_thread_pool);
+
     return ret;
 }
 #endif // NCNN_VULKAN
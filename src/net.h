@@ -67,6 +67,21 @@ public:
     // return 0 if success
     int register_custom_layer(int index, layer_creator_func creator, layer_destroyer_func destroyer = 0, void* userdata = 0);
 
+#if NCNN_STDIO
+    // cache the weights transformed in create_pipeline to file
+    // load_model restores them when model, layer, cpu and option all match
+    // and rewrites the file when anything is missing or stale
+    // set before load_model, null path disables the cache
+    void set_weight_cache(const char* cachepath);
+
+    // time the kernel variants of tunable layers on the blob shape hints and keep the fastest,
+    // such as winograd / im2col-gemm / direct of x86 Convolution and tile sizes of x86 Gemm
+    // load_model applies the choices recorded in the tuning file without timing again,
+    // times the layers missing or stale in it and rewrites the file
+    // set before load_model, null path disables tuning
+    void set_tuning_file(const char* tunepath);
+#endif // NCNN_STDIO
+
 #if NCNN_STRING
     int load_param(const DataReader& dr);
 #endif // NCNN_STRING
@@ -92,6 +107,12 @@ public:
     // return 0 if success
     int load_model(FILE* fp);
     int load_model(const char* modelpath);
+
+    // map network weight data from model file
+    // weight data is referenced from the file mapping instead of being copied
+    // the mapping is retained until clear()
+    // return 0 if success
+    int load_model_mmap(const char* modelpath);
 #endif // NCNN_STDIO
 
     // load network structure from external memory
@@ -162,6 +183,37 @@ private:
     NetPrivate* const d;
 };
 
+// per-layer record collected by Extractor profiling
+class NCNN_EXPORT LayerProfile
+{
+public:
+    LayerProfile();
+
+    int layer_index;
+    int typeindex;
+#if NCNN_STRING
+    std::string type;
+    std::string name;
+#endif // NCNN_STRING
+
+    // forward begin and end timestamp in ms, see get_current_time()
+    double start;
+    double end;
+
+    int num_threads;
+
+    // shape only without data, dims w h d c elempack elemsize are kept
+    std::vector<Mat> bottom_shapes;
+    std::vector<Mat> top_shapes;
+
+    // top blob bytes plus workspace bytes allocated during forward
+    size_t bytes_allocated;
+
+    // kernel path reported by the layer, such as winograd43 / sgemm / packed / int8_sgemm
+    // empty string if the layer does not report
+    const char* kernel;
+};
+
 class ExtractorPrivate;
 class NCNN_EXPORT Extractor
 {
@@ -192,6 +244,27 @@ public:
     // set workspace memory allocator
     void set_workspace_allocator(Allocator* allocator);
 
+    // run the cpu threads of this extractor on the pool
+    // the calling thread and its openmp team are pinned to the pool cpus during extract
+    // and get their previous affinity back when it returns, linux only
+    // keep net.opt.num_threads no more than the pool thread count
+    void set_thread_pool(ThreadPool* pool);
+
+    // enable per-layer profiling at runtime, previous records are dropped
+    // layers run one by one on the calling thread while profiling
+    // vulkan layers are not profiled
+    void set_profiling(bool enable);
+
+    // profile records in execution order since profiling was enabled
+    const std::vector<LayerProfile>& layer_profiles() const;
+
+#if NCNN_STDIO
+    // save profile records as chrome trace json
+    // open it in chrome://tracing or https://ui.perfetto.dev
+    // return 0 if success
+    int save_chrome_trace(const char* path) const;
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     // deprecated, no-op
     // instead, set net.opt.use_vulkan_compute before net.load_param()
@@ -214,8 +287,40 @@ public:
     // type = 0, default
     // type = 1, do not convert fp16/bf16 or / and packing
     int extract(const char* blob_name, Mat& feat, int type = 0);
+
+    // set batched input by blob name
+    // return 0 if success
+    int input_batch(const char* blob_name, const std::vector<Mat>& in);
+
+    // get batched result by blob name
+    // return 0 if success
+    int extract_batch(const char* blob_name, std::vector<Mat>& feats, int type = 0);
+
+    // bind a recurrent state by blob name, see bind_state(int, int)
+    // return 0 if success
+    int bind_state(const char* in_blob_name, const char* out_blob_name);
 #endif // NCNN_STRING
 
+    // bind a recurrent state for streaming inference
+    // in_blob_index is the state input blob produced by an Input layer, out_blob_index is the updated state blob
+    // calling input() after extract() starts a new run, where the updated state of the previous run is fed back
+    // states are carried in internal layout, the first run sees empty states and layers start from zeros
+    // batched extraction does not carry states
+    // return 0 if success
+    int bind_state(int in_blob_index, int out_blob_index);
+
+    // drop the carried states, the next run starts from empty states
+    // call it before setting the inputs of the next run
+    void reset_state();
+
+    // start a new run on this extractor, the blobs of the previous run are dropped
+    // allocators are kept, and with opt.use_memory_plan the next run is placed in the same arena
+    // so a stream of same shape inputs runs without reallocating intermediate blobs
+    // bound states are carried as input() after extract() does
+    // set every input of the next run again after calling it
+    // return 0 if success
+    int reset_inputs();
+
     // set input by blob index
     // return 0 if success
     int input(int blob_index, const Mat& in);
@@ -226,6 +331,20 @@ public:
     // type = 1, do not convert fp16/bf16 or / and packing
     int extract(int blob_index, Mat& feat, int type = 0);
 
+    // set batched input by blob index
+    // one mat per sample, every batched input must have the same sample count
+    // blobs set by input() are shared by all samples
+    // return 0 if success
+    int input_batch(int blob_index, const std::vector<Mat>& in);
+
+    // get batched result by blob index, one mat per sample
+    // innerproduct, gemm with constant B and 1x1 convolution run all samples in one weight pass
+    // other layers forward the samples one by one
+    // return 0 if success
+    // type = 0, default
+    // type = 1, do not convert fp16/bf16 or / and packing
+    int extract_batch(int blob_index, std::vector<Mat>& feats, int type = 0);
+
 #if NCNN_VULKAN
 #if NCNN_STRING
     // set input by blob name
@@ -250,6 +369,9 @@ protected:
     friend Extractor Net::create_extractor() const;
     Extractor(const Net* net, size_t blob_count);
 
+    // finish the current run and reset blob mats, feeding back the updated states if carry_state
+    int begin_run(bool carry_state);
+
 private:
     ExtractorPrivate* const d;
 };
@@ -0,0 +1,268 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "nms.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif // __ARM_NEON
+
+namespace ncnn {
+
+// every key is unique with the index tie break, so partitioning never degenerates on equal scores
+static inline bool score_before(float s0, int i0, float s1, int i1)
+{
+    return s0 > s1 || (s0 == s1 && i0 < i1);
+}
+
+static inline void swap_pair(float* scores, int* indices, int a, int b)
+{
+    std::swap(scores[a], scores[b]);
+    std::swap(indices[a], indices[b]);
+}
+
+static void insertion_sort_descent(float* scores, int* indices, int left, int right)
+{
+    for (int i = left + 1; i <= right; i++)
+    {
+        const float s = scores[i];
+        const int id = indices[i];
+
+        int j = i - 1;
+        for (; j >= left && score_before(s, id, scores[j], indices[j]); j--)
+        {
+            scores[j + 1] = scores[j];
+            indices[j + 1] = indices[j];
+        }
+
+        scores[j + 1] = s;
+        indices[j + 1] = id;
+    }
+}
+
+// hoare partition around the median of three
+// on return [left, j] rank before the pivot and [i, right] rank after it
+static void partition_descent(float* scores, int* indices, int left, int right, int& i, int& j)
+{
+    const int mid = left + (right - left) / 2;
+    if (score_before(scores[mid], indices[mid], scores[left], indices[left]))
+        swap_pair(scores, indices, mid, left);
+    if (score_before(scores[right], indices[right], scores[left], indices[left]))
+        swap_pair(scores, indices, right, left);
+    if (score_before(scores[right], indices[right], scores[mid], indices[mid]))
+        swap_pair(scores, indices, right, mid);
+
+    const float ps = scores[mid];
+    const int pi = indices[mid];
+
+    i = left;
+    j = right;
+    while (i <= j)
+    {
+        while (i <= right && score_before(scores[i], indices[i], ps, pi))
+            i++;
+
+        while (j >= left && score_before(ps, pi, scores[j], indices[j]))
+            j--;
+
+        if (i <= j)
+        {
+            swap_pair(scores, indices, i, j);
+            i++;
+            j--;
+        }
+    }
+}
+
+static void sort_descent(float* scores, int* indices, int left, int right)
+{
+    while (right - left > 16)
+    {
+        int i;
+        int j;
+        partition_descent(scores, indices, left, right, i, j);
+
+        // recurse into the smaller side to bound the stack depth
+        if (j - left < right - i)
+        {
+            sort_descent(scores, indices, left, j);
+            left = i;
+        }
+        else
+        {
+            sort_descent(scores, indices, i, right);
+            right = j;
+        }
+    }
+
+    insertion_sort_descent(scores, indices, left, right);
+}
+
+// move the top k to the front in any order
+static void select_descent(float* scores, int* indices, int left, int right, int k)
+{
+    while (right - left > 16)
+    {
+        int i;
+        int j;
+        partition_descent(scores, indices, left, right, i, j);
+
+        if (k <= j)
+            right = j;
+        else if (k >= i)
+            left = i;
+        else
+            return;
+    }
+
+    insertion_sort_descent(scores, indices, left, right);
+}
+
+void topk_descent(const float* scores, int n, int k, std::vector<int>& indices)
+{
+    if (n <= 0 || k == 0)
+    {
+        indices.clear();
+        return;
+    }
+
+    std::vector<float> keys(scores, scores + n);
+    indices.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        indices[i] = i;
+    }
+
+    if (k > 0 && k < n)
+    {
+        select_descent(&keys[0], &indices[0], 0, n - 1, k);
+        sort_descent(&keys[0], &indices[0], 0, k - 1);
+        indices.resize(k);
+    }
+    else
+    {
+        sort_descent(&keys[0], &indices[0], 0, n - 1);
+    }
+}
+
+void nms_sorted_bboxes(const float* boxes, const int* order, int n, float iou_threshold, std::vector<int>& kept, int max_keep)
+{
+    kept.clear();
+
+    if (n <= 0)
+        return;
+
+    // transpose to structure of arrays in rank order, zero padded to 8 boxes
+    // padding boxes have no area and are never suppressed
+    const int nn = (n + 7) / 8 * 8;
+
+    std::vector<float> soa(nn * 5, 0.f);
+    float* x1 = &soa[0];
+    float* y1 = x1 + nn;
+    float* x2 = y1 + nn;
+    float* y2 = x2 + nn;
+    float* areas = y2 + nn;
+
+    for (int i = 0; i < n; i++)
+    {
+        const float* box = boxes + order[i] * 4;
+
+        x1[i] = box[0];
+        y1[i] = box[1];
+        x2[i] = box[2];
+        y2[i] = box[3];
+        areas[i] = (box[2] - box[0]) * (box[3] - box[1]);
+    }
+
+    // one bit per box, set once a kept box suppresses it
+    std::vector<unsigned char> removed(nn / 8, 0);
+
+    for (int i = 0; i < n; i++)
+    {
+        if (removed[i / 8] & (1 << (i % 8)))
+            continue;
+
+        kept.push_back(order[i]);
+
+        if (max_keep > 0 && (int)kept.size() >= max_keep)
+            break;
+
+        // suppress the boxes ranked after i by one iou row
+        // the row starts at the 8-aligned group of i + 1, marking i and earlier boxes again is harmless
+        const float ax1 = x1[i];
+        const float ay1 = y1[i];
+        const float ax2 = x2[i];
+        const float ay2 = y2[i];
+        const float aarea = areas[i];
+
+        int j = (i + 1) / 8 * 8;
+#if __SSE2__
+        {
+            __m128 _ax1 = _mm_set1_ps(ax1);
+            __m128 _ay1 = _mm_set1_ps(ay1);
+            __m128 _ax2 = _mm_set1_ps(ax2);
+            __m128 _ay2 = _mm_set1_ps(ay2);
+            __m128 _aarea = _mm_set1_ps(aarea);
+            __m128 _thresh = _mm_set1_ps(iou_threshold);
+            __m128 _zero = _mm_setzero_ps();
+            for (; j < nn; j += 4)
+            {
+                __m128 _iw = _mm_sub_ps(_mm_min_ps(_ax2, _mm_loadu_ps(x2 + j)), _mm_max_ps(_ax1, _mm_loadu_ps(x1 + j)));
+                __m128 _ih = _mm_sub_ps(_mm_min_ps(_ay2, _mm_loadu_ps(y2 + j)), _mm_max_ps(_ay1, _mm_loadu_ps(y1 + j)));
+                __m128 _inter = _mm_mul_ps(_mm_max_ps(_iw, _zero), _mm_max_ps(_ih, _zero));
+                __m128 _union = _mm_sub_ps(_mm_add_ps(_aarea, _mm_loadu_ps(areas + j)), _inter);
+                __m128 _mask = _mm_cmpgt_ps(_inter, _mm_mul_ps(_thresh, _union));
+                removed[j / 8] |= (unsigned char)(_mm_movemask_ps(_mask) << (j % 8));
+            }
+        }
+#elif __ARM_NEON
+        {
+            static const unsigned int lane_bits[4] = {1, 2, 4, 8};
+            uint32x4_t _lane_bits = vld1q_u32(lane_bits);
+            float32x4_t _ax1 = vdupq_n_f32(ax1);
+            float32x4_t _ay1 = vdupq_n_f32(ay1);
+            float32x4_t _ax2 = vdupq_n_f32(ax2);
+            float32x4_t _ay2 = vdupq_n_f32(ay2);
+            float32x4_t _aarea = vdupq_n_f32(aarea);
+            float32x4_t _thresh = vdupq_n_f32(iou_threshold);
+            float32x4_t _zero = vdupq_n_f32(0.f);
+            for (; j < nn; j += 4)
+            {
+                float32x4_t _iw = vsubq_f32(vminq_f32(_ax2, vld1q_f32(x2 + j)), vmaxq_f32(_ax1, vld1q_f32(x1 + j)));
+                float32x4_t _ih = vsubq_f32(vminq_f32(_ay2, vld1q_f32(y2 + j)), vmaxq_f32(_ay1, vld1q_f32(y1 + j)));
+                float32x4_t _inter = vmulq_f32(vmaxq_f32(_iw, _zero), vmaxq_f32(_ih, _zero));
+                float32x4_t _union = vsubq_f32(vaddq_f32(_aarea, vld1q_f32(areas + j)), _inter);
+                uint32x4_t _mask = vandq_u32(vcgtq_f32(_inter, vmulq_f32(_thresh, _union)), _lane_bits);
+                uint32x2_t _bits = vadd_u32(vget_low_u32(_mask), vget_high_u32(_mask));
+                _bits = vpadd_u32(_bits, _bits);
+                removed[j / 8] |= (unsigned char)(vget_lane_u32(_bits, 0) << (j % 8));
+            }
+        }
+#endif // __SSE2__ || __ARM_NEON
+        for (; j < nn; j++)
+        {
+            float iw = std::min(ax2, x2[j]) - std::max(ax1, x1[j]);
+            float ih = std::min(ay2, y2[j]) - std::max(ay1, y1[j]);
+            float inter = std::max(iw, 0.f) * std::max(ih, 0.f);
+            float union_area = aarea + areas[j] - inter;
+            if (inter > iou_threshold * union_area)
+                removed[j / 8] |= (unsigned char)(1 << (j % 8));
+        }
+    }
+}
+
+} // namespace ncnn
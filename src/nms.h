@@ -0,0 +1,37 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_NMS_H
+#define NCNN_NMS_H
+
+#include "platform.h"
+
+namespace ncnn {
+
+// detection post-processing shared by DetectionOutput, Proposal and the yolo layers
+// boxes are stored as xmin ymin xmax ymax float quadruples
+
+// indices of the k highest scores in descending order, equal scores keep the lower index first
+// k < 0 or k >= n sorts all n scores, otherwise the top k are selected in linear time and only they are sorted
+NCNN_EXPORT void topk_descent(const float* scores, int n, int k, std::vector<int>& indices);
+
+// greedy non-maximum suppression
+// order lists n box indices sorted by score descending
+// a box is dropped when intersection > iou_threshold * union with any kept box ranked before it
+// kept receives the box indices in order, stops after max_keep boxes when max_keep > 0
+NCNN_EXPORT void nms_sorted_bboxes(const float* boxes, const int* order, int n, float iou_threshold, std::vector<int>& kept, int max_keep = -1);
+
+} // namespace ncnn
+
+#endif // NCNN_NMS_H
@@ -78,9 +78,12 @@ Option::Option()
     use_fp16_uniform = true;
     use_int8_uniform = true;
 
-    use_reserved_9 = false;
-    use_reserved_10 = false;
+    use_parallel_graph = false;
+    use_memory_plan = false;
     use_reserved_11 = false;
+
+    thread_pool = 0;
+    weight_numa_node = -1;
 }
 
 } // namespace ncnn
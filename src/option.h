@@ -25,6 +25,7 @@ class PipelineCache;
 #endif // NCNN_VULKAN
 
 class Allocator;
+class ThreadPool;
 class NCNN_EXPORT Option
 {
 public:
@@ -152,9 +153,34 @@ public:
     bool use_fp16_uniform;
     bool use_int8_uniform;
 
-    bool use_reserved_9;
-    bool use_reserved_10;
+    // enable inter-layer parallel inference
+    // independent graph branches run concurrently, each taking a share of num_threads
+    // the share is fixed per layer from the graph width, enable it before load_model
+    // blob and workspace allocators must be thread-safe when enabled
+    // disabled by default
+    bool use_parallel_graph;
+
+    // enable static memory plan
+    // intermediate blobs and workspace of an extraction are placed in one preallocated arena
+    // offsets are solved from the blob lifetimes recorded in the previous extraction
+    // and solved again when input shape or extract order changes
+    // disabled by default
+    bool use_memory_plan;
     bool use_reserved_11;
+
+    // run the cpu threads on this pool, the pool cpus become the island of the network
+    // num_threads should not exceed the pool thread count
+    // default value is null, all threads come from the global openmp runtime
+    ThreadPool* thread_pool;
+
+    // numa placement of the weights, packed weights from create_pipeline included
+    // -1 = no placement, pages follow the memory policy of the loading threads
+    // -2 = interleave the pages across all numa nodes
+    // n = place the weights on numa node n, load one net per node for per-node replicas
+    // weights are copied out of mapped or user memory when enabled
+    // changes should be applied before loading model
+    // default value is -1
+    int weight_numa_node;
 };
 
 } // namespace ncnn
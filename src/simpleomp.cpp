@@ -18,6 +18,7 @@
 
 #include "simpleomp.h"
 #include "cpu.h" // ncnn::get_cpu_count()
+#include "threadpool.h" // ncnn::get_current_thread_pool()
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -499,6 +500,42 @@ static void* kmp_threadfunc(void* args)
     return 0;
 }
 
+// a parallel region running on the thread pool of the calling thread
+struct KMPPoolRegion
+{
+#if __clang__
+    kmpc_micro fn;
+    int argc;
+    void** argv;
+#else
+    void (*fn)(void*);
+    void* data;
+#endif
+};
+
+static void kmp_pool_threadfunc(int thread_num, int num_threads, void* userdata)
+{
+    const KMPPoolRegion* region = (const KMPPoolRegion*)userdata;
+
+    tls_num_threads.set(reinterpret_cast<void*>((size_t)num_threads));
+    tls_thread_num.set(reinterpret_cast<void*>((size_t)thread_num));
+
+#if __clang__
+    kmp_invoke_microtask(region->fn, thread_num, thread_num, region->argc, region->argv);
+#else
+    region->fn(region->data);
+#endif
+}
+
+static void kmp_pool_parallel(ncnn::ThreadPool* pool, const KMPPoolRegion& region, int num_threads)
+{
+    pool->run(num_threads, kmp_pool_threadfunc, (void*)&region);
+
+    // the calling thread may have helped with other thread numbers
+    tls_num_threads.set(reinterpret_cast<void*>((size_t)num_threads));
+    tls_thread_num.set(reinterpret_cast<void*>((size_t)0));
+}
+
 #if __clang__
 int32_t __kmpc_global_thread_num(void* /*loc*/)
 {
@@ -529,6 +566,17 @@ void __kmpc_fork_call(void* /*loc*/, int32_t argc, kmpc_micro fn, ...)
         va_end(ap);
     }
 
+    ncnn::ThreadPool* pool = ncnn::get_current_thread_pool();
+    if (pool && num_threads > 1)
+    {
+        KMPPoolRegion region;
+        region.fn = fn;
+        region.argc = argc;
+        region.argv = argv;
+        kmp_pool_parallel(pool, region, num_threads);
+        return;
+    }
+
     if (g_kmp_global.kmp_max_threads == 1 || num_threads == 1)
     {
         for (int i = 0; i < num_threads; i++)
@@ -743,6 +791,16 @@ void GOMP_parallel(void (*fn)(void*), void* data, unsigned num_threads, unsigned
         num_threads = omp_get_max_threads();
     }
 
+    ncnn::ThreadPool* pool = ncnn::get_current_thread_pool();
+    if (pool && num_threads > 1)
+    {
+        KMPPoolRegion region;
+        region.fn = fn;
+        region.data = data;
+        kmp_pool_parallel(pool, region, (int)num_threads);
+        return;
+    }
+
     if (g_kmp_global.kmp_max_threads == 1 || num_threads == 1)
     {
         for (unsigned i = 0; i < num_threads; i++)
@@ -0,0 +1,480 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "threadpool.h"
+
+#include "allocator.h" // NCNN_XADD
+
+namespace ncnn {
+
+// the pool of the calling thread
+static ThreadLocalStorage tls_current_thread_pool;
+
+// the pool serial the calling thread and its openmp team are pinned for
+static ThreadLocalStorage tls_bound_pool_serial;
+
+// the openmp team size the calling thread pinned
+static ThreadLocalStorage tls_bound_num_threads;
+
+// the affinity this thread had before it was first pinned for a pool
+static ThreadLocalStorage tls_saved_affinity;
+
+// the pool this worker thread belongs to
+static ThreadLocalStorage tls_worker_pool;
+
+static int g_thread_pool_serial = 0;
+
+#if NCNN_THREADS
+struct ThreadPoolTeam
+{
+    int num_threads_to_wait;
+    Mutex finish_lock;
+    ConditionVariable finish_condition;
+};
+
+struct ThreadPoolTask
+{
+    void (*func)(int thread_num, int num_threads, void* userdata);
+    void* userdata;
+    int thread_num;
+    int num_threads;
+    ThreadPoolTeam* team;
+};
+
+// per-worker task queue
+struct ThreadPoolQueue
+{
+    Mutex lock;
+    std::list<ThreadPoolTask> tasks;
+};
+
+struct ThreadPoolWorkerArgs
+{
+    ThreadPoolPrivate* d;
+    int worker_id;
+    int cpu;
+};
+#endif // NCNN_THREADS
+
+class ThreadPoolPrivate
+{
+public:
+    CpuSet thread_affinity_mask;
+    int num_threads;
+    int serial;
+
+#if NCNN_THREADS
+    // take one task, own queue first and then steal from the others
+    // the caller must have claimed the task from pending
+    void pop_task(int worker_id, ThreadPoolTask& task);
+
+    void run_task(const ThreadPoolTask& task);
+
+    std::vector<Thread*> workers;
+    std::vector<ThreadPoolWorkerArgs> worker_args;
+    std::vector<ThreadPoolQueue*> queues;
+
+    // the number of queued tasks nobody has claimed yet
+    Mutex pending_lock;
+    ConditionVariable pending_condition;
+    int pending;
+    bool exit;
+#endif // NCNN_THREADS
+};
+
+#if NCNN_THREADS
+void ThreadPoolPrivate::pop_task(int worker_id, ThreadPoolTask& task)
+{
+    const int num_queues = (int)queues.size();
+
+    // a claimed task is always somewhere in the queues, keep looking until we own it
+    for (;;)
+    {
+        for (int k = 0; k < num_queues; k++)
+        {
+            ThreadPoolQueue* q = queues[(worker_id + k) % num_queues];
+
+            q->lock.lock();
+            if (!q->tasks.empty())
+            {
+                task = *q->tasks.begin();
+                q->tasks.pop_front();
+                q->lock.unlock();
+                return;
+            }
+            q->lock.unlock();
+        }
+    }
+}
+
+void ThreadPoolPrivate::run_task(const ThreadPoolTask& task)
+{
+    task.func(task.thread_num, task.num_threads, task.userdata);
+
+    ThreadPoolTeam* team = task.team;
+
+    team->finish_lock.lock();
+    team->num_threads_to_wait--;
+    if (team->num_threads_to_wait == 0)
+    {
+        team->finish_condition.signal();
+    }
+    team->finish_lock.unlock();
+}
+
+static void* thread_pool_worker(void* args)
+{
+    ThreadPoolWorkerArgs* wargs = (ThreadPoolWorkerArgs*)args;
+    ThreadPoolPrivate* d = wargs->d;
+    const int worker_id = wargs->worker_id;
+
+    if (wargs->cpu >= 0)
+    {
+        CpuSet thread_affinity_mask;
+        thread_affinity_mask.enable(wargs->cpu);
+        set_current_thread_affinity(thread_affinity_mask);
+    }
+
+    tls_worker_pool.set((void*)d);
+
+    for (;;)
+    {
+        d->pending_lock.lock();
+        while (d->pending == 0 && !d->exit)
+        {
+            d->pending_condition.wait(d->pending_lock);
+        }
+
+        if (d->pending == 0)
+        {
+            // exit with all work drained
+            d->pending_lock.unlock();
+            break;
+        }
+
+        d->pending--;
+        d->pending_lock.unlock();
+
+        ThreadPoolTask task;
+        d->pop_task(worker_id, task);
+        d->run_task(task);
+    }
+
+    return 0;
+}
+#endif // NCNN_THREADS
+
+ThreadPool::ThreadPool(const CpuSet& thread_affinity_mask, int num_threads)
+    : d(new ThreadPoolPrivate)
+{
+    d->thread_affinity_mask = thread_affinity_mask;
+
+    // the enabled cpus in order
+    std::vector<int> cpus;
+    const int cpu_count = get_cpu_count();
+    for (int i = 0; i < cpu_count; i++)
+    {
+        if (thread_affinity_mask.is_enabled(i))
+            cpus.push_back(i);
+    }
+
+    if (num_threads <= 0)
+        num_threads = (int)cpus.size();
+
+    d->num_threads = std::max(num_threads, 1);
+    d->serial = NCNN_XADD(&g_thread_pool_serial, 1) + 1;
+
+#if NCNN_THREADS
+    d->pending = 0;
+    d->exit = false;
+
+    // the calling thread of run() is thread 0, the workers are 1 ~ num_threads-1
+    const int num_workers = d->num_threads - 1;
+
+    d->queues.resize(num_workers);
+    d->worker_args.resize(num_workers);
+    d->workers.resize(num_workers);
+    for (int i = 0; i < num_workers; i++)
+    {
+        d->queues[i] = new ThreadPoolQueue;
+
+        d->worker_args[i].d = d;
+        d->worker_args[i].worker_id = i;
+        d->worker_args[i].cpu = cpus.empty() ? -1 : cpus[(i + 1) % cpus.size()];
+    }
+
+    for (int i = 0; i < num_workers; i++)
+    {
+        d->workers[i] = new Thread(thread_pool_worker, (void*)&d->worker_args[i]);
+    }
+#endif // NCNN_THREADS
+}
+
+ThreadPool::~ThreadPool()
+{
+#if NCNN_THREADS
+    d->pending_lock.lock();
+    d->exit = true;
+    d->pending_condition.broadcast();
+    d->pending_lock.unlock();
+
+    for (size_t i = 0; i < d->workers.size(); i++)
+    {
+        d->workers[i]->join();
+        delete d->workers[i];
+    }
+
+    for (size_t i = 0; i < d->queues.size(); i++)
+    {
+        delete d->queues[i];
+    }
+#endif // NCNN_THREADS
+
+    delete d;
+}
+
+ThreadPool::ThreadPool(const ThreadPool&)
+    : d(0)
+{
+}
+
+ThreadPool& ThreadPool::operator=(const ThreadPool&)
+{
+    return *this;
+}
+
+int ThreadPool::num_threads() const
+{
+    return d->num_threads;
+}
+
+const CpuSet& ThreadPool::thread_affinity_mask() const
+{
+    return d->thread_affinity_mask;
+}
+
+void ThreadPool::run(int num_threads, void (*func)(int thread_num, int num_threads, void* userdata), void* userdata)
+{
+#if NCNN_THREADS
+    if (num_threads <= 1 || d->workers.empty() || tls_worker_pool.get() == (void*)d)
+#endif // NCNN_THREADS
+    {
+        for (int i = 0; i < num_threads; i++)
+        {
+            func(i, num_threads, userdata);
+        }
+        return;
+    }
+
+#if NCNN_THREADS
+    ThreadPoolTeam team;
+    team.num_threads_to_wait = num_threads - 1;
+
+    // thread i goes to the queue of the worker pinned for it
+    const int num_queues = (int)d->queues.size();
+    for (int i = 1; i < num_threads; i++)
+    {
+        ThreadPoolTask task;
+        task.func = func;
+        task.userdata = userdata;
+        task.thread_num = i;
+        task.num_threads = num_threads;
+        task.team = &team;
+
+        ThreadPoolQueue* q = d->queues[(i - 1) % num_queues];
+        q->lock.lock();
+        q->tasks.push_back(task);
+        q->lock.unlock();
+    }
+
+    d->pending_lock.lock();
+    d->pending += num_threads - 1;
+    d->pending_condition.broadcast();
+    d->pending_lock.unlock();
+
+    func(0, num_threads, userdata);
+
+    // help with the queued work instead of sleeping while there is any
+    for (;;)
+    {
+        team.finish_lock.lock();
+        const bool finished = team.num_threads_to_wait == 0;
+        team.finish_lock.unlock();
+
+        if (finished)
+            break;
+
+        d->pending_lock.lock();
+        const bool claimed = d->pending > 0;
+        if (claimed)
+            d->pending--;
+        d->pending_lock.unlock();
+
+        if (!claimed)
+            break;
+
+        ThreadPoolTask task;
+        d->pop_task(0, task);
+        d->run_task(task);
+    }
+
+    // wait for finished
+    team.finish_lock.lock();
+    while (team.num_threads_to_wait != 0)
+    {
+        team.finish_condition.wait(team.finish_lock);
+    }
+    team.finish_lock.unlock();
+#endif // NCNN_THREADS
+}
+
+struct thread_pool_parallel_for_context
+{
+    void (*func)(int i, void* userdata);
+    void* userdata;
+
+    // thread t walks next[t] ~ end[t]
+    std::vector<int> next;
+    std::vector<int> end;
+};
+
+static void thread_pool_parallel_for(int thread_num, int num_threads, void* userdata)
+{
+    thread_pool_parallel_for_context* ctx = (thread_pool_parallel_for_context*)userdata;
+
+    // own range first, then steal from the others in ring order
+    for (int k = 0; k < num_threads; k++)
+    {
+        const int t = (thread_num + k) % num_threads;
+
+        for (;;)
+        {
+            const int i = NCNN_XADD(&ctx->next[t], 1);
+            if (i >= ctx->end[t])
+                break;
+
+            ctx->func(i, ctx->userdata);
+        }
+    }
+}
+
+void ThreadPool::parallel_for(int n, void (*func)(int i, void* userdata), void* userdata)
+{
+    if (n <= 0)
+        return;
+
+    const int num_threads = std::min(d->num_threads, n);
+
+    thread_pool_parallel_for_context ctx;
+    ctx.func = func;
+    ctx.userdata = userdata;
+    ctx.next.resize(num_threads);
+    ctx.end.resize(num_threads);
+    for (int t = 0; t < num_threads; t++)
+    {
+        ctx.next[t] = (int)((long long)n * t / num_threads);
+        ctx.end[t] = (int)((long long)n * (t + 1) / num_threads);
+    }
+
+    run(num_threads, thread_pool_parallel_for, &ctx);
+}
+
+ThreadPool* get_current_thread_pool()
+{
+    return (ThreadPool*)tls_current_thread_pool.get();
+}
+
+static void pin_current_thread(const CpuSet& thread_affinity_mask)
+{
+    // keep the affinity from before the first pool only
+    if (!tls_saved_affinity.get())
+    {
+        CpuSet* saved_affinity_mask = new CpuSet;
+        if (get_current_thread_affinity(*saved_affinity_mask) == 0)
+        {
+            tls_saved_affinity.set((void*)saved_affinity_mask);
+        }
+        else
+        {
+            delete saved_affinity_mask;
+        }
+    }
+
+    set_current_thread_affinity(thread_affinity_mask);
+}
+
+static void unpin_current_thread()
+{
+    CpuSet* saved_affinity_mask = (CpuSet*)tls_saved_affinity.get();
+    if (!saved_affinity_mask)
+        return;
+
+    set_current_thread_affinity(*saved_affinity_mask);
+
+    delete saved_affinity_mask;
+    tls_saved_affinity.set(0);
+}
+
+void set_current_thread_pool(ThreadPool* pool)
+{
+    tls_current_thread_pool.set((void*)pool);
+
+    const int bound_num_threads = (int)(size_t)tls_bound_num_threads.get();
+
+    if (!pool)
+    {
+        if (bound_num_threads == 0)
+            return;
+
+        // give the calling thread and its openmp team their previous affinity back
+#if defined(_OPENMP) && !NCNN_SIMPLEOMP
+        #pragma omp parallel for num_threads(bound_num_threads)
+        for (int i = 0; i < bound_num_threads; i++)
+        {
+            unpin_current_thread();
+        }
+#else
+        unpin_current_thread();
+#endif
+
+        tls_bound_pool_serial.set(0);
+        tls_bound_num_threads.set(0);
+        return;
+    }
+
+    const CpuSet& thread_affinity_mask = pool->thread_affinity_mask();
+    const size_t serial = (size_t)pool->d->serial;
+
+    // pin only once per thread and pool
+    if ((size_t)tls_bound_pool_serial.get() == serial)
+        return;
+
+#if defined(_OPENMP) && !NCNN_SIMPLEOMP
+    // the regions of this thread run on its openmp team, keep the whole team on the pool cpus
+    const int num_threads = pool->num_threads();
+    #pragma omp parallel for num_threads(num_threads)
+    for (int i = 0; i < num_threads; i++)
+    {
+        pin_current_thread(thread_affinity_mask);
+    }
+#else
+    const int num_threads = 1;
+    pin_current_thread(thread_affinity_mask);
+#endif
+
+    tls_bound_pool_serial.set((void*)serial);
+    tls_bound_num_threads.set((void*)(size_t)std::max(bound_num_threads, num_threads));
+}
+
+} // namespace ncnn
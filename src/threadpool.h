@@ -0,0 +1,70 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_THREADPOOL_H
+#define NCNN_THREADPOOL_H
+
+#include "cpu.h"
+#include "platform.h"
+
+namespace ncnn {
+
+class ThreadPool;
+
+// the pool used by the parallel regions of the calling thread, null for the global openmp runtime
+// simpleomp sends every parallel region of this thread to the pool workers
+// with system openmp the threads of the calling thread's openmp team are pinned to the pool cpus instead,
+// the regions keep the openmp schedule and get neither one pinned worker per cpu nor work stealing
+// setting null gives the calling thread and its openmp team back the affinity they had before, linux only
+NCNN_EXPORT ThreadPool* get_current_thread_pool();
+NCNN_EXPORT void set_current_thread_pool(ThreadPool* pool);
+
+class ThreadPoolPrivate;
+class NCNN_EXPORT ThreadPool
+{
+public:
+    // a team of threads living on the cpus of thread_affinity_mask
+    // thread i is a worker pinned to the i-th enabled cpu, wrapping around when there are more threads than cpus
+    // num_threads = 0 creates one thread per enabled cpu
+    ThreadPool(const CpuSet& thread_affinity_mask, int num_threads = 0);
+    ~ThreadPool();
+
+    // thread count including the calling thread
+    int num_threads() const;
+
+    const CpuSet& thread_affinity_mask() const;
+
+    // run func(thread_num, num_threads, userdata) for thread_num in 0 ~ num_threads-1 and wait for all
+    // the calling thread takes thread_num 0 and the rest go to the pinned workers
+    // idle workers steal queued work from the busy ones
+    // calling run from inside a pool worker runs the team serially
+    void run(int num_threads, void (*func)(int thread_num, int num_threads, void* userdata), void* userdata);
+
+    // run func(i, userdata) for i in 0 ~ n-1 and wait for all
+    // each thread walks its own contiguous range and then steals from the ranges of the others
+    void parallel_for(int n, void (*func)(int i, void* userdata), void* userdata);
+
+private:
+    friend void set_current_thread_pool(ThreadPool* pool);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+private:
+    ThreadPoolPrivate* const d;
+};
+
+} // namespace ncnn
+
+#endif // NCNN_THREADPOOL_H
@@ -0,0 +1,255 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "allocator.h"
+#include "cpu.h"
+#include "mat.h"
+
+static int test_sizeclass_allocator_0()
+{
+    ncnn::SizeClassPoolAllocator allocator;
+
+    const size_t sizes[] = {1, 63, 64, 65, 100, 1000, 4096, 12345, 1 << 20, (1 << 20) + 1};
+    const int count = sizeof(sizes) / sizeof(sizes[0]);
+
+    void* ptrs[count];
+    for (int i = 0; i < count; i++)
+    {
+        ptrs[i] = allocator.fastMalloc(sizes[i]);
+        if (!ptrs[i] || (size_t)ptrs[i] % NCNN_MALLOC_ALIGN != 0)
+        {
+            fprintf(stderr, "sizeclass allocator malloc %d failed or misaligned\n", (int)sizes[i]);
+            return -1;
+        }
+
+        // whole range and overread must be writable
+        memset(ptrs[i], i, sizes[i] + NCNN_MALLOC_OVERREAD);
+    }
+
+    if (allocator.hit_count() != 0 || allocator.miss_count() != (size_t)count || allocator.bytes_held() != 0)
+    {
+        fprintf(stderr, "sizeclass allocator statistics mismatch after first round\n");
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        allocator.fastFree(ptrs[i]);
+    }
+
+    if (allocator.bytes_held() < 1 << 21)
+    {
+        fprintf(stderr, "sizeclass allocator holds %d bytes after free\n", (int)allocator.bytes_held());
+        return -1;
+    }
+
+    // same sizes come back from cache
+    for (int i = 0; i < count; i++)
+    {
+        ptrs[i] = allocator.fastMalloc(sizes[i]);
+    }
+
+    if (allocator.hit_count() != (size_t)count || allocator.miss_count() != (size_t)count || allocator.bytes_held() != 0)
+    {
+        fprintf(stderr, "sizeclass allocator statistics mismatch after second round\n");
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        allocator.fastFree(ptrs[i]);
+    }
+
+    allocator.clear();
+
+    if (allocator.bytes_held() != 0)
+    {
+        fprintf(stderr, "sizeclass allocator holds %d bytes after clear\n", (int)allocator.bytes_held());
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_sizeclass_allocator_1()
+{
+    ncnn::SizeClassPoolAllocator allocator;
+    allocator.set_thread_cache_size(0);
+
+    // mat lifecycle with chunks going through the shared list only
+    for (int i = 0; i < 10; i++)
+    {
+        ncnn::Mat m(17, 19, 23, (size_t)4u, &allocator);
+        if (m.empty())
+        {
+            fprintf(stderr, "sizeclass allocator mat create failed\n");
+            return -1;
+        }
+
+        m.fill(1.f);
+    }
+
+    if (allocator.hit_count() != 9 || allocator.miss_count() != 1)
+    {
+        fprintf(stderr, "sizeclass allocator shared list hit %d miss %d\n", (int)allocator.hit_count(), (int)allocator.miss_count());
+        return -1;
+    }
+
+    return 0;
+}
+
+// chunks freed beyond the shared limit go back to system
+static int test_sizeclass_allocator_3()
+{
+    ncnn::SizeClassPoolAllocator allocator;
+    allocator.set_thread_cache_size(2);
+
+    const int shared_limit = (2 + 1) * ncnn::get_cpu_count() * 2;
+    const int count = shared_limit * 4;
+
+    std::vector<void*> ptrs(count);
+    for (int i = 0; i < count; i++)
+    {
+        ptrs[i] = allocator.fastMalloc(1000);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        allocator.fastFree(ptrs[i]);
+    }
+
+    // 1000 bytes fall in the 1024 size class
+    const size_t bytes_held = allocator.bytes_held();
+    if (bytes_held == 0 || bytes_held > (size_t)(shared_limit + 2) * 1024)
+    {
+        fprintf(stderr, "sizeclass allocator holds %d bytes after freeing %d chunks\n", (int)bytes_held, count);
+        return -1;
+    }
+
+    return 0;
+}
+
+#if NCNN_THREADS
+struct sizeclass_allocator_thread_args
+{
+    ncnn::Allocator* allocator;
+    int seed;
+    int malloc_count;
+    int ret;
+};
+
+static void* sizeclass_allocator_thread(void* args)
+{
+    sizeclass_allocator_thread_args* a = (sizeclass_allocator_thread_args*)args;
+
+    unsigned int seed = a->seed;
+
+    void* ptrs[16] = {0};
+    size_t sizes[16] = {0};
+    for (int i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int slot = (seed >> 16) % 16;
+
+        if (ptrs[slot])
+        {
+            // detect corruption from chunks handed out twice
+            const unsigned char* p = (const unsigned char*)ptrs[slot];
+            if (p[0] != (unsigned char)slot || p[sizes[slot] - 1] != (unsigned char)slot)
+            {
+                a->ret = -1;
+                return 0;
+            }
+
+            a->allocator->fastFree(ptrs[slot]);
+            ptrs[slot] = 0;
+        }
+        else
+        {
+            sizes[slot] = 1 + (seed >> 8) % 20000;
+            ptrs[slot] = a->allocator->fastMalloc(sizes[slot]);
+            a->malloc_count++;
+            memset(ptrs[slot], slot, sizes[slot]);
+        }
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        a->allocator->fastFree(ptrs[i]);
+    }
+
+    a->ret = 0;
+    return 0;
+}
+
+static int test_sizeclass_allocator_2()
+{
+    ncnn::SizeClassPoolAllocator allocator;
+
+    const int thread_count = 8;
+
+    sizeclass_allocator_thread_args args[thread_count];
+    ncnn::Thread* threads[thread_count];
+    for (int i = 0; i < thread_count; i++)
+    {
+        args[i].allocator = &allocator;
+        args[i].seed = i + 1;
+        args[i].malloc_count = 0;
+        args[i].ret = -1;
+        threads[i] = new ncnn::Thread(sizeclass_allocator_thread, (void*)&args[i]);
+    }
+
+    int ret = 0;
+    size_t malloc_count = 0;
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+
+        if (args[i].ret != 0)
+        {
+            fprintf(stderr, "sizeclass allocator thread %d found corrupted chunk\n", i);
+            ret = -1;
+        }
+
+        malloc_count += args[i].malloc_count;
+    }
+
+    if (allocator.hit_count() + allocator.miss_count() != malloc_count)
+    {
+        fprintf(stderr, "sizeclass allocator counted %d allocations\n", (int)(allocator.hit_count() + allocator.miss_count()));
+        ret = -1;
+    }
+
+    return ret;
+}
+#else
+static int test_sizeclass_allocator_2()
+{
+    return 0;
+}
+#endif // NCNN_THREADS
+
+int main()
+{
+    return 0
+           || test_sizeclass_allocator_0()
+           || test_sizeclass_allocator_1()
+           || test_sizeclass_allocator_2()
+           || test_sizeclass_allocator_3();
+}
@@ -86,9 +86,109 @@ static int test_convolution3d_0()
     return 0;
 }
 
+static int test_convolution3d_aniso(int w, int h, int d, int c, int outch, const int* kernel, const int* dilation, const int* stride, int pad, int bias, const ncnn::Option* opt = 0)
+{
+    ncnn::Mat a = RandomMat(w, h, d, c);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);        // num_output
+    pd.set(1, kernel[0]);    // kernel_w
+    pd.set(11, kernel[1]);   // kernel_h
+    pd.set(21, kernel[2]);   // kernel_d
+    pd.set(2, dilation[0]);  // dilation_w
+    pd.set(12, dilation[1]); // dilation_h
+    pd.set(22, dilation[2]); // dilation_d
+    pd.set(3, stride[0]);    // stride_w
+    pd.set(13, stride[1]);   // stride_h
+    pd.set(23, stride[2]);   // stride_d
+    pd.set(4, pad);          // pad_w
+    pd.set(5, bias);         // bias_term
+    pd.set(6, outch * c * kernel[0] * kernel[1] * kernel[2]);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * c * kernel[0] * kernel[1] * kernel[2]);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    int ret = opt ? test_layer_opt("Convolution3D", pd, weights, *opt, a) : test_layer("Convolution3D", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution3d_aniso failed w=%d h=%d d=%d c=%d outch=%d kernel=%d,%d,%d dilation=%d,%d,%d stride=%d,%d,%d pad=%d bias=%d\n", w, h, d, c, outch, kernel[0], kernel[1], kernel[2], dilation[0], dilation[1], dilation[2], stride[0], stride[1], stride[2], pad, bias);
+    }
+
+    return ret;
+}
+
+static int test_convolution3d_1()
+{
+    // packed input and output, the depth slices are gathered with a kernel_d stride and dilation
+    // that differ from the spatial ones, and the output slices are odd sized
+    static const int kds[4][9] = {
+        {3, 2, 1, 1, 1, 1, 1, 1, 1},
+        {1, 1, 3, 1, 1, 2, 1, 1, 2},
+        {2, 3, 2, 2, 1, 1, 1, 2, 1},
+        {1, 1, 1, 1, 1, 1, 2, 2, 3},
+    };
+
+    for (int i = 0; i < 4; i++)
+    {
+        const int* k = kds[i];
+        const int* d = kds[i] + 3;
+        const int* s = kds[i] + 6;
+
+        int ret = 0
+                  || test_convolution3d_aniso(7, 5, 8, 4, 8, k, d, s, 0, 1)
+                  || test_convolution3d_aniso(7, 5, 8, 8, 4, k, d, s, 1, 0)
+                  || test_convolution3d_aniso(9, 3, 7, 16, 16, k, d, s, 0, 1)
+                  || test_convolution3d_aniso(9, 3, 7, 12, 24, k, d, s, 1, 1)
+                  || test_convolution3d_aniso(5, 5, 6, 3, 16, k, d, s, 0, 0);
+
+        if (ret != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int test_convolution3d_2()
+{
+    // Convolution3D has no int8 weights, int8 inference must keep the stacked 2d convolution in fp32
+    static const int kds[2][9] = {
+        {3, 3, 3, 1, 1, 1, 1, 1, 1},
+        {1, 1, 2, 1, 1, 1, 1, 1, 2},
+    };
+
+    for (int i = 0; i < 2; i++)
+    {
+        const int* k = kds[i];
+        const int* d = kds[i] + 3;
+        const int* s = kds[i] + 6;
+
+        for (int j = 0; j < 2; j++)
+        {
+            ncnn::Option opt;
+            opt.num_threads = 1;
+            opt.use_packing_layout = j;
+            opt.use_int8_inference = true;
+
+            int ret = 0
+                      || test_convolution3d_aniso(7, 6, 5, 4, 8, k, d, s, 1, 1, &opt)
+                      || test_convolution3d_aniso(7, 6, 5, 16, 3, k, d, s, 0, 0, &opt);
+
+            if (ret != 0)
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_convolution3d_0();
+    return 0
+           || test_convolution3d_0()
+           || test_convolution3d_1()
+           || test_convolution3d_2();
 }
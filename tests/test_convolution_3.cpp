@@ -445,6 +445,78 @@ static int test_convolution_1_2()
            || test_convolution_int8(19, 17, 31, 32, 5, 2, 2, 0, 1)
            || test_convolution_int8(19, 17, 32, 32, 5, 2, 2, 0, 0);
 }
+
+static int test_convolution_int8_dynamic(int w, int h, int c, int outch, int kernel, int dilation, int stride, int pad, int bias)
+{
+    ncnn::Mat a = RandomMat(w, h, c);
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch);
+    pd.set(1, kernel);
+    pd.set(2, dilation);
+    pd.set(3, stride);
+    pd.set(4, pad);
+    pd.set(5, bias);
+    pd.set(6, outch * c * kernel * kernel);
+    pd.set(20, 1); // int8_dynamic_quantize
+
+    int activation_type = RAND() % 7; // 0 1 2 3 4 5 6
+    ncnn::Mat activation_params(2);
+    activation_params[0] = (activation_type == 6) ? RandomFloat(0, 1) : RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);                                               // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * c * kernel * kernel);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    int flag = TEST_LAYER_DISABLE_GPU_TESTING;
+    int ret = test_layer("Convolution", pd, weights, a, 0.001f, 0, flag);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_convolution_int8_dynamic failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d act=%d actparams=[%f,%f]\n", w, h, c, outch, kernel, dilation, stride, pad, bias, activation_type, activation_params[0], activation_params[1]);
+        return ret;
+    }
+
+    {
+        ncnn::Option opt;
+        opt.num_threads = 1;
+        opt.use_packing_layout = true;
+        opt.use_fp16_packed = false;
+        opt.use_fp16_storage = false;
+        opt.use_fp16_arithmetic = false;
+        opt.use_bf16_storage = false;
+        opt.use_shader_pack8 = false;
+        opt.use_sgemm_convolution = false;
+        opt.use_winograd_convolution = false;
+
+        ret = test_layer_opt("Convolution", pd, weights, opt, a, 0.001f, 0, flag);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_convolution_int8_dynamic failed w=%d h=%d c=%d outch=%d kernel=%d dilation=%d stride=%d pad=%d bias=%d act=%d actparams=[%f,%f]\n", w, h, c, outch, kernel, dilation, stride, pad, bias, activation_type, activation_params[0], activation_params[1]);
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+static int test_convolution_1_3()
+{
+    return 0
+           || test_convolution_int8_dynamic(9, 7, 1, 1, 1, 1, 1, 0, 1)
+           || test_convolution_int8_dynamic(9, 7, 3, 5, 1, 1, 1, 0, 0)
+           || test_convolution_int8_dynamic(9, 7, 8, 8, 1, 1, 1, 1, 1)
+           || test_convolution_int8_dynamic(11, 5, 16, 24, 1, 1, 1, 0, 1)
+           || test_convolution_int8_dynamic(6, 6, 31, 32, 1, 1, 1, 0, 0)
+           || test_convolution_int8_dynamic(13, 9, 32, 16, 1, 1, 1, 0, 1)
+           || test_convolution_int8_dynamic(9, 7, 8, 16, 1, 1, 2, 0, 1)
+           || test_convolution_int8_dynamic(11, 11, 8, 16, 3, 1, 1, 1, 1)
+           || test_convolution_int8_dynamic(13, 16, 16, 24, 3, 1, 2, 1, 0)
+           || test_convolution_int8_dynamic(19, 17, 7, 8, 5, 2, 2, 0, 1);
+}
 #endif // NCNN_INT8
 
 int main()
@@ -455,6 +527,7 @@ int main()
     return 0
            || test_convolution_1()
            || test_convolution_1_2()
+           || test_convolution_1_3()
            || test_convolution_2()
            || test_convolution_3();
 #else
@@ -0,0 +1,943 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "testutil.h"
+
+#include <string.h>
+
+// append one float32 weight blob in model bin layout
+static void append_weight(std::vector<unsigned int>& model, const ncnn::Mat& m)
+{
+    model.push_back(0); // float32 flag
+
+    const size_t offset = model.size();
+    model.resize(offset + m.total());
+    memcpy(&model[offset], (const float*)m, m.total() * sizeof(float));
+}
+
+// append raw float32 data without type flag, such as bias
+static void append_data(std::vector<unsigned int>& model, const ncnn::Mat& m)
+{
+    const size_t offset = model.size();
+    model.resize(offset + m.total());
+    memcpy(&model[offset], (const float*)m, m.total() * sizeof(float));
+}
+
+// state_type = 0, gru with hidden state
+// state_type = 1, lstm with hidden and cell state
+static int load_recurrent_net(ncnn::Net& net, int state_type, int size, int num_output, std::vector<unsigned int>& model)
+{
+    const int gates = state_type == 0 ? 3 : 4;
+    const int weight_data_size = num_output * size * gates;
+
+    char param[1024];
+    if (state_type == 0)
+    {
+        sprintf(param, "7767517\n3 4\n"
+                "Input in 0 1 in\n"
+                "Input h0 0 1 h0\n"
+                "GRU rnn 2 2 in h0 out hn 0=%d 1=%d 2=0\n",
+                num_output, weight_data_size);
+    }
+    else
+    {
+        sprintf(param, "7767517\n4 6\n"
+                "Input in 0 1 in\n"
+                "Input h0 0 1 h0\n"
+                "Input c0 0 1 c0\n"
+                "LSTM rnn 3 3 in h0 c0 out hn cn 0=%d 1=%d 2=0\n",
+                num_output, weight_data_size);
+    }
+
+    append_weight(model, RandomMat(size * gates * num_output));
+    append_weight(model, RandomMat((state_type == 0 ? 4 : gates) * num_output));
+    append_weight(model, RandomMat(num_output * gates * num_output));
+
+    int ret = net.load_param_mem(param);
+    if (ret != 0)
+        return ret;
+
+    net.load_model((const unsigned char*)&model[0]);
+
+    return 0;
+}
+
+static int test_extractor_state(const ncnn::Option& opt, int state_type, int size, int num_output, int T, float epsilon = 0.001)
+{
+    ncnn::Net net;
+    net.opt = opt;
+
+    std::vector<unsigned int> model;
+    if (load_recurrent_net(net, state_type, size, num_output, model) != 0)
+    {
+        fprintf(stderr, "load_recurrent_net failed\n");
+        return -1;
+    }
+
+    ncnn::Mat in = RandomMat(size, T);
+
+    // the whole sequence in one run starting from zero states
+    ncnn::Mat ref;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+        ex.extract("out", ref);
+    }
+
+    ncnn::Extractor ex = net.create_extractor();
+    if (ex.bind_state("h0", "hn") != 0)
+        return -1;
+    if (state_type == 1 && ex.bind_state("c0", "cn") != 0)
+        return -1;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        // the same sequence fed in uneven chunks
+        ncnn::Mat out(num_output, T);
+        int t0 = 0;
+        for (int i = 0; t0 < T; i++)
+        {
+            const int chunk = std::min(i % 3 + 1, T - t0);
+
+            ex.input("in", in.row_range(t0, chunk).clone());
+
+            ncnn::Mat out_chunk;
+            int ret = ex.extract("out", out_chunk);
+            if (ret != 0 || out_chunk.w != num_output || out_chunk.h != chunk)
+            {
+                fprintf(stderr, "test_extractor_state extract failed state_type=%d size=%d num_output=%d T=%d t0=%d\n", state_type, size, num_output, T, t0);
+                return -1;
+            }
+
+            memcpy(out.row(t0), out_chunk, num_output * chunk * sizeof(float));
+            t0 += chunk;
+        }
+
+        if (CompareMat(ref, out, epsilon) != 0)
+        {
+            fprintf(stderr, "test_extractor_state failed state_type=%d size=%d num_output=%d T=%d pass=%d\n", state_type, size, num_output, T, pass);
+            return -1;
+        }
+
+        // the second pass starts over from zero states
+        ex.reset_state();
+    }
+
+    return 0;
+}
+
+static int test_extractor_state_0()
+{
+    ncnn::Option opts[3];
+
+    opts[0].use_packing_layout = true;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+    opts[1].use_memory_plan = true;
+
+    opts[2].use_packing_layout = false;
+    opts[2].use_fp16_storage = false;
+    opts[2].use_bf16_storage = false;
+    opts[2].lightmode = false;
+
+    for (int i = 0; i < 3; i++)
+    {
+        const ncnn::Option& opt = opts[i];
+
+        int ret = 0
+                  || test_extractor_state(opt, 0, 4, 8, 9)
+                  || test_extractor_state(opt, 0, 7, 13, 12)
+                  || test_extractor_state(opt, 1, 4, 8, 9)
+                  || test_extractor_state(opt, 1, 7, 13, 12);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_extractor_state_1()
+{
+    ncnn::Net net;
+
+    std::vector<unsigned int> model;
+    if (load_recurrent_net(net, 0, 4, 8, model) != 0)
+        return -1;
+
+    ncnn::Extractor ex = net.create_extractor();
+
+    // the state input must come from an Input layer
+    if (ex.bind_state("out", "hn") == 0)
+    {
+        fprintf(stderr, "test_extractor_state_1 bind non-input blob should fail\n");
+        return -1;
+    }
+
+    if (ex.bind_state("h0", "h0") == 0)
+    {
+        fprintf(stderr, "test_extractor_state_1 bind blob to itself should fail\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_extractor_reuse(const ncnn::Option& opt, int state_type, int size, int num_output, float epsilon = 0.001)
+{
+    ncnn::Net net;
+    net.opt = opt;
+
+    std::vector<unsigned int> model;
+    if (load_recurrent_net(net, state_type, size, num_output, model) != 0)
+    {
+        fprintf(stderr, "load_recurrent_net failed\n");
+        return -1;
+    }
+
+    // same shape runs, then a shape change and back
+    const int Ts[6] = {5, 5, 5, 9, 5, 5};
+
+    ncnn::Extractor ex = net.create_extractor();
+    for (int i = 0; i < 6; i++)
+    {
+        ncnn::Mat in = RandomMat(size, Ts[i]);
+
+        ncnn::Mat ref;
+        {
+            ncnn::Extractor ex0 = net.create_extractor();
+            ex0.input("in", in);
+            ex0.extract("out", ref);
+        }
+
+        if (ex.reset_inputs() != 0)
+            return -1;
+
+        ex.input("in", in);
+
+        ncnn::Mat out;
+        int ret = ex.extract("out", out);
+        if (ret != 0 || CompareMat(ref, out, epsilon) != 0)
+        {
+            fprintf(stderr, "test_extractor_reuse failed state_type=%d size=%d num_output=%d i=%d\n", state_type, size, num_output, i);
+            return -1;
+        }
+    }
+
+    // bound states are carried across reset_inputs
+    ncnn::Mat in = RandomMat(size, 8);
+
+    ncnn::Mat ref;
+    {
+        ncnn::Extractor ex0 = net.create_extractor();
+        ex0.input("in", in);
+        ex0.extract("out", ref);
+    }
+
+    if (ex.bind_state("h0", "hn") != 0)
+        return -1;
+    if (state_type == 1 && ex.bind_state("c0", "cn") != 0)
+        return -1;
+
+    // start from zero states rather than those of the last unbound run
+    ex.reset_state();
+
+    for (int t0 = 0; t0 < 8; t0 += 2)
+    {
+        ex.reset_inputs();
+        ex.input("in", in.row_range(t0, 2).clone());
+
+        ncnn::Mat out;
+        int ret = ex.extract("out", out);
+        if (ret != 0 || CompareMat(ref.row_range(t0, 2).clone(), out, epsilon) != 0)
+        {
+            fprintf(stderr, "test_extractor_reuse state failed state_type=%d size=%d num_output=%d t0=%d\n", state_type, size, num_output, t0);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_extractor_reuse_0()
+{
+    ncnn::Option opts[3];
+
+    opts[0].use_packing_layout = true;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = true;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+    opts[1].use_memory_plan = true;
+
+    opts[2].num_threads = 4;
+    opts[2].use_packing_layout = true;
+    opts[2].use_fp16_storage = false;
+    opts[2].use_bf16_storage = false;
+    opts[2].use_memory_plan = true;
+
+    for (int i = 0; i < 3; i++)
+    {
+        const ncnn::Option& opt = opts[i];
+
+        int ret = 0
+                  || test_extractor_reuse(opt, 0, 4, 8)
+                  || test_extractor_reuse(opt, 1, 7, 13);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// samples of different shapes are stacked as rows into one innerproduct and gemm pass
+static int test_extractor_batch(const ncnn::Option& opt)
+{
+    const char param[] = "7767517\n4 4\n"
+                         "Input in 0 1 in\n"
+                         "InnerProduct fc 1 1 in a 0=24 1=1 2=720\n"
+                         "ReLU relu 1 1 a b\n"
+                         "Gemm gemm 1 1 b out 5=1 6=1 8=20 9=24 10=4\n";
+
+    std::vector<unsigned int> model;
+    append_weight(model, RandomMat(720));
+    append_data(model, RandomMat(24));
+    append_weight(model, RandomMat(20 * 24));
+    append_weight(model, RandomMat(20));
+
+    ncnn::Net net;
+    net.opt = opt;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    // innerproduct flattens vectors and volumes, and takes matrices of 30 wide as rows
+    std::vector<ncnn::Mat> ins0(4);
+    ins0[0] = RandomMat(30);
+    ins0[1] = RandomMat(30, 3);
+    ins0[2] = RandomMat(5, 2, 3);
+    ins0[3] = RandomMat(30, 5);
+
+    // gemm takes the rows of every matrix sample
+    std::vector<ncnn::Mat> ins1(4);
+    ins1[0] = RandomMat(30, 3);
+    ins1[1] = RandomMat(30, 1);
+    ins1[2] = RandomMat(30, 8);
+    ins1[3] = RandomMat(30, 2);
+
+    for (int k = 0; k < 2; k++)
+    {
+        const std::vector<ncnn::Mat>& ins = k == 0 ? ins0 : ins1;
+        const char* out_name = k == 0 ? "a" : "out";
+
+        std::vector<ncnn::Mat> outs;
+        {
+            ncnn::Extractor ex = net.create_extractor();
+            ex.input_batch("in", ins);
+            int ret = ex.extract_batch(out_name, outs);
+            if (ret != 0 || outs.size() != ins.size())
+            {
+                fprintf(stderr, "test_extractor_batch extract_batch failed k=%d\n", k);
+                return -1;
+            }
+        }
+
+        for (size_t i = 0; i < ins.size(); i++)
+        {
+            ncnn::Mat ref;
+            {
+                ncnn::Extractor ex = net.create_extractor();
+                ex.input("in", ins[i]);
+                ex.extract(out_name, ref);
+            }
+
+            if (CompareMat(ref, outs[i], 0.001) != 0)
+            {
+                fprintf(stderr, "test_extractor_batch sample %d not match k=%d\n", (int)i, k);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_extractor_batch_0()
+{
+    ncnn::Option opts[2];
+
+    opts[0].use_packing_layout = true;
+    opts[0].use_fp16_storage = false;
+    opts[0].use_bf16_storage = false;
+
+    opts[1].use_packing_layout = false;
+    opts[1].use_fp16_storage = false;
+    opts[1].use_bf16_storage = false;
+    opts[1].lightmode = false;
+
+    for (int i = 0; i < 2; i++)
+    {
+        int ret = test_extractor_batch(opts[i]);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// multihead attention runs the heads on openmp threads, each allocating its own workspace
+static const char mha_param[] = "7767517\n2 2\n"
+                                "Input in 0 1 in 0=64 1=40\n"
+                                "MultiHeadAttention mha 1 1 in out 0=64 1=8 2=4096\n";
+
+static void append_mha_weight(std::vector<unsigned int>& model)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        append_weight(model, RandomMat(64 * 64));
+        append_data(model, RandomMat(64));
+    }
+}
+
+// the plan recorded with num_threads > 1 places the next extractions in the arena
+static int test_extractor_memory_plan()
+{
+    std::vector<unsigned int> model;
+    append_mha_weight(model);
+
+    ncnn::Net net0;
+    net0.opt.num_threads = 1;
+    net0.load_param_mem(mha_param);
+    net0.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Net net;
+    net.opt.num_threads = 4;
+    net.opt.use_memory_plan = true;
+    net.load_param_mem(mha_param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    for (int i = 0; i < 5; i++)
+    {
+        ncnn::Mat in = RandomMat(64, 40);
+
+        ncnn::Mat ref;
+        {
+            ncnn::Extractor ex0 = net0.create_extractor();
+            ex0.input("in", in);
+            ex0.extract("out", ref);
+        }
+
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+
+        ncnn::Mat out;
+        int ret = ex.extract("out", out);
+        if (ret != 0 || CompareMat(ref, out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_extractor_memory_plan failed i=%d\n", i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// blobs taken over by a copied extractor must outlive the planned arena of the source
+static int test_extractor_memory_plan_copy(bool assign)
+{
+    const char param[] = "7767517\n3 3\n"
+                         "Input in 0 1 in 0=64 1=40\n"
+                         "MultiHeadAttention mha 1 1 in a 0=64 1=8 2=4096\n"
+                         "ReLU relu 1 1 a out 0=0.1\n";
+
+    std::vector<unsigned int> model;
+    append_mha_weight(model);
+
+    ncnn::Net net0;
+    net0.opt.num_threads = 1;
+    net0.load_param_mem(param);
+    net0.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Net net;
+    net.opt.num_threads = 4;
+    net.opt.use_memory_plan = true;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Mat in = RandomMat(64, 40);
+
+    ncnn::Mat ref;
+    {
+        ncnn::Extractor ex0 = net0.create_extractor();
+        ex0.input("in", in);
+        ex0.extract("out", ref);
+    }
+
+    // record the plan
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+
+        ncnn::Mat out;
+        ex.extract("out", out);
+    }
+
+    // blob a stays in the arena of ex
+    ncnn::Extractor* ex = new ncnn::Extractor(net.create_extractor());
+    ex->set_light_mode(false);
+    ex->input("in", in);
+
+    ncnn::Mat a;
+    ex->extract("a", a);
+
+    ncnn::Extractor ex1 = assign ? net.create_extractor() : *ex;
+    if (assign)
+        ex1 = *ex;
+
+    delete ex;
+
+    // the next arena is likely placed where the freed one was
+    {
+        ncnn::Extractor ex2 = net.create_extractor();
+        ex2.input("in", RandomMat(64, 40));
+
+        ncnn::Mat out;
+        ex2.extract("out", out);
+    }
+
+    ncnn::Mat out;
+    int ret = ex1.extract("out", out);
+    if (ret != 0 || CompareMat(ref, out, 0.001) != 0)
+    {
+        fprintf(stderr, "test_extractor_memory_plan_copy failed assign=%d\n", (int)assign);
+        return -1;
+    }
+
+    return 0;
+}
+
+// where the last forward placed its top blob
+static const void* probe_data = 0;
+
+class ProbeLayer : public ncnn::Layer
+{
+public:
+    ProbeLayer()
+    {
+        one_blob_only = true;
+    }
+
+    virtual int forward(const ncnn::Mat& bottom_blob, ncnn::Mat& top_blob, const ncnn::Option& opt) const
+    {
+        top_blob = bottom_blob.clone(opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        probe_data = top_blob.data;
+        return 0;
+    }
+};
+
+DEFINE_LAYER_CREATOR(ProbeLayer)
+
+// reset_inputs rewinds the arena when multithreaded layers follow the plan
+static int test_extractor_memory_plan_reuse()
+{
+    const char param[] = "7767517\n3 3\n"
+                         "Input in 0 1 in 0=64 1=40\n"
+                         "MultiHeadAttention mha 1 1 in a 0=64 1=8 2=4096\n"
+                         "Probe probe 1 1 a out\n";
+
+    std::vector<unsigned int> model;
+    append_mha_weight(model);
+
+    ncnn::Net net;
+    net.opt.num_threads = 4;
+    net.opt.use_memory_plan = true;
+    net.register_custom_layer("Probe", ProbeLayer_layer_creator);
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    // hold the chunks the probe would get again from heap
+    std::vector<ncnn::Mat> held;
+
+    const void* planned_data = 0;
+
+    ncnn::Extractor ex = net.create_extractor();
+    for (int i = 0; i < 6; i++)
+    {
+        ncnn::Mat in = RandomMat(64, 40);
+
+        ncnn::Mat ref;
+        {
+            ncnn::Extractor ex0 = net.create_extractor();
+            ex0.input("in", in);
+            ex0.extract("a", ref);
+        }
+
+        if (ex.reset_inputs() != 0)
+            return -1;
+
+        ex.input("in", in);
+
+        ncnn::Mat out;
+        int ret = ex.extract("out", out);
+        if (ret != 0 || CompareMat(ref, out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_extractor_memory_plan_reuse failed i=%d\n", i);
+            return -1;
+        }
+
+        // the first run records the plan, the second places it in an arena, later runs rewind that arena
+        if (i >= 2 && probe_data != planned_data)
+        {
+            fprintf(stderr, "test_extractor_memory_plan_reuse arena not rewound i=%d\n", i);
+            return -1;
+        }
+
+        planned_data = probe_data;
+
+        held.push_back(ncnn::Mat(64, 40));
+    }
+
+    return 0;
+}
+
+// weights placed on numa nodes are copied out of the model memory
+static int test_extractor_numa(int weight_numa_node)
+{
+    ncnn::Net net;
+    net.opt.weight_numa_node = weight_numa_node;
+
+    const char param[] = "7767517\n3 3\n"
+                         "Input in 0 1 in\n"
+                         "MemoryData md 0 1 md 0=16 1=12 2=3\n"
+                         "BinaryOp add 2 1 in md out 0=0\n";
+
+    if (net.load_param_mem(param) != 0)
+    {
+        fprintf(stderr, "test_extractor_numa load_param_mem failed\n");
+        return -1;
+    }
+
+    ncnn::Mat md = RandomMat(16, 12, 3);
+
+    std::vector<unsigned int> model(md.total());
+    memcpy(&model[0], (const float*)md, md.total() * sizeof(float));
+
+    net.load_model((const unsigned char*)&model[0]);
+
+    // the net must not read the model memory any more
+    memset(&model[0], 0, model.size() * sizeof(unsigned int));
+
+    ncnn::Mat in = RandomMat(16, 12, 3);
+
+    ncnn::Mat ref = in.clone();
+    for (int q = 0; q < ref.c; q++)
+    {
+        float* ptr = ref.channel(q);
+        const float* mptr = md.channel(q);
+        for (int i = 0; i < ref.w * ref.h; i++)
+        {
+            ptr[i] += mptr[i];
+        }
+    }
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("in", in);
+
+    ncnn::Mat out;
+    int ret = ex.extract("out", out);
+    if (ret != 0 || CompareMat(ref, out, 0.001) != 0)
+    {
+        fprintf(stderr, "test_extractor_numa failed weight_numa_node=%d\n", weight_numa_node);
+        return -1;
+    }
+
+    return 0;
+}
+
+// input wrapping external memory is neither written by inplace layers nor copied up front
+static int test_extractor_external()
+{
+    ncnn::Net net;
+
+    const char param[] = "7767517\n2 2\n"
+                         "Input in 0 1 in\n"
+                         "ReLU relu 1 1 in out\n";
+
+    if (net.load_param_mem(param) != 0)
+    {
+        fprintf(stderr, "test_extractor_external load_param_mem failed\n");
+        return -1;
+    }
+
+    net.load_model((const unsigned char*)"");
+
+    ncnn::Mat a = RandomMat(7, 6, 5);
+    ncnn::Mat in(a.w, a.h, a.c, a.data, a.elemsize);
+    in.cstep = a.cstep;
+
+    ncnn::Mat ref = a.clone();
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("in", in);
+
+    ncnn::Mat out;
+    int ret = ex.extract("out", out);
+    if (ret != 0 || CompareMat(ref, a, 0.001) != 0)
+    {
+        fprintf(stderr, "test_extractor_external failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+#if NCNN_THREADS
+struct parallel_graph_run
+{
+    ncnn::Net* net;
+    const ncnn::Mat* in;
+    ncnn::Mat out;
+    int ret;
+};
+
+static void* parallel_graph_extract(void* args)
+{
+    parallel_graph_run* run = (parallel_graph_run*)args;
+
+    ncnn::Extractor ex = run->net->create_extractor();
+    ex.input("in", *run->in);
+    run->ret = ex.extract("out", run->out);
+
+    return 0;
+}
+
+// two convolution branches joined by binaryop, run by the graph workers of the net
+static int test_extractor_parallel_graph(bool lightmode)
+{
+    const char param[] = "7767517\n5 6\n"
+                         "Input in 0 1 in -23330=4,3,24,20,8 0=24 1=20 2=8\n"
+                         "Split sp 1 2 in a b\n"
+                         "Convolution conv0 1 1 a a1 -23330=4,3,24,20,16 0=16 1=3 4=1 5=1 6=1152\n"
+                         "Convolution conv1 1 1 b b1 -23330=4,3,24,20,16 0=16 1=1 5=1 6=128\n"
+                         "BinaryOp add 2 1 a1 b1 out -23330=4,3,24,20,16 0=0\n";
+
+    std::vector<unsigned int> model;
+    append_weight(model, RandomMat(1152));
+    append_data(model, RandomMat(16));
+    append_weight(model, RandomMat(128));
+    append_data(model, RandomMat(16));
+
+    ncnn::Mat in = RandomMat(24, 20, 8);
+
+    ncnn::Mat ref;
+    {
+        ncnn::Net net;
+        net.opt.num_threads = 1;
+        net.load_param_mem(param);
+        net.load_model((const unsigned char*)&model[0]);
+
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+        ex.extract("out", ref);
+    }
+
+    ncnn::Net net;
+    net.opt.num_threads = 4;
+    net.opt.lightmode = lightmode;
+    net.opt.use_parallel_graph = true;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    // the workers persist across runs
+    for (int i = 0; i < 3; i++)
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+
+        ncnn::Mat out;
+        int ret = ex.extract("out", out);
+        if (ret != 0 || CompareMat(ref, out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_extractor_parallel_graph failed lightmode=%d i=%d\n", lightmode, i);
+            return -1;
+        }
+    }
+
+    // concurrent extractors share the workers
+    parallel_graph_run runs[3];
+    ncnn::Thread* threads[3];
+    for (int i = 0; i < 3; i++)
+    {
+        runs[i].net = &net;
+        runs[i].in = &in;
+        runs[i].ret = -1;
+        threads[i] = new ncnn::Thread(parallel_graph_extract, (void*)&runs[i]);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (runs[i].ret != 0 || CompareMat(ref, runs[i].out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_extractor_parallel_graph concurrent failed lightmode=%d i=%d\n", lightmode, i);
+            return -1;
+        }
+    }
+
+    // the serial profiling run uses the same thread share as the workers
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.set_profiling(true);
+        ex.input("in", in);
+
+        ncnn::Mat out;
+        int ret = ex.extract("out", out);
+        if (ret != 0 || CompareMat(ref, out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_extractor_parallel_graph serial failed lightmode=%d\n", lightmode);
+            return -1;
+        }
+
+        const std::vector<ncnn::LayerProfile>& profiles = ex.layer_profiles();
+        for (size_t i = 0; i < profiles.size(); i++)
+        {
+            // split level holds two convolutions
+            int expected = profiles[i].layer_index == 2 || profiles[i].layer_index == 3 ? 2 : 4;
+            if (profiles[i].num_threads != expected)
+            {
+                fprintf(stderr, "test_extractor_parallel_graph layer %d num_threads %d expect %d\n", profiles[i].layer_index, profiles[i].num_threads, expected);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+#endif // NCNN_THREADS
+
+#if NCNN_STDIO
+// the first load times the kernel variants on the shape hints, later loads take them from the tuning file
+static int test_extractor_tuning(const char* param, const std::vector<unsigned int>& model, const ncnn::Mat& in)
+{
+    const char* tunepath = "test_extractor_tuning.txt";
+    remove(tunepath);
+
+    ncnn::Mat ref;
+    {
+        ncnn::Net net;
+        net.load_param_mem(param);
+        net.load_model((const unsigned char*)&model[0]);
+
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+        ex.extract("out", ref);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        ncnn::Net net;
+        net.set_tuning_file(tunepath);
+        net.load_param_mem(param);
+        net.load_model((const unsigned char*)&model[0]);
+
+        FILE* fp = fopen(tunepath, "rb");
+        if (!fp)
+        {
+            fprintf(stderr, "tuning file %s not written\n", tunepath);
+            return -1;
+        }
+        fclose(fp);
+
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+
+        ncnn::Mat out;
+        int ret = ex.extract("out", out);
+        if (ret != 0 || CompareMat(ref, out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_extractor_tuning failed i=%d\n", i);
+            return -1;
+        }
+    }
+
+    remove(tunepath);
+
+    return 0;
+}
+
+static int test_extractor_tuning_0()
+{
+    const char param[] = "7767517\n2 2\n"
+                         "Input in 0 1 in -23330=4,3,20,18,16 0=20 1=18 2=16\n"
+                         "Convolution conv 1 1 in out -23330=4,3,20,18,24 0=24 1=3 4=1 5=1 6=3456\n";
+
+    std::vector<unsigned int> model;
+    append_weight(model, RandomMat(3456));
+    append_data(model, RandomMat(24));
+
+    return test_extractor_tuning(param, model, RandomMat(20, 18, 16));
+}
+
+static int test_extractor_tuning_1()
+{
+    const char param[] = "7767517\n2 2\n"
+                         "Input in 0 1 in -23330=4,2,80,60,1 0=80 1=60\n"
+                         "Gemm gemm 1 1 in out -23330=4,2,72,60,1 5=1 6=0 8=72 9=80 10=-1\n";
+
+    std::vector<unsigned int> model;
+    append_weight(model, RandomMat(72 * 80));
+
+    return test_extractor_tuning(param, model, RandomMat(80, 60));
+}
+#endif // NCNN_STDIO
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_extractor_state_0()
+           || test_extractor_state_1()
+           || test_extractor_reuse_0()
+           || test_extractor_batch_0()
+           || test_extractor_memory_plan()
+           || test_extractor_memory_plan_reuse()
+           || test_extractor_memory_plan_copy(false)
+           || test_extractor_memory_plan_copy(true)
+           || test_extractor_numa(0)
+           || test_extractor_numa(-2)
+           || test_extractor_external()
+#if NCNN_THREADS
+           || test_extractor_parallel_graph(false)
+           || test_extractor_parallel_graph(true)
+#endif // NCNN_THREADS
+#if NCNN_STDIO
+           || test_extractor_tuning_0()
+           || test_extractor_tuning_1()
+#endif // NCNN_STDIO
+           ;
+}
@@ -0,0 +1,154 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "fft.h"
+#include "testutil.h"
+
+static void dft_naive(const float* in, float* out, int n, int sign)
+{
+    for (int k = 0; k < n; k++)
+    {
+        double re = 0.0;
+        double im = 0.0;
+        for (int j = 0; j < n; j++)
+        {
+            double angle = sign * 2 * 3.14159265358979323846 * ((long long)j * k % n) / n;
+            re += in[j * 2] * cos(angle) - in[j * 2 + 1] * sin(angle);
+            im += in[j * 2] * sin(angle) + in[j * 2 + 1] * cos(angle);
+        }
+        out[k * 2] = (float)re;
+        out[k * 2 + 1] = (float)im;
+    }
+}
+
+static int compare_complex(const float* a, const float* b, int n, float epsilon)
+{
+    for (int i = 0; i < n * 2; i++)
+    {
+        if (!NearlyEqual(a[i], b[i], epsilon))
+        {
+            fprintf(stderr, "value not match at %d %s expect %f but got %f\n", i / 2, i % 2 ? "im" : "re", a[i], b[i]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_fft(int n)
+{
+    ncnn::FFT fft;
+    if (fft.create(n) != 0)
+    {
+        fprintf(stderr, "test_fft create failed n=%d\n", n);
+        return -1;
+    }
+
+    ncnn::Mat a = RandomMat(n * 2);
+    ncnn::Mat workspace(fft.workspace_size());
+
+    ncnn::Mat ref(n * 2);
+    ncnn::Mat out(n * 2);
+
+    // complex forward
+    dft_naive(a, ref, n, -1);
+    fft.forward(a, out, workspace);
+    if (compare_complex(ref, out, n, 0.001f) != 0)
+    {
+        fprintf(stderr, "test_fft forward failed n=%d\n", n);
+        return -1;
+    }
+
+    // complex forward in-place
+    ncnn::Mat b = a.clone();
+    fft.forward(b, b, workspace);
+    if (compare_complex(ref, b, n, 0.001f) != 0)
+    {
+        fprintf(stderr, "test_fft forward in-place failed n=%d\n", n);
+        return -1;
+    }
+
+    // complex inverse
+    dft_naive(a, ref, n, 1);
+    fft.inverse(a, out, workspace);
+    if (compare_complex(ref, out, n, 0.001f) != 0)
+    {
+        fprintf(stderr, "test_fft inverse failed n=%d\n", n);
+        return -1;
+    }
+
+    // real forward
+    ncnn::Mat r = RandomMat(n);
+    ncnn::Mat rc(n * 2);
+    for (int i = 0; i < n; i++)
+    {
+        rc[i * 2] = r[i];
+        rc[i * 2 + 1] = 0.f;
+    }
+    dft_naive(rc, ref, n, -1);
+    fft.forward_real(r, out, workspace);
+    if (compare_complex(ref, out, n / 2 + 1, 0.001f) != 0)
+    {
+        fprintf(stderr, "test_fft forward_real failed n=%d\n", n);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_fft_0()
+{
+    return 0
+           || test_fft(1)
+           || test_fft(2)
+           || test_fft(3)
+           || test_fft(4)
+           || test_fft(5)
+           || test_fft(8)
+           || test_fft(12)
+           || test_fft(16);
+}
+
+static int test_fft_1()
+{
+    return 0
+           || test_fft(10)
+           || test_fft(17)
+           || test_fft(35)
+           || test_fft(55)
+           || test_fft(98)
+           || test_fft(121)
+           || test_fft(255);
+}
+
+static int test_fft_2()
+{
+    return 0
+           || test_fft(64)
+           || test_fft(128)
+           || test_fft(256)
+           || test_fft(400)
+           || test_fft(512)
+           || test_fft(1024);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_fft_0()
+           || test_fft_1()
+           || test_fft_2();
+}
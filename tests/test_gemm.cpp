@@ -136,6 +136,56 @@ static int test_gemm_bias(int M, int N, int K, const ncnn::Mat& C, float alpha,
     return ret;
 }
 
+static int test_gemm_act(int M, int N, int K, float alpha, int transA, int transB, int output_transpose, int constantA, int constantB, int activation_type)
+{
+    ncnn::Mat activation_params(2);
+    activation_params[0] = (activation_type == 6) ? RandomFloat(0, 1) : RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);                                               // beta
+
+    ncnn::ParamDict pd;
+    pd.set(0, alpha);
+    pd.set(1, 0.6f); // beta
+    pd.set(2, transA);
+    pd.set(3, transB);
+    pd.set(4, constantA);
+    pd.set(5, constantB);
+    pd.set(6, 1);
+    pd.set(7, M);
+    pd.set(8, N);
+    pd.set(9, K);
+    pd.set(10, 4);
+    pd.set(14, output_transpose);
+    pd.set(15, activation_type);
+    pd.set(16, activation_params);
+
+    std::vector<ncnn::Mat> weights;
+    if (constantA) weights.push_back(transA ? ncnn::Mat(M, K) : ncnn::Mat(K, M));
+    if (constantB) weights.push_back(transB ? ncnn::Mat(K, N) : ncnn::Mat(N, K));
+    weights.push_back(ncnn::Mat(N));
+
+    std::vector<ncnn::Mat> a;
+    if (!constantA) a.push_back(transA ? ncnn::Mat(M, K) : ncnn::Mat(K, M));
+    if (!constantB) a.push_back(transB ? ncnn::Mat(K, N) : ncnn::Mat(N, K));
+
+    for (size_t i = 0; i < weights.size(); i++)
+    {
+        Randomize(weights[i]);
+    }
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        Randomize(a[i]);
+    }
+
+    int ret = test_layer("Gemm", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gemm_act failed M=%d N=%d K=%d alpha=%f transA=%d transB=%d output_transpose=%d constantA=%d constantB=%d act=%d actparams=[%f,%f]\n", M, N, K, alpha, transA, transB, output_transpose, constantA, constantB, activation_type, activation_params[0], activation_params[1]);
+    }
+
+    return ret;
+}
+
 static int test_gemm_0(int M, int N, int K)
 {
     return 0
@@ -245,6 +295,19 @@ static int test_gemm_1(int M, int N, int K)
            || test_gemm_bias(M, N, K, RandomMat(N), 3.1f, 0.6f, 0, 1, 0, 1, 1, 1);
 }
 
+static int test_gemm_2(int M, int N, int K)
+{
+    return 0
+           || test_gemm_act(M, N, K, 1.f, 0, 0, 0, 0, 0, 1)
+           || test_gemm_act(M, N, K, 2.1f, 0, 1, 0, 0, 1, 2)
+           || test_gemm_act(M, N, K, 1.f, 1, 0, 1, 1, 0, 3)
+           || test_gemm_act(M, N, K, 0.7f, 1, 1, 0, 0, 0, 4)
+           || test_gemm_act(M, N, K, 1.f, 0, 1, 1, 0, 1, 5)
+           || test_gemm_act(M, N, K, 1.3f, 1, 0, 0, 0, 0, 6)
+           || test_gemm_act(M, N, K, 1.f, 0, 0, 0, 0, 1, 7)
+           || test_gemm_act(M, N, K, 0.9f, 1, 1, 1, 1, 0, 8);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -297,7 +360,8 @@ int main()
 
         int ret = 0
                   || test_gemm_0(M, N, K)
-                  || test_gemm_1(M, N, K);
+                  || test_gemm_1(M, N, K)
+                  || test_gemm_2(M, N, K);
 
         if (ret != 0)
             return ret;
@@ -21,7 +21,7 @@ static int test_innerproduct(const ncnn::Mat& a, int outch, int bias)
     pd.set(1, bias);  // bias_term
     pd.set(2, outch * a.w * a.h * a.c);
 
-    int activation_type = RAND() % 7; // 0 1 2 3 4 5 6
+    int activation_type = RAND() % 9; // 0 1 2 3 4 5 6 7 8
     ncnn::Mat activation_params(2);
     activation_params[0] = (activation_type == 6) ? RandomFloat(0, 1) : RandomFloat(-1, 0); // alpha
     activation_params[1] = RandomFloat(0, 1);                                               // beta
@@ -255,8 +255,113 @@ static int test_innerproduct_5()
            || test_innerproduct_gemm_int8(RandomMat(6, 16), 16, 0)
            || test_innerproduct_gemm_int8(RandomMat(12, 16), 7, 1);
 }
+
+static int test_innerproduct_int8_dynamic(const ncnn::Mat& a, int outch, int bias)
+{
+    ncnn::ParamDict pd;
+    pd.set(0, outch); // num_output
+    pd.set(1, bias);  // bias_term
+    pd.set(2, outch * (a.dims == 2 ? a.w : a.w * a.h * a.c));
+    pd.set(20, 1); // int8_dynamic_quantize
+
+    int activation_type = RAND() % 7; // 0 1 2 3 4 5 6
+    ncnn::Mat activation_params(2);
+    activation_params[0] = (activation_type == 6) ? RandomFloat(0, 1) : RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);                                               // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * (a.dims == 2 ? a.w : a.w * a.h * a.c));
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    int flag = TEST_LAYER_DISABLE_GPU_TESTING;
+    int ret = test_layer("InnerProduct", pd, weights, a, 0.001f, 0, flag);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_int8_dynamic failed a.dims=%d a=(%d %d %d) outch=%d bias=%d act=%d actparams=[%f,%f]\n", a.dims, a.w, a.h, a.c, outch, bias, activation_type, activation_params[0], activation_params[1]);
+    }
+
+    return ret;
+}
+
+static int test_innerproduct_6()
+{
+    return 0
+           || test_innerproduct_int8_dynamic(RandomMat(1, 3, 1), 1, 1)
+           || test_innerproduct_int8_dynamic(RandomMat(5, 3, 3), 3, 0)
+           || test_innerproduct_int8_dynamic(RandomMat(4, 3, 8), 8, 1)
+           || test_innerproduct_int8_dynamic(RandomMat(16), 7, 1)
+           || test_innerproduct_int8_dynamic(RandomMat(24), 16, 0)
+           || test_innerproduct_int8_dynamic(RandomMat(1, 5), 1, 1)
+           || test_innerproduct_int8_dynamic(RandomMat(9, 8), 7, 1)
+           || test_innerproduct_int8_dynamic(RandomMat(13, 12), 8, 0)
+           || test_innerproduct_int8_dynamic(RandomMat(6, 16), 16, 1)
+           || test_innerproduct_int8_dynamic(RandomMat(12, 16), 7, 1);
+}
 #endif // NCNN_INT8
 
+static int test_innerproduct_weight_quant(const ncnn::Mat& a, int outch, int bias, int bits, int group_size)
+{
+    const int num_input = a.dims == 2 ? a.w : a.w * a.h * a.c;
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch); // num_output
+    pd.set(1, bias);  // bias_term
+    pd.set(2, outch * num_input);
+    pd.set(21, bits);       // weight_quant_bits
+    pd.set(22, group_size); // weight_quant_group_size
+
+    int activation_type = RAND() % 7; // 0 1 2 3 4 5 6
+    ncnn::Mat activation_params(2);
+    activation_params[0] = (activation_type == 6) ? RandomFloat(0, 1) : RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);                                               // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    const int group_count = num_input / (group_size ? group_size : num_input);
+
+    std::vector<ncnn::Mat> weights(bias ? 3 : 2);
+    weights[0] = RandomS8Mat(outch * num_input * bits / 8);
+    if (bias)
+    {
+        weights[1] = RandomMat(outch);
+        weights[2] = RandomMat(group_count * outch, 0.001f, 0.02f);
+    }
+    else
+    {
+        weights[1] = RandomMat(group_count * outch, 0.001f, 0.02f);
+    }
+
+    int flag = TEST_LAYER_DISABLE_GPU_TESTING;
+    int ret = test_layer("InnerProduct", pd, weights, a, 0.001f, 0, flag);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_weight_quant failed a.dims=%d a=(%d %d %d) outch=%d bias=%d bits=%d group_size=%d act=%d actparams=[%f,%f]\n", a.dims, a.w, a.h, a.c, outch, bias, bits, group_size, activation_type, activation_params[0], activation_params[1]);
+    }
+
+    return ret;
+}
+
+static int test_innerproduct_7()
+{
+    return 0
+           || test_innerproduct_weight_quant(RandomMat(2, 3, 4), 5, 1, 8, 0)
+           || test_innerproduct_weight_quant(RandomMat(4, 4, 8), 8, 0, 8, 32)
+           || test_innerproduct_weight_quant(RandomMat(64), 16, 1, 8, 16)
+           || test_innerproduct_weight_quant(RandomMat(70), 7, 1, 8, 35)
+           || test_innerproduct_weight_quant(RandomMat(2, 3, 4), 5, 1, 4, 0)
+           || test_innerproduct_weight_quant(RandomMat(4, 4, 8), 8, 0, 4, 32)
+           || test_innerproduct_weight_quant(RandomMat(64), 16, 1, 4, 16)
+           || test_innerproduct_weight_quant(RandomMat(70), 7, 1, 4, 14)
+           || test_innerproduct_weight_quant(RandomMat(48, 5), 12, 1, 8, 16)
+           || test_innerproduct_weight_quant(RandomMat(48, 8), 16, 0, 4, 48)
+           || test_innerproduct_weight_quant(RandomMat(30, 3), 9, 1, 4, 10)
+           || test_innerproduct_weight_quant(RandomMat(4096, 4), 72, 1, 4, 128)
+           || test_innerproduct_weight_quant(RandomMat(4096, 8), 40, 0, 8, 64);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -268,12 +373,15 @@ int main()
            || test_innerproduct_2()
            || test_innerproduct_3()
            || test_innerproduct_4()
-           || test_innerproduct_5();
+           || test_innerproduct_5()
+           || test_innerproduct_6()
+           || test_innerproduct_7();
 #else
     return 0
            || test_innerproduct_0()
            || test_innerproduct_1()
            || test_innerproduct_2()
-           || test_innerproduct_4();
+           || test_innerproduct_4()
+           || test_innerproduct_7();
 #endif
 }
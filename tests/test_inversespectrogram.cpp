@@ -48,9 +48,20 @@ static int test_inversespectrogram_0()
            || test_inversespectrogram(124, 28, 55, 2, 12, 55, 1, 1, 2);
 }
 
+static int test_inversespectrogram_1()
+{
+    return 0
+           || test_inversespectrogram(9, 257, 512, 0, 128, 512, 1, 1, 0)
+           || test_inversespectrogram(6, 201, 400, 1, 160, 400, 1, 1, 1)
+           || test_inversespectrogram(11, 256, 256, 2, 64, 200, 2, 0, 2)
+           || test_inversespectrogram(13, 96, 96, 1, 24, 96, 1, 1, 0);
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_inversespectrogram_0();
+    return 0
+           || test_inversespectrogram_0()
+           || test_inversespectrogram_1();
 }
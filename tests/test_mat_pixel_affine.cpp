@@ -498,9 +498,113 @@ static int test_mat_pixel_affine_1()
            || test_mat_pixel_affine_yuv420sp(220, 340);
 }
 
+// per pixel with the same fixed point arithmetic, constant border
+static void warpaffine_bilinear_ref(const unsigned char* src, int srcw, int srch, int srcstride, int c, unsigned char* dst, int w, int h, int stride, const float* tm, unsigned int v)
+{
+    const unsigned char* border_color = (const unsigned char*)&v;
+
+    for (int y = 0; y < h; y++)
+    {
+        float X0f = (tm[1] * y + tm[2]) * (1 << 10);
+        float Y0f = (tm[4] * y + tm[5]) * (1 << 10);
+        int X0 = (int)(X0f + (X0f >= 0.f ? 0.5f : -0.5f));
+        int Y0 = (int)(Y0f + (Y0f >= 0.f ? 0.5f : -0.5f));
+
+        for (int x = 0; x < w; x++)
+        {
+            float adeltaf = tm[0] * x * (1 << 10);
+            float bdeltaf = tm[3] * x * (1 << 10);
+            int X = X0 + (int)(adeltaf + (adeltaf >= 0.f ? 0.5f : -0.5f));
+            int Y = Y0 + (int)(bdeltaf + (bdeltaf >= 0.f ? 0.5f : -0.5f));
+
+            int sx = X >> 10;
+            int sy = Y >> 10;
+
+            unsigned char* p = dst + stride * y + x * c;
+
+            if (sx < -1 || sx >= srcw || sy < -1 || sy >= srch)
+            {
+                for (int k = 0; k < c; k++)
+                    p[k] = border_color[k];
+                continue;
+            }
+
+            int alpha0 = (1 << 10) - (X & ((1 << 10) - 1));
+            int alpha1 = X & ((1 << 10) - 1);
+            int beta0 = (1 << 10) - (Y & ((1 << 10) - 1));
+            int beta1 = Y & ((1 << 10) - 1);
+
+            const unsigned char* a0 = sx >= 0 && sy >= 0 ? src + srcstride * sy + sx * c : border_color;
+            const unsigned char* a1 = sx + 1 < srcw && sy >= 0 ? src + srcstride * sy + (sx + 1) * c : border_color;
+            const unsigned char* b0 = sx >= 0 && sy + 1 < srch ? src + srcstride * (sy + 1) + sx * c : border_color;
+            const unsigned char* b1 = sx + 1 < srcw && sy + 1 < srch ? src + srcstride * (sy + 1) + (sx + 1) * c : border_color;
+
+            for (int k = 0; k < c; k++)
+            {
+                p[k] = (unsigned char)(((unsigned short)((a0[k] * alpha0 + a1[k] * alpha1) >> 5) * beta0 + (unsigned short)((b0[k] * alpha0 + b1[k] * alpha1) >> 5) * beta1) >> 15);
+            }
+        }
+    }
+}
+
+static int test_mat_pixel_affine_threads(int w, int h, float angle, float scale)
+{
+    ncnn::Option opt;
+    opt.num_threads = 4;
+
+    for (int c = 1; c <= 4; c++)
+    {
+        // noise catches mixed up channels and taps
+        const int srcstride = w * c + 3;
+        ncnn::Mat a0(srcstride, h, (size_t)1u, 1);
+        for (int i = 0; i < srcstride * h; i++)
+        {
+            ((unsigned char*)a0)[i] = RAND() % 256;
+        }
+
+        const int outw = w * 2 / 3;
+        const int outh = h * 3 / 4;
+        const int stride = outw * c + 1;
+
+        float tm[6];
+        ncnn::get_rotation_matrix(angle, scale, w / 2, h / 2, tm);
+
+        const unsigned int border = 0x40302010;
+
+        ncnn::Mat a1(stride, outh, (size_t)1u, 1);
+        ncnn::Mat a2(stride, outh, (size_t)1u, 1);
+        memset(a1, 0, stride * outh);
+        memset(a2, 0, stride * outh);
+
+        if (c == 1) ncnn::warpaffine_bilinear_c1(a0, w, h, srcstride, a1, outw, outh, stride, tm, 0, border, opt);
+        if (c == 2) ncnn::warpaffine_bilinear_c2(a0, w, h, srcstride, a1, outw, outh, stride, tm, 0, border, opt);
+        if (c == 3) ncnn::warpaffine_bilinear_c3(a0, w, h, srcstride, a1, outw, outh, stride, tm, 0, border, opt);
+        if (c == 4) ncnn::warpaffine_bilinear_c4(a0, w, h, srcstride, a1, outw, outh, stride, tm, 0, border, opt);
+
+        warpaffine_bilinear_ref(a0, w, h, srcstride, c, a2, outw, outh, stride, tm, border);
+
+        if (memcmp(a1, a2, stride * outh) != 0)
+        {
+            fprintf(stderr, "test_mat_pixel_affine_threads failed w=%d h=%d c=%d angle=%f scale=%f\n", w, h, c, angle, scale);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_mat_pixel_affine_2()
+{
+    return 0
+           || test_mat_pixel_affine_threads(60, 70, 10.f, 0.85f)
+           || test_mat_pixel_affine_threads(120, 160, -35.f, 1.3f)
+           || test_mat_pixel_affine_threads(33, 47, 90.f, 0.5f)
+           || test_mat_pixel_affine_threads(90, 60, 0.f, 1.f);
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_mat_pixel_affine_0() || test_mat_pixel_affine_1();
+    return test_mat_pixel_affine_0() || test_mat_pixel_affine_1() || test_mat_pixel_affine_2();
 }
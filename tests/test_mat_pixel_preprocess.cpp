@@ -0,0 +1,252 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "mat.h"
+#include "prng.h"
+
+#include <math.h>
+#include <string.h>
+
+static struct prng_rand_t g_prng_rand_state;
+#define SRAND(seed) prng_srand(seed, &g_prng_rand_state)
+#define RAND()      prng_rand(&g_prng_rand_state)
+
+static ncnn::Mat RandomPixels(int size, int lo, int hi)
+{
+    ncnn::Mat m(size, (size_t)1u, 1);
+
+    unsigned char* p = m;
+    for (int i = 0; i < size; i++)
+    {
+        p[i] = lo + RAND() % (hi - lo);
+    }
+
+    return m;
+}
+
+// unpack and cast to fp32, int8 is taken as is
+static ncnn::Mat UnpackedFloat(const ncnn::Mat& m)
+{
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    ncnn::Mat m1;
+    ncnn::convert_packing(m, m1, 1, opt);
+
+    if (m1.elemsize == 4)
+        return m1;
+
+    ncnn::Mat m2;
+    if (m1.elemsize == 2)
+        ncnn::cast_float16_to_float32(m1, m2, opt);
+    if (m1.elemsize == 1)
+        ncnn::cast_int8_to_float32(m1, m2, opt);
+
+    return m2;
+}
+
+static int Compare(const ncnn::Mat& a, const ncnn::Mat& b, float epsilon)
+{
+    if (a.w != b.w || a.h != b.h || a.c != b.c)
+    {
+        fprintf(stderr, "shape not match    expect %d %d %d but got %d %d %d\n", a.w, a.h, a.c, b.w, b.h, b.c);
+        return -1;
+    }
+
+    for (int q = 0; q < a.c; q++)
+    {
+        const float* pa = a.channel(q);
+        const float* pb = b.channel(q);
+        for (int i = 0; i < a.w * a.h; i++)
+        {
+            if (fabs(pa[i] - pb[i]) > epsilon)
+            {
+                fprintf(stderr, "value not match  at c:%d i:%d    expect %f but got %f\n", q, i, pa[i], pb[i]);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_mat_pixel_preprocess(int type, int w, int h, int roix, int roiy, int roiw, int roih, int target_width, int target_height, int elempack, int elembits, int num_threads)
+{
+    const int type_from = type & ncnn::Mat::PIXEL_FORMAT_MASK;
+    const int type_to = (type & ncnn::Mat::PIXEL_CONVERT_MASK) >> ncnn::Mat::PIXEL_CONVERT_SHIFT;
+    const bool yuv420sp = type_from == ncnn::Mat::PIXEL_NV21 || type_from == ncnn::Mat::PIXEL_NV12;
+
+    const int cn = type_from == ncnn::Mat::PIXEL_GRAY ? 1 : type_from == ncnn::Mat::PIXEL_RGBA || type_from == ncnn::Mat::PIXEL_BGRA ? 4 : 3;
+    const int out_cn = type_to == ncnn::Mat::PIXEL_GRAY ? 1 : type_to == ncnn::Mat::PIXEL_RGBA || type_to == ncnn::Mat::PIXEL_BGRA ? 4 : type_to == 0 ? cn : 3;
+
+    const float mean_vals[4] = {104.f, 117.f, 123.f, 50.f};
+    const float norm_vals[4] = {1 / 58.f, 1 / 57.f, 1 / 59.f, 1 / 60.f};
+
+    // int8 quantizes with the scale folded into norm_vals
+    const float int8_scale = 127 / 2.5f;
+    float norm_vals_int8[4];
+    for (int i = 0; i < 4; i++)
+    {
+        norm_vals_int8[i] = norm_vals[i] * int8_scale;
+    }
+    const float* norm = elembits == 8 ? norm_vals_int8 : norm_vals;
+
+    ncnn::Option opt;
+    opt.num_threads = num_threads;
+
+    // the reference goes through rgb pixels, resize, normalize and packing one by one
+    ncnn::Mat pixels;
+    ncnn::Mat ref;
+    int stride;
+    if (yuv420sp)
+    {
+        // keep yuv to rgb away from saturation where resizing before converting differs
+        stride = w;
+        pixels = RandomPixels(w * h * 3 / 2, 64, 192);
+        unsigned char* uv = (unsigned char*)pixels.data + w * h;
+        for (int i = 0; i < w * h / 2; i++)
+        {
+            uv[i] = 112 + RAND() % 32;
+        }
+
+        ncnn::Mat yuv = pixels;
+        if (type_from == ncnn::Mat::PIXEL_NV12)
+        {
+            // swap chroma to nv21 for yuv420sp2rgb
+            yuv = pixels.clone();
+            unsigned char* p = (unsigned char*)yuv.data + w * h;
+            for (int i = 0; i < w * h / 2; i += 2)
+            {
+                std::swap(p[i], p[i + 1]);
+            }
+        }
+
+        ncnn::Mat rgb(w * h * 3, (size_t)1u, 1);
+        ncnn::yuv420sp2rgb(yuv, w, h, rgb);
+
+        const int type_rgb = type_to == ncnn::Mat::PIXEL_RGB ? ncnn::Mat::PIXEL_RGB : type_to == ncnn::Mat::PIXEL_BGR ? ncnn::Mat::PIXEL_RGB2BGR : ncnn::Mat::PIXEL_RGB2GRAY;
+        ref = ncnn::Mat::from_pixels_roi_resize(rgb, type_rgb, w, h, w * 3, roix, roiy, roiw, roih, target_width, target_height);
+        if (type_to == ncnn::Mat::PIXEL_GRAY)
+        {
+            // gray from yuv is the luma plane
+            ref = ncnn::Mat::from_pixels_roi_resize(pixels, ncnn::Mat::PIXEL_GRAY, w, h, w, roix, roiy, roiw, roih, target_width, target_height);
+        }
+    }
+    else
+    {
+        stride = w * cn + 7;
+        pixels = RandomPixels(stride * h, 0, 256);
+
+        ref = ncnn::Mat::from_pixels_roi_resize(pixels, type, w, h, stride, roix, roiy, roiw, roih, target_width, target_height);
+    }
+
+    ref.substract_mean_normalize(mean_vals, norm);
+
+    if (elembits == 8)
+    {
+        for (int q = 0; q < ref.c; q++)
+        {
+            float* ptr = ref.channel(q);
+            for (int i = 0; i < ref.w * ref.h; i++)
+            {
+                ptr[i] = std::min(std::max(roundf(ptr[i]), -127.f), 127.f);
+            }
+        }
+    }
+
+    ncnn::Mat m = ncnn::Mat::from_pixels_roi_resize_normalize(pixels, type, w, h, stride, roix, roiy, roiw, roih, target_width, target_height, mean_vals, norm, elempack, elembits, opt);
+    if (m.empty() || m.c != out_cn / elempack || m.elempack != elempack || (int)m.elemsize != elembits / 8 * elempack)
+    {
+        fprintf(stderr, "test_mat_pixel_preprocess bad blob type=%d elempack=%d elembits=%d\n", type, elempack, elembits);
+        return -1;
+    }
+
+    // within a couple of pixel levels for the uint8 intermediates of the reference
+    float epsilon = 2.f / 57;
+    if (elembits == 16)
+        epsilon += 0.005f;
+    if (elembits == 8)
+        epsilon = 2.f * int8_scale / 57 + 1;
+
+    if (Compare(ref, UnpackedFloat(m), epsilon) != 0)
+    {
+        fprintf(stderr, "test_mat_pixel_preprocess failed type=%d w=%d h=%d roi=[%d %d %d %d] target_width=%d target_height=%d elempack=%d elembits=%d num_threads=%d\n", type, w, h, roix, roiy, roiw, roih, target_width, target_height, elempack, elembits, num_threads);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_mat_pixel_preprocess_0()
+{
+    const int types[] = {
+        ncnn::Mat::PIXEL_RGB,
+        ncnn::Mat::PIXEL_BGR2RGB,
+        ncnn::Mat::PIXEL_RGB2GRAY,
+        ncnn::Mat::PIXEL_GRAY2BGR,
+        ncnn::Mat::PIXEL_RGBA2BGR,
+        ncnn::Mat::PIXEL_BGRA2RGBA,
+        ncnn::Mat::PIXEL_NV212RGB,
+        ncnn::Mat::PIXEL_NV122BGR,
+        ncnn::Mat::PIXEL_NV212GRAY,
+    };
+
+    for (int i = 0; i < (int)(sizeof(types) / sizeof(int)); i++)
+    {
+        const int type = types[i];
+
+        int ret = 0
+                  || test_mat_pixel_preprocess(type, 24, 16, 0, 0, 24, 16, 24, 16, 1, 32, 1)
+                  || test_mat_pixel_preprocess(type, 64, 48, 0, 0, 64, 48, 19, 13, 1, 32, 1)
+                  || test_mat_pixel_preprocess(type, 40, 36, 3, 5, 31, 22, 57, 41, 1, 32, 2)
+                  || test_mat_pixel_preprocess(type, 36, 30, 7, 2, 23, 25, 16, 16, 1, 16, 3)
+                  || test_mat_pixel_preprocess(type, 36, 30, 1, 2, 33, 25, 16, 9, 1, 8, 1);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_mat_pixel_preprocess_1()
+{
+    // packed blobs for the four channel outputs
+    const int types[] = {
+        ncnn::Mat::PIXEL_RGBA,
+        ncnn::Mat::PIXEL_RGB2BGRA,
+    };
+
+    for (int i = 0; i < (int)(sizeof(types) / sizeof(int)); i++)
+    {
+        const int type = types[i];
+
+        int ret = 0
+                  || test_mat_pixel_preprocess(type, 32, 24, 0, 0, 32, 24, 16, 12, 4, 32, 1)
+                  || test_mat_pixel_preprocess(type, 32, 24, 2, 3, 25, 17, 41, 29, 4, 16, 2)
+                  || test_mat_pixel_preprocess(type, 32, 24, 2, 3, 25, 17, 15, 8, 4, 8, 1);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return test_mat_pixel_preprocess_0() || test_mat_pixel_preprocess_1();
+}
@@ -15,6 +15,7 @@
 #include "mat.h"
 #include "prng.h"
 
+#include <math.h>
 #include <string.h>
 
 static struct prng_rand_t g_prng_rand_state;
@@ -125,6 +126,144 @@ static int test_mat_pixel_resize(int w, int h, int ch, int target_width, int tar
     return 0;
 }
 
+static int test_mat_pixel_resize_threads(int w, int h, int ch, int target_width, int target_height)
+{
+    ncnn::Option opt;
+    opt.num_threads = 4;
+
+    // padded rows
+    const int srcstride = w * ch + 5;
+    const int stride = target_width * ch + 3;
+
+    ncnn::Mat a = RandomMat(srcstride, h, 1);
+
+    ncnn::Mat b(stride, target_height, (size_t)1u, 1);
+    ncnn::Mat b2(stride, target_height, (size_t)1u, 1);
+    memset(b, 0, stride * target_height);
+    memset(b2, 0, stride * target_height);
+
+    if (ch == 1) resize_bilinear_c1(a, w, h, srcstride, b, target_width, target_height, stride);
+    if (ch == 2) resize_bilinear_c2(a, w, h, srcstride, b, target_width, target_height, stride);
+    if (ch == 3) resize_bilinear_c3(a, w, h, srcstride, b, target_width, target_height, stride);
+    if (ch == 4) resize_bilinear_c4(a, w, h, srcstride, b, target_width, target_height, stride);
+
+    if (ch == 1) resize_bilinear_c1(a, w, h, srcstride, b2, target_width, target_height, stride, opt);
+    if (ch == 2) resize_bilinear_c2(a, w, h, srcstride, b2, target_width, target_height, stride, opt);
+    if (ch == 3) resize_bilinear_c3(a, w, h, srcstride, b2, target_width, target_height, stride, opt);
+    if (ch == 4) resize_bilinear_c4(a, w, h, srcstride, b2, target_width, target_height, stride, opt);
+
+    if (memcmp(b, b2, stride * target_height) != 0)
+    {
+        fprintf(stderr, "test_mat_pixel_resize_threads failed w=%d h=%d ch=%d target_width=%d target_height=%d\n", w, h, ch, target_width, target_height);
+        return -1;
+    }
+
+    return 0;
+}
+
+// the share of source pixel [s, s + 1) in output cell d
+static double area_overlap(int s, int d, double scale)
+{
+    double x0 = std::max((double)s, d * scale);
+    double x1 = std::min((double)s + 1, (d + 1) * scale);
+    return x1 > x0 ? (x1 - x0) / scale : 0.0;
+}
+
+static int test_mat_pixel_resize_area(int w, int h, int ch, int target_width, int target_height)
+{
+    ncnn::Option opt;
+    opt.num_threads = 2;
+
+    ncnn::Mat a = RandomMat(w, h, ch);
+
+    ncnn::Mat b(target_width, target_height, 1, (size_t)ch, ch);
+
+    if (ch == 1) resize_area_c1(a, w, h, b, target_width, target_height, opt);
+    if (ch == 2) resize_area_c2(a, w, h, b, target_width, target_height, opt);
+    if (ch == 3) resize_area_c3(a, w, h, b, target_width, target_height, opt);
+    if (ch == 4) resize_area_c4(a, w, h, b, target_width, target_height, opt);
+
+    const double scale_x = (double)w / target_width;
+    const double scale_y = (double)h / target_height;
+
+    const unsigned char* pa = a;
+    const unsigned char* pb = b;
+    for (int dy = 0; dy < target_height; dy++)
+    {
+        for (int dx = 0; dx < target_width; dx++)
+        {
+            for (int k = 0; k < ch; k++)
+            {
+                double sum = 0;
+                for (int sy = 0; sy < h; sy++)
+                {
+                    const double wy = area_overlap(sy, dy, scale_y);
+                    if (wy == 0)
+                        continue;
+
+                    for (int sx = 0; sx < w; sx++)
+                    {
+                        sum += pa[(sy * w + sx) * ch + k] * wy * area_overlap(sx, dx, scale_x);
+                    }
+                }
+
+                const int v = pb[(dy * target_width + dx) * ch + k];
+                if (fabs(sum - v) > 1)
+                {
+                    fprintf(stderr, "test_mat_pixel_resize_area failed w=%d h=%d ch=%d target_width=%d target_height=%d at %d %d %d, expect %f but got %d\n", w, h, ch, target_width, target_height, dx, dy, k, sum, v);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_mat_pixel_resize_bicubic(int w, int h, int ch, int target_width, int target_height)
+{
+    ncnn::Option opt;
+    opt.num_threads = 2;
+
+    ncnn::Mat a = RandomMat(w, h, ch);
+
+    ncnn::Mat b(target_width, target_height, 1, (size_t)ch, ch);
+
+    if (ch == 1) resize_bicubic_c1(a, w, h, b, target_width, target_height, opt);
+    if (ch == 2) resize_bicubic_c2(a, w, h, b, target_width, target_height, opt);
+    if (ch == 3) resize_bicubic_c3(a, w, h, b, target_width, target_height, opt);
+    if (ch == 4) resize_bicubic_c4(a, w, h, b, target_width, target_height, opt);
+
+    ncnn::Mat a2;
+    ncnn::convert_packing(a, a2, 1, opt);
+
+    ncnn::Mat b2;
+    ncnn::convert_packing(b, b2, 1, opt);
+
+    for (int i = 0; i < ch; i++)
+    {
+        ncnn::Mat c = ncnn::Mat::from_pixels(a2.channel(i), ncnn::Mat::PIXEL_GRAY, w, h);
+        ncnn::Mat d = ncnn::Mat::from_pixels(b2.channel(i), ncnn::Mat::PIXEL_GRAY, target_width, target_height);
+
+        ncnn::Mat e;
+        ncnn::resize_bicubic(c, e, target_width, target_height, opt);
+
+        // the float reference is not saturated
+        for (int j = 0; j < e.w * e.h; j++)
+        {
+            e[j] = std::min(std::max(e[j], 0.f), 255.f);
+        }
+
+        if (Compare(e, d, 0.6) != 0)
+        {
+            fprintf(stderr, "test_mat_pixel_resize_bicubic failed w=%d h=%d ch=%d target_width=%d target_height=%d\n", w, h, ch, target_width, target_height);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 static int test_mat_pixel_roi_resize_gray(int w, int h, int roix, int roiy, int roiw, int roih, int target_width, int target_height)
 {
     ncnn::Option opt;
@@ -331,9 +470,33 @@ static int test_mat_pixel_2()
            || test_mat_pixel_roi_resize_bgra(15, 15, 7, 3, 1, 1, 1, 1);
 }
 
+static int test_mat_pixel_3()
+{
+    for (int c = 1; c <= 4; c++)
+    {
+        int ret = 0
+                  || test_mat_pixel_resize_threads(24, 48, c, 24, 48)
+                  || test_mat_pixel_resize_threads(67, 43, c, 23, 19)
+                  || test_mat_pixel_resize_threads(9, 7, c, 53, 37)
+                  || test_mat_pixel_resize_threads(3, 2, c, 5, 4)
+                  || test_mat_pixel_resize_area(24, 48, c, 12, 16)
+                  || test_mat_pixel_resize_area(67, 43, c, 13, 10)
+                  || test_mat_pixel_resize_area(33, 23, c, 33, 7)
+                  || test_mat_pixel_resize_bicubic(24, 48, c, 24, 48)
+                  || test_mat_pixel_resize_bicubic(13, 17, c, 11, 14)
+                  || test_mat_pixel_resize_bicubic(33, 23, c, 5, 6)
+                  || test_mat_pixel_resize_bicubic(7, 5, c, 31, 16);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_mat_pixel_0() || test_mat_pixel_1() || test_mat_pixel_2();
+    return test_mat_pixel_0() || test_mat_pixel_1() || test_mat_pixel_2() || test_mat_pixel_3();
 }
@@ -132,6 +132,55 @@ static int test_multiheadattention_sameqkv(const ncnn::Mat& a, int embed_dim, in
     return ret;
 }
 
+static int test_multiheadattention_kvcache(const ncnn::Mat& q, const ncnn::Mat& k, const ncnn::Mat& v, int past_seqlen, int embed_dim, int num_heads, int attn_mask)
+{
+    const int qdim = q.w;
+    const int kdim = k.w;
+    const int vdim = v.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, kdim);
+    pd.set(4, vdim);
+    pd.set(5, attn_mask);
+    pd.set(7, 1); // kv_cache
+
+    std::vector<ncnn::Mat> weights(8);
+    weights[0] = RandomMat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomMat(embed_dim * kdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomMat(embed_dim * vdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomMat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+
+    std::vector<ncnn::Mat> as(3);
+    as[0] = q;
+    as[1] = k;
+    as[2] = v;
+
+    if (attn_mask)
+    {
+        as.push_back(RandomMat(past_seqlen + k.h, q.h));
+    }
+
+    as.push_back(RandomMat(past_seqlen, embed_dim));
+    as.push_back(RandomMat(past_seqlen, embed_dim));
+
+    float epsilon = 0.005;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 3, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_kvcache failed q=(%d %d) k=(%d %d) v=(%d %d) past_seqlen=%d embed_dim=%d num_heads=%d kdim=%d vdim=%d attn_mask=%d\n", q.w, q.h, k.w, k.h, v.w, v.h, past_seqlen, embed_dim, num_heads, kdim, vdim, attn_mask);
+    }
+
+    return ret;
+}
+
 static int test_multiheadattention_0()
 {
     return 0
@@ -163,6 +212,15 @@ static int test_multiheadattention_2()
            || test_multiheadattention_sameqkv(RandomMat(48, 127), 64, 8);
 }
 
+static int test_multiheadattention_3()
+{
+    return 0
+           || test_multiheadattention_kvcache(RandomMat(64, 1), RandomMat(64, 1), RandomMat(64, 1), 15, 64, 4, 0)
+           || test_multiheadattention_kvcache(RandomMat(48, 1), RandomMat(32, 1), RandomMat(28, 1), 32, 64, 8, 1)
+           || test_multiheadattention_kvcache(RandomMat(26, 4), RandomMat(32, 4), RandomMat(18, 4), 13, 26, 2, 1)
+           || test_multiheadattention_kvcache(RandomMat(12, 17), RandomMat(28, 17), RandomMat(32, 17), 40, 12, 3, 0);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -170,5 +228,6 @@ int main()
     return 0
            || test_multiheadattention_0()
            || test_multiheadattention_1()
-           || test_multiheadattention_2();
+           || test_multiheadattention_2()
+           || test_multiheadattention_3();
 }
@@ -150,6 +150,61 @@ static int test_multiheadattention_int8_sameqkv(const ncnn::Mat& a, int embed_di
     return ret;
 }
 
+static int test_multiheadattention_int8_kvcache(const ncnn::Mat& q, const ncnn::Mat& k, const ncnn::Mat& v, int past_seqlen, int embed_dim, int num_heads, int attn_mask)
+{
+    const int qdim = q.w;
+    const int kdim = k.w;
+    const int vdim = v.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, kdim);
+    pd.set(4, vdim);
+    pd.set(5, attn_mask);
+    pd.set(6, 1.f / sqrtf(embed_dim / num_heads));
+    pd.set(7, 1);  // kv_cache
+    pd.set(18, 2); // int8_scale_term
+
+    std::vector<ncnn::Mat> weights(12);
+    weights[0] = RandomS8Mat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomS8Mat(embed_dim * kdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomS8Mat(embed_dim * vdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomS8Mat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+    weights[8] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[9] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[10] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[11] = RandomMat(1, 160.f, 200.f);
+
+    std::vector<ncnn::Mat> as(3);
+    as[0] = q;
+    as[1] = k;
+    as[2] = v;
+
+    if (attn_mask)
+    {
+        as.push_back(RandomMat(past_seqlen + k.h, q.h));
+    }
+
+    as.push_back(RandomMat(past_seqlen, embed_dim));
+    as.push_back(RandomMat(past_seqlen, embed_dim));
+
+    float epsilon = 0.1;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 3, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_int8_kvcache failed q=(%d %d) k=(%d %d) v=(%d %d) past_seqlen=%d embed_dim=%d num_heads=%d kdim=%d vdim=%d attn_mask=%d\n", q.w, q.h, k.w, k.h, v.w, v.h, past_seqlen, embed_dim, num_heads, kdim, vdim, attn_mask);
+    }
+
+    return ret;
+}
+
 static int test_multiheadattention_0()
 {
     return 0
@@ -180,6 +235,13 @@ static int test_multiheadattention_2()
            || test_multiheadattention_int8_sameqkv(RandomMat(64, 128), 64, 4)
            || test_multiheadattention_int8_sameqkv(RandomMat(48, 127), 64, 8);
 }
+
+static int test_multiheadattention_3()
+{
+    return 0
+           || test_multiheadattention_int8_kvcache(RandomMat(64, 1), RandomMat(64, 1), RandomMat(64, 1), 15, 64, 4, 0)
+           || test_multiheadattention_int8_kvcache(RandomMat(26, 4), RandomMat(32, 4), RandomMat(18, 4), 13, 26, 2, 1);
+}
 #endif
 
 int main()
@@ -190,7 +252,8 @@ int main()
     return 0
            || test_multiheadattention_0()
            || test_multiheadattention_1()
-           || test_multiheadattention_2();
+           || test_multiheadattention_2()
+           || test_multiheadattention_3();
 #else
     // test nothing
     return 0;
@@ -0,0 +1,223 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "testutil.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static int run_ncnnoptimize(const char* inparam, const char* outparam, const char* outbin, const char* extra_args)
+{
+    std::string cmd = std::string("\"") + NCNNOPTIMIZE_EXECUTABLE + "\" " + inparam + " null " + outparam + " " + outbin + " 0 " + extra_args;
+    return system(cmd.c_str());
+}
+
+static int write_file(const char* path, const char* content)
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+        fprintf(stderr, "fopen %s failed\n", path);
+        return -1;
+    }
+    fputs(content, fp);
+    fclose(fp);
+
+    return 0;
+}
+
+static bool file_contains(const char* path, const char* word)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return false;
+
+    char line[1024];
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), fp))
+    {
+        found = strstr(line, word) != 0;
+    }
+    fclose(fp);
+
+    return found;
+}
+
+static int extract(const char* parampath, const char* binpath, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Net net;
+    if (net.load_param(parampath) != 0)
+        return -1;
+
+    if (net.load_model(binpath) != 0)
+        return -1;
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("in", in);
+    return ex.extract("out", out);
+}
+
+// the Input shape of a dynamic shape model is only a placeholder
+// without shape= the optimized model must still take any input shape
+static int test_ncnnoptimize_dynamic_shape()
+{
+    const char* inparam = "test_ncnnoptimize_dynamic.param";
+    const char* outparam = "test_ncnnoptimize_dynamic-opt.param";
+    const char* outbin = "test_ncnnoptimize_dynamic-opt.bin";
+
+    // keep is a noop and swap resolves to 6x4 for the placeholder 4x6
+    const char param[] = "7767517\n3 3\n"
+                         "Input in 0 1 in 0=4 1=6\n"
+                         "Reshape keep 1 1 in keep 0=-1 1=6\n"
+                         "Reshape swap 1 1 keep out 6=\"0h,0w\"\n";
+
+    if (write_file(inparam, param) != 0)
+        return -1;
+
+    int ret = 0;
+
+    if (run_ncnnoptimize(inparam, outparam, outbin, "") != 0)
+    {
+        fprintf(stderr, "test_ncnnoptimize_dynamic_shape ncnnoptimize failed\n");
+        ret = -1;
+    }
+
+    // other shapes than the placeholder
+    const int shapes[][2] = {{4, 6}, {8, 3}, {5, 12}};
+    for (int i = 0; ret == 0 && i < 3; i++)
+    {
+        ncnn::Mat in = RandomMat(shapes[i][0], shapes[i][1]);
+
+        ncnn::Mat out;
+        if (extract(outparam, outbin, in, out) != 0)
+        {
+            fprintf(stderr, "test_ncnnoptimize_dynamic_shape extract failed in=(%d %d)\n", in.w, in.h);
+            ret = -1;
+            break;
+        }
+
+        // (w*h/6, 6) swapped
+        const int outw = 6;
+        const int outh = in.w * in.h / 6;
+        if (out.dims != 2 || out.w != outw || out.h != outh || CompareMat(in.reshape(outw, outh), out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_ncnnoptimize_dynamic_shape failed in=(%d %d) out=(%d %d)\n", in.w, in.h, out.w, out.h);
+            ret = -1;
+        }
+    }
+
+    remove(inparam);
+    remove(outparam);
+    remove(outbin);
+
+    return ret;
+}
+
+static int extract(const char* parampath, const char* binpath, const ncnn::Mat& a, const ncnn::Mat& b, ncnn::Mat& out)
+{
+    ncnn::Net net;
+    if (net.load_param(parampath) != 0)
+        return -1;
+
+    if (net.load_model(binpath) != 0)
+        return -1;
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("a", a);
+    ex.input("b", b);
+    return ex.extract("out", out);
+}
+
+// the 2d transpose of MatMul B folds into transB, permute on 1d B is noop and stays as is
+static int test_ncnnoptimize_permute_matmul(const ncnn::Mat& a, const ncnn::Mat& b, bool fused)
+{
+    const char* inparam = "test_ncnnoptimize_permute_matmul.param";
+    const char* outparam = "test_ncnnoptimize_permute_matmul-opt.param";
+    const char* outbin = "test_ncnnoptimize_permute_matmul-opt.bin";
+
+    char param[256];
+    sprintf(param, "7767517\n4 4\n"
+            "Input a 0 1 a 0=%d 1=%d\n"
+            "Input b 0 1 b 0=%d 1=%d\n"
+            "Permute bt 1 1 b bt 0=1\n"
+            "MatMul mm 2 1 a bt out\n",
+            a.w, a.h, b.w, b.dims == 2 ? b.h : 0);
+
+    char shape_arg[64];
+    if (b.dims == 2)
+        sprintf(shape_arg, "\"shape=[%d,%d],[%d,%d]\"", a.w, a.h, b.w, b.h);
+    else
+        sprintf(shape_arg, "\"shape=[%d,%d],[%d]\"", a.w, a.h, b.w);
+
+    if (write_file(inparam, param) != 0)
+        return -1;
+
+    int ret = 0;
+
+    if (run_ncnnoptimize(inparam, outparam, outbin, shape_arg) != 0)
+    {
+        fprintf(stderr, "test_ncnnoptimize_permute_matmul ncnnoptimize failed\n");
+        ret = -1;
+    }
+
+    if (ret == 0 && file_contains(outparam, "Permute") == fused)
+    {
+        fprintf(stderr, "test_ncnnoptimize_permute_matmul failed b.dims=%d expect fused=%d\n", b.dims, (int)fused);
+        ret = -1;
+    }
+
+    ncnn::Mat out_ref;
+    {
+        // no weights to read
+        ncnn::Net net;
+        net.load_param_mem(param);
+        net.load_model((const unsigned char*)param);
+
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("a", a);
+        ex.input("b", b);
+        ex.extract("out", out_ref);
+    }
+
+    ncnn::Mat out;
+    if (ret == 0 && extract(outparam, outbin, a, b, out) != 0)
+    {
+        fprintf(stderr, "test_ncnnoptimize_permute_matmul extract failed b.dims=%d\n", b.dims);
+        ret = -1;
+    }
+
+    if (ret == 0 && CompareMat(out_ref, out, 0.001) != 0)
+    {
+        fprintf(stderr, "test_ncnnoptimize_permute_matmul failed b.dims=%d\n", b.dims);
+        ret = -1;
+    }
+
+    remove(inparam);
+    remove(outparam);
+    remove(outbin);
+
+    return ret;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_ncnnoptimize_dynamic_shape()
+           || test_ncnnoptimize_permute_matmul(RandomMat(4, 3), RandomMat(5, 4), true)
+           || test_ncnnoptimize_permute_matmul(RandomMat(4, 3), RandomMat(4), false);
+}
@@ -0,0 +1,195 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "nms.h"
+#include "testutil.h"
+
+static void topk_naive(const float* scores, int n, int k, std::vector<int>& indices)
+{
+    indices.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        indices[i] = i;
+    }
+
+    // selection sort, equal scores keep the lower index first
+    for (int i = 0; i < n; i++)
+    {
+        int best = i;
+        for (int j = i + 1; j < n; j++)
+        {
+            const float sj = scores[indices[j]];
+            const float sb = scores[indices[best]];
+            if (sj > sb || (sj == sb && indices[j] < indices[best]))
+                best = j;
+        }
+
+        std::swap(indices[i], indices[best]);
+    }
+
+    if (k >= 0 && k < n)
+        indices.resize(k);
+}
+
+static void nms_naive(const float* boxes, const int* order, int n, float iou_threshold, std::vector<int>& kept, int max_keep)
+{
+    kept.clear();
+
+    for (int i = 0; i < n; i++)
+    {
+        const float* a = boxes + order[i] * 4;
+
+        bool keep = true;
+        for (size_t j = 0; j < kept.size(); j++)
+        {
+            const float* b = boxes + kept[j] * 4;
+
+            float iw = std::min(a[2], b[2]) - std::max(a[0], b[0]);
+            float ih = std::min(a[3], b[3]) - std::max(a[1], b[1]);
+            float inter = iw > 0.f && ih > 0.f ? iw * ih : 0.f;
+            float union_area = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter;
+            if (inter > iou_threshold * union_area)
+            {
+                keep = false;
+                break;
+            }
+        }
+
+        if (keep)
+        {
+            kept.push_back(order[i]);
+            if (max_keep > 0 && (int)kept.size() >= max_keep)
+                break;
+        }
+    }
+}
+
+static int compare_indices(const std::vector<int>& a, const std::vector<int>& b)
+{
+    if (a.size() != b.size())
+    {
+        fprintf(stderr, "size not match expect %d but got %d\n", (int)a.size(), (int)b.size());
+        return -1;
+    }
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i] != b[i])
+        {
+            fprintf(stderr, "value not match at %d expect %d but got %d\n", (int)i, a[i], b[i]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_topk(int n, int k, int distinct)
+{
+    // few distinct values exercise the tie break
+    std::vector<float> scores(n);
+    for (int i = 0; i < n; i++)
+    {
+        scores[i] = (float)RandomInt(0, distinct - 1);
+    }
+
+    std::vector<int> ref;
+    topk_naive(&scores[0], n, k, ref);
+
+    std::vector<int> out;
+    ncnn::topk_descent(&scores[0], n, k, out);
+
+    if (compare_indices(ref, out) != 0)
+    {
+        fprintf(stderr, "test_topk failed n=%d k=%d distinct=%d\n", n, k, distinct);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_nms(int n, float extent, float iou_threshold, int max_keep)
+{
+    // boxes of size around 1 scattered in extent, smaller extent gives denser overlap
+    std::vector<float> boxes(n * 4);
+    std::vector<float> scores(n);
+    for (int i = 0; i < n; i++)
+    {
+        float cx = RandomFloat(0.f, extent);
+        float cy = RandomFloat(0.f, extent);
+        float bw = RandomFloat(0.5f, 1.5f);
+        float bh = RandomFloat(0.5f, 1.5f);
+
+        boxes[i * 4] = cx - bw * 0.5f;
+        boxes[i * 4 + 1] = cy - bh * 0.5f;
+        boxes[i * 4 + 2] = cx + bw * 0.5f;
+        boxes[i * 4 + 3] = cy + bh * 0.5f;
+        scores[i] = RandomFloat(0.f, 1.f);
+    }
+
+    std::vector<int> order;
+    ncnn::topk_descent(&scores[0], n, -1, order);
+
+    std::vector<int> ref;
+    nms_naive(&boxes[0], &order[0], n, iou_threshold, ref, max_keep);
+
+    std::vector<int> out;
+    ncnn::nms_sorted_bboxes(&boxes[0], &order[0], n, iou_threshold, out, max_keep);
+
+    if (compare_indices(ref, out) != 0)
+    {
+        fprintf(stderr, "test_nms failed n=%d extent=%f iou_threshold=%f max_keep=%d\n", n, extent, iou_threshold, max_keep);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_topk_0()
+{
+    return 0
+           || test_topk(1, -1, 10)
+           || test_topk(5, 3, 10)
+           || test_topk(17, -1, 1000)
+           || test_topk(17, 0, 1000)
+           || test_topk(64, 10, 1000)
+           || test_topk(100, 100, 3)
+           || test_topk(300, 7, 3)
+           || test_topk(1000, 300, 100000)
+           || test_topk(2000, 1, 2)
+           || test_topk(4000, 1000, 20);
+}
+
+static int test_nms_0()
+{
+    return 0
+           || test_nms(1, 10.f, 0.45f, -1)
+           || test_nms(7, 2.f, 0.45f, -1)
+           || test_nms(8, 2.f, 0.3f, -1)
+           || test_nms(33, 4.f, 0.5f, -1)
+           || test_nms(100, 5.f, 0.7f, -1)
+           || test_nms(257, 3.f, 0.45f, -1)
+           || test_nms(1000, 20.f, 0.45f, -1)
+           || test_nms(1000, 20.f, 0.45f, 50)
+           || test_nms(2000, 8.f, 0.1f, 10);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_topk_0()
+           || test_nms_0();
+}
@@ -46,6 +46,7 @@ static int test_permute_1()
     ncnn::Mat b = RandomMat(8, 15);
     ncnn::Mat c = RandomMat(11, 16);
     ncnn::Mat d = RandomMat(7, 9);
+    ncnn::Mat e = RandomMat(67, 45);
 
     for (int order_type = 0; order_type < 2; order_type++)
     {
@@ -53,7 +54,8 @@ static int test_permute_1()
                   || test_permute(a, order_type)
                   || test_permute(b, order_type)
                   || test_permute(c, order_type)
-                  || test_permute(d, order_type);
+                  || test_permute(d, order_type)
+                  || test_permute(e, order_type);
 
         if (ret != 0)
             return -1;
@@ -70,6 +72,7 @@ static int test_permute_2()
     ncnn::Mat d = RandomMat(4, 4, 13);
     ncnn::Mat e = RandomMat(1, 2, 7);
     ncnn::Mat f = RandomMat(8, 5, 6);
+    ncnn::Mat g = RandomMat(40, 35, 9);
 
     for (int order_type = 0; order_type < 6; order_type++)
     {
@@ -79,7 +82,8 @@ static int test_permute_2()
                   || test_permute(c, order_type)
                   || test_permute(d, order_type)
                   || test_permute(e, order_type)
-                  || test_permute(f, order_type);
+                  || test_permute(f, order_type)
+                  || test_permute(g, order_type);
 
         if (ret != 0)
             return -1;
@@ -96,6 +100,7 @@ static int test_permute_3()
     ncnn::Mat d = RandomMat(4, 4, 4, 13);
     ncnn::Mat e = RandomMat(1, 2, 3, 7);
     ncnn::Mat f = RandomMat(8, 6, 5, 6);
+    ncnn::Mat g = RandomMat(36, 9, 5, 34);
 
     for (int order_type = 0; order_type < 24; order_type++)
     {
@@ -105,7 +110,8 @@ static int test_permute_3()
                   || test_permute(c, order_type)
                   || test_permute(d, order_type)
                   || test_permute(e, order_type)
-                  || test_permute(f, order_type);
+                  || test_permute(f, order_type)
+                  || test_permute(g, order_type);
 
         if (ret != 0)
             return -1;
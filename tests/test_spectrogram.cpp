@@ -50,9 +50,20 @@ static int test_spectrogram_0()
            || test_spectrogram(124, 55, 2, 12, 55, 1, 1, 2, 2, 0);
 }
 
+static int test_spectrogram_1()
+{
+    return 0
+           || test_spectrogram(1000, 512, 2, 128, 512, 1, 1, 2, 0, 1)
+           || test_spectrogram(800, 400, 0, 160, 400, 1, 1, 0, 1, 1)
+           || test_spectrogram(700, 256, 1, 64, 200, 2, 0, 0, 2, 0)
+           || test_spectrogram(300, 96, 0, 24, 96, 1, 1, 1, 0, 0);
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_spectrogram_0();
+    return 0
+           || test_spectrogram_0()
+           || test_spectrogram_1();
 }
@@ -211,6 +211,13 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
         squeezenet.load_param((const unsigned char*)param_data);
         squeezenet.load_model((const unsigned char*)model_data);
     }
+    if (load_model_type == 4)
+    {
+        // load from mapped model file
+        squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+        if (squeezenet.load_model_mmap(MODEL_DIR "/squeezenet_v1.1.bin") != 0)
+            return -1;
+    }
 
     ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
 
@@ -220,7 +227,7 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
     ncnn::Extractor ex = squeezenet.create_extractor();
 
     ncnn::Mat out;
-    if (load_model_type == 0 || load_model_type == 1)
+    if (load_model_type == 0 || load_model_type == 1 || load_model_type == 4)
     {
         ex.input("data", in);
         ex.extract("prob", out);
@@ -241,6 +248,230 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
     return check_top2(cls_scores, epsilon);
 }
 
+static int test_squeezenet_memory_plan(const ncnn::Option& opt, float epsilon = 0.001)
+{
+    ncnn::Net squeezenet;
+
+    squeezenet.opt = opt;
+    squeezenet.opt.use_memory_plan = true;
+
+    squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+    squeezenet.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+    ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
+
+    const float mean_vals[3] = {104.f, 117.f, 123.f};
+    in.substract_mean_normalize(mean_vals, 0);
+
+    // record, replay and replay again
+    for (int i = 0; i < 3; i++)
+    {
+        ncnn::Extractor ex = squeezenet.create_extractor();
+
+        ncnn::Mat out;
+        ex.input("data", in);
+        ex.extract("prob", out);
+
+        std::vector<float> cls_scores;
+        cls_scores.resize(out.w);
+        for (int j = 0; j < out.w; j++)
+        {
+            cls_scores[j] = out[j];
+        }
+
+        int ret = check_top2(cls_scores, epsilon);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int test_squeezenet_profiling(const ncnn::Option& opt, float epsilon = 0.001)
+{
+    ncnn::Net squeezenet;
+
+    squeezenet.opt = opt;
+
+    squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+    squeezenet.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+    ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
+
+    const float mean_vals[3] = {104.f, 117.f, 123.f};
+    in.substract_mean_normalize(mean_vals, 0);
+
+    ncnn::Extractor ex = squeezenet.create_extractor();
+    ex.set_profiling(true);
+
+    ncnn::Mat out;
+    ex.input("data", in);
+    ex.extract("prob", out);
+
+    std::vector<float> cls_scores;
+    cls_scores.resize(out.w);
+    for (int j = 0; j < out.w; j++)
+    {
+        cls_scores[j] = out[j];
+    }
+
+    int ret = check_top2(cls_scores, epsilon);
+    if (ret != 0)
+        return ret;
+
+    // every layer except input is recorded once
+    const std::vector<ncnn::LayerProfile>& profiles = ex.layer_profiles();
+    if (profiles.size() + 1 != squeezenet.layers().size())
+    {
+        fprintf(stderr, "profiled %d layers, expect %d\n", (int)profiles.size(), (int)squeezenet.layers().size() - 1);
+        return -1;
+    }
+
+    for (size_t i = 0; i < profiles.size(); i++)
+    {
+        const ncnn::LayerProfile& profile = profiles[i];
+        if (profile.end < profile.start || profile.num_threads != opt.num_threads || profile.top_shapes.empty() || profile.top_shapes[0].dims == 0)
+        {
+            fprintf(stderr, "bad profile of layer %d\n", profile.layer_index);
+            return -1;
+        }
+    }
+
+#if NCNN_STDIO
+    if (ex.save_chrome_trace("test_squeezenet_profiling.json") != 0)
+        return -1;
+#endif
+
+    return 0;
+}
+
+#if NCNN_STDIO
+static int test_squeezenet_weight_cache(const ncnn::Option& opt, float epsilon = 0.001)
+{
+    const char* cachepath = "test_squeezenet_weight_cache.bin";
+    remove(cachepath);
+
+    // first load writes the cache, second and third restore from it
+    for (int i = 0; i < 3; i++)
+    {
+        ncnn::Net squeezenet;
+
+        squeezenet.opt = opt;
+        squeezenet.opt.lightmode = i != 2;
+        squeezenet.set_weight_cache(cachepath);
+
+        squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+        squeezenet.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+        FILE* fp = fopen(cachepath, "rb");
+        if (!fp)
+        {
+            fprintf(stderr, "weight cache %s not written\n", cachepath);
+            return -1;
+        }
+        fclose(fp);
+
+        ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
+
+        const float mean_vals[3] = {104.f, 117.f, 123.f};
+        in.substract_mean_normalize(mean_vals, 0);
+
+        ncnn::Extractor ex = squeezenet.create_extractor();
+
+        ncnn::Mat out;
+        ex.input("data", in);
+        ex.extract("prob", out);
+
+        std::vector<float> cls_scores;
+        cls_scores.resize(out.w);
+        for (int j = 0; j < out.w; j++)
+        {
+            cls_scores[j] = out[j];
+        }
+
+        int ret = check_top2(cls_scores, epsilon);
+        if (ret != 0)
+            return ret;
+    }
+
+    remove(cachepath);
+
+    return 0;
+}
+#endif // NCNN_STDIO
+
+static int test_squeezenet_batch(const ncnn::Option& opt, int batch, float epsilon = 0.001)
+{
+    ncnn::Net squeezenet;
+
+    squeezenet.opt = opt;
+
+    squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+    squeezenet.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+    ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
+
+    const float mean_vals[3] = {104.f, 117.f, 123.f};
+    in.substract_mean_normalize(mean_vals, 0);
+
+    // distinct samples, so that mixing them up in stacked passes shows
+    std::vector<ncnn::Mat> ins(batch);
+    for (int i = 0; i < batch; i++)
+    {
+        ins[i] = in.clone();
+        if (i == 0)
+            continue;
+
+        ncnn::Mat noise = RandomMat(227, 227, 3, -20.f * i, 20.f * i);
+        for (int j = 0; j < (int)ins[i].total(); j++)
+        {
+            ins[i][j] += noise[j];
+        }
+    }
+
+    ncnn::Extractor ex = squeezenet.create_extractor();
+
+    // compare the logits, the probabilities of random classes are all tiny
+    std::vector<ncnn::Mat> logits;
+    std::vector<ncnn::Mat> outs;
+    ex.input_batch("data", ins);
+    int ret = ex.extract_batch("pool10", logits);
+    if (ret != 0 || (int)logits.size() != batch)
+        return -1;
+
+    ret = ex.extract_batch("prob", outs);
+    if (ret != 0 || (int)outs.size() != batch)
+        return -1;
+
+    for (int i = 0; i < batch; i++)
+    {
+        ncnn::Mat ref;
+        {
+            ncnn::Extractor ex1 = squeezenet.create_extractor();
+            ex1.input("data", ins[i]);
+            ret = ex1.extract("pool10", ref);
+            if (ret != 0)
+                return ret;
+        }
+
+        if (CompareMat(ref, logits[i], 0.001) != 0)
+        {
+            fprintf(stderr, "test_squeezenet_batch sample %d not match\n", i);
+            return -1;
+        }
+    }
+
+    // the unperturbed sample still classifies the logo
+    std::vector<float> cls_scores;
+    cls_scores.resize(outs[0].w);
+    for (int j = 0; j < outs[0].w; j++)
+    {
+        cls_scores[j] = outs[0][j];
+    }
+
+    return check_top2(cls_scores, epsilon);
+}
+
 class MyConvolution : public ncnn::Layer
 {
 public:
@@ -514,5 +745,102 @@ int main()
 #endif // NCNN_VULKAN
     }
 
+#if NCNN_STDIO && (defined _WIN32 || defined __unix__ || defined __APPLE__)
+    // weight data referenced from file mapping
+    {
+        ncnn::Option opt;
+        opt.num_threads = 1;
+        opt.use_vulkan_compute = false;
+
+        int ret = test_squeezenet(opt, 4, 0.1);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet cpu failed load_model_mmap\n");
+            return ret;
+        }
+    }
+#endif
+
+    // intermediate blobs placed in planned arena
+    {
+        ncnn::Option opt;
+        opt.num_threads = 1;
+        opt.use_vulkan_compute = false;
+
+        int ret = test_squeezenet_memory_plan(opt, 0.1);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet cpu failed use_memory_plan=1\n");
+            return ret;
+        }
+    }
+
+    // per-layer runtime profiling
+    {
+        ncnn::Option opt;
+        opt.num_threads = 1;
+        opt.use_vulkan_compute = false;
+
+        int ret = test_squeezenet_profiling(opt, 0.1);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet cpu failed profiling\n");
+            return ret;
+        }
+    }
+
+#if NCNN_STDIO
+    // transformed weights restored from cache file
+    {
+        ncnn::Option opt;
+        opt.num_threads = 1;
+        opt.use_vulkan_compute = false;
+
+        int ret = test_squeezenet_weight_cache(opt, 0.1);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet cpu failed weight cache\n");
+            return ret;
+        }
+    }
+#endif // NCNN_STDIO
+
+    // samples stacked through 1x1 convolution
+    {
+        ncnn::Option opt;
+        opt.num_threads = 1;
+        opt.use_vulkan_compute = false;
+
+        int ret = test_squeezenet_batch(opt, 4, 0.1);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet cpu failed extract_batch\n");
+            return ret;
+        }
+    }
+
+    // inter-layer parallel inference over the fire module branches
+    {
+        ncnn::Option opt;
+        opt.num_threads = 4;
+        opt.use_parallel_graph = true;
+        opt.use_vulkan_compute = false;
+
+        int ret = test_squeezenet(opt, 0, 0.1);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet cpu failed use_parallel_graph=%d\n", opt.use_parallel_graph);
+            return ret;
+        }
+
+        opt.lightmode = false;
+        ret = test_squeezenet(opt, 2, 0.1);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet cpu failed use_parallel_graph=%d lightmode=%d\n", opt.use_parallel_graph, opt.lightmode);
+            return ret;
+        }
+    }
+
     return 0;
 }
@@ -0,0 +1,241 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2025 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "testutil.h"
+#include "threadpool.h"
+
+#include <string.h>
+
+static void record_thread_num(int thread_num, int num_threads, void* userdata)
+{
+    int* counts = (int*)userdata;
+    if (thread_num >= 0 && thread_num < num_threads)
+        counts[thread_num]++;
+}
+
+static int test_threadpool_run(int num_threads)
+{
+    ncnn::ThreadPool pool(ncnn::get_cpu_thread_affinity_mask(0), num_threads);
+
+    if (pool.num_threads() != num_threads)
+    {
+        fprintf(stderr, "test_threadpool_run expect %d threads but got %d\n", num_threads, pool.num_threads());
+        return -1;
+    }
+
+    for (int r = 0; r < 100; r++)
+    {
+        // fewer, equal and more threads than the pool
+        const int team_size = 1 + r % (num_threads + 2);
+
+        int counts[16];
+        memset(counts, 0, sizeof(counts));
+
+        pool.run(team_size, record_thread_num, counts);
+
+        for (int i = 0; i < team_size; i++)
+        {
+            if (counts[i] != 1)
+            {
+                fprintf(stderr, "test_threadpool_run failed num_threads=%d team_size=%d thread %d ran %d times\n", num_threads, team_size, i, counts[i]);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void record_index(int i, void* userdata)
+{
+    int* counts = (int*)userdata;
+    counts[i]++;
+}
+
+static int test_threadpool_parallel_for(int num_threads, int n)
+{
+    ncnn::ThreadPool pool(ncnn::get_cpu_thread_affinity_mask(0), num_threads);
+
+    std::vector<int> counts(n, 0);
+
+    for (int r = 0; r < 10; r++)
+    {
+        pool.parallel_for(n, record_index, &counts[0]);
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        if (counts[i] != 10)
+        {
+            fprintf(stderr, "test_threadpool_parallel_for failed num_threads=%d n=%d index %d ran %d times\n", num_threads, n, i, counts[i]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_threadpool_numa()
+{
+    const int node_count = ncnn::get_numa_node_count();
+    if (node_count < 1)
+    {
+        fprintf(stderr, "test_threadpool_numa expect at least one node but got %d\n", node_count);
+        return -1;
+    }
+
+    for (int i = 0; i < node_count; i++)
+    {
+        if (ncnn::get_numa_node_affinity_mask(i).num_enabled() < 1)
+        {
+            fprintf(stderr, "test_threadpool_numa node %d has no cpu\n", i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_threadpool_restore_affinity(int num_threads)
+{
+    ncnn::CpuSet affinity_before;
+    if (ncnn::get_current_thread_affinity(affinity_before) != 0)
+    {
+        // no affinity capability
+        return 0;
+    }
+
+    // a pool on the first allowed cpu only
+    ncnn::CpuSet island;
+    for (int i = 0; i < ncnn::get_cpu_count(); i++)
+    {
+        if (affinity_before.is_enabled(i))
+        {
+            island.enable(i);
+            break;
+        }
+    }
+
+    ncnn::ThreadPool pool(island, num_threads);
+
+    for (int r = 0; r < 2; r++)
+    {
+        ncnn::set_current_thread_pool(&pool);
+        ncnn::set_current_thread_pool(0);
+
+        ncnn::CpuSet affinity_after;
+        ncnn::get_current_thread_affinity(affinity_after);
+
+        for (int i = 0; i < ncnn::get_cpu_count(); i++)
+        {
+            if (affinity_before.is_enabled(i) != affinity_after.is_enabled(i))
+            {
+                fprintf(stderr, "test_threadpool_restore_affinity failed num_threads=%d cpu %d not restored\n", num_threads, i);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// append one float32 weight blob in model bin layout
+static void append_weight(std::vector<unsigned int>& model, const ncnn::Mat& m, bool flag)
+{
+    if (flag)
+        model.push_back(0); // float32 flag
+
+    const size_t offset = model.size();
+    model.resize(offset + m.total());
+    memcpy(&model[offset], (const float*)m, m.total() * sizeof(float));
+}
+
+static int test_threadpool_extractor(int num_threads)
+{
+    std::vector<unsigned int> model;
+    append_weight(model, RandomMat(16 * 8 * 3 * 3), true);
+    append_weight(model, RandomMat(16), false);
+
+    const char param[] = "7767517\n3 3\n"
+                         "Input in 0 1 in\n"
+                         "Convolution conv 1 1 in conv 0=16 1=3 4=1 5=1 6=1152\n"
+                         "ReLU relu 1 1 conv out\n";
+
+    ncnn::Net net;
+    net.opt.num_threads = num_threads;
+    net.opt.use_packing_layout = false;
+
+    if (net.load_param_mem(param) != 0)
+    {
+        fprintf(stderr, "test_threadpool_extractor load_param_mem failed\n");
+        return -1;
+    }
+
+    net.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Mat in = RandomMat(31, 23, 8);
+
+    ncnn::Mat out_ref;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in", in);
+        ex.extract("out", out_ref);
+    }
+
+    ncnn::ThreadPool pool(ncnn::get_cpu_thread_affinity_mask(0), num_threads);
+
+    for (int r = 0; r < 3; r++)
+    {
+        ncnn::Mat out;
+        {
+            ncnn::Extractor ex = net.create_extractor();
+            ex.set_thread_pool(&pool);
+            ex.input("in", in);
+            ex.extract("out", out);
+        }
+
+        if (ncnn::get_current_thread_pool() != 0)
+        {
+            fprintf(stderr, "test_threadpool_extractor current thread pool not restored\n");
+            return -1;
+        }
+
+        if (CompareMat(out_ref, out, 0.001) != 0)
+        {
+            fprintf(stderr, "test_threadpool_extractor failed num_threads=%d\n", num_threads);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_threadpool_run(1)
+           || test_threadpool_run(4)
+           || test_threadpool_parallel_for(1, 5)
+           || test_threadpool_parallel_for(4, 3)
+           || test_threadpool_parallel_for(4, 1000)
+           || test_threadpool_parallel_for(3, 10007)
+           || test_threadpool_numa()
+           || test_threadpool_restore_affinity(1)
+           || test_threadpool_restore_affinity(4)
+           || test_threadpool_extractor(1)
+           || test_threadpool_extractor(4);
+}
@@ -356,6 +356,7 @@ int ModelWriter::shape_inference()
 
         int w = input->w;
         int h = input->h;
+        int d = input->d;
         int c = input->c;
 
         int dims = 0;
@@ -363,6 +364,7 @@ int ModelWriter::shape_inference()
         if (w != 0 && h == 0 && c == 0) dims = 1;
         if (w != 0 && h != 0 && c == 0) dims = 2;
         if (w != 0 && h != 0 && c != 0) dims = 3;
+        if (w != 0 && h != 0 && d != 0 && c != 0) dims = 4;
 
         if (dims == 0)
         {
@@ -374,6 +376,7 @@ int ModelWriter::shape_inference()
         if (dims == 1) m.create(w);
         if (dims == 2) m.create(w, h);
         if (dims == 3) m.create(w, h, c);
+        if (dims == 4) m.create(w, h, d, c);
 
         ex.input(layer->tops[0], m);
     }
@@ -386,6 +389,7 @@ int ModelWriter::shape_inference()
         int dims = blob.shape.dims;
         int w = blob.shape.w;
         int h = blob.shape.h;
+        int d = blob.shape.d;
         int c = blob.shape.c;
 
         if (dims == 0)
@@ -395,6 +399,7 @@ int ModelWriter::shape_inference()
         if (dims == 1) m.create(w);
         if (dims == 2) m.create(w, h);
         if (dims == 3) m.create(w, h, c);
+        if (dims == 4) m.create(w, h, d, c);
 
         m.fill(0.f);
 
@@ -483,6 +488,7 @@ int ModelWriter::estimate_memory_footprint()
 
         int w = input->w;
         int h = input->h;
+        int d = input->d;
         int c = input->c;
 
         int dims = 0;
@@ -490,6 +496,7 @@ int ModelWriter::estimate_memory_footprint()
         if (w != 0 && h == 0 && c == 0) dims = 1;
         if (w != 0 && h != 0 && c == 0) dims = 2;
         if (w != 0 && h != 0 && c != 0) dims = 3;
+        if (w != 0 && h != 0 && d != 0 && c != 0) dims = 4;
 
         if (dims == 0)
         {
@@ -501,6 +508,7 @@ int ModelWriter::estimate_memory_footprint()
         if (dims == 1) m.create(w, 4u, &allocator);
         if (dims == 2) m.create(w, h, 4u, &allocator);
         if (dims == 3) m.create(w, h, c, 4u, &allocator);
+        if (dims == 4) m.create(w, h, d, c, 4u, &allocator);
 
         ex.input(layer->tops[0], m);
 
@@ -614,6 +622,30 @@ static void Randomize(ncnn::Mat& m, float a = -1.2f, float b = 1.2f)
     }
 }
 
+#if NCNN_INT8
+// restore float weight for int8_dynamic_quantize, which quantizes weight at load time
+static ncnn::Mat dequantize_weight_int8(const ncnn::Mat& weight_data, const ncnn::Mat& weight_data_int8_scales)
+{
+    const int num_output = weight_data_int8_scales.w;
+    const int size = (int)(weight_data.total() / num_output);
+
+    ncnn::Mat m(size * num_output);
+    for (int p = 0; p < num_output; p++)
+    {
+        const signed char* ptr = (const signed char*)weight_data + size * p;
+        float* outptr = (float*)m + size * p;
+
+        const float scale = weight_data_int8_scales[p];
+        for (int i = 0; i < size; i++)
+        {
+            outptr[i] = scale == 0.f ? 0.f : ptr[i] / scale;
+        }
+    }
+
+    return m;
+}
+#endif // NCNN_INT8
+
 int ModelWriter::fwrite_weight_tag_data(const ncnn::Mat& data, FILE* bp, float a, float b)
 {
     int p0 = ftell(bp);
@@ -668,6 +700,10 @@ int ModelWriter::fwrite_weight_tag_data(const ncnn::Mat& data, FILE* bp, float a
 
 int ModelWriter::fwrite_weight_data(const ncnn::Mat& data, FILE* bp, float a, float b)
 {
+    // nothing to write, eg. the gamma and beta of a LayerNorm without affine
+    if (data.empty())
+        return 0;
+
     int p0 = ftell(bp);
 
     ncnn::Mat data_flattened = data.reshape(data.w * data.h * data.d * data.c);
@@ -897,10 +933,16 @@ int ModelWriter::save(const char* parampath, const char* binpath)
                 if (!op->activation_params.empty()) fprintf_param_float_array(10, op->activation_params, pp);
             }
             fprintf_param_value(" 19=%d", dynamic_weight)
+            fprintf_param_value(" 20=%d", int8_dynamic_quantize)
 
             if (op->dynamic_weight == 0)
             {
-                fwrite_weight_tag_data(op->weight_data, bp);
+#if NCNN_INT8
+                if (op->int8_dynamic_quantize && !op->int8_scale_term && op->weight_data.elemsize == 1)
+                    fwrite_weight_tag_data(dequantize_weight_int8(op->weight_data, op->weight_data_int8_scales), bp);
+                else
+#endif // NCNN_INT8
+                    fwrite_weight_tag_data(op->weight_data, bp);
                 fwrite_weight_data(op->bias_data, bp);
 
 #if NCNN_INT8
@@ -1782,6 +1824,10 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             fprintf_param_value(" 12=%d", output_elempack)
             fprintf_param_value(" 13=%d", output_elemtype)
             fprintf_param_value(" 14=%d", output_transpose)
+            fprintf_param_value(" 15=%d", activation_type)
+            {
+                if (!op->activation_params.empty()) fprintf_param_float_array(16, op->activation_params, pp);
+            }
             fprintf_param_value(" 18=%d", int8_scale_term)
             fprintf_param_value(" 20=%d", constant_TILE_M)
             fprintf_param_value(" 21=%d", constant_TILE_N)
@@ -1899,8 +1945,16 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             {
                 if (!op->activation_params.empty()) fprintf_param_float_array(10, op->activation_params, pp);
             }
+            fprintf_param_value(" 20=%d", int8_dynamic_quantize)
+            fprintf_param_value(" 21=%d", weight_quant_bits)
+            fprintf_param_value(" 22=%d", weight_quant_group_size)
 
-            fwrite_weight_tag_data(op->weight_data, bp);
+#if NCNN_INT8
+            if (op->int8_dynamic_quantize && !op->int8_scale_term && op->weight_data.elemsize == 1)
+                fwrite_weight_tag_data(dequantize_weight_int8(op->weight_data, op->weight_data_int8_scales), bp);
+            else
+#endif // NCNN_INT8
+                fwrite_weight_tag_data(op->weight_data, bp);
             fwrite_weight_data(op->bias_data, bp);
 
 #if NCNN_INT8
@@ -1912,6 +1966,11 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             }
 #endif // NCNN_INT8
 
+            if (op->weight_quant_bits)
+            {
+                fwrite_weight_data(op->weight_data_group_scales, bp, 0.001, 0.02);
+            }
+
             if (shape_ready)
             {
                 int inw = blobs[layer->bottoms[0]].shape.w;
@@ -1930,6 +1989,7 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             fprintf_param_value(" 0=%d", w)
             fprintf_param_value(" 1=%d", h)
             fprintf_param_value(" 2=%d", c)
+            fprintf_param_value(" 11=%d", d)
         }
         else if (layer->type == "InstanceNorm")
         {
@@ -28,6 +28,7 @@
 #include "net.h"
 
 // ncnn private header
+#include "expression.h"
 #include "modelwriter.h"
 
 class DataReaderFromEmpty : public ncnn::DataReader
@@ -64,11 +65,19 @@ public:
     int fuse_innerproduct_batchnorm();
     int fuse_innerproduct_add();
     int fuse_innerproduct_dropout();
+    int fuse_layernorm_innerproduct();
+    int fuse_layernorm_gemm();
+    int fuse_innerproduct_qkv();
+    int fuse_gemm_add();
+    int fuse_permute_gemm();
+    int fuse_gemm_permute();
+    int fuse_permute_matmul();
     int fuse_convolution_activation();
     int fuse_convolutiondepthwise_activation();
     int fuse_deconvolution_activation();
     int fuse_deconvolutiondepthwise_activation();
     int fuse_innerproduct_activation();
+    int fuse_gemm_activation();
     int fuse_memorydata_binaryop();
     int fuse_binaryop_eltwise();
 
@@ -86,6 +95,11 @@ public:
     int replace_prelu_with_leaky_relu();
     int replace_convolution_with_innerproduct_after_global_pooling();
     int replace_convolution_with_innerproduct_after_innerproduct();
+
+    int set_input_shapes(const std::vector<std::vector<int> >& shapes);
+    int fold_memorydata_subgraph();
+    int resolve_shape_expression();
+    int eliminate_noop_reshape_permute_crop();
 };
 
 NetOptimize::NetOptimize()
@@ -1276,21 +1290,21 @@ int NetOptimize::fuse_innerproduct_dropout()
     return 0;
 }
 
-int NetOptimize::fuse_convolution_activation()
+int NetOptimize::fuse_layernorm_innerproduct()
 {
     const size_t layer_count = layers.size();
     for (size_t i = 0; i < layer_count; i++)
     {
-        if (layers[i]->type != "Convolution")
+        if (layers[i]->type != "LayerNorm")
             continue;
 
-        // Convolution - Activation
+        // LayerNorm - InnerProduct
         int top_blob_index = layers[i]->tops[0];
 
         size_t j = i + 1;
         for (; j < layer_count; j++)
         {
-            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish" && layers[j]->type != "HardSwish")
+            if (layers[j]->type != "InnerProduct")
                 continue;
 
             if (layers[j]->bottoms.size() != 1)
@@ -1303,72 +1317,79 @@ int NetOptimize::fuse_convolution_activation()
         if (j == layer_count)
             continue;
 
-        // fuse Convolution - Activation to Convolution
-        ncnn::Convolution* convolution = (ncnn::Convolution*)layers[i];
-        ncnn::Layer* activation = layers[j];
+        // fuse LayerNorm affine - InnerProduct to InnerProduct
+        ncnn::LayerNorm* layernorm = (ncnn::LayerNorm*)layers[i];
+        ncnn::InnerProduct* innerproduct = (ncnn::InnerProduct*)layers[j];
 
-        fprintf(stderr, "fuse_convolution_activation %s %s\n", convolution->name.c_str(), activation->name.c_str());
+        if (layernorm->affine == 0)
+            continue;
 
-        if (activation->type == "ReLU")
-        {
-            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+        if (innerproduct->int8_scale_term || innerproduct->int8_dynamic_quantize || innerproduct->weight_quant_bits || innerproduct->weight_data.elemsize != 4)
+            continue;
 
-            if (relu->slope == 0.f)
+        const int num_output = innerproduct->num_output;
+        const int num_input = innerproduct->weight_data_size / num_output;
+        const int affine_size = layernorm->affine_size;
+
+        // the flattened input k is scaled by gamma[k % affine_size]
+        if (num_input % affine_size != 0)
+            continue;
+
+        fprintf(stderr, "fuse_layernorm_innerproduct %s %s\n", layernorm->name.c_str(), innerproduct->name.c_str());
+
+        {
+            if (innerproduct->bias_term == 0)
             {
-                convolution->activation_type = 1;
+                // init bias as zero
+                innerproduct->bias_term = 1;
+                innerproduct->bias_data = ncnn::Mat(num_output);
+                innerproduct->bias_data.fill(0.f);
             }
-            else
+
+            const float* gamma = layernorm->gamma_data;
+            const float* beta = layernorm->beta_data;
+            float* weight = innerproduct->weight_data;
+            float* bias = innerproduct->bias_data;
+
+            // W * (x * gamma + beta) + b = (W * gamma) * x + (W * beta + b)
+            for (int p = 0; p < num_output; p++)
             {
-                convolution->activation_type = 2;
-                convolution->activation_params = ncnn::Mat(1);
-                convolution->activation_params[0] = relu->slope;
-            }
-        }
-        else if (activation->type == "Clip")
-        {
-            ncnn::Clip* clip = (ncnn::Clip*)activation;
+                float* w = weight + p * num_input;
 
-            convolution->activation_type = 3;
-            convolution->activation_params = ncnn::Mat(2);
-            convolution->activation_params[0] = clip->min;
-            convolution->activation_params[1] = clip->max;
-        }
-        else if (activation->type == "Sigmoid")
-        {
-            convolution->activation_type = 4;
-        }
-        else if (activation->type == "Mish")
-        {
-            convolution->activation_type = 5;
-        }
-        else if (activation->type == "HardSwish")
-        {
-            ncnn::HardSwish* hardswish = (ncnn::HardSwish*)activation;
+                double bias_sum = bias[p];
+                for (int k = 0; k < num_input; k++)
+                {
+                    bias_sum += w[k] * beta[k % affine_size];
+                    w[k] *= gamma[k % affine_size];
+                }
 
-            convolution->activation_type = 6;
-            convolution->activation_params = ncnn::Mat(2);
-            convolution->activation_params[0] = hardswish->alpha;
-            convolution->activation_params[1] = hardswish->beta;
+                bias[p] = (float)bias_sum;
+            }
         }
 
-        int top_blob_index_final = activation->tops[0];
-        convolution->tops[0] = top_blob_index_final;
-        blobs[top_blob_index_final].producer = i;
-        activation->type = "ncnnfused";
+        layernorm->affine = 0;
+        layernorm->gamma_data.release();
+        layernorm->beta_data.release();
     }
 
+    return 0;
+}
+
+int NetOptimize::fuse_layernorm_gemm()
+{
+    const size_t layer_count = layers.size();
     for (size_t i = 0; i < layer_count; i++)
     {
-        if (layers[i]->type != "Convolution1D")
+        if (layers[i]->type != "LayerNorm")
             continue;
 
-        // Convolution1D - Activation
+        // LayerNorm - Gemm
         int top_blob_index = layers[i]->tops[0];
 
         size_t j = i + 1;
         for (; j < layer_count; j++)
         {
-            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish")
+            if (layers[j]->type != "Gemm")
                 continue;
 
             if (layers[j]->bottoms.size() != 1)
@@ -1381,227 +1402,873 @@ int NetOptimize::fuse_convolution_activation()
         if (j == layer_count)
             continue;
 
-        // fuse Convolution1D - Activation to Convolution1D
-        ncnn::Convolution1D* convolution = (ncnn::Convolution1D*)layers[i];
-        ncnn::Layer* activation = layers[j];
+        // fuse LayerNorm affine - Gemm to Gemm
+        ncnn::LayerNorm* layernorm = (ncnn::LayerNorm*)layers[i];
+        ncnn::Gemm* gemm = (ncnn::Gemm*)layers[j];
 
-        fprintf(stderr, "fuse_convolution1d_activation %s %s\n", convolution->name.c_str(), activation->name.c_str());
+        if (layernorm->affine == 0)
+            continue;
 
-        if (activation->type == "ReLU")
-        {
-            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+        // the normalized rows are A with constant B
+        if (gemm->constantA || !gemm->constantB || gemm->transA || gemm->int8_scale_term || gemm->B_data.elemsize != 4)
+            continue;
 
-            if (relu->slope == 0.f)
-            {
-                convolution->activation_type = 1;
-            }
-            else
+        if (gemm->constantK != layernorm->affine_size)
+            continue;
+
+        // bias goes to a constant per-column C
+        if (gemm->constantC && gemm->constant_broadcast_type_C != 0 && gemm->constant_broadcast_type_C != 4)
+            continue;
+
+        if (gemm->beta == 0.f)
+            continue;
+
+        fprintf(stderr, "fuse_layernorm_gemm %s %s\n", layernorm->name.c_str(), gemm->name.c_str());
+
+        const int N = gemm->constantN;
+        const int K = gemm->constantK;
+
+        ncnn::Mat C_data(N);
+        if (gemm->constantC && gemm->constant_broadcast_type_C == 4)
+        {
+            const float* c = gemm->C_data;
+            for (int n = 0; n < N; n++)
             {
-                convolution->activation_type = 2;
-                convolution->activation_params = ncnn::Mat(1);
-                convolution->activation_params[0] = relu->slope;
+                C_data[n] = c[n];
             }
         }
-        else if (activation->type == "Clip")
-        {
-            ncnn::Clip* clip = (ncnn::Clip*)activation;
-
-            convolution->activation_type = 3;
-            convolution->activation_params = ncnn::Mat(2);
-            convolution->activation_params[0] = clip->min;
-            convolution->activation_params[1] = clip->max;
-        }
-        else if (activation->type == "Sigmoid")
+        else
         {
-            convolution->activation_type = 4;
+            C_data.fill(gemm->constantC ? gemm->C_data[0] : 0.f);
         }
-        else if (activation->type == "Mish")
+
         {
-            convolution->activation_type = 5;
+            const float* gamma = layernorm->gamma_data;
+            const float* beta = layernorm->beta_data;
+            float* B = gemm->B_data;
+
+            // (x * gamma + beta) * B + C = x * (gamma * B) + (beta * B + C)
+            for (int n = 0; n < N; n++)
+            {
+                double bias_sum = 0.0;
+                for (int k = 0; k < K; k++)
+                {
+                    float& b = gemm->transB ? B[n * K + k] : B[k * N + n];
+
+                    bias_sum += b * beta[k];
+                    b *= gamma[k];
+                }
+
+                // C is multiplied by beta at runtime
+                C_data[n] += (float)(bias_sum / gemm->beta);
+            }
         }
 
-        int top_blob_index_final = activation->tops[0];
-        convolution->tops[0] = top_blob_index_final;
-        blobs[top_blob_index_final].producer = i;
-        activation->type = "ncnnfused";
+        gemm->constantC = 1;
+        gemm->constant_broadcast_type_C = 4;
+        gemm->C_data = C_data;
+
+        layernorm->affine = 0;
+        layernorm->gamma_data.release();
+        layernorm->beta_data.release();
     }
 
     return 0;
 }
 
-int NetOptimize::fuse_convolutiondepthwise_activation()
+int NetOptimize::fuse_innerproduct_qkv()
 {
     const size_t layer_count = layers.size();
     for (size_t i = 0; i < layer_count; i++)
     {
-        if (layers[i]->type != "ConvolutionDepthWise")
+        if (layers[i]->type != "Split")
             continue;
 
-        // ConvolutionDepthWise - Activation
-        int top_blob_index = layers[i]->tops[0];
+        // Split - InnerProduct x N
+        ncnn::Layer* split = layers[i];
 
-        size_t j = i + 1;
-        for (; j < layer_count; j++)
+        std::vector<size_t> candidates;
+        for (size_t k = 0; k < split->tops.size(); k++)
         {
-            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish" && layers[j]->type != "HardSwish")
+            int consumer = blobs[split->tops[k]].consumer;
+            if (consumer == -1 || layers[consumer]->type != "InnerProduct")
                 continue;
 
-            if (layers[j]->bottoms.size() != 1)
+            ncnn::InnerProduct* innerproduct = (ncnn::InnerProduct*)layers[consumer];
+            if (innerproduct->int8_scale_term || innerproduct->int8_dynamic_quantize || innerproduct->weight_quant_bits || innerproduct->weight_data.elemsize != 4)
                 continue;
 
-            if (layers[j]->bottoms[0] == top_blob_index)
-                break;
+            candidates.push_back((size_t)consumer);
         }
 
-        if (j == layer_count)
+        if (candidates.size() < 2)
             continue;
 
-        // fuse ConvolutionDepthWise - Activation to ConvolutionDepthWise
-        ncnn::ConvolutionDepthWise* convolutiondepthwise = (ncnn::ConvolutionDepthWise*)layers[i];
-        ncnn::Layer* activation = layers[j];
+        std::sort(candidates.begin(), candidates.end());
 
-        fprintf(stderr, "fuse_convolutiondepthwise_activation %s %s\n", convolutiondepthwise->name.c_str(), activation->name.c_str());
+        // the projections share input size and activation
+        ncnn::InnerProduct* ip0 = (ncnn::InnerProduct*)layers[candidates[0]];
+        const int num_input = ip0->weight_data_size / ip0->num_output;
 
-        if (activation->type == "ReLU")
+        std::vector<ncnn::InnerProduct*> projections;
+        std::vector<size_t> projection_indexes;
+        for (size_t k = 0; k < candidates.size(); k++)
         {
-            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+            ncnn::InnerProduct* innerproduct = (ncnn::InnerProduct*)layers[candidates[k]];
+            if (innerproduct->weight_data_size / innerproduct->num_output != num_input)
+                continue;
 
-            if (relu->slope == 0.f)
-            {
-                convolutiondepthwise->activation_type = 1;
-            }
-            else
+            if (innerproduct->activation_type != ip0->activation_type)
+                continue;
+
+            bool same_activation_params = innerproduct->activation_params.w == ip0->activation_params.w;
+            for (int q = 0; same_activation_params && q < ip0->activation_params.w; q++)
             {
-                convolutiondepthwise->activation_type = 2;
-                convolutiondepthwise->activation_params = ncnn::Mat(1);
-                convolutiondepthwise->activation_params[0] = relu->slope;
+                same_activation_params = innerproduct->activation_params[q] == ip0->activation_params[q];
             }
-        }
-        else if (activation->type == "Clip")
-        {
-            ncnn::Clip* clip = (ncnn::Clip*)activation;
+            if (!same_activation_params)
+                continue;
 
-            convolutiondepthwise->activation_type = 3;
-            convolutiondepthwise->activation_params = ncnn::Mat(2);
-            convolutiondepthwise->activation_params[0] = clip->min;
-            convolutiondepthwise->activation_params[1] = clip->max;
+            projections.push_back(innerproduct);
+            projection_indexes.push_back(candidates[k]);
         }
-        else if (activation->type == "Sigmoid")
+
+        if (projections.size() < 2)
+            continue;
+
+        // the merged projection takes the first slot and the slice takes the second
+        // every output consumer must come after the slice to keep the layer order topological
+        const size_t i0 = projection_indexes[0];
+        const size_t i1 = projection_indexes[1];
+
+        bool order_ok = true;
+        for (size_t k = 0; k < projections.size(); k++)
         {
-            convolutiondepthwise->activation_type = 4;
+            int consumer = blobs[projections[k]->tops[0]].consumer;
+            if (consumer != -1 && (size_t)consumer < i1)
+                order_ok = false;
         }
-        else if (activation->type == "Mish")
+        if (!order_ok)
+            continue;
+
+        fprintf(stderr, "fuse_innerproduct_qkv %s", split->name.c_str());
+        for (size_t k = 0; k < projections.size(); k++)
         {
-            convolutiondepthwise->activation_type = 5;
+            fprintf(stderr, " %s", projections[k]->name.c_str());
         }
-        else if (activation->type == "HardSwish")
-        {
-            ncnn::HardSwish* hardswish = (ncnn::HardSwish*)activation;
+        fprintf(stderr, "\n");
 
-            convolutiondepthwise->activation_type = 6;
-            convolutiondepthwise->activation_params = ncnn::Mat(2);
-            convolutiondepthwise->activation_params[0] = hardswish->alpha;
-            convolutiondepthwise->activation_params[1] = hardswish->beta;
+        int num_output = 0;
+        bool bias_term = false;
+        for (size_t k = 0; k < projections.size(); k++)
+        {
+            num_output += projections[k]->num_output;
+            bias_term = bias_term || projections[k]->bias_term;
         }
 
-        int top_blob_index_final = activation->tops[0];
-        convolutiondepthwise->tops[0] = top_blob_index_final;
-        blobs[top_blob_index_final].producer = i;
-        activation->type = "ncnnfused";
-    }
+        ncnn::InnerProduct* merged = (ncnn::InnerProduct*)ncnn::create_layer_cpu("InnerProduct");
 
-    return 0;
-}
+        merged->type = "InnerProduct";
+        merged->name = ip0->name;
+        merged->bottoms = ip0->bottoms;
 
-int NetOptimize::fuse_deconvolution_activation()
-{
-    const size_t layer_count = layers.size();
-    for (size_t i = 0; i < layer_count; i++)
-    {
-        if (layers[i]->type != "Deconvolution")
-            continue;
+        ncnn::ParamDict pd;
+        merged->load_param(pd);
 
-        // Deconvolution - Activation
-        int top_blob_index = layers[i]->tops[0];
+        merged->num_output = num_output;
+        merged->bias_term = bias_term ? 1 : 0;
+        merged->weight_data_size = num_output * num_input;
+        merged->activation_type = ip0->activation_type;
+        merged->activation_params = ip0->activation_params;
 
-        size_t j = i + 1;
-        for (; j < layer_count; j++)
+        merged->weight_data = ncnn::Mat(merged->weight_data_size);
+        if (bias_term)
         {
-            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid")
-                continue;
-
-            if (layers[j]->bottoms.size() != 1)
-                continue;
-
-            if (layers[j]->bottoms[0] == top_blob_index)
-                break;
+            merged->bias_data = ncnn::Mat(num_output);
+            merged->bias_data.fill(0.f);
         }
 
-        if (j == layer_count)
-            continue;
+        ncnn::Slice* slice = (ncnn::Slice*)ncnn::create_layer_cpu("Slice");
 
-        // fuse Deconvolution - Activation to Deconvolution
-        ncnn::Deconvolution* deconvolution = (ncnn::Deconvolution*)layers[i];
-        ncnn::Layer* activation = layers[j];
+        slice->type = "Slice";
+        slice->name = ip0->name + "_slice";
 
-        fprintf(stderr, "fuse_deconvolution_activation %s %s\n", deconvolution->name.c_str(), activation->name.c_str());
+        slice->load_param(pd);
 
-        if (activation->type == "ReLU")
+        slice->slices = ncnn::Mat((int)projections.size(), (size_t)4u);
+        slice->axis = -1;
+
+        int p = 0;
+        for (size_t k = 0; k < projections.size(); k++)
         {
-            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+            ncnn::InnerProduct* innerproduct = projections[k];
 
-            if (relu->slope == 0.f)
-            {
-                deconvolution->activation_type = 1;
-            }
-            else
+            memcpy((float*)merged->weight_data + p * num_input, innerproduct->weight_data, innerproduct->weight_data_size * sizeof(float));
+            if (innerproduct->bias_term)
             {
-                deconvolution->activation_type = 2;
-                deconvolution->activation_params = ncnn::Mat(1);
-                deconvolution->activation_params[0] = relu->slope;
+                memcpy((float*)merged->bias_data + p, innerproduct->bias_data, innerproduct->num_output * sizeof(float));
             }
+
+            ((int*)slice->slices)[k] = innerproduct->num_output;
+            p += innerproduct->num_output;
+
+            slice->tops.push_back(innerproduct->tops[0]);
+            blobs[innerproduct->tops[0]].producer = (int)i1;
         }
-        else if (activation->type == "Clip")
+
+        // the merged projection output
+        ncnn::Blob merged_blob;
+        merged_blob.name = ip0->name + "_merged";
+        merged_blob.producer = (int)i0;
+        merged_blob.consumer = (int)i1;
+        blobs.push_back(merged_blob);
+
+        const int merged_blob_index = (int)blobs.size() - 1;
+        merged->tops.push_back(merged_blob_index);
+        slice->bottoms.push_back(merged_blob_index);
+
+        // drop the split outputs of the other projections
+        for (size_t k = 1; k < projections.size(); k++)
         {
-            ncnn::Clip* clip = (ncnn::Clip*)activation;
+            int bottom_blob_index = projections[k]->bottoms[0];
+            blobs[bottom_blob_index].consumer = -1;
+            split->tops.erase(std::find(split->tops.begin(), split->tops.end(), bottom_blob_index));
+        }
 
-            deconvolution->activation_type = 3;
-            deconvolution->activation_params = ncnn::Mat(2);
-            deconvolution->activation_params[0] = clip->min;
-            deconvolution->activation_params[1] = clip->max;
+        for (size_t k = 2; k < projections.size(); k++)
+        {
+            projections[k]->type = "ncnnfused";
         }
-        else if (activation->type == "Sigmoid")
+
+        // the merged projection may be the only split output left, feed it directly
+        if (split->tops.size() == 1)
         {
-            deconvolution->activation_type = 4;
+            int bottom_blob_index = split->bottoms[0];
+            merged->bottoms[0] = bottom_blob_index;
+            blobs[bottom_blob_index].consumer = (int)i0;
+            split->type = "ncnnfused";
         }
 
-        int top_blob_index_final = activation->tops[0];
-        deconvolution->tops[0] = top_blob_index_final;
-        blobs[top_blob_index_final].producer = i;
-        activation->type = "ncnnfused";
+        delete layers[i0];
+        delete layers[i1];
+        layers[i0] = merged;
+        layers[i1] = slice;
     }
 
     return 0;
 }
 
-int NetOptimize::fuse_deconvolutiondepthwise_activation()
+int NetOptimize::fuse_gemm_add()
 {
     const size_t layer_count = layers.size();
+
+    // the residual add is fused into the C input, which is only safe with known shapes
+    bool shape_ready = false;
+
     for (size_t i = 0; i < layer_count; i++)
     {
-        if (layers[i]->type != "DeconvolutionDepthWise")
+        if (layers[i]->type != "Gemm")
             continue;
 
-        // DeconvolutionDepthWise - Activation
+        // Gemm - BinaryOp
         int top_blob_index = layers[i]->tops[0];
 
         size_t j = i + 1;
         for (; j < layer_count; j++)
         {
-            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid")
+            if (layers[j]->type != "BinaryOp")
                 continue;
 
-            if (layers[j]->bottoms.size() != 1)
+            if (layers[j]->bottoms.size() != 2)
+                continue;
+
+            if (layers[j]->bottoms[0] == top_blob_index || layers[j]->bottoms[1] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        // fuse Gemm - BinaryOp residual add to Gemm
+        ncnn::Gemm* gemm = (ncnn::Gemm*)layers[i];
+        ncnn::BinaryOp* binaryop = (ncnn::BinaryOp*)layers[j];
+
+        if (binaryop->op_type != 0 || binaryop->with_scalar)
+            continue;
+
+        // gemm without C
+        const size_t gemm_input_count = (gemm->constantA ? 0 : 1) + (gemm->constantB ? 0 : 1);
+        if (gemm->constantC || gemm->bottoms.size() != gemm_input_count)
+            continue;
+
+        // C is added before activation and output layout changes
+        if (gemm->activation_type || gemm->output_transpose || gemm->output_N1M || gemm->alpha == 0.f)
+            continue;
+
+        const int residual_blob_index = binaryop->bottoms[0] == top_blob_index ? binaryop->bottoms[1] : binaryop->bottoms[0];
+        if (residual_blob_index == top_blob_index)
+            continue;
+
+        // the residual must be ready before gemm
+        if (blobs[residual_blob_index].producer == -1 || (size_t)blobs[residual_blob_index].producer > i)
+            continue;
+
+        if (!shape_ready)
+        {
+            if (shape_inference() != 0)
+                return 0;
+
+            shape_ready = true;
+        }
+
+        // the residual has the gemm output shape
+        const ncnn::Mat& out_shape = blobs[top_blob_index].shape;
+        const ncnn::Mat& residual_shape = blobs[residual_blob_index].shape;
+        if (out_shape.dims != 2 || residual_shape.dims != 2 || out_shape.w != residual_shape.w || out_shape.h != residual_shape.h)
+            continue;
+
+        fprintf(stderr, "fuse_gemm_add %s %s\n", gemm->name.c_str(), binaryop->name.c_str());
+
+        // (A * B + C * beta) * alpha with beta = 1 / alpha
+        gemm->beta = 1.f / gemm->alpha;
+
+        gemm->bottoms.push_back(residual_blob_index);
+        blobs[residual_blob_index].consumer = (int)i;
+
+        int top_blob_index_final = binaryop->tops[0];
+        gemm->tops[0] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = i;
+        binaryop->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_permute_gemm()
+{
+    const size_t layer_count = layers.size();
+
+    // only the plain matrix transpose folds into gemm
+    bool shape_ready = false;
+
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Permute")
+            continue;
+
+        ncnn::Permute* permute = (ncnn::Permute*)layers[i];
+        if (permute->order_type != 1)
+            continue;
+
+        // Permute - Gemm
+        int top_blob_index = permute->tops[0];
+
+        size_t j = i + 1;
+        int bottom_i = -1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "Gemm")
+                continue;
+
+            for (size_t k = 0; k < layers[j]->bottoms.size(); k++)
+            {
+                if (layers[j]->bottoms[k] == top_blob_index)
+                {
+                    bottom_i = (int)k;
+                    break;
+                }
+            }
+
+            if (bottom_i != -1)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        ncnn::Gemm* gemm = (ncnn::Gemm*)layers[j];
+
+        // which gemm input is permuted, C keeps its layout
+        const int a_index = gemm->constantA ? -1 : 0;
+        const int b_index = gemm->constantB ? -1 : gemm->constantA ? 0 : 1;
+        if (bottom_i != a_index && bottom_i != b_index)
+            continue;
+
+        if (!shape_ready)
+        {
+            if (shape_inference() != 0)
+                return 0;
+
+            shape_ready = true;
+        }
+
+        if (blobs[permute->bottoms[0]].shape.dims != 2)
+            continue;
+
+        fprintf(stderr, "fuse_permute_gemm %s %s\n", permute->name.c_str(), gemm->name.c_str());
+
+        if (bottom_i == a_index)
+            gemm->transA = 1 - gemm->transA;
+        else
+            gemm->transB = 1 - gemm->transB;
+
+        int bottom_blob_index_final = permute->bottoms[0];
+        gemm->bottoms[bottom_i] = bottom_blob_index_final;
+        blobs[bottom_blob_index_final].consumer = (int)j;
+        permute->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_gemm_permute()
+{
+    const size_t layer_count = layers.size();
+
+    bool shape_ready = false;
+
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Gemm")
+            continue;
+
+        // Gemm - Permute
+        int top_blob_index = layers[i]->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "Permute")
+                continue;
+
+            if (layers[j]->bottoms.size() != 1)
+                continue;
+
+            if (layers[j]->bottoms[0] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        ncnn::Gemm* gemm = (ncnn::Gemm*)layers[i];
+        ncnn::Permute* permute = (ncnn::Permute*)layers[j];
+
+        if (permute->order_type != 1 || gemm->output_N1M)
+            continue;
+
+        if (!shape_ready)
+        {
+            if (shape_inference() != 0)
+                return 0;
+
+            shape_ready = true;
+        }
+
+        if (blobs[top_blob_index].shape.dims != 2)
+            continue;
+
+        fprintf(stderr, "fuse_gemm_permute %s %s\n", gemm->name.c_str(), permute->name.c_str());
+
+        gemm->output_transpose = 1 - gemm->output_transpose;
+
+        int top_blob_index_final = permute->tops[0];
+        gemm->tops[0] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = i;
+        permute->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_permute_matmul()
+{
+    const size_t layer_count = layers.size();
+
+    // permute on 1d blob is noop and must not flip transB
+    bool shape_ready = false;
+
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Permute")
+            continue;
+
+        // swap the last two axes
+        ncnn::Permute* permute = (ncnn::Permute*)layers[i];
+        if (permute->order_type != 1)
+            continue;
+
+        // Permute - MatMul B
+        int top_blob_index = permute->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "MatMul")
+                continue;
+
+            if (layers[j]->bottoms.size() != 2)
+                continue;
+
+            if (layers[j]->bottoms[1] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        ncnn::MatMul* matmul = (ncnn::MatMul*)layers[j];
+
+        if (!shape_ready)
+        {
+            if (shape_inference() != 0)
+                return 0;
+
+            shape_ready = true;
+        }
+
+        if (blobs[permute->bottoms[0]].shape.dims < 2)
+            continue;
+
+        fprintf(stderr, "fuse_permute_matmul %s %s\n", permute->name.c_str(), matmul->name.c_str());
+
+        matmul->transB = 1 - matmul->transB;
+
+        int bottom_blob_index_final = permute->bottoms[0];
+        matmul->bottoms[1] = bottom_blob_index_final;
+        blobs[bottom_blob_index_final].consumer = (int)j;
+        permute->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_convolution_activation()
+{
+    const size_t layer_count = layers.size();
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Convolution")
+            continue;
+
+        // Convolution - Activation
+        int top_blob_index = layers[i]->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish" && layers[j]->type != "HardSwish")
+                continue;
+
+            if (layers[j]->bottoms.size() != 1)
+                continue;
+
+            if (layers[j]->bottoms[0] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        // fuse Convolution - Activation to Convolution
+        ncnn::Convolution* convolution = (ncnn::Convolution*)layers[i];
+        ncnn::Layer* activation = layers[j];
+
+        fprintf(stderr, "fuse_convolution_activation %s %s\n", convolution->name.c_str(), activation->name.c_str());
+
+        if (activation->type == "ReLU")
+        {
+            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+
+            if (relu->slope == 0.f)
+            {
+                convolution->activation_type = 1;
+            }
+            else
+            {
+                convolution->activation_type = 2;
+                convolution->activation_params = ncnn::Mat(1);
+                convolution->activation_params[0] = relu->slope;
+            }
+        }
+        else if (activation->type == "Clip")
+        {
+            ncnn::Clip* clip = (ncnn::Clip*)activation;
+
+            convolution->activation_type = 3;
+            convolution->activation_params = ncnn::Mat(2);
+            convolution->activation_params[0] = clip->min;
+            convolution->activation_params[1] = clip->max;
+        }
+        else if (activation->type == "Sigmoid")
+        {
+            convolution->activation_type = 4;
+        }
+        else if (activation->type == "Mish")
+        {
+            convolution->activation_type = 5;
+        }
+        else if (activation->type == "HardSwish")
+        {
+            ncnn::HardSwish* hardswish = (ncnn::HardSwish*)activation;
+
+            convolution->activation_type = 6;
+            convolution->activation_params = ncnn::Mat(2);
+            convolution->activation_params[0] = hardswish->alpha;
+            convolution->activation_params[1] = hardswish->beta;
+        }
+
+        int top_blob_index_final = activation->tops[0];
+        convolution->tops[0] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = i;
+        activation->type = "ncnnfused";
+    }
+
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Convolution1D")
+            continue;
+
+        // Convolution1D - Activation
+        int top_blob_index = layers[i]->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish")
+                continue;
+
+            if (layers[j]->bottoms.size() != 1)
+                continue;
+
+            if (layers[j]->bottoms[0] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        // fuse Convolution1D - Activation to Convolution1D
+        ncnn::Convolution1D* convolution = (ncnn::Convolution1D*)layers[i];
+        ncnn::Layer* activation = layers[j];
+
+        fprintf(stderr, "fuse_convolution1d_activation %s %s\n", convolution->name.c_str(), activation->name.c_str());
+
+        if (activation->type == "ReLU")
+        {
+            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+
+            if (relu->slope == 0.f)
+            {
+                convolution->activation_type = 1;
+            }
+            else
+            {
+                convolution->activation_type = 2;
+                convolution->activation_params = ncnn::Mat(1);
+                convolution->activation_params[0] = relu->slope;
+            }
+        }
+        else if (activation->type == "Clip")
+        {
+            ncnn::Clip* clip = (ncnn::Clip*)activation;
+
+            convolution->activation_type = 3;
+            convolution->activation_params = ncnn::Mat(2);
+            convolution->activation_params[0] = clip->min;
+            convolution->activation_params[1] = clip->max;
+        }
+        else if (activation->type == "Sigmoid")
+        {
+            convolution->activation_type = 4;
+        }
+        else if (activation->type == "Mish")
+        {
+            convolution->activation_type = 5;
+        }
+
+        int top_blob_index_final = activation->tops[0];
+        convolution->tops[0] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = i;
+        activation->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_convolutiondepthwise_activation()
+{
+    const size_t layer_count = layers.size();
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "ConvolutionDepthWise")
+            continue;
+
+        // ConvolutionDepthWise - Activation
+        int top_blob_index = layers[i]->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish" && layers[j]->type != "HardSwish")
+                continue;
+
+            if (layers[j]->bottoms.size() != 1)
+                continue;
+
+            if (layers[j]->bottoms[0] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        // fuse ConvolutionDepthWise - Activation to ConvolutionDepthWise
+        ncnn::ConvolutionDepthWise* convolutiondepthwise = (ncnn::ConvolutionDepthWise*)layers[i];
+        ncnn::Layer* activation = layers[j];
+
+        fprintf(stderr, "fuse_convolutiondepthwise_activation %s %s\n", convolutiondepthwise->name.c_str(), activation->name.c_str());
+
+        if (activation->type == "ReLU")
+        {
+            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+
+            if (relu->slope == 0.f)
+            {
+                convolutiondepthwise->activation_type = 1;
+            }
+            else
+            {
+                convolutiondepthwise->activation_type = 2;
+                convolutiondepthwise->activation_params = ncnn::Mat(1);
+                convolutiondepthwise->activation_params[0] = relu->slope;
+            }
+        }
+        else if (activation->type == "Clip")
+        {
+            ncnn::Clip* clip = (ncnn::Clip*)activation;
+
+            convolutiondepthwise->activation_type = 3;
+            convolutiondepthwise->activation_params = ncnn::Mat(2);
+            convolutiondepthwise->activation_params[0] = clip->min;
+            convolutiondepthwise->activation_params[1] = clip->max;
+        }
+        else if (activation->type == "Sigmoid")
+        {
+            convolutiondepthwise->activation_type = 4;
+        }
+        else if (activation->type == "Mish")
+        {
+            convolutiondepthwise->activation_type = 5;
+        }
+        else if (activation->type == "HardSwish")
+        {
+            ncnn::HardSwish* hardswish = (ncnn::HardSwish*)activation;
+
+            convolutiondepthwise->activation_type = 6;
+            convolutiondepthwise->activation_params = ncnn::Mat(2);
+            convolutiondepthwise->activation_params[0] = hardswish->alpha;
+            convolutiondepthwise->activation_params[1] = hardswish->beta;
+        }
+
+        int top_blob_index_final = activation->tops[0];
+        convolutiondepthwise->tops[0] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = i;
+        activation->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_deconvolution_activation()
+{
+    const size_t layer_count = layers.size();
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Deconvolution")
+            continue;
+
+        // Deconvolution - Activation
+        int top_blob_index = layers[i]->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid")
+                continue;
+
+            if (layers[j]->bottoms.size() != 1)
+                continue;
+
+            if (layers[j]->bottoms[0] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        // fuse Deconvolution - Activation to Deconvolution
+        ncnn::Deconvolution* deconvolution = (ncnn::Deconvolution*)layers[i];
+        ncnn::Layer* activation = layers[j];
+
+        fprintf(stderr, "fuse_deconvolution_activation %s %s\n", deconvolution->name.c_str(), activation->name.c_str());
+
+        if (activation->type == "ReLU")
+        {
+            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+
+            if (relu->slope == 0.f)
+            {
+                deconvolution->activation_type = 1;
+            }
+            else
+            {
+                deconvolution->activation_type = 2;
+                deconvolution->activation_params = ncnn::Mat(1);
+                deconvolution->activation_params[0] = relu->slope;
+            }
+        }
+        else if (activation->type == "Clip")
+        {
+            ncnn::Clip* clip = (ncnn::Clip*)activation;
+
+            deconvolution->activation_type = 3;
+            deconvolution->activation_params = ncnn::Mat(2);
+            deconvolution->activation_params[0] = clip->min;
+            deconvolution->activation_params[1] = clip->max;
+        }
+        else if (activation->type == "Sigmoid")
+        {
+            deconvolution->activation_type = 4;
+        }
+
+        int top_blob_index_final = activation->tops[0];
+        deconvolution->tops[0] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = i;
+        activation->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_deconvolutiondepthwise_activation()
+{
+    const size_t layer_count = layers.size();
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "DeconvolutionDepthWise")
+            continue;
+
+        // DeconvolutionDepthWise - Activation
+        int top_blob_index = layers[i]->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid")
+                continue;
+
+            if (layers[j]->bottoms.size() != 1)
                 continue;
 
             if (layers[j]->bottoms[0] == top_blob_index)
@@ -1669,7 +2336,7 @@ int NetOptimize::fuse_innerproduct_activation()
         size_t j = i + 1;
         for (; j < layer_count; j++)
         {
-            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish" && layers[j]->type != "HardSwish")
+            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish" && layers[j]->type != "HardSwish" && layers[j]->type != "GELU" && layers[j]->type != "Swish")
                 continue;
 
             if (layers[j]->bottoms.size() != 1)
@@ -1682,6 +2349,10 @@ int NetOptimize::fuse_innerproduct_activation()
         if (j == layer_count)
             continue;
 
+        // only the tanh approximation of gelu has a fused form
+        if (layers[j]->type == "GELU" && ((ncnn::GELU*)layers[j])->fast_gelu == 0)
+            continue;
+
         // fuse InnerProduct - Activation to InnerProduct
         ncnn::InnerProduct* innerproduct = (ncnn::InnerProduct*)layers[i];
         ncnn::Layer* activation = layers[j];
@@ -1729,9 +2400,113 @@ int NetOptimize::fuse_innerproduct_activation()
             innerproduct->activation_params[0] = hardswish->alpha;
             innerproduct->activation_params[1] = hardswish->beta;
         }
+        else if (activation->type == "GELU")
+        {
+            innerproduct->activation_type = 7;
+        }
+        else if (activation->type == "Swish")
+        {
+            innerproduct->activation_type = 8;
+        }
+
+        int top_blob_index_final = activation->tops[0];
+        innerproduct->tops[0] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = i;
+        activation->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::fuse_gemm_activation()
+{
+    const size_t layer_count = layers.size();
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Gemm")
+            continue;
+
+        // Gemm - Activation
+        int top_blob_index = layers[i]->tops[0];
+
+        size_t j = i + 1;
+        for (; j < layer_count; j++)
+        {
+            if (layers[j]->type != "ReLU" && layers[j]->type != "Clip" && layers[j]->type != "Sigmoid" && layers[j]->type != "Mish" && layers[j]->type != "HardSwish" && layers[j]->type != "GELU" && layers[j]->type != "Swish")
+                continue;
+
+            if (layers[j]->bottoms.size() != 1)
+                continue;
+
+            if (layers[j]->bottoms[0] == top_blob_index)
+                break;
+        }
+
+        if (j == layer_count)
+            continue;
+
+        // only the tanh approximation of gelu has a fused form
+        if (layers[j]->type == "GELU" && ((ncnn::GELU*)layers[j])->fast_gelu == 0)
+            continue;
+
+        // fuse Gemm - Activation to Gemm
+        ncnn::Gemm* gemm = (ncnn::Gemm*)layers[i];
+        ncnn::Layer* activation = layers[j];
+
+        fprintf(stderr, "fuse_gemm_activation %s %s\n", gemm->name.c_str(), activation->name.c_str());
+
+        if (activation->type == "ReLU")
+        {
+            ncnn::ReLU* relu = (ncnn::ReLU*)activation;
+
+            if (relu->slope == 0.f)
+            {
+                gemm->activation_type = 1;
+            }
+            else
+            {
+                gemm->activation_type = 2;
+                gemm->activation_params = ncnn::Mat(1);
+                gemm->activation_params[0] = relu->slope;
+            }
+        }
+        else if (activation->type == "Clip")
+        {
+            ncnn::Clip* clip = (ncnn::Clip*)activation;
+
+            gemm->activation_type = 3;
+            gemm->activation_params = ncnn::Mat(2);
+            gemm->activation_params[0] = clip->min;
+            gemm->activation_params[1] = clip->max;
+        }
+        else if (activation->type == "Sigmoid")
+        {
+            gemm->activation_type = 4;
+        }
+        else if (activation->type == "Mish")
+        {
+            gemm->activation_type = 5;
+        }
+        else if (activation->type == "HardSwish")
+        {
+            ncnn::HardSwish* hardswish = (ncnn::HardSwish*)activation;
+
+            gemm->activation_type = 6;
+            gemm->activation_params = ncnn::Mat(2);
+            gemm->activation_params[0] = hardswish->alpha;
+            gemm->activation_params[1] = hardswish->beta;
+        }
+        else if (activation->type == "GELU")
+        {
+            gemm->activation_type = 7;
+        }
+        else if (activation->type == "Swish")
+        {
+            gemm->activation_type = 8;
+        }
 
         int top_blob_index_final = activation->tops[0];
-        innerproduct->tops[0] = top_blob_index_final;
+        gemm->tops[0] = top_blob_index_final;
         blobs[top_blob_index_final].producer = i;
         activation->type = "ncnnfused";
     }
@@ -2759,11 +3534,445 @@ int NetOptimize::replace_convolution_with_innerproduct_after_innerproduct()
     return 0;
 }
 
+int NetOptimize::set_input_shapes(const std::vector<std::vector<int> >& shapes)
+{
+    const size_t layer_count = layers.size();
+
+    size_t input_index = 0;
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Input")
+            continue;
+
+        if (input_index == shapes.size())
+        {
+            fprintf(stderr, "expect shape for Input layer %s\n", layers[i]->name.c_str());
+            return -1;
+        }
+
+        // shape is given as [w,h,...]
+        const std::vector<int>& shape = shapes[input_index++];
+        if (shape.empty() || shape.size() > 4)
+        {
+            fprintf(stderr, "invalid shape for Input layer %s\n", layers[i]->name.c_str());
+            return -1;
+        }
+
+        ncnn::Input* input = (ncnn::Input*)layers[i];
+
+        input->w = shape[0];
+        input->h = shape.size() > 1 ? shape[1] : 0;
+        input->d = shape.size() == 4 ? shape[2] : 0;
+        input->c = shape.size() == 3 ? shape[2] : shape.size() == 4 ? shape[3] : 0;
+    }
+
+    if (input_index != shapes.size())
+    {
+        fprintf(stderr, "expect %d shapes, but got %d\n", (int)input_index, (int)shapes.size());
+        return -1;
+    }
+
+    // the shape hints in param are stale for the new input shapes
+    const size_t blob_count = blobs.size();
+    for (size_t i = 0; i < blob_count; i++)
+    {
+        blobs[i].shape = ncnn::Mat();
+    }
+
+    return 0;
+}
+
+int NetOptimize::fold_memorydata_subgraph()
+{
+    if (has_custom_layer)
+        return 0;
+
+    const size_t layer_count = layers.size();
+    const size_t blob_count = blobs.size();
+
+    // a blob is constant when it only depends on MemoryData
+    std::vector<bool> constant_blob(blob_count, false);
+    std::vector<size_t> foldable;
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        const ncnn::Layer* layer = layers[i];
+        if (layer->type == "ncnnfused" || layer->type == "Input" || layer->type == "Noop")
+            continue;
+
+        if (layer->type == "MemoryData")
+        {
+            constant_blob[layer->tops[0]] = true;
+            continue;
+        }
+
+        if (layer->bottoms.empty())
+            continue;
+
+        bool all_constant = true;
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            if (!constant_blob[layer->bottoms[j]])
+            {
+                all_constant = false;
+                break;
+            }
+        }
+
+        if (!all_constant)
+            continue;
+
+        for (size_t j = 0; j < layer->tops.size(); j++)
+        {
+            constant_blob[layer->tops[j]] = true;
+        }
+
+        // Split keeps fanning out the folded result
+        if (layer->type == "Split" || layer->tops.size() != 1)
+            continue;
+
+        foldable.push_back(i);
+    }
+
+    if (foldable.empty())
+        return 0;
+
+    // evaluate the constant subgraphs once
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        ncnn::Layer* layer = layers[i];
+        if (layer->type == "ncnnfused")
+            continue;
+
+        layer->destroy_pipeline(opt);
+
+        int cret = layer->create_pipeline(opt);
+        if (cret != 0)
+        {
+            NCNN_LOGE("layer create_pipeline %d %s failed", (int)i, layer->name.c_str());
+            return -1;
+        }
+    }
+
+    std::vector<ncnn::Mat> folded(foldable.size());
+    {
+        ncnn::Extractor ex = create_extractor();
+
+        for (size_t k = 0; k < foldable.size(); k++)
+        {
+            int ret = ex.extract(layers[foldable[k]]->tops[0], folded[k]);
+            if (ret != 0)
+                folded[k].release();
+        }
+    }
+
+    for (size_t k = 0; k < foldable.size(); k++)
+    {
+        const size_t i = foldable[k];
+        const ncnn::Mat& m = folded[k];
+        if (m.empty() || m.elemsize != 4 || m.elempack != 1)
+            continue;
+
+        ncnn::Layer* layer = layers[i];
+
+        fprintf(stderr, "fold_memorydata_subgraph %s\n", layer->name.c_str());
+
+        ncnn::MemoryData* memorydata = (ncnn::MemoryData*)ncnn::create_layer_cpu("MemoryData");
+
+        memorydata->type = "MemoryData";
+        memorydata->name = layer->name;
+        memorydata->tops = layer->tops;
+
+        ncnn::ParamDict pd;
+        memorydata->load_param(pd);
+
+        memorydata->w = m.w;
+        memorydata->h = m.dims >= 2 ? m.h : 0;
+        memorydata->d = m.dims == 4 ? m.d : 0;
+        memorydata->c = m.dims >= 3 ? m.c : 0;
+        memorydata->data = m.clone();
+
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            blobs[layer->bottoms[j]].consumer = -1;
+        }
+
+        layer->destroy_pipeline(opt);
+        delete layer;
+        layers[i] = memorydata;
+    }
+
+    // drop the Split whose outputs are all folded away
+    for (int i = (int)layer_count - 1; i >= 0; i--)
+    {
+        ncnn::Layer* split = layers[i];
+        if (split->type != "Split")
+            continue;
+
+        bool orphaned = true;
+        for (size_t j = 0; j < split->tops.size(); j++)
+        {
+            if (blobs[split->tops[j]].consumer != -1)
+            {
+                orphaned = false;
+                break;
+            }
+        }
+
+        if (!orphaned)
+            continue;
+
+        fprintf(stderr, "fold_memorydata_subgraph %s\n", split->name.c_str());
+
+        blobs[split->bottoms[0]].consumer = -1;
+        split->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+int NetOptimize::resolve_shape_expression()
+{
+    const size_t layer_count = layers.size();
+
+    bool shape_ready = false;
+
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        ncnn::Layer* layer = layers[i];
+
+        bool has_expression = false;
+        if (layer->type == "Reshape")
+            has_expression = !((ncnn::Reshape*)layer)->shape_expr.empty();
+        if (layer->type == "Interp")
+            has_expression = !((ncnn::Interp*)layer)->size_expr.empty() && ((ncnn::Interp*)layer)->dynamic_target_size == 0;
+        if (layer->type == "Crop")
+            has_expression = !((ncnn::Crop*)layer)->starts_expr.empty() && !((ncnn::Crop*)layer)->ends_expr.empty();
+
+        if (!has_expression)
+            continue;
+
+        if (!shape_ready)
+        {
+            if (shape_inference() != 0)
+                return 0;
+
+            shape_ready = true;
+        }
+
+        // the expressions only read the shape of the referenced blobs
+        std::vector<ncnn::Mat> bottom_shapes(layer->bottoms.size());
+        bool bottom_shape_ready = true;
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            bottom_shapes[j] = blobs[layer->bottoms[j]].shape;
+            if (bottom_shapes[j].dims == 0)
+                bottom_shape_ready = false;
+        }
+
+        if (!bottom_shape_ready)
+            continue;
+
+        if (layer->type == "Reshape")
+        {
+            ncnn::Reshape* reshape = (ncnn::Reshape*)layer;
+
+            std::vector<int> shape;
+            if (ncnn::eval_list_expression(reshape->shape_expr, bottom_shapes, shape) != 0 || shape.empty() || shape.size() > 4)
+                continue;
+
+            fprintf(stderr, "resolve_shape_expression %s %s\n", reshape->name.c_str(), reshape->shape_expr.c_str());
+
+            reshape->w = shape[0];
+            reshape->h = shape.size() > 1 ? shape[1] : -233;
+            reshape->d = shape.size() == 4 ? shape[2] : -233;
+            reshape->c = shape.size() == 3 ? shape[2] : shape.size() == 4 ? shape[3] : -233;
+            reshape->ndim = (int)shape.size();
+            reshape->shape_expr.clear();
+        }
+        if (layer->type == "Interp")
+        {
+            ncnn::Interp* interp = (ncnn::Interp*)layer;
+
+            std::vector<int> sizes;
+            if (ncnn::eval_list_expression(interp->size_expr, bottom_shapes, sizes) != 0 || sizes.empty() || sizes.size() > 2)
+                continue;
+
+            fprintf(stderr, "resolve_shape_expression %s %s\n", interp->name.c_str(), interp->size_expr.c_str());
+
+            interp->output_width = sizes[0];
+            interp->output_height = sizes.size() == 2 ? sizes[1] : bottom_shapes[0].h;
+            interp->size_expr.clear();
+        }
+        if (layer->type == "Crop")
+        {
+            ncnn::Crop* crop = (ncnn::Crop*)layer;
+
+            std::vector<int> starts;
+            std::vector<int> ends;
+            std::vector<int> axes;
+            if (ncnn::eval_list_expression(crop->starts_expr, bottom_shapes, starts) != 0 || ncnn::eval_list_expression(crop->ends_expr, bottom_shapes, ends) != 0 || ncnn::eval_list_expression(crop->axes_expr, bottom_shapes, axes) != 0)
+                continue;
+
+            if (starts.empty() || starts.size() != ends.size())
+                continue;
+
+            fprintf(stderr, "resolve_shape_expression %s %s %s\n", crop->name.c_str(), crop->starts_expr.c_str(), crop->ends_expr.c_str());
+
+            crop->starts = ncnn::Mat((int)starts.size(), (size_t)4u);
+            crop->ends = ncnn::Mat((int)ends.size(), (size_t)4u);
+            memcpy(crop->starts.data, starts.data(), starts.size() * sizeof(int));
+            memcpy(crop->ends.data, ends.data(), ends.size() * sizeof(int));
+
+            crop->axes.release();
+            if (!axes.empty())
+            {
+                crop->axes = ncnn::Mat((int)axes.size(), (size_t)4u);
+                memcpy(crop->axes.data, axes.data(), axes.size() * sizeof(int));
+            }
+
+            crop->starts_expr.clear();
+            crop->ends_expr.clear();
+            crop->axes_expr.clear();
+        }
+
+        // the extra reference blobs are no longer consumed
+        for (size_t j = 1; j < layer->bottoms.size(); j++)
+        {
+            blobs[layer->bottoms[j]].consumer = -1;
+        }
+        layer->bottoms.resize(1);
+        layer->bottom_shapes.resize(1);
+        layer->one_blob_only = true;
+    }
+
+    return 0;
+}
+
+int NetOptimize::eliminate_noop_reshape_permute_crop()
+{
+    const size_t layer_count = layers.size();
+
+    bool shape_ready = false;
+
+    for (size_t i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "Reshape" && layers[i]->type != "Permute" && layers[i]->type != "Crop" && layers[i]->type != "Flatten" && layers[i]->type != "Squeeze" && layers[i]->type != "ExpandDims")
+            continue;
+
+        ncnn::Layer* noop = layers[i];
+
+        if (noop->bottoms.size() != 1 || noop->tops.size() != 1)
+            continue;
+
+        if (!shape_ready)
+        {
+            if (shape_inference() != 0)
+                return 0;
+
+            shape_ready = true;
+        }
+
+        // the output is the input when shape does not change
+        const ncnn::Mat& bottom_shape = blobs[noop->bottoms[0]].shape;
+        const ncnn::Mat& top_shape = blobs[noop->tops[0]].shape;
+        if (bottom_shape.dims == 0 || bottom_shape.dims != top_shape.dims || bottom_shape.w != top_shape.w || bottom_shape.h != top_shape.h || bottom_shape.d != top_shape.d || bottom_shape.c != top_shape.c)
+            continue;
+
+        if (noop->type == "Permute" && ((ncnn::Permute*)noop)->order_type != 0)
+        {
+            // moving around axes of size 1 keeps the memory layout
+            int non_trivial_axis_count = (bottom_shape.w > 1) + (bottom_shape.h > 1) + (bottom_shape.d > 1) + (bottom_shape.c > 1);
+            if (non_trivial_axis_count > 1)
+                continue;
+        }
+
+        // Any - Noop
+        int bottom_blob_index = noop->bottoms[0];
+
+        int top_i = -1;
+        int j = i - 1;
+        for (; j >= 0; j--)
+        {
+            if (layers[j]->type == "ncnnfused")
+                continue;
+
+            for (size_t k = 0; k < layers[j]->tops.size(); k++)
+            {
+                if (layers[j]->tops[k] == bottom_blob_index)
+                {
+                    top_i = k;
+                    break;
+                }
+            }
+
+            if (top_i != -1)
+                break;
+        }
+
+        if (j == -1)
+            continue;
+
+        ncnn::Layer* any = layers[j];
+
+        // keep the input blob name
+        if (any->type == "Input")
+            continue;
+
+        fprintf(stderr, "eliminate_noop_reshape_permute_crop %s %s\n", any->name.c_str(), noop->name.c_str());
+
+        int top_blob_index_final = noop->tops[0];
+        any->tops[top_i] = top_blob_index_final;
+        blobs[top_blob_index_final].producer = j;
+        noop->type = "ncnnfused";
+    }
+
+    return 0;
+}
+
+static std::vector<std::vector<int> > parse_comma_int_array_list(char* s)
+{
+    std::vector<std::vector<int> > aai;
+
+    char* pch = strtok(s, "[]");
+    while (pch != NULL)
+    {
+        // parse a,b,c
+        int v;
+        int nconsumed = 0;
+        int nscan = sscanf(pch, "%d%n", &v, &nconsumed);
+        if (nscan == 1)
+        {
+            // ok we get array
+            pch += nconsumed;
+
+            std::vector<int> ai;
+            ai.push_back(v);
+
+            nscan = sscanf(pch, ",%d%n", &v, &nconsumed);
+            while (nscan == 1)
+            {
+                pch += nconsumed;
+
+                ai.push_back(v);
+
+                nscan = sscanf(pch, ",%d%n", &v, &nconsumed);
+            }
+
+            // array end
+            aai.push_back(ai);
+        }
+
+        pch = strtok(NULL, "[]");
+    }
+
+    return aai;
+}
+
 int main(int argc, char** argv)
 {
     if (argc < 6)
     {
-        fprintf(stderr, "usage: %s [inparam] [inbin] [outparam] [outbin] [flag] [cutstart] [cutend]\n", argv[0]);
+        fprintf(stderr, "usage: %s [inparam] [inbin] [outparam] [outbin] [flag] [cutstart] [cutend] [shape=[w,h,c],...]\n", argv[0]);
         return -1;
     }
 
@@ -2774,15 +3983,23 @@ int main(int argc, char** argv)
     int flag = atoi(argv[5]);
     const char* cutstartname = nullptr;
     const char* cutendname = nullptr;
+    std::vector<std::vector<int> > shapes;
 
-    if (argc > 6)
+    int positional_index = 6;
+    for (int i = 6; i < argc; i++)
     {
-        cutstartname = argv[6];
-    }
+        if (memcmp(argv[i], "shape=", 6) == 0)
+        {
+            shapes = parse_comma_int_array_list(argv[i] + 6);
+            continue;
+        }
 
-    if (argc > 7)
-    {
-        cutendname = argv[7];
+        if (positional_index == 6)
+            cutstartname = argv[i];
+        if (positional_index == 7)
+            cutendname = argv[i];
+
+        positional_index++;
     }
 
     NetOptimize optimizer;
@@ -2812,6 +4029,18 @@ int main(int argc, char** argv)
         return -1;
     }
 
+    // specialize the model for the given input shapes
+    if (!shapes.empty() && optimizer.set_input_shapes(shapes) < 0)
+    {
+        return -1;
+    }
+
+    // the passes that rely on blob shapes only run for the given input shapes
+    // the Input shapes in param may just be placeholders of a dynamic shape model
+    const bool shape_specialized = !shapes.empty();
+
+    optimizer.fold_memorydata_subgraph();
+
     optimizer.fuse_batchnorm_scale();
     optimizer.fuse_convolution_batchnorm();
     optimizer.fuse_convolution_mul();
@@ -2826,6 +4055,16 @@ int main(int argc, char** argv)
     optimizer.fuse_innerproduct_batchnorm();
     optimizer.fuse_innerproduct_add();
     optimizer.fuse_innerproduct_dropout();
+    optimizer.fuse_innerproduct_qkv();
+    optimizer.fuse_layernorm_innerproduct();
+    optimizer.fuse_layernorm_gemm();
+    if (shape_specialized)
+    {
+        optimizer.fuse_gemm_add();
+        optimizer.fuse_permute_gemm();
+        optimizer.fuse_gemm_permute();
+        optimizer.fuse_permute_matmul();
+    }
 
     optimizer.replace_reduction_with_global_pooling();
     optimizer.replace_prelu_with_leaky_relu();
@@ -2835,9 +4074,16 @@ int main(int argc, char** argv)
     optimizer.fuse_deconvolution_activation();
     optimizer.fuse_deconvolutiondepthwise_activation();
     optimizer.fuse_innerproduct_activation();
+    optimizer.fuse_gemm_activation();
     optimizer.fuse_memorydata_binaryop();
     optimizer.fuse_binaryop_eltwise();
 
+    if (shape_specialized)
+    {
+        optimizer.resolve_shape_expression();
+        optimizer.eliminate_noop_reshape_permute_crop();
+    }
+
     optimizer.eliminate_dropout();
     optimizer.eliminate_pooling1x1();
     optimizer.eliminate_noop();
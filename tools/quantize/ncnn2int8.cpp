@@ -17,6 +17,7 @@
 #endif
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <map>
 #include <set>
@@ -128,6 +129,7 @@ public:
     int quantize_convolution();
     int quantize_convolutiondepthwise();
     int quantize_innerproduct();
+    int quantize_innerproduct_weight_only(int bits, int group_size);
 
     int quantize_rnn();
     int quantize_lstm();
@@ -320,6 +322,93 @@ int NetQuantize::quantize_innerproduct()
     return 0;
 }
 
+int NetQuantize::quantize_innerproduct_weight_only(int bits, int group_size)
+{
+    const int qmax = bits == 4 ? 7 : 127;
+
+    const int layer_count = static_cast<int>(layers.size());
+    for (int i = 0; i < layer_count; i++)
+    {
+        if (layers[i]->type != "InnerProduct")
+            continue;
+
+        ncnn::InnerProduct* fc = (ncnn::InnerProduct*)layers[i];
+
+        if (fc->int8_scale_term || fc->int8_dynamic_quantize || fc->weight_quant_bits)
+            continue;
+
+        const int num_input = fc->weight_data_size / fc->num_output;
+
+        // fallback to one group per output row when the group size does not fit
+        int gs = group_size > 0 && group_size < num_input ? group_size : num_input;
+        if (num_input % gs != 0 || (bits == 4 && gs % 2 != 0))
+            gs = num_input;
+        if (bits == 4 && gs % 2 != 0)
+            continue;
+
+        fprintf(stderr, "quantize_innerproduct_weight_only %s int%d group %d\n", fc->name.c_str(), bits, gs);
+
+        const int group_count = num_input / gs;
+        const size_t row_bytes = (size_t)num_input * bits / 8;
+
+        ncnn::Mat weight_data_r2 = fc->weight_data.reshape(num_input, fc->num_output);
+
+        ncnn::Mat weight_data_quantized((int)(row_bytes * fc->num_output), (size_t)1u);
+        ncnn::Mat weight_data_group_scales(group_count, fc->num_output);
+        if (weight_data_quantized.empty() || weight_data_group_scales.empty())
+            return -100;
+
+        weight_data_quantized.fill<signed char>(0);
+
+        for (int p = 0; p < fc->num_output; p++)
+        {
+            const float* kptr = weight_data_r2.row(p);
+            signed char* qptr = (signed char*)weight_data_quantized + row_bytes * p;
+            float* scales = weight_data_group_scales.row(p);
+
+            for (int g = 0; g < group_count; g++)
+            {
+                float absmax = 0.f;
+                for (int k = 0; k < gs; k++)
+                {
+                    absmax = std::max(absmax, (float)fabs(kptr[g * gs + k]));
+                }
+
+                const float scale = absmax == 0.f ? 1.f : absmax / qmax;
+                scales[g] = scale;
+
+                for (int k = 0; k < gs; k++)
+                {
+                    const int index = g * gs + k;
+
+                    int q = (int)round(kptr[index] / scale);
+                    q = std::min(std::max(q, -qmax), qmax);
+
+                    if (bits == 8)
+                    {
+                        qptr[index] = (signed char)q;
+                    }
+                    else if (index % 2 == 0)
+                    {
+                        qptr[index / 2] = (signed char)(q & 0x0f);
+                    }
+                    else
+                    {
+                        qptr[index / 2] = (signed char)((unsigned char)qptr[index / 2] | (q << 4));
+                    }
+                }
+            }
+        }
+
+        fc->weight_data = weight_data_quantized;
+        fc->weight_data_group_scales = weight_data_group_scales;
+        fc->weight_quant_bits = bits;
+        fc->weight_quant_group_size = gs;
+    }
+
+    return 0;
+}
+
 int NetQuantize::quantize_rnn()
 {
     for (size_t i = 0; i < layers.size(); i++)
@@ -1061,6 +1150,7 @@ int main(int argc, char** argv)
     if (argc != 5 && argc != 6)
     {
         fprintf(stderr, "usage: %s [inparam] [inbin] [outparam] [outbin] [calibration table]\n", argv[0]);
+        fprintf(stderr, "       %s [inparam] [inbin] [outparam] [outbin] w4|w8[:group_size]\n", argv[0]);
         return -1;
     }
 
@@ -1070,6 +1160,18 @@ int main(int argc, char** argv)
     const char* outbin = argv[4];
     const char* int8scale_table_path = argc == 6 ? argv[5] : NULL;
 
+    // weight-only quantization for innerproduct, w4 / w8 / w4:128
+    int weight_quant_bits = 0;
+    int weight_quant_group_size = 0;
+    if (int8scale_table_path && (strncmp(int8scale_table_path, "w4", 2) == 0 || strncmp(int8scale_table_path, "w8", 2) == 0))
+    {
+        weight_quant_bits = int8scale_table_path[1] - '0';
+        if (int8scale_table_path[2] == ':')
+            weight_quant_group_size = atoi(int8scale_table_path + 3);
+
+        int8scale_table_path = NULL;
+    }
+
     NetQuantize quantizer;
     quantizer.storage_type = 1; // use fp16 where int8 not applied
 
@@ -1097,6 +1199,8 @@ int main(int argc, char** argv)
     quantizer.quantize_convolution();
     quantizer.quantize_convolutiondepthwise();
     quantizer.quantize_innerproduct();
+    if (weight_quant_bits)
+        quantizer.quantize_innerproduct_weight_only(weight_quant_bits, weight_quant_group_size);
 
     quantizer.quantize_rnn();
     quantizer.quantize_lstm();